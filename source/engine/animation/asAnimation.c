@@ -0,0 +1,960 @@
+#include "asAnimation.h"
+#include "../thread/asJobSystem.h"
+
+#if ASTRENGINE_VK
+#include "../renderer/vulkan/asVulkanBackend.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_ANIM_SSE2 1
+#include <emmintrin.h>
+#else
+#define AS_ANIM_SSE2 0
+#endif
+
+#define AS_ANIM_BATCH_SIZE 8 /*Skeletons evaluated by each job*/
+#define AS_ANIM_CURSOR_STEPS 4 /*Keys stepped forward from the cursor before searching instead*/
+
+static bool gAnimSimd = AS_ANIM_SSE2 ? true : false;
+
+ASEXPORT bool asAnimation_SetSimdEnabled(bool enabled)
+{
+	gAnimSimd = enabled && AS_ANIM_SSE2;
+	return gAnimSimd;
+}
+
+/*------------------------------------FORMAT------------------------------------*/
+
+static bool _animRange(const asAnimation_t* pAnim, uint64_t offset, uint64_t bytes, uint64_t alignment)
+{
+	return offset % alignment == 0 && offset <= pAnim->size && bytes <= pAnim->size - offset;
+}
+
+static bool _animString(const asAnimation_t* pAnim, uint64_t offset)
+{
+	return offset < pAnim->size && memchr((const char*)pAnim + offset, '\0', (size_t)(pAnim->size - offset)) != NULL;
+}
+
+static bool _animClipValid(const asAnimation_t* pAnim, const asAnimClip_t* pClip)
+{
+	const uint64_t trackCount = (uint64_t)AS_ANIM_TRACK_COUNT * pClip->boneCount;
+	if (!_animString(pAnim, pClip->name.offset) || pClip->boneCount != pAnim->boneCount || pClip->skeletonHash != pAnim->skeletonHash ||
+		pClip->frameCount < 1 || pClip->frameCount > AS_ANIM_MAX_FRAMES || (pClip->frameCount > 1 && !(pClip->sampleRate > 0.0f)) ||
+		!_animRange(pAnim, pClip->tracks.offset, sizeof(asAnimTrack_t) * trackCount, 8) ||
+		!_animRange(pAnim, pClip->keyFrames.offset, sizeof(uint16_t) * (uint64_t)pClip->keyCount, 2) ||
+		!_animRange(pAnim, pClip->keyValues.offset, sizeof(uint16_t) * 3 * (uint64_t)pClip->keyCount, 2))
+	{
+		return false;
+	}
+
+	/*Keyed tracks run from the first frame to the last with increasing frames*/
+	const uint8_t* pBase = (const uint8_t*)pAnim;
+	const asAnimTrack_t* pTracks = (const asAnimTrack_t*)(pBase + pClip->tracks.offset);
+	const uint16_t* pFrames = (const uint16_t*)(pBase + pClip->keyFrames.offset);
+	for (uint64_t t = 0; t < trackCount; t++)
+	{
+		const asAnimTrack_t* pTrack = &pTracks[t];
+		if (!pTrack->keyCount)
+			continue;
+		if (pTrack->keyCount == 1 || (uint64_t)pTrack->firstKey + pTrack->keyCount > pClip->keyCount)
+			return false;
+		const uint16_t* pKeyFrames = &pFrames[pTrack->firstKey];
+		if (pKeyFrames[0] != 0 || pKeyFrames[pTrack->keyCount - 1] != pClip->frameCount - 1)
+			return false;
+		for (uint32_t k = 1; k < pTrack->keyCount; k++)
+		{
+			if (pKeyFrames[k] <= pKeyFrames[k - 1])
+				return false;
+		}
+	}
+	return true;
+}
+
+ASEXPORT asResults asAnimation_Relocate(void* pBlob, size_t size, asAnimation_t** ppAnimation)
+{
+	asAnimation_t* pAnim = (asAnimation_t*)pBlob;
+	if (size < sizeof(asAnimation_t) || (uintptr_t)pBlob % AS_ANIM_ALIGNMENT || memcmp(pAnim->tag, AS_ANIM_FILE_TAG, 4) != 0)
+		return AS_FAILURE_PARSE_ERROR;
+	if (pAnim->version != AS_ANIM_VERSION)
+		return AS_FAILURE_UNKNOWN_FORMAT;
+	if (pAnim->size != size)
+		return AS_FAILURE_PARSE_ERROR;
+	if (pAnim->relocated)
+	{
+		/*Already pointers, they have to point back into this blob*/
+		const uintptr_t start = (uintptr_t)pBlob;
+		const uintptr_t tables[4] = { (uintptr_t)pAnim->bones.ptr, (uintptr_t)pAnim->inverseBinds.ptr,
+			(uintptr_t)pAnim->restPose.ptr, (uintptr_t)pAnim->clips.ptr };
+		for (int i = 0; i < 4; i++)
+		{
+			if (tables[i] < start || tables[i] > start + size)
+				return AS_FAILURE_PARSE_ERROR;
+		}
+		*ppAnimation = pAnim;
+		return AS_SUCCESS;
+	}
+
+	/*Check the tables before anything is written so a bad blob is left as it was*/
+	if (pAnim->boneCount > AS_ANIM_MAX_BONES || pAnim->paletteCount > pAnim->boneCount ||
+		!_animRange(pAnim, pAnim->bones.offset, (uint64_t)sizeof(asAnimBone_t) * pAnim->boneCount, 8) ||
+		!_animRange(pAnim, pAnim->inverseBinds.offset, (uint64_t)sizeof(mat4) * pAnim->boneCount, AS_ANIM_ALIGNMENT) ||
+		!_animRange(pAnim, pAnim->restPose.offset, (uint64_t)sizeof(asAnimSoaTransform_t) * AS_ANIM_SOA_COUNT(pAnim->boneCount), AS_ANIM_ALIGNMENT) ||
+		!_animRange(pAnim, pAnim->clips.offset, (uint64_t)sizeof(asAnimClip_t) * pAnim->clipCount, 8))
+	{
+		return AS_FAILURE_PARSE_ERROR;
+	}
+	uint8_t* pBase = (uint8_t*)pBlob;
+	asAnimBone_t* pBones = (asAnimBone_t*)(pBase + pAnim->bones.offset);
+	asAnimClip_t* pClips = (asAnimClip_t*)(pBase + pAnim->clips.offset);
+	for (uint32_t i = 0; i < pAnim->boneCount; i++)
+	{
+		if (!_animString(pAnim, pBones[i].name.offset) || pBones[i].parent < -1 || pBones[i].parent >= (int32_t)i ||
+			(pBones[i].paletteIndex >= pAnim->paletteCount && pBones[i].paletteIndex != AS_ANIM_NO_PALETTE))
+		{
+			return AS_FAILURE_PARSE_ERROR;
+		}
+	}
+	for (uint32_t i = 0; i < pAnim->clipCount; i++)
+	{
+		if (!_animClipValid(pAnim, &pClips[i]))
+			return AS_FAILURE_PARSE_ERROR;
+	}
+
+	/*Offsets become pointers*/
+	for (uint32_t i = 0; i < pAnim->boneCount; i++)
+		pBones[i].name.ptr = (const char*)(pBase + pBones[i].name.offset);
+	for (uint32_t i = 0; i < pAnim->clipCount; i++)
+	{
+		pClips[i].name.ptr = (const char*)(pBase + pClips[i].name.offset);
+		pClips[i].tracks.ptr = (const asAnimTrack_t*)(pBase + pClips[i].tracks.offset);
+		pClips[i].keyFrames.ptr = (const uint16_t*)(pBase + pClips[i].keyFrames.offset);
+		pClips[i].keyValues.ptr = (const uint16_t*)(pBase + pClips[i].keyValues.offset);
+	}
+	pAnim->bones.ptr = pBones;
+	pAnim->inverseBinds.ptr = (const mat4*)(pBase + pAnim->inverseBinds.offset);
+	pAnim->restPose.ptr = (const asAnimSoaTransform_t*)(pBase + pAnim->restPose.offset);
+	pAnim->clips.ptr = pClips;
+	pAnim->relocated = 1;
+	*ppAnimation = pAnim;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asAnimation_LoadFile(const char* pPath, asAnimation_t** ppAnimation)
+{
+	FILE* fp = fopen(pPath, "rb");
+	if (!fp)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	fseek(fp, 0, SEEK_END);
+	const size_t size = (size_t)ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	void* pBlob = asMalloc(size ? size : 1);
+	if (!pBlob)
+	{
+		fclose(fp);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	const bool read = size && fread(pBlob, size, 1, fp) == 1;
+	fclose(fp);
+	asResults result = read ? asAnimation_Relocate(pBlob, size, ppAnimation) : AS_FAILURE_FILE_INACCESSIBLE;
+	if (result != AS_SUCCESS)
+		asFree(pBlob);
+	return result;
+}
+
+ASEXPORT const asAnimClip_t* asAnimation_FindClip(const asAnimation_t* pAnimation, const char* pName)
+{
+	for (uint32_t i = 0; i < pAnimation->clipCount; i++)
+	{
+		if (!strcmp(pAnimation->clips.ptr[i].name.ptr, pName))
+			return &pAnimation->clips.ptr[i];
+	}
+	return NULL;
+}
+
+ASEXPORT bool asAnimation_IsClipCompatible(const asAnimation_t* pSkeleton, const asAnimClip_t* pClip)
+{
+	return pClip->skeletonHash == pSkeleton->skeletonHash && pClip->boneCount == pSkeleton->boneCount;
+}
+
+/*------------------------------------SAMPLING------------------------------------*/
+
+ASEXPORT asResults asAnimSamplingCache_Init(asAnimSamplingCache_t* pCache, uint32_t boneCount)
+{
+	memset(pCache, 0, sizeof(asAnimSamplingCache_t));
+	pCache->trackCount = AS_ANIM_TRACK_COUNT * boneCount;
+	pCache->pCursors = asMalloc(sizeof(uint16_t) * (pCache->trackCount ? pCache->trackCount : 1));
+	if (!pCache->pCursors)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asAnimSamplingCache_Free(asAnimSamplingCache_t* pCache)
+{
+	asFree(pCache->pCursors);
+	memset(pCache, 0, sizeof(asAnimSamplingCache_t));
+}
+
+/*The two keys of each lane of a SoA group and how far between them the sample is*/
+typedef struct {
+	int32_t wordsA[3][4];
+	int32_t wordsB[3][4];
+	float rangeMin[3][4];
+	float rangeExtent[3][4];
+	float alpha[4];
+} _animLanes;
+
+/*Key before a frame (never the last key)*/
+static uint32_t _animFindKey(const uint16_t* pFrames, uint32_t keyCount, float frame, uint32_t cursor)
+{
+	if (cursor + 1 < keyCount && (float)pFrames[cursor] <= frame)
+	{
+		for (uint32_t step = 0; step < AS_ANIM_CURSOR_STEPS; step++)
+		{
+			if (cursor + 2 >= keyCount || (float)pFrames[cursor + 1] > frame)
+				return cursor;
+			cursor++;
+		}
+	}
+	uint32_t low = 0;
+	uint32_t high = keyCount - 1;
+	while (high - low > 1)
+	{
+		const uint32_t mid = (low + high) / 2;
+		if ((float)pFrames[mid] <= frame)
+			low = mid;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+static void _animGatherLane(const asAnimClip_t* pClip, const asAnimTrack_t* pTrack, asAnimTrackType type, float frame,
+	uint16_t* pCursor, _animLanes* pLanes, uint32_t lane)
+{
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		pLanes->wordsA[c][lane] = 0;
+		pLanes->wordsB[c][lane] = 0;
+		pLanes->rangeExtent[c][lane] = 0.0f;
+	}
+	pLanes->alpha[lane] = 0.0f;
+
+	/*Constant lanes decode to their minimum (rotations drop W)*/
+	if (!pTrack || !pTrack->keyCount)
+	{
+		const float identity = type == AS_ANIM_TRACK_SCALE ? 1.0f : 0.0f;
+		for (uint32_t c = 0; c < 3; c++)
+			pLanes->rangeMin[c][lane] = pTrack ? pTrack->rangeMin[c] : identity;
+		if (type == AS_ANIM_TRACK_ROTATION)
+		{
+			pLanes->wordsA[0][lane] = pLanes->wordsB[0][lane] = 0x8000;
+			pLanes->wordsA[1][lane] = pLanes->wordsB[1][lane] = 0x8000;
+		}
+		return;
+	}
+
+	const uint16_t* pFrames = &pClip->keyFrames.ptr[pTrack->firstKey];
+	const uint32_t key = _animFindKey(pFrames, pTrack->keyCount, frame, pCursor ? *pCursor : 0);
+	if (pCursor)
+		*pCursor = (uint16_t)key;
+	const uint16_t* pValues = &pClip->keyValues.ptr[(size_t)(pTrack->firstKey + key) * 3];
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		pLanes->wordsA[c][lane] = pValues[c];
+		pLanes->wordsB[c][lane] = pValues[3 + c];
+		pLanes->rangeMin[c][lane] = pTrack->rangeMin[c];
+		pLanes->rangeExtent[c][lane] = pTrack->rangeExtent[c];
+	}
+	const float alpha = (frame - (float)pFrames[key]) / (float)(pFrames[key + 1] - pFrames[key]);
+	pLanes->alpha[lane] = alpha < 1.0f ? alpha : 1.0f;
+}
+
+/*Scalar*/
+
+static void _animDecodeQuat(const _animLanes* pLanes, const int32_t words[3][4], uint32_t lane, float q[4])
+{
+	float s[3];
+	for (uint32_t c = 0; c < 3; c++)
+		s[c] = pLanes->rangeMin[c][lane] + pLanes->rangeExtent[c][lane] * ((float)(words[c][lane] & 0x7FFF) * (1.0f / 32767.0f));
+	const float d2 = 1.0f - ((s[0] * s[0] + s[1] * s[1]) + s[2] * s[2]);
+	const float d = sqrtf(d2 > 0.0f ? d2 : 0.0f);
+	const int32_t index = ((words[0][lane] >> 15) & 1) | (((words[1][lane] >> 15) & 1) << 1);
+	q[0] = index == 0 ? d : s[0];
+	q[1] = index == 0 ? s[0] : (index == 1 ? d : s[1]);
+	q[2] = index == 3 ? s[2] : (index == 2 ? d : s[1]);
+	q[3] = index == 3 ? d : s[2];
+}
+
+static void _animSampleRotationScalar(const _animLanes* pLanes, float pOut[4][4])
+{
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		float a[4], b[4], q[4];
+		_animDecodeQuat(pLanes, pLanes->wordsA, lane, a);
+		_animDecodeQuat(pLanes, pLanes->wordsB, lane, b);
+		/*Shortest path*/
+		const float dot = ((a[0] * b[0] + a[1] * b[1]) + a[2] * b[2]) + a[3] * b[3];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			if (dot < 0.0f)
+				b[c] = -b[c];
+			q[c] = a[c] + (b[c] - a[c]) * pLanes->alpha[lane];
+		}
+		const float invLength = 1.0f / sqrtf(((q[0] * q[0] + q[1] * q[1]) + q[2] * q[2]) + q[3] * q[3]);
+		for (uint32_t c = 0; c < 4; c++)
+			pOut[c][lane] = q[c] * invLength;
+	}
+}
+
+static void _animSampleVectorScalar(const _animLanes* pLanes, float pOut[3][4])
+{
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		for (uint32_t lane = 0; lane < 4; lane++)
+		{
+			const float a = pLanes->rangeMin[c][lane] + pLanes->rangeExtent[c][lane] * ((float)pLanes->wordsA[c][lane] * (1.0f / 65535.0f));
+			const float b = pLanes->rangeMin[c][lane] + pLanes->rangeExtent[c][lane] * ((float)pLanes->wordsB[c][lane] * (1.0f / 65535.0f));
+			pOut[c][lane] = a + (b - a) * pLanes->alpha[lane];
+		}
+	}
+}
+
+/*SSE2*/
+
+#if AS_ANIM_SSE2
+static __m128 _animSelect(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 _animDot4(const __m128 a[4], const __m128 b[4])
+{
+	return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2])), _mm_mul_ps(a[3], b[3]));
+}
+
+static __m128 _animDecodeSlot(const _animLanes* pLanes, const int32_t words[3][4], uint32_t c, __m128i valueMask, __m128 scale)
+{
+	const __m128 q = _mm_cvtepi32_ps(_mm_and_si128(_mm_loadu_si128((const __m128i*)words[c]), valueMask));
+	return _mm_add_ps(_mm_loadu_ps(pLanes->rangeMin[c]), _mm_mul_ps(_mm_loadu_ps(pLanes->rangeExtent[c]), _mm_mul_ps(q, scale)));
+}
+
+static void _animDecodeQuatSse2(const _animLanes* pLanes, const int32_t words[3][4], __m128 q[4])
+{
+	const __m128i valueMask = _mm_set1_epi32(0x7FFF);
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128 scale = _mm_set1_ps(1.0f / 32767.0f);
+	const __m128 s0 = _animDecodeSlot(pLanes, words, 0, valueMask, scale);
+	const __m128 s1 = _animDecodeSlot(pLanes, words, 1, valueMask, scale);
+	const __m128 s2 = _animDecodeSlot(pLanes, words, 2, valueMask, scale);
+	const __m128 d2 = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(s0, s0), _mm_mul_ps(s1, s1)), _mm_mul_ps(s2, s2)));
+	const __m128 d = _mm_sqrt_ps(_mm_max_ps(d2, _mm_setzero_ps()));
+	const __m128i index = _mm_or_si128(
+		_mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)words[0]), 15), one),
+		_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)words[1]), 15), one), 1));
+	const __m128 is0 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_setzero_si128()));
+	const __m128 is1 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, one));
+	const __m128 is2 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(2)));
+	const __m128 is3 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(3)));
+	q[0] = _animSelect(is0, d, s0);
+	q[1] = _animSelect(is0, s0, _animSelect(is1, d, s1));
+	q[2] = _animSelect(is3, s2, _animSelect(is2, d, s1));
+	q[3] = _animSelect(is3, d, s2);
+}
+
+static void _animSampleRotationSse2(const _animLanes* pLanes, float pOut[4][4])
+{
+	__m128 a[4], b[4];
+	_animDecodeQuatSse2(pLanes, pLanes->wordsA, a);
+	_animDecodeQuatSse2(pLanes, pLanes->wordsB, b);
+	const __m128 flip = _mm_and_ps(_mm_cmplt_ps(_animDot4(a, b), _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+	const __m128 alpha = _mm_loadu_ps(pLanes->alpha);
+	__m128 q[4];
+	for (uint32_t c = 0; c < 4; c++)
+		q[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(b[c], flip), a[c]), alpha));
+	const __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_animDot4(q, q)));
+	for (uint32_t c = 0; c < 4; c++)
+		_mm_storeu_ps(pOut[c], _mm_mul_ps(q[c], invLength));
+}
+
+static void _animSampleVectorSse2(const _animLanes* pLanes, float pOut[3][4])
+{
+	const __m128i valueMask = _mm_set1_epi32(0xFFFF);
+	const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+	const __m128 alpha = _mm_loadu_ps(pLanes->alpha);
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		const __m128 a = _animDecodeSlot(pLanes, pLanes->wordsA, c, valueMask, scale);
+		const __m128 b = _animDecodeSlot(pLanes, pLanes->wordsB, c, valueMask, scale);
+		_mm_storeu_ps(pOut[c], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), alpha)));
+	}
+}
+#endif
+
+ASEXPORT void asAnimation_SampleClip(const asAnimClip_t* pClip, float time, asAnimSamplingCache_t* pCache, asAnimSoaTransform_t* pOutPose)
+{
+	const uint32_t boneCount = pClip->boneCount;
+	const float lastFrame = (float)(pClip->frameCount - 1);
+	float frame = time * pClip->sampleRate;
+	frame = frame > 0.0f ? (frame < lastFrame ? frame : lastFrame) : 0.0f;
+
+	/*Cursors only carry over while the same clip plays*/
+	uint16_t* pCursors = NULL;
+	if (pCache && pCache->trackCount >= AS_ANIM_TRACK_COUNT * boneCount)
+	{
+		if (pCache->pClip != pClip)
+		{
+			memset(pCache->pCursors, 0, sizeof(uint16_t) * AS_ANIM_TRACK_COUNT * boneCount);
+			pCache->pClip = pClip;
+		}
+		pCursors = pCache->pCursors;
+	}
+
+	for (uint32_t type = 0; type < AS_ANIM_TRACK_COUNT; type++)
+	{
+		const asAnimTrack_t* pTracks = &pClip->tracks.ptr[type * boneCount];
+		for (uint32_t s = 0; s < AS_ANIM_SOA_COUNT(boneCount); s++)
+		{
+			_animLanes lanes;
+			for (uint32_t lane = 0; lane < 4; lane++)
+			{
+				const uint32_t bone = s * 4 + lane;
+				_animGatherLane(pClip, bone < boneCount ? &pTracks[bone] : NULL, (asAnimTrackType)type, frame,
+					pCursors && bone < boneCount ? &pCursors[type * boneCount + bone] : NULL, &lanes, lane);
+			}
+			asAnimSoaTransform_t* pOut = &pOutPose[s];
+#if AS_ANIM_SSE2
+			if (gAnimSimd)
+			{
+				if (type == AS_ANIM_TRACK_ROTATION)
+					_animSampleRotationSse2(&lanes, pOut->rotation);
+				else
+					_animSampleVectorSse2(&lanes, type == AS_ANIM_TRACK_TRANSLATION ? pOut->translation : pOut->scale);
+				continue;
+			}
+#endif
+			if (type == AS_ANIM_TRACK_ROTATION)
+				_animSampleRotationScalar(&lanes, pOut->rotation);
+			else
+				_animSampleVectorScalar(&lanes, type == AS_ANIM_TRACK_TRANSLATION ? pOut->translation : pOut->scale);
+		}
+	}
+}
+
+/*------------------------------------BLENDING------------------------------------*/
+
+static void _animBlendScalar(const asAnimSoaTransform_t* const* ppPoses, const float* pWeights, uint32_t poseCount, uint32_t s,
+	asAnimSoaTransform_t* pOut)
+{
+	asAnimSoaTransform_t result;
+	const asAnimSoaTransform_t* pFirst = &ppPoses[0][s];
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			result.rotation[c][lane] = pFirst->rotation[c][lane] * pWeights[0];
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			result.translation[c][lane] = pFirst->translation[c][lane] * pWeights[0];
+			result.scale[c][lane] = pFirst->scale[c][lane] * pWeights[0];
+		}
+		for (uint32_t p = 1; p < poseCount; p++)
+		{
+			const asAnimSoaTransform_t* pPose = &ppPoses[p][s];
+			const float dot = ((pFirst->rotation[0][lane] * pPose->rotation[0][lane] + pFirst->rotation[1][lane] * pPose->rotation[1][lane]) +
+				pFirst->rotation[2][lane] * pPose->rotation[2][lane]) + pFirst->rotation[3][lane] * pPose->rotation[3][lane];
+			const float rotationWeight = dot < 0.0f ? -pWeights[p] : pWeights[p];
+			for (uint32_t c = 0; c < 4; c++)
+				result.rotation[c][lane] = result.rotation[c][lane] + pPose->rotation[c][lane] * rotationWeight;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				result.translation[c][lane] = result.translation[c][lane] + pPose->translation[c][lane] * pWeights[p];
+				result.scale[c][lane] = result.scale[c][lane] + pPose->scale[c][lane] * pWeights[p];
+			}
+		}
+		const float invLength = 1.0f / sqrtf(((result.rotation[0][lane] * result.rotation[0][lane] + result.rotation[1][lane] * result.rotation[1][lane]) +
+			result.rotation[2][lane] * result.rotation[2][lane]) + result.rotation[3][lane] * result.rotation[3][lane]);
+		for (uint32_t c = 0; c < 4; c++)
+			result.rotation[c][lane] = result.rotation[c][lane] * invLength;
+	}
+	*pOut = result;
+}
+
+#if AS_ANIM_SSE2
+static void _animBlendSse2(const asAnimSoaTransform_t* const* ppPoses, const float* pWeights, uint32_t poseCount, uint32_t s,
+	asAnimSoaTransform_t* pOut)
+{
+	const asAnimSoaTransform_t* pFirst = &ppPoses[0][s];
+	__m128 first[4], rotation[4], translation[3], scale[3];
+	const __m128 firstWeight = _mm_set1_ps(pWeights[0]);
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		first[c] = _mm_loadu_ps(pFirst->rotation[c]);
+		rotation[c] = _mm_mul_ps(first[c], firstWeight);
+	}
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		translation[c] = _mm_mul_ps(_mm_loadu_ps(pFirst->translation[c]), firstWeight);
+		scale[c] = _mm_mul_ps(_mm_loadu_ps(pFirst->scale[c]), firstWeight);
+	}
+	for (uint32_t p = 1; p < poseCount; p++)
+	{
+		const asAnimSoaTransform_t* pPose = &ppPoses[p][s];
+		const __m128 weight = _mm_set1_ps(pWeights[p]);
+		__m128 pose[4];
+		for (uint32_t c = 0; c < 4; c++)
+			pose[c] = _mm_loadu_ps(pPose->rotation[c]);
+		const __m128 flip = _mm_and_ps(_mm_cmplt_ps(_animDot4(first, pose), _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+		const __m128 rotationWeight = _mm_xor_ps(weight, flip);
+		for (uint32_t c = 0; c < 4; c++)
+			rotation[c] = _mm_add_ps(rotation[c], _mm_mul_ps(pose[c], rotationWeight));
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			translation[c] = _mm_add_ps(translation[c], _mm_mul_ps(_mm_loadu_ps(pPose->translation[c]), weight));
+			scale[c] = _mm_add_ps(scale[c], _mm_mul_ps(_mm_loadu_ps(pPose->scale[c]), weight));
+		}
+	}
+	const __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_animDot4(rotation, rotation)));
+	for (uint32_t c = 0; c < 4; c++)
+		_mm_storeu_ps(pOut->rotation[c], _mm_mul_ps(rotation[c], invLength));
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		_mm_storeu_ps(pOut->translation[c], translation[c]);
+		_mm_storeu_ps(pOut->scale[c], scale[c]);
+	}
+}
+#endif
+
+ASEXPORT void asAnimation_BlendPoses(const asAnimation_t* pSkeleton, const asAnimSoaTransform_t* const* ppPoses, const float* pWeights,
+	uint32_t poseCount, asAnimSoaTransform_t* pOutPose)
+{
+	const uint32_t soaCount = AS_ANIM_SOA_COUNT(pSkeleton->boneCount);
+
+	/*Only poses with weight take part, normalized to add up to 1*/
+	const asAnimSoaTransform_t* pPoses[AS_ANIM_MAX_LAYERS];
+	float weights[AS_ANIM_MAX_LAYERS];
+	uint32_t count = 0;
+	float totalWeight = 0.0f;
+	for (uint32_t p = 0; p < poseCount && count < AS_ANIM_MAX_LAYERS; p++)
+	{
+		if (!(pWeights[p] > 0.0f))
+			continue;
+		pPoses[count] = ppPoses[p];
+		weights[count++] = pWeights[p];
+		totalWeight += pWeights[p];
+	}
+	if (count <= 1)
+	{
+		const asAnimSoaTransform_t* pSrc = count ? pPoses[0] : pSkeleton->restPose.ptr;
+		if (pSrc != pOutPose)
+			memmove(pOutPose, pSrc, sizeof(asAnimSoaTransform_t) * soaCount);
+		return;
+	}
+	for (uint32_t p = 0; p < count; p++)
+		weights[p] = weights[p] / totalWeight;
+
+	for (uint32_t s = 0; s < soaCount; s++)
+	{
+#if AS_ANIM_SSE2
+		if (gAnimSimd)
+		{
+			_animBlendSse2(pPoses, weights, count, s, &pOutPose[s]);
+			continue;
+		}
+#endif
+		_animBlendScalar(pPoses, weights, count, s, &pOutPose[s]);
+	}
+}
+
+/*------------------------------------MATRICES------------------------------------*/
+
+static void _animMatrixMulScalar(const float a[4][4], const float b[4][4], float out[4][4])
+{
+	for (uint32_t j = 0; j < 4; j++)
+	{
+		for (uint32_t r = 0; r < 4; r++)
+			out[j][r] = ((a[0][r] * b[j][0] + a[1][r] * b[j][1]) + a[2][r] * b[j][2]) + a[3][r] * b[j][3];
+	}
+}
+
+/*Matrices of the 4 lanes of a SoA transform as [column][row][lane]*/
+static void _animSoaMatrixScalar(const asAnimSoaTransform_t* pSoa, float m[4][4][4])
+{
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		const float x = pSoa->rotation[0][lane], y = pSoa->rotation[1][lane], z = pSoa->rotation[2][lane], w = pSoa->rotation[3][lane];
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z;
+		const float wx = w * x, wy = w * y, wz = w * z;
+		const float sx = pSoa->scale[0][lane], sy = pSoa->scale[1][lane], sz = pSoa->scale[2][lane];
+		m[0][0][lane] = (1.0f - 2.0f * (yy + zz)) * sx;
+		m[0][1][lane] = (2.0f * (xy + wz)) * sx;
+		m[0][2][lane] = (2.0f * (xz - wy)) * sx;
+		m[1][0][lane] = (2.0f * (xy - wz)) * sy;
+		m[1][1][lane] = (1.0f - 2.0f * (xx + zz)) * sy;
+		m[1][2][lane] = (2.0f * (yz + wx)) * sy;
+		m[2][0][lane] = (2.0f * (xz + wy)) * sz;
+		m[2][1][lane] = (2.0f * (yz - wx)) * sz;
+		m[2][2][lane] = (1.0f - 2.0f * (xx + yy)) * sz;
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			m[c][3][lane] = 0.0f;
+			m[3][c][lane] = pSoa->translation[c][lane];
+		}
+		m[3][3][lane] = 1.0f;
+	}
+}
+
+static void _animLocalMatricesScalar(const asAnimSoaTransform_t* pSoa, float pOut[4][4][4])
+{
+	float m[4][4][4];
+	_animSoaMatrixScalar(pSoa, m);
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			for (uint32_t r = 0; r < 4; r++)
+				pOut[lane][c][r] = m[c][r][lane];
+		}
+	}
+}
+
+#if AS_ANIM_SSE2
+static void _animMatrixMulSse2(const float a[4][4], const float b[4][4], float out[4][4])
+{
+	const __m128 a0 = _mm_loadu_ps(a[0]), a1 = _mm_loadu_ps(a[1]), a2 = _mm_loadu_ps(a[2]), a3 = _mm_loadu_ps(a[3]);
+	for (uint32_t j = 0; j < 4; j++)
+	{
+		const __m128 column = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(a0, _mm_set1_ps(b[j][0])), _mm_mul_ps(a1, _mm_set1_ps(b[j][1]))),
+			_mm_mul_ps(a2, _mm_set1_ps(b[j][2]))), _mm_mul_ps(a3, _mm_set1_ps(b[j][3])));
+		_mm_storeu_ps(out[j], column);
+	}
+}
+
+static void _animLocalMatricesSse2(const asAnimSoaTransform_t* pSoa, float pOut[4][4][4])
+{
+	const __m128 x = _mm_loadu_ps(pSoa->rotation[0]), y = _mm_loadu_ps(pSoa->rotation[1]);
+	const __m128 z = _mm_loadu_ps(pSoa->rotation[2]), w = _mm_loadu_ps(pSoa->rotation[3]);
+	const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+	const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+	const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+	const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+	const __m128 sx = _mm_loadu_ps(pSoa->scale[0]), sy = _mm_loadu_ps(pSoa->scale[1]), sz = _mm_loadu_ps(pSoa->scale[2]);
+	__m128 columns[4][4] = {
+		{ _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx), zero },
+		{ _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+			_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy), zero },
+		{ _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+			_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+			_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz), zero },
+		{ _mm_loadu_ps(pSoa->translation[0]), _mm_loadu_ps(pSoa->translation[1]), _mm_loadu_ps(pSoa->translation[2]), one },
+	};
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		_MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+		for (uint32_t lane = 0; lane < 4; lane++)
+			_mm_storeu_ps(pOut[lane][c], columns[c][lane]);
+	}
+}
+#endif
+
+ASEXPORT void asAnimation_LocalToModel(const asAnimation_t* pSkeleton, const asAnimSoaTransform_t* pLocalPose, mat4* pOutMatrices)
+{
+	const asAnimBone_t* pBones = pSkeleton->bones.ptr;
+	const uint32_t boneCount = pSkeleton->boneCount;
+	for (uint32_t s = 0; s < AS_ANIM_SOA_COUNT(boneCount); s++)
+	{
+		float local[4][4][4];
+#if AS_ANIM_SSE2
+		if (gAnimSimd)
+			_animLocalMatricesSse2(&pLocalPose[s], local);
+		else
+#endif
+			_animLocalMatricesScalar(&pLocalPose[s], local);
+
+		/*Parents always come first so their model matrices are done*/
+		for (uint32_t lane = 0; lane < 4 && s * 4 + lane < boneCount; lane++)
+		{
+			const uint32_t bone = s * 4 + lane;
+			const int32_t parent = pBones[bone].parent;
+			if (parent < 0)
+			{
+				memcpy(pOutMatrices[bone], local[lane], sizeof(mat4));
+				continue;
+			}
+#if AS_ANIM_SSE2
+			if (gAnimSimd)
+			{
+				_animMatrixMulSse2(pOutMatrices[parent], local[lane], pOutMatrices[bone]);
+				continue;
+			}
+#endif
+			_animMatrixMulScalar(pOutMatrices[parent], local[lane], pOutMatrices[bone]);
+		}
+	}
+}
+
+ASEXPORT void asAnimation_WritePalette(const asAnimation_t* pSkeleton, const mat4* pModelMatrices, asAnimPaletteMatrix_t* pOutPalette)
+{
+	const asAnimBone_t* pBones = pSkeleton->bones.ptr;
+	for (uint32_t bone = 0; bone < pSkeleton->boneCount; bone++)
+	{
+		const uint32_t paletteIndex = pBones[bone].paletteIndex;
+		if (paletteIndex == AS_ANIM_NO_PALETTE)
+			continue;
+		float skin[4][4];
+		asAnimPaletteMatrix_t* pOut = &pOutPalette[paletteIndex];
+#if AS_ANIM_SSE2
+		if (gAnimSimd)
+		{
+			_animMatrixMulSse2(pModelMatrices[bone], pSkeleton->inverseBinds.ptr[bone], skin);
+			__m128 c0 = _mm_loadu_ps(skin[0]), c1 = _mm_loadu_ps(skin[1]), c2 = _mm_loadu_ps(skin[2]), c3 = _mm_loadu_ps(skin[3]);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(pOut->rows[0], c0);
+			_mm_storeu_ps(pOut->rows[1], c1);
+			_mm_storeu_ps(pOut->rows[2], c2);
+			continue;
+		}
+#endif
+		_animMatrixMulScalar(pModelMatrices[bone], pSkeleton->inverseBinds.ptr[bone], skin);
+		for (uint32_t r = 0; r < 3; r++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+				pOut->rows[r][c] = skin[c][r];
+		}
+	}
+}
+
+/*------------------------------------EVALUATION------------------------------------*/
+
+/*Poses and matrices reused for every skeleton a job evaluates*/
+typedef struct {
+	uint32_t boneCapacity;
+	asAnimSoaTransform_t* pLayerPoses;
+	asAnimSoaTransform_t* pPose;
+	mat4* pModelMatrices;
+	void* pMemory;
+} _animScratch;
+
+static bool _animScratchReserve(_animScratch* pScratch, uint32_t boneCount)
+{
+	if (pScratch->pMemory && boneCount <= pScratch->boneCapacity)
+		return true;
+	asFree(pScratch->pMemory);
+	const size_t soaCount = AS_ANIM_SOA_COUNT(boneCount);
+	const size_t poseSize = sizeof(asAnimSoaTransform_t) * soaCount;
+	pScratch->pMemory = asMalloc(sizeof(mat4) * (boneCount + 1) + poseSize * (AS_ANIM_MAX_LAYERS + 1));
+	if (!pScratch->pMemory)
+	{
+		pScratch->boneCapacity = 0;
+		return false;
+	}
+	/*Matrices first so they stay 16 byte aligned*/
+	uint8_t* pBase = (uint8_t*)(((uintptr_t)pScratch->pMemory + 15) & ~(uintptr_t)15);
+	pScratch->pModelMatrices = (mat4*)pBase;
+	pScratch->pLayerPoses = (asAnimSoaTransform_t*)(pBase + sizeof(mat4) * boneCount);
+	pScratch->pPose = pScratch->pLayerPoses + soaCount * AS_ANIM_MAX_LAYERS;
+	pScratch->boneCapacity = boneCount;
+	return true;
+}
+
+static asResults _animEvaluate(const asAnimEvaluateDesc_t* pDesc, _animScratch* pScratch)
+{
+	const asAnimation_t* pSkeleton = pDesc->pSkeleton;
+	if (!pSkeleton || !pDesc->pPalette || pDesc->layerCount > AS_ANIM_MAX_LAYERS)
+		return AS_FAILURE_INVALID_PARAM;
+	for (uint32_t l = 0; l < pDesc->layerCount; l++)
+	{
+		if (!pDesc->layers[l].pClip || !asAnimation_IsClipCompatible(pSkeleton, pDesc->layers[l].pClip))
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	if (!_animScratchReserve(pScratch, pSkeleton->boneCount))
+		return AS_FAILURE_OUT_OF_MEMORY;
+
+	/*Layers without weight are not sampled*/
+	const uint32_t soaCount = AS_ANIM_SOA_COUNT(pSkeleton->boneCount);
+	const asAnimSoaTransform_t* pPoses[AS_ANIM_MAX_LAYERS];
+	float weights[AS_ANIM_MAX_LAYERS];
+	for (uint32_t l = 0; l < pDesc->layerCount; l++)
+	{
+		const asAnimLayer_t* pLayer = &pDesc->layers[l];
+		weights[l] = pLayer->weight;
+		pPoses[l] = pSkeleton->restPose.ptr;
+		if (!(pLayer->weight > 0.0f))
+			continue;
+		asAnimSoaTransform_t* pPose = &pScratch->pLayerPoses[soaCount * l];
+		asAnimation_SampleClip(pLayer->pClip, pLayer->time, pLayer->pCache, pPose);
+		pPoses[l] = pPose;
+	}
+	asAnimation_BlendPoses(pSkeleton, pPoses, weights, pDesc->layerCount, pScratch->pPose);
+
+	mat4* pModelMatrices = pDesc->pModelMatrices ? pDesc->pModelMatrices : pScratch->pModelMatrices;
+	asAnimation_LocalToModel(pSkeleton, pScratch->pPose, pModelMatrices);
+	asAnimation_WritePalette(pSkeleton, pModelMatrices, pDesc->pPalette);
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asAnimation_Evaluate(const asAnimEvaluateDesc_t* pDesc)
+{
+	_animScratch scratch;
+	memset(&scratch, 0, sizeof(scratch));
+	asResults result = _animEvaluate(pDesc, &scratch);
+	asFree(scratch.pMemory);
+	return result;
+}
+
+typedef struct {
+	const asAnimEvaluateDesc_t* pDescs;
+	size_t count;
+	asResults result;
+} _animBatchJob;
+
+static void _animBatchJobEntry(void* pUserData)
+{
+	_animBatchJob* pJob = (_animBatchJob*)pUserData;
+	_animScratch scratch;
+	memset(&scratch, 0, sizeof(scratch));
+	pJob->result = AS_SUCCESS;
+	for (size_t i = 0; i < pJob->count; i++)
+	{
+		asResults result = _animEvaluate(&pJob->pDescs[i], &scratch);
+		if (pJob->result == AS_SUCCESS)
+			pJob->result = result;
+	}
+	asFree(scratch.pMemory);
+}
+
+ASEXPORT asResults asAnimation_EvaluateBatch(const asAnimEvaluateDesc_t* pDescs, size_t count)
+{
+	if (!count)
+		return AS_SUCCESS;
+	const size_t jobCount = asJobSystem_GetWorkerCount() ? (count + AS_ANIM_BATCH_SIZE - 1) / AS_ANIM_BATCH_SIZE : 1;
+	if (jobCount == 1)
+	{
+		_animBatchJob job = { pDescs, count, AS_SUCCESS };
+		_animBatchJobEntry(&job);
+		return job.result;
+	}
+
+	_animBatchJob* pBatches = asMalloc(sizeof(_animBatchJob) * jobCount);
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * jobCount);
+	if (!pBatches || !pJobs)
+	{
+		asFree(pBatches);
+		asFree(pJobs);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (size_t i = 0; i < jobCount; i++)
+	{
+		const size_t first = i * AS_ANIM_BATCH_SIZE;
+		pBatches[i].pDescs = &pDescs[first];
+		pBatches[i].count = count - first < AS_ANIM_BATCH_SIZE ? count - first : AS_ANIM_BATCH_SIZE;
+		pBatches[i].result = AS_SUCCESS;
+		pJobs[i].fpEntry = _animBatchJobEntry;
+		pJobs[i].pUserData = &pBatches[i];
+	}
+	asJobCounter counter;
+	asJobSystem_CreateCounter(&counter);
+	asJobSystem_Dispatch(pJobs, jobCount, counter);
+	asJobSystem_WaitForCounter(counter);
+	asJobSystem_ReleaseCounter(counter);
+
+	asResults result = AS_SUCCESS;
+	for (size_t i = 0; i < jobCount && result == AS_SUCCESS; i++)
+		result = pBatches[i].result;
+	asFree(pBatches);
+	asFree(pJobs);
+	return result;
+}
+
+/*------------------------------------GPU PALETTES------------------------------------*/
+
+struct asAnimPaletteBufferT
+{
+	uint32_t matrixCount;
+	uint32_t matrixMax;
+	asAnimPaletteMatrix_t* pMatrices;
+	void* _bufferMappings[AS_MAX_INFLIGHT];
+	asBufferHandle_t buffers[AS_MAX_INFLIGHT];
+
+	int32_t currentFrame;
+	int32_t populatedFrame; /*Buffer holding the palettes of the last populate*/
+};
+
+ASEXPORT asResults asAnimPaletteBufferCreate(asAnimPaletteBuffer* pBuffer, uint32_t maxMatrices)
+{
+	asAnimPaletteBuffer buffer = asMalloc(sizeof(struct asAnimPaletteBufferT));
+	ASASSERT(buffer);
+	memset(buffer, 0, sizeof(struct asAnimPaletteBufferT));
+	buffer->matrixMax = maxMatrices;
+
+	asBufferDesc_t paletteBuffDesc = asBufferDesc_Init();
+	paletteBuffDesc.bufferSize = maxMatrices * sizeof(asAnimPaletteMatrix_t);
+	paletteBuffDesc.pDebugLabel = "PaletteBuffer";
+	paletteBuffDesc.usageFlags = AS_BUFFERUSAGE_STORAGE;
+	paletteBuffDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
+
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		buffer->buffers[i] = asCreateBuffer(&paletteBuffDesc);
+		#if ASTRENGINE_VK
+		asVkAllocation_t paletteAlloc = asVkGetAllocFromBuffer(buffer->buffers[i]);
+		asVkMapMemory(paletteAlloc, 0, paletteAlloc.size, &buffer->_bufferMappings[i]);
+		#endif
+	}
+
+	*pBuffer = buffer;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asAnimPaletteBufferDestroy(asAnimPaletteBuffer buffer)
+{
+	if (!buffer)
+		return;
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		if (!asHandleValid(buffer->buffers[i])) {
+			continue;
+		}
+		#if ASTRENGINE_VK
+		asVkUnmapMemory(asVkGetAllocFromBuffer(buffer->buffers[i]));
+		#endif
+		asReleaseBuffer(buffer->buffers[i]);
+	}
+	asFree(buffer);
+}
+
+ASEXPORT asResults asAnimPaletteBufferPopulateBegin(asAnimPaletteBuffer buffer)
+{
+	buffer->pMatrices = (asAnimPaletteMatrix_t*)buffer->_bufferMappings[buffer->currentFrame];
+	buffer->matrixCount = 0;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asAnimPaletteBufferAllocate(asAnimPaletteBuffer buffer, uint32_t matrixCount, asAnimPaletteMatrix_t** ppMatrices, uint32_t* pOffset)
+{
+	if (!buffer->pMatrices || buffer->matrixCount + matrixCount > buffer->matrixMax) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	*ppMatrices = buffer->pMatrices + buffer->matrixCount;
+	if (pOffset) { *pOffset = buffer->matrixCount; }
+	buffer->matrixCount += matrixCount;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asAnimPaletteBufferPopulateEnd(asAnimPaletteBuffer buffer)
+{
+	#if ASTRENGINE_VK
+	asVkAllocation_t paletteAlloc = asVkGetAllocFromBuffer(buffer->buffers[buffer->currentFrame]);
+	asVkFlushMemory(paletteAlloc);
+	buffer->populatedFrame = buffer->currentFrame;
+	buffer->currentFrame = asVkCurrentFrame;
+	#endif
+	buffer->pMatrices = NULL;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asBufferHandle_t asAnimPaletteBufferGetBuffer(asAnimPaletteBuffer buffer)
+{
+	return buffer->buffers[buffer->populatedFrame];
+}
@@ -0,0 +1,273 @@
+#ifndef _ASANIMATION_H_
+#define _ASANIMATION_H_
+
+#include "../common/asCommon.h"
+#include "../renderer/asRendererCore.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Skeletal animation runtime: compressed clips are sampled, blended and turned into matrix palettes for skinning
+* Poses are kept as SoA transforms of 4 bones so sampling, blending and matrix building run 4 bones at a time with SSE2
+* (every step has a scalar path that does the same math in the same order)
+* Batches of skeletons are split across the job workers, each one writes its palette straight into (mapped GPU) memory
+*/
+
+/*------------------------------------FORMAT------------------------------------*/
+
+/**
+* @brief asAnim files are a single blob used right where it is loaded:
+* asAnimation_t at the start followed by the bones, inverse bind matrices, rest pose and clips (each AS_ANIM_ALIGNMENT aligned)
+* Pointers are stored as offsets from the start of the blob and are turned into pointers in place by asAnimation_Relocate()
+* Clips are curve fit to keyframes between which the runtime interpolates linearly (normalized for rotations),
+* rotations are quantized as the smallest three components at 15 bits and translations and scales at 16 bits over the range of each track
+*/
+#define AS_ANIM_FILE_TAG "AANM"
+#define AS_ANIM_VERSION 1
+#define AS_ANIM_ALIGNMENT 16
+#define AS_ANIM_MAX_NAME 64
+#define AS_ANIM_MAX_BONES 1024
+#define AS_ANIM_MAX_FRAMES 65535
+#define AS_ANIM_MAX_LAYERS 4
+#define AS_ANIM_NO_PALETTE UINT32_MAX
+
+/**
+* @brief A pointer stored as an offset from the start of the blob (use ptr after relocation)
+*/
+#define AS_ANIM_POINTER(_type) union { uint64_t offset; _type* ptr; }
+
+/**
+* @brief Local transforms of 4 bones as structure of arrays (lanes past the last bone are identity)
+*/
+typedef struct {
+	float rotation[4][4]; /**< Quaternion XYZW of each lane*/
+	float translation[3][4];
+	float scale[3][4];
+} asAnimSoaTransform_t;
+
+/**
+* @brief Number of asAnimSoaTransform_t needed for a pose of a skeleton
+*/
+#define AS_ANIM_SOA_COUNT(_boneCount) (((_boneCount) + 3) / 4)
+
+/**
+* @brief Skinning matrix as the first three rows of a column major affine matrix (std430 vec4[3])
+*/
+typedef struct {
+	float rows[3][4];
+} asAnimPaletteMatrix_t;
+
+/**
+* @brief Channels animated for every bone
+*/
+typedef enum {
+	AS_ANIM_TRACK_ROTATION,
+	AS_ANIM_TRACK_TRANSLATION,
+	AS_ANIM_TRACK_SCALE,
+	AS_ANIM_TRACK_COUNT,
+	AS_ANIM_TRACK_MAX = UINT32_MAX
+} asAnimTrackType;
+
+/**
+* @brief A bone of the skeleton, parents always come before their children
+*/
+typedef struct {
+	AS_ANIM_POINTER(const char) name;
+	int32_t parent; /**< -1 for roots*/
+	uint32_t paletteIndex; /**< Skin joint the bone is written to (AS_ANIM_NO_PALETTE when it only moves its children)*/
+} asAnimBone_t;
+
+/**
+* @brief Keys of one channel of one bone
+* Keys hold 3 words each, rotation words carry 15 bits of a component and the words 0 and 1 carry the index of the dropped component in their top bit
+* a value decodes as rangeMin + rangeExtent * word / (2^bits - 1)
+*/
+typedef struct {
+	float rangeMin[4]; /**< The value itself when the track is constant (rotations as XYZ with a positive W)*/
+	float rangeExtent[4];
+	uint32_t firstKey; /**< Into the key tables of the clip*/
+	uint32_t keyCount; /**< 0 when constant, otherwise at least 2 (on the first and last frame)*/
+} asAnimTrack_t;
+
+/**
+* @brief A clip of every bone of a skeleton
+*/
+typedef struct {
+	AS_ANIM_POINTER(const char) name;
+	uint64_t skeletonHash; /**< Clips only play on skeletons with the same hash*/
+	uint32_t boneCount;
+	uint32_t frameCount; /**< At least 1*/
+	float sampleRate; /**< Frames per second*/
+	float duration; /**< Seconds from the first frame to the last*/
+	uint32_t keyCount;
+	uint32_t _reserved;
+	AS_ANIM_POINTER(const asAnimTrack_t) tracks; /**< AS_ANIM_TRACK_COUNT * boneCount, every bone of a type before the next type*/
+	AS_ANIM_POINTER(const uint16_t) keyFrames; /**< Frame of each key*/
+	AS_ANIM_POINTER(const uint16_t) keyValues; /**< Three words per key*/
+} asAnimClip_t;
+
+/**
+* @brief A whole animation file (a skeleton and the clips made for it)
+*/
+typedef struct {
+	char tag[4]; /**< AS_ANIM_FILE_TAG*/
+	uint32_t version;
+	uint64_t size; /**< Of the whole blob*/
+	uint64_t skeletonHash; /**< Of the names and parents of the bones*/
+	uint32_t boneCount;
+	uint32_t paletteCount; /**< Matrices written for each pose*/
+	uint32_t clipCount;
+	uint32_t relocated; /**< Offsets have been turned into pointers*/
+	AS_ANIM_POINTER(const asAnimBone_t) bones;
+	AS_ANIM_POINTER(const mat4) inverseBinds; /**< Model space to bone space of every bone*/
+	AS_ANIM_POINTER(const asAnimSoaTransform_t) restPose; /**< AS_ANIM_SOA_COUNT(boneCount)*/
+	AS_ANIM_POINTER(const asAnimClip_t) clips;
+} asAnimation_t;
+
+/**
+* @brief Turn the offsets of an animation blob into pointers in place (nothing is copied)
+* @param pBlob the whole file at an AS_ANIM_ALIGNMENT aligned address, it is the animation from then on
+* @return AS_FAILURE_PARSE_ERROR if the blob is not a valid animation, AS_FAILURE_UNKNOWN_FORMAT for other versions
+*/
+ASEXPORT asResults asAnimation_Relocate(void* pBlob, size_t size, asAnimation_t** ppAnimation);
+
+/**
+* @brief Load an animation file with a single read and relocate it
+* @warning free the animation with asFree()
+*/
+ASEXPORT asResults asAnimation_LoadFile(const char* pPath, asAnimation_t** ppAnimation);
+
+/**
+* @brief Find a clip by name (NULL if there is none)
+*/
+ASEXPORT const asAnimClip_t* asAnimation_FindClip(const asAnimation_t* pAnimation, const char* pName);
+
+/**
+* @brief Whether a clip (possibly from another file) can play on the skeleton of an animation
+*/
+ASEXPORT bool asAnimation_IsClipCompatible(const asAnimation_t* pSkeleton, const asAnimClip_t* pClip);
+
+/*------------------------------------POSES------------------------------------*/
+
+/**
+* @brief Use the SSE2 paths (on by default where available), for testing and benchmarks
+* @return whether the SSE2 paths are in use
+*/
+ASEXPORT bool asAnimation_SetSimdEnabled(bool enabled);
+
+/**
+* @brief Key each track of a clip was last sampled from, so playing forward does not search for keys
+*/
+typedef struct {
+	const asAnimClip_t* pClip; /**< Clip the cursors belong to (they reset when it changes)*/
+	uint32_t trackCount;
+	uint16_t* pCursors;
+} asAnimSamplingCache_t;
+
+/**
+* @brief Allocate the cursors for clips of up to boneCount bones
+*/
+ASEXPORT asResults asAnimSamplingCache_Init(asAnimSamplingCache_t* pCache, uint32_t boneCount);
+ASEXPORT void asAnimSamplingCache_Free(asAnimSamplingCache_t* pCache);
+
+/**
+* @brief Sample the local pose of a clip
+* @param time seconds clamped to the clip (wrap looping clips before)
+* @param pCache optional, sampling forward from the last time is faster with it
+* @param pOutPose AS_ANIM_SOA_COUNT(boneCount) transforms
+*/
+ASEXPORT void asAnimation_SampleClip(const asAnimClip_t* pClip, float time, asAnimSamplingCache_t* pCache, asAnimSoaTransform_t* pOutPose);
+
+/**
+* @brief Blend local poses by weight (weights are normalized, rotations are blended on the side of the first pose)
+* the rest pose is written when no weight is above 0
+* @param pOutPose may be one of the poses
+*/
+ASEXPORT void asAnimation_BlendPoses(const asAnimation_t* pSkeleton, const asAnimSoaTransform_t* const* ppPoses, const float* pWeights,
+	uint32_t poseCount, asAnimSoaTransform_t* pOutPose);
+
+/**
+* @brief Concatenate a local pose down the hierarchy into model space matrices
+* @param pOutMatrices one per bone
+*/
+ASEXPORT void asAnimation_LocalToModel(const asAnimation_t* pSkeleton, const asAnimSoaTransform_t* pLocalPose, mat4* pOutMatrices);
+
+/**
+* @brief Skinning matrices (model matrix times inverse bind) of the bones with a palette index
+* @param pOutPalette paletteCount matrices
+*/
+ASEXPORT void asAnimation_WritePalette(const asAnimation_t* pSkeleton, const mat4* pModelMatrices, asAnimPaletteMatrix_t* pOutPalette);
+
+/*------------------------------------EVALUATION------------------------------------*/
+
+/**
+* @brief A clip sampled into a pose
+*/
+typedef struct {
+	const asAnimClip_t* pClip;
+	float time; /**< Seconds*/
+	float weight;
+	asAnimSamplingCache_t* pCache; /**< Optional, owned by the caller and used by one skeleton at a time*/
+} asAnimLayer_t;
+
+/**
+* @brief Everything needed to turn the clips playing on one skeleton into its palette
+*/
+typedef struct {
+	const asAnimation_t* pSkeleton;
+	uint32_t layerCount; /**< 0 writes the rest pose*/
+	asAnimLayer_t layers[AS_ANIM_MAX_LAYERS];
+	asAnimPaletteMatrix_t* pPalette; /**< paletteCount matrices of the skeleton*/
+	mat4* pModelMatrices; /**< Optional, filled with the model space matrix of every bone*/
+} asAnimEvaluateDesc_t;
+
+/**
+* @brief Sample, blend and write the palette of a single skeleton on the calling thread
+* @return AS_FAILURE_INVALID_PARAM if a clip does not fit the skeleton
+*/
+ASEXPORT asResults asAnimation_Evaluate(const asAnimEvaluateDesc_t* pDesc);
+
+/**
+* @brief Evaluate many skeletons split across the job workers and wait for them (the calling thread helps)
+* @return the first failure of any skeleton (the others are still written)
+*/
+ASEXPORT asResults asAnimation_EvaluateBatch(const asAnimEvaluateDesc_t* pDescs, size_t count);
+
+/*------------------------------------GPU PALETTES------------------------------------*/
+
+/**
+* @brief Storage buffer the palettes of a frame are written into (one per frame in flight, persistently mapped)
+*/
+typedef struct asAnimPaletteBufferT* asAnimPaletteBuffer;
+
+ASEXPORT asResults asAnimPaletteBufferCreate(asAnimPaletteBuffer* pBuffer, uint32_t maxMatrices);
+ASEXPORT void asAnimPaletteBufferDestroy(asAnimPaletteBuffer buffer);
+
+/**
+* @brief Start filling the buffer of the current frame
+*/
+ASEXPORT asResults asAnimPaletteBufferPopulateBegin(asAnimPaletteBuffer buffer);
+
+/**
+* @brief Reserve room for a palette (point asAnimEvaluateDesc_t::pPalette at it)
+* @param pOffset filled with the index of the first matrix in the buffer
+* @return AS_FAILURE_OUT_OF_BOUNDS when the buffer is full
+*/
+ASEXPORT asResults asAnimPaletteBufferAllocate(asAnimPaletteBuffer buffer, uint32_t matrixCount, asAnimPaletteMatrix_t** ppMatrices, uint32_t* pOffset);
+
+/**
+* @brief Make the palettes visible to the GPU (after the evaluation is done)
+*/
+ASEXPORT asResults asAnimPaletteBufferPopulateEnd(asAnimPaletteBuffer buffer);
+
+/**
+* @brief Buffer holding the palettes of the last populate
+*/
+ASEXPORT asBufferHandle_t asAnimPaletteBufferGetBuffer(asAnimPaletteBuffer buffer);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -22,7 +22,7 @@ ASEXPORT asResults asBinWriterOpen(asBinWriter* pWriter, char fileTag[4], const
 	}
 
 	/*Create Section List*/
-	const size_t memListSize = (sizeof(asBinSectionContent) + sizeof(asHash32_t)) * sectionCapacity;
+	const size_t memListSize = (sizeof(asBinSectionContent) + sizeof(asBinSectionIdentifier)) * sectionCapacity;
 	pWriter->_inMemoryList = asMalloc(memListSize);
 	ASASSERT(pWriter->_inMemoryList);
 	memset(pWriter->_inMemoryList, 0, memListSize);
@@ -3,6 +3,8 @@
 #include "asOsEvents.h"
 #include "../renderer/asRendererCore.h"
 #include "../resource/asUserFiles.h"
+#include "../resource/asResourceTrace.h"
+#include "../thread/asJobSystem.h"
 #include "../input/asInput.h"
 #include "../common/preferences/asPreferences.h"
 #if ASTRENGINE_NUKLEAR
@@ -73,6 +75,9 @@ ASEXPORT int asIgnite(int argc, char *argv[], asAppInfo_t *pAppInfo, void *pCust
 	/*Console Global Preferences*/
 	asGuiToolCommandConsole_RegisterPrefManager(pPrefMan, "as");
 
+	/*Job System*/
+	asInitJobSystem(0);
+
 	/*Resource*/
 	asInitResource();
 
@@ -110,6 +115,7 @@ ASEXPORT void asShutdown(void)
 #endif
 	asShutdownGfx();
 	asShutdownResource();
+	asShutdownJobSystem();
 	
 	asPreferencesSaveSectionsToIni(asGetGlobalPrefs(), GLOBAL_INI_NAME);
 	asPreferenceManagerDestroy(asGetGlobalPrefs());
@@ -150,6 +156,7 @@ ASEXPORT int asLoopSingleShot(double time, asLoopDesc_t loopDesc)
 #endif
 	asInputSystemNextFrame();
 	asPollOSEvents();
+	asResourcePrefetch_Update();
 	asGfxRenderFrame();
 #if ASTRENGINE_DEARIMGUI
 	asImGuiNewFrame(time);
@@ -0,0 +1,530 @@
+#include "asAnimationBuilder.h"
+
+#include <math.h>
+#include <float.h>
+
+ASEXPORT asAnimBuilderCompressDesc_t asAnimBuilderCompressDesc_Init()
+{
+	asAnimBuilderCompressDesc_t desc;
+	desc.rotationTolerance = 0.0005f;
+	desc.translationTolerance = 0.0001f;
+	desc.scaleTolerance = 0.0001f;
+	return desc;
+}
+
+/*Decoding (the same math in the same order as the scalar path of the runtime)*/
+
+static void _animDecodeKey(asAnimTrackType type, const asAnimTrack_t* pTrack, const uint16_t words[3], float out[4])
+{
+	if (type != AS_ANIM_TRACK_ROTATION)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+			out[c] = pTrack->rangeMin[c] + pTrack->rangeExtent[c] * ((float)words[c] * (1.0f / 65535.0f));
+		out[3] = 0.0f;
+		return;
+	}
+	float s[3];
+	for (uint32_t c = 0; c < 3; c++)
+		s[c] = pTrack->rangeMin[c] + pTrack->rangeExtent[c] * ((float)(words[c] & 0x7FFF) * (1.0f / 32767.0f));
+	const float d2 = 1.0f - ((s[0] * s[0] + s[1] * s[1]) + s[2] * s[2]);
+	const float d = sqrtf(d2 > 0.0f ? d2 : 0.0f);
+	const int32_t index = ((words[0] >> 15) & 1) | (((words[1] >> 15) & 1) << 1);
+	out[0] = index == 0 ? d : s[0];
+	out[1] = index == 0 ? s[0] : (index == 1 ? d : s[1]);
+	out[2] = index == 3 ? s[2] : (index == 2 ? d : s[1]);
+	out[3] = index == 3 ? d : s[2];
+}
+
+static void _animInterpolate(asAnimTrackType type, const float a[4], const float b[4], float alpha, float out[4])
+{
+	if (type != AS_ANIM_TRACK_ROTATION)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+			out[c] = a[c] + (b[c] - a[c]) * alpha;
+		out[3] = 0.0f;
+		return;
+	}
+	const float dot = ((a[0] * b[0] + a[1] * b[1]) + a[2] * b[2]) + a[3] * b[3];
+	float q[4];
+	for (uint32_t c = 0; c < 4; c++)
+		q[c] = a[c] + ((dot < 0.0f ? -b[c] : b[c]) - a[c]) * alpha;
+	const float invLength = 1.0f / sqrtf(((q[0] * q[0] + q[1] * q[1]) + q[2] * q[2]) + q[3] * q[3]);
+	for (uint32_t c = 0; c < 4; c++)
+		out[c] = q[c] * invLength;
+}
+
+/*Angle between rotations, distance between translations and the largest difference of scales*/
+static float _animError(asAnimTrackType type, const float a[4], const float b[4])
+{
+	if (type == AS_ANIM_TRACK_ROTATION)
+	{
+		/*From the chord between the normalized rotations, acos() near 1 would turn float rounding into error*/
+		double lengthA = 0.0, lengthB = 0.0;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			lengthA += (double)a[c] * a[c];
+			lengthB += (double)b[c] * b[c];
+		}
+		lengthA = sqrt(lengthA);
+		lengthB = sqrt(lengthB);
+		double minus = 0.0, plus = 0.0;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			const double dA = a[c] / lengthA, dB = b[c] / lengthB;
+			minus += (dA - dB) * (dA - dB);
+			plus += (dA + dB) * (dA + dB);
+		}
+		const double chord = sqrt(minus < plus ? minus : plus) * 0.5;
+		return (float)(4.0 * asin(chord < 1.0 ? chord : 1.0));
+	}
+	if (type == AS_ANIM_TRACK_TRANSLATION)
+	{
+		const double dx = (double)a[0] - b[0], dy = (double)a[1] - b[1], dz = (double)a[2] - b[2];
+		return (float)sqrt(dx * dx + dy * dy + dz * dz);
+	}
+	float error = 0.0f;
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		const float d = fabsf(a[c] - b[c]);
+		error = d > error ? d : error;
+	}
+	return error;
+}
+
+/*Compression*/
+
+typedef struct {
+	asAnimTrack_t* pTracks;
+	uint16_t* pFrames;
+	uint16_t* pValues;
+	uint32_t keyCount;
+	uint32_t keyCapacity;
+} _animBuiltClip;
+
+typedef struct {
+	float* pSamples; /*4 floats per frame*/
+	float* pDecoded; /*4 floats per frame*/
+	uint16_t* pWords; /*3 per frame*/
+} _animTrackScratch;
+
+static void _animGetSample(const asAnimBuilderBone_t* pBone, const asAnimBuilderClip_t* pClip, uint32_t bone, asAnimTrackType type,
+	uint32_t frame, float out[4])
+{
+	const size_t sample = (size_t)bone * pClip->frameCount + frame;
+	out[3] = 0.0f;
+	if (type == AS_ANIM_TRACK_ROTATION)
+	{
+		const float* pSrc = pClip->pRotations ? &pClip->pRotations[sample * 4] : pBone->restRotation;
+		const float length = sqrtf(pSrc[0] * pSrc[0] + pSrc[1] * pSrc[1] + pSrc[2] * pSrc[2] + pSrc[3] * pSrc[3]);
+		for (uint32_t c = 0; c < 4; c++)
+			out[c] = length > 0.0f ? pSrc[c] / length : (c == 3 ? 1.0f : 0.0f);
+		return;
+	}
+	const float* pChannel = type == AS_ANIM_TRACK_TRANSLATION ? pClip->pTranslations : pClip->pScales;
+	const float* pSrc = pChannel ? &pChannel[sample * 3] : (type == AS_ANIM_TRACK_TRANSLATION ? pBone->restTranslation : pBone->restScale);
+	memcpy(out, pSrc, sizeof(float) * 3);
+}
+
+/*The three smallest components of a rotation after the largest one is made positive*/
+static void _animSmallestThree(const float q[4], float slots[3], uint32_t* pIndex)
+{
+	uint32_t index = 0;
+	for (uint32_t c = 1; c < 4; c++)
+	{
+		if (fabsf(q[c]) > fabsf(q[index]))
+			index = c;
+	}
+	const float sign = q[index] < 0.0f ? -1.0f : 1.0f;
+	for (uint32_t c = 0, slot = 0; c < 4; c++)
+	{
+		if (c != index)
+			slots[slot++] = q[c] * sign;
+	}
+	*pIndex = index;
+}
+
+/*Quantize to the words of a key (rotations as the smallest three with the largest component made positive and dropped)*/
+static void _animQuantize(asAnimTrackType type, const asAnimTrack_t* pTrack, const float value[4], uint16_t words[3])
+{
+	float slots[3];
+	uint32_t index = 3;
+	if (type == AS_ANIM_TRACK_ROTATION)
+	{
+		_animSmallestThree(value, slots, &index);
+	}
+	else
+	{
+		memcpy(slots, value, sizeof(slots));
+	}
+	const float maxWord = type == AS_ANIM_TRACK_ROTATION ? 32767.0f : 65535.0f;
+	for (uint32_t c = 0; c < 3; c++)
+	{
+		float word = pTrack->rangeExtent[c] > 0.0f ? (slots[c] - pTrack->rangeMin[c]) / pTrack->rangeExtent[c] * maxWord : 0.0f;
+		word = word > 0.0f ? (word < maxWord ? word : maxWord) : 0.0f;
+		words[c] = (uint16_t)lrintf(word);
+	}
+	if (type == AS_ANIM_TRACK_ROTATION)
+	{
+		words[0] |= (uint16_t)((index & 1) << 15);
+		words[1] |= (uint16_t)((index >> 1) << 15);
+	}
+}
+
+static bool _animAddKey(_animBuiltClip* pClip, uint32_t frame, const uint16_t words[3])
+{
+	if (pClip->keyCount == pClip->keyCapacity)
+	{
+		const uint32_t capacity = pClip->keyCapacity ? pClip->keyCapacity * 2 : 256;
+		uint16_t* pFrames = asRealloc(pClip->pFrames, sizeof(uint16_t) * capacity);
+		if (pFrames)
+			pClip->pFrames = pFrames;
+		uint16_t* pValues = asRealloc(pClip->pValues, sizeof(uint16_t) * 3 * capacity);
+		if (pValues)
+			pClip->pValues = pValues;
+		if (!pFrames || !pValues)
+			return false;
+		pClip->keyCapacity = capacity;
+	}
+	pClip->pFrames[pClip->keyCount] = (uint16_t)frame;
+	memcpy(&pClip->pValues[(size_t)pClip->keyCount * 3], words, sizeof(uint16_t) * 3);
+	pClip->keyCount++;
+	return true;
+}
+
+static asResults _animCompressTrack(const asAnimBuilderBone_t* pBone, uint32_t bone, const asAnimBuilderClip_t* pClip, asAnimTrackType type,
+	float tolerance, _animTrackScratch* pScratch, _animBuiltClip* pOut, asAnimTrack_t* pTrack, float* pMaxError)
+{
+	const uint32_t frameCount = pClip->frameCount;
+	float* pSamples = pScratch->pSamples;
+	float* pDecoded = pScratch->pDecoded;
+	uint16_t* pWords = pScratch->pWords;
+	for (uint32_t f = 0; f < frameCount; f++)
+		_animGetSample(pBone, pClip, bone, type, f, &pSamples[f * 4]);
+	memset(pTrack, 0, sizeof(asAnimTrack_t));
+
+	/*Constant when the first frame (as decoded) is close enough to every frame*/
+	memcpy(pTrack->rangeMin, pSamples, sizeof(float) * 4);
+	if (type == AS_ANIM_TRACK_ROTATION && pTrack->rangeMin[3] < 0.0f)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			pTrack->rangeMin[c] = -pTrack->rangeMin[c];
+	}
+	const uint16_t constantWord = type == AS_ANIM_TRACK_ROTATION ? 0x8000 : 0; /*Rotations drop W*/
+	const uint16_t constantWords[3] = { constantWord, constantWord, 0 };
+	float constant[4];
+	_animDecodeKey(type, pTrack, constantWords, constant);
+	float constantError = 0.0f;
+	for (uint32_t f = 0; f < frameCount && constantError <= tolerance; f++)
+	{
+		const float error = _animError(type, constant, &pSamples[f * 4]);
+		constantError = error > constantError ? error : constantError;
+	}
+	if (constantError <= tolerance)
+	{
+		*pMaxError = constantError > *pMaxError ? constantError : *pMaxError;
+		return AS_SUCCESS;
+	}
+
+	/*Range of each stored component over the track*/
+	float rangeMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t c = 0; c < 3; c++)
+		pTrack->rangeMin[c] = FLT_MAX;
+	pTrack->rangeMin[3] = 0.0f;
+	for (uint32_t f = 0; f < frameCount; f++)
+	{
+		float slots[3];
+		uint32_t index;
+		if (type == AS_ANIM_TRACK_ROTATION)
+			_animSmallestThree(&pSamples[f * 4], slots, &index);
+		else
+			memcpy(slots, &pSamples[f * 4], sizeof(slots));
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			pTrack->rangeMin[c] = slots[c] < pTrack->rangeMin[c] ? slots[c] : pTrack->rangeMin[c];
+			rangeMax[c] = slots[c] > rangeMax[c] ? slots[c] : rangeMax[c];
+		}
+	}
+	for (uint32_t c = 0; c < 3; c++)
+		pTrack->rangeExtent[c] = rangeMax[c] - pTrack->rangeMin[c];
+	for (uint32_t f = 0; f < frameCount; f++)
+	{
+		_animQuantize(type, pTrack, &pSamples[f * 4], &pWords[f * 3]);
+		_animDecodeKey(type, pTrack, &pWords[f * 3], &pDecoded[f * 4]);
+	}
+
+	/*Grow each segment for as long as interpolating its ends stays within tolerance of every frame it covers*/
+	pTrack->firstKey = pOut->keyCount;
+	if (!_animAddKey(pOut, 0, pWords))
+		return AS_FAILURE_OUT_OF_MEMORY;
+	const float firstError = _animError(type, pDecoded, pSamples);
+	*pMaxError = firstError > *pMaxError ? firstError : *pMaxError;
+	uint32_t start = 0;
+	while (start < frameCount - 1)
+	{
+		uint32_t end = start + 1;
+		float endError = _animError(type, &pDecoded[end * 4], &pSamples[end * 4]);
+		for (uint32_t candidate = start + 2; candidate < frameCount; candidate++)
+		{
+			float segmentError = _animError(type, &pDecoded[candidate * 4], &pSamples[candidate * 4]);
+			for (uint32_t f = start + 1; f < candidate && segmentError <= tolerance; f++)
+			{
+				float value[4];
+				const float alpha = ((float)f - (float)start) / (float)(candidate - start);
+				_animInterpolate(type, &pDecoded[start * 4], &pDecoded[candidate * 4], alpha < 1.0f ? alpha : 1.0f, value);
+				const float error = _animError(type, value, &pSamples[f * 4]);
+				segmentError = error > segmentError ? error : segmentError;
+			}
+			if (segmentError > tolerance)
+				break;
+			end = candidate;
+			endError = segmentError;
+		}
+		*pMaxError = endError > *pMaxError ? endError : *pMaxError;
+		if (!_animAddKey(pOut, end, &pWords[end * 3]))
+			return AS_FAILURE_OUT_OF_MEMORY;
+		start = end;
+	}
+	pTrack->keyCount = pOut->keyCount - pTrack->firstKey;
+	return AS_SUCCESS;
+}
+
+/*Model files*/
+
+static uint64_t _animAlign(uint64_t offset)
+{
+	return (offset + AS_ANIM_ALIGNMENT - 1) & ~(uint64_t)(AS_ANIM_ALIGNMENT - 1);
+}
+
+static size_t _animNameLength(const char* pName)
+{
+	size_t length = 0;
+	while (length < AS_ANIM_MAX_NAME - 1 && pName[length])
+		length++;
+	return length;
+}
+
+/*Clips only play on skeletons with the same bone names and parents*/
+static uint64_t _animSkeletonHash(const asAnimBuilderBone_t* pBones, uint32_t boneCount)
+{
+	asHash64_t hashes[3] = { boneCount, 0, 0 };
+	for (uint32_t i = 0; i < boneCount; i++)
+	{
+		hashes[1] = asHashBytes64_xxHash(pBones[i].name, _animNameLength(pBones[i].name));
+		hashes[2] = (asHash64_t)(int64_t)pBones[i].parent;
+		hashes[0] = asHashBytes64_xxHash(hashes, sizeof(hashes));
+	}
+	return hashes[0];
+}
+
+static void _animFreeBuiltClips(_animBuiltClip* pBuilt, uint32_t clipCount)
+{
+	for (uint32_t i = 0; pBuilt && i < clipCount; i++)
+	{
+		asFree(pBuilt[i].pTracks);
+		asFree(pBuilt[i].pFrames);
+		asFree(pBuilt[i].pValues);
+	}
+	asFree(pBuilt);
+}
+
+ASEXPORT asResults asAnimBuilder_Build(const asAnimBuilderBone_t* pBones, uint32_t boneCount, const asAnimBuilderClip_t* pClips, uint32_t clipCount,
+	const asAnimBuilderCompressDesc_t* pDesc, void** ppBlob, size_t* pSize, asAnimBuilderStats_t* pStats)
+{
+	const asAnimBuilderCompressDesc_t desc = pDesc ? *pDesc : asAnimBuilderCompressDesc_Init();
+	asAnimBuilderStats_t stats;
+	memset(&stats, 0, sizeof(stats));
+	if (boneCount > AS_ANIM_MAX_BONES)
+		return AS_FAILURE_INVALID_PARAM;
+	uint32_t paletteCount = 0;
+	for (uint32_t i = 0; i < boneCount; i++)
+	{
+		if (pBones[i].parent < -1 || pBones[i].parent >= (int32_t)i ||
+			(pBones[i].paletteIndex >= boneCount && pBones[i].paletteIndex != AS_ANIM_NO_PALETTE))
+			return AS_FAILURE_INVALID_PARAM;
+		if (pBones[i].paletteIndex != AS_ANIM_NO_PALETTE && pBones[i].paletteIndex >= paletteCount)
+			paletteCount = pBones[i].paletteIndex + 1;
+	}
+	uint32_t maxFrames = 1;
+	for (uint32_t i = 0; i < clipCount; i++)
+	{
+		if (pClips[i].frameCount < 1 || pClips[i].frameCount > AS_ANIM_MAX_FRAMES || (pClips[i].frameCount > 1 && !(pClips[i].sampleRate > 0.0f)))
+			return AS_FAILURE_INVALID_PARAM;
+		maxFrames = pClips[i].frameCount > maxFrames ? pClips[i].frameCount : maxFrames;
+	}
+
+	/*Compress every track of every clip*/
+	asResults result = AS_SUCCESS;
+	_animBuiltClip* pBuilt = asMalloc(sizeof(_animBuiltClip) * (clipCount ? clipCount : 1));
+	_animTrackScratch scratch;
+	scratch.pSamples = asMalloc(sizeof(float) * 4 * maxFrames);
+	scratch.pDecoded = asMalloc(sizeof(float) * 4 * maxFrames);
+	scratch.pWords = asMalloc(sizeof(uint16_t) * 3 * maxFrames);
+	if (pBuilt)
+		memset(pBuilt, 0, sizeof(_animBuiltClip) * (clipCount ? clipCount : 1));
+	if (!pBuilt || !scratch.pSamples || !scratch.pDecoded || !scratch.pWords)
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	const float tolerances[AS_ANIM_TRACK_COUNT] = { desc.rotationTolerance, desc.translationTolerance, desc.scaleTolerance };
+	float* pMaxErrors[AS_ANIM_TRACK_COUNT] = { &stats.maxRotationError, &stats.maxTranslationError, &stats.maxScaleError };
+	for (uint32_t i = 0; i < clipCount && result == AS_SUCCESS; i++)
+	{
+		pBuilt[i].pTracks = asMalloc(sizeof(asAnimTrack_t) * AS_ANIM_TRACK_COUNT * (boneCount ? boneCount : 1));
+		if (!pBuilt[i].pTracks)
+		{
+			result = AS_FAILURE_OUT_OF_MEMORY;
+			break;
+		}
+		for (uint32_t type = 0; type < AS_ANIM_TRACK_COUNT && result == AS_SUCCESS; type++)
+		{
+			for (uint32_t bone = 0; bone < boneCount && result == AS_SUCCESS; bone++)
+			{
+				asAnimTrack_t* pTrack = &pBuilt[i].pTracks[type * boneCount + bone];
+				result = _animCompressTrack(&pBones[bone], bone, &pClips[i], (asAnimTrackType)type, tolerances[type],
+					&scratch, &pBuilt[i], pTrack, pMaxErrors[type]);
+				if (pTrack->keyCount)
+					stats.animatedTracks++;
+				else
+					stats.constantTracks++;
+			}
+		}
+		stats.keyCount += pBuilt[i].keyCount;
+		stats.sampledSize += sizeof(float) * 10 * (size_t)boneCount * pClips[i].frameCount;
+	}
+	asFree(scratch.pSamples);
+	asFree(scratch.pDecoded);
+	asFree(scratch.pWords);
+	if (result != AS_SUCCESS)
+	{
+		_animFreeBuiltClips(pBuilt, clipCount);
+		return result;
+	}
+
+	/*Layout of the blob, every table aligned so it can be used in place*/
+	asAnimation_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.tag, AS_ANIM_FILE_TAG, 4);
+	header.version = AS_ANIM_VERSION;
+	header.skeletonHash = _animSkeletonHash(pBones, boneCount);
+	header.boneCount = boneCount;
+	header.paletteCount = paletteCount;
+	header.clipCount = clipCount;
+	header.bones.offset = _animAlign(sizeof(asAnimation_t));
+	header.inverseBinds.offset = _animAlign(header.bones.offset + sizeof(asAnimBone_t) * boneCount);
+	header.restPose.offset = _animAlign(header.inverseBinds.offset + sizeof(mat4) * boneCount);
+	header.clips.offset = _animAlign(header.restPose.offset + sizeof(asAnimSoaTransform_t) * AS_ANIM_SOA_COUNT(boneCount));
+	uint64_t offset = _animAlign(header.clips.offset + sizeof(asAnimClip_t) * clipCount);
+	asAnimClip_t* pOutClips = asMalloc(sizeof(asAnimClip_t) * (clipCount ? clipCount : 1));
+	if (!pOutClips)
+	{
+		_animFreeBuiltClips(pBuilt, clipCount);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < clipCount; i++)
+	{
+		asAnimClip_t* pClip = &pOutClips[i];
+		memset(pClip, 0, sizeof(asAnimClip_t));
+		pClip->skeletonHash = header.skeletonHash;
+		pClip->boneCount = boneCount;
+		pClip->frameCount = pClips[i].frameCount;
+		pClip->sampleRate = pClips[i].frameCount > 1 ? pClips[i].sampleRate : 0.0f;
+		pClip->duration = pClips[i].frameCount > 1 ? (float)(pClips[i].frameCount - 1) / pClips[i].sampleRate : 0.0f;
+		pClip->keyCount = pBuilt[i].keyCount;
+		pClip->tracks.offset = offset;
+		pClip->keyFrames.offset = _animAlign(pClip->tracks.offset + sizeof(asAnimTrack_t) * AS_ANIM_TRACK_COUNT * boneCount);
+		pClip->keyValues.offset = _animAlign(pClip->keyFrames.offset + sizeof(uint16_t) * pClip->keyCount);
+		offset = _animAlign(pClip->keyValues.offset + sizeof(uint16_t) * 3 * (uint64_t)pClip->keyCount);
+	}
+	uint64_t stringOffset = offset;
+	for (uint32_t i = 0; i < boneCount; i++)
+		offset += _animNameLength(pBones[i].name) + 1;
+	for (uint32_t i = 0; i < clipCount; i++)
+		offset += _animNameLength(pClips[i].name) + 1;
+	header.size = _animAlign(offset);
+	uint8_t* pBlob = header.size <= SIZE_MAX ? asMalloc((size_t)header.size) : NULL;
+	if (!pBlob)
+	{
+		asFree(pOutClips);
+		_animFreeBuiltClips(pBuilt, clipCount);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	memset(pBlob, 0, (size_t)header.size);
+
+	/*Skeleton, names go into the pool at the end*/
+	asAnimBone_t* pOutBones = (asAnimBone_t*)(pBlob + header.bones.offset);
+	mat4* pInverseBinds = (mat4*)(pBlob + header.inverseBinds.offset);
+	asAnimSoaTransform_t* pRestPose = (asAnimSoaTransform_t*)(pBlob + header.restPose.offset);
+	for (uint32_t i = 0; i < AS_ANIM_SOA_COUNT(boneCount) * 4; i++)
+	{
+		asAnimSoaTransform_t* pSoa = &pRestPose[i / 4];
+		const uint32_t lane = i % 4;
+		if (i >= boneCount)
+		{
+			pSoa->rotation[3][lane] = 1.0f;
+			pSoa->scale[0][lane] = pSoa->scale[1][lane] = pSoa->scale[2][lane] = 1.0f;
+			continue;
+		}
+		const asAnimBuilderBone_t* pBone = &pBones[i];
+		const size_t nameLength = _animNameLength(pBone->name);
+		pOutBones[i].name.offset = stringOffset;
+		pOutBones[i].parent = pBone->parent;
+		pOutBones[i].paletteIndex = pBone->paletteIndex;
+		memcpy(pBlob + stringOffset, pBone->name, nameLength);
+		stringOffset += nameLength + 1;
+		memcpy(pInverseBinds[i], pBone->inverseBind, sizeof(mat4));
+		const float* pQ = pBone->restRotation;
+		const float length = sqrtf(pQ[0] * pQ[0] + pQ[1] * pQ[1] + pQ[2] * pQ[2] + pQ[3] * pQ[3]);
+		for (uint32_t c = 0; c < 4; c++)
+			pSoa->rotation[c][lane] = length > 0.0f ? pQ[c] / length : (c == 3 ? 1.0f : 0.0f);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			pSoa->translation[c][lane] = pBone->restTranslation[c];
+			pSoa->scale[c][lane] = pBone->restScale[c];
+		}
+	}
+
+	/*Clips and their key tables*/
+	for (uint32_t i = 0; i < clipCount; i++)
+	{
+		asAnimClip_t* pClip = &pOutClips[i];
+		const size_t nameLength = _animNameLength(pClips[i].name);
+		pClip->name.offset = stringOffset;
+		memcpy(pBlob + stringOffset, pClips[i].name, nameLength);
+		stringOffset += nameLength + 1;
+		memcpy(pBlob + pClip->tracks.offset, pBuilt[i].pTracks, sizeof(asAnimTrack_t) * AS_ANIM_TRACK_COUNT * boneCount);
+		if (pClip->keyCount)
+		{
+			memcpy(pBlob + pClip->keyFrames.offset, pBuilt[i].pFrames, sizeof(uint16_t) * pClip->keyCount);
+			memcpy(pBlob + pClip->keyValues.offset, pBuilt[i].pValues, sizeof(uint16_t) * 3 * (size_t)pClip->keyCount);
+		}
+	}
+	memcpy(pBlob + header.clips.offset, pOutClips, sizeof(asAnimClip_t) * clipCount);
+	memcpy(pBlob, &header, sizeof(asAnimation_t));
+	asFree(pOutClips);
+	_animFreeBuiltClips(pBuilt, clipCount);
+
+	stats.size = (size_t)header.size;
+	if (pStats)
+		*pStats = stats;
+	*ppBlob = pBlob;
+	*pSize = (size_t)header.size;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asAnimBuilder_WriteFile(const char* pPath, const asAnimBuilderBone_t* pBones, uint32_t boneCount,
+	const asAnimBuilderClip_t* pClips, uint32_t clipCount, const asAnimBuilderCompressDesc_t* pDesc, asAnimBuilderStats_t* pStats)
+{
+	void* pBlob;
+	size_t size;
+	asResults result = asAnimBuilder_Build(pBones, boneCount, pClips, clipCount, pDesc, &pBlob, &size, pStats);
+	if (result != AS_SUCCESS)
+		return result;
+	FILE* fp = fopen(pPath, "wb");
+	if (!fp)
+	{
+		asFree(pBlob);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	const bool written = fwrite(pBlob, size, 1, fp) == 1;
+	fclose(fp);
+	asFree(pBlob);
+	return written ? AS_SUCCESS : AS_FAILURE_FILE_INACCESSIBLE;
+}
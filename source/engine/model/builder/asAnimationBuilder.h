@@ -0,0 +1,90 @@
+#ifndef _ASANIMATIONBUILDER_H_
+#define _ASANIMATIONBUILDER_H_
+
+#include "../../animation/asAnimation.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Offline compression of sampled skeletal animation into asAnim files (see asAnimation_t)
+* Tracks that stay within tolerance of their first frame are stored as a constant, the rest are quantized
+* and then fit with the fewest keys the runtime can interpolate back to within tolerance of every frame
+* (errors are measured on the values exactly as the runtime decodes them)
+*/
+
+/**
+* @brief A bone of the skeleton being built, parents have to come before their children
+*/
+typedef struct {
+	char name[AS_ANIM_MAX_NAME];
+	int32_t parent; /**< -1 for roots*/
+	uint32_t paletteIndex; /**< Skin joint of the bone (AS_ANIM_NO_PALETTE when it is not one)*/
+	float restRotation[4]; /**< Quaternion XYZW*/
+	float restTranslation[3];
+	float restScale[3];
+	mat4 inverseBind;
+} asAnimBuilderBone_t;
+
+/**
+* @brief A clip sampled at a fixed rate
+* channels hold every frame of the first bone, then every frame of the next bone and so on
+*/
+typedef struct {
+	char name[AS_ANIM_MAX_NAME];
+	float sampleRate; /**< Frames per second*/
+	uint32_t frameCount; /**< Up to AS_ANIM_MAX_FRAMES*/
+	const float* pRotations; /**< Quaternion XYZW per frame (NULL keeps the rest pose)*/
+	const float* pTranslations; /**< XYZ per frame (NULL keeps the rest pose)*/
+	const float* pScales; /**< XYZ per frame (NULL keeps the rest pose)*/
+} asAnimBuilderClip_t;
+
+/**
+* @brief How far the compressed clip may be from the samples
+*/
+typedef struct {
+	float rotationTolerance; /**< Radians*/
+	float translationTolerance; /**< Model units*/
+	float scaleTolerance;
+} asAnimBuilderCompressDesc_t;
+
+/**
+* @brief Set the default tolerances (0.0005 radians, 0.0001 units and 0.0001 scale)
+*/
+ASEXPORT asAnimBuilderCompressDesc_t asAnimBuilderCompressDesc_Init();
+
+/**
+* @brief What the compression did
+*/
+typedef struct {
+	uint32_t constantTracks;
+	uint32_t animatedTracks;
+	uint32_t keyCount;
+	float maxRotationError; /**< Radians*/
+	float maxTranslationError;
+	float maxScaleError;
+	size_t sampledSize; /**< Bytes of the samples as floats*/
+	size_t size; /**< Bytes of the blob*/
+} asAnimBuilderStats_t;
+
+/**
+* @brief Compress clips for a skeleton into an asAnim blob
+* @param pDesc NULL for the defaults
+* @param ppBlob filled with the blob (free with asFree(), relocate with asAnimation_Relocate())
+* @param pStats optional
+* @return AS_FAILURE_INVALID_PARAM if a parent comes after its child or a clip is out of range
+*/
+ASEXPORT asResults asAnimBuilder_Build(const asAnimBuilderBone_t* pBones, uint32_t boneCount, const asAnimBuilderClip_t* pClips, uint32_t clipCount,
+	const asAnimBuilderCompressDesc_t* pDesc, void** ppBlob, size_t* pSize, asAnimBuilderStats_t* pStats);
+
+/**
+* @brief Compress clips and write them out as an asAnim file
+*/
+ASEXPORT asResults asAnimBuilder_WriteFile(const char* pPath, const asAnimBuilderBone_t* pBones, uint32_t boneCount,
+	const asAnimBuilderClip_t* pClips, uint32_t clipCount, const asAnimBuilderCompressDesc_t* pDesc, asAnimBuilderStats_t* pStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,1761 @@
+#include "asMeshBuildingAPI.h"
+#include "mikkt/mikktspace.h"
+
+#include <math.h>
+#include <float.h>
+
+/*Welding*/
+
+ASEXPORT asResults asMeshBuilder_WeldVertices(asMeshBuilderMesh_t* pMesh)
+{
+	const uint32_t vertexCount = pMesh->vertexCount;
+	uint32_t tableSize = 1;
+	while (tableSize < vertexCount + vertexCount / 4 + 1)
+		tableSize *= 2;
+	uint32_t* pTable = asMalloc(sizeof(uint32_t) * tableSize);
+	uint32_t* pRemap = asMalloc(sizeof(uint32_t) * (vertexCount ? vertexCount : 1));
+	if (!pTable || !pRemap)
+	{
+		asFree(pTable);
+		asFree(pRemap);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	memset(pTable, 0xFF, sizeof(uint32_t) * tableSize);
+
+	/*Unique vertices are compacted to the front as they are found (open addressing on the vertex bytes)*/
+	uint32_t uniqueCount = 0;
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const asVertexGeneric vertex = pMesh->pVertices[i];
+		uint32_t bucket = (uint32_t)asHashBytes64_xxHash(&vertex, sizeof(asVertexGeneric)) & (tableSize - 1);
+		while (pTable[bucket] != UINT32_MAX && memcmp(&pMesh->pVertices[pTable[bucket]], &vertex, sizeof(asVertexGeneric)) != 0)
+			bucket = (bucket + 1) & (tableSize - 1);
+		if (pTable[bucket] == UINT32_MAX)
+		{
+			pTable[bucket] = uniqueCount;
+			pMesh->pVertices[uniqueCount] = vertex;
+			uniqueCount++;
+		}
+		pRemap[i] = pTable[bucket];
+	}
+	for (uint32_t i = 0; i < pMesh->indexCount; i++)
+		pMesh->pIndices[i] = pRemap[pMesh->pIndices[i]];
+	pMesh->vertexCount = uniqueCount;
+
+	asFree(pTable);
+	asFree(pRemap);
+	return AS_SUCCESS;
+}
+
+/*Vertex Cache*/
+
+#define AS_MESH_BUILDER_VALENCE_SCORES 32
+
+static float _vertexScore(const float* pCacheScores, const float* pValenceScores, int32_t cachePos, uint32_t remaining)
+{
+	if (!remaining)
+		return -1.0f; /*Nothing left to draw with it*/
+	const float cacheScore = cachePos >= 0 ? pCacheScores[cachePos] : 0.0f;
+	const float valenceScore = remaining < AS_MESH_BUILDER_VALENCE_SCORES ?
+		pValenceScores[remaining] : 2.0f * powf((float)remaining, -0.5f);
+	return cacheScore + valenceScore;
+}
+
+ASEXPORT asResults asMeshBuilder_OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+{
+	const uint32_t triCount = indexCount / 3;
+	if (!triCount)
+		return AS_SUCCESS;
+	uint32_t* pOffsets = asMalloc(sizeof(uint32_t) * (vertexCount + 1));
+	uint32_t* pRemaining = asMalloc(sizeof(uint32_t) * vertexCount);
+	uint32_t* pAdjacency = asMalloc(sizeof(uint32_t) * triCount * 3);
+	int32_t* pCachePos = asMalloc(sizeof(int32_t) * vertexCount);
+	float* pVertexScores = asMalloc(sizeof(float) * vertexCount);
+	float* pTriScores = asMalloc(sizeof(float) * triCount);
+	uint8_t* pEmitted = asMalloc(triCount);
+	uint32_t* pOut = asMalloc(sizeof(uint32_t) * triCount * 3);
+	if (!pOffsets || !pRemaining || !pAdjacency || !pCachePos || !pVertexScores || !pTriScores || !pEmitted || !pOut)
+	{
+		asFree(pOffsets);
+		asFree(pRemaining);
+		asFree(pAdjacency);
+		asFree(pCachePos);
+		asFree(pVertexScores);
+		asFree(pTriScores);
+		asFree(pEmitted);
+		asFree(pOut);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	/*Scores (the three most recent vertices score the same so the order within a triangle does not matter)*/
+	float cacheScores[AS_MESH_BUILDER_CACHE_SIZE];
+	for (int32_t i = 0; i < AS_MESH_BUILDER_CACHE_SIZE; i++)
+		cacheScores[i] = i < 3 ? 0.75f : powf(1.0f - (float)(i - 3) / (float)(AS_MESH_BUILDER_CACHE_SIZE - 3), 1.5f);
+	float valenceScores[AS_MESH_BUILDER_VALENCE_SCORES];
+	valenceScores[0] = 0.0f;
+	for (uint32_t i = 1; i < AS_MESH_BUILDER_VALENCE_SCORES; i++)
+		valenceScores[i] = 2.0f * powf((float)i, -0.5f);
+
+	/*Triangles using each vertex*/
+	memset(pRemaining, 0, sizeof(uint32_t) * vertexCount);
+	for (uint32_t i = 0; i < triCount * 3; i++)
+		pRemaining[pIndices[i]]++;
+	pOffsets[0] = 0;
+	for (uint32_t i = 0; i < vertexCount; i++)
+		pOffsets[i + 1] = pOffsets[i] + pRemaining[i];
+	memset(pRemaining, 0, sizeof(uint32_t) * vertexCount);
+	for (uint32_t i = 0; i < triCount * 3; i++)
+	{
+		const uint32_t v = pIndices[i];
+		pAdjacency[pOffsets[v] + pRemaining[v]] = i / 3;
+		pRemaining[v]++;
+	}
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		pCachePos[i] = -1;
+		pVertexScores[i] = _vertexScore(cacheScores, valenceScores, -1, pRemaining[i]);
+	}
+	uint32_t bestTri = 0;
+	for (uint32_t i = 0; i < triCount; i++)
+	{
+		const uint32_t* pTri = &pIndices[i * 3];
+		pTriScores[i] = pVertexScores[pTri[0]] + pVertexScores[pTri[1]] + pVertexScores[pTri[2]];
+		if (pTriScores[i] > pTriScores[bestTri])
+			bestTri = i;
+	}
+	memset(pEmitted, 0, triCount);
+
+	/*Draw the best scoring triangle using the cached vertices, start over at the next undrawn one if there is none*/
+	uint32_t cache[AS_MESH_BUILDER_CACHE_SIZE + 3];
+	uint32_t nextCache[AS_MESH_BUILDER_CACHE_SIZE + 3];
+	uint32_t cacheCount = 0;
+	uint32_t cursor = 0;
+	for (uint32_t emitted = 0; emitted < triCount; emitted++)
+	{
+		if (bestTri == UINT32_MAX)
+		{
+			while (pEmitted[cursor])
+				cursor++;
+			bestTri = cursor;
+		}
+		const uint32_t* pTri = &pIndices[bestTri * 3];
+		memcpy(&pOut[emitted * 3], pTri, sizeof(uint32_t) * 3);
+		pEmitted[bestTri] = 1;
+
+		/*Remove the triangle from its vertices*/
+		for (int k = 0; k < 3; k++)
+		{
+			const uint32_t v = pTri[k];
+			uint32_t* pList = &pAdjacency[pOffsets[v]];
+			for (uint32_t j = 0; j < pRemaining[v]; j++)
+			{
+				if (pList[j] == bestTri)
+				{
+					pList[j] = pList[pRemaining[v] - 1];
+					break;
+				}
+			}
+			pRemaining[v]--;
+		}
+
+		/*Move the triangle's vertices to the front of the cache*/
+		uint32_t nextCount = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			if (k > 0 && pTri[k] == pTri[0])
+				continue;
+			if (k > 1 && pTri[k] == pTri[1])
+				continue;
+			nextCache[nextCount++] = pTri[k];
+		}
+		for (uint32_t i = 0; i < cacheCount; i++)
+		{
+			const uint32_t v = cache[i];
+			if (v != pTri[0] && v != pTri[1] && v != pTri[2])
+				nextCache[nextCount++] = v;
+		}
+
+		/*Rescore what moved in the cache (and what fell out) and find the best triangle among the cached vertices*/
+		bestTri = UINT32_MAX;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < nextCount; i++)
+		{
+			const uint32_t v = nextCache[i];
+			pCachePos[v] = i < AS_MESH_BUILDER_CACHE_SIZE ? (int32_t)i : -1;
+			const float score = _vertexScore(cacheScores, valenceScores, pCachePos[v], pRemaining[v]);
+			const float delta = score - pVertexScores[v];
+			pVertexScores[v] = score;
+			const uint32_t* pList = &pAdjacency[pOffsets[v]];
+			for (uint32_t j = 0; j < pRemaining[v]; j++)
+				pTriScores[pList[j]] += delta;
+		}
+		for (uint32_t i = 0; i < nextCount && i < AS_MESH_BUILDER_CACHE_SIZE; i++)
+		{
+			const uint32_t v = nextCache[i];
+			const uint32_t* pList = &pAdjacency[pOffsets[v]];
+			for (uint32_t j = 0; j < pRemaining[v]; j++)
+			{
+				if (pTriScores[pList[j]] > bestScore)
+				{
+					bestScore = pTriScores[pList[j]];
+					bestTri = pList[j];
+				}
+			}
+		}
+		cacheCount = nextCount < AS_MESH_BUILDER_CACHE_SIZE ? nextCount : AS_MESH_BUILDER_CACHE_SIZE;
+		memcpy(cache, nextCache, sizeof(uint32_t) * cacheCount);
+	}
+	memcpy(pIndices, pOut, sizeof(uint32_t) * triCount * 3);
+
+	asFree(pOffsets);
+	asFree(pRemaining);
+	asFree(pAdjacency);
+	asFree(pCachePos);
+	asFree(pVertexScores);
+	asFree(pTriScores);
+	asFree(pEmitted);
+	asFree(pOut);
+	return AS_SUCCESS;
+}
+
+/*FIFO cache simulation: a vertex is still cached if fewer than cacheSize vertices were transformed since it was*/
+static uint32_t _fifoMisses(uint32_t* pTimestamps, uint32_t* pTime, uint32_t cacheSize, const uint32_t* pTri)
+{
+	uint32_t misses = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		if (*pTime - pTimestamps[pTri[k]] > cacheSize)
+		{
+			pTimestamps[pTri[k]] = *pTime;
+			(*pTime)++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+ASEXPORT asVertexCacheStats_t asMeshBuilder_AnalyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	asVertexCacheStats_t result = (asVertexCacheStats_t) { 0 };
+	const uint32_t triCount = indexCount / 3;
+	uint32_t* pTimestamps = asMalloc(sizeof(uint32_t) * (vertexCount ? vertexCount : 1));
+	if (!triCount || !pTimestamps)
+	{
+		asFree(pTimestamps);
+		return result;
+	}
+	memset(pTimestamps, 0, sizeof(uint32_t) * vertexCount);
+	uint32_t time = cacheSize + 1;
+	for (uint32_t i = 0; i < triCount; i++)
+		result.verticesTransformed += _fifoMisses(pTimestamps, &time, cacheSize, &pIndices[i * 3]);
+
+	/*Only referenced vertices count towards the ATVR*/
+	uint32_t usedCount = 0;
+	memset(pTimestamps, 0, sizeof(uint32_t) * vertexCount);
+	for (uint32_t i = 0; i < triCount * 3; i++)
+	{
+		usedCount += pTimestamps[pIndices[i]] ? 0 : 1;
+		pTimestamps[pIndices[i]] = 1;
+	}
+	result.acmr = (float)result.verticesTransformed / (float)triCount;
+	result.atvr = (float)result.verticesTransformed / (float)usedCount;
+	asFree(pTimestamps);
+	return result;
+}
+
+/*Overdraw*/
+
+struct _meshCluster
+{
+	uint32_t start; /*First triangle*/
+	uint32_t end;
+	float sortKey;
+};
+
+static int _compareClusters(const void* pA, const void* pB)
+{
+	const struct _meshCluster* a = (const struct _meshCluster*)pA;
+	const struct _meshCluster* b = (const struct _meshCluster*)pB;
+	if (a->sortKey != b->sortKey)
+		return a->sortKey > b->sortKey ? -1 : 1;
+	return a->start < b->start ? -1 : (a->start > b->start ? 1 : 0);
+}
+
+ASEXPORT asResults asMeshBuilder_OptimizeOverdraw(uint32_t* pIndices, uint32_t indexCount,
+	const asVertexGeneric* pVertices, uint32_t vertexCount, float threshold)
+{
+	const uint32_t triCount = indexCount / 3;
+	if (triCount < 2)
+		return AS_SUCCESS;
+	uint32_t* pTimestamps = asMalloc(sizeof(uint32_t) * vertexCount);
+	uint32_t* pMisses = asMalloc(sizeof(uint32_t) * triCount);
+	struct _meshCluster* pClusters = asMalloc(sizeof(struct _meshCluster) * triCount);
+	uint32_t* pOut = asMalloc(sizeof(uint32_t) * triCount * 3);
+	if (!pTimestamps || !pMisses || !pClusters || !pOut)
+	{
+		asFree(pTimestamps);
+		asFree(pMisses);
+		asFree(pClusters);
+		asFree(pOut);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	/*Hard boundaries are where the cache was flushed anyway (every vertex of the triangle missed)*/
+	memset(pTimestamps, 0, sizeof(uint32_t) * vertexCount);
+	uint32_t time = AS_MESH_BUILDER_CACHE_SIZE + 1;
+	for (uint32_t i = 0; i < triCount; i++)
+		pMisses[i] = _fifoMisses(pTimestamps, &time, AS_MESH_BUILDER_CACHE_SIZE, &pIndices[i * 3]);
+
+	/*Split each hard cluster further wherever the ACMR so far is within the threshold of the cluster's,
+	restarting with an empty cache since clusters may be drawn in any order*/
+	uint32_t clusterCount = 0;
+	uint32_t hardStart = 0;
+	while (hardStart < triCount)
+	{
+		uint32_t hardEnd = hardStart + 1;
+		uint32_t hardMisses = pMisses[hardStart];
+		while (hardEnd < triCount && pMisses[hardEnd] != 3)
+			hardMisses += pMisses[hardEnd++];
+		const float clusterThreshold = threshold * (float)hardMisses / (float)(hardEnd - hardStart);
+
+		time += AS_MESH_BUILDER_CACHE_SIZE + 1;
+		uint32_t start = hardStart;
+		uint32_t runningMisses = 0;
+		for (uint32_t i = hardStart; i < hardEnd; i++)
+		{
+			runningMisses += _fifoMisses(pTimestamps, &time, AS_MESH_BUILDER_CACHE_SIZE, &pIndices[i * 3]);
+			if ((float)runningMisses / (float)(i + 1 - start) <= clusterThreshold)
+			{
+				pClusters[clusterCount].start = start;
+				pClusters[clusterCount].end = i + 1;
+				clusterCount++;
+				start = i + 1;
+				runningMisses = 0;
+				time += AS_MESH_BUILDER_CACHE_SIZE + 1;
+			}
+		}
+		if (start < hardEnd)
+		{
+			pClusters[clusterCount].start = start;
+			pClusters[clusterCount].end = hardEnd;
+			clusterCount++;
+		}
+		hardStart = hardEnd;
+	}
+
+	/*Clusters facing away from the center of the mesh are likely in front, draw them first*/
+	vec3 meshCenter = { 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < triCount * 3; i++)
+		glm_vec3_add(meshCenter, (float*)pVertices[pIndices[i]].position, meshCenter);
+	glm_vec3_scale(meshCenter, 1.0f / (float)(triCount * 3), meshCenter);
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		vec3 center = { 0.0f, 0.0f, 0.0f };
+		vec3 normal = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (uint32_t i = pClusters[c].start; i < pClusters[c].end; i++)
+		{
+			float* p0 = (float*)pVertices[pIndices[i * 3 + 0]].position;
+			float* p1 = (float*)pVertices[pIndices[i * 3 + 1]].position;
+			float* p2 = (float*)pVertices[pIndices[i * 3 + 2]].position;
+			vec3 e0, e1, n, triCenter;
+			glm_vec3_sub(p1, p0, e0);
+			glm_vec3_sub(p2, p0, e1);
+			glm_vec3_cross(e0, e1, n);
+			const float triArea = glm_vec3_norm(n);
+			glm_vec3_add(p0, p1, triCenter);
+			glm_vec3_add(triCenter, p2, triCenter);
+			glm_vec3_muladds(triCenter, triArea / 3.0f, center);
+			glm_vec3_add(normal, n, normal);
+			area += triArea;
+		}
+		if (area > 0.0f)
+			glm_vec3_scale(center, 1.0f / area, center);
+		glm_vec3_normalize(normal);
+		glm_vec3_sub(center, meshCenter, center);
+		pClusters[c].sortKey = glm_vec3_dot(center, normal);
+	}
+	qsort(pClusters, clusterCount, sizeof(struct _meshCluster), _compareClusters);
+
+	uint32_t written = 0;
+	for (uint32_t c = 0; c < clusterCount; c++)
+	{
+		const uint32_t count = (pClusters[c].end - pClusters[c].start) * 3;
+		memcpy(&pOut[written], &pIndices[pClusters[c].start * 3], sizeof(uint32_t) * count);
+		written += count;
+	}
+	memcpy(pIndices, pOut, sizeof(uint32_t) * triCount * 3);
+
+	asFree(pTimestamps);
+	asFree(pMisses);
+	asFree(pClusters);
+	asFree(pOut);
+	return AS_SUCCESS;
+}
+
+/*Vertex Fetch*/
+
+ASEXPORT asResults asMeshBuilder_OptimizeVertexFetch(asMeshBuilderMesh_t* pMesh)
+{
+	const uint32_t vertexCount = pMesh->vertexCount;
+	if (!vertexCount)
+		return AS_SUCCESS;
+	uint32_t* pRemap = asMalloc(sizeof(uint32_t) * vertexCount);
+	asVertexGeneric* pReordered = asMalloc(sizeof(asVertexGeneric) * vertexCount);
+	if (!pRemap || !pReordered)
+	{
+		asFree(pRemap);
+		asFree(pReordered);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	memset(pRemap, 0xFF, sizeof(uint32_t) * vertexCount);
+	uint32_t usedCount = 0;
+	for (uint32_t i = 0; i < pMesh->indexCount; i++)
+	{
+		const uint32_t v = pMesh->pIndices[i];
+		if (pRemap[v] == UINT32_MAX)
+		{
+			pRemap[v] = usedCount;
+			pReordered[usedCount++] = pMesh->pVertices[v];
+		}
+		pMesh->pIndices[i] = pRemap[v];
+	}
+	memcpy(pMesh->pVertices, pReordered, sizeof(asVertexGeneric) * usedCount);
+	pMesh->vertexCount = usedCount;
+	asFree(pRemap);
+	asFree(pReordered);
+	return AS_SUCCESS;
+}
+
+/*Simplification*/
+
+/*Sum of squared distances to planes: x^T A x + 2 b.x + c, weighted by area*/
+struct _quadric
+{
+	double a00, a11, a22, a01, a02, a12;
+	double b0, b1, b2;
+	double c;
+	double weight;
+};
+
+static void _quadricAddPlane(struct _quadric* pQ, const double n[3], double d, double weight)
+{
+	pQ->a00 += weight * n[0] * n[0];
+	pQ->a11 += weight * n[1] * n[1];
+	pQ->a22 += weight * n[2] * n[2];
+	pQ->a01 += weight * n[0] * n[1];
+	pQ->a02 += weight * n[0] * n[2];
+	pQ->a12 += weight * n[1] * n[2];
+	pQ->b0 += weight * n[0] * d;
+	pQ->b1 += weight * n[1] * d;
+	pQ->b2 += weight * n[2] * d;
+	pQ->c += weight * d * d;
+	pQ->weight += weight;
+}
+
+static void _quadricAdd(struct _quadric* pQ, const struct _quadric* pOther)
+{
+	pQ->a00 += pOther->a00;
+	pQ->a11 += pOther->a11;
+	pQ->a22 += pOther->a22;
+	pQ->a01 += pOther->a01;
+	pQ->a02 += pOther->a02;
+	pQ->a12 += pOther->a12;
+	pQ->b0 += pOther->b0;
+	pQ->b1 += pOther->b1;
+	pQ->b2 += pOther->b2;
+	pQ->c += pOther->c;
+	pQ->weight += pOther->weight;
+}
+
+/*Average squared distance of a point to the planes*/
+static double _quadricError(const struct _quadric* pQ, const float* pPos)
+{
+	const double x = pPos[0];
+	const double y = pPos[1];
+	const double z = pPos[2];
+	const double error = pQ->a00 * x * x + pQ->a11 * y * y + pQ->a22 * z * z +
+		2.0 * (pQ->a01 * x * y + pQ->a02 * x * z + pQ->a12 * y * z) +
+		2.0 * (pQ->b0 * x + pQ->b1 * y + pQ->b2 * z) + pQ->c;
+	return pQ->weight > 0.0 ? fabs(error) / pQ->weight : 0.0;
+}
+
+/*Borders and seams are held in place by planes through the edge at a right angle to the triangle*/
+#define AS_MESH_BUILDER_EDGE_WEIGHT 10.0
+
+/*Attribute vertices kept per position, more and the position is locked*/
+#define AS_MESH_BUILDER_MAX_WEDGES 16
+
+struct _simplifyEdge
+{
+	uint64_t key; /*Lower position in the high bits*/
+	uint32_t tri;
+};
+
+struct _simplifyCollapse
+{
+	uint32_t from; /*Position moving onto another*/
+	uint32_t to;
+	uint32_t firstEdge; /*Triangles along the edge*/
+	uint32_t edgeCount;
+	double cost;
+};
+
+static int _compareSimplifyEdges(const void* pA, const void* pB)
+{
+	const struct _simplifyEdge* a = (const struct _simplifyEdge*)pA;
+	const struct _simplifyEdge* b = (const struct _simplifyEdge*)pB;
+	if (a->key != b->key)
+		return a->key < b->key ? -1 : 1;
+	return a->tri < b->tri ? -1 : (a->tri > b->tri ? 1 : 0);
+}
+
+static int _compareSimplifyCollapses(const void* pA, const void* pB)
+{
+	const struct _simplifyCollapse* a = (const struct _simplifyCollapse*)pA;
+	const struct _simplifyCollapse* b = (const struct _simplifyCollapse*)pB;
+	if (a->cost != b->cost)
+		return a->cost < b->cost ? -1 : 1;
+	return a->from < b->from ? -1 : (a->from > b->from ? 1 : 0);
+}
+
+struct _simplifyState
+{
+	const asVertexGeneric* pVertices;
+	uint32_t* pIndices; /*Current triangles*/
+	uint32_t indexCount;
+	uint32_t* pPositionOf; /*Position of every vertex*/
+	uint32_t positionCount;
+	const float** ppPositions; /*Of every position*/
+	struct _quadric* pQuadrics;
+	uint32_t* pPositionRemap; /*Where each position was collapsed to*/
+	uint32_t* pVertexRemap;
+	struct _simplifyEdge* pEdges;
+	struct _simplifyCollapse* pCollapses;
+	uint32_t* pTriOffsets; /*Triangles around each position*/
+	uint32_t* pTriAdjacency;
+	uint32_t* pWedges; /*Vertices at each position (laid out like the triangles)*/
+	uint32_t* pWedgeCounts;
+	uint8_t* pFlags;
+};
+
+#define AS_SIMPLIFY_LOCKED 1 /*Can not move*/
+#define AS_SIMPLIFY_BORDER 2 /*Only moves along open edges*/
+#define AS_SIMPLIFY_USED 4 /*Already part of a collapse this pass*/
+
+static uint32_t _simplifyCornerVertex(const struct _simplifyState* pState, uint32_t tri, uint32_t position)
+{
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		if (pState->pPositionOf[pState->pIndices[tri * 3 + k]] == position)
+			return pState->pIndices[tri * 3 + k];
+	}
+	return UINT32_MAX;
+}
+
+static uint32_t _simplifyResolve(const struct _simplifyState* pState, uint32_t position)
+{
+	while (pState->pPositionRemap[position] != position)
+		position = pState->pPositionRemap[position];
+	return position;
+}
+
+/*Every vertex at the moving position follows the triangles along the edge to a single vertex at the other end,
+so UV seams and normal creases can only collapse along themselves*/
+static bool _simplifyMapWedges(const struct _simplifyState* pState, const struct _simplifyCollapse* pCollapse, uint32_t* pTargets)
+{
+	const uint32_t* pWedges = &pState->pWedges[pState->pTriOffsets[pCollapse->from]];
+	for (uint32_t i = 0; i < pState->pWedgeCounts[pCollapse->from]; i++)
+	{
+		pTargets[i] = UINT32_MAX;
+		for (uint32_t e = 0; e < pCollapse->edgeCount; e++)
+		{
+			const uint32_t tri = pState->pEdges[pCollapse->firstEdge + e].tri;
+			if (_simplifyCornerVertex(pState, tri, pCollapse->from) != pWedges[i])
+				continue;
+			const uint32_t target = _simplifyCornerVertex(pState, tri, pCollapse->to);
+			if (pTargets[i] != UINT32_MAX && pTargets[i] != target)
+				return false;
+			pTargets[i] = target;
+		}
+		if (pTargets[i] == UINT32_MAX)
+			return false;
+	}
+	return true;
+}
+
+/*Triangles around the moving position may not turn over*/
+static bool _simplifyFlips(const struct _simplifyState* pState, const struct _simplifyCollapse* pCollapse)
+{
+	const float* pTo = pState->ppPositions[pCollapse->to];
+	for (uint32_t i = pState->pTriOffsets[pCollapse->from]; i < pState->pTriOffsets[pCollapse->from + 1]; i++)
+	{
+		const uint32_t tri = pState->pTriAdjacency[i];
+		uint32_t corners[3];
+		bool degenerate = false;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			corners[k] = _simplifyResolve(pState, pState->pPositionOf[pState->pIndices[tri * 3 + k]]);
+			degenerate |= corners[k] == pCollapse->to;
+		}
+		if (degenerate)
+			continue;
+		vec3 e0, e1, before, after;
+		const float* p0 = pState->ppPositions[corners[0]];
+		const float* p1 = pState->ppPositions[corners[1]];
+		const float* p2 = pState->ppPositions[corners[2]];
+		glm_vec3_sub((float*)p1, (float*)p0, e0);
+		glm_vec3_sub((float*)p2, (float*)p0, e1);
+		glm_vec3_cross(e0, e1, before);
+		p0 = corners[0] == pCollapse->from ? pTo : p0;
+		p1 = corners[1] == pCollapse->from ? pTo : p1;
+		p2 = corners[2] == pCollapse->from ? pTo : p2;
+		glm_vec3_sub((float*)p1, (float*)p0, e0);
+		glm_vec3_sub((float*)p2, (float*)p0, e1);
+		glm_vec3_cross(e0, e1, after);
+		if (glm_vec3_dot(before, after) <= 0.0f)
+			return true;
+	}
+	return false;
+}
+
+/*Sort the edges of the current triangles and work out what each position is allowed to do*/
+static uint32_t _simplifyClassify(struct _simplifyState* pState)
+{
+	const uint32_t triCount = pState->indexCount / 3;
+	for (uint32_t i = 0; i < triCount * 3; i++)
+	{
+		const uint32_t a = pState->pPositionOf[pState->pIndices[i]];
+		const uint32_t b = pState->pPositionOf[pState->pIndices[i - i % 3 + (i + 1) % 3]];
+		pState->pEdges[i].key = a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+		pState->pEdges[i].tri = i / 3;
+	}
+	qsort(pState->pEdges, triCount * 3, sizeof(struct _simplifyEdge), _compareSimplifyEdges);
+
+	/*Triangles and vertices around each position*/
+	memset(pState->pTriOffsets, 0, sizeof(uint32_t) * (pState->positionCount + 1));
+	for (uint32_t i = 0; i < triCount * 3; i++)
+		pState->pTriOffsets[pState->pPositionOf[pState->pIndices[i]] + 1]++;
+	for (uint32_t i = 0; i < pState->positionCount; i++)
+		pState->pTriOffsets[i + 1] += pState->pTriOffsets[i];
+	memset(pState->pWedgeCounts, 0, sizeof(uint32_t) * pState->positionCount);
+	memset(pState->pFlags, 0, pState->positionCount);
+	for (uint32_t i = 0; i < triCount * 3; i++)
+	{
+		const uint32_t vertex = pState->pIndices[i];
+		const uint32_t position = pState->pPositionOf[vertex];
+		pState->pTriAdjacency[pState->pTriOffsets[position] + pState->pWedgeCounts[position]++] = i / 3;
+	}
+	for (uint32_t p = 0; p < pState->positionCount; p++)
+	{
+		uint32_t* pWedges = &pState->pWedges[pState->pTriOffsets[p]];
+		uint32_t wedgeCount = 0;
+		for (uint32_t i = pState->pTriOffsets[p]; i < pState->pTriOffsets[p + 1]; i++)
+		{
+			const uint32_t vertex = _simplifyCornerVertex(pState, pState->pTriAdjacency[i], p);
+			uint32_t w = 0;
+			while (w < wedgeCount && pWedges[w] != vertex)
+				w++;
+			if (w == wedgeCount)
+				pWedges[wedgeCount++] = vertex;
+		}
+		pState->pWedgeCounts[p] = wedgeCount;
+		if (wedgeCount > AS_MESH_BUILDER_MAX_WEDGES)
+			pState->pFlags[p] |= AS_SIMPLIFY_LOCKED;
+	}
+
+	/*Open edges make a border, edges shared by more than two triangles lock their ends*/
+	uint32_t edgeCount = 0;
+	for (uint32_t i = 0; i < triCount * 3; i += edgeCount)
+	{
+		edgeCount = 1;
+		while (i + edgeCount < triCount * 3 && pState->pEdges[i + edgeCount].key == pState->pEdges[i].key)
+			edgeCount++;
+		const uint32_t a = (uint32_t)(pState->pEdges[i].key >> 32);
+		const uint32_t b = (uint32_t)pState->pEdges[i].key;
+		if (edgeCount == 1)
+		{
+			pState->pFlags[a] |= AS_SIMPLIFY_BORDER;
+			pState->pFlags[b] |= AS_SIMPLIFY_BORDER;
+		}
+		else if (edgeCount > 2)
+		{
+			pState->pFlags[a] |= AS_SIMPLIFY_LOCKED;
+			pState->pFlags[b] |= AS_SIMPLIFY_LOCKED;
+		}
+	}
+
+	/*Cheapest direction of every edge that can collapse*/
+	uint32_t collapseCount = 0;
+	for (uint32_t i = 0; i < triCount * 3; i += edgeCount)
+	{
+		edgeCount = 1;
+		while (i + edgeCount < triCount * 3 && pState->pEdges[i + edgeCount].key == pState->pEdges[i].key)
+			edgeCount++;
+		if (edgeCount > 2)
+			continue;
+		const uint32_t ends[2] = { (uint32_t)(pState->pEdges[i].key >> 32), (uint32_t)pState->pEdges[i].key };
+		struct _simplifyCollapse best;
+		best.cost = -1.0;
+		for (uint32_t d = 0; d < 2; d++)
+		{
+			struct _simplifyCollapse collapse;
+			collapse.from = ends[d];
+			collapse.to = ends[1 - d];
+			collapse.firstEdge = i;
+			collapse.edgeCount = edgeCount;
+			if (pState->pFlags[collapse.from] & AS_SIMPLIFY_LOCKED)
+				continue;
+			if ((pState->pFlags[collapse.from] & AS_SIMPLIFY_BORDER) && edgeCount != 1)
+				continue;
+			uint32_t targets[AS_MESH_BUILDER_MAX_WEDGES];
+			if (!_simplifyMapWedges(pState, &collapse, targets))
+				continue;
+			collapse.cost = _quadricError(&pState->pQuadrics[collapse.from], pState->ppPositions[collapse.to]);
+			if (best.cost < 0.0 || collapse.cost < best.cost)
+				best = collapse;
+		}
+		if (best.cost >= 0.0)
+			pState->pCollapses[collapseCount++] = best;
+	}
+	return collapseCount;
+}
+
+ASEXPORT asResults asMeshBuilder_Simplify(const asVertexGeneric* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount,
+	uint32_t targetIndexCount, float maxError, uint32_t* pOutIndices, uint32_t* pOutIndexCount, float* pOutError)
+{
+	indexCount -= indexCount % 3;
+	struct _simplifyState state;
+	memset(&state, 0, sizeof(state));
+	state.pVertices = pVertices;
+	state.pIndices = asMalloc(sizeof(uint32_t) * (indexCount + 3));
+	state.pPositionOf = asMalloc(sizeof(uint32_t) * (vertexCount + 1));
+	state.ppPositions = asMalloc(sizeof(float*) * (vertexCount + 1));
+	state.pQuadrics = asMalloc(sizeof(struct _quadric) * (vertexCount + 1));
+	state.pPositionRemap = asMalloc(sizeof(uint32_t) * (vertexCount + 1));
+	state.pVertexRemap = asMalloc(sizeof(uint32_t) * (vertexCount + 1));
+	state.pEdges = asMalloc(sizeof(struct _simplifyEdge) * (indexCount + 3));
+	state.pCollapses = asMalloc(sizeof(struct _simplifyCollapse) * (indexCount + 3));
+	state.pTriOffsets = asMalloc(sizeof(uint32_t) * (vertexCount + 2));
+	state.pTriAdjacency = asMalloc(sizeof(uint32_t) * (indexCount + 3));
+	state.pWedges = asMalloc(sizeof(uint32_t) * (indexCount + 3));
+	state.pWedgeCounts = asMalloc(sizeof(uint32_t) * (vertexCount + 1));
+	state.pFlags = asMalloc(vertexCount + 1);
+	uint32_t tableSize = 1;
+	while (tableSize < vertexCount + vertexCount / 4 + 1)
+		tableSize *= 2;
+	uint32_t* pTable = asMalloc(sizeof(uint32_t) * tableSize);
+	asResults result = AS_SUCCESS;
+	if (!state.pIndices || !state.pPositionOf || !state.ppPositions || !state.pQuadrics || !state.pPositionRemap || !state.pVertexRemap ||
+		!state.pEdges || !state.pCollapses || !state.pTriOffsets || !state.pTriAdjacency || !state.pWedges || !state.pWedgeCounts ||
+		!state.pFlags || !pTable)
+	{
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	}
+	float resultError = 0.0f;
+	if (result == AS_SUCCESS)
+	{
+		/*Vertices that only differ in attributes share a position*/
+		memset(pTable, 0xFF, sizeof(uint32_t) * tableSize);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			const float* pPos = pVertices[i].position;
+			uint32_t bucket = (uint32_t)asHashBytes64_xxHash(pPos, sizeof(float) * 3) & (tableSize - 1);
+			while (pTable[bucket] != UINT32_MAX && memcmp(state.ppPositions[pTable[bucket]], pPos, sizeof(float) * 3) != 0)
+				bucket = (bucket + 1) & (tableSize - 1);
+			if (pTable[bucket] == UINT32_MAX)
+			{
+				pTable[bucket] = state.positionCount;
+				state.ppPositions[state.positionCount++] = pPos;
+			}
+			state.pPositionOf[i] = pTable[bucket];
+		}
+		for (uint32_t i = 0; i < state.positionCount; i++)
+			state.pPositionRemap[i] = i;
+		for (uint32_t i = 0; i < vertexCount; i++)
+			state.pVertexRemap[i] = i;
+
+		/*Drop triangles without an area*/
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			const uint32_t a = state.pPositionOf[pIndices[i + 0]];
+			const uint32_t b = state.pPositionOf[pIndices[i + 1]];
+			const uint32_t c = state.pPositionOf[pIndices[i + 2]];
+			if (a == b || b == c || a == c)
+				continue;
+			memcpy(&state.pIndices[state.indexCount], &pIndices[i], sizeof(uint32_t) * 3);
+			state.indexCount += 3;
+		}
+
+		/*Quadrics of the triangle planes and of the planes holding borders and seams*/
+		memset(state.pQuadrics, 0, sizeof(struct _quadric) * state.positionCount);
+		for (uint32_t i = 0; i < state.indexCount; i += 3)
+		{
+			const uint32_t corners[3] = { state.pPositionOf[state.pIndices[i]], state.pPositionOf[state.pIndices[i + 1]], state.pPositionOf[state.pIndices[i + 2]] };
+			const float* p[3] = { state.ppPositions[corners[0]], state.ppPositions[corners[1]], state.ppPositions[corners[2]] };
+			double e0[3], e1[3], n[3];
+			for (int k = 0; k < 3; k++)
+			{
+				e0[k] = (double)p[1][k] - p[0][k];
+				e1[k] = (double)p[2][k] - p[0][k];
+			}
+			n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+			n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+			n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+			const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length <= 0.0)
+				continue;
+			for (int k = 0; k < 3; k++)
+				n[k] /= length;
+			const double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+			for (int k = 0; k < 3; k++)
+				_quadricAddPlane(&state.pQuadrics[corners[k]], n, d, length * 0.5);
+		}
+		_simplifyClassify(&state);
+		uint32_t edgeCount = 0;
+		for (uint32_t i = 0; i < state.indexCount; i += edgeCount)
+		{
+			edgeCount = 1;
+			while (i + edgeCount < state.indexCount && state.pEdges[i + edgeCount].key == state.pEdges[i].key)
+				edgeCount++;
+			const uint32_t a = (uint32_t)(state.pEdges[i].key >> 32);
+			const uint32_t b = (uint32_t)state.pEdges[i].key;
+			bool seam = edgeCount == 1;
+			if (edgeCount == 2)
+			{
+				const uint32_t t0 = state.pEdges[i].tri;
+				const uint32_t t1 = state.pEdges[i + 1].tri;
+				seam = _simplifyCornerVertex(&state, t0, a) != _simplifyCornerVertex(&state, t1, a) ||
+					_simplifyCornerVertex(&state, t0, b) != _simplifyCornerVertex(&state, t1, b);
+			}
+			if (!seam)
+				continue;
+			for (uint32_t e = 0; e < edgeCount; e++)
+			{
+				const uint32_t tri = state.pEdges[i + e].tri;
+				const float* p0 = state.ppPositions[state.pPositionOf[state.pIndices[tri * 3 + 0]]];
+				const float* p1 = state.ppPositions[state.pPositionOf[state.pIndices[tri * 3 + 1]]];
+				const float* p2 = state.ppPositions[state.pPositionOf[state.pIndices[tri * 3 + 2]]];
+				double e0[3], e1[3], edge[3], tn[3], n[3];
+				for (int k = 0; k < 3; k++)
+				{
+					e0[k] = (double)p1[k] - p0[k];
+					e1[k] = (double)p2[k] - p0[k];
+					edge[k] = (double)state.ppPositions[b][k] - state.ppPositions[a][k];
+				}
+				tn[0] = e0[1] * e1[2] - e0[2] * e1[1];
+				tn[1] = e0[2] * e1[0] - e0[0] * e1[2];
+				tn[2] = e0[0] * e1[1] - e0[1] * e1[0];
+				n[0] = edge[1] * tn[2] - edge[2] * tn[1];
+				n[1] = edge[2] * tn[0] - edge[0] * tn[2];
+				n[2] = edge[0] * tn[1] - edge[1] * tn[0];
+				const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				if (length <= 0.0)
+					continue;
+				for (int k = 0; k < 3; k++)
+					n[k] /= length;
+				const double d = -(n[0] * state.ppPositions[a][0] + n[1] * state.ppPositions[a][1] + n[2] * state.ppPositions[a][2]);
+				const double weight = AS_MESH_BUILDER_EDGE_WEIGHT * (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]) / (double)edgeCount;
+				_quadricAddPlane(&state.pQuadrics[a], n, d, weight);
+				_quadricAddPlane(&state.pQuadrics[b], n, d, weight);
+			}
+		}
+
+		/*Collapse the cheapest edges that do not touch each other every pass until the target is reached*/
+		const double maxErrorSq = (double)maxError * (double)maxError;
+		while (state.indexCount > targetIndexCount)
+		{
+			const uint32_t collapseCount = _simplifyClassify(&state);
+			qsort(state.pCollapses, collapseCount, sizeof(struct _simplifyCollapse), _compareSimplifyCollapses);
+			uint32_t removed = 0;
+			uint32_t applied = 0;
+			for (uint32_t i = 0; i < collapseCount && state.indexCount - removed * 3 > targetIndexCount; i++)
+			{
+				const struct _simplifyCollapse* pCollapse = &state.pCollapses[i];
+				if (pCollapse->cost > maxErrorSq)
+					break;
+				if ((state.pFlags[pCollapse->from] | state.pFlags[pCollapse->to]) & AS_SIMPLIFY_USED)
+					continue;
+				uint32_t targets[AS_MESH_BUILDER_MAX_WEDGES];
+				if (!_simplifyMapWedges(&state, pCollapse, targets) || _simplifyFlips(&state, pCollapse))
+					continue;
+				const uint32_t* pWedges = &state.pWedges[state.pTriOffsets[pCollapse->from]];
+				for (uint32_t w = 0; w < state.pWedgeCounts[pCollapse->from]; w++)
+					state.pVertexRemap[pWedges[w]] = targets[w];
+				state.pPositionRemap[pCollapse->from] = pCollapse->to;
+				_quadricAdd(&state.pQuadrics[pCollapse->to], &state.pQuadrics[pCollapse->from]);
+				state.pFlags[pCollapse->from] |= AS_SIMPLIFY_USED;
+				state.pFlags[pCollapse->to] |= AS_SIMPLIFY_USED;
+				removed += pCollapse->edgeCount;
+				applied++;
+				const float error = (float)sqrt(pCollapse->cost);
+				resultError = error > resultError ? error : resultError;
+			}
+			if (!applied)
+				break;
+
+			/*Move the triangles over and drop the ones that collapsed*/
+			uint32_t written = 0;
+			for (uint32_t i = 0; i < state.indexCount; i += 3)
+			{
+				uint32_t tri[3];
+				for (int k = 0; k < 3; k++)
+					tri[k] = state.pVertexRemap[state.pIndices[i + k]];
+				const uint32_t a = state.pPositionOf[tri[0]];
+				const uint32_t b = state.pPositionOf[tri[1]];
+				const uint32_t c = state.pPositionOf[tri[2]];
+				if (a == b || b == c || a == c)
+					continue;
+				memcpy(&state.pIndices[written], tri, sizeof(tri));
+				written += 3;
+			}
+			state.indexCount = written;
+		}
+		memcpy(pOutIndices, state.pIndices, sizeof(uint32_t) * state.indexCount);
+		*pOutIndexCount = state.indexCount;
+		if (pOutError)
+			*pOutError = resultError;
+	}
+
+	asFree(state.pIndices);
+	asFree(state.pPositionOf);
+	asFree((void*)state.ppPositions);
+	asFree(state.pQuadrics);
+	asFree(state.pPositionRemap);
+	asFree(state.pVertexRemap);
+	asFree(state.pEdges);
+	asFree(state.pCollapses);
+	asFree(state.pTriOffsets);
+	asFree(state.pTriAdjacency);
+	asFree(state.pWedges);
+	asFree(state.pWedgeCounts);
+	asFree(state.pFlags);
+	asFree(pTable);
+	return result;
+}
+
+ASEXPORT asMeshBuilderLodDesc_t asMeshBuilderLodDesc_Init()
+{
+	asMeshBuilderLodDesc_t desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.lodCount = 4;
+	desc.ratios[0] = 1.0f;
+	desc.ratios[1] = 0.5f;
+	desc.ratios[2] = 0.25f;
+	desc.ratios[3] = 0.125f;
+	desc.maxError = 0.05f;
+	return desc;
+}
+
+ASEXPORT asResults asMeshBuilder_GenerateLods(asMeshBuilderMesh_t* pMesh, const asMeshBuilderLodDesc_t* pDesc)
+{
+	if (pMesh->lodCount > 1 || pMesh->indexCount % 3 || pDesc->lodCount > AS_MESH_BUILDER_MAX_LODS)
+		return AS_FAILURE_INVALID_PARAM;
+	const uint32_t baseIndexCount = pMesh->indexCount;
+	pMesh->lodCount = 1;
+	pMesh->lods[0].firstIndex = 0;
+	pMesh->lods[0].indexCount = baseIndexCount;
+	pMesh->lods[0].error = 0.0f;
+	if (!baseIndexCount || pDesc->lodCount < 2)
+		return AS_SUCCESS;
+
+	/*Errors are relative to the size of the mesh*/
+	vec3 boundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+	vec3 boundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i = 0; i < baseIndexCount; i++)
+	{
+		glm_vec3_minv(boundsMin, (float*)pMesh->pVertices[pMesh->pIndices[i]].position, boundsMin);
+		glm_vec3_maxv(boundsMax, (float*)pMesh->pVertices[pMesh->pIndices[i]].position, boundsMax);
+	}
+	const float radius = glm_vec3_distance(boundsMin, boundsMax) * 0.5f;
+
+	/*Every level is simplified from the full mesh so its error is against the full mesh*/
+	uint32_t* pLevel = asMalloc(sizeof(uint32_t) * baseIndexCount);
+	if (!pLevel)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	asResults result = AS_SUCCESS;
+	for (uint32_t i = 1; i < pDesc->lodCount && result == AS_SUCCESS; i++)
+	{
+		const uint32_t targetIndexCount = (uint32_t)((float)(baseIndexCount / 3) * pDesc->ratios[i]) * 3;
+		uint32_t levelIndexCount = 0;
+		float error = 0.0f;
+		result = asMeshBuilder_Simplify(pMesh->pVertices, pMesh->vertexCount, pMesh->pIndices, baseIndexCount,
+			targetIndexCount, pDesc->maxError * radius, pLevel, &levelIndexCount, &error);
+		const asMeshBuilderLod_t* pPrevious = &pMesh->lods[pMesh->lodCount - 1];
+		if (result != AS_SUCCESS || !levelIndexCount || levelIndexCount >= pPrevious->indexCount)
+			break;
+		uint32_t* pIndices = asRealloc(pMesh->pIndices, sizeof(uint32_t) * (pMesh->indexCount + levelIndexCount));
+		if (!pIndices)
+		{
+			result = AS_FAILURE_OUT_OF_MEMORY;
+			break;
+		}
+		pMesh->pIndices = pIndices;
+		memcpy(&pMesh->pIndices[pMesh->indexCount], pLevel, sizeof(uint32_t) * levelIndexCount);
+		asMeshBuilderLod_t* pLod = &pMesh->lods[pMesh->lodCount++];
+		pLod->firstIndex = pMesh->indexCount;
+		pLod->indexCount = levelIndexCount;
+		pLod->error = error;
+		pMesh->indexCount += levelIndexCount;
+	}
+	asFree(pLevel);
+	return result;
+}
+
+/*Meshlets*/
+
+ASEXPORT asMeshBuilderMeshletDesc_t asMeshBuilderMeshletDesc_Init()
+{
+	asMeshBuilderMeshletDesc_t desc;
+	memset(&desc, 0, sizeof(desc));
+	desc.maxVertices = AS_MODEL_MESHLET_MAX_VERTICES;
+	desc.maxTriangles = AS_MODEL_MESHLET_MAX_TRIANGLES;
+	desc.coneWeight = 0.25f;
+	return desc;
+}
+
+/*Triangles that share no vertex with the meshlet are searched for this far ahead in the index order*/
+#define AS_MESH_BUILDER_MESHLET_SEARCH 256
+
+#define AS_MESHLET_NOT_LOCAL 0xFF
+
+struct _meshletState
+{
+	const asVertexGeneric* pVertices;
+	const uint32_t* pIndices; /*Of the level being split*/
+	uint32_t triCount;
+	uint32_t* pAdjacencyOffsets; /*First triangle around each vertex*/
+	uint32_t* pAdjacencyCounts; /*Triangles around each vertex that are not in a meshlet yet (at the front of its range)*/
+	uint32_t* pAdjacency;
+	uint8_t* pLocal; /*Index of each vertex in the meshlet being built*/
+	uint8_t* pEmitted;
+	float* pTriCenters;
+	float* pTriNormals; /*Unit length, zero for degenerate triangles*/
+
+	/*Meshlet being built*/
+	uint32_t vertices[AS_MODEL_MESHLET_MAX_VERTICES];
+	uint32_t vertexCount;
+	uint32_t triangles[AS_MODEL_MESHLET_MAX_TRIANGLES];
+	uint32_t triangleCount;
+	vec3 centerSum;
+	vec3 normalSum;
+};
+
+static uint32_t _meshletNewVertices(const struct _meshletState* pState, uint32_t tri)
+{
+	const uint32_t* pTri = &pState->pIndices[tri * 3];
+	uint32_t count = pState->pLocal[pTri[0]] == AS_MESHLET_NOT_LOCAL;
+	count += pTri[1] != pTri[0] && pState->pLocal[pTri[1]] == AS_MESHLET_NOT_LOCAL;
+	count += pTri[2] != pTri[0] && pTri[2] != pTri[1] && pState->pLocal[pTri[2]] == AS_MESHLET_NOT_LOCAL;
+	return count;
+}
+
+/*Closer triangles first, the cone weight makes the ones facing away from the meshlet further*/
+static float _meshletScore(const struct _meshletState* pState, uint32_t tri, const vec3 center, const vec3 axis, float coneWeight)
+{
+	const float distance = glm_vec3_distance((float*)center, &pState->pTriCenters[tri * 3]);
+	const float facing = glm_vec3_dot((float*)axis, &pState->pTriNormals[tri * 3]);
+	return distance * (1.0f - coneWeight * facing);
+}
+
+static void _meshletAddTriangle(struct _meshletState* pState, uint32_t tri)
+{
+	pState->pEmitted[tri] = 1;
+	pState->triangles[pState->triangleCount++] = tri;
+	glm_vec3_add(pState->centerSum, &pState->pTriCenters[tri * 3], pState->centerSum);
+	glm_vec3_add(pState->normalSum, &pState->pTriNormals[tri * 3], pState->normalSum);
+	for (int c = 0; c < 3; c++)
+	{
+		const uint32_t v = pState->pIndices[tri * 3 + c];
+		if (pState->pLocal[v] == AS_MESHLET_NOT_LOCAL)
+		{
+			pState->pLocal[v] = (uint8_t)pState->vertexCount;
+			pState->vertices[pState->vertexCount++] = v;
+		}
+		/*Take the triangle out of the live ones around the vertex (once per corner as it went in once per corner)*/
+		uint32_t* pAround = &pState->pAdjacency[pState->pAdjacencyOffsets[v]];
+		for (uint32_t i = 0; i < pState->pAdjacencyCounts[v]; i++)
+		{
+			if (pAround[i] == tri)
+			{
+				pAround[i] = pAround[--pState->pAdjacencyCounts[v]];
+				break;
+			}
+		}
+	}
+}
+
+/*Ritter's bounding sphere and the normal cone of the triangles (after Zeux's meshoptimizer)*/
+static void _meshletBounds(const struct _meshletState* pState, asModelMeshlet_t* pOut)
+{
+	const asVertexGeneric* pVertices = pState->pVertices;
+	const float* pFirst = pVertices[pState->vertices[0]].position;
+	const float* pA = pFirst;
+	const float* pB = pFirst;
+	float farthest = -1.0f;
+	for (uint32_t i = 0; i < pState->vertexCount; i++)
+	{
+		const float distance = glm_vec3_distance2((float*)pFirst, (float*)pVertices[pState->vertices[i]].position);
+		if (distance > farthest)
+		{
+			farthest = distance;
+			pA = pVertices[pState->vertices[i]].position;
+		}
+	}
+	farthest = -1.0f;
+	for (uint32_t i = 0; i < pState->vertexCount; i++)
+	{
+		const float distance = glm_vec3_distance2((float*)pA, (float*)pVertices[pState->vertices[i]].position);
+		if (distance > farthest)
+		{
+			farthest = distance;
+			pB = pVertices[pState->vertices[i]].position;
+		}
+	}
+	vec3 center;
+	glm_vec3_center((float*)pA, (float*)pB, center);
+	float radius = sqrtf(farthest) * 0.5f;
+	for (uint32_t i = 0; i < pState->vertexCount; i++)
+	{
+		float* pPos = (float*)pVertices[pState->vertices[i]].position;
+		const float distance = glm_vec3_distance(center, pPos);
+		if (distance > radius)
+		{
+			const float grownRadius = (radius + distance) * 0.5f;
+			vec3 toPos;
+			glm_vec3_sub(pPos, center, toPos);
+			glm_vec3_muladds(toPos, (grownRadius - radius) / distance, center);
+			radius = grownRadius;
+		}
+	}
+	/*Moving the center can leave points just outside through rounding*/
+	for (uint32_t i = 0; i < pState->vertexCount; i++)
+		radius = glm_max(radius, glm_vec3_distance(center, (float*)pVertices[pState->vertices[i]].position));
+	glm_vec3_copy(center, pOut->center);
+	pOut->radius = radius;
+
+	/*Normal cone, clusters with normals spread too far apart are never culled*/
+	vec3 axis;
+	glm_vec3_copy((float*)pState->normalSum, axis);
+	const float axisLength = glm_vec3_norm(axis);
+	glm_vec3_scale(axis, axisLength > 0.0f ? 1.0f / axisLength : 0.0f, axis);
+	float minFacing = 1.0f;
+	for (uint32_t i = 0; i < pState->triangleCount; i++)
+	{
+		const float* pNormal = &pState->pTriNormals[pState->triangles[i] * 3];
+		if (pNormal[0] != 0.0f || pNormal[1] != 0.0f || pNormal[2] != 0.0f)
+			minFacing = glm_min(minFacing, glm_vec3_dot(axis, (float*)pNormal));
+	}
+	glm_vec3_copy(axis, pOut->coneAxis);
+	glm_vec3_copy(center, pOut->coneApex);
+	pOut->coneCutoff = 1.0f;
+	if (axisLength <= 0.0f || minFacing <= 0.1f)
+		return;
+	/*The apex sits back along the axis until it is behind every triangle*/
+	float maxT = 0.0f;
+	for (uint32_t i = 0; i < pState->triangleCount; i++)
+	{
+		const float* pNormal = &pState->pTriNormals[pState->triangles[i] * 3];
+		const float facing = glm_vec3_dot(axis, (float*)pNormal);
+		if (facing <= 0.0f)
+			continue;
+		vec3 toCenter;
+		glm_vec3_sub(center, (float*)pVertices[pState->pIndices[pState->triangles[i] * 3]].position, toCenter);
+		maxT = glm_max(maxT, glm_vec3_dot(toCenter, (float*)pNormal) / facing);
+	}
+	glm_vec3_muladds(axis, -maxT, pOut->coneApex);
+	pOut->coneCutoff = sqrtf(1.0f - minFacing * minFacing);
+}
+
+static asResults _meshletReserve(asMeshBuilderMesh_t* pMesh, uint32_t* pCapacity)
+{
+	if (pMesh->meshletCount < *pCapacity)
+		return AS_SUCCESS;
+	const uint32_t capacity = *pCapacity ? *pCapacity * 2 : 64;
+	asModelMeshlet_t* pMeshlets = asRealloc(pMesh->pMeshlets, sizeof(asModelMeshlet_t) * capacity);
+	if (!pMeshlets)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	pMesh->pMeshlets = pMeshlets;
+	*pCapacity = capacity;
+	return AS_SUCCESS;
+}
+
+/*Split the triangles of one level, pOutIndices gets them in meshlet order*/
+static asResults _meshletSplitLevel(struct _meshletState* pState, asMeshBuilderMesh_t* pMesh, uint32_t firstIndex,
+	const asMeshBuilderMeshletDesc_t* pDesc, uint32_t* pOutIndices, uint32_t* pMeshletCapacity)
+{
+	const uint32_t triCount = pState->triCount;
+	const asVertexGeneric* pVertices = pState->pVertices;
+
+	/*Triangles around each vertex*/
+	for (uint32_t i = 0; i < triCount * 3; i++)
+		pState->pAdjacencyCounts[pState->pIndices[i]]++;
+	uint32_t offset = 0;
+	for (uint32_t i = 0; i < pMesh->vertexCount; i++)
+	{
+		pState->pAdjacencyOffsets[i] = offset;
+		offset += pState->pAdjacencyCounts[i];
+		pState->pAdjacencyCounts[i] = 0;
+	}
+	for (uint32_t i = 0; i < triCount * 3; i++)
+	{
+		const uint32_t v = pState->pIndices[i];
+		pState->pAdjacency[pState->pAdjacencyOffsets[v] + pState->pAdjacencyCounts[v]++] = i / 3;
+	}
+	for (uint32_t t = 0; t < triCount; t++)
+	{
+		const float* p0 = pVertices[pState->pIndices[t * 3 + 0]].position;
+		const float* p1 = pVertices[pState->pIndices[t * 3 + 1]].position;
+		const float* p2 = pVertices[pState->pIndices[t * 3 + 2]].position;
+		float* pCenter = &pState->pTriCenters[t * 3];
+		float* pNormal = &pState->pTriNormals[t * 3];
+		vec3 e0, e1;
+		glm_vec3_add((float*)p0, (float*)p1, pCenter);
+		glm_vec3_add(pCenter, (float*)p2, pCenter);
+		glm_vec3_scale(pCenter, 1.0f / 3.0f, pCenter);
+		glm_vec3_sub((float*)p1, (float*)p0, e0);
+		glm_vec3_sub((float*)p2, (float*)p0, e1);
+		glm_vec3_cross(e0, e1, pNormal);
+		const float length = glm_vec3_norm(pNormal);
+		glm_vec3_scale(pNormal, length > 0.0f ? 1.0f / length : 0.0f, pNormal);
+	}
+	memset(pState->pEmitted, 0, triCount);
+
+	uint32_t emittedCount = 0;
+	uint32_t seed = 0;
+	while (emittedCount < triCount)
+	{
+		while (pState->pEmitted[seed])
+			seed++;
+		pState->vertexCount = 0;
+		pState->triangleCount = 0;
+		glm_vec3_zero(pState->centerSum);
+		glm_vec3_zero(pState->normalSum);
+		_meshletAddTriangle(pState, seed);
+
+		while (pState->triangleCount < pDesc->maxTriangles)
+		{
+			vec3 center, axis;
+			glm_vec3_scale(pState->centerSum, 1.0f / (float)pState->triangleCount, center);
+			glm_vec3_normalize_to(pState->normalSum, axis);
+
+			/*Triangles around the vertices already in the meshlet, the ones adding the fewest vertices first*/
+			uint32_t best = UINT32_MAX;
+			uint32_t bestNew = 4;
+			float bestScore = FLT_MAX;
+			for (uint32_t i = 0; i < pState->vertexCount; i++)
+			{
+				const uint32_t v = pState->vertices[i];
+				const uint32_t* pAround = &pState->pAdjacency[pState->pAdjacencyOffsets[v]];
+				for (uint32_t j = 0; j < pState->pAdjacencyCounts[v]; j++)
+				{
+					const uint32_t newVertices = _meshletNewVertices(pState, pAround[j]);
+					if (pState->vertexCount + newVertices > pDesc->maxVertices || newVertices > bestNew)
+						continue;
+					const float score = _meshletScore(pState, pAround[j], center, axis, pDesc->coneWeight);
+					if (newVertices < bestNew || score < bestScore)
+					{
+						best = pAround[j];
+						bestNew = newVertices;
+						bestScore = score;
+					}
+				}
+			}
+			/*Nothing connected fits, take a close triangle from the ones that follow in the index order*/
+			if (best == UINT32_MAX)
+			{
+				const uint32_t searchEnd = seed + AS_MESH_BUILDER_MESHLET_SEARCH < triCount ? seed + AS_MESH_BUILDER_MESHLET_SEARCH : triCount;
+				for (uint32_t t = seed; t < searchEnd; t++)
+				{
+					if (pState->pEmitted[t] || pState->vertexCount + _meshletNewVertices(pState, t) > pDesc->maxVertices)
+						continue;
+					const float score = _meshletScore(pState, t, center, axis, pDesc->coneWeight);
+					if (score < bestScore)
+					{
+						best = t;
+						bestScore = score;
+					}
+				}
+			}
+			if (best == UINT32_MAX)
+				break;
+			_meshletAddTriangle(pState, best);
+		}
+
+		/*Write out the meshlet*/
+		asResults result = _meshletReserve(pMesh, pMeshletCapacity);
+		if (result != AS_SUCCESS)
+			return result;
+		asModelMeshlet_t* pMeshlet = &pMesh->pMeshlets[pMesh->meshletCount++];
+		memset(pMeshlet, 0, sizeof(asModelMeshlet_t));
+		pMeshlet->firstIndex = firstIndex + emittedCount * 3;
+		pMeshlet->firstVertex = pMesh->meshletVertexCount;
+		pMeshlet->firstTriangle = pMesh->meshletTriangleSize;
+		pMeshlet->vertexCount = (uint16_t)pState->vertexCount;
+		pMeshlet->triangleCount = (uint16_t)pState->triangleCount;
+		_meshletBounds(pState, pMeshlet);
+		uint8_t* pLocalTriangles = &pMesh->pMeshletTriangles[pMesh->meshletTriangleSize];
+		for (uint32_t i = 0; i < pState->triangleCount; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				const uint32_t v = pState->pIndices[pState->triangles[i] * 3 + c];
+				pOutIndices[(emittedCount + i) * 3 + c] = v;
+				pLocalTriangles[i * 3 + c] = pState->pLocal[v];
+			}
+		}
+		pMesh->meshletTriangleSize += (pState->triangleCount * 3 + 3) & ~3u;
+		for (uint32_t i = 0; i < pState->vertexCount; i++)
+		{
+			pMesh->pMeshletVertices[pMesh->meshletVertexCount++] = pState->vertices[i];
+			pState->pLocal[pState->vertices[i]] = AS_MESHLET_NOT_LOCAL;
+		}
+		emittedCount += pState->triangleCount;
+	}
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asMeshBuilder_BuildMeshlets(asMeshBuilderMesh_t* pMesh, const asMeshBuilderMeshletDesc_t* pDesc)
+{
+	if (pMesh->indexCount % 3 || pMesh->lodCount > AS_MESH_BUILDER_MAX_LODS ||
+		pDesc->maxVertices < 3 || pDesc->maxVertices > AS_MODEL_MESHLET_MAX_VERTICES ||
+		pDesc->maxTriangles < 1 || pDesc->maxTriangles > AS_MODEL_MESHLET_MAX_TRIANGLES)
+	{
+		return AS_FAILURE_INVALID_PARAM;
+	}
+	for (uint32_t i = 0; i < pMesh->indexCount; i++)
+	{
+		if (pMesh->pIndices[i] >= pMesh->vertexCount)
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	for (uint32_t i = 0; i < pMesh->lodCount; i++)
+	{
+		if (pMesh->lods[i].firstIndex + pMesh->lods[i].indexCount > pMesh->indexCount || pMesh->lods[i].indexCount % 3)
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	asFree(pMesh->pMeshlets);
+	asFree(pMesh->pMeshletVertices);
+	asFree(pMesh->pMeshletTriangles);
+	pMesh->pMeshlets = NULL;
+	pMesh->meshletCount = 0;
+	pMesh->meshletVertexCount = 0;
+	pMesh->meshletTriangleSize = 0;
+
+	/*Every corner can bring its own vertex and every meshlet pads its triangles to 4 bytes*/
+	const uint32_t triCount = pMesh->indexCount / 3;
+	const size_t vertexSlots = pMesh->vertexCount ? pMesh->vertexCount : 1;
+	const size_t triSlots = triCount ? triCount : 1;
+	struct _meshletState state;
+	memset(&state, 0, sizeof(state));
+	state.pVertices = pMesh->pVertices;
+	state.pAdjacencyOffsets = asMalloc(sizeof(uint32_t) * vertexSlots);
+	state.pAdjacencyCounts = asMalloc(sizeof(uint32_t) * vertexSlots);
+	state.pAdjacency = asMalloc(sizeof(uint32_t) * triSlots * 3);
+	state.pLocal = asMalloc(vertexSlots);
+	state.pEmitted = asMalloc(triSlots);
+	state.pTriCenters = asMalloc(sizeof(float) * triSlots * 3);
+	state.pTriNormals = asMalloc(sizeof(float) * triSlots * 3);
+	uint32_t* pLevelIndices = asMalloc(sizeof(uint32_t) * triSlots * 3);
+	pMesh->pMeshletVertices = asMalloc(sizeof(uint32_t) * triSlots * 3);
+	pMesh->pMeshletTriangles = asMalloc(triSlots * 6);
+	asResults result = AS_SUCCESS;
+	if (!state.pAdjacencyOffsets || !state.pAdjacencyCounts || !state.pAdjacency || !state.pLocal || !state.pEmitted ||
+		!state.pTriCenters || !state.pTriNormals || !pLevelIndices || !pMesh->pMeshletVertices || !pMesh->pMeshletTriangles)
+	{
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	}
+	else
+	{
+		memset(state.pLocal, AS_MESHLET_NOT_LOCAL, vertexSlots);
+	}
+
+	uint32_t meshletCapacity = 0;
+	const uint32_t levelCount = pMesh->lodCount ? pMesh->lodCount : 1;
+	for (uint32_t l = 0; l < levelCount && result == AS_SUCCESS; l++)
+	{
+		const uint32_t firstIndex = pMesh->lodCount ? pMesh->lods[l].firstIndex : 0;
+		const uint32_t indexCount = pMesh->lodCount ? pMesh->lods[l].indexCount : pMesh->indexCount;
+		const uint32_t firstMeshlet = pMesh->meshletCount;
+		memset(state.pAdjacencyCounts, 0, sizeof(uint32_t) * vertexSlots);
+		state.pIndices = &pMesh->pIndices[firstIndex];
+		state.triCount = indexCount / 3;
+		result = _meshletSplitLevel(&state, pMesh, firstIndex, pDesc, pLevelIndices, &meshletCapacity);
+		if (result != AS_SUCCESS)
+			break;
+		memcpy(&pMesh->pIndices[firstIndex], pLevelIndices, sizeof(uint32_t) * indexCount);
+		if (pMesh->lodCount)
+		{
+			pMesh->lods[l].firstMeshlet = firstMeshlet;
+			pMesh->lods[l].meshletCount = pMesh->meshletCount - firstMeshlet;
+		}
+	}
+
+	asFree(state.pAdjacencyOffsets);
+	asFree(state.pAdjacencyCounts);
+	asFree(state.pAdjacency);
+	asFree(state.pLocal);
+	asFree(state.pEmitted);
+	asFree(state.pTriCenters);
+	asFree(state.pTriNormals);
+	asFree(pLevelIndices);
+	if (result != AS_SUCCESS)
+	{
+		asFree(pMesh->pMeshlets);
+		asFree(pMesh->pMeshletVertices);
+		asFree(pMesh->pMeshletTriangles);
+		pMesh->pMeshlets = NULL;
+		pMesh->pMeshletVertices = NULL;
+		pMesh->pMeshletTriangles = NULL;
+		pMesh->meshletCount = 0;
+		pMesh->meshletVertexCount = 0;
+		pMesh->meshletTriangleSize = 0;
+		for (uint32_t l = 0; l < pMesh->lodCount; l++)
+			pMesh->lods[l].meshletCount = 0;
+	}
+	return result;
+}
+
+/*Tangents*/
+
+struct _tangentContext
+{
+	const float* pPositions;
+	const float* pNormals;
+	const float* pUVs;
+	const uint32_t* pIndices;
+	uint32_t indexCount;
+	float* pOutTangents;
+};
+
+static int _mikkGetNumFaces(const SMikkTSpaceContext* pContext)
+{
+	return (int)(((struct _tangentContext*)pContext->m_pUserData)->indexCount / 3);
+}
+
+static int _mikkGetNumVerticesOfFace(const SMikkTSpaceContext* pContext, const int face)
+{
+	return 3;
+}
+
+static void _mikkGetPosition(const SMikkTSpaceContext* pContext, float pos[], const int face, const int vert)
+{
+	const struct _tangentContext* pTangents = (struct _tangentContext*)pContext->m_pUserData;
+	memcpy(pos, &pTangents->pPositions[pTangents->pIndices[face * 3 + vert] * 3], sizeof(float) * 3);
+}
+
+static void _mikkGetNormal(const SMikkTSpaceContext* pContext, float normal[], const int face, const int vert)
+{
+	const struct _tangentContext* pTangents = (struct _tangentContext*)pContext->m_pUserData;
+	memcpy(normal, &pTangents->pNormals[pTangents->pIndices[face * 3 + vert] * 3], sizeof(float) * 3);
+}
+
+static void _mikkGetTexCoord(const SMikkTSpaceContext* pContext, float uv[], const int face, const int vert)
+{
+	const struct _tangentContext* pTangents = (struct _tangentContext*)pContext->m_pUserData;
+	memcpy(uv, &pTangents->pUVs[pTangents->pIndices[face * 3 + vert] * 2], sizeof(float) * 2);
+}
+
+static void _mikkSetTSpaceBasic(const SMikkTSpaceContext* pContext, const float tangent[], const float sign, const int face, const int vert)
+{
+	const struct _tangentContext* pTangents = (struct _tangentContext*)pContext->m_pUserData;
+	float* pOut = &pTangents->pOutTangents[(face * 3 + vert) * 4];
+	memcpy(pOut, tangent, sizeof(float) * 3);
+	pOut[3] = sign;
+}
+
+ASEXPORT asResults asMeshBuilder_GenerateTangents(const float* pPositions, const float* pNormals, const float* pUVs,
+	const uint32_t* pIndices, uint32_t indexCount, float* pOutTangents)
+{
+	if (indexCount % 3)
+		return AS_FAILURE_INVALID_PARAM;
+	struct _tangentContext tangents = { pPositions, pNormals, pUVs, pIndices, indexCount, pOutTangents };
+	SMikkTSpaceInterface callbacks;
+	memset(&callbacks, 0, sizeof(callbacks));
+	callbacks.m_getNumFaces = _mikkGetNumFaces;
+	callbacks.m_getNumVerticesOfFace = _mikkGetNumVerticesOfFace;
+	callbacks.m_getPosition = _mikkGetPosition;
+	callbacks.m_getNormal = _mikkGetNormal;
+	callbacks.m_getTexCoord = _mikkGetTexCoord;
+	callbacks.m_setTSpaceBasic = _mikkSetTSpaceBasic;
+	SMikkTSpaceContext context;
+	context.m_pInterface = &callbacks;
+	context.m_pUserData = &tangents;
+	/*Degenerate triangles are skipped by MikkTSpace so give them something usable*/
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		const float fallback[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+		memcpy(&pOutTangents[i * 4], fallback, sizeof(fallback));
+	}
+	if (!indexCount)
+		return AS_SUCCESS;
+	return genTangSpaceDefault(&context) ? AS_SUCCESS : AS_FAILURE_OUT_OF_MEMORY;
+}
+
+/*Model files*/
+
+static uint64_t _modelAlign(uint64_t offset)
+{
+	return (offset + AS_MODEL_ALIGNMENT - 1) & ~(uint64_t)(AS_MODEL_ALIGNMENT - 1);
+}
+
+/*Strings are packed one after another, missing ones share the empty string at the start*/
+static uint64_t _modelAddString(uint8_t* pBlob, uint64_t poolStart, uint64_t* pPoolEnd, const char* pString)
+{
+	if (!pString || !*pString)
+		return poolStart;
+	const size_t length = strlen(pString) + 1;
+	const uint64_t offset = *pPoolEnd;
+	if (pBlob)
+		memcpy(pBlob + offset, pString, length);
+	*pPoolEnd += length;
+	return offset;
+}
+
+static uint64_t _modelAddStrings(uint8_t* pBlob, uint64_t poolStart, const asMeshBuilderSubmesh_t* pSubmeshes, uint32_t submeshCount,
+	asModelSubmesh_t* pOutSubmeshes, const asModelMaterial_t* pMaterials, uint32_t materialCount, asModelMaterial_t* pOutMaterials)
+{
+	uint64_t poolEnd = poolStart + 1;
+	if (pBlob)
+		pBlob[poolStart] = '\0';
+	for (uint32_t i = 0; i < submeshCount; i++)
+	{
+		const uint64_t offset = _modelAddString(pBlob, poolStart, &poolEnd, pSubmeshes[i].name);
+		if (pOutSubmeshes)
+			pOutSubmeshes[i].name.offset = offset;
+	}
+	for (uint32_t i = 0; i < materialCount; i++)
+	{
+		const uint64_t offset = _modelAddString(pBlob, poolStart, &poolEnd, pMaterials[i].name.ptr);
+		if (pOutMaterials)
+			pOutMaterials[i].name.offset = offset;
+		for (uint32_t t = 0; t < AS_MODEL_TEXTURE_COUNT; t++)
+		{
+			const uint64_t textureOffset = _modelAddString(pBlob, poolStart, &poolEnd, pMaterials[i].textures[t].ptr);
+			if (pOutMaterials)
+				pOutMaterials[i].textures[t].offset = textureOffset;
+		}
+	}
+	return poolEnd;
+}
+
+/*Positions over the bounds of the whole model so submeshes that share an edge still meet after quantization,
+the vertices are snapped to the same positions so depth and shading passes rasterize the same surface*/
+static void _modelWritePositions(asModel_t* pHeader, asVertexGeneric* pVertices, uint8_t* pPositions)
+{
+	if (!(pHeader->flags & AS_MODEL_FLAG_QUANTIZED_POSITIONS))
+	{
+		for (uint32_t v = 0; v < pHeader->vertexCount; v++)
+			memcpy(pPositions + (size_t)v * pHeader->positionSize, pVertices[v].position, sizeof(float) * 3);
+		return;
+	}
+	glm_vec3_copy(pHeader->boundsMin, pHeader->positionOffset);
+	glm_vec3_sub(pHeader->boundsMax, pHeader->boundsMin, pHeader->positionScale);
+	uint16_t* pQuantized = (uint16_t*)pPositions;
+	for (uint32_t v = 0; v < pHeader->vertexCount; v++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			/*Flat axes keep the offset*/
+			const float scale = pHeader->positionScale[i];
+			const float unorm = scale > 0.0f ? (pVertices[v].position[i] - pHeader->positionOffset[i]) / scale : 0.0f;
+			const uint16_t q = (uint16_t)glm_clamp(roundf(unorm * 65535.0f), 0.0f, 65535.0f);
+			pQuantized[(size_t)v * 4 + i] = q;
+			pVertices[v].position[i] = pHeader->positionOffset[i] + scale * ((float)q / 65535.0f);
+		}
+		pQuantized[(size_t)v * 4 + 3] = 0;
+	}
+}
+
+ASEXPORT asResults asMeshBuilder_WriteModelFile(const char* pPath, const asMeshBuilderSubmesh_t* pSubmeshes, uint32_t submeshCount,
+	const asModelMaterial_t* pMaterials, uint32_t materialCount, uint32_t flags)
+{
+	asModel_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.tag, AS_MODEL_FILE_TAG, 4);
+	header.version = AS_MODEL_VERSION;
+	header.flags = flags;
+	header.submeshCount = submeshCount;
+	header.materialCount = materialCount;
+	header.indexSize = 2;
+	header.positionSize = (flags & AS_MODEL_FLAG_QUANTIZED_POSITIONS) ? sizeof(uint16_t) * 4 : sizeof(float) * 3;
+	glm_vec3_broadcast(submeshCount ? FLT_MAX : 0.0f, header.boundsMin);
+	glm_vec3_broadcast(submeshCount ? -FLT_MAX : 0.0f, header.boundsMax);
+	for (uint32_t i = 0; i < submeshCount; i++)
+	{
+		const asMeshBuilderMesh_t* pMesh = &pSubmeshes[i].mesh;
+		for (uint32_t j = 0; j < pMesh->indexCount; j++)
+		{
+			if (pMesh->pIndices[j] >= pMesh->vertexCount)
+				return AS_FAILURE_INVALID_PARAM;
+		}
+		if (pSubmeshes[i].materialIndex >= materialCount)
+			return AS_FAILURE_INVALID_PARAM;
+		if (asMeshBuilder_GetIndexSize(pMesh->vertexCount) > header.indexSize)
+			header.indexSize = asMeshBuilder_GetIndexSize(pMesh->vertexCount);
+		header.vertexCount += pMesh->vertexCount;
+		header.indexCount += pMesh->indexCount;
+		header.meshletCount += pMesh->meshletCount;
+		header.meshletVertexCount += pMesh->meshletVertexCount;
+		header.meshletTriangleSize += pMesh->meshletTriangleSize;
+	}
+
+	/*Layout of the blob, every table aligned so it can be used in place*/
+	header.submeshes.offset = _modelAlign(sizeof(asModel_t));
+	header.materials.offset = _modelAlign(header.submeshes.offset + sizeof(asModelSubmesh_t) * submeshCount);
+	const uint64_t poolStart = header.materials.offset + sizeof(asModelMaterial_t) * materialCount;
+	const uint64_t poolEnd = _modelAddStrings(NULL, poolStart, pSubmeshes, submeshCount, NULL, pMaterials, materialCount, NULL);
+	header.vertices.offset = _modelAlign(poolEnd);
+	header.positions.offset = _modelAlign(header.vertices.offset + sizeof(asVertexGeneric) * header.vertexCount);
+	header.indices.offset = _modelAlign(header.positions.offset + (uint64_t)header.positionSize * header.vertexCount);
+	header.meshlets.offset = _modelAlign(header.indices.offset + (uint64_t)header.indexSize * header.indexCount);
+	header.meshletVertices.offset = _modelAlign(header.meshlets.offset + sizeof(asModelMeshlet_t) * header.meshletCount);
+	header.meshletTriangles.offset = _modelAlign(header.meshletVertices.offset + sizeof(uint32_t) * header.meshletVertexCount);
+	header.size = _modelAlign(header.meshletTriangles.offset + header.meshletTriangleSize);
+	if (header.size > SIZE_MAX)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	uint8_t* pBlob = asMalloc((size_t)header.size);
+	if (!pBlob)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	memset(pBlob, 0, (size_t)header.size);
+	asModelSubmesh_t* pOutSubmeshes = (asModelSubmesh_t*)(pBlob + header.submeshes.offset);
+	asModelMaterial_t* pOutMaterials = (asModelMaterial_t*)(pBlob + header.materials.offset);
+	asVertexGeneric* pVertices = (asVertexGeneric*)(pBlob + header.vertices.offset);
+	uint8_t* pIndices = pBlob + header.indices.offset;
+	asModelMeshlet_t* pMeshlets = (asModelMeshlet_t*)(pBlob + header.meshlets.offset);
+	uint32_t* pMeshletVertices = (uint32_t*)(pBlob + header.meshletVertices.offset);
+	uint8_t* pMeshletTriangles = pBlob + header.meshletTriangles.offset;
+	if (materialCount)
+		memcpy(pOutMaterials, pMaterials, sizeof(asModelMaterial_t) * materialCount);
+	_modelAddStrings(pBlob, poolStart, pSubmeshes, submeshCount, pOutSubmeshes, pMaterials, materialCount, pOutMaterials);
+
+	/*Every submesh one after another with indices relative to its first vertex*/
+	uint32_t vertexOffset = 0;
+	uint32_t indexOffset = 0;
+	uint32_t meshletOffset = 0;
+	uint32_t meshletVertexOffset = 0;
+	uint32_t meshletTriangleOffset = 0;
+	for (uint32_t i = 0; i < submeshCount; i++)
+	{
+		const asMeshBuilderMesh_t* pMesh = &pSubmeshes[i].mesh;
+		asModelSubmesh_t* pOut = &pOutSubmeshes[i];
+		pOut->material.offset = header.materials.offset + sizeof(asModelMaterial_t) * pSubmeshes[i].materialIndex;
+		pOut->vertexOffset = vertexOffset;
+		pOut->vertexCount = pMesh->vertexCount;
+		pOut->materialIndex = pSubmeshes[i].materialIndex;
+		if (pMesh->lodCount)
+		{
+			pOut->lodCount = pMesh->lodCount;
+			for (uint32_t l = 0; l < pMesh->lodCount; l++)
+			{
+				pOut->lods[l].firstIndex = indexOffset + pMesh->lods[l].firstIndex;
+				pOut->lods[l].indexCount = pMesh->lods[l].indexCount;
+				pOut->lods[l].error = pMesh->lods[l].error;
+				pOut->lods[l].firstMeshlet = meshletOffset + pMesh->lods[l].firstMeshlet;
+				pOut->lods[l].meshletCount = pMesh->lods[l].meshletCount;
+			}
+		}
+		else
+		{
+			pOut->lodCount = 1;
+			pOut->lods[0].firstIndex = indexOffset;
+			pOut->lods[0].indexCount = pMesh->indexCount;
+			pOut->lods[0].firstMeshlet = meshletOffset;
+			pOut->lods[0].meshletCount = pMesh->meshletCount;
+		}
+		glm_vec3_broadcast(pMesh->vertexCount ? FLT_MAX : 0.0f, pOut->boundsMin);
+		glm_vec3_broadcast(pMesh->vertexCount ? -FLT_MAX : 0.0f, pOut->boundsMax);
+		for (uint32_t v = 0; v < pMesh->vertexCount; v++)
+		{
+			glm_vec3_minv(pOut->boundsMin, (float*)pMesh->pVertices[v].position, pOut->boundsMin);
+			glm_vec3_maxv(pOut->boundsMax, (float*)pMesh->pVertices[v].position, pOut->boundsMax);
+		}
+		glm_vec3_minv(header.boundsMin, pOut->boundsMin, header.boundsMin);
+		glm_vec3_maxv(header.boundsMax, pOut->boundsMax, header.boundsMax);
+
+		memcpy(&pVertices[vertexOffset], pMesh->pVertices, sizeof(asVertexGeneric) * pMesh->vertexCount);
+		asMeshBuilder_WriteIndices(pIndices + (size_t)indexOffset * header.indexSize, header.indexSize, pMesh->pIndices, pMesh->indexCount);
+
+		/*Meshlets move with the submesh into the shared tables*/
+		for (uint32_t m = 0; m < pMesh->meshletCount; m++)
+		{
+			asModelMeshlet_t* pMeshlet = &pMeshlets[meshletOffset + m];
+			*pMeshlet = pMesh->pMeshlets[m];
+			pMeshlet->firstIndex += indexOffset;
+			pMeshlet->baseVertex = vertexOffset;
+			pMeshlet->firstVertex += meshletVertexOffset;
+			pMeshlet->firstTriangle += meshletTriangleOffset;
+		}
+		if (pMesh->meshletVertexCount)
+			memcpy(&pMeshletVertices[meshletVertexOffset], pMesh->pMeshletVertices, sizeof(uint32_t) * pMesh->meshletVertexCount);
+		if (pMesh->meshletTriangleSize)
+			memcpy(&pMeshletTriangles[meshletTriangleOffset], pMesh->pMeshletTriangles, pMesh->meshletTriangleSize);
+		vertexOffset += pMesh->vertexCount;
+		indexOffset += pMesh->indexCount;
+		meshletOffset += pMesh->meshletCount;
+		meshletVertexOffset += pMesh->meshletVertexCount;
+		meshletTriangleOffset += pMesh->meshletTriangleSize;
+	}
+	_modelWritePositions(&header, pVertices, pBlob + header.positions.offset);
+	memcpy(pBlob, &header, sizeof(header));
+
+	FILE* fp = fopen(pPath, "wb");
+	asResults result = fp ? AS_SUCCESS : AS_FAILURE_FILE_INACCESSIBLE;
+	if (fp && fwrite(pBlob, (size_t)header.size, 1, fp) != 1)
+		result = AS_FAILURE_FILE_INACCESSIBLE;
+	if (fp)
+		fclose(fp);
+	asFree(pBlob);
+	return result;
+}
+
+/*Interface*/
+
+ASEXPORT asResults asMeshBuilder_Optimize(asMeshBuilderMesh_t* pMesh, uint32_t flags)
+{
+	if (pMesh->indexCount % 3 || pMesh->lodCount > AS_MESH_BUILDER_MAX_LODS)
+		return AS_FAILURE_INVALID_PARAM;
+	for (uint32_t i = 0; i < pMesh->indexCount; i++)
+	{
+		if (pMesh->pIndices[i] >= pMesh->vertexCount)
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	for (uint32_t i = 0; i < pMesh->lodCount; i++)
+	{
+		if (pMesh->lods[i].firstIndex + pMesh->lods[i].indexCount > pMesh->indexCount || pMesh->lods[i].indexCount % 3)
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	asResults result = AS_SUCCESS;
+	if (flags & AS_MESHOPTIMIZE_WELD)
+		result = asMeshBuilder_WeldVertices(pMesh);
+	/*Levels of detail are drawn on their own so each is ordered on its own*/
+	const uint32_t levelCount = pMesh->lodCount ? pMesh->lodCount : 1;
+	for (uint32_t i = 0; i < levelCount && result == AS_SUCCESS; i++)
+	{
+		uint32_t* pIndices = pMesh->lodCount ? &pMesh->pIndices[pMesh->lods[i].firstIndex] : pMesh->pIndices;
+		const uint32_t indexCount = pMesh->lodCount ? pMesh->lods[i].indexCount : pMesh->indexCount;
+		if (flags & AS_MESHOPTIMIZE_VERTEX_CACHE)
+			result = asMeshBuilder_OptimizeVertexCache(pIndices, indexCount, pMesh->vertexCount);
+		if (result == AS_SUCCESS && (flags & AS_MESHOPTIMIZE_OVERDRAW))
+			result = asMeshBuilder_OptimizeOverdraw(pIndices, indexCount, pMesh->pVertices, pMesh->vertexCount, AS_MESH_BUILDER_OVERDRAW_THRESHOLD);
+	}
+	if (result == AS_SUCCESS && (flags & AS_MESHOPTIMIZE_VERTEX_FETCH))
+		result = asMeshBuilder_OptimizeVertexFetch(pMesh);
+	return result;
+}
+
+ASEXPORT uint32_t asMeshBuilder_GetIndexSize(uint32_t vertexCount)
+{
+	return vertexCount <= UINT16_MAX ? 2 : 4;
+}
+
+ASEXPORT void asMeshBuilder_WriteIndices(void* pDst, uint32_t indexSize, const uint32_t* pIndices, uint32_t indexCount)
+{
+	if (indexSize == 4)
+	{
+		memcpy(pDst, pIndices, sizeof(uint32_t) * indexCount);
+		return;
+	}
+	uint16_t* pDst16 = (uint16_t*)pDst;
+	for (uint32_t i = 0; i < indexCount; i++)
+		pDst16[i] = (uint16_t)pIndices[i];
+}
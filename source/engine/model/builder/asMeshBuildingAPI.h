@@ -0,0 +1,228 @@
+#ifndef _ASMESHBUILDINGAPI_H_
+#define _ASMESHBUILDINGAPI_H_
+
+#include "../runtime/asModelRuntime.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Offline optimization of indexed triangle meshes before they are sent to the GPU
+* Duplicate vertices are welded, triangles are ordered for the post transform vertex cache and then
+* for less overdraw, and vertices are ordered by first use so fetches stay local.
+* Indices are 32 bit while building and can be written out as 16 bit when the vertex count allows it.
+* Levels of detail are simplified with quadric error metrics and share the vertices of the full mesh
+* and can be split into meshlets (small clusters of triangles with bounds for culling them on the GPU)
+* Built submeshes are written out as asMdl files
+*/
+
+/**
+* @brief Vertex cache size the triangle order is optimized for
+*/
+#define AS_MESH_BUILDER_CACHE_SIZE 32
+
+/**
+* @brief Default ACMR growth allowed when reordering for overdraw
+*/
+#define AS_MESH_BUILDER_OVERDRAW_THRESHOLD 1.05f
+
+/**
+* @brief Maximum number of levels of detail (including the full mesh)
+*/
+#define AS_MESH_BUILDER_MAX_LODS AS_MODEL_MAX_LODS
+
+/**
+* @brief Indices of a level of detail
+*/
+typedef struct {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float error; /**< Distance the level may be from the surface of the full mesh (in model units)*/
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+} asMeshBuilderLod_t;
+
+/**
+* @brief Indexed triangle list being built
+*/
+typedef struct {
+	asVertexGeneric* pVertices; /**< Reordered (and shrunk) in place*/
+	uint32_t vertexCount;
+	uint32_t* pIndices; /**< Three per triangle, every level of detail one after another*/
+	uint32_t indexCount;
+	uint32_t lodCount; /**< 0 when the indices are a single level*/
+	asMeshBuilderLod_t lods[AS_MESH_BUILDER_MAX_LODS];
+	asModelMeshlet_t* pMeshlets; /**< From asMeshBuilder_BuildMeshlets() (firstIndex into pIndices and baseVertex 0), free with asFree()*/
+	uint32_t meshletCount;
+	uint32_t* pMeshletVertices;
+	uint32_t meshletVertexCount;
+	uint8_t* pMeshletTriangles;
+	uint32_t meshletTriangleSize; /**< Bytes*/
+} asMeshBuilderMesh_t;
+
+/**
+* @brief Steps of asMeshBuilder_Optimize()
+*/
+typedef enum {
+	AS_MESHOPTIMIZE_WELD = 1 << 0, /**< Merge identical vertices*/
+	AS_MESHOPTIMIZE_VERTEX_CACHE = 1 << 1, /**< Order triangles for the vertex cache*/
+	AS_MESHOPTIMIZE_OVERDRAW = 1 << 2, /**< Order clusters of triangles front to back (needs the vertex cache order)*/
+	AS_MESHOPTIMIZE_VERTEX_FETCH = 1 << 3, /**< Order vertices by first use and drop unused ones*/
+	AS_MESHOPTIMIZE_ALL = AS_MESHOPTIMIZE_WELD | AS_MESHOPTIMIZE_VERTEX_CACHE | AS_MESHOPTIMIZE_OVERDRAW | AS_MESHOPTIMIZE_VERTEX_FETCH,
+	AS_MESHOPTIMIZE_MAX = UINT32_MAX
+} asMeshOptimizeFlags;
+
+/**
+* @brief Run the optimization steps in order (weld, vertex cache, overdraw, vertex fetch)
+* triangles are only reordered within their level of detail
+* @return AS_FAILURE_INVALID_PARAM if an index is out of range or the index count is not a multiple of 3
+*/
+ASEXPORT asResults asMeshBuilder_Optimize(asMeshBuilderMesh_t* pMesh, uint32_t flags);
+
+/**
+* @brief Merge vertices that are identical bit for bit and remap the indices
+*/
+ASEXPORT asResults asMeshBuilder_WeldVertices(asMeshBuilderMesh_t* pMesh);
+
+/**
+* @brief Reorder triangles so vertices are reused while they are still in the post transform cache
+* (Forsyth's linear speed optimization with an LRU cache of AS_MESH_BUILDER_CACHE_SIZE)
+*/
+ASEXPORT asResults asMeshBuilder_OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+
+/**
+* @brief Reorder clusters of a vertex cache optimized triangle list so outward facing clusters draw first
+* @param threshold how much worse the ACMR may get for smaller clusters (AS_MESH_BUILDER_OVERDRAW_THRESHOLD)
+*/
+ASEXPORT asResults asMeshBuilder_OptimizeOverdraw(uint32_t* pIndices, uint32_t indexCount,
+	const asVertexGeneric* pVertices, uint32_t vertexCount, float threshold);
+
+/**
+* @brief Reorder vertices by their first use in the indices (unused vertices are removed)
+*/
+ASEXPORT asResults asMeshBuilder_OptimizeVertexFetch(asMeshBuilderMesh_t* pMesh);
+
+/*Simplification*/
+
+/**
+* @brief Simplify a triangle list by collapsing the edges that move the surface the least (quadric error metrics)
+* Vertices only move onto their neighbors and keep their attributes, UV seams, normal creases and open borders
+* only collapse along themselves so they stay intact
+* @param targetIndexCount stop once there are this many indices or fewer
+* @param maxError stop before the surface moves further than this (in model units)
+* @param pOutIndices room for indexCount indices (may be the same as pIndices)
+* @param pOutError filled with the largest distance from the original surface (optional)
+*/
+ASEXPORT asResults asMeshBuilder_Simplify(const asVertexGeneric* pVertices, uint32_t vertexCount, const uint32_t* pIndices, uint32_t indexCount,
+	uint32_t targetIndexCount, float maxError, uint32_t* pOutIndices, uint32_t* pOutIndexCount, float* pOutError);
+
+/**
+* @brief Description of a level of detail chain
+*/
+typedef struct {
+	uint32_t lodCount; /**< Levels including the full mesh*/
+	float ratios[AS_MESH_BUILDER_MAX_LODS]; /**< Fraction of the triangles kept by each level (the first is the full mesh)*/
+	float maxError; /**< Largest error of a level as a fraction of the mesh radius (the chain ends early once reached)*/
+} asMeshBuilderLodDesc_t;
+
+/**
+* @brief Set the defaults for a level of detail chain (50%, 25% and 12.5% of the triangles at up to 5% of the radius)
+*/
+ASEXPORT asMeshBuilderLodDesc_t asMeshBuilderLodDesc_Init();
+
+/**
+* @brief Simplify a single level mesh into a chain of levels of detail (stored in the mesh after its indices)
+* levels that would not remove any more triangles are left out
+* @warning pIndices must come from asMalloc() as it grows to hold every level
+*/
+ASEXPORT asResults asMeshBuilder_GenerateLods(asMeshBuilderMesh_t* pMesh, const asMeshBuilderLodDesc_t* pDesc);
+
+/*Meshlets*/
+
+/**
+* @brief Description of how a mesh is split into meshlets
+*/
+typedef struct {
+	uint32_t maxVertices; /**< Up to AS_MODEL_MESHLET_MAX_VERTICES*/
+	uint32_t maxTriangles; /**< Up to AS_MODEL_MESHLET_MAX_TRIANGLES*/
+	float coneWeight; /**< 0 groups triangles by distance only, towards 1 also by facing for tighter normal cones*/
+} asMeshBuilderMeshletDesc_t;
+
+/**
+* @brief Set the defaults for meshlets (64 vertices and 124 triangles with a cone weight of 0.25)
+*/
+ASEXPORT asMeshBuilderMeshletDesc_t asMeshBuilderMeshletDesc_Init();
+
+/**
+* @brief Split every level of detail into meshlets with a bounding sphere and normal cone each
+* Triangles are grown from a seed through shared vertices (closest and best facing first) until a limit is reached,
+* the triangles of each level are reordered so every meshlet is a contiguous range of indices
+* @warning run it after asMeshBuilder_Optimize() as reordering vertices or triangles afterwards leaves the meshlets stale,
+* existing meshlets are replaced
+*/
+ASEXPORT asResults asMeshBuilder_BuildMeshlets(asMeshBuilderMesh_t* pMesh, const asMeshBuilderMeshletDesc_t* pDesc);
+
+/*Tangents*/
+
+/**
+* @brief Generate MikkTSpace tangents for an indexed triangle list
+* @param pPositions 3 floats per vertex
+* @param pNormals 3 floats per vertex
+* @param pUVs 2 floats per vertex
+* @param pOutTangents 4 floats per index (XYZ and the bitangent sign in W), corners sharing a vertex may get different tangents
+*/
+ASEXPORT asResults asMeshBuilder_GenerateTangents(const float* pPositions, const float* pNormals, const float* pUVs,
+	const uint32_t* pIndices, uint32_t indexCount, float* pOutTangents);
+
+/*Model files*/
+
+/**
+* @brief A built mesh and the material it is drawn with
+*/
+typedef struct {
+	char name[AS_MODEL_MAX_NAME];
+	asMeshBuilderMesh_t mesh;
+	uint32_t materialIndex;
+} asMeshBuilderSubmesh_t;
+
+/**
+* @brief Write submeshes and materials into a load in place asMdl file (see asModel_t)
+* indices are written at the smallest size every submesh fits in, meshlets are written for the submeshes that have them
+* the position stream is quantized over the bounds of the whole model with AS_MODEL_FLAG_QUANTIZED_POSITIONS (vertices are snapped to match)
+* @param pMaterials names and texture paths are read through ptr (NULL for none) and written as offsets
+* @param flags asModelFlags
+*/
+ASEXPORT asResults asMeshBuilder_WriteModelFile(const char* pPath, const asMeshBuilderSubmesh_t* pSubmeshes, uint32_t submeshCount,
+	const asModelMaterial_t* pMaterials, uint32_t materialCount, uint32_t flags);
+
+/**
+* @brief Post transform cache efficiency of a triangle list
+*/
+typedef struct {
+	uint32_t verticesTransformed; /**< Cache misses*/
+	float acmr; /**< Average cache miss ratio, vertices transformed per triangle (3 is the worst, about 0.5 the best)*/
+	float atvr; /**< Average transform to vertex ratio, vertices transformed per vertex (1 is the best)*/
+} asVertexCacheStats_t;
+
+/**
+* @brief Simulate a FIFO vertex cache over the triangles
+*/
+ASEXPORT asVertexCacheStats_t asMeshBuilder_AnalyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize);
+
+/**
+* @brief Size of each index needed for a vertex count (2 when 16 bit indices are enough otherwise 4)
+* 0xFFFF is never used as an index so it stays free for primitive restart
+*/
+ASEXPORT uint32_t asMeshBuilder_GetIndexSize(uint32_t vertexCount);
+
+/**
+* @brief Write indices at an index size from asMeshBuilder_GetIndexSize()
+* @param pDst indexCount * indexSize bytes
+*/
+ASEXPORT void asMeshBuilder_WriteIndices(void* pDst, uint32_t indexSize, const uint32_t* pIndices, uint32_t indexCount);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,7 +1,5 @@
 #include "asModelRuntime.h"
 
-#include "tiny_imageFormat/encodehelpers.h"
-
 ASEXPORT void asVertexGeneric_encodePosition(asVertexGeneric* pVertex, const vec3 pos)
 {
 	float* pPos = (float*)pVertex->position;
@@ -10,71 +8,19 @@ ASEXPORT void asVertexGeneric_encodePosition(asVertexGeneric* pVertex, const vec
 
 ASEXPORT void asVertexGeneric_encodeNormal(asVertexGeneric* pVertex, const vec3 normal)
 {
-	/*struct encoding {
-		union {
-			struct {
-				uint16_t b : 10;
-				uint16_t g : 11;
-				uint16_t r : 11;
-			};
-			uint32_t full;
-		};
-	};
-	vec3 normalizedNormal = {
-		normal[0] * 0.5f + 0.5f,
-		normal[1] * 0.5f + 0.5f,
-		normal[2] * 0.5f + 0.5f };
-	struct encoding result;
-	result.full = 0;
-	result.b = TinyImageFormat_FloatToUFloat10AsUint(normalizedNormal[2]);
-	result.g = TinyImageFormat_FloatToUFloat11AsUint(normalizedNormal[1]);
-	result.r = TinyImageFormat_FloatToUFloat11AsUint(normalizedNormal[0]);*/
-	struct encoding {
-		union {
-			struct {
-				int b : 10;
-				int g : 10;
-				int r : 10;
-				int a : 2;
-			};
-			uint32_t full;
-		};
-	};
-	struct encoding result;
-	result.full = 0;
-	result.r = ((int)(normal[0] * 511));
-	result.g = ((int)(normal[1] * 511));
-	result.b = ((int)(normal[2] * 511));
-	pVertex->normal = result.full;
+	asVertexEncode_Normals(&pVertex->normal, normal, 1, AS_VERTEX_NORMAL_SNORM10);
 }
 
 ASEXPORT void asVertexGeneric_encodeTangent(asVertexGeneric* pVertex, const vec3 tangent, const int sign)
 {
-	struct encoding {
-		union {
-			struct {
-				int b : 10;
-				int g : 10;
-				int r : 10;
-				int a : 2;
-			};
-			uint32_t full;
-		};
-	};
-	struct encoding result;
-	result.full = 0;
-	result.a = sign;
-	result.r = (int)(tangent[0] * 511);
-	result.g = (int)(tangent[1] * 511);
-	result.b = (int)(tangent[2] * 511);
-	pVertex->tangent = result.full;
+	const float tangentSign[4] = { tangent[0], tangent[1], tangent[2], (float)sign };
+	asVertexEncode_Tangents(&pVertex->tangent, tangentSign, 1);
 }
 
 ASEXPORT void asVertexGeneric_encodeUV(asVertexGeneric* pVertex, int uvSet, const vec2 uv)
 {
 	uint16_t* pUVSet = (uint16_t*)((uvSet == 0) ? &pVertex->uv0 : &pVertex->uv1);
-	pUVSet[0] = TinyImageFormat_FloatToHalfAsUint(uv[0]);
-	pUVSet[1] = TinyImageFormat_FloatToHalfAsUint(uv[1]);
+	asVertexEncode_FloatToHalf(pUVSet, uv, 2);
 }
 
 ASEXPORT void asVertexGeneric_encodeColor(asVertexGeneric* pVertex, const uint8_t rgba[4])
@@ -91,8 +37,222 @@ ASEXPORT void asVertexGeneric_encodeBoneIds_Mult(asVertexGeneric* pVertex, const
 
 ASEXPORT void asVertexGeneric_encodeBoneWeights_Mult(asVertexGeneric* pVertex, const float weight[4])
 {
-	uint8_t* pWeights = (uint8_t*)&pVertex->boneWeight;
-	for (int i = 0; i < 4; i++) {
-		pWeights[i] = (uint8_t)(weight[i] * 255);
+	uint32_t packed;
+	asVertexEncode_BoneWeights(&packed, weight, 1);
+	memcpy(pVertex->boneWeight, &packed, 4);
+}
+
+/*Vertices are encoded a chunk at a time into tightly packed arrays then interleaved*/
+#define AS_VERTEX_BATCH_CHUNK 256
+
+ASEXPORT void asVertexGeneric_encodeBatch(asVertexGeneric* pVertices, size_t count, const asVertexGenericStreams_t* pStreams)
+{
+	uint32_t normals[AS_VERTEX_BATCH_CHUNK];
+	uint32_t tangents[AS_VERTEX_BATCH_CHUNK];
+	uint32_t uvs[2][AS_VERTEX_BATCH_CHUNK];
+	uint32_t weights[AS_VERTEX_BATCH_CHUNK];
+	memset(pVertices, 0, sizeof(asVertexGeneric) * count);
+	for (size_t first = 0; first < count; first += AS_VERTEX_BATCH_CHUNK)
+	{
+		const size_t chunk = count - first < AS_VERTEX_BATCH_CHUNK ? count - first : AS_VERTEX_BATCH_CHUNK;
+		asVertexGeneric* pChunk = pVertices + first;
+		if (pStreams->pPositions)
+		{
+			for (size_t i = 0; i < chunk; i++)
+				memcpy(pChunk[i].position, &pStreams->pPositions[(first + i) * 3], sizeof(float) * 3);
+		}
+		if (pStreams->pNormals)
+		{
+			asVertexEncode_Normals(normals, &pStreams->pNormals[first * 3], chunk, pStreams->normalEncoding);
+			for (size_t i = 0; i < chunk; i++)
+				pChunk[i].normal = normals[i];
+		}
+		if (pStreams->pTangents)
+		{
+			asVertexEncode_Tangents(tangents, &pStreams->pTangents[first * 4], chunk);
+			for (size_t i = 0; i < chunk; i++)
+				pChunk[i].tangent = tangents[i];
+		}
+		for (int set = 0; set < 2; set++)
+		{
+			if (!pStreams->pUVs[set])
+				continue;
+			asVertexEncode_FloatToHalf((uint16_t*)uvs[set], &pStreams->pUVs[set][first * 2], chunk * 2);
+			for (size_t i = 0; i < chunk; i++)
+			{
+				if (set == 0)
+					pChunk[i].uv0 = uvs[set][i];
+				else
+					pChunk[i].uv1 = uvs[set][i];
+			}
+		}
+		if (pStreams->pColors)
+		{
+			for (size_t i = 0; i < chunk; i++)
+				memcpy(pChunk[i].color, &pStreams->pColors[(first + i) * 4], 4);
+		}
+		if (pStreams->pBoneIds)
+		{
+			for (size_t i = 0; i < chunk; i++)
+				memcpy(pChunk[i].boneIdx, &pStreams->pBoneIds[(first + i) * 4], sizeof(uint16_t) * 4);
+		}
+		if (pStreams->pBoneWeights)
+		{
+			asVertexEncode_BoneWeights(weights, &pStreams->pBoneWeights[first * 4], chunk);
+			for (size_t i = 0; i < chunk; i++)
+				memcpy(pChunk[i].boneWeight, &weights[i], 4);
+		}
+	}
+}
+/*------------------------------------MODEL------------------------------------*/
+
+static bool _modelRange(const asModel_t* pModel, uint64_t offset, uint64_t bytes, uint64_t alignment)
+{
+	return offset % alignment == 0 && offset <= pModel->size && bytes <= pModel->size - offset;
+}
+
+static bool _modelString(const asModel_t* pModel, uint64_t offset)
+{
+	return offset < pModel->size && memchr((const char*)pModel + offset, '\0', (size_t)(pModel->size - offset)) != NULL;
+}
+
+ASEXPORT asResults asModel_Relocate(void* pBlob, size_t size, asModel_t** ppModel)
+{
+	asModel_t* pModel = (asModel_t*)pBlob;
+	if (size < sizeof(asModel_t) || (uintptr_t)pBlob % 8 || memcmp(pModel->tag, AS_MODEL_FILE_TAG, 4) != 0)
+		return AS_FAILURE_PARSE_ERROR;
+	if (pModel->version != AS_MODEL_VERSION)
+		return AS_FAILURE_UNKNOWN_FORMAT;
+	if (pModel->size != size)
+		return AS_FAILURE_PARSE_ERROR;
+	if (pModel->relocated)
+	{
+		/*Already pointers, they have to point back into this blob*/
+		const uintptr_t start = (uintptr_t)pBlob;
+		const uintptr_t tables[8] = { (uintptr_t)pModel->submeshes.ptr, (uintptr_t)pModel->materials.ptr,
+			(uintptr_t)pModel->vertices.ptr, (uintptr_t)pModel->positions.ptr, (uintptr_t)pModel->indices.ptr,
+			(uintptr_t)pModel->meshlets.ptr, (uintptr_t)pModel->meshletVertices.ptr, (uintptr_t)pModel->meshletTriangles.ptr };
+		for (int i = 0; i < 8; i++)
+		{
+			if (tables[i] < start || tables[i] > start + size)
+				return AS_FAILURE_PARSE_ERROR;
+		}
+		*ppModel = pModel;
+		return AS_SUCCESS;
+	}
+
+	/*Check the tables before anything is written so a bad blob is left as it was*/
+	if (!_modelRange(pModel, pModel->submeshes.offset, (uint64_t)sizeof(asModelSubmesh_t) * pModel->submeshCount, 8) ||
+		!_modelRange(pModel, pModel->materials.offset, (uint64_t)sizeof(asModelMaterial_t) * pModel->materialCount, 8) ||
+		!_modelRange(pModel, pModel->vertices.offset, (uint64_t)sizeof(asVertexGeneric) * pModel->vertexCount, AS_MODEL_ALIGNMENT) ||
+		pModel->positionSize != ((pModel->flags & AS_MODEL_FLAG_QUANTIZED_POSITIONS) ? 8 : 12) ||
+		!_modelRange(pModel, pModel->positions.offset, (uint64_t)pModel->positionSize * pModel->vertexCount, AS_MODEL_ALIGNMENT) ||
+		(pModel->indexSize != 2 && pModel->indexSize != 4) ||
+		!_modelRange(pModel, pModel->indices.offset, (uint64_t)pModel->indexSize * pModel->indexCount, AS_MODEL_ALIGNMENT) ||
+		!_modelRange(pModel, pModel->meshlets.offset, (uint64_t)sizeof(asModelMeshlet_t) * pModel->meshletCount, AS_MODEL_ALIGNMENT) ||
+		!_modelRange(pModel, pModel->meshletVertices.offset, (uint64_t)sizeof(uint32_t) * pModel->meshletVertexCount, AS_MODEL_ALIGNMENT) ||
+		!_modelRange(pModel, pModel->meshletTriangles.offset, pModel->meshletTriangleSize, AS_MODEL_ALIGNMENT))
+	{
+		return AS_FAILURE_PARSE_ERROR;
+	}
+	uint8_t* pBase = (uint8_t*)pBlob;
+	asModelSubmesh_t* pSubmeshes = (asModelSubmesh_t*)(pBase + pModel->submeshes.offset);
+	asModelMaterial_t* pMaterials = (asModelMaterial_t*)(pBase + pModel->materials.offset);
+	const asModelMeshlet_t* pMeshlets = (const asModelMeshlet_t*)(pBase + pModel->meshlets.offset);
+	for (uint32_t i = 0; i < pModel->submeshCount; i++)
+	{
+		const asModelSubmesh_t* pSubmesh = &pSubmeshes[i];
+		if (!_modelString(pModel, pSubmesh->name.offset) || pSubmesh->materialIndex >= pModel->materialCount ||
+			(uint64_t)pSubmesh->vertexOffset + pSubmesh->vertexCount > pModel->vertexCount ||
+			pSubmesh->lodCount < 1 || pSubmesh->lodCount > AS_MODEL_MAX_LODS)
+		{
+			return AS_FAILURE_PARSE_ERROR;
+		}
+		for (uint32_t l = 0; l < pSubmesh->lodCount; l++)
+		{
+			if ((uint64_t)pSubmesh->lods[l].firstIndex + pSubmesh->lods[l].indexCount > pModel->indexCount ||
+				(uint64_t)pSubmesh->lods[l].firstMeshlet + pSubmesh->lods[l].meshletCount > pModel->meshletCount)
+				return AS_FAILURE_PARSE_ERROR;
+		}
+	}
+	for (uint32_t i = 0; i < pModel->meshletCount; i++)
+	{
+		const asModelMeshlet_t* pMeshlet = &pMeshlets[i];
+		if (pMeshlet->vertexCount > AS_MODEL_MESHLET_MAX_VERTICES || pMeshlet->triangleCount > AS_MODEL_MESHLET_MAX_TRIANGLES ||
+			(uint64_t)pMeshlet->firstIndex + pMeshlet->triangleCount * 3u > pModel->indexCount ||
+			pMeshlet->baseVertex > pModel->vertexCount ||
+			(uint64_t)pMeshlet->firstVertex + pMeshlet->vertexCount > pModel->meshletVertexCount ||
+			pMeshlet->firstTriangle % 4 || (uint64_t)pMeshlet->firstTriangle + pMeshlet->triangleCount * 3u > pModel->meshletTriangleSize)
+		{
+			return AS_FAILURE_PARSE_ERROR;
+		}
+	}
+	for (uint32_t i = 0; i < pModel->materialCount; i++)
+	{
+		if (!_modelString(pModel, pMaterials[i].name.offset))
+			return AS_FAILURE_PARSE_ERROR;
+		for (uint32_t t = 0; t < AS_MODEL_TEXTURE_COUNT; t++)
+		{
+			if (!_modelString(pModel, pMaterials[i].textures[t].offset))
+				return AS_FAILURE_PARSE_ERROR;
+		}
+	}
+
+	/*Offsets become pointers*/
+	for (uint32_t i = 0; i < pModel->submeshCount; i++)
+	{
+		pSubmeshes[i].name.ptr = (const char*)(pBase + pSubmeshes[i].name.offset);
+		pSubmeshes[i].material.ptr = &pMaterials[pSubmeshes[i].materialIndex];
+	}
+	for (uint32_t i = 0; i < pModel->materialCount; i++)
+	{
+		pMaterials[i].name.ptr = (const char*)(pBase + pMaterials[i].name.offset);
+		for (uint32_t t = 0; t < AS_MODEL_TEXTURE_COUNT; t++)
+			pMaterials[i].textures[t].ptr = (const char*)(pBase + pMaterials[i].textures[t].offset);
+	}
+	pModel->submeshes.ptr = pSubmeshes;
+	pModel->materials.ptr = pMaterials;
+	pModel->vertices.ptr = (asVertexGeneric*)(pBase + pModel->vertices.offset);
+	pModel->positions.ptr = pBase + pModel->positions.offset;
+	pModel->indices.ptr = pBase + pModel->indices.offset;
+	pModel->meshlets.ptr = (asModelMeshlet_t*)(pBase + pModel->meshlets.offset);
+	pModel->meshletVertices.ptr = (uint32_t*)(pBase + pModel->meshletVertices.offset);
+	pModel->meshletTriangles.ptr = pBase + pModel->meshletTriangles.offset;
+	pModel->relocated = 1;
+	*ppModel = pModel;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asModel_DecodePosition(const asModel_t* pModel, uint32_t vertex, vec3 position)
+{
+	if (pModel->flags & AS_MODEL_FLAG_QUANTIZED_POSITIONS)
+	{
+		const uint16_t* pQuantized = (const uint16_t*)pModel->positions.ptr + (size_t)vertex * 4;
+		for (int i = 0; i < 3; i++)
+			position[i] = pModel->positionOffset[i] + pModel->positionScale[i] * ((float)pQuantized[i] / 65535.0f);
+		return;
+	}
+	memcpy(position, (const float*)pModel->positions.ptr + (size_t)vertex * 3, sizeof(float) * 3);
+}
+
+ASEXPORT asResults asModel_LoadFile(const char* pPath, asModel_t** ppModel)
+{
+	FILE* fp = fopen(pPath, "rb");
+	if (!fp)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	fseek(fp, 0, SEEK_END);
+	const size_t size = (size_t)ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	void* pBlob = asMalloc(size ? size : 1);
+	if (!pBlob)
+	{
+		fclose(fp);
+		return AS_FAILURE_OUT_OF_MEMORY;
 	}
-}
\ No newline at end of file
+	const bool read = size && fread(pBlob, size, 1, fp) == 1;
+	fclose(fp);
+	asResults result = read ? asModel_Relocate(pBlob, size, ppModel) : AS_FAILURE_FILE_INACCESSIBLE;
+	if (result != AS_SUCCESS)
+		asFree(pBlob);
+	return result;
+}
@@ -4,6 +4,7 @@
 #include "../engine/common/asCommon.h"
 #include "../engine/renderer/asRendererCore.h"
 #include "../thirdparty/cglm/cglm.h"
+#include "asVertexEncoding.h"
 #ifdef __cplusplus
 extern "C" {
 #endif 
@@ -14,13 +15,13 @@ extern "C" {
 /**
 * @brief Vertex format for common models
 * position: vertex position in model space (XYZ) AS_COLORFORMAT_RGB32_SFLOAT
-* normal: packed normals: (ZYX) AS_COLORFORMAT_B10G11R11_UFLOAT
+* normal: packed normals: (XYZ) AS_COLORFORMAT_A2R10G10B10_SNORM or octahedral AS_COLORFORMAT_RG16_SNORM (AS_MODEL_FLAG_OCTAHEDRAL_NORMALS)
 * tangent: packed tangent XYZ with sign stored in W (WXYZ): AS_COLORFORMAT_A2R10G10B10_SNORM
 * uv0: packed texture coordinate 0 (XY): AS_COLORFORMAT_RG16_SFLOAT
 * uv1: packed texture coordinate 1 (XY): AS_COLORFORMAT_RG16_SFLOAT
 * rgba: vertex color (RGBA): AS_COLORFORMAT_RGBA8_UNORM
 * boneIdx: bone indices (4 bones) (XYZW): AS_COLORFORMAT_RGBA16_UINT
-* boneWeight: bone weights (4 bones) (XYZW): AS_COLORFORMAT_RGBA8_UNORM
+* boneWeight: bone weights (4 bones) (XYZW): AS_COLORFORMAT_RGBA8_UNORM adding up to 1
 */
 #define REFLECT_MACRO_Vertex_Generic AS_REFLECT_STRUCT(asVertexGeneric,\
 	AS_REFLECT_ENTRY_ARRAY(asVertexGeneric, float, position, 3, AS_REFLECT_FORMAT_NONE)\
@@ -43,8 +44,194 @@ ASEXPORT void asVertexGeneric_encodeColor(asVertexGeneric* pVertex, const uint8_
 ASEXPORT void asVertexGeneric_encodeBoneIds_Mult(asVertexGeneric* pVertex, const uint16_t ids[4]);
 ASEXPORT void asVertexGeneric_encodeBoneWeights_Mult(asVertexGeneric* pVertex, const float weight[4]);
 
+/**
+* @brief Attribute arrays for asVertexGeneric_encodeBatch(), NULL streams are left zeroed
+*/
+typedef struct {
+	const float* pPositions; /**< 3 floats per vertex*/
+	const float* pNormals; /**< 3 floats per vertex*/
+	const float* pTangents; /**< 4 floats per vertex (bitangent sign in W)*/
+	const float* pUVs[2]; /**< 2 floats per vertex for each UV set*/
+	const uint8_t* pColors; /**< RGBA per vertex*/
+	const uint16_t* pBoneIds; /**< 4 per vertex*/
+	const float* pBoneWeights; /**< 4 per vertex*/
+	asVertexNormalEncoding normalEncoding;
+} asVertexGenericStreams_t;
+
+/**
+* @brief Encode whole arrays of vertices with the SIMD encoders in asVertexEncoding.h
+* (gives the same vertices as the per vertex functions above)
+*/
+ASEXPORT void asVertexGeneric_encodeBatch(asVertexGeneric* pVertices, size_t count, const asVertexGenericStreams_t* pStreams);
+
 /*------------------------------------SUBMESH------------------------------------*/
 
+/**
+* @brief asMdl files are a single blob used right where it is loaded:
+* asModel_t at the start followed by the submeshes, materials, names, vertices, positions, indices and meshlets (each AS_MODEL_ALIGNMENT aligned)
+* Pointers are stored as offsets from the start of the blob and are turned into pointers in place by asModel_Relocate()
+* so a model is one read (or a writable mapping) with nothing done per vertex before upload
+*/
+#define AS_MODEL_FILE_TAG "AMDL"
+#define AS_MODEL_VERSION 4
+#define AS_MODEL_ALIGNMENT 16
+#define AS_MODEL_MAX_NAME 64
+#define AS_MODEL_MAX_LODS 8
+#define AS_MODEL_MESHLET_MAX_VERTICES 64
+#define AS_MODEL_MESHLET_MAX_TRIANGLES 124
+
+/**
+* @brief A pointer stored as an offset from the start of the blob (use ptr after relocation)
+*/
+#define AS_MODEL_POINTER(_type) union { uint64_t offset; _type* ptr; }
+
+/**
+* @brief Flags of a model
+*/
+typedef enum {
+	AS_MODEL_FLAG_SKINNED = 1 << 0, /**< Vertices carry bone indices and weights*/
+	AS_MODEL_FLAG_TANGENTS = 1 << 1, /**< Vertices carry tangents*/
+	AS_MODEL_FLAG_OCTAHEDRAL_NORMALS = 1 << 2, /**< Normals are AS_VERTEX_NORMAL_OCTAHEDRAL instead of AS_VERTEX_NORMAL_SNORM10*/
+	AS_MODEL_FLAG_QUANTIZED_POSITIONS = 1 << 3, /**< The position stream is 16 bit UNORM instead of float (see asModel_t)*/
+	AS_MODEL_FLAG_MAX = UINT32_MAX
+} asModelFlags;
+
+/**
+* @brief Texture slots of a material
+*/
+typedef enum {
+	AS_MODEL_TEXTURE_BASECOLOR,
+	AS_MODEL_TEXTURE_NORMAL,
+	AS_MODEL_TEXTURE_METALLICROUGHNESS, /**< Roughness in G, metallic in B*/
+	AS_MODEL_TEXTURE_OCCLUSION,
+	AS_MODEL_TEXTURE_EMISSIVE,
+	AS_MODEL_TEXTURE_COUNT
+} asModelTextureSlot;
+
+/**
+* @brief Alpha modes of a material
+*/
+typedef enum {
+	AS_MODEL_ALPHA_OPAQUE,
+	AS_MODEL_ALPHA_MASK,
+	AS_MODEL_ALPHA_BLEND,
+	AS_MODEL_ALPHA_MAX = UINT32_MAX
+} asModelAlphaMode;
+
+/**
+* @brief PBR material in the style of glTF
+*/
+typedef struct {
+	AS_MODEL_POINTER(const char) name;
+	AS_MODEL_POINTER(const char) textures[AS_MODEL_TEXTURE_COUNT]; /**< Paths relative to the model file (empty if unused)*/
+	float baseColor[4];
+	float emissive[3];
+	float metallic;
+	float roughness;
+	float normalScale;
+	float occlusionStrength;
+	float alphaCutoff;
+	asModelAlphaMode alphaMode;
+	uint32_t doubleSided;
+} asModelMaterial_t;
+
+/**
+* @brief Indices of a level of detail
+*/
+typedef struct {
+	uint32_t firstIndex; /**< Into the whole index buffer*/
+	uint32_t indexCount;
+	float error; /**< Distance from the surface of the full submesh (in model units)*/
+	uint32_t firstMeshlet; /**< Into the meshlet table*/
+	uint32_t meshletCount; /**< 0 when the model has no meshlets*/
+} asModelLod_t;
+
+/**
+* @brief A small cluster of triangles of a level of detail that is culled on its own
+* Laid out for std430 storage buffers so the table can be uploaded as is
+* The cluster faces away from a camera at P when dot(normalize(coneApex - P), coneAxis) >= coneCutoff
+* (normals follow the counter clockwise winding of the triangles)
+*/
+typedef struct {
+	float center[3]; /**< Bounding sphere in model space*/
+	float radius;
+	float coneApex[3];
+	float coneCutoff; /**< Sine of the angle the normals keep from the cone axis, 1 when the cluster can not be backface culled*/
+	float coneAxis[3];
+	uint32_t firstIndex; /**< Into the whole index buffer, the triangles of a meshlet are drawn with a single ranged draw*/
+	uint32_t baseVertex; /**< Vertex offset of the submesh, added to the indices and meshlet vertices*/
+	uint32_t firstVertex; /**< Into the meshlet vertex table*/
+	uint32_t firstTriangle; /**< Byte offset into the meshlet triangle table (4 byte aligned)*/
+	uint16_t vertexCount; /**< Up to AS_MODEL_MESHLET_MAX_VERTICES*/
+	uint16_t triangleCount; /**< Up to AS_MODEL_MESHLET_MAX_TRIANGLES*/
+} asModelMeshlet_t;
+
+/**
+* @brief A triangle list drawn with a single material
+*/
+typedef struct {
+	AS_MODEL_POINTER(const char) name;
+	AS_MODEL_POINTER(const asModelMaterial_t) material;
+	uint32_t materialIndex;
+	uint32_t vertexOffset; /**< Added to every index of the submesh*/
+	uint32_t vertexCount;
+	uint32_t lodCount; /**< At least 1, the first level is the full submesh*/
+	asModelLod_t lods[AS_MODEL_MAX_LODS];
+	float boundsMin[3];
+	float boundsMax[3];
+} asModelSubmesh_t;
+
+/**
+* @brief A whole model file
+*/
+typedef struct {
+	char tag[4]; /**< AS_MODEL_FILE_TAG*/
+	uint32_t version;
+	uint64_t size; /**< Of the whole blob*/
+	uint32_t flags;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexSize; /**< 2 or 4 bytes*/
+	uint32_t positionSize; /**< 12 bytes (float XYZ) or 8 bytes (uint16_t XYZ and padding) with AS_MODEL_FLAG_QUANTIZED_POSITIONS*/
+	uint32_t submeshCount;
+	uint32_t materialCount;
+	uint32_t meshletCount;
+	uint32_t meshletVertexCount;
+	uint32_t meshletTriangleSize; /**< Bytes of meshlet triangles*/
+	float boundsMin[3];
+	float boundsMax[3];
+	float positionScale[3]; /**< Quantized positions are positionOffset + positionScale * (q / 65535)*/
+	float positionOffset[3];
+	uint32_t relocated; /**< Offsets have been turned into pointers*/
+	AS_MODEL_POINTER(asModelSubmesh_t) submeshes;
+	AS_MODEL_POINTER(asModelMaterial_t) materials;
+	AS_MODEL_POINTER(asVertexGeneric) vertices;
+	AS_MODEL_POINTER(void) positions; /**< Position only copy of the vertices for depth and shadow passes (AS_COLORFORMAT_RGB32_SFLOAT or AS_COLORFORMAT_RGBA16_UNORM)*/
+	AS_MODEL_POINTER(void) indices;
+	AS_MODEL_POINTER(asModelMeshlet_t) meshlets; /**< Every level of detail split into meshlets (empty when the model was built without them)*/
+	AS_MODEL_POINTER(uint32_t) meshletVertices; /**< Vertices used by each meshlet relative to the submesh*/
+	AS_MODEL_POINTER(uint8_t) meshletTriangles; /**< Three meshlet vertex indices per triangle*/
+} asModel_t;
+
+/**
+* @brief Turn the offsets of a model blob into pointers in place (nothing is copied)
+* @param pBlob the whole file at an 8 byte aligned (AS_MODEL_ALIGNMENT for SIMD) address, it is the model from then on
+* @return AS_FAILURE_PARSE_ERROR if the blob is not a valid model, AS_FAILURE_UNKNOWN_FORMAT for other versions
+*/
+ASEXPORT asResults asModel_Relocate(void* pBlob, size_t size, asModel_t** ppModel);
+
+/**
+* @brief Position of a vertex from the position stream (dequantized when AS_MODEL_FLAG_QUANTIZED_POSITIONS is set)
+* Quantized models snap the positions of their vertices to the same values so both streams give the same surface
+*/
+ASEXPORT void asModel_DecodePosition(const asModel_t* pModel, uint32_t vertex, vec3 position);
+
+/**
+* @brief Load a model file with a single read and relocate it
+* @warning free the model with asFree()
+*/
+ASEXPORT asResults asModel_LoadFile(const char* pPath, asModel_t** ppModel);
+
 #ifdef __cplusplus
 }
 #endif
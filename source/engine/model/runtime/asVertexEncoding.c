@@ -0,0 +1,971 @@
+#include "asVertexEncoding.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_VERTEX_SSE2 1
+#include <emmintrin.h>
+#else
+#define AS_VERTEX_SSE2 0
+#endif
+
+/*AVX2 and F16C are only used after checking the CPU, GCC and Clang need them enabled per function*/
+#if AS_VERTEX_SSE2 && (defined(_MSC_VER) || defined(__GNUC__))
+#define AS_VERTEX_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AS_VERTEX_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define AS_VERTEX_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#else
+#define AS_VERTEX_AVX2 0
+#endif
+
+/*------------------------------------SIMD LEVEL------------------------------------*/
+
+static asVertexSimdLevel gVertexSimdLevel = AS_VERTEX_SIMD_COUNT;
+
+static asVertexSimdLevel _detectSimdLevel()
+{
+#if AS_VERTEX_AVX2
+	uint32_t regs[4] = { 0 };
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, 0, 0);
+#else
+	__cpuid_count(0, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	const uint32_t maxLeaf = regs[0];
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, 1, 0);
+#else
+	__cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	/*OSXSAVE, AVX and F16C, then the OS has to save the YMM registers*/
+	const uint32_t avxBits = (1u << 27) | (1u << 28) | (1u << 29);
+	if (maxLeaf >= 7 && (regs[2] & avxBits) == avxBits)
+	{
+#if defined(_MSC_VER)
+		const uint64_t xcr0 = _xgetbv(0);
+#else
+		uint32_t xcr0Low, xcr0High;
+		__asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+		const uint64_t xcr0 = ((uint64_t)xcr0High << 32) | xcr0Low;
+#endif
+#if defined(_MSC_VER)
+		__cpuidex((int*)regs, 7, 0);
+#else
+		__cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		if ((xcr0 & 6) == 6 && (regs[1] & (1u << 5)))
+			return AS_VERTEX_SIMD_AVX2;
+	}
+#endif
+#if AS_VERTEX_SSE2
+	return AS_VERTEX_SIMD_SSE2;
+#else
+	return AS_VERTEX_SIMD_SCALAR;
+#endif
+}
+
+static asVertexSimdLevel _vertexSimdLevel()
+{
+	if (gVertexSimdLevel == AS_VERTEX_SIMD_COUNT)
+		gVertexSimdLevel = _detectSimdLevel();
+	return gVertexSimdLevel;
+}
+
+ASEXPORT asVertexSimdLevel asVertexEncode_GetSimdLevel()
+{
+	return _vertexSimdLevel();
+}
+
+ASEXPORT asVertexSimdLevel asVertexEncode_SetSimdLevel(asVertexSimdLevel level)
+{
+	const asVertexSimdLevel supported = _detectSimdLevel();
+	gVertexSimdLevel = level < supported ? level : supported;
+	return gVertexSimdLevel;
+}
+
+/*------------------------------------SCALAR------------------------------------*/
+
+/*These match minps/maxps exactly (the second value wins when either is NaN)*/
+static float _min(float a, float b)
+{
+	return a < b ? a : b;
+}
+
+static float _max(float a, float b)
+{
+	return a > b ? a : b;
+}
+
+static float _clampUnit(float v)
+{
+	return _max(_min(v, 1.0f), -1.0f);
+}
+
+/*Round to nearest even like cvtps2dq (which gives INT32_MIN for NaNs and anything out of range)*/
+static int32_t _round(float v)
+{
+	if (!(v >= -2147483648.0f && v < 2147483648.0f))
+		return INT32_MIN;
+	return (int32_t)lrintf(v);
+}
+
+static uint32_t _floatBits(float v)
+{
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return bits;
+}
+
+static float _bitsFloat(uint32_t bits)
+{
+	float v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+#define VE_HALF_OVERFLOW 0x47800000u /*65536.0f*/
+#define VE_HALF_MIN_NORMAL 0x38800000u /*2^-14*/
+#define VE_HALF_SUBNORMAL_MAGIC 0x3F000000u /*Adding 0.5f lines the float mantissa up with the half subnormal*/
+#define VE_HALF_REBIAS 0xC8000FFFu /*Exponent bias (15 - 127) plus rounding (half the dropped bits minus one)*/
+
+static uint16_t _floatToHalf(float value)
+{
+	uint32_t f = _floatBits(value);
+	const uint32_t sign = f & 0x80000000u;
+	f ^= sign;
+	uint32_t h;
+	if (f >= VE_HALF_OVERFLOW) /*Infinity, NaNs keep the top of their payload and become quiet*/
+		h = f > 0x7F800000u ? 0x7E00u | ((f >> 13) & 0x3FFu) : 0x7C00u;
+	else if (f < VE_HALF_MIN_NORMAL)
+		h = _floatBits(_bitsFloat(f) + _bitsFloat(VE_HALF_SUBNORMAL_MAGIC)) - VE_HALF_SUBNORMAL_MAGIC;
+	else
+		h = (f + VE_HALF_REBIAS + ((f >> 13) & 1u)) >> 13;
+	return (uint16_t)(h | (sign >> 16));
+}
+
+static float _halfToFloat(uint16_t half)
+{
+	uint32_t f = ((uint32_t)half & 0x7FFFu) << 13;
+	const uint32_t exponent = f & 0x0F800000u;
+	f += 0x38000000u;
+	if (exponent == 0x0F800000u) /*Infinity and NaN, NaNs become quiet*/
+	{
+		f += 0x38000000u;
+		if (f & 0x007FFFFFu)
+			f |= 0x00400000u;
+	}
+	else if (exponent == 0) /*Subnormal halves are normal floats, let the FPU shift them into place*/
+		f = _floatBits(_bitsFloat(f + 0x00800000u) - _bitsFloat(VE_HALF_MIN_NORMAL));
+	return _bitsFloat(f | (((uint32_t)half & 0x8000u) << 16));
+}
+
+static uint32_t _encodeSnorm10(const float* pSrc, uint32_t w)
+{
+	const uint32_t x = (uint32_t)_round(_clampUnit(pSrc[0]) * 511.0f) & 0x3FFu;
+	const uint32_t y = (uint32_t)_round(_clampUnit(pSrc[1]) * 511.0f) & 0x3FFu;
+	const uint32_t z = (uint32_t)_round(_clampUnit(pSrc[2]) * 511.0f) & 0x3FFu;
+	return z | (y << 10) | (x << 20) | (w << 30);
+}
+
+static void _decodeSnorm10(float* pDst, uint32_t packed)
+{
+	pDst[0] = _max((float)((int32_t)(packed << 2) >> 22) / 511.0f, -1.0f);
+	pDst[1] = _max((float)((int32_t)(packed << 12) >> 22) / 511.0f, -1.0f);
+	pDst[2] = _max((float)((int32_t)(packed << 22) >> 22) / 511.0f, -1.0f);
+}
+
+/*Project onto the octahedron |x|+|y|+|z| = 1 and fold the lower half over the diagonals*/
+static uint32_t _encodeOctahedral(const float* pSrc)
+{
+	float sum = (fabsf(pSrc[0]) + fabsf(pSrc[1])) + fabsf(pSrc[2]);
+	sum = sum > 0.0f ? sum : 1.0f;
+	float x = pSrc[0] / sum;
+	float y = pSrc[1] / sum;
+	if (pSrc[2] < 0.0f)
+	{
+		const float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	const uint32_t qx = (uint32_t)_round(_clampUnit(x) * 32767.0f) & 0xFFFFu;
+	const uint32_t qy = (uint32_t)_round(_clampUnit(y) * 32767.0f) & 0xFFFFu;
+	return qx | (qy << 16);
+}
+
+static void _decodeOctahedral(float* pDst, uint32_t packed)
+{
+	float x = _max((float)((int32_t)(packed << 16) >> 16) / 32767.0f, -1.0f);
+	float y = _max((float)((int32_t)packed >> 16) / 32767.0f, -1.0f);
+	const float z = (1.0f - fabsf(x)) - fabsf(y);
+	const float t = _max(-z, 0.0f);
+	x = x + (x >= 0.0f ? -t : t);
+	y = y + (y >= 0.0f ? -t : t);
+	const float length = sqrtf((x * x + y * y) + z * z);
+	pDst[0] = x / length;
+	pDst[1] = y / length;
+	pDst[2] = z / length;
+}
+
+static uint32_t _encodeTangent(const float* pSrc)
+{
+	return _encodeSnorm10(pSrc, pSrc[3] < 0.0f ? 3u : 1u);
+}
+
+static void _decodeTangent(float* pDst, uint32_t packed)
+{
+	_decodeSnorm10(pDst, packed);
+	pDst[3] = (int32_t)packed < 0 ? -1.0f : 1.0f;
+}
+
+static uint32_t _encodeBoneWeights(const float* pSrc)
+{
+	float w[4];
+	for (int i = 0; i < 4; i++)
+		w[i] = _max(pSrc[i], 0.0f);
+	const float sum = ((w[0] + w[1]) + w[2]) + w[3];
+	if (!(sum > 0.0f))
+		return 0;
+	int32_t q[4];
+	int32_t total = 0;
+	int largest = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		q[i] = _round(_min(w[i] / sum, 1.0f) * 255.0f);
+		total += q[i];
+		if (q[i] > q[largest])
+			largest = i;
+	}
+	q[largest] += 255 - total;
+	return ((uint32_t)q[0] & 0xFFu) | (((uint32_t)q[1] & 0xFFu) << 8) | (((uint32_t)q[2] & 0xFFu) << 16) | ((uint32_t)q[3] << 24);
+}
+
+static void _decodeBoneWeights(float* pDst, uint32_t packed)
+{
+	for (int i = 0; i < 4; i++)
+		pDst[i] = (float)((packed >> (i * 8)) & 0xFFu) / 255.0f;
+}
+
+/*------------------------------------SSE2------------------------------------*/
+
+/*Each kernel returns how many elements it handled, the scalar code finishes the rest*/
+#if AS_VERTEX_SSE2
+
+static __m128i _select4i(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static __m128 _select4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 _clampUnit4(__m128 v)
+{
+	return _mm_max_ps(_mm_min_ps(v, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+}
+
+static __m128 _abs4(__m128 v)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+/*x0y0z0x1 y1z1x2y2 z2x3y3z3 to one register per component*/
+static void _loadVec3x4(const float* pSrc, __m128* pX, __m128* pY, __m128* pZ)
+{
+	const __m128 a = _mm_loadu_ps(pSrc);
+	const __m128 b = _mm_loadu_ps(pSrc + 4);
+	const __m128 c = _mm_loadu_ps(pSrc + 8);
+	const __m128 highX = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+	*pX = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), highX, _MM_SHUFFLE(2, 0, 2, 0));
+	*pY = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	*pZ = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static void _storeVec3x4(float* pDst, __m128 x, __m128 y, __m128 z)
+{
+	float values[3][4];
+	_mm_storeu_ps(values[0], x);
+	_mm_storeu_ps(values[1], y);
+	_mm_storeu_ps(values[2], z);
+	for (int i = 0; i < 4; i++)
+	{
+		pDst[i * 3 + 0] = values[0][i];
+		pDst[i * 3 + 1] = values[1][i];
+		pDst[i * 3 + 2] = values[2][i];
+	}
+}
+
+static __m128i _floatToHalf4(__m128 value)
+{
+	__m128i f = _mm_castps_si128(value);
+	const __m128i sign = _mm_and_si128(f, _mm_set1_epi32((int)0x80000000u));
+	f = _mm_xor_si128(f, sign);
+	const __m128i isInfNan = _mm_cmpgt_epi32(f, _mm_set1_epi32((int)VE_HALF_OVERFLOW - 1));
+	const __m128i isNan = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7F800000));
+	const __m128i isSubnormal = _mm_cmplt_epi32(f, _mm_set1_epi32((int)VE_HALF_MIN_NORMAL));
+	const __m128i infNan = _mm_or_si128(_mm_set1_epi32(0x7C00),
+		_mm_and_si128(isNan, _mm_or_si128(_mm_set1_epi32(0x200), _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(0x3FF)))));
+	const __m128i magic = _mm_set1_epi32((int)VE_HALF_SUBNORMAL_MAGIC);
+	const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(magic))), magic);
+	const __m128i odd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+	const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32((int)VE_HALF_REBIAS)), odd), 13);
+	const __m128i h = _select4i(isInfNan, infNan, _select4i(isSubnormal, subnormal, normal));
+	return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+static __m128 _halfToFloat4(__m128i half)
+{
+	const __m128i shifted = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7FFF)), 13);
+	const __m128i exponent = _mm_and_si128(shifted, _mm_set1_epi32(0x0F800000));
+	const __m128i f = _mm_add_epi32(shifted, _mm_set1_epi32(0x38000000));
+	const __m128i isInfNan = _mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x0F800000));
+	const __m128i isSubnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+	const __m128i isNan = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(shifted, _mm_set1_epi32(0x007FFFFF)), _mm_setzero_si128()), isInfNan);
+	const __m128i infNan = _mm_or_si128(_mm_add_epi32(f, _mm_set1_epi32(0x38000000)), _mm_and_si128(isNan, _mm_set1_epi32(0x00400000)));
+	const __m128i subnormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(f, _mm_set1_epi32(0x00800000))),
+		_mm_castsi128_ps(_mm_set1_epi32((int)VE_HALF_MIN_NORMAL))));
+	const __m128i result = _select4i(isInfNan, infNan, _select4i(isSubnormal, subnormal, f));
+	return _mm_castsi128_ps(_mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16)));
+}
+
+/*Halves are below 0x10000 so sign extending lets the signed pack keep them*/
+static __m128i _packHalves(__m128i low, __m128i high)
+{
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(low, 16), 16), _mm_srai_epi32(_mm_slli_epi32(high, 16), 16));
+}
+
+static size_t _floatToHalfSse2(uint16_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i low = _floatToHalf4(_mm_loadu_ps(pSrc + i));
+		const __m128i high = _floatToHalf4(_mm_loadu_ps(pSrc + i + 4));
+		_mm_storeu_si128((__m128i*)(pDst + i), _packHalves(low, high));
+	}
+	return i;
+}
+
+static size_t _halfToFloatSse2(float* pDst, const uint16_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i halves = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		_mm_storeu_ps(pDst + i, _halfToFloat4(_mm_unpacklo_epi16(halves, _mm_setzero_si128())));
+		_mm_storeu_ps(pDst + i + 4, _halfToFloat4(_mm_unpackhi_epi16(halves, _mm_setzero_si128())));
+	}
+	return i;
+}
+
+static __m128i _snorm10x4(__m128 v)
+{
+	return _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_clampUnit4(v), _mm_set1_ps(511.0f))), _mm_set1_epi32(0x3FF));
+}
+
+static __m128i _encodeSnorm10x4(__m128 x, __m128 y, __m128 z)
+{
+	return _mm_or_si128(_snorm10x4(z), _mm_or_si128(_mm_slli_epi32(_snorm10x4(y), 10), _mm_slli_epi32(_snorm10x4(x), 20)));
+}
+
+static void _decodeSnorm10x4(__m128i packed, __m128* pX, __m128* pY, __m128* pZ)
+{
+	const __m128 scale = _mm_set1_ps(511.0f);
+	const __m128 minimum = _mm_set1_ps(-1.0f);
+	*pX = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 2), 22)), scale), minimum);
+	*pY = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 12), 22)), scale), minimum);
+	*pZ = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 22), 22)), scale), minimum);
+}
+
+static __m128i _encodeOctahedral4(__m128 x, __m128 y, __m128 z)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	__m128 sum = _mm_add_ps(_mm_add_ps(_abs4(x), _abs4(y)), _abs4(z));
+	sum = _select4(_mm_cmpgt_ps(sum, zero), sum, one);
+	x = _mm_div_ps(x, sum);
+	y = _mm_div_ps(y, sum);
+	const __m128 foldedX = _mm_mul_ps(_mm_sub_ps(one, _abs4(y)), _select4(_mm_cmpge_ps(x, zero), one, minusOne));
+	const __m128 foldedY = _mm_mul_ps(_mm_sub_ps(one, _abs4(x)), _select4(_mm_cmpge_ps(y, zero), one, minusOne));
+	const __m128 lower = _mm_cmplt_ps(z, zero);
+	x = _select4(lower, foldedX, x);
+	y = _select4(lower, foldedY, y);
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128i qx = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(_clampUnit4(x), scale)), _mm_set1_epi32(0xFFFF));
+	const __m128i qy = _mm_cvtps_epi32(_mm_mul_ps(_clampUnit4(y), scale));
+	return _mm_or_si128(qx, _mm_slli_epi32(qy, 16));
+}
+
+static void _decodeOctahedral4(__m128i packed, __m128* pX, __m128* pY, __m128* pZ)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 minimum = _mm_set1_ps(-1.0f);
+	__m128 x = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(packed, 16), 16)), scale), minimum);
+	__m128 y = _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packed, 16)), scale), minimum);
+	const __m128 z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _abs4(x)), _abs4(y));
+	const __m128 t = _mm_max_ps(_mm_xor_ps(z, signBit), zero);
+	x = _mm_add_ps(x, _select4(_mm_cmpge_ps(x, zero), _mm_xor_ps(t, signBit), t));
+	y = _mm_add_ps(y, _select4(_mm_cmpge_ps(y, zero), _mm_xor_ps(t, signBit), t));
+	const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	*pX = _mm_div_ps(x, length);
+	*pY = _mm_div_ps(y, length);
+	*pZ = _mm_div_ps(z, length);
+}
+
+static size_t _encodeNormalsSse2(uint32_t* pDst, const float* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x, y, z;
+		_loadVec3x4(pSrc + i * 3, &x, &y, &z);
+		const __m128i packed = encoding == AS_VERTEX_NORMAL_OCTAHEDRAL ? _encodeOctahedral4(x, y, z) : _encodeSnorm10x4(x, y, z);
+		_mm_storeu_si128((__m128i*)(pDst + i), packed);
+	}
+	return i;
+}
+
+static size_t _decodeNormalsSse2(float* pDst, const uint32_t* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i packed = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		__m128 x, y, z;
+		if (encoding == AS_VERTEX_NORMAL_OCTAHEDRAL)
+			_decodeOctahedral4(packed, &x, &y, &z);
+		else
+			_decodeSnorm10x4(packed, &x, &y, &z);
+		_storeVec3x4(pDst + i * 3, x, y, z);
+	}
+	return i;
+}
+
+static size_t _encodeTangentsSse2(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(pSrc + i * 4);
+		__m128 y = _mm_loadu_ps(pSrc + i * 4 + 4);
+		__m128 z = _mm_loadu_ps(pSrc + i * 4 + 8);
+		__m128 w = _mm_loadu_ps(pSrc + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		const __m128i sign = _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(w, _mm_setzero_ps())), _mm_set1_epi32(2)), _mm_set1_epi32(1));
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(_encodeSnorm10x4(x, y, z), _mm_slli_epi32(sign, 30)));
+	}
+	return i;
+}
+
+static size_t _decodeTangentsSse2(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i packed = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		__m128 x, y, z;
+		_decodeSnorm10x4(packed, &x, &y, &z);
+		__m128 w = _select4(_mm_castsi128_ps(_mm_cmplt_epi32(packed, _mm_setzero_si128())), _mm_set1_ps(-1.0f), _mm_set1_ps(1.0f));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(pDst + i * 4, x);
+		_mm_storeu_ps(pDst + i * 4 + 4, y);
+		_mm_storeu_ps(pDst + i * 4 + 8, z);
+		_mm_storeu_ps(pDst + i * 4 + 12, w);
+	}
+	return i;
+}
+
+/*Weights are transposed so each register holds the same weight of 4 vertices*/
+static __m128i _encodeBoneWeights4(__m128 w0, __m128 w1, __m128 w2, __m128 w3)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	w0 = _mm_max_ps(w0, zero);
+	w1 = _mm_max_ps(w1, zero);
+	w2 = _mm_max_ps(w2, zero);
+	w3 = _mm_max_ps(w3, zero);
+	const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(w0, w1), w2), w3);
+	const __m128i valid = _mm_castps_si128(_mm_cmpgt_ps(sum, zero));
+	__m128i q0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_div_ps(w0, sum), one), scale));
+	__m128i q1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_div_ps(w1, sum), one), scale));
+	__m128i q2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_div_ps(w2, sum), one), scale));
+	__m128i q3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_div_ps(w3, sum), one), scale));
+	const __m128i error = _mm_sub_epi32(_mm_set1_epi32(255), _mm_add_epi32(_mm_add_epi32(q0, q1), _mm_add_epi32(q2, q3)));
+
+	/*The first largest weight takes the error*/
+	__m128i largest = _select4i(_mm_cmpgt_epi32(q1, q0), q1, q0);
+	largest = _select4i(_mm_cmpgt_epi32(q2, largest), q2, largest);
+	largest = _select4i(_mm_cmpgt_epi32(q3, largest), q3, largest);
+	const __m128i is0 = _mm_cmpeq_epi32(q0, largest);
+	const __m128i is1 = _mm_andnot_si128(is0, _mm_cmpeq_epi32(q1, largest));
+	const __m128i is2 = _mm_andnot_si128(_mm_or_si128(is0, is1), _mm_cmpeq_epi32(q2, largest));
+	const __m128i is3 = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(is0, is1), is2), _mm_set1_epi32(-1));
+	q0 = _mm_add_epi32(q0, _mm_and_si128(is0, error));
+	q1 = _mm_add_epi32(q1, _mm_and_si128(is1, error));
+	q2 = _mm_add_epi32(q2, _mm_and_si128(is2, error));
+	q3 = _mm_add_epi32(q3, _mm_and_si128(is3, error));
+
+	const __m128i byteMask = _mm_set1_epi32(0xFF);
+	const __m128i packed = _mm_or_si128(_mm_or_si128(_mm_and_si128(q0, byteMask), _mm_slli_epi32(_mm_and_si128(q1, byteMask), 8)),
+		_mm_or_si128(_mm_slli_epi32(_mm_and_si128(q2, byteMask), 16), _mm_slli_epi32(q3, 24)));
+	return _mm_and_si128(packed, valid);
+}
+
+static size_t _encodeBoneWeightsSse2(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 w0 = _mm_loadu_ps(pSrc + i * 4);
+		__m128 w1 = _mm_loadu_ps(pSrc + i * 4 + 4);
+		__m128 w2 = _mm_loadu_ps(pSrc + i * 4 + 8);
+		__m128 w3 = _mm_loadu_ps(pSrc + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+		_mm_storeu_si128((__m128i*)(pDst + i), _encodeBoneWeights4(w0, w1, w2, w3));
+	}
+	return i;
+}
+
+static size_t _decodeBoneWeightsSse2(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	const __m128 scale = _mm_set1_ps(255.0f);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i bytes = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		const __m128i low = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+		const __m128i high = _mm_unpackhi_epi8(bytes, _mm_setzero_si128());
+		_mm_storeu_ps(pDst + i * 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, _mm_setzero_si128())), scale));
+		_mm_storeu_ps(pDst + i * 4 + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, _mm_setzero_si128())), scale));
+		_mm_storeu_ps(pDst + i * 4 + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, _mm_setzero_si128())), scale));
+		_mm_storeu_ps(pDst + i * 4 + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, _mm_setzero_si128())), scale));
+	}
+	return i;
+}
+
+#endif
+
+/*------------------------------------AVX2------------------------------------*/
+
+/*The same math as the SSE2 kernels 8 wide, F16C does the half conversions*/
+#if AS_VERTEX_AVX2
+
+AS_VERTEX_TARGET_AVX2 static __m256 _select8(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256 _clampUnit8(__m256 v)
+{
+	return _mm256_max_ps(_mm256_min_ps(v, _mm256_set1_ps(1.0f)), _mm256_set1_ps(-1.0f));
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256 _abs8(__m256 v)
+{
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+AS_VERTEX_TARGET_AVX2 static void _loadVec3x8(const float* pSrc, __m256* pX, __m256* pY, __m256* pZ)
+{
+	__m128 x[2], y[2], z[2];
+	_loadVec3x4(pSrc, &x[0], &y[0], &z[0]);
+	_loadVec3x4(pSrc + 12, &x[1], &y[1], &z[1]);
+	*pX = _mm256_insertf128_ps(_mm256_castps128_ps256(x[0]), x[1], 1);
+	*pY = _mm256_insertf128_ps(_mm256_castps128_ps256(y[0]), y[1], 1);
+	*pZ = _mm256_insertf128_ps(_mm256_castps128_ps256(z[0]), z[1], 1);
+}
+
+AS_VERTEX_TARGET_AVX2 static void _storeVec3x8(float* pDst, __m256 x, __m256 y, __m256 z)
+{
+	float values[3][8];
+	_mm256_storeu_ps(values[0], x);
+	_mm256_storeu_ps(values[1], y);
+	_mm256_storeu_ps(values[2], z);
+	for (int i = 0; i < 8; i++)
+	{
+		pDst[i * 3 + 0] = values[0][i];
+		pDst[i * 3 + 1] = values[1][i];
+		pDst[i * 3 + 2] = values[2][i];
+	}
+}
+
+/*Transpose 4x4 within each 128 bit lane, the low lane holds vectors 0-3 and the high lane vectors 4-7*/
+AS_VERTEX_TARGET_AVX2 static void _transpose8x4(__m256* pA, __m256* pB, __m256* pC, __m256* pD)
+{
+	const __m256 t0 = _mm256_unpacklo_ps(*pA, *pB);
+	const __m256 t1 = _mm256_unpacklo_ps(*pC, *pD);
+	const __m256 t2 = _mm256_unpackhi_ps(*pA, *pB);
+	const __m256 t3 = _mm256_unpackhi_ps(*pC, *pD);
+	*pA = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	*pB = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	*pC = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	*pD = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+AS_VERTEX_TARGET_AVX2 static void _loadVec4x8(const float* pSrc, __m256* pX, __m256* pY, __m256* pZ, __m256* pW)
+{
+	*pX = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pSrc)), _mm_loadu_ps(pSrc + 16), 1);
+	*pY = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pSrc + 4)), _mm_loadu_ps(pSrc + 20), 1);
+	*pZ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pSrc + 8)), _mm_loadu_ps(pSrc + 24), 1);
+	*pW = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pSrc + 12)), _mm_loadu_ps(pSrc + 28), 1);
+	_transpose8x4(pX, pY, pZ, pW);
+}
+
+AS_VERTEX_TARGET_AVX2 static void _storeVec4x8(float* pDst, __m256 x, __m256 y, __m256 z, __m256 w)
+{
+	_transpose8x4(&x, &y, &z, &w);
+	_mm_storeu_ps(pDst, _mm256_castps256_ps128(x));
+	_mm_storeu_ps(pDst + 4, _mm256_castps256_ps128(y));
+	_mm_storeu_ps(pDst + 8, _mm256_castps256_ps128(z));
+	_mm_storeu_ps(pDst + 12, _mm256_castps256_ps128(w));
+	_mm_storeu_ps(pDst + 16, _mm256_extractf128_ps(x, 1));
+	_mm_storeu_ps(pDst + 20, _mm256_extractf128_ps(y, 1));
+	_mm_storeu_ps(pDst + 24, _mm256_extractf128_ps(z, 1));
+	_mm_storeu_ps(pDst + 28, _mm256_extractf128_ps(w, 1));
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _floatToHalfAvx2(uint16_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm256_cvtps_ph(_mm256_loadu_ps(pSrc + i), _MM_FROUND_TO_NEAREST_INT));
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _halfToFloatAvx2(float* pDst, const uint16_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(pDst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(pSrc + i))));
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256i _snorm10x8(__m256 v)
+{
+	return _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(_clampUnit8(v), _mm256_set1_ps(511.0f))), _mm256_set1_epi32(0x3FF));
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256i _encodeSnorm10x8(__m256 x, __m256 y, __m256 z)
+{
+	return _mm256_or_si256(_snorm10x8(z), _mm256_or_si256(_mm256_slli_epi32(_snorm10x8(y), 10), _mm256_slli_epi32(_snorm10x8(x), 20)));
+}
+
+AS_VERTEX_TARGET_AVX2 static void _decodeSnorm10x8(__m256i packed, __m256* pX, __m256* pY, __m256* pZ)
+{
+	const __m256 scale = _mm256_set1_ps(511.0f);
+	const __m256 minimum = _mm256_set1_ps(-1.0f);
+	*pX = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(packed, 2), 22)), scale), minimum);
+	*pY = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(packed, 12), 22)), scale), minimum);
+	*pZ = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(packed, 22), 22)), scale), minimum);
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256i _encodeOctahedral8(__m256 x, __m256 y, __m256 z)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	__m256 sum = _mm256_add_ps(_mm256_add_ps(_abs8(x), _abs8(y)), _abs8(z));
+	sum = _select8(_mm256_cmp_ps(sum, zero, _CMP_GT_OQ), sum, one);
+	x = _mm256_div_ps(x, sum);
+	y = _mm256_div_ps(y, sum);
+	const __m256 foldedX = _mm256_mul_ps(_mm256_sub_ps(one, _abs8(y)), _select8(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), one, minusOne));
+	const __m256 foldedY = _mm256_mul_ps(_mm256_sub_ps(one, _abs8(x)), _select8(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), one, minusOne));
+	const __m256 lower = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+	x = _select8(lower, foldedX, x);
+	y = _select8(lower, foldedY, y);
+	const __m256 scale = _mm256_set1_ps(32767.0f);
+	const __m256i qx = _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(_clampUnit8(x), scale)), _mm256_set1_epi32(0xFFFF));
+	const __m256i qy = _mm256_cvtps_epi32(_mm256_mul_ps(_clampUnit8(y), scale));
+	return _mm256_or_si256(qx, _mm256_slli_epi32(qy, 16));
+}
+
+AS_VERTEX_TARGET_AVX2 static void _decodeOctahedral8(__m256i packed, __m256* pX, __m256* pY, __m256* pZ)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 signBit = _mm256_set1_ps(-0.0f);
+	const __m256 scale = _mm256_set1_ps(32767.0f);
+	const __m256 minimum = _mm256_set1_ps(-1.0f);
+	__m256 x = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(packed, 16), 16)), scale), minimum);
+	__m256 y = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(packed, 16)), scale), minimum);
+	const __m256 z = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _abs8(x)), _abs8(y));
+	const __m256 t = _mm256_max_ps(_mm256_xor_ps(z, signBit), zero);
+	x = _mm256_add_ps(x, _select8(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), _mm256_xor_ps(t, signBit), t));
+	y = _mm256_add_ps(y, _select8(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), _mm256_xor_ps(t, signBit), t));
+	const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+	*pX = _mm256_div_ps(x, length);
+	*pY = _mm256_div_ps(y, length);
+	*pZ = _mm256_div_ps(z, length);
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _encodeNormalsAvx2(uint32_t* pDst, const float* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x, y, z;
+		_loadVec3x8(pSrc + i * 3, &x, &y, &z);
+		const __m256i packed = encoding == AS_VERTEX_NORMAL_OCTAHEDRAL ? _encodeOctahedral8(x, y, z) : _encodeSnorm10x8(x, y, z);
+		_mm256_storeu_si256((__m256i*)(pDst + i), packed);
+	}
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _decodeNormalsAvx2(float* pDst, const uint32_t* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i packed = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+		__m256 x, y, z;
+		if (encoding == AS_VERTEX_NORMAL_OCTAHEDRAL)
+			_decodeOctahedral8(packed, &x, &y, &z);
+		else
+			_decodeSnorm10x8(packed, &x, &y, &z);
+		_storeVec3x8(pDst + i * 3, x, y, z);
+	}
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _encodeTangentsAvx2(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x, y, z, w;
+		_loadVec4x8(pSrc + i * 4, &x, &y, &z, &w);
+		const __m256i negative = _mm256_castps_si256(_mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_LT_OQ));
+		const __m256i sign = _mm256_or_si256(_mm256_and_si256(negative, _mm256_set1_epi32(2)), _mm256_set1_epi32(1));
+		const __m256i packed = _mm256_or_si256(_encodeSnorm10x8(x, y, z), _mm256_slli_epi32(sign, 30));
+		_mm256_storeu_si256((__m256i*)(pDst + i), packed);
+	}
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _decodeTangentsAvx2(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i packed = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+		__m256 x, y, z;
+		_decodeSnorm10x8(packed, &x, &y, &z);
+		const __m256 negative = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_setzero_si256(), packed));
+		const __m256 w = _select8(negative, _mm256_set1_ps(-1.0f), _mm256_set1_ps(1.0f));
+		_storeVec4x8(pDst + i * 4, x, y, z, w);
+	}
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static __m256i _encodeBoneWeights8(__m256 w0, __m256 w1, __m256 w2, __m256 w3)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 scale = _mm256_set1_ps(255.0f);
+	w0 = _mm256_max_ps(w0, zero);
+	w1 = _mm256_max_ps(w1, zero);
+	w2 = _mm256_max_ps(w2, zero);
+	w3 = _mm256_max_ps(w3, zero);
+	const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(w0, w1), w2), w3);
+	const __m256i valid = _mm256_castps_si256(_mm256_cmp_ps(sum, zero, _CMP_GT_OQ));
+	__m256i q0 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_div_ps(w0, sum), one), scale));
+	__m256i q1 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_div_ps(w1, sum), one), scale));
+	__m256i q2 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_div_ps(w2, sum), one), scale));
+	__m256i q3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_div_ps(w3, sum), one), scale));
+	const __m256i error = _mm256_sub_epi32(_mm256_set1_epi32(255), _mm256_add_epi32(_mm256_add_epi32(q0, q1), _mm256_add_epi32(q2, q3)));
+
+	const __m256i largest = _mm256_max_epi32(_mm256_max_epi32(q0, q1), _mm256_max_epi32(q2, q3));
+	const __m256i is0 = _mm256_cmpeq_epi32(q0, largest);
+	const __m256i is1 = _mm256_andnot_si256(is0, _mm256_cmpeq_epi32(q1, largest));
+	const __m256i is2 = _mm256_andnot_si256(_mm256_or_si256(is0, is1), _mm256_cmpeq_epi32(q2, largest));
+	const __m256i is3 = _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(is0, is1), is2), _mm256_set1_epi32(-1));
+	q0 = _mm256_add_epi32(q0, _mm256_and_si256(is0, error));
+	q1 = _mm256_add_epi32(q1, _mm256_and_si256(is1, error));
+	q2 = _mm256_add_epi32(q2, _mm256_and_si256(is2, error));
+	q3 = _mm256_add_epi32(q3, _mm256_and_si256(is3, error));
+
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	const __m256i packed = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(q0, byteMask), _mm256_slli_epi32(_mm256_and_si256(q1, byteMask), 8)),
+		_mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(q2, byteMask), 16), _mm256_slli_epi32(q3, 24)));
+	return _mm256_and_si256(packed, valid);
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _encodeBoneWeightsAvx2(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 w0, w1, w2, w3;
+		_loadVec4x8(pSrc + i * 4, &w0, &w1, &w2, &w3);
+		_mm256_storeu_si256((__m256i*)(pDst + i), _encodeBoneWeights8(w0, w1, w2, w3));
+	}
+	return i;
+}
+
+AS_VERTEX_TARGET_AVX2 static size_t _decodeBoneWeightsAvx2(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	const __m256 scale = _mm256_set1_ps(255.0f);
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		const __m256i weights = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pSrc + i)));
+		_mm256_storeu_ps(pDst + i * 4, _mm256_div_ps(_mm256_cvtepi32_ps(weights), scale));
+	}
+	return i;
+}
+
+#endif
+
+/*------------------------------------ENCODING------------------------------------*/
+
+ASEXPORT void asVertexEncode_FloatToHalf(uint16_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _floatToHalfAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _floatToHalfSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		pDst[i] = _floatToHalf(pSrc[i]);
+}
+
+ASEXPORT void asVertexDecode_HalfToFloat(float* pDst, const uint16_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _halfToFloatAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _halfToFloatSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		pDst[i] = _halfToFloat(pSrc[i]);
+}
+
+ASEXPORT void asVertexEncode_Normals(uint32_t* pDst, const float* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _encodeNormalsAvx2(pDst, pSrc, count, encoding); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _encodeNormalsSse2(pDst, pSrc, count, encoding); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		pDst[i] = encoding == AS_VERTEX_NORMAL_OCTAHEDRAL ? _encodeOctahedral(&pSrc[i * 3]) : _encodeSnorm10(&pSrc[i * 3], 0);
+}
+
+ASEXPORT void asVertexDecode_Normals(float* pDst, const uint32_t* pSrc, size_t count, asVertexNormalEncoding encoding)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _decodeNormalsAvx2(pDst, pSrc, count, encoding); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _decodeNormalsSse2(pDst, pSrc, count, encoding); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+	{
+		if (encoding == AS_VERTEX_NORMAL_OCTAHEDRAL)
+			_decodeOctahedral(&pDst[i * 3], pSrc[i]);
+		else
+			_decodeSnorm10(&pDst[i * 3], pSrc[i]);
+	}
+}
+
+ASEXPORT void asVertexEncode_Tangents(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _encodeTangentsAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _encodeTangentsSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		pDst[i] = _encodeTangent(&pSrc[i * 4]);
+}
+
+ASEXPORT void asVertexDecode_Tangents(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _decodeTangentsAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _decodeTangentsSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		_decodeTangent(&pDst[i * 4], pSrc[i]);
+}
+
+ASEXPORT void asVertexEncode_BoneWeights(uint32_t* pDst, const float* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _encodeBoneWeightsAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _encodeBoneWeightsSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		pDst[i] = _encodeBoneWeights(&pSrc[i * 4]);
+}
+
+ASEXPORT void asVertexDecode_BoneWeights(float* pDst, const uint32_t* pSrc, size_t count)
+{
+	size_t i = 0;
+	switch (_vertexSimdLevel())
+	{
+#if AS_VERTEX_AVX2
+	case AS_VERTEX_SIMD_AVX2: i = _decodeBoneWeightsAvx2(pDst, pSrc, count); break;
+#endif
+#if AS_VERTEX_SSE2
+	case AS_VERTEX_SIMD_SSE2: i = _decodeBoneWeightsSse2(pDst, pSrc, count); break;
+#endif
+	default: break;
+	}
+	for (; i < count; i++)
+		_decodeBoneWeights(&pDst[i * 4], pSrc[i]);
+}
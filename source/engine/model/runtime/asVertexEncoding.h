@@ -0,0 +1,106 @@
+#ifndef _ASVERTEXENCODING_H_
+#define _ASVERTEXENCODING_H_
+
+#include "../engine/common/asCommon.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Array at a time encoding and decoding of packed vertex attributes
+* Every routine has a scalar path, an SSE2 path and an AVX2 (with F16C) path picked at runtime,
+* all of them give the same bits for the same input (the scalar path is the reference)
+* Float to int conversions round to nearest even and follow the current rounding mode like the SIMD paths do
+*/
+
+/**
+* @brief Instruction sets the encoders can use
+*/
+typedef enum {
+	AS_VERTEX_SIMD_SCALAR,
+	AS_VERTEX_SIMD_SSE2,
+	AS_VERTEX_SIMD_AVX2, /**< AVX2 and F16C*/
+	AS_VERTEX_SIMD_COUNT,
+	AS_VERTEX_SIMD_MAX = UINT32_MAX
+} asVertexSimdLevel;
+
+/**
+* @brief Best instruction set the CPU supports (or the one forced by asVertexEncode_SetSimdLevel())
+*/
+ASEXPORT asVertexSimdLevel asVertexEncode_GetSimdLevel();
+
+/**
+* @brief Force an instruction set for testing and benchmarks (AS_VERTEX_SIMD_COUNT returns to the best supported)
+* @return the level in use, levels the CPU does not support fall back to the best one it does
+*/
+ASEXPORT asVertexSimdLevel asVertexEncode_SetSimdLevel(asVertexSimdLevel level);
+
+/**
+* @brief Ways a unit vector is packed into 32 bits
+*/
+typedef enum {
+	AS_VERTEX_NORMAL_SNORM10, /**< XYZ as 10 bit SNORM from the high bits down (A2R10G10B10_SNORM) with W left 0*/
+	AS_VERTEX_NORMAL_OCTAHEDRAL, /**< Octahedral map as 16 bit SNORM, X in the low bits (RG16_SNORM)*/
+	AS_VERTEX_NORMAL_MAX = UINT32_MAX
+} asVertexNormalEncoding;
+
+/*Half floats*/
+
+/**
+* @brief Convert floats to IEEE half floats (round to nearest even, NaNs stay NaNs)
+*/
+ASEXPORT void asVertexEncode_FloatToHalf(uint16_t* pDst, const float* pSrc, size_t count);
+
+/**
+* @brief Convert IEEE half floats to floats (exact, signaling NaNs become quiet)
+*/
+ASEXPORT void asVertexDecode_HalfToFloat(float* pDst, const uint16_t* pSrc, size_t count);
+
+/*Normals and tangents*/
+
+/**
+* @brief Pack unit vectors, components outside [-1, 1] are clamped
+* @param pSrc 3 floats per normal
+*/
+ASEXPORT void asVertexEncode_Normals(uint32_t* pDst, const float* pSrc, size_t count, asVertexNormalEncoding encoding);
+
+/**
+* @brief Unpack normals (octahedral normals come back unit length)
+* @param pDst 3 floats per normal
+*/
+ASEXPORT void asVertexDecode_Normals(float* pDst, const uint32_t* pSrc, size_t count, asVertexNormalEncoding encoding);
+
+/**
+* @brief Pack tangents as AS_VERTEX_NORMAL_SNORM10 with the bitangent sign in W (negative W stores -1, anything else 1)
+* @param pSrc 4 floats per tangent
+*/
+ASEXPORT void asVertexEncode_Tangents(uint32_t* pDst, const float* pSrc, size_t count);
+
+/**
+* @brief Unpack tangents
+* @param pDst 4 floats per tangent, W is 1 or -1
+*/
+ASEXPORT void asVertexDecode_Tangents(float* pDst, const uint32_t* pSrc, size_t count);
+
+/*Bone weights*/
+
+/**
+* @brief Quantize 4 bone weights to 8 bit UNORM that add up to exactly 255
+* weights are normalized first, negative weights count as 0 and all zero weights stay zero
+* the rounding error goes to the largest weight (the first one on ties)
+* @param pSrc 4 floats per vertex
+* @param pDst 4 bytes per vertex (first weight in the low byte)
+*/
+ASEXPORT void asVertexEncode_BoneWeights(uint32_t* pDst, const float* pSrc, size_t count);
+
+/**
+* @brief Unpack bone weights
+* @param pDst 4 floats per vertex
+*/
+ASEXPORT void asVertexDecode_BoneWeights(float* pDst, const uint32_t* pSrc, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -7,21 +7,47 @@
 #include <SDL_vulkan.h>
 #endif
 
+int32_t gTexturePoolSize = AS_MAX_POOLED_TEXTURES;
+
 asTextureHandle_t missingTextureHndl;
 asTextureHandle_t textureHandleAssociations[AS_MAX_POOLED_TEXTURES] = { 0 }; /*Allows Further Remapping for Streaming/Unload*/
 
 #if ASTRENGINE_VK /*Vulkan Globals*/
-int32_t texturePoolFrame = 0;
 VkDescriptorSet vTexturePoolDescSets[AS_MAX_INFLIGHT];
 VkDescriptorSetLayout vTexturePoolDescLayout;
 VkDescriptorPool vTexturePoolDescriptorPool;
 #endif
 
-/*Queue of Updates*/
-#define TEXTURE_UPDATE_QUEUE_COUNT (AS_MAX_INFLIGHT + 1)
-int32_t textureUpdateQueueCurrent = 0;
-size_t textureUpdateQueueCounts[TEXTURE_UPDATE_QUEUE_COUNT] = { 0 };
-asBindlessTextureIndex textureUpdateQueues[TEXTURE_UPDATE_QUEUE_COUNT][AS_MAX_POOLED_TEXTURES];
+/*Slot Allocation*/
+int32_t texturePoolCapacity = 0;
+int32_t texturePoolSlotCount = 0; /*Slots past this have never been handed out*/
+int32_t texturePoolFreeCount = 0;
+asBindlessTextureIndex texturePoolFreeSlots[AS_MAX_POOLED_TEXTURES];
+uint8_t texturePoolSlotUsed[AS_MAX_POOLED_TEXTURES];
+
+/*Slots changed since the descriptor set of each frame was last written*/
+#define TEXTURE_DIRTY_WORD_COUNT (AS_MAX_POOLED_TEXTURES / 64)
+#define TEXTURE_WRITE_BATCH 1024
+size_t textureDirtyCounts[AS_MAX_INFLIGHT] = { 0 };
+asBindlessTextureIndex textureDirtySlots[AS_MAX_INFLIGHT][AS_MAX_POOLED_TEXTURES];
+uint64_t textureDirtyBits[AS_MAX_INFLIGHT][TEXTURE_DIRTY_WORD_COUNT];
+
+static void _texturePoolMarkDirty(asBindlessTextureIndex textureIndex)
+{
+	const uint64_t bit = 1ull << (textureIndex % 64);
+	for (int f = 0; f < AS_MAX_INFLIGHT; f++)
+	{
+		if (textureDirtyBits[f][textureIndex / 64] & bit) { continue; }
+		textureDirtyBits[f][textureIndex / 64] |= bit;
+		textureDirtySlots[f][textureDirtyCounts[f]] = textureIndex;
+		textureDirtyCounts[f]++;
+	}
+}
+
+static bool _texturePoolSlotInUse(asBindlessTextureIndex textureIndex)
+{
+	return textureIndex > AS_TEXTURE_POOL_MISSING_INDEX && textureIndex < texturePoolSlotCount && texturePoolSlotUsed[textureIndex];
+}
 
 /*Debug Window*/
 int32_t showTexturePoolDebugWindow = 0;
@@ -39,7 +65,8 @@ void _asTexturePoolDebug()
 		static asBindlessTextureIndex idx;
 		static float squash = 1.0f;
 		static float stretch = 1.0f;
-		igDragInt("Texture Idx", &idx, 0.1f, 0, AS_MAX_POOLED_TEXTURES, NULL);
+		igText("Slots: %d / %d", asTexturePoolGetUsedCount(), texturePoolCapacity);
+		igDragInt("Texture Idx", &idx, 0.1f, 0, texturePoolSlotCount - 1, NULL);
 		igDragFloat("W", &squash, 0.1f, 0.0, 5.0, NULL, 1.0);
 		igDragFloat("H", &stretch, 0.1f, 0.0, 5.0, NULL, 1.0);
 		igImage((ImTextureID)idx, (ImVec2) { 256.0f * squash, 256.0f * stretch }, (ImVec2) { 0, 0 }, (ImVec2) { 1, 1 }, (ImVec4) { 1, 1, 1, 1 }, (ImVec4) { 1, 1, 1, 1 });
@@ -50,43 +77,114 @@ void _asTexturePoolDebug()
 
 ASEXPORT asResults asTexturePoolAddFromHandle(const asTextureHandle_t handle, asBindlessTextureIndex* pTextureIndex)
 {
-	if (handle._index >= AS_MAX_POOLED_TEXTURES) { return AS_FAILURE_OUT_OF_BOUNDS; }
-	textureHandleAssociations[handle._index] = handle;
-	if (pTextureIndex) { *pTextureIndex = handle._index; }
+	if (pTextureIndex) { *pTextureIndex = AS_TEXTURE_POOL_MISSING_INDEX; }
+	if (!asHandleValid(handle)) { return AS_FAILURE_INVALID_PARAM; }
 
-	textureUpdateQueues[textureUpdateQueueCurrent][textureUpdateQueueCounts[textureUpdateQueueCurrent]] = handle._index;
-	textureUpdateQueueCounts[textureUpdateQueueCurrent]++;
+	/*Reuse released slots first*/
+	asBindlessTextureIndex textureIndex;
+	if (texturePoolFreeCount > 0)
+	{
+		texturePoolFreeCount--;
+		textureIndex = texturePoolFreeSlots[texturePoolFreeCount];
+	}
+	else if (texturePoolSlotCount < texturePoolCapacity)
+	{
+		textureIndex = texturePoolSlotCount;
+		texturePoolSlotCount++;
+	}
+	else
+	{
+		asDebugWarning("Texture pool is full (%d textures)", texturePoolCapacity);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	texturePoolSlotUsed[textureIndex] = 1;
+	textureHandleAssociations[textureIndex] = handle;
+	_texturePoolMarkDirty(textureIndex);
+	if (pTextureIndex) { *pTextureIndex = textureIndex; }
 	return AS_SUCCESS;
 }
 
 ASEXPORT asResults asTexturePoolRelease(asBindlessTextureIndex textureIndex)
 {
+	if (!_texturePoolSlotInUse(textureIndex)) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	texturePoolSlotUsed[textureIndex] = 0;
 	textureHandleAssociations[textureIndex] = missingTextureHndl;
-	textureUpdateQueues[textureUpdateQueueCurrent][textureUpdateQueueCounts[textureUpdateQueueCurrent]] = missingTextureHndl._index;
-	textureUpdateQueueCounts[textureUpdateQueueCurrent]++;
+	_texturePoolMarkDirty(textureIndex);
+	texturePoolFreeSlots[texturePoolFreeCount] = textureIndex;
+	texturePoolFreeCount++;
 	return AS_SUCCESS;
 }
 
+ASEXPORT asResults asTexturePoolRemap(asBindlessTextureIndex textureIndex, const asTextureHandle_t handle)
+{
+	if (!_texturePoolSlotInUse(textureIndex)) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	if (!asHandleValid(handle)) { return AS_FAILURE_INVALID_PARAM; }
+	textureHandleAssociations[textureIndex] = handle;
+	_texturePoolMarkDirty(textureIndex);
+	return AS_SUCCESS;
+}
+
+ASEXPORT int32_t asTexturePoolGetCapacity()
+{
+	return texturePoolCapacity;
+}
+
+ASEXPORT int32_t asTexturePoolGetUsedCount()
+{
+	return texturePoolSlotCount - texturePoolFreeCount;
+}
+
 ASEXPORT asResults asInitTexturePool()
 {
 	asPreferencesRegisterOpenSection(asGetGlobalPrefs(), "gfx");
 	asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "debugActiveTextureViewer", &showTexturePoolDebugWindow, 0, 1, false, NULL, NULL, "Show Texture Pool Dump");
+	asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "texturePoolSize", &gTexturePoolSize, 64, AS_MAX_POOLED_TEXTURES, true, NULL, NULL,
+		"Slots in the bindless texture pool (Requires Restart)");
+	asPreferencesLoadSection(asGetGlobalPrefs(), "gfx");
+
+	/*Size*/
+	texturePoolCapacity = gTexturePoolSize;
+#if ASTRENGINE_VK
+	if ((uint32_t)texturePoolCapacity > asVkDescriptorIndexingProps.maxDescriptorSetUpdateAfterBindSampledImages)
+		texturePoolCapacity = (int32_t)asVkDescriptorIndexingProps.maxDescriptorSetUpdateAfterBindSampledImages;
+	if ((uint32_t)texturePoolCapacity > asVkDescriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages)
+		texturePoolCapacity = (int32_t)asVkDescriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages;
+#endif
+	asDebugLog("Texture Pool Size: %d", texturePoolCapacity);
+	texturePoolSlotCount = 0;
+	texturePoolFreeCount = 0;
+	memset(texturePoolSlotUsed, 0, sizeof(texturePoolSlotUsed));
+	memset(textureDirtyCounts, 0, sizeof(textureDirtyCounts));
+	memset(textureDirtyBits, 0, sizeof(textureDirtyBits));
 
-	/*Missing Texture*/
 #if ASTRENGINE_VK
 	/*Descriptor Set Layout*/
 	{
+		/*Slots are only written once used and may change while a frame is recorded*/
+		VkDescriptorBindingFlagsEXT bindingFlags[] = {
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT |
+			VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT
+		};
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT };
+		bindingFlagsInfo.bindingCount = ASARRAYLEN(bindingFlags);
+		bindingFlagsInfo.pBindingFlags = bindingFlags;
+
 		VkDescriptorSetLayoutBinding descriptorBindings[] = {
 
 			(VkDescriptorSetLayoutBinding) {
 				.binding = AS_BINDING_TEXTURE_POOL,
 				.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-				.descriptorCount = AS_MAX_POOLED_TEXTURES,
+				.descriptorCount = (uint32_t)texturePoolCapacity,
 				.stageFlags = VK_SHADER_STAGE_ALL,
 			}
 		};
 
 		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+		descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
 		descriptorSetLayoutInfo.bindingCount = ASARRAYLEN(descriptorBindings);
 		descriptorSetLayoutInfo.pBindings = descriptorBindings;
 		AS_VK_CHECK(vkCreateDescriptorSetLayout(asVkDevice, &descriptorSetLayoutInfo, AS_VK_MEMCB, &vTexturePoolDescLayout),
@@ -94,29 +192,36 @@ ASEXPORT asResults asInitTexturePool()
 	}
 	/*Descriptor Pool*/
 	{
-		VkDescriptorPoolSize fontImagePoolSize = { 0 };
-		fontImagePoolSize.descriptorCount = AS_MAX_POOLED_TEXTURES * AS_MAX_INFLIGHT;
-		fontImagePoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		VkDescriptorPoolSize texturePoolSize = { 0 };
+		texturePoolSize.descriptorCount = (uint32_t)texturePoolCapacity * AS_MAX_INFLIGHT;
+		texturePoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 
 		VkDescriptorPoolCreateInfo createInfo = (VkDescriptorPoolCreateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-		createInfo.maxSets = 2;
+		createInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+		createInfo.maxSets = AS_MAX_INFLIGHT;
 		createInfo.poolSizeCount = 1;
-		createInfo.pPoolSizes = &fontImagePoolSize;
+		createInfo.pPoolSizes = &texturePoolSize;
 		AS_VK_CHECK(vkCreateDescriptorPool(asVkDevice, &createInfo, AS_VK_MEMCB, &vTexturePoolDescriptorPool),
 			"vkCreateDescriptorPool() Failed to create vTexturePoolDescriptorPool");
 	}
 	/*Descriptor Set*/
 	{
 		VkDescriptorSetLayout layouts[AS_MAX_INFLIGHT];
-		for (int i = 0; i < AS_MAX_INFLIGHT; i++) { layouts[i] = vTexturePoolDescLayout; }
+		uint32_t counts[AS_MAX_INFLIGHT];
+		for (int i = 0; i < AS_MAX_INFLIGHT; i++) { layouts[i] = vTexturePoolDescLayout; counts[i] = (uint32_t)texturePoolCapacity; }
+		VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableCountInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT };
+		variableCountInfo.descriptorSetCount = AS_MAX_INFLIGHT;
+		variableCountInfo.pDescriptorCounts = counts;
 		VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		descSetAllocInfo.pNext = &variableCountInfo;
 		descSetAllocInfo.descriptorPool = vTexturePoolDescriptorPool;
 		descSetAllocInfo.descriptorSetCount = AS_MAX_INFLIGHT;
 		descSetAllocInfo.pSetLayouts = layouts;
 		AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, vTexturePoolDescSets),
 			"vkAllocateDescriptorSets() Failed to allocate vTexturePoolDescSets");
 	}
-	/*Set all as Blank Texture*/
+#endif
+	/*Missing Texture*/
 	{
 		uint32_t tex[4][4];
 		memset(tex, 255, 4 * 4 * 4);
@@ -141,54 +246,69 @@ ASEXPORT asResults asInitTexturePool()
 		desc.pDebugLabel = "MissingTexture";
 		missingTextureHndl = asCreateTexture(&desc);
 
-		for (size_t i = 0; i < AS_MAX_POOLED_TEXTURES; i++)
-		{
-			for (int f = 0; f < AS_MAX_INFLIGHT; f++)
-			{
-				VkWriteDescriptorSet descSetWrite = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-				descSetWrite.dstSet = vTexturePoolDescSets[f];
-				descSetWrite.dstBinding = AS_BINDING_TEXTURE_POOL;
-				descSetWrite.descriptorCount = 1;
-				descSetWrite.dstArrayElement = i;
-				descSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				descSetWrite.pImageInfo = &(VkDescriptorImageInfo) {
-					.imageView = asVkGetViewFromTexture(missingTextureHndl),
-						.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-						.sampler = *asVkGetSimpleSamplerPtr(true)
-				};
-				vkUpdateDescriptorSets(asVkDevice, 1, &descSetWrite, 0, NULL);
-			}
-		}
+		/*Only the first slot is written, the rest are left unbound until used*/
+		asTexturePoolAddFromHandle(missingTextureHndl, NULL);
 	}
-#endif
 	return AS_SUCCESS;
 }
 
+static int _texturePoolCompareIndex(const void* pA, const void* pB)
+{
+	return *(const asBindlessTextureIndex*)pA - *(const asBindlessTextureIndex*)pB;
+}
+
 ASEXPORT asResults asTexturePoolUpdate()
 {
-	/*Update Descriptors*/
-	textureUpdateQueueCurrent = texturePoolFrame;
-	texturePoolFrame = asVkCurrentFrame;
-	for (int f = 0; f < AS_MAX_INFLIGHT; f++)
+#if ASTRENGINE_VK
+	/*The current frame's set is no longer in use, write every slot that changed since it was last written*/
+	const int frame = asVkCurrentFrame;
+	const size_t dirtyCount = textureDirtyCounts[frame];
+	if (!dirtyCount) { return AS_SUCCESS; }
+	asBindlessTextureIndex* pDirty = textureDirtySlots[frame];
+	qsort(pDirty, dirtyCount, sizeof(asBindlessTextureIndex), _texturePoolCompareIndex);
+
+	/*Neighbouring slots share one write, writes are submitted in batches*/
+	static VkDescriptorImageInfo imageInfos[TEXTURE_WRITE_BATCH];
+	static VkWriteDescriptorSet descSetWrites[TEXTURE_WRITE_BATCH];
+	const VkSampler sampler = *asVkGetSimpleSamplerPtr(true);
+	uint32_t imageCount = 0;
+	uint32_t writeCount = 0;
+	for (size_t i = 0; i < dirtyCount; i++)
 	{
-		int queueIdx = abs((f + textureUpdateQueueCurrent - TEXTURE_UPDATE_QUEUE_COUNT) % AS_MAX_INFLIGHT);
-		for (size_t i = 0; i < textureUpdateQueueCounts[queueIdx]; i++)
+		const asBindlessTextureIndex textureIndex = pDirty[i];
+		textureDirtyBits[frame][textureIndex / 64] &= ~(1ull << (textureIndex % 64));
+		imageInfos[imageCount] = (VkDescriptorImageInfo) {
+			.imageView = asVkGetViewFromTexture(textureHandleAssociations[textureIndex]),
+			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.sampler = sampler
+		};
+		if (writeCount && i && pDirty[i - 1] + 1 == textureIndex)
+		{
+			descSetWrites[writeCount - 1].descriptorCount++;
+		}
+		else
 		{
 			VkWriteDescriptorSet descSetWrite = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			descSetWrite.dstSet = vTexturePoolDescSets[texturePoolFrame];
+			descSetWrite.dstSet = vTexturePoolDescSets[frame];
 			descSetWrite.dstBinding = AS_BINDING_TEXTURE_POOL;
 			descSetWrite.descriptorCount = 1;
-			descSetWrite.dstArrayElement = textureUpdateQueues[queueIdx][i];
+			descSetWrite.dstArrayElement = (uint32_t)textureIndex;
 			descSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descSetWrite.pImageInfo = &(VkDescriptorImageInfo) {
-				.imageView = asVkGetViewFromTexture(textureHandleAssociations[textureUpdateQueues[queueIdx][i]]),
-				.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				.sampler = *asVkGetSimpleSamplerPtr(true)
-			};
-			vkUpdateDescriptorSets(asVkDevice, 1, &descSetWrite, 0, NULL);
+			descSetWrite.pImageInfo = &imageInfos[imageCount];
+			descSetWrites[writeCount] = descSetWrite;
+			writeCount++;
+		}
+		imageCount++;
+
+		if (imageCount == TEXTURE_WRITE_BATCH || i == dirtyCount - 1)
+		{
+			vkUpdateDescriptorSets(asVkDevice, writeCount, descSetWrites, 0, NULL);
+			imageCount = 0;
+			writeCount = 0;
 		}
-		if (f == TEXTURE_UPDATE_QUEUE_COUNT - 1) { textureUpdateQueueCounts[queueIdx] = 0; }
 	}
+	textureDirtyCounts[frame] = 0;
+#endif
 	return AS_SUCCESS;
 }
 
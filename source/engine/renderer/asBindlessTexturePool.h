@@ -9,15 +9,44 @@ extern "C" {
 
 typedef int32_t asBindlessTextureIndex;
 
-#define AS_MAX_POOLED_TEXTURES 1024
+/*Upper bound of the pool, the actual size is the "texturePoolSize" preference clamped to the device limits*/
+#define AS_MAX_POOLED_TEXTURES 65536
+/*Always holds the missing texture (slots that were never written are not valid to sample)*/
+#define AS_TEXTURE_POOL_MISSING_INDEX 0
 
 #define AS_BINDING_TEXTURE_POOL 200
 #define AS_DESCSET_TEXTURE_POOL 0
 
+/**
+* @brief Take a free slot in the pool for a texture
+* @param pTextureIndex filled with the slot (AS_TEXTURE_POOL_MISSING_INDEX if the pool is full)
+*/
 ASEXPORT asResults asTexturePoolAddFromHandle(const asTextureHandle_t handle, asBindlessTextureIndex* pTextureIndex);
 
+/**
+* @brief Return a slot to the pool, it reads as the missing texture until reused
+*/
 ASEXPORT asResults asTexturePoolRelease(asBindlessTextureIndex textureIndex);
 
+/**
+* @brief Number of slots the pool was created with
+*/
+ASEXPORT int32_t asTexturePoolGetCapacity();
+
+/**
+* @brief Number of slots currently in use (including the missing texture)
+*/
+ASEXPORT int32_t asTexturePoolGetUsedCount();
+
+/*Frames until a slot change has been written to the descriptors of every frame in flight*/
+#define AS_TEXTURE_POOL_UPDATE_LATENCY (AS_MAX_INFLIGHT + 1)
+
+/**
+* @brief Point an existing slot at a different texture (used for streaming)
+* @warning the previous texture must stay alive for AS_TEXTURE_POOL_UPDATE_LATENCY frames
+*/
+ASEXPORT asResults asTexturePoolRemap(asBindlessTextureIndex textureIndex, const asTextureHandle_t handle);
+
 ASEXPORT asResults asInitTexturePool();
 
 ASEXPORT asResults asTexturePoolUpdate();
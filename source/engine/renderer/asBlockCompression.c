@@ -0,0 +1,864 @@
+#include "asBlockCompression.h"
+#include "../thread/asJobSystem.h"
+
+#include <float.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_BC_SSE2 1
+#include <emmintrin.h>
+#else
+#define AS_BC_SSE2 0
+#endif
+
+/*Blocks are kept as floats with each channel in its own row so 4 pixels are handled at once*/
+typedef struct {
+	float c[4][16];
+} bcBlock;
+
+/*Index Selection*/
+
+/*Find the closest palette entry for every pixel, returns the error of each pixel*/
+static void _bcSelectIndices(const bcBlock* pBlock, int channels, const float (*pPalette)[4], int paletteCount, uint8_t indices[16], float errors[16])
+{
+#if AS_BC_SSE2
+	for (int q = 0; q < 16; q += 4)
+	{
+		__m128 px[4];
+		for (int c = 0; c < channels; c++)
+			px[c] = _mm_loadu_ps(&pBlock->c[c][q]);
+		__m128 best = _mm_set1_ps(FLT_MAX);
+		__m128i bestIdx = _mm_setzero_si128();
+		for (int p = 0; p < paletteCount; p++)
+		{
+			__m128 d = _mm_sub_ps(px[0], _mm_set1_ps(pPalette[p][0]));
+			__m128 err = _mm_mul_ps(d, d);
+			for (int c = 1; c < channels; c++)
+			{
+				d = _mm_sub_ps(px[c], _mm_set1_ps(pPalette[p][c]));
+				err = _mm_add_ps(err, _mm_mul_ps(d, d));
+			}
+			const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(err, best));
+			best = _mm_min_ps(err, best);
+			bestIdx = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)), _mm_andnot_si128(closer, bestIdx));
+		}
+		int32_t idx[4];
+		_mm_storeu_ps(&errors[q], best);
+		_mm_storeu_si128((__m128i*)idx, bestIdx);
+		for (int i = 0; i < 4; i++)
+			indices[q + i] = (uint8_t)idx[i];
+	}
+#else
+	for (int i = 0; i < 16; i++)
+	{
+		float best = FLT_MAX;
+		for (int p = 0; p < paletteCount; p++)
+		{
+			float err = 0.0f;
+			for (int c = 0; c < channels; c++)
+			{
+				const float d = pBlock->c[c][i] - pPalette[p][c];
+				err += d * d;
+			}
+			if (err < best)
+			{
+				best = err;
+				indices[i] = (uint8_t)p;
+			}
+		}
+		errors[i] = best;
+	}
+#endif
+}
+
+static float _bcMaskedError(const float errors[16], uint16_t mask)
+{
+	float total = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask & (1 << i))
+			total += errors[i];
+	}
+	return total;
+}
+
+/*Endpoint Fitting*/
+
+/*Endpoints at the extremes of the principal axis of the masked pixels, returns the error left off the axis*/
+static float _bcFitPrincipalAxis(const bcBlock* pBlock, int channels, uint16_t mask, float e0[4], float e1[4])
+{
+	float mean[4] = { 0 };
+	float count = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		if (!(mask & (1 << i)))
+			continue;
+		for (int c = 0; c < channels; c++)
+			mean[c] += pBlock->c[c][i];
+		count += 1.0f;
+	}
+	if (count == 0.0f)
+	{
+		memset(e0, 0, sizeof(float) * 4);
+		memset(e1, 0, sizeof(float) * 4);
+		return 0.0f;
+	}
+	for (int c = 0; c < channels; c++)
+		mean[c] /= count;
+
+	float cov[4][4] = { 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		if (!(mask & (1 << i)))
+			continue;
+		float d[4];
+		for (int c = 0; c < channels; c++)
+			d[c] = pBlock->c[c][i] - mean[c];
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = a; b < channels; b++)
+				cov[a][b] += d[a] * d[b];
+		}
+	}
+	float variance = 0.0f;
+	for (int a = 0; a < channels; a++)
+	{
+		variance += cov[a][a];
+		for (int b = 0; b < a; b++)
+			cov[a][b] = cov[b][a];
+	}
+
+	/*Power iteration from the widest channel*/
+	float axis[4] = { 0 };
+	int widest = 0;
+	for (int c = 1; c < channels; c++)
+	{
+		if (cov[c][c] > cov[widest][widest])
+			widest = c;
+	}
+	axis[widest] = 1.0f;
+	float eigenValue = 0.0f;
+	for (int iter = 0; iter < 8; iter++)
+	{
+		float next[4] = { 0 };
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+				next[a] += cov[a][b] * axis[b];
+		}
+		float length = 0.0f;
+		for (int c = 0; c < channels; c++)
+			length += next[c] * next[c];
+		if (length < 1e-12f)
+			break;
+		length = sqrtf(length);
+		eigenValue = length;
+		for (int c = 0; c < channels; c++)
+			axis[c] = next[c] / length;
+	}
+
+	float tMin = FLT_MAX;
+	float tMax = -FLT_MAX;
+	for (int i = 0; i < 16; i++)
+	{
+		if (!(mask & (1 << i)))
+			continue;
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++)
+			t += (pBlock->c[c][i] - mean[c]) * axis[c];
+		if (t < tMin) tMin = t;
+		if (t > tMax) tMax = t;
+	}
+	for (int c = 0; c < 4; c++)
+	{
+		const float v0 = c < channels ? mean[c] + axis[c] * tMin : 0.0f;
+		const float v1 = c < channels ? mean[c] + axis[c] * tMax : 0.0f;
+		e0[c] = v0 < 0.0f ? 0.0f : (v0 > 255.0f ? 255.0f : v0);
+		e1[c] = v1 < 0.0f ? 0.0f : (v1 > 255.0f ? 255.0f : v1);
+	}
+	const float residual = variance - eigenValue;
+	return residual > 0.0f ? residual : 0.0f;
+}
+
+/*Least squares endpoints for the chosen indices (weights are how far each index is towards e1)*/
+static bool _bcRefineEndpoints(const bcBlock* pBlock, int channels, uint16_t mask, const uint8_t indices[16], const float* pWeights, float e0[4], float e1[4])
+{
+	float a = 0.0f, b = 0.0f, d = 0.0f;
+	float x0[4] = { 0 }, x1[4] = { 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		if (!(mask & (1 << i)))
+			continue;
+		const float w = pWeights[indices[i]];
+		const float iw = 1.0f - w;
+		a += iw * iw;
+		b += iw * w;
+		d += w * w;
+		for (int c = 0; c < channels; c++)
+		{
+			x0[c] += iw * pBlock->c[c][i];
+			x1[c] += w * pBlock->c[c][i];
+		}
+	}
+	const float det = a * d - b * b;
+	if (fabsf(det) < 1e-6f)
+		return false;
+	for (int c = 0; c < channels; c++)
+	{
+		const float v0 = (d * x0[c] - b * x1[c]) / det;
+		const float v1 = (a * x1[c] - b * x0[c]) / det;
+		e0[c] = v0 < 0.0f ? 0.0f : (v0 > 255.0f ? 255.0f : v0);
+		e1[c] = v1 < 0.0f ? 0.0f : (v1 > 255.0f ? 255.0f : v1);
+	}
+	return true;
+}
+
+static int _bcRefineIterations(asBlockCompressQuality quality)
+{
+	switch (quality)
+	{
+	case AS_BLOCKCOMPRESS_QUALITY_FAST: return 0;
+	case AS_BLOCKCOMPRESS_QUALITY_NORMAL: return 2;
+	default: return 4;
+	}
+}
+
+/*BC1*/
+
+static uint16_t _bcTo565(const float c[4])
+{
+	const int r = (int)(c[0] * (31.0f / 255.0f) + 0.5f);
+	const int g = (int)(c[1] * (63.0f / 255.0f) + 0.5f);
+	const int b = (int)(c[2] * (31.0f / 255.0f) + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void _bcFrom565(uint16_t v, float c[4])
+{
+	const int r = (v >> 11) & 31;
+	const int g = (v >> 5) & 63;
+	const int b = v & 31;
+	c[0] = (float)((r << 3) | (r >> 2));
+	c[1] = (float)((g << 2) | (g >> 4));
+	c[2] = (float)((b << 3) | (b >> 2));
+	c[3] = 255.0f;
+}
+
+/*Weights towards color1 for each index*/
+static const float bc1Weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float bc1Weights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+/*Encode the colors for a pair of endpoints, returns the error of the opaque pixels*/
+static float _bcEncodeBC1Colors(const bcBlock* pBlock, uint16_t opaqueMask, const float e0[4], const float e1[4], bool threeColor, uint8_t pOut[8])
+{
+	uint16_t c0 = _bcTo565(e0);
+	uint16_t c1 = _bcTo565(e1);
+	/*Four colors needs c0 > c1, three colors (with transparency) needs c0 <= c1*/
+	if (threeColor ? c0 > c1 : c0 < c1)
+	{
+		const uint16_t tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+	}
+
+	float palette[4][4];
+	_bcFrom565(c0, palette[0]);
+	_bcFrom565(c1, palette[1]);
+	int paletteCount = 4;
+	if (c0 == c1 && !threeColor)
+	{
+		paletteCount = 1;
+	}
+	else if (threeColor)
+	{
+		for (int c = 0; c < 3; c++)
+			palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f;
+		paletteCount = 3;
+	}
+	else
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+	}
+
+	uint8_t indices[16];
+	float errors[16];
+	_bcSelectIndices(pBlock, 3, (const float(*)[4])palette, paletteCount, indices, errors);
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const uint32_t idx = (opaqueMask & (1 << i)) ? indices[i] : 3;
+		bits |= idx << (i * 2);
+	}
+	pOut[0] = (uint8_t)(c0 & 0xFF);
+	pOut[1] = (uint8_t)(c0 >> 8);
+	pOut[2] = (uint8_t)(c1 & 0xFF);
+	pOut[3] = (uint8_t)(c1 >> 8);
+	memcpy(pOut + 4, &bits, sizeof(uint32_t));
+	return _bcMaskedError(errors, opaqueMask);
+}
+
+/*Indices of an encoded BC1 block as weights towards the original e0/e1 order*/
+static void _bcBC1Indices(const uint8_t pBlock[8], uint8_t indices[16])
+{
+	uint32_t bits;
+	memcpy(&bits, pBlock + 4, sizeof(uint32_t));
+	for (int i = 0; i < 16; i++)
+		indices[i] = (uint8_t)((bits >> (i * 2)) & 3);
+}
+
+static void _bcEncodeBC1(const bcBlock* pBlock, asBlockCompressQuality quality, bool allowTransparency, uint8_t pOut[8])
+{
+	uint16_t opaqueMask = 0xFFFF;
+	if (allowTransparency)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			if (pBlock->c[3][i] < 128.0f)
+				opaqueMask &= ~(1 << i);
+		}
+	}
+	const bool threeColor = opaqueMask != 0xFFFF;
+	if (!opaqueMask)
+	{
+		memset(pOut, 0, 4);
+		memset(pOut + 4, 0xFF, 4);
+		return;
+	}
+
+	float e0[4], e1[4];
+	_bcFitPrincipalAxis(pBlock, 3, opaqueMask, e0, e1);
+	float bestError = _bcEncodeBC1Colors(pBlock, opaqueMask, e0, e1, threeColor, pOut);
+	for (int iter = 0; iter < _bcRefineIterations(quality) && bestError > 0.0f; iter++)
+	{
+		/*Refit against the indices of the best block so far (its endpoints may have been swapped)*/
+		uint8_t indices[16];
+		_bcBC1Indices(pOut, indices);
+		float r0[4], r1[4];
+		uint16_t c0, c1;
+		memcpy(&c0, pOut, sizeof(uint16_t));
+		memcpy(&c1, pOut + 2, sizeof(uint16_t));
+		if (!_bcRefineEndpoints(pBlock, 3, opaqueMask, indices, threeColor ? bc1Weights3 : bc1Weights4, r0, r1))
+			break;
+		uint8_t candidate[8];
+		const float error = _bcEncodeBC1Colors(pBlock, opaqueMask, r0, r1, threeColor, candidate);
+		if (error >= bestError)
+			break;
+		bestError = error;
+		memcpy(pOut, candidate, 8);
+	}
+}
+
+/*BC4 (single channel, used for BC3 alpha and BC5)*/
+
+static float _bcEncodeBC4Endpoints(const bcBlock* pBlock, int channel, int a0, int a1, uint8_t pOut[8])
+{
+	float palette[8][4];
+	memset(palette, 0, sizeof(palette));
+	palette[0][0] = (float)a0;
+	palette[1][0] = (float)a1;
+	if (a0 > a1)
+	{
+		for (int i = 1; i < 7; i++)
+			palette[i + 1][0] = ((float)(7 - i) * a0 + (float)i * a1) / 7.0f;
+	}
+	else
+	{
+		for (int i = 1; i < 5; i++)
+			palette[i + 1][0] = ((float)(5 - i) * a0 + (float)i * a1) / 5.0f;
+		palette[6][0] = 0.0f;
+		palette[7][0] = 255.0f;
+	}
+
+	bcBlock channelBlock;
+	memcpy(channelBlock.c[0], pBlock->c[channel], sizeof(float) * 16);
+	uint8_t indices[16];
+	float errors[16];
+	_bcSelectIndices(&channelBlock, 1, (const float(*)[4])palette, 8, indices, errors);
+
+	uint64_t bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= (uint64_t)indices[i] << (i * 3);
+	pOut[0] = (uint8_t)a0;
+	pOut[1] = (uint8_t)a1;
+	for (int i = 0; i < 6; i++)
+		pOut[2 + i] = (uint8_t)(bits >> (i * 8));
+	return _bcMaskedError(errors, 0xFFFF);
+}
+
+static void _bcBC4Indices(const uint8_t pBlock[8], uint8_t indices[16])
+{
+	uint64_t bits = 0;
+	for (int i = 0; i < 6; i++)
+		bits |= (uint64_t)pBlock[2 + i] << (i * 8);
+	for (int i = 0; i < 16; i++)
+		indices[i] = (uint8_t)((bits >> (i * 3)) & 7);
+}
+
+static void _bcEncodeBC4(const bcBlock* pBlock, int channel, asBlockCompressQuality quality, uint8_t pOut[8])
+{
+	float minValue = 255.0f, maxValue = 0.0f;
+	float innerMin = 255.0f, innerMax = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		const float v = pBlock->c[channel][i];
+		if (v < minValue) minValue = v;
+		if (v > maxValue) maxValue = v;
+		if (v > 0.0f && v < innerMin) innerMin = v;
+		if (v < 255.0f && v > innerMax) innerMax = v;
+	}
+	int a0 = (int)(maxValue + 0.5f);
+	int a1 = (int)(minValue + 0.5f);
+	if (a0 == a1)
+	{
+		_bcEncodeBC4Endpoints(pBlock, channel, a0, a1, pOut);
+		return;
+	}
+	float bestError = _bcEncodeBC4Endpoints(pBlock, channel, a0, a1, pOut);
+
+	/*Least squares on the 8 value mode*/
+	static const float bc4Weights[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+	for (int iter = 0; iter < _bcRefineIterations(quality) && bestError > 0.0f; iter++)
+	{
+		uint8_t indices[16];
+		_bcBC4Indices(pOut, indices);
+		bcBlock channelBlock;
+		memcpy(channelBlock.c[0], pBlock->c[channel], sizeof(float) * 16);
+		float r0[4], r1[4];
+		if (!_bcRefineEndpoints(&channelBlock, 1, 0xFFFF, indices, bc4Weights, r0, r1))
+			break;
+		int n0 = (int)(r0[0] + 0.5f);
+		int n1 = (int)(r1[0] + 0.5f);
+		if (n0 == n1)
+			break;
+		if (n0 < n1)
+		{
+			const int tmp = n0;
+			n0 = n1;
+			n1 = tmp;
+		}
+		uint8_t candidate[8];
+		const float error = _bcEncodeBC4Endpoints(pBlock, channel, n0, n1, candidate);
+		if (error >= bestError)
+			break;
+		bestError = error;
+		memcpy(pOut, candidate, 8);
+	}
+
+	/*The 6 value mode has exact 0 and 255 which helps blocks with a few extremes*/
+	if (quality == AS_BLOCKCOMPRESS_QUALITY_HIGH && (minValue == 0.0f || maxValue == 255.0f) && innerMin <= innerMax)
+	{
+		uint8_t candidate[8];
+		const float error = _bcEncodeBC4Endpoints(pBlock, channel, (int)(innerMin + 0.5f), (int)(innerMax + 0.5f), candidate);
+		if (error < bestError)
+			memcpy(pOut, candidate, 8);
+	}
+}
+
+/*BC7*/
+
+typedef struct {
+	uint64_t bits[2];
+	int position;
+} bcBitWriter;
+
+static void _bcWriteBits(bcBitWriter* pWriter, uint32_t value, int count)
+{
+	for (int i = 0; i < count; i++, pWriter->position++)
+	{
+		if (value & (1u << i))
+			pWriter->bits[pWriter->position / 64] |= 1ull << (pWriter->position % 64);
+	}
+}
+
+static void _bcWriteBlock(const bcBitWriter* pWriter, uint8_t pOut[16])
+{
+	for (int i = 0; i < 16; i++)
+		pOut[i] = (uint8_t)(pWriter->bits[i / 8] >> ((i % 8) * 8));
+}
+
+static const float bc7Weights3[8] = { 0.0f, 9.0f / 64.0f, 18.0f / 64.0f, 27.0f / 64.0f, 37.0f / 64.0f, 46.0f / 64.0f, 55.0f / 64.0f, 1.0f };
+static const float bc7Weights4[16] = {
+	0.0f, 4.0f / 64.0f, 9.0f / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+	34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 1.0f
+};
+
+/*Two subset partitions (bit set for pixels in the second subset) and the anchor pixel of the second subset*/
+static const uint16_t bc7Partitions2[64] = {
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+static const uint8_t bc7Anchors2[64] = {
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+	15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+	6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+};
+
+typedef struct {
+	int q[2][4]; /*Quantized endpoints*/
+	int p[2]; /*P-bits (the same for both endpoints when shared)*/
+	uint8_t indices[16];
+	float error;
+} bc7Subset;
+
+/*Quantize endpoints to bits + a p-bit, unique p-bits pick the best per endpoint, shared ones the best for both*/
+static void _bc7Quantize(const float e0[4], const float e1[4], int channels, int bits, bool sharedPBit, bc7Subset* pOut, float palette[][4], int paletteCount, const float* pWeights)
+{
+	const int maxQ = (1 << bits) - 1;
+	const float* pEndpoints[2] = { e0, e1 };
+	float bestError[2] = { FLT_MAX, FLT_MAX };
+	float sharedError[2] = { 0 };
+	int sharedQ[2][2][4];
+	for (int p = 0; p < 2; p++)
+	{
+		for (int e = 0; e < 2; e++)
+		{
+			float error = 0.0f;
+			int q[4] = { 0 };
+			for (int c = 0; c < channels; c++)
+			{
+				int v = (int)((pEndpoints[e][c] - (float)p) / 2.0f * (float)(maxQ * 2 + 1) / 255.0f + 0.5f);
+				v = v < 0 ? 0 : (v > maxQ ? maxQ : v);
+				/*Expand (bits + p-bit) to 8 bits, the bits + 1 wide value is replicated into the low bits*/
+				const int full = (v << 1) | p;
+				const int expanded = (full << (7 - bits)) | (full >> (2 * bits - 6));
+				const float d = (float)expanded - pEndpoints[e][c];
+				error += d * d;
+				q[c] = v;
+			}
+			memcpy(sharedQ[p][e], q, sizeof(q));
+			sharedError[p] += error;
+			if (!sharedPBit && error < bestError[e])
+			{
+				bestError[e] = error;
+				memcpy(pOut->q[e], q, sizeof(q));
+				pOut->p[e] = p;
+			}
+		}
+	}
+	if (sharedPBit)
+	{
+		const int p = sharedError[1] < sharedError[0] ? 1 : 0;
+		memcpy(pOut->q[0], sharedQ[p][0], sizeof(pOut->q[0]));
+		memcpy(pOut->q[1], sharedQ[p][1], sizeof(pOut->q[1]));
+		pOut->p[0] = pOut->p[1] = p;
+	}
+
+	/*Palette from the expanded endpoints*/
+	float expanded[2][4] = { { 0, 0, 0, 255.0f }, { 0, 0, 0, 255.0f } };
+	for (int e = 0; e < 2; e++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			const int full = (pOut->q[e][c] << 1) | pOut->p[e];
+			expanded[e][c] = (float)((full << (7 - bits)) | (full >> (2 * bits - 6)));
+		}
+	}
+	for (int i = 0; i < paletteCount; i++)
+	{
+		const int w = (int)(pWeights[i] * 64.0f + 0.5f);
+		for (int c = 0; c < 4; c++)
+			palette[i][c] = (float)((int)((64 - w) * (int)expanded[0][c] + w * (int)expanded[1][c] + 32) >> 6);
+	}
+}
+
+/*Encode one subset with the given precision, refining the endpoints against the chosen indices*/
+static void _bc7EncodeSubset(const bcBlock* pBlock, int channels, uint16_t mask, int bits, bool sharedPBit, int paletteCount, const float* pWeights,
+	asBlockCompressQuality quality, bc7Subset* pOut)
+{
+	float e0[4], e1[4];
+	_bcFitPrincipalAxis(pBlock, channels, mask, e0, e1);
+	pOut->error = FLT_MAX;
+	for (int iter = 0; iter <= _bcRefineIterations(quality); iter++)
+	{
+		bc7Subset candidate;
+		float palette[16][4];
+		float errors[16];
+		_bc7Quantize(e0, e1, channels, bits, sharedPBit, &candidate, palette, paletteCount, pWeights);
+		_bcSelectIndices(pBlock, channels, (const float(*)[4])palette, paletteCount, candidate.indices, errors);
+		candidate.error = _bcMaskedError(errors, mask);
+		if (candidate.error >= pOut->error)
+			break;
+		*pOut = candidate;
+		if (pOut->error == 0.0f || !_bcRefineEndpoints(pBlock, channels, mask, pOut->indices, pWeights, e0, e1))
+			break;
+	}
+}
+
+/*The anchor index must have its top bit clear, flip the subset if not*/
+static void _bc7FixAnchor(bc7Subset* pSubset, uint16_t mask, int anchor, int indexBits)
+{
+	const int maxIndex = (1 << indexBits) - 1;
+	if (pSubset->indices[anchor] <= maxIndex / 2)
+		return;
+	for (int c = 0; c < 4; c++)
+	{
+		const int tmp = pSubset->q[0][c];
+		pSubset->q[0][c] = pSubset->q[1][c];
+		pSubset->q[1][c] = tmp;
+	}
+	const int tmp = pSubset->p[0];
+	pSubset->p[0] = pSubset->p[1];
+	pSubset->p[1] = tmp;
+	for (int i = 0; i < 16; i++)
+	{
+		if (mask & (1 << i))
+			pSubset->indices[i] = (uint8_t)(maxIndex - pSubset->indices[i]);
+	}
+}
+
+/*Mode 6: one subset, RGBA 7.7.7.7 with unique p-bits, 4 bit indices*/
+static float _bc7EncodeMode6(const bcBlock* pBlock, asBlockCompressQuality quality, uint8_t pOut[16])
+{
+	bc7Subset subset;
+	_bc7EncodeSubset(pBlock, 4, 0xFFFF, 7, false, 16, bc7Weights4, quality, &subset);
+	_bc7FixAnchor(&subset, 0xFFFF, 0, 4);
+
+	bcBitWriter writer = { { 0, 0 }, 0 };
+	_bcWriteBits(&writer, 1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		_bcWriteBits(&writer, subset.q[0][c], 7);
+		_bcWriteBits(&writer, subset.q[1][c], 7);
+	}
+	_bcWriteBits(&writer, subset.p[0], 1);
+	_bcWriteBits(&writer, subset.p[1], 1);
+	for (int i = 0; i < 16; i++)
+		_bcWriteBits(&writer, subset.indices[i], i == 0 ? 3 : 4);
+	_bcWriteBlock(&writer, pOut);
+	return subset.error;
+}
+
+/*Mode 1: two subsets, RGB 6.6.6 with a shared p-bit per subset, 3 bit indices (opaque only)*/
+static float _bc7EncodeMode1(const bcBlock* pBlock, int partition, asBlockCompressQuality quality, uint8_t pOut[16])
+{
+	const uint16_t masks[2] = { (uint16_t)~bc7Partitions2[partition], bc7Partitions2[partition] };
+	const int anchors[2] = { 0, bc7Anchors2[partition] };
+	bc7Subset subsets[2];
+	for (int s = 0; s < 2; s++)
+	{
+		_bc7EncodeSubset(pBlock, 3, masks[s], 6, true, 8, bc7Weights3, quality, &subsets[s]);
+		_bc7FixAnchor(&subsets[s], masks[s], anchors[s], 3);
+	}
+
+	bcBitWriter writer = { { 0, 0 }, 0 };
+	_bcWriteBits(&writer, 1 << 1, 2);
+	_bcWriteBits(&writer, (uint32_t)partition, 6);
+	for (int c = 0; c < 3; c++)
+	{
+		for (int s = 0; s < 2; s++)
+		{
+			_bcWriteBits(&writer, subsets[s].q[0][c], 6);
+			_bcWriteBits(&writer, subsets[s].q[1][c], 6);
+		}
+	}
+	_bcWriteBits(&writer, subsets[0].p[0], 1);
+	_bcWriteBits(&writer, subsets[1].p[0], 1);
+	for (int i = 0; i < 16; i++)
+	{
+		const int s = (masks[1] & (1 << i)) ? 1 : 0;
+		_bcWriteBits(&writer, subsets[s].indices[i], i == anchors[s] ? 2 : 3);
+	}
+	_bcWriteBlock(&writer, pOut);
+	return subsets[0].error + subsets[1].error;
+}
+
+static void _bcEncodeBC7(const bcBlock* pBlock, asBlockCompressQuality quality, uint8_t pOut[16])
+{
+	float bestError = _bc7EncodeMode6(pBlock, quality, pOut);
+	if (quality != AS_BLOCKCOMPRESS_QUALITY_HIGH || bestError == 0.0f)
+		return;
+	for (int i = 0; i < 16; i++)
+	{
+		if (pBlock->c[3][i] < 255.0f)
+			return;
+	}
+
+	/*Rank partitions by how well each subset fits a line, then encode the best few*/
+	#define BC7_PARTITION_CANDIDATES 4
+	int candidates[BC7_PARTITION_CANDIDATES];
+	float candidateErrors[BC7_PARTITION_CANDIDATES];
+	for (int i = 0; i < BC7_PARTITION_CANDIDATES; i++)
+	{
+		candidates[i] = -1;
+		candidateErrors[i] = FLT_MAX;
+	}
+	for (int partition = 0; partition < 64; partition++)
+	{
+		float e0[4], e1[4];
+		float error = _bcFitPrincipalAxis(pBlock, 3, (uint16_t)~bc7Partitions2[partition], e0, e1);
+		error += _bcFitPrincipalAxis(pBlock, 3, bc7Partitions2[partition], e0, e1);
+		for (int i = 0; i < BC7_PARTITION_CANDIDATES; i++)
+		{
+			if (error >= candidateErrors[i])
+				continue;
+			for (int j = BC7_PARTITION_CANDIDATES - 1; j > i; j--)
+			{
+				candidates[j] = candidates[j - 1];
+				candidateErrors[j] = candidateErrors[j - 1];
+			}
+			candidates[i] = partition;
+			candidateErrors[i] = error;
+			break;
+		}
+	}
+	for (int i = 0; i < BC7_PARTITION_CANDIDATES && candidates[i] >= 0; i++)
+	{
+		uint8_t candidate[16];
+		const float error = _bc7EncodeMode1(pBlock, candidates[i], quality, candidate);
+		if (error < bestError)
+		{
+			bestError = error;
+			memcpy(pOut, candidate, 16);
+		}
+	}
+}
+
+/*Interface*/
+
+ASEXPORT bool asBlockCompressIsSupported(asColorFormat format)
+{
+	switch (format)
+	{
+	case AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK:
+	case AS_COLORFORMAT_BC3_UNORM_BLOCK:
+	case AS_COLORFORMAT_BC5_UNORM_BLOCK:
+	case AS_COLORFORMAT_BC7_UNORM_BLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static size_t _bcBlockSize(asColorFormat format)
+{
+	return format == AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK ? 8 : 16;
+}
+
+ASEXPORT size_t asBlockCompressGetSize(asColorFormat format, uint32_t width, uint32_t height)
+{
+	const size_t blocksX = (width + 3) / 4;
+	const size_t blocksY = (height + 3) / 4;
+	return (blocksX ? blocksX : 1) * (blocksY ? blocksY : 1) * _bcBlockSize(format);
+}
+
+static void _bcEncodeBlock(asColorFormat format, asBlockCompressQuality quality, const bcBlock* pBlock, uint8_t* pDst)
+{
+	switch (format)
+	{
+	case AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK:
+		_bcEncodeBC1(pBlock, quality, true, pDst);
+		break;
+	case AS_COLORFORMAT_BC3_UNORM_BLOCK:
+		_bcEncodeBC4(pBlock, 3, quality, pDst);
+		_bcEncodeBC1(pBlock, quality, false, pDst + 8);
+		break;
+	case AS_COLORFORMAT_BC5_UNORM_BLOCK:
+		_bcEncodeBC4(pBlock, 0, quality, pDst);
+		_bcEncodeBC4(pBlock, 1, quality, pDst + 8);
+		break;
+	case AS_COLORFORMAT_BC7_UNORM_BLOCK:
+		_bcEncodeBC7(pBlock, quality, pDst);
+		break;
+	default:
+		break;
+	}
+}
+
+ASEXPORT asResults asBlockCompressBlock(asColorFormat format, asBlockCompressQuality quality, const uint8_t pRGBA[64], void* pDst)
+{
+	if (!asBlockCompressIsSupported(format)) { return AS_FAILURE_UNKNOWN_FORMAT; }
+	bcBlock block;
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+			block.c[c][i] = (float)pRGBA[i * 4 + c];
+	}
+	_bcEncodeBlock(format, quality, &block, (uint8_t*)pDst);
+	return AS_SUCCESS;
+}
+
+struct bcImageJob {
+	asColorFormat format;
+	asBlockCompressQuality quality;
+	const uint8_t* pRGBA;
+	uint32_t width;
+	uint32_t height;
+	uint32_t firstBlockRow;
+	uint32_t blockRowCount;
+	uint8_t* pDst;
+};
+
+static void _bcImageJob(void* pUserData)
+{
+	const struct bcImageJob* pJob = (const struct bcImageJob*)pUserData;
+	const uint32_t blocksX = (pJob->width + 3) / 4;
+	const size_t blockSize = _bcBlockSize(pJob->format);
+	for (uint32_t by = pJob->firstBlockRow; by < pJob->firstBlockRow + pJob->blockRowCount; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			/*Gather with the edges clamped*/
+			bcBlock block;
+			for (uint32_t py = 0; py < 4; py++)
+			{
+				const uint32_t y = by * 4 + py < pJob->height ? by * 4 + py : pJob->height - 1;
+				for (uint32_t px = 0; px < 4; px++)
+				{
+					const uint32_t x = bx * 4 + px < pJob->width ? bx * 4 + px : pJob->width - 1;
+					const uint8_t* pPixel = pJob->pRGBA + ((size_t)y * pJob->width + x) * 4;
+					for (int c = 0; c < 4; c++)
+						block.c[c][py * 4 + px] = (float)pPixel[c];
+				}
+			}
+			_bcEncodeBlock(pJob->format, pJob->quality, &block, pJob->pDst + ((size_t)by * blocksX + bx) * blockSize);
+		}
+	}
+}
+
+ASEXPORT asResults asBlockCompressImage(asColorFormat format, asBlockCompressQuality quality, const uint8_t* pRGBA, uint32_t width, uint32_t height, void* pDst)
+{
+	if (!asBlockCompressIsSupported(format)) { return AS_FAILURE_UNKNOWN_FORMAT; }
+	if (!pRGBA || !pDst || !width || !height) { return AS_FAILURE_INVALID_PARAM; }
+
+	/*A few jobs per worker so uneven rows balance out*/
+	const uint32_t blocksY = (height + 3) / 4;
+	const uint32_t workers = (uint32_t)asJobSystem_GetWorkerCount() + 1;
+	uint32_t rowsPerJob = blocksY / (workers * 4);
+	if (!rowsPerJob) { rowsPerJob = 1; }
+	const uint32_t jobCount = (blocksY + rowsPerJob - 1) / rowsPerJob;
+
+	struct bcImageJob* pJobData = asMalloc(sizeof(struct bcImageJob) * jobCount);
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * jobCount);
+	if (!pJobData || !pJobs)
+	{
+		asFree(pJobData);
+		asFree(pJobs);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < jobCount; i++)
+	{
+		pJobData[i] = (struct bcImageJob){ format, quality, pRGBA, width, height, i * rowsPerJob, rowsPerJob, (uint8_t*)pDst };
+		if (pJobData[i].firstBlockRow + rowsPerJob > blocksY)
+			pJobData[i].blockRowCount = blocksY - pJobData[i].firstBlockRow;
+		pJobs[i].fpEntry = _bcImageJob;
+		pJobs[i].pUserData = &pJobData[i];
+	}
+
+	asJobCounter counter;
+	asResults result = asJobSystem_CreateCounter(&counter);
+	if (result == AS_SUCCESS)
+	{
+		result = asJobSystem_Dispatch(pJobs, jobCount, counter);
+		asJobSystem_WaitForCounter(counter);
+		asJobSystem_ReleaseCounter(counter);
+	}
+	asFree(pJobs);
+	asFree(pJobData);
+	return result;
+}
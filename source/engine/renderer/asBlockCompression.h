@@ -0,0 +1,54 @@
+#ifndef _ASBLOCKCOMPRESSION_H_
+#define _ASBLOCKCOMPRESSION_H_
+
+#include "../common/asCommon.h"
+#include "asRendererCore.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Block compression (BC1, BC3, BC5 and BC7) of 8 bit RGBA images
+* Meant for cooking textures offline, images are split across the job system
+*/
+
+/**
+* @brief Encoder speed/quality tradeoff
+*/
+typedef enum {
+	AS_BLOCKCOMPRESS_QUALITY_FAST, /**< Endpoints from the principal axis only*/
+	AS_BLOCKCOMPRESS_QUALITY_NORMAL, /**< Endpoints refined against the chosen indices*/
+	AS_BLOCKCOMPRESS_QUALITY_HIGH, /**< More refinement and BC7 partitioned blocks (slow)*/
+	AS_BLOCKCOMPRESS_QUALITY_COUNT
+} asBlockCompressQuality;
+
+/**
+* @brief Check if a format can be produced by the encoder
+*/
+ASEXPORT bool asBlockCompressIsSupported(asColorFormat format);
+
+/**
+* @brief Size of an image once compressed (each block is 4x4 pixels)
+*/
+ASEXPORT size_t asBlockCompressGetSize(asColorFormat format, uint32_t width, uint32_t height);
+
+/**
+* @brief Compress a single 4x4 block
+* @param pRGBA 16 pixels of 8 bit RGBA in rows
+* @param pDst 8 bytes for BC1 and 16 for the rest
+*/
+ASEXPORT asResults asBlockCompressBlock(asColorFormat format, asBlockCompressQuality quality, const uint8_t pRGBA[64], void* pDst);
+
+/**
+* @brief Compress an image (edges are padded by repeating the last row/column)
+* @param pRGBA 8 bit RGBA pixels with rows packed together
+* @param pDst asBlockCompressGetSize() bytes
+* @note blocks are encoded on the job system, jobs run inline if it is not running
+*/
+ASEXPORT asResults asBlockCompressImage(asColorFormat format, asBlockCompressQuality quality, const uint8_t* pRGBA, uint32_t width, uint32_t height, void* pDst);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,896 @@
+#include "asClusterCulling.h"
+
+#include "asMipGeneration.h"
+#include "../resource/asResource.h"
+
+#if ASTRENGINE_VK
+#include "../renderer/vulkan/asVulkanBackend.h"
+#include <SDL_vulkan.h>
+#endif
+
+#define AS_CLUSTER_MAX_PYRAMID_MIPS 16
+
+/*Matches ClusterCulling.glsl*/
+struct clusterCullJob {
+	uint32_t firstMeshlet;
+	uint32_t meshletCount;
+	uint32_t instanceCount;
+	uint32_t firstDraw;
+	uint32_t transformOffset;
+	uint32_t transformOffsetPreviousFrame;
+	uint32_t flags;
+	uint32_t _pad;
+};
+
+#define CLUSTER_CULL_FLAG_COMPACT 1 /*Draws are appended and counted*/
+#define CLUSTER_CULL_FLAG_OCCLUSION 2 /*Depth pyramid of last frame is valid*/
+#define CLUSTER_CULL_FLAG_PERSPECTIVE 4 /*Cone and occlusion tests are valid*/
+
+struct clusterCullUbo {
+	mat4 viewProj;
+	mat4 view;
+	mat4 prevView;
+	vec4 frustumPlanes[5]; /*Left, right, bottom, top, near (infinite far)*/
+	vec4 viewPosition;
+	float P00;
+	float P11;
+	float znear;
+	uint32_t flags;
+	float pyramidWidth;
+	float pyramidHeight;
+	uint32_t pyramidMips;
+	uint32_t _pad;
+};
+
+struct clusterHizPushConstants {
+	int32_t srcSize[2];
+	int32_t dstSize[2];
+};
+
+struct clusterCullPushConstants {
+	uint32_t firstJob;
+};
+
+/*Shaders*/
+asResourceFileID_t clusterCullShaderFileID;
+asShaderFx* pClusterCullShader;
+bool clusterCullingAvailable = false;
+
+#if ASTRENGINE_VK /*Vulkan Globals*/
+VkDescriptorSetLayout vClusterFrameDescLayout;
+VkDescriptorSetLayout vClusterGeometryDescLayout;
+VkDescriptorSetLayout vClusterHizDescLayout;
+VkDescriptorPool vClusterDescriptorPool;
+VkPipelineLayout vClusterCullPipelineLayout;
+VkPipelineLayout vClusterHizPipelineLayout;
+
+/*Depth Pyramid*/
+asTextureHandle_t clusterPyramidTexture;
+VkImageView vClusterPyramidMipViews[AS_CLUSTER_MAX_PYRAMID_MIPS];
+VkDescriptorSet vClusterHizDescSets[AS_CLUSTER_MAX_PYRAMID_MIPS];
+uint32_t clusterPyramidWidth;
+uint32_t clusterPyramidHeight;
+uint32_t clusterPyramidMips;
+bool clusterPyramidInitialized; /*Moved to VK_IMAGE_LAYOUT_GENERAL*/
+bool clusterPyramidBuilt; /*Holds the depth of a frame*/
+#endif
+
+/*Batches queued to be culled this frame*/
+asClusterCullBatch clusterPendingBatches[AS_CLUSTER_MAX_BATCHES];
+uint32_t clusterPendingBatchCount = 0;
+
+/*Geometry*/
+struct asClusterGeometryT {
+	asBufferHandle_t meshletBuffer;
+	asBufferHandle_t meshletVertexBuffer;
+	asBufferHandle_t meshletTriangleBuffer;
+	asBufferHandle_t vertexBuffer;
+	asBufferHandle_t indexBuffer;
+	bool uint32Indices;
+	bool octahedralNormals;
+	uint32_t meshletCount;
+#if ASTRENGINE_VK
+	VkDescriptorSet vDescSet;
+#endif
+};
+
+static asBufferHandle_t _clusterCreateDeviceBuffer(const void* pData, size_t size, int32_t usageFlags, const char* pDebugLabel)
+{
+	asBufferDesc_t desc = asBufferDesc_Init();
+	desc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	desc.usageFlags = usageFlags;
+	desc.bufferSize = (uint32_t)((size + 3) & ~(size_t)3); /*Read as 32 bit words*/
+	desc.initialContentsBufferSize = size;
+	desc.pInitialContentsBuffer = (void*)pData;
+	desc.pDebugLabel = pDebugLabel;
+	return asCreateBuffer(&desc);
+}
+
+ASEXPORT asResults asClusterGeometryCreate(asClusterGeometry* pGeometry, const asModel_t* pModel, const char* pDebugLabel)
+{
+	if (!pGeometry || !pModel || !pModel->relocated) { return AS_FAILURE_INVALID_PARAM; }
+	if (!pModel->meshletCount || !pModel->meshletVertexCount || !pModel->meshletTriangleSize) { return AS_FAILURE_INVALID_PARAM; }
+	asClusterGeometry geometry = asMalloc(sizeof(struct asClusterGeometryT));
+	ASASSERT(geometry);
+	memset(geometry, 0, sizeof(struct asClusterGeometryT));
+	const char* pLabel = pDebugLabel ? pDebugLabel : "ClusterGeometry";
+
+	/*Buffers*/
+	geometry->meshletCount = pModel->meshletCount;
+	geometry->uint32Indices = pModel->indexSize == 4;
+	geometry->octahedralNormals = (pModel->flags & AS_MODEL_FLAG_OCTAHEDRAL_NORMALS) != 0;
+	geometry->meshletBuffer = _clusterCreateDeviceBuffer(pModel->meshlets.ptr,
+		pModel->meshletCount * sizeof(asModelMeshlet_t), AS_BUFFERUSAGE_STORAGE, pLabel);
+	geometry->meshletVertexBuffer = _clusterCreateDeviceBuffer(pModel->meshletVertices.ptr,
+		pModel->meshletVertexCount * sizeof(uint32_t), AS_BUFFERUSAGE_STORAGE, pLabel);
+	geometry->meshletTriangleBuffer = _clusterCreateDeviceBuffer(pModel->meshletTriangles.ptr,
+		pModel->meshletTriangleSize, AS_BUFFERUSAGE_STORAGE, pLabel);
+	geometry->vertexBuffer = _clusterCreateDeviceBuffer(pModel->vertices.ptr,
+		pModel->vertexCount * sizeof(asVertexGeneric), AS_BUFFERUSAGE_VERTEX | AS_BUFFERUSAGE_STORAGE, pLabel);
+	geometry->indexBuffer = _clusterCreateDeviceBuffer(pModel->indices.ptr,
+		(size_t)pModel->indexCount * pModel->indexSize, AS_BUFFERUSAGE_INDEX, pLabel);
+
+#if ASTRENGINE_VK
+	/*Descriptor Set*/
+	VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	descSetAllocInfo.descriptorPool = vClusterDescriptorPool;
+	descSetAllocInfo.descriptorSetCount = 1;
+	descSetAllocInfo.pSetLayouts = &vClusterGeometryDescLayout;
+	AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, &geometry->vDescSet),
+		"vkAllocateDescriptorSets() Failed to allocate geometry->vDescSet");
+
+	const asBufferHandle_t buffers[] = {
+		geometry->meshletBuffer, geometry->meshletVertexBuffer, geometry->meshletTriangleBuffer, geometry->vertexBuffer
+	};
+	VkDescriptorBufferInfo bufferInfos[ASARRAYLEN(buffers)];
+	VkWriteDescriptorSet descSetWrites[ASARRAYLEN(buffers)];
+	for (uint32_t i = 0; i < ASARRAYLEN(buffers); i++)
+	{
+		bufferInfos[i] = (VkDescriptorBufferInfo){ asVkGetBufferFromBuffer(buffers[i]), 0, VK_WHOLE_SIZE };
+		descSetWrites[i] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descSetWrites[i].dstSet = geometry->vDescSet;
+		descSetWrites[i].dstBinding = i;
+		descSetWrites[i].descriptorCount = 1;
+		descSetWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descSetWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+	vkUpdateDescriptorSets(asVkDevice, ASARRAYLEN(descSetWrites), descSetWrites, 0, NULL);
+#endif
+
+	*pGeometry = geometry;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asClusterGeometryDestroy(asClusterGeometry geometry)
+{
+	if (!geometry) { return; }
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+	vkFreeDescriptorSets(asVkDevice, vClusterDescriptorPool, 1, &geometry->vDescSet);
+#endif
+	asReleaseBuffer(geometry->meshletBuffer);
+	asReleaseBuffer(geometry->meshletVertexBuffer);
+	asReleaseBuffer(geometry->meshletTriangleBuffer);
+	asReleaseBuffer(geometry->vertexBuffer);
+	asReleaseBuffer(geometry->indexBuffer);
+	asFree(geometry);
+}
+
+ASEXPORT asBufferHandle_t asClusterGeometryGetVertexBuffer(asClusterGeometry geometry)
+{
+	return geometry->vertexBuffer;
+}
+
+ASEXPORT asBufferHandle_t asClusterGeometryGetIndexBuffer(asClusterGeometry geometry, bool* pUint32Indices)
+{
+	if (pUint32Indices) { *pUint32Indices = geometry->uint32Indices; }
+	return geometry->indexBuffer;
+}
+
+/*Batches*/
+struct asClusterCullBatchT {
+	uint32_t maxJobs;
+	uint32_t maxDraws;
+	uint32_t jobCount;
+	uint32_t drawCount;
+	struct clusterCullJob* pJobs;
+	asClusterGeometry* pJobGeometries;
+
+	asBufferHandle_t uboBuffs[AS_MAX_INFLIGHT];
+	asBufferHandle_t jobBuffs[AS_MAX_INFLIGHT];
+	asBufferHandle_t drawBuffs[AS_MAX_INFLIGHT];
+	asBufferHandle_t countBuffs[AS_MAX_INFLIGHT];
+	void* _uboMappings[AS_MAX_INFLIGHT];
+	void* _jobMappings[AS_MAX_INFLIGHT];
+
+	mat4 prevView; /*View the depth pyramid was drawn with*/
+	bool prevViewValid;
+	int32_t currentFrame;
+
+#if ASTRENGINE_VK
+	VkDescriptorSet vDescSets[AS_MAX_INFLIGHT];
+#endif
+};
+
+ASEXPORT bool asClusterCullingAvailable()
+{
+	return clusterCullingAvailable;
+}
+
+ASEXPORT bool asClusterCullingUseMeshShaders(const asShaderFx* pShaderFx)
+{
+#if ASTRENGINE_VK
+	return clusterCullingAvailable && asVkMeshShaderSupported &&
+		pShaderFx && pShaderFx->registration->pipelineCount > 1 && pShaderFx->pipelines[1];
+#else
+	return false;
+#endif
+}
+
+ASEXPORT asResults asClusterCullBatchCreate(asClusterCullBatch* pBatch, uint32_t maxJobs, uint32_t maxDraws)
+{
+	if (!maxJobs || !maxDraws) { return AS_FAILURE_INVALID_PARAM; }
+	asClusterCullBatch batch = asMalloc(sizeof(struct asClusterCullBatchT));
+	ASASSERT(batch);
+	memset(batch, 0, sizeof(struct asClusterCullBatchT));
+	batch->maxJobs = maxJobs;
+	batch->maxDraws = maxDraws;
+	batch->pJobs = asMalloc(maxJobs * sizeof(struct clusterCullJob));
+	ASASSERT(batch->pJobs);
+	batch->pJobGeometries = asMalloc(maxJobs * sizeof(asClusterGeometry));
+	ASASSERT(batch->pJobGeometries);
+
+	asBufferDesc_t uboDesc = asBufferDesc_Init();
+	uboDesc.bufferSize = sizeof(struct clusterCullUbo);
+	uboDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
+	uboDesc.usageFlags = AS_BUFFERUSAGE_UNIFORM;
+	uboDesc.pDebugLabel = "ClusterCullUbo";
+	asBufferDesc_t jobDesc = asBufferDesc_Init();
+	jobDesc.bufferSize = maxJobs * sizeof(struct clusterCullJob);
+	jobDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
+	jobDesc.usageFlags = AS_BUFFERUSAGE_STORAGE;
+	jobDesc.pDebugLabel = "ClusterCullJobs";
+	asBufferDesc_t drawDesc = asBufferDesc_Init();
+	drawDesc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	drawDesc.usageFlags = AS_BUFFERUSAGE_STORAGE | AS_BUFFERUSAGE_INDIRECT;
+	drawDesc.pDebugLabel = "ClusterCullDraws";
+	asBufferDesc_t countDesc = asBufferDesc_Init();
+	countDesc.bufferSize = maxJobs * sizeof(uint32_t);
+	countDesc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	countDesc.usageFlags = AS_BUFFERUSAGE_STORAGE | AS_BUFFERUSAGE_INDIRECT | AS_BUFFERUSAGE_TRANSFER_DST;
+	countDesc.pDebugLabel = "ClusterCullCounts";
+#if ASTRENGINE_VK
+	drawDesc.bufferSize = maxDraws * sizeof(VkDrawIndexedIndirectCommand);
+#endif
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		batch->uboBuffs[i] = asCreateBuffer(&uboDesc);
+		batch->jobBuffs[i] = asCreateBuffer(&jobDesc);
+		batch->drawBuffs[i] = asCreateBuffer(&drawDesc);
+		batch->countBuffs[i] = asCreateBuffer(&countDesc);
+#if ASTRENGINE_VK
+		asVkAllocation_t uboAlloc = asVkGetAllocFromBuffer(batch->uboBuffs[i]);
+		asVkMapMemory(uboAlloc, 0, uboAlloc.size, &batch->_uboMappings[i]);
+		asVkAllocation_t jobAlloc = asVkGetAllocFromBuffer(batch->jobBuffs[i]);
+		asVkMapMemory(jobAlloc, 0, jobAlloc.size, &batch->_jobMappings[i]);
+#endif
+	}
+
+#if ASTRENGINE_VK
+	/*Descriptor Sets (written once the transforms are known)*/
+	VkDescriptorSetLayout layouts[AS_MAX_INFLIGHT];
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++) { layouts[i] = vClusterFrameDescLayout; }
+	VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	descSetAllocInfo.descriptorPool = vClusterDescriptorPool;
+	descSetAllocInfo.descriptorSetCount = AS_MAX_INFLIGHT;
+	descSetAllocInfo.pSetLayouts = layouts;
+	AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, batch->vDescSets),
+		"vkAllocateDescriptorSets() Failed to allocate batch->vDescSets");
+#endif
+
+	*pBatch = batch;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asClusterCullBatchDestroy(asClusterCullBatch batch)
+{
+	if (!batch) { return; }
+	for (uint32_t i = 0; i < clusterPendingBatchCount; i++)
+	{
+		if (clusterPendingBatches[i] == batch)
+		{
+			clusterPendingBatches[i] = clusterPendingBatches[--clusterPendingBatchCount];
+			break;
+		}
+	}
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+	vkFreeDescriptorSets(asVkDevice, vClusterDescriptorPool, AS_MAX_INFLIGHT, batch->vDescSets);
+#endif
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+#if ASTRENGINE_VK
+		asVkUnmapMemory(asVkGetAllocFromBuffer(batch->uboBuffs[i]));
+		asVkUnmapMemory(asVkGetAllocFromBuffer(batch->jobBuffs[i]));
+#endif
+		asReleaseBuffer(batch->uboBuffs[i]);
+		asReleaseBuffer(batch->jobBuffs[i]);
+		asReleaseBuffer(batch->drawBuffs[i]);
+		asReleaseBuffer(batch->countBuffs[i]);
+	}
+	asFree(batch->pJobs);
+	asFree(batch->pJobGeometries);
+	asFree(batch);
+}
+
+ASEXPORT asResults asClusterCullBatchBegin(asClusterCullBatch batch)
+{
+	batch->jobCount = 0;
+	batch->drawCount = 0;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asClusterCullBatchAddJob(asClusterCullBatch batch, const asClusterJobDesc* pJob, uint32_t* pJobIdx)
+{
+	if (!pJob->geometry || !pJob->meshletCount || !pJob->instanceCount) { return AS_FAILURE_INVALID_PARAM; }
+	if (pJob->firstMeshlet + pJob->meshletCount > pJob->geometry->meshletCount) { return AS_FAILURE_INVALID_PARAM; }
+	const uint64_t drawCount = (uint64_t)pJob->meshletCount * pJob->instanceCount;
+	if (batch->jobCount >= batch->maxJobs || batch->drawCount + drawCount > batch->maxDraws) { return AS_FAILURE_OUT_OF_BOUNDS; }
+
+	struct clusterCullJob* pDst = &batch->pJobs[batch->jobCount];
+	pDst->firstMeshlet = pJob->firstMeshlet;
+	pDst->meshletCount = pJob->meshletCount;
+	pDst->instanceCount = pJob->instanceCount;
+	pDst->firstDraw = batch->drawCount;
+	pDst->transformOffset = pJob->transformOffset;
+	pDst->transformOffsetPreviousFrame = pJob->transformOffsetPreviousFrame;
+	pDst->flags = pJob->flags & ~AS_CLUSTER_JOB_OCTAHEDRAL_NORMALS;
+	if (pJob->geometry->octahedralNormals) { pDst->flags |= AS_CLUSTER_JOB_OCTAHEDRAL_NORMALS; }
+	pDst->_pad = 0;
+	batch->pJobGeometries[batch->jobCount] = pJob->geometry;
+	if (pJobIdx) { *pJobIdx = batch->jobCount; }
+	batch->jobCount++;
+	batch->drawCount += (uint32_t)drawCount;
+	return AS_SUCCESS;
+}
+
+/*Normalized plane from the sum of two rows of a matrix (Gribb and Hartmann)*/
+static void _clusterPlaneFromRows(mat4 m, int rowA, int rowB, float sign, vec4 dest)
+{
+	for (int i = 0; i < 4; i++) { dest[i] = m[i][rowA] + (m[i][rowB] * sign); }
+	const float length = glm_vec3_norm(dest);
+	if (length > 0.0f) { glm_vec4_scale(dest, 1.0f / length, dest); }
+}
+
+ASEXPORT asResults asClusterCullBatchEnd(asClusterCullBatch batch, const asClusterViewDesc* pView)
+{
+#if ASTRENGINE_VK
+	/*The frame in flight may still be reading the buffers and descriptors*/
+	vkWaitForFences(asVkDevice, 1, &asVkInFlightFences[asVkCurrentFrame], VK_TRUE, UINT64_MAX);
+	batch->currentFrame = asVkCurrentFrame;
+#endif
+	const int32_t frame = batch->currentFrame;
+
+	/*Jobs*/
+	memcpy(batch->_jobMappings[frame], batch->pJobs, batch->jobCount * sizeof(struct clusterCullJob));
+
+	/*View*/
+	struct clusterCullUbo* pUbo = batch->_uboMappings[frame];
+	memset(pUbo, 0, sizeof(struct clusterCullUbo));
+	glm_mat4_mul((vec4*)pView->projMatrix, (vec4*)pView->viewMatrix, pUbo->viewProj);
+	glm_mat4_copy((vec4*)pView->viewMatrix, pUbo->view);
+	glm_mat4_copy(batch->prevViewValid ? batch->prevView : (vec4*)pView->viewMatrix, pUbo->prevView);
+	_clusterPlaneFromRows(pUbo->viewProj, 3, 0, 1.0f, pUbo->frustumPlanes[0]);
+	_clusterPlaneFromRows(pUbo->viewProj, 3, 0, -1.0f, pUbo->frustumPlanes[1]);
+	_clusterPlaneFromRows(pUbo->viewProj, 3, 1, 1.0f, pUbo->frustumPlanes[2]);
+	_clusterPlaneFromRows(pUbo->viewProj, 3, 1, -1.0f, pUbo->frustumPlanes[3]);
+	_clusterPlaneFromRows(pUbo->viewProj, 3, 2, -1.0f, pUbo->frustumPlanes[4]); /*Reversed depth*/
+	glm_vec3_copy((float*)pView->viewPosition, pUbo->viewPosition);
+	pUbo->P00 = pView->projMatrix[0][0];
+	pUbo->P11 = fabsf(pView->projMatrix[1][1]); /*Sign only flips the NDC of Vulkan*/
+	pUbo->znear = pView->projMatrix[3][2];
+	const bool perspective = pView->projMatrix[3][3] == 0.0f;
+	if (perspective) { pUbo->flags |= CLUSTER_CULL_FLAG_PERSPECTIVE; }
+#if ASTRENGINE_VK
+	if (asVkDrawIndirectCountSupported) { pUbo->flags |= CLUSTER_CULL_FLAG_COMPACT; }
+	if (perspective && pView->depthPyramidView && clusterPyramidBuilt && batch->prevViewValid) { pUbo->flags |= CLUSTER_CULL_FLAG_OCCLUSION; }
+	pUbo->pyramidWidth = (float)clusterPyramidWidth;
+	pUbo->pyramidHeight = (float)clusterPyramidHeight;
+	pUbo->pyramidMips = clusterPyramidMips;
+#endif
+	glm_mat4_copy((vec4*)pView->viewMatrix, batch->prevView);
+	batch->prevViewValid = true;
+
+#if ASTRENGINE_VK
+	asVkFlushMemory(asVkGetAllocFromBuffer(batch->jobBuffs[frame]));
+	asVkFlushMemory(asVkGetAllocFromBuffer(batch->uboBuffs[frame]));
+
+	/*Descriptors*/
+	const VkDescriptorBufferInfo bufferInfos[] = {
+		{ asVkGetBufferFromBuffer(batch->uboBuffs[frame]), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(batch->jobBuffs[frame]), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(pView->transformBuffer), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(batch->drawBuffs[frame]), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(batch->countBuffs[frame]), 0, VK_WHOLE_SIZE },
+	};
+	VkWriteDescriptorSet descSetWrites[ASARRAYLEN(bufferInfos) + 1];
+	for (uint32_t i = 0; i < ASARRAYLEN(bufferInfos); i++)
+	{
+		descSetWrites[i] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descSetWrites[i].dstSet = batch->vDescSets[frame];
+		descSetWrites[i].dstBinding = i;
+		descSetWrites[i].descriptorCount = 1;
+		descSetWrites[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descSetWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+	const VkDescriptorImageInfo pyramidInfo = {
+		*asVkGetSimpleSamplerPtr(false), asVkGetViewFromTexture(clusterPyramidTexture), VK_IMAGE_LAYOUT_GENERAL
+	};
+	descSetWrites[ASARRAYLEN(bufferInfos)] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+	descSetWrites[ASARRAYLEN(bufferInfos)].dstSet = batch->vDescSets[frame];
+	descSetWrites[ASARRAYLEN(bufferInfos)].dstBinding = ASARRAYLEN(bufferInfos);
+	descSetWrites[ASARRAYLEN(bufferInfos)].descriptorCount = 1;
+	descSetWrites[ASARRAYLEN(bufferInfos)].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descSetWrites[ASARRAYLEN(bufferInfos)].pImageInfo = &pyramidInfo;
+	vkUpdateDescriptorSets(asVkDevice, ASARRAYLEN(descSetWrites), descSetWrites, 0, NULL);
+#endif
+
+	/*Queue for Culling*/
+	for (uint32_t i = 0; i < clusterPendingBatchCount; i++)
+	{
+		if (clusterPendingBatches[i] == batch) { return AS_SUCCESS; }
+	}
+	if (clusterPendingBatchCount >= AS_CLUSTER_MAX_BATCHES) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	clusterPendingBatches[clusterPendingBatchCount++] = batch;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asClusterCullBatchDrawCmd(asClusterCullBatch batch, uint32_t jobIdx, bool meshShaders, asGfxAPIs api, void* pCmdBuff, void* pLayout)
+{
+	ASASSERT(jobIdx < batch->jobCount);
+#if ASTRENGINE_VK
+	ASASSERT(api == AS_GFXAPI_VULKAN);
+	VkCommandBuffer vCmd = *(VkCommandBuffer*)pCmdBuff;
+	VkPipelineLayout pipelineLayout = *(VkPipelineLayout*)pLayout;
+	const struct clusterCullJob job = batch->pJobs[jobIdx];
+	const asClusterGeometry geometry = batch->pJobGeometries[jobIdx];
+	const int32_t frame = batch->currentFrame;
+
+	/*Bind Descriptor Sets*/
+	const VkDescriptorSet descSets[] = { batch->vDescSets[frame], geometry->vDescSet };
+	vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+		pipelineLayout, AS_DESCSET_CLUSTER_FRAME, ASARRAYLEN(descSets), descSets, 0, NULL);
+
+	/*Task shaders cull their own meshlets*/
+#ifdef VK_EXT_mesh_shader
+	if (meshShaders && asVkMeshShaderSupported)
+	{
+		const uint32_t groupCount = (job.meshletCount + AS_CLUSTER_TASK_GROUP_SIZE - 1) / AS_CLUSTER_TASK_GROUP_SIZE;
+		asVkCmdDrawMeshTasks(vCmd, groupCount, job.instanceCount, 1);
+		return;
+	}
+#endif
+
+	/*Bind Geometry*/
+	VkBuffer vBuff = asVkGetBufferFromBuffer(geometry->vertexBuffer);
+	VkDeviceSize vOffset = 0;
+	vkCmdBindVertexBuffers(vCmd, 0, 1, &vBuff, &vOffset);
+	vkCmdBindIndexBuffer(vCmd, asVkGetBufferFromBuffer(geometry->indexBuffer), 0,
+		geometry->uint32Indices ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16);
+
+	/*Indirect Draws*/
+	VkBuffer drawBuff = asVkGetBufferFromBuffer(batch->drawBuffs[frame]);
+	const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+	const uint32_t maxDrawCount = job.meshletCount * job.instanceCount;
+	const VkDeviceSize drawOffset = (VkDeviceSize)job.firstDraw * stride;
+	if (asVkDrawIndirectCountSupported)
+	{
+		asVkCmdDrawIndexedIndirectCount(vCmd, drawBuff, drawOffset,
+			asVkGetBufferFromBuffer(batch->countBuffs[frame]), (VkDeviceSize)jobIdx * sizeof(uint32_t), maxDrawCount, stride);
+	}
+	else if (asVkDeviceFeatures.multiDrawIndirect)
+	{
+		vkCmdDrawIndexedIndirect(vCmd, drawBuff, drawOffset, maxDrawCount, stride);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < maxDrawCount; i++)
+		{
+			vkCmdDrawIndexedIndirect(vCmd, drawBuff, drawOffset + (VkDeviceSize)i * stride, 1, stride);
+		}
+	}
+#endif
+}
+
+#if ASTRENGINE_VK
+static void _clusterPyramidInitLayout(VkCommandBuffer vCmd)
+{
+	if (clusterPyramidInitialized) { return; }
+	VkImageMemoryBarrier toGeneral = (VkImageMemoryBarrier){ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	toGeneral.srcAccessMask = 0;
+	toGeneral.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	toGeneral.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	toGeneral.image = asVkGetImageFromTexture(clusterPyramidTexture);
+	toGeneral.subresourceRange = (VkImageSubresourceRange){ VK_IMAGE_ASPECT_COLOR_BIT, 0, clusterPyramidMips, 0, 1 };
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, &toGeneral);
+	clusterPyramidInitialized = true;
+}
+#endif
+
+ASEXPORT asResults asClusterCullingRecordCmds(asGfxAPIs api, void* pCmdBuff)
+{
+	if (!clusterCullingAvailable || !clusterPendingBatchCount) {
+		clusterPendingBatchCount = 0;
+		return AS_SUCCESS;
+	}
+#if ASTRENGINE_VK
+	ASASSERT(api == AS_GFXAPI_VULKAN);
+	VkCommandBuffer vCmd = *(VkCommandBuffer*)pCmdBuff;
+	_clusterPyramidInitLayout(vCmd);
+
+	/*Reset Counts*/
+	for (uint32_t b = 0; b < clusterPendingBatchCount; b++)
+	{
+		const asClusterCullBatch batch = clusterPendingBatches[b];
+		vkCmdFillBuffer(vCmd, asVkGetBufferFromBuffer(batch->countBuffs[batch->currentFrame]), 0, VK_WHOLE_SIZE, 0);
+	}
+	VkMemoryBarrier toCompute = (VkMemoryBarrier){ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	toCompute.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	toCompute.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &toCompute, 0, NULL, 0, NULL);
+
+	/*Cull (a dispatch for each run of jobs sharing geometry)*/
+	vkCmdBindPipeline(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE, (VkPipeline)pClusterCullShader->pipelines[1]);
+	const uint32_t maxJobsPerDispatch = asVkDeviceProperties.limits.maxComputeWorkGroupCount[1];
+	const uint32_t maxGroupsPerJob = asVkDeviceProperties.limits.maxComputeWorkGroupCount[0]; /*The shader strides over the rest*/
+	for (uint32_t b = 0; b < clusterPendingBatchCount; b++)
+	{
+		const asClusterCullBatch batch = clusterPendingBatches[b];
+		vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+			vClusterCullPipelineLayout, 0, 1, &batch->vDescSets[batch->currentFrame], 0, NULL);
+		uint32_t runStart = 0;
+		while (runStart < batch->jobCount)
+		{
+			const asClusterGeometry geometry = batch->pJobGeometries[runStart];
+			uint32_t runEnd = runStart;
+			uint32_t groupCount = 0;
+			while (runEnd < batch->jobCount && runEnd - runStart < maxJobsPerDispatch && batch->pJobGeometries[runEnd] == geometry)
+			{
+				const uint32_t drawCount = batch->pJobs[runEnd].meshletCount * batch->pJobs[runEnd].instanceCount;
+				const uint32_t jobGroupCount = (drawCount + AS_CLUSTER_CULL_GROUP_SIZE - 1) / AS_CLUSTER_CULL_GROUP_SIZE;
+				if (jobGroupCount > groupCount) { groupCount = jobGroupCount; }
+				runEnd++;
+			}
+			if (groupCount > maxGroupsPerJob) { groupCount = maxGroupsPerJob; }
+			struct clusterCullPushConstants pushConstants = { runStart };
+			vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+				vClusterCullPipelineLayout, 1, 1, &geometry->vDescSet, 0, NULL);
+			vkCmdPushConstants(vCmd, vClusterCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			vkCmdDispatch(vCmd, groupCount, runEnd - runStart, 1);
+			runStart = runEnd;
+		}
+	}
+
+	/*Draws are read by the render pass*/
+	VkMemoryBarrier toDraw = (VkMemoryBarrier){ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	toDraw.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	toDraw.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+		0, 1, &toDraw, 0, NULL, 0, NULL);
+#endif
+	clusterPendingBatchCount = 0;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asClusterCullingBuildDepthPyramidCmds(asGfxAPIs api, void* pCmdBuff)
+{
+	if (!clusterCullingAvailable) { return AS_SUCCESS; }
+#if ASTRENGINE_VK
+	ASASSERT(api == AS_GFXAPI_VULKAN);
+	VkCommandBuffer vCmd = *(VkCommandBuffer*)pCmdBuff;
+	asVkScreenResources* pScreen = asVkGetScreenResourcesPtr(0);
+	_clusterPyramidInitLayout(vCmd);
+
+	/*Depth to Shader Read*/
+	VkImageMemoryBarrier depthBarrier = (VkImageMemoryBarrier){ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	depthBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.image = asVkGetImageFromTexture(pScreen->depthTexture);
+	depthBarrier.subresourceRange = (VkImageSubresourceRange){ VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+	VkMemoryBarrier pyramidBarrier = (VkMemoryBarrier){ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	pyramidBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	pyramidBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &pyramidBarrier, 0, NULL, 1, &depthBarrier);
+
+	/*Reduce each level from the last (the first from the depth buffer)*/
+	vkCmdBindPipeline(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE, (VkPipeline)pClusterCullShader->pipelines[0]);
+	int32_t srcSize[2] = { (int32_t)pScreen->extents.width, (int32_t)pScreen->extents.height };
+	for (uint32_t i = 0; i < clusterPyramidMips; i++)
+	{
+		struct clusterHizPushConstants pushConstants;
+		pushConstants.srcSize[0] = srcSize[0];
+		pushConstants.srcSize[1] = srcSize[1];
+		pushConstants.dstSize[0] = (int32_t)(clusterPyramidWidth >> i ? clusterPyramidWidth >> i : 1);
+		pushConstants.dstSize[1] = (int32_t)(clusterPyramidHeight >> i ? clusterPyramidHeight >> i : 1);
+		vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+			vClusterHizPipelineLayout, 0, 1, &vClusterHizDescSets[i], 0, NULL);
+		vkCmdPushConstants(vCmd, vClusterHizPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+		vkCmdDispatch(vCmd, (pushConstants.dstSize[0] + 7) / 8, (pushConstants.dstSize[1] + 7) / 8, 1);
+
+		VkMemoryBarrier levelBarrier = (VkMemoryBarrier){ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &levelBarrier, 0, NULL, 0, NULL);
+		srcSize[0] = pushConstants.dstSize[0];
+		srcSize[1] = pushConstants.dstSize[1];
+	}
+
+	/*Depth back to an Attachment*/
+	depthBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	depthBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+		0, 0, NULL, 0, NULL, 1, &depthBarrier);
+	clusterPyramidBuilt = true;
+#endif
+	return AS_SUCCESS;
+}
+
+#if ASTRENGINE_VK
+/*Depth pyramid at the power of two below the screen (so every level halves exactly)*/
+static void _clusterCreatePyramid()
+{
+	asVkScreenResources* pScreen = asVkGetScreenResourcesPtr(0);
+	clusterPyramidWidth = 1;
+	clusterPyramidHeight = 1;
+	while (clusterPyramidWidth * 2 <= pScreen->extents.width) { clusterPyramidWidth *= 2; }
+	while (clusterPyramidHeight * 2 <= pScreen->extents.height) { clusterPyramidHeight *= 2; }
+	clusterPyramidMips = asMipGen_GetMipCount(clusterPyramidWidth, clusterPyramidHeight, AS_CLUSTER_MAX_PYRAMID_MIPS);
+	clusterPyramidInitialized = false;
+	clusterPyramidBuilt = false;
+
+	asTextureDesc_t desc = asTextureDesc_Init();
+	desc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	desc.format = AS_COLORFORMAT_R32_SFLOAT;
+	desc.usageFlags = AS_TEXTUREUSAGE_SAMPLED | AS_TEXTUREUSAGE_STORAGE;
+	desc.width = clusterPyramidWidth;
+	desc.height = clusterPyramidHeight;
+	desc.mips = clusterPyramidMips;
+	desc.pDebugLabel = "DepthPyramid";
+	clusterPyramidTexture = asCreateTexture(&desc);
+
+	/*A view and descriptor set for each level*/
+	VkDescriptorSetLayout layouts[AS_CLUSTER_MAX_PYRAMID_MIPS];
+	for (uint32_t i = 0; i < clusterPyramidMips; i++) { layouts[i] = vClusterHizDescLayout; }
+	VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	descSetAllocInfo.descriptorPool = vClusterDescriptorPool;
+	descSetAllocInfo.descriptorSetCount = clusterPyramidMips;
+	descSetAllocInfo.pSetLayouts = layouts;
+	AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, vClusterHizDescSets),
+		"vkAllocateDescriptorSets() Failed to allocate vClusterHizDescSets");
+	for (uint32_t i = 0; i < clusterPyramidMips; i++)
+	{
+		VkImageViewCreateInfo createInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		createInfo.image = asVkGetImageFromTexture(clusterPyramidTexture);
+		createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		createInfo.format = VK_FORMAT_R32_SFLOAT;
+		createInfo.subresourceRange = (VkImageSubresourceRange){ VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, 1 };
+		AS_VK_CHECK(vkCreateImageView(asVkDevice, &createInfo, AS_VK_MEMCB, &vClusterPyramidMipViews[i]),
+			"vkCreateImageView() Failed to create vClusterPyramidMipViews[]");
+
+		const VkDescriptorImageInfo srcInfo = i == 0 ?
+			(VkDescriptorImageInfo) { *asVkGetSimpleSamplerPtr(false), asVkGetViewFromTexture(pScreen->depthTexture), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL } :
+			(VkDescriptorImageInfo) { *asVkGetSimpleSamplerPtr(false), vClusterPyramidMipViews[i - 1], VK_IMAGE_LAYOUT_GENERAL };
+		const VkDescriptorImageInfo dstInfo = { VK_NULL_HANDLE, vClusterPyramidMipViews[i], VK_IMAGE_LAYOUT_GENERAL };
+		VkWriteDescriptorSet descSetWrites[2];
+		descSetWrites[0] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descSetWrites[0].dstSet = vClusterHizDescSets[i];
+		descSetWrites[0].dstBinding = 0;
+		descSetWrites[0].descriptorCount = 1;
+		descSetWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descSetWrites[0].pImageInfo = &srcInfo;
+		descSetWrites[1] = descSetWrites[0];
+		descSetWrites[1].dstBinding = 1;
+		descSetWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		descSetWrites[1].pImageInfo = &dstInfo;
+		vkUpdateDescriptorSets(asVkDevice, ASARRAYLEN(descSetWrites), descSetWrites, 0, NULL);
+	}
+}
+
+static void _clusterDestroyPyramid()
+{
+	vkDeviceWaitIdle(asVkDevice);
+	vkFreeDescriptorSets(asVkDevice, vClusterDescriptorPool, clusterPyramidMips, vClusterHizDescSets);
+	for (uint32_t i = 0; i < clusterPyramidMips; i++)
+	{
+		vkDestroyImageView(asVkDevice, vClusterPyramidMipViews[i], AS_VK_MEMCB);
+	}
+	asReleaseTexture(clusterPyramidTexture);
+	clusterPyramidMips = 0;
+}
+
+static VkDescriptorSetLayout _clusterCreateSetLayout(const VkDescriptorType* pTypes, uint32_t count)
+{
+	VkDescriptorSetLayoutBinding bindings[8];
+	ASASSERT(count <= ASARRAYLEN(bindings));
+	for (uint32_t i = 0; i < count; i++)
+	{
+		bindings[i] = (VkDescriptorSetLayoutBinding){ 0 };
+		bindings[i].binding = i;
+		bindings[i].descriptorType = pTypes[i];
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+	}
+	VkDescriptorSetLayoutCreateInfo desc = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	desc.bindingCount = count;
+	desc.pBindings = bindings;
+	VkDescriptorSetLayout layout;
+	AS_VK_CHECK(vkCreateDescriptorSetLayout(asVkDevice, &desc, AS_VK_MEMCB, &layout),
+		"vkCreateDescriptorSetLayout() Failed to create a cluster culling layout");
+	return layout;
+}
+
+static VkPipelineLayout _clusterCreatePipelineLayout(const VkDescriptorSetLayout* pSetLayouts, uint32_t count, uint32_t pushConstantSize)
+{
+	VkPipelineLayoutCreateInfo createInfo = (VkPipelineLayoutCreateInfo){ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	createInfo.setLayoutCount = count;
+	createInfo.pSetLayouts = pSetLayouts;
+	createInfo.pushConstantRangeCount = 1;
+	VkPushConstantRange pcRange;
+	pcRange.offset = 0;
+	pcRange.size = pushConstantSize;
+	pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	createInfo.pPushConstantRanges = &pcRange;
+	VkPipelineLayout layout;
+	AS_VK_CHECK(vkCreatePipelineLayout(asVkDevice, &createInfo, AS_VK_MEMCB, &layout),
+		"vkCreatePipelineLayout() Failed to create a cluster culling layout");
+	return layout;
+}
+#endif
+
+ASEXPORT asResults asInitClusterCulling()
+{
+	clusterPendingBatchCount = 0;
+#if ASTRENGINE_VK
+	/*Descriptor Set Layouts*/
+	{
+		const VkDescriptorType frameTypes[] = {
+			VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, /*View*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Jobs*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Transforms*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Draws*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Counts*/
+			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER /*Depth Pyramid*/
+		};
+		const VkDescriptorType geometryTypes[] = {
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Meshlets*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Meshlet Vertices*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /*Meshlet Triangles*/
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER /*Vertices*/
+		};
+		const VkDescriptorType hizTypes[] = {
+			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, /*Last Level*/
+			VK_DESCRIPTOR_TYPE_STORAGE_IMAGE /*Level*/
+		};
+		vClusterFrameDescLayout = _clusterCreateSetLayout(frameTypes, ASARRAYLEN(frameTypes));
+		vClusterGeometryDescLayout = _clusterCreateSetLayout(geometryTypes, ASARRAYLEN(geometryTypes));
+		vClusterHizDescLayout = _clusterCreateSetLayout(hizTypes, ASARRAYLEN(hizTypes));
+	}
+	/*Pipeline Layouts*/
+	{
+		const VkDescriptorSetLayout cullLayouts[] = { vClusterFrameDescLayout, vClusterGeometryDescLayout };
+		vClusterCullPipelineLayout = _clusterCreatePipelineLayout(cullLayouts, ASARRAYLEN(cullLayouts), sizeof(struct clusterCullPushConstants));
+		vClusterHizPipelineLayout = _clusterCreatePipelineLayout(&vClusterHizDescLayout, 1, sizeof(struct clusterHizPushConstants));
+	}
+	/*Descriptor Pool*/
+	{
+		const uint32_t frameSets = AS_CLUSTER_MAX_BATCHES * AS_MAX_INFLIGHT;
+		VkDescriptorPoolSize poolSizes[] = {
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameSets },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (frameSets * 4) + (AS_CLUSTER_MAX_GEOMETRIES * 4) },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frameSets + AS_CLUSTER_MAX_PYRAMID_MIPS },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, AS_CLUSTER_MAX_PYRAMID_MIPS },
+		};
+		VkDescriptorPoolCreateInfo createInfo = (VkDescriptorPoolCreateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		createInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		createInfo.maxSets = frameSets + AS_CLUSTER_MAX_GEOMETRIES + AS_CLUSTER_MAX_PYRAMID_MIPS;
+		createInfo.poolSizeCount = ASARRAYLEN(poolSizes);
+		createInfo.pPoolSizes = poolSizes;
+		AS_VK_CHECK(vkCreateDescriptorPool(asVkDevice, &createInfo, AS_VK_MEMCB, &vClusterDescriptorPool),
+			"vkCreateDescriptorPool() Failed to create vClusterDescriptorPool");
+	}
+	_clusterCreatePyramid();
+
+	/*Shaders (prims are drawn whole without them)*/
+	const char* path = "shaders/core/ClusterCull_FX.asfx";
+	clusterCullShaderFileID = asResource_FileIDFromRelativePath(path, strlen(path));
+	pClusterCullShader = asShaderFxManagerGetShaderFx(clusterCullShaderFileID);
+	if (!pClusterCullShader || !pClusterCullShader->pipelines[0] || !pClusterCullShader->pipelines[1])
+	{
+		asDebugWarning("Cluster culling disabled: could not load \"%s\"", path);
+		clusterCullingAvailable = false;
+	}
+	else if (!asVkDeviceFeatures.drawIndirectFirstInstance)
+	{
+		asDebugWarning("Cluster culling disabled: device lacks %s", "drawIndirectFirstInstance");
+		clusterCullingAvailable = false;
+	}
+	else
+	{
+		clusterCullingAvailable = true;
+		asDebugLog("Cluster culling: %s%s", asVkDrawIndirectCountSupported ? "draw indirect count" : "fixed indirect draws",
+			asVkMeshShaderSupported ? ", mesh shaders" : "");
+	}
+#endif
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asTriggerResizeClusterCulling()
+{
+#if ASTRENGINE_VK
+	_clusterDestroyPyramid();
+	_clusterCreatePyramid();
+#endif
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asShutdownClusterCulling()
+{
+	if (pClusterCullShader) { asShaderFxManagerDereferenceShaderFx(clusterCullShaderFileID); }
+	pClusterCullShader = NULL;
+	clusterCullingAvailable = false;
+	clusterPendingBatchCount = 0;
+#if ASTRENGINE_VK
+	_clusterDestroyPyramid();
+	vkDestroyDescriptorPool(asVkDevice, vClusterDescriptorPool, AS_VK_MEMCB);
+	vkDestroyPipelineLayout(asVkDevice, vClusterCullPipelineLayout, AS_VK_MEMCB);
+	vkDestroyPipelineLayout(asVkDevice, vClusterHizPipelineLayout, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vClusterFrameDescLayout, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vClusterGeometryDescLayout, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vClusterHizDescLayout, AS_VK_MEMCB);
+#endif
+	return AS_SUCCESS;
+}
+
+#if ASTRENGINE_VK
+ASEXPORT void asVkGetClusterCullingDescSetLayouts(void* pFrameDest, void* pGeometryDest)
+{
+	memcpy(pFrameDest, &vClusterFrameDescLayout, sizeof(vClusterFrameDescLayout));
+	memcpy(pGeometryDest, &vClusterGeometryDescLayout, sizeof(vClusterGeometryDescLayout));
+}
+#endif
+
+/*Fill out Vulkan Pipelines for Cluster Culling*/
+ASEXPORT asResults _asFillGfxPipeline_ClusterCull(
+	asBinReader* pShaderAsBin,
+	asGfxAPIs api,
+	asPipelineType pipelineType,
+	void* pDesc,
+	const char* pipelineName,
+	asPipelineHandle* pPipelineOut,
+	void* pUserData)
+{
+#if ASTRENGINE_VK
+	if (api != AS_GFXAPI_VULKAN || pipelineType != AS_PIPELINETYPE_COMPUTE) { return AS_FAILURE_UNKNOWN_FORMAT; }
+	VkComputePipelineCreateInfo* pComputePipelineDesc = (VkComputePipelineCreateInfo*)pDesc;
+	pComputePipelineDesc->basePipelineHandle = VK_NULL_HANDLE;
+	pComputePipelineDesc->basePipelineIndex = 0;
+	pComputePipelineDesc->layout = asIsStringEqual(pipelineName, "hiz") ? vClusterHizPipelineLayout : vClusterCullPipelineLayout;
+	AS_VK_CHECK(vkCreateComputePipelines(asVkDevice, VK_NULL_HANDLE, 1, pComputePipelineDesc, AS_VK_MEMCB, (VkPipeline*)pPipelineOut),
+		"vkCreateComputePipelines() Failed to create clusterCullPipeline");
+	return AS_SUCCESS;
+#endif
+	return AS_FAILURE_UNKNOWN;
+}
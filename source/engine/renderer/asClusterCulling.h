@@ -0,0 +1,168 @@
+#ifndef _ASCLUSTERCULLING_H_
+#define _ASCLUSTERCULLING_H_
+
+#include "engine/common/asCommon.h"
+#include "engine/renderer/asRendererCore.h"
+#include "engine/renderer/asRenderFx.h"
+#include "engine/model/runtime/asModelRuntime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief GPU culling of meshlets (see asModelMeshlet_t) against the view frustum, their normal cone and a hierarchical depth buffer
+* A compute pass writes an indexed indirect draw for every meshlet instance that survives and they are drawn with draw indirect count
+* (without it every meshlet instance keeps a fixed draw that gets zero instances when culled).
+* Occlusion is tested against the depth pyramid of the last frame with the view and transforms of the last frame,
+* so clusters that were hidden last frame show up one frame late.
+* The pyramid is built from the depth of screen 0, only the view that drew it (see asClusterViewDesc::depthPyramidView) tests occlusion.
+* Devices with task and mesh shaders can run the same tests per meshlet in the "meshlet" pipeline of the Scene shader type
+* (Scene FX includes SceneMeshlet.glsl for it) instead of the compute pass.
+* Shaders come from "shaders/core/ClusterCull_FX.asfx", without it (or draw indirect first instance) prims are drawn whole
+*/
+
+#define AS_CLUSTER_CULL_GROUP_SIZE 64 /**< Meshlet instances per compute workgroup*/
+#define AS_CLUSTER_TASK_GROUP_SIZE 32 /**< Meshlets per task shader workgroup*/
+#define AS_CLUSTER_MAX_GEOMETRIES 1024
+#define AS_CLUSTER_MAX_BATCHES 32
+
+/*Descriptor sets of the scene pipeline layout (after the texture pool and viewer)*/
+#define AS_DESCSET_CLUSTER_FRAME 2
+#define AS_DESCSET_CLUSTER_GEOMETRY 3
+
+/*Geometry*/
+
+/**
+* @brief GPU copy of the vertices, indices and meshlet tables of a model
+*/
+typedef struct asClusterGeometryT* asClusterGeometry;
+
+/**
+* @brief Upload a relocated model with meshlets
+* @return AS_FAILURE_INVALID_PARAM if the model has no meshlets
+*/
+ASEXPORT asResults asClusterGeometryCreate(asClusterGeometry* pGeometry, const asModel_t* pModel, const char* pDebugLabel);
+
+/**
+* @warning waits for the device to be idle
+*/
+ASEXPORT void asClusterGeometryDestroy(asClusterGeometry geometry);
+
+ASEXPORT asBufferHandle_t asClusterGeometryGetVertexBuffer(asClusterGeometry geometry);
+
+/**
+* @param pUint32Indices filled with whether the indices are 32 bit (optional)
+*/
+ASEXPORT asBufferHandle_t asClusterGeometryGetIndexBuffer(asClusterGeometry geometry, bool* pUint32Indices);
+
+/*Culling*/
+
+/**
+* @brief Whether meshlets can be culled on the GPU (otherwise draw prims whole)
+*/
+ASEXPORT bool asClusterCullingAvailable();
+
+/**
+* @brief Whether the "meshlet" pipeline of a Scene shader can draw culled meshlets with task and mesh shaders
+*/
+ASEXPORT bool asClusterCullingUseMeshShaders(const asShaderFx* pShaderFx);
+
+typedef enum {
+	AS_CLUSTER_JOB_NO_CONE = 1 << 0, /**< Skip the normal cone test (double sided or non uniformly scaled)*/
+	AS_CLUSTER_JOB_NO_OCCLUSION = 1 << 1, /**< Skip the depth pyramid test*/
+	AS_CLUSTER_JOB_OCTAHEDRAL_NORMALS = 1 << 2, /**< Normals are AS_VERTEX_NORMAL_OCTAHEDRAL (set from the model of the geometry by asClusterCullBatchAddJob())*/
+	AS_CLUSTER_JOB_MAX = UINT32_MAX
+} asClusterJobFlags;
+
+/**
+* @brief A range of meshlets drawn with a range of transforms
+*/
+typedef struct {
+	asClusterGeometry geometry;
+	uint32_t firstMeshlet; /**< Into the meshlet table of the model (see asModelLod_t::firstMeshlet)*/
+	uint32_t meshletCount;
+	uint32_t instanceCount; /**< One transform per instance*/
+	uint32_t transformOffset;
+	uint32_t transformOffsetPreviousFrame; /**< Transforms the depth pyramid was drawn with*/
+	uint32_t flags; /**< asClusterJobFlags*/
+} asClusterJobDesc;
+
+/**
+* @brief Camera the jobs are culled for
+*/
+typedef struct {
+	mat4 viewMatrix;
+	mat4 projMatrix; /**< Reversed infinite perspective or orthographic (the cone and occlusion tests need a perspective)*/
+	vec3 viewPosition;
+	asBufferHandle_t transformBuffer; /**< asGfxInstanceTransform for every instance*/
+	bool depthPyramidView; /**< Drew the depth of screen 0 the pyramid is built from (other views skip the occlusion test)*/
+} asClusterViewDesc;
+
+/**
+* @brief Culling jobs and their indirect draws for each frame in flight
+* Not threadsafe, use one batch per thread
+*/
+typedef struct asClusterCullBatchT* asClusterCullBatch;
+
+ASEXPORT asResults asClusterCullBatchCreate(asClusterCullBatch* pBatch, uint32_t maxJobs, uint32_t maxDraws);
+ASEXPORT void asClusterCullBatchDestroy(asClusterCullBatch batch);
+
+ASEXPORT asResults asClusterCullBatchBegin(asClusterCullBatch batch);
+
+/**
+* @param pJobIdx filled with the index to draw the job with
+* @return AS_FAILURE_OUT_OF_BOUNDS once the batch runs out of jobs or draws
+*/
+ASEXPORT asResults asClusterCullBatchAddJob(asClusterCullBatch batch, const asClusterJobDesc* pJob, uint32_t* pJobIdx);
+
+/**
+* @brief Upload the jobs and queue the batch to be culled before the scene is drawn this frame
+* @warning waits for the frame in flight to be done with the batch
+*/
+ASEXPORT asResults asClusterCullBatchEnd(asClusterCullBatch batch, const asClusterViewDesc* pView);
+
+/**
+* @brief Draw the meshlets of a job that survived culling (in a render pass with a Scene pipeline bound)
+* binds the geometry and the cluster descriptor sets, draws with task and mesh shaders when asClusterCullingUseMeshShaders()
+*/
+ASEXPORT void asClusterCullBatchDrawCmd(asClusterCullBatch batch, uint32_t jobIdx, bool meshShaders, asGfxAPIs api, void* pCmdBuff, void* pLayout);
+
+/**
+* @brief Cull every batch queued this frame (outside of a render pass before it is drawn)
+*/
+ASEXPORT asResults asClusterCullingRecordCmds(asGfxAPIs api, void* pCmdBuff);
+
+/**
+* @brief Reduce the depth of the frame into the depth pyramid (outside of the render pass that drew it)
+*/
+ASEXPORT asResults asClusterCullingBuildDepthPyramidCmds(asGfxAPIs api, void* pCmdBuff);
+
+ASEXPORT asResults asInitClusterCulling();
+ASEXPORT asResults asTriggerResizeClusterCulling();
+ASEXPORT asResults asShutdownClusterCulling();
+
+#if ASTRENGINE_VK /*Vulkan Stuff*/
+/**
+* @brief Set layouts for AS_DESCSET_CLUSTER_FRAME and AS_DESCSET_CLUSTER_GEOMETRY
+*/
+ASEXPORT void asVkGetClusterCullingDescSetLayouts(void* pFrameDest, void* pGeometryDest);
+#endif
+
+/**
+* @For internal use by shader system
+*/
+ASEXPORT asResults _asFillGfxPipeline_ClusterCull(
+	asBinReader* pShaderAsBin,
+	asGfxAPIs api,
+	asPipelineType pipelineType,
+	void* pDesc,
+	const char* pipelineName,
+	asPipelineHandle* pPipelineOut,
+	void* pUserData);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
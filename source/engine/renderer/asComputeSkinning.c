@@ -0,0 +1,437 @@
+#include "asComputeSkinning.h"
+
+#include "../resource/asResource.h"
+#include "../model/runtime/asModelRuntime.h"
+
+#if ASTRENGINE_VK
+#include "../renderer/vulkan/asVulkanBackend.h"
+#include <SDL_vulkan.h>
+#endif
+
+/*Matches Skinning_FX.glsl*/
+struct skinJob {
+	uint32_t firstSourceVertex;
+	uint32_t vertexCount;
+	uint32_t firstPalette;
+	uint32_t firstCacheVertex;
+	uint32_t flags;
+	uint32_t _pad[3];
+};
+
+struct skinPushConstants {
+	uint32_t firstJob;
+};
+
+/*Shaders*/
+asResourceFileID_t skinningShaderFileID;
+asShaderFx* pSkinningShader;
+bool skinningAvailable = false;
+
+#if ASTRENGINE_VK /*Vulkan Globals*/
+VkDescriptorSetLayout vSkinFrameDescLayout;
+VkDescriptorSetLayout vSkinSourceDescLayout;
+VkDescriptorPool vSkinDescriptorPool;
+VkPipelineLayout vSkinPipelineLayout;
+#endif
+
+/*Caches queued to be skinned this frame*/
+asSkinCache skinPendingCaches[AS_SKIN_MAX_CACHES];
+uint32_t skinPendingCacheCount = 0;
+uint32_t skinSourceCount = 0;
+
+/*Sources*/
+struct asSkinSourceT {
+	asBufferHandle_t vertexBuffer;
+	uint32_t vertexCount;
+#if ASTRENGINE_VK
+	VkDescriptorSet vDescSet;
+#endif
+};
+
+ASEXPORT asResults asSkinSourceCreate(asSkinSource* pSource, asBufferHandle_t vertexBuffer, uint32_t vertexCount)
+{
+	if (!pSource || !asHandleValid(vertexBuffer) || !vertexCount) { return AS_FAILURE_INVALID_PARAM; }
+	if (skinSourceCount >= AS_SKIN_MAX_SOURCES) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	asSkinSource source = asMalloc(sizeof(struct asSkinSourceT));
+	ASASSERT(source);
+	memset(source, 0, sizeof(struct asSkinSourceT));
+	source->vertexBuffer = vertexBuffer;
+	source->vertexCount = vertexCount;
+
+#if ASTRENGINE_VK
+	/*Descriptor Set*/
+	VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	descSetAllocInfo.descriptorPool = vSkinDescriptorPool;
+	descSetAllocInfo.descriptorSetCount = 1;
+	descSetAllocInfo.pSetLayouts = &vSkinSourceDescLayout;
+	AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, &source->vDescSet),
+		"vkAllocateDescriptorSets() Failed to allocate source->vDescSet");
+
+	const VkDescriptorBufferInfo bufferInfo = { asVkGetBufferFromBuffer(vertexBuffer), 0, VK_WHOLE_SIZE };
+	VkWriteDescriptorSet descSetWrite = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+	descSetWrite.dstSet = source->vDescSet;
+	descSetWrite.dstBinding = 0;
+	descSetWrite.descriptorCount = 1;
+	descSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descSetWrite.pBufferInfo = &bufferInfo;
+	vkUpdateDescriptorSets(asVkDevice, 1, &descSetWrite, 0, NULL);
+#endif
+
+	skinSourceCount++;
+	*pSource = source;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asSkinSourceDestroy(asSkinSource source)
+{
+	if (!source) { return; }
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+	vkFreeDescriptorSets(asVkDevice, vSkinDescriptorPool, 1, &source->vDescSet);
+#endif
+	skinSourceCount--;
+	asFree(source);
+}
+
+/*Caches*/
+struct asSkinCacheT {
+	uint32_t maxJobs;
+	uint32_t maxVertices;
+	uint32_t jobCount;
+	uint32_t vertexCount;
+	struct skinJob* pJobs;
+	asSkinSource* pJobSources;
+
+	asBufferHandle_t jobBuffs[AS_MAX_INFLIGHT];
+	asBufferHandle_t vertexBuffs[AS_MAX_INFLIGHT];
+	void* _jobMappings[AS_MAX_INFLIGHT];
+
+	int32_t currentFrame;
+
+#if ASTRENGINE_VK
+	VkDescriptorSet vDescSets[AS_MAX_INFLIGHT];
+#endif
+};
+
+ASEXPORT bool asComputeSkinningAvailable()
+{
+	return skinningAvailable;
+}
+
+ASEXPORT asResults asSkinCacheCreate(asSkinCache* pCache, uint32_t maxJobs, uint32_t maxVertices)
+{
+	if (!maxJobs || !maxVertices) { return AS_FAILURE_INVALID_PARAM; }
+	asSkinCache cache = asMalloc(sizeof(struct asSkinCacheT));
+	ASASSERT(cache);
+	memset(cache, 0, sizeof(struct asSkinCacheT));
+	cache->maxJobs = maxJobs;
+	cache->maxVertices = maxVertices;
+	cache->pJobs = asMalloc(maxJobs * sizeof(struct skinJob));
+	ASASSERT(cache->pJobs);
+	cache->pJobSources = asMalloc(maxJobs * sizeof(asSkinSource));
+	ASASSERT(cache->pJobSources);
+
+	asBufferDesc_t jobDesc = asBufferDesc_Init();
+	jobDesc.bufferSize = maxJobs * sizeof(struct skinJob);
+	jobDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
+	jobDesc.usageFlags = AS_BUFFERUSAGE_STORAGE;
+	jobDesc.pDebugLabel = "SkinJobs";
+	asBufferDesc_t vertexDesc = asBufferDesc_Init();
+	vertexDesc.bufferSize = maxVertices * sizeof(asVertexGeneric);
+	vertexDesc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	vertexDesc.usageFlags = AS_BUFFERUSAGE_VERTEX | AS_BUFFERUSAGE_STORAGE;
+	vertexDesc.pDebugLabel = "SkinCache";
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		cache->jobBuffs[i] = asCreateBuffer(&jobDesc);
+		cache->vertexBuffs[i] = asCreateBuffer(&vertexDesc);
+#if ASTRENGINE_VK
+		asVkAllocation_t jobAlloc = asVkGetAllocFromBuffer(cache->jobBuffs[i]);
+		asVkMapMemory(jobAlloc, 0, jobAlloc.size, &cache->_jobMappings[i]);
+#endif
+	}
+
+#if ASTRENGINE_VK
+	/*Descriptor Sets (written once the palettes are known)*/
+	VkDescriptorSetLayout layouts[AS_MAX_INFLIGHT];
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++) { layouts[i] = vSkinFrameDescLayout; }
+	VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	descSetAllocInfo.descriptorPool = vSkinDescriptorPool;
+	descSetAllocInfo.descriptorSetCount = AS_MAX_INFLIGHT;
+	descSetAllocInfo.pSetLayouts = layouts;
+	AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, cache->vDescSets),
+		"vkAllocateDescriptorSets() Failed to allocate cache->vDescSets");
+#endif
+
+	*pCache = cache;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asSkinCacheDestroy(asSkinCache cache)
+{
+	if (!cache) { return; }
+	for (uint32_t i = 0; i < skinPendingCacheCount; i++)
+	{
+		if (skinPendingCaches[i] == cache)
+		{
+			skinPendingCaches[i] = skinPendingCaches[--skinPendingCacheCount];
+			break;
+		}
+	}
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+	vkFreeDescriptorSets(asVkDevice, vSkinDescriptorPool, AS_MAX_INFLIGHT, cache->vDescSets);
+#endif
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+#if ASTRENGINE_VK
+		asVkUnmapMemory(asVkGetAllocFromBuffer(cache->jobBuffs[i]));
+#endif
+		asReleaseBuffer(cache->jobBuffs[i]);
+		asReleaseBuffer(cache->vertexBuffs[i]);
+	}
+	asFree(cache->pJobs);
+	asFree(cache->pJobSources);
+	asFree(cache);
+}
+
+ASEXPORT asResults asSkinCacheBegin(asSkinCache cache)
+{
+	cache->jobCount = 0;
+	cache->vertexCount = 0;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asSkinCacheAddJob(asSkinCache cache, const asSkinJobDesc* pJob, uint32_t* pCacheVertex)
+{
+	if (!pJob->source || !pJob->vertexCount) { return AS_FAILURE_INVALID_PARAM; }
+	if ((uint64_t)pJob->firstVertex + pJob->vertexCount > pJob->source->vertexCount) { return AS_FAILURE_INVALID_PARAM; }
+	if (cache->jobCount >= cache->maxJobs || (uint64_t)cache->vertexCount + pJob->vertexCount > cache->maxVertices) { return AS_FAILURE_OUT_OF_BOUNDS; }
+
+	struct skinJob* pDst = &cache->pJobs[cache->jobCount];
+	memset(pDst, 0, sizeof(struct skinJob));
+	pDst->firstSourceVertex = pJob->firstVertex;
+	pDst->vertexCount = pJob->vertexCount;
+	pDst->firstPalette = pJob->firstPalette;
+	pDst->firstCacheVertex = cache->vertexCount;
+	pDst->flags = pJob->flags;
+	cache->pJobSources[cache->jobCount] = pJob->source;
+	if (pCacheVertex) { *pCacheVertex = cache->vertexCount; }
+	cache->jobCount++;
+	cache->vertexCount += pJob->vertexCount;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asSkinCacheEnd(asSkinCache cache, asBufferHandle_t paletteBuffer)
+{
+	if (!asHandleValid(paletteBuffer)) { return AS_FAILURE_INVALID_PARAM; }
+#if ASTRENGINE_VK
+	/*The frame in flight may still be reading the buffers and descriptors*/
+	vkWaitForFences(asVkDevice, 1, &asVkInFlightFences[asVkCurrentFrame], VK_TRUE, UINT64_MAX);
+	cache->currentFrame = asVkCurrentFrame;
+#endif
+	const int32_t frame = cache->currentFrame;
+
+	/*Jobs*/
+	memcpy(cache->_jobMappings[frame], cache->pJobs, cache->jobCount * sizeof(struct skinJob));
+
+#if ASTRENGINE_VK
+	asVkFlushMemory(asVkGetAllocFromBuffer(cache->jobBuffs[frame]));
+
+	/*Descriptors*/
+	const VkDescriptorBufferInfo bufferInfos[] = {
+		{ asVkGetBufferFromBuffer(cache->jobBuffs[frame]), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(paletteBuffer), 0, VK_WHOLE_SIZE },
+		{ asVkGetBufferFromBuffer(cache->vertexBuffs[frame]), 0, VK_WHOLE_SIZE },
+	};
+	VkWriteDescriptorSet descSetWrites[ASARRAYLEN(bufferInfos)];
+	for (uint32_t i = 0; i < ASARRAYLEN(bufferInfos); i++)
+	{
+		descSetWrites[i] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		descSetWrites[i].dstSet = cache->vDescSets[frame];
+		descSetWrites[i].dstBinding = i;
+		descSetWrites[i].descriptorCount = 1;
+		descSetWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descSetWrites[i].pBufferInfo = &bufferInfos[i];
+	}
+	vkUpdateDescriptorSets(asVkDevice, ASARRAYLEN(descSetWrites), descSetWrites, 0, NULL);
+#endif
+
+	/*Queue for Skinning*/
+	for (uint32_t i = 0; i < skinPendingCacheCount; i++)
+	{
+		if (skinPendingCaches[i] == cache) { return AS_SUCCESS; }
+	}
+	if (skinPendingCacheCount >= AS_SKIN_MAX_CACHES) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	skinPendingCaches[skinPendingCacheCount++] = cache;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asBufferHandle_t asSkinCacheGetVertexBuffer(asSkinCache cache)
+{
+	return cache->vertexBuffs[cache->currentFrame];
+}
+
+ASEXPORT asResults asComputeSkinningRecordCmds(asGfxAPIs api, void* pCmdBuff)
+{
+	if (!skinningAvailable || !skinPendingCacheCount) {
+		skinPendingCacheCount = 0;
+		return AS_SUCCESS;
+	}
+#if ASTRENGINE_VK
+	ASASSERT(api == AS_GFXAPI_VULKAN);
+	VkCommandBuffer vCmd = *(VkCommandBuffer*)pCmdBuff;
+
+	/*Skin (a dispatch for each run of jobs sharing a source)*/
+	vkCmdBindPipeline(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE, (VkPipeline)pSkinningShader->pipelines[0]);
+	const uint32_t maxJobsPerDispatch = asVkDeviceProperties.limits.maxComputeWorkGroupCount[1];
+	for (uint32_t c = 0; c < skinPendingCacheCount; c++)
+	{
+		const asSkinCache cache = skinPendingCaches[c];
+		vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+			vSkinPipelineLayout, 0, 1, &cache->vDescSets[cache->currentFrame], 0, NULL);
+		uint32_t runStart = 0;
+		while (runStart < cache->jobCount)
+		{
+			const asSkinSource source = cache->pJobSources[runStart];
+			uint32_t runEnd = runStart;
+			uint32_t groupCount = 0;
+			while (runEnd < cache->jobCount && runEnd - runStart < maxJobsPerDispatch && cache->pJobSources[runEnd] == source)
+			{
+				const uint32_t jobGroupCount = (cache->pJobs[runEnd].vertexCount + AS_SKIN_GROUP_SIZE - 1) / AS_SKIN_GROUP_SIZE;
+				if (jobGroupCount > groupCount) { groupCount = jobGroupCount; }
+				runEnd++;
+			}
+			struct skinPushConstants pushConstants = { runStart };
+			vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+				vSkinPipelineLayout, 1, 1, &source->vDescSet, 0, NULL);
+			vkCmdPushConstants(vCmd, vSkinPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			vkCmdDispatch(vCmd, groupCount, runEnd - runStart, 1);
+			runStart = runEnd;
+		}
+	}
+
+	/*Skinned vertices are read as vertex buffers (and pulled by task and mesh shaders)*/
+	VkMemoryBarrier toDraw = (VkMemoryBarrier){ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	toDraw.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	toDraw.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(vCmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &toDraw, 0, NULL, 0, NULL);
+#endif
+	skinPendingCacheCount = 0;
+	return AS_SUCCESS;
+}
+
+#if ASTRENGINE_VK
+static VkDescriptorSetLayout _skinCreateSetLayout(uint32_t storageBufferCount)
+{
+	VkDescriptorSetLayoutBinding bindings[4];
+	ASASSERT(storageBufferCount <= ASARRAYLEN(bindings));
+	for (uint32_t i = 0; i < storageBufferCount; i++)
+	{
+		bindings[i] = (VkDescriptorSetLayoutBinding){ 0 };
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+	VkDescriptorSetLayoutCreateInfo desc = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	desc.bindingCount = storageBufferCount;
+	desc.pBindings = bindings;
+	VkDescriptorSetLayout layout;
+	AS_VK_CHECK(vkCreateDescriptorSetLayout(asVkDevice, &desc, AS_VK_MEMCB, &layout),
+		"vkCreateDescriptorSetLayout() Failed to create a skinning layout");
+	return layout;
+}
+#endif
+
+ASEXPORT asResults asInitComputeSkinning()
+{
+	skinPendingCacheCount = 0;
+#if ASTRENGINE_VK
+	/*Descriptor Set Layouts*/
+	vSkinFrameDescLayout = _skinCreateSetLayout(3); /*Jobs, Palettes, Cache*/
+	vSkinSourceDescLayout = _skinCreateSetLayout(1); /*Bind Pose Vertices*/
+	/*Pipeline Layout*/
+	{
+		const VkDescriptorSetLayout setLayouts[] = { vSkinFrameDescLayout, vSkinSourceDescLayout };
+		VkPipelineLayoutCreateInfo createInfo = (VkPipelineLayoutCreateInfo){ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		createInfo.setLayoutCount = ASARRAYLEN(setLayouts);
+		createInfo.pSetLayouts = setLayouts;
+		createInfo.pushConstantRangeCount = 1;
+		VkPushConstantRange pcRange;
+		pcRange.offset = 0;
+		pcRange.size = sizeof(struct skinPushConstants);
+		pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		createInfo.pPushConstantRanges = &pcRange;
+		AS_VK_CHECK(vkCreatePipelineLayout(asVkDevice, &createInfo, AS_VK_MEMCB, &vSkinPipelineLayout),
+			"vkCreatePipelineLayout() Failed to create vSkinPipelineLayout");
+	}
+	/*Descriptor Pool*/
+	{
+		const uint32_t frameSets = AS_SKIN_MAX_CACHES * AS_MAX_INFLIGHT;
+		VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (frameSets * 3) + AS_SKIN_MAX_SOURCES };
+		VkDescriptorPoolCreateInfo createInfo = (VkDescriptorPoolCreateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		createInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		createInfo.maxSets = frameSets + AS_SKIN_MAX_SOURCES;
+		createInfo.poolSizeCount = 1;
+		createInfo.pPoolSizes = &poolSize;
+		AS_VK_CHECK(vkCreateDescriptorPool(asVkDevice, &createInfo, AS_VK_MEMCB, &vSkinDescriptorPool),
+			"vkCreateDescriptorPool() Failed to create vSkinDescriptorPool");
+	}
+
+	/*Shaders (caches are never skinned without them)*/
+	const char* path = "shaders/core/Skinning_FX.asfx";
+	skinningShaderFileID = asResource_FileIDFromRelativePath(path, strlen(path));
+	pSkinningShader = asShaderFxManagerGetShaderFx(skinningShaderFileID);
+	if (!pSkinningShader || !pSkinningShader->pipelines[0])
+	{
+		asDebugWarning("Compute skinning disabled: could not load \"%s\"", path);
+		skinningAvailable = false;
+	}
+	else
+	{
+		skinningAvailable = true;
+	}
+#endif
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asShutdownComputeSkinning()
+{
+	if (pSkinningShader) { asShaderFxManagerDereferenceShaderFx(skinningShaderFileID); }
+	pSkinningShader = NULL;
+	skinningAvailable = false;
+	skinPendingCacheCount = 0;
+#if ASTRENGINE_VK
+	vkDestroyDescriptorPool(asVkDevice, vSkinDescriptorPool, AS_VK_MEMCB);
+	vkDestroyPipelineLayout(asVkDevice, vSkinPipelineLayout, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vSkinFrameDescLayout, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vSkinSourceDescLayout, AS_VK_MEMCB);
+#endif
+	return AS_SUCCESS;
+}
+
+/*Fill out Vulkan Pipelines for Compute Skinning*/
+ASEXPORT asResults _asFillGfxPipeline_Skinning(
+	asBinReader* pShaderAsBin,
+	asGfxAPIs api,
+	asPipelineType pipelineType,
+	void* pDesc,
+	const char* pipelineName,
+	asPipelineHandle* pPipelineOut,
+	void* pUserData)
+{
+#if ASTRENGINE_VK
+	if (api != AS_GFXAPI_VULKAN || pipelineType != AS_PIPELINETYPE_COMPUTE) { return AS_FAILURE_UNKNOWN_FORMAT; }
+	VkComputePipelineCreateInfo* pComputePipelineDesc = (VkComputePipelineCreateInfo*)pDesc;
+	pComputePipelineDesc->basePipelineHandle = VK_NULL_HANDLE;
+	pComputePipelineDesc->basePipelineIndex = 0;
+	pComputePipelineDesc->layout = vSkinPipelineLayout;
+	AS_VK_CHECK(vkCreateComputePipelines(asVkDevice, VK_NULL_HANDLE, 1, pComputePipelineDesc, AS_VK_MEMCB, (VkPipeline*)pPipelineOut),
+		"vkCreateComputePipelines() Failed to create skinningPipeline");
+	return AS_SUCCESS;
+#endif
+	return AS_FAILURE_UNKNOWN;
+}
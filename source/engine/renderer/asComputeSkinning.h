@@ -0,0 +1,123 @@
+#ifndef _ASCOMPUTESKINNING_H_
+#define _ASCOMPUTESKINNING_H_
+
+#include "engine/common/asCommon.h"
+#include "engine/renderer/asRendererCore.h"
+#include "engine/renderer/asRenderFx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Skinning of asVertexGeneric vertices in a compute pass before the scene is drawn
+* Each job blends the palette matrices (see asAnimPaletteMatrix_t) of the bind pose vertices of a source into a skin cache,
+* a vertex buffer of skinned asVertexGeneric for each frame in flight. Depth, shadow and main passes all draw the cache as static geometry
+* (bind it as the vertex buffer and draw with vertexStart at the vertex of the job) so skinning happens once per frame per instance however many views draw it.
+* Positions, normals and tangents are skinned, the rest of the vertex is copied (normals are exact for rotations and uniform scale).
+* Shaders come from "shaders/core/Skinning_FX.asfx", without them asComputeSkinningAvailable() is false and nothing is skinned
+* (the engine has no other skinning path, callers have to draw the bind pose vertices of the source instead).
+* The decode and skin math of the shader is checked on the CPU against asAnimation_WritePalette() by the animation benchmark (tools/animbenchmark)
+*/
+
+#define AS_SKIN_GROUP_SIZE 64 /**< Vertices per compute workgroup*/
+#define AS_SKIN_MAX_SOURCES 1024
+#define AS_SKIN_MAX_CACHES 32
+
+/*Sources*/
+
+/**
+* @brief Bind pose vertices jobs are skinned from
+*/
+typedef struct asSkinSourceT* asSkinSource;
+
+/**
+* @brief Skin from a buffer of asVertexGeneric (with AS_BUFFERUSAGE_STORAGE, see asClusterGeometryGetVertexBuffer())
+* @param vertexBuffer owned by the caller and kept alive until the source is destroyed
+* @return AS_FAILURE_OUT_OF_BOUNDS once there are AS_SKIN_MAX_SOURCES sources
+*/
+ASEXPORT asResults asSkinSourceCreate(asSkinSource* pSource, asBufferHandle_t vertexBuffer, uint32_t vertexCount);
+
+/**
+* @warning waits for the device to be idle
+*/
+ASEXPORT void asSkinSourceDestroy(asSkinSource source);
+
+/*Skinning*/
+
+/**
+* @brief Whether the skin caches are skinned (otherwise draw the bind pose)
+*/
+ASEXPORT bool asComputeSkinningAvailable();
+
+typedef enum {
+	AS_SKIN_JOB_OCTAHEDRAL_NORMALS = 1 << 0, /**< Normals are AS_VERTEX_NORMAL_OCTAHEDRAL (AS_MODEL_FLAG_OCTAHEDRAL_NORMALS)*/
+	AS_SKIN_JOB_MAX = UINT32_MAX
+} asSkinJobFlags;
+
+/**
+* @brief A range of vertices of a source skinned by a palette
+*/
+typedef struct {
+	asSkinSource source;
+	uint32_t firstVertex; /**< Into the source*/
+	uint32_t vertexCount;
+	uint32_t firstPalette; /**< Matrix the bone indices of the vertices start from (see asAnimPaletteBufferAllocate())*/
+	uint32_t flags; /**< asSkinJobFlags*/
+} asSkinJobDesc;
+
+/**
+* @brief Skinning jobs and the skinned vertices they write for each frame in flight
+* Not threadsafe, use one cache per thread
+*/
+typedef struct asSkinCacheT* asSkinCache;
+
+ASEXPORT asResults asSkinCacheCreate(asSkinCache* pCache, uint32_t maxJobs, uint32_t maxVertices);
+ASEXPORT void asSkinCacheDestroy(asSkinCache cache);
+
+ASEXPORT asResults asSkinCacheBegin(asSkinCache cache);
+
+/**
+* @brief Jobs of the same source added one after another are skinned by the same dispatch
+* @param pCacheVertex filled with the vertex of the cache the skinned vertices start at (draw with it as vertexStart)
+* @return AS_FAILURE_OUT_OF_BOUNDS once the cache runs out of jobs or vertices
+*/
+ASEXPORT asResults asSkinCacheAddJob(asSkinCache cache, const asSkinJobDesc* pJob, uint32_t* pCacheVertex);
+
+/**
+* @brief Upload the jobs and queue the cache to be skinned before the scene is drawn this frame
+* @param paletteBuffer matrices the jobs index into (see asAnimPaletteBufferGetBuffer())
+* @warning waits for the frame in flight to be done with the cache
+*/
+ASEXPORT asResults asSkinCacheEnd(asSkinCache cache, asBufferHandle_t paletteBuffer);
+
+/**
+* @brief Vertex buffer the jobs of the last end are skinned into
+*/
+ASEXPORT asBufferHandle_t asSkinCacheGetVertexBuffer(asSkinCache cache);
+
+/**
+* @brief Skin every cache queued this frame (outside of a render pass before anything draws them)
+*/
+ASEXPORT asResults asComputeSkinningRecordCmds(asGfxAPIs api, void* pCmdBuff);
+
+ASEXPORT asResults asInitComputeSkinning();
+ASEXPORT asResults asShutdownComputeSkinning();
+
+/**
+* @For internal use by shader system
+*/
+ASEXPORT asResults _asFillGfxPipeline_Skinning(
+	asBinReader* pShaderAsBin,
+	asGfxAPIs api,
+	asPipelineType pipelineType,
+	void* pDesc,
+	const char* pipelineName,
+	asPipelineHandle* pPipelineOut,
+	void* pUserData);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,298 @@
+#include "asGeometryArena.h"
+
+#if ASTRENGINE_VK
+#include "../renderer/vulkan/asVulkanBackend.h"
+#include <SDL_vulkan.h>
+#endif
+
+/*Free ranges of a buffer sorted by start (neighbours are always merged, so there is at most one more than there are allocations)*/
+struct arenaFreeRange {
+	uint32_t start;
+	uint32_t count;
+};
+
+struct arenaFreeList {
+	uint32_t rangeCount;
+	uint32_t used;
+	struct arenaFreeRange ranges[AS_GEOMETRY_ARENA_MAX_ALLOCATIONS + 1];
+};
+
+struct arenaFreeList arenaFreeVertices;
+struct arenaFreeList arenaFreeIndices;
+uint32_t arenaAllocationCount;
+asBufferHandle_t arenaVertexBuffer;
+asBufferHandle_t arenaIndexBuffer;
+
+#if ASTRENGINE_VK /*Vulkan Globals*/
+VkDescriptorSetLayout vArenaDescLayout;
+VkDescriptorPool vArenaDescriptorPool;
+VkDescriptorSet vArenaDescSet;
+#endif
+
+static void _arenaFreeListInit(struct arenaFreeList* pList, uint32_t size)
+{
+	pList->rangeCount = 1;
+	pList->used = 0;
+	pList->ranges[0] = (struct arenaFreeRange){ 0, size };
+}
+
+/*First fit, UINT32_MAX when no range is large enough*/
+static uint32_t _arenaFreeListTake(struct arenaFreeList* pList, uint32_t count)
+{
+	if (!count) { return 0; }
+	for (uint32_t i = 0; i < pList->rangeCount; i++)
+	{
+		struct arenaFreeRange* pRange = &pList->ranges[i];
+		if (pRange->count < count) { continue; }
+		const uint32_t start = pRange->start;
+		pRange->start += count;
+		pRange->count -= count;
+		if (!pRange->count)
+		{
+			memmove(pRange, pRange + 1, (pList->rangeCount - i - 1) * sizeof(struct arenaFreeRange));
+			pList->rangeCount--;
+		}
+		pList->used += count;
+		return start;
+	}
+	return UINT32_MAX;
+}
+
+static void _arenaFreeListGive(struct arenaFreeList* pList, uint32_t start, uint32_t count)
+{
+	if (!count) { return; }
+	uint32_t i = 0;
+	while (i < pList->rangeCount && pList->ranges[i].start < start) { i++; }
+	const bool mergePrev = i > 0 && pList->ranges[i - 1].start + pList->ranges[i - 1].count == start;
+	const bool mergeNext = i < pList->rangeCount && start + count == pList->ranges[i].start;
+	pList->used -= count;
+	if (mergePrev && mergeNext)
+	{
+		pList->ranges[i - 1].count += count + pList->ranges[i].count;
+		memmove(&pList->ranges[i], &pList->ranges[i + 1], (pList->rangeCount - i - 1) * sizeof(struct arenaFreeRange));
+		pList->rangeCount--;
+	}
+	else if (mergePrev)
+	{
+		pList->ranges[i - 1].count += count;
+	}
+	else if (mergeNext)
+	{
+		pList->ranges[i].start = start;
+		pList->ranges[i].count += count;
+	}
+	else
+	{
+		ASASSERT(pList->rangeCount <= AS_GEOMETRY_ARENA_MAX_ALLOCATIONS);
+		memmove(&pList->ranges[i + 1], &pList->ranges[i], (pList->rangeCount - i) * sizeof(struct arenaFreeRange));
+		pList->ranges[i] = (struct arenaFreeRange){ start, count };
+		pList->rangeCount++;
+	}
+}
+
+static uint32_t _arenaFreeListLargest(const struct arenaFreeList* pList)
+{
+	uint32_t largest = 0;
+	for (uint32_t i = 0; i < pList->rangeCount; i++)
+	{
+		if (pList->ranges[i].count > largest) { largest = pList->ranges[i].count; }
+	}
+	return largest;
+}
+
+ASEXPORT asResults asGeometryArenaAllocate(const asVertexGeneric* pVertices, uint32_t vertexCount,
+	const void* pIndices, uint32_t indexCount, uint32_t indexSize, asGeometryArenaRange_t* pRange)
+{
+	if (!pRange || !vertexCount || !pVertices || !indexCount || !pIndices) { return AS_FAILURE_INVALID_PARAM; }
+	if (indexSize != 2 && indexSize != 4) { return AS_FAILURE_INVALID_PARAM; }
+	if (arenaAllocationCount >= AS_GEOMETRY_ARENA_MAX_ALLOCATIONS) { return AS_FAILURE_OUT_OF_MEMORY; }
+	const uint32_t firstVertex = _arenaFreeListTake(&arenaFreeVertices, vertexCount);
+	if (firstVertex == UINT32_MAX) { return AS_FAILURE_OUT_OF_MEMORY; }
+	const uint32_t firstIndex = _arenaFreeListTake(&arenaFreeIndices, indexCount);
+	if (firstIndex == UINT32_MAX)
+	{
+		_arenaFreeListGive(&arenaFreeVertices, firstVertex, vertexCount);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	/*Indices stay relative to the range (vertexStart is added by the draw)*/
+	const uint32_t* pIndices32 = pIndices;
+	uint32_t* pWidened = NULL;
+	if (indexSize == 2)
+	{
+		pWidened = asMalloc((size_t)indexCount * sizeof(uint32_t));
+		ASASSERT(pWidened);
+		const uint16_t* pIndices16 = pIndices;
+		for (uint32_t i = 0; i < indexCount; i++) { pWidened[i] = pIndices16[i]; }
+		pIndices32 = pWidened;
+	}
+
+	/*Vertices and indices in one submission*/
+	const asBufferUploadRegion_t regions[] = {
+		{ arenaVertexBuffer, (size_t)firstVertex * sizeof(asVertexGeneric), (size_t)vertexCount * sizeof(asVertexGeneric), pVertices },
+		{ arenaIndexBuffer, (size_t)firstIndex * sizeof(uint32_t), (size_t)indexCount * sizeof(uint32_t), pIndices32 }
+	};
+	asResults result = asUploadBufferRegions(regions, ASARRAYLEN(regions));
+	if (pWidened) { asFree(pWidened); }
+	if (result != AS_SUCCESS)
+	{
+		_arenaFreeListGive(&arenaFreeVertices, firstVertex, vertexCount);
+		_arenaFreeListGive(&arenaFreeIndices, firstIndex, indexCount);
+		return result;
+	}
+
+	arenaAllocationCount++;
+	pRange->firstVertex = firstVertex;
+	pRange->vertexCount = vertexCount;
+	pRange->firstIndex = firstIndex;
+	pRange->indexCount = indexCount;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asGeometryArenaAllocateModel(const asModel_t* pModel, asGeometryArenaRange_t* pRange)
+{
+	if (!pModel || !pModel->relocated) { return AS_FAILURE_INVALID_PARAM; }
+	return asGeometryArenaAllocate(pModel->vertices.ptr, pModel->vertexCount,
+		pModel->indices.ptr, pModel->indexCount, pModel->indexSize, pRange);
+}
+
+ASEXPORT void asGeometryArenaFree(const asGeometryArenaRange_t* pRange)
+{
+	if (!pRange || !pRange->vertexCount) { return; }
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+#endif
+	_arenaFreeListGive(&arenaFreeVertices, pRange->firstVertex, pRange->vertexCount);
+	_arenaFreeListGive(&arenaFreeIndices, pRange->firstIndex, pRange->indexCount);
+	arenaAllocationCount--;
+}
+
+ASEXPORT void asGeometryArenaGetStats(uint32_t* pUsedVertices, uint32_t* pUsedIndices, uint32_t* pLargestFreeVertices, uint32_t* pLargestFreeIndices)
+{
+	if (pUsedVertices) { *pUsedVertices = arenaFreeVertices.used; }
+	if (pUsedIndices) { *pUsedIndices = arenaFreeIndices.used; }
+	if (pLargestFreeVertices) { *pLargestFreeVertices = _arenaFreeListLargest(&arenaFreeVertices); }
+	if (pLargestFreeIndices) { *pLargestFreeIndices = _arenaFreeListLargest(&arenaFreeIndices); }
+}
+
+ASEXPORT asBufferHandle_t asGeometryArenaGetVertexBuffer()
+{
+	return arenaVertexBuffer;
+}
+
+ASEXPORT asBufferHandle_t asGeometryArenaGetIndexBuffer()
+{
+	return arenaIndexBuffer;
+}
+
+ASEXPORT void asGeometryArenaBindCmd(asGfxAPIs api, void* pCmdBuff, void* pLayout)
+{
+	ASASSERT(api == AS_GFXAPI_VULKAN);
+#if ASTRENGINE_VK
+	const VkCommandBuffer vCmd = *(VkCommandBuffer*)pCmdBuff;
+	const VkPipelineLayout pipelineLayout = *(VkPipelineLayout*)pLayout;
+	VkBuffer vBuff = asVkGetBufferFromBuffer(arenaVertexBuffer);
+	VkDeviceSize byteOffset = 0;
+	vkCmdBindVertexBuffers(vCmd, 0, 1, &vBuff, &byteOffset);
+	vkCmdBindIndexBuffer(vCmd, asVkGetBufferFromBuffer(arenaIndexBuffer), 0, VK_INDEX_TYPE_UINT32);
+	vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+		pipelineLayout, AS_DESCSET_GEOMETRY_ARENA, 1, &vArenaDescSet, 0, NULL);
+#endif
+}
+
+ASEXPORT asResults asInitGeometryArena()
+{
+	_arenaFreeListInit(&arenaFreeVertices, AS_GEOMETRY_ARENA_MAX_VERTICES);
+	_arenaFreeListInit(&arenaFreeIndices, AS_GEOMETRY_ARENA_MAX_INDICES);
+	arenaAllocationCount = 0;
+
+	/*Buffers*/
+	asBufferDesc_t desc = asBufferDesc_Init();
+	desc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+	desc.usageFlags = AS_BUFFERUSAGE_VERTEX | AS_BUFFERUSAGE_STORAGE | AS_BUFFERUSAGE_TRANSFER_DST;
+	desc.bufferSize = AS_GEOMETRY_ARENA_MAX_VERTICES * sizeof(asVertexGeneric);
+	desc.pDebugLabel = "GeometryArenaVertices";
+	arenaVertexBuffer = asCreateBuffer(&desc);
+	desc.usageFlags = AS_BUFFERUSAGE_INDEX | AS_BUFFERUSAGE_STORAGE | AS_BUFFERUSAGE_TRANSFER_DST;
+	desc.bufferSize = AS_GEOMETRY_ARENA_MAX_INDICES * sizeof(uint32_t);
+	desc.pDebugLabel = "GeometryArenaIndices";
+	arenaIndexBuffer = asCreateBuffer(&desc);
+
+#if ASTRENGINE_VK
+	/*Descriptor Set Layout*/
+	{
+		VkDescriptorSetLayoutBinding bindings[2];
+		for (uint32_t i = 0; i < ASARRAYLEN(bindings); i++)
+		{
+			bindings[i] = (VkDescriptorSetLayoutBinding){ 0 };
+			bindings[i].binding = i; /*Vertices, Indices*/
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+		}
+		VkDescriptorSetLayoutCreateInfo createInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		createInfo.bindingCount = ASARRAYLEN(bindings);
+		createInfo.pBindings = bindings;
+		AS_VK_CHECK(vkCreateDescriptorSetLayout(asVkDevice, &createInfo, AS_VK_MEMCB, &vArenaDescLayout),
+			"vkCreateDescriptorSetLayout() Failed to create vArenaDescLayout");
+	}
+	/*Descriptor Pool*/
+	{
+		VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 };
+		VkDescriptorPoolCreateInfo createInfo = (VkDescriptorPoolCreateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		createInfo.maxSets = 1;
+		createInfo.poolSizeCount = 1;
+		createInfo.pPoolSizes = &poolSize;
+		AS_VK_CHECK(vkCreateDescriptorPool(asVkDevice, &createInfo, AS_VK_MEMCB, &vArenaDescriptorPool),
+			"vkCreateDescriptorPool() Failed to create vArenaDescriptorPool");
+	}
+	/*Descriptor Set*/
+	{
+		VkDescriptorSetAllocateInfo descSetAllocInfo = (VkDescriptorSetAllocateInfo){ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		descSetAllocInfo.descriptorPool = vArenaDescriptorPool;
+		descSetAllocInfo.descriptorSetCount = 1;
+		descSetAllocInfo.pSetLayouts = &vArenaDescLayout;
+		AS_VK_CHECK(vkAllocateDescriptorSets(asVkDevice, &descSetAllocInfo, &vArenaDescSet),
+			"vkAllocateDescriptorSets() Failed to allocate vArenaDescSet");
+
+		const asBufferHandle_t buffers[] = { arenaVertexBuffer, arenaIndexBuffer };
+		VkDescriptorBufferInfo bufferInfos[ASARRAYLEN(buffers)];
+		VkWriteDescriptorSet descSetWrites[ASARRAYLEN(buffers)];
+		for (uint32_t i = 0; i < ASARRAYLEN(buffers); i++)
+		{
+			bufferInfos[i] = (VkDescriptorBufferInfo){ asVkGetBufferFromBuffer(buffers[i]), 0, VK_WHOLE_SIZE };
+			descSetWrites[i] = (VkWriteDescriptorSet){ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			descSetWrites[i].dstSet = vArenaDescSet;
+			descSetWrites[i].dstBinding = i;
+			descSetWrites[i].descriptorCount = 1;
+			descSetWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descSetWrites[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(asVkDevice, ASARRAYLEN(descSetWrites), descSetWrites, 0, NULL);
+	}
+	asDebugLog("Geometry arena: %u vertices, %u indices, %s", AS_GEOMETRY_ARENA_MAX_VERTICES, AS_GEOMETRY_ARENA_MAX_INDICES,
+		asVkDeviceFeatures.multiDrawIndirect && asVkDeviceFeatures.drawIndirectFirstInstance ? "multi draw indirect" : "direct draws");
+#endif
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asShutdownGeometryArena()
+{
+#if ASTRENGINE_VK
+	vkDeviceWaitIdle(asVkDevice);
+	vkDestroyDescriptorPool(asVkDevice, vArenaDescriptorPool, AS_VK_MEMCB);
+	vkDestroyDescriptorSetLayout(asVkDevice, vArenaDescLayout, AS_VK_MEMCB);
+#endif
+	asReleaseBuffer(arenaVertexBuffer);
+	asReleaseBuffer(arenaIndexBuffer);
+	_arenaFreeListInit(&arenaFreeVertices, 0);
+	_arenaFreeListInit(&arenaFreeIndices, 0);
+	return AS_SUCCESS;
+}
+
+#if ASTRENGINE_VK
+ASEXPORT void asVkGetGeometryArenaDescSetLayout(void* pDest)
+{
+	memcpy(pDest, &vArenaDescLayout, sizeof(vArenaDescLayout));
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef _ASGEOMETRYARENA_H_
+#define _ASGEOMETRYARENA_H_
+
+#include "engine/common/asCommon.h"
+#include "engine/renderer/asRendererCore.h"
+#include "engine/model/runtime/asModelRuntime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Static mesh vertices and indices suballocated from one large vertex buffer and one large index buffer
+* Prims drawn from the arena (AS_GFX_DRAW_FLAG_GEOMETRY_ARENA) share the same bindings, so the scene renderer binds them once
+* per command buffer and merges runs of them into a single multi draw indirect when their Scene FX has the "arena" pipeline
+* (it reads the transforms and material of each draw from the instance attributes, other shaders draw them one by one).
+* Indices are 32 bit and relative to the first vertex of their range (draw with vertexStart at the first vertex).
+* Shaders may also pull vertices from the storage buffers of AS_DESCSET_GEOMETRY_ARENA by gl_VertexIndex (see GeometryArena.glsl)
+*/
+
+#define AS_GEOMETRY_ARENA_MAX_VERTICES (1 << 21) /**< 88 MiB of asVertexGeneric*/
+#define AS_GEOMETRY_ARENA_MAX_INDICES (1 << 23) /**< 32 MiB of uint32_t*/
+#define AS_GEOMETRY_ARENA_MAX_ALLOCATIONS 4096
+
+/*Descriptor set of the scene pipeline layout (after the cluster sets)*/
+#define AS_DESCSET_GEOMETRY_ARENA 4
+
+/**
+* @brief Vertices and indices of an allocation
+*/
+typedef struct {
+	uint32_t firstVertex; /**< Draw with this as vertexStart (added to every index)*/
+	uint32_t vertexCount;
+	uint32_t firstIndex; /**< Draw with this added to indexStart*/
+	uint32_t indexCount;
+} asGeometryArenaRange_t;
+
+/**
+* @brief Copy vertices and indices into the arena
+* @param indexSize 2 or 4 bytes, 16 bit indices are widened
+* @return AS_FAILURE_INVALID_PARAM without indices (arena prims are always drawn indexed),
+* AS_FAILURE_OUT_OF_MEMORY when there is no free range large enough or AS_GEOMETRY_ARENA_MAX_ALLOCATIONS are live
+* @warning waits for the upload (a single submission) to finish, not threadsafe
+*/
+ASEXPORT asResults asGeometryArenaAllocate(const asVertexGeneric* pVertices, uint32_t vertexCount,
+	const void* pIndices, uint32_t indexCount, uint32_t indexSize, asGeometryArenaRange_t* pRange);
+
+/**
+* @brief Copy the vertices and indices of a relocated model into the arena
+* submeshes are drawn with vertexStart at firstVertex + vertexOffset and indexStart at firstIndex + the first index of the level
+*/
+ASEXPORT asResults asGeometryArenaAllocateModel(const asModel_t* pModel, asGeometryArenaRange_t* pRange);
+
+/**
+* @warning waits for the device to be idle
+*/
+ASEXPORT void asGeometryArenaFree(const asGeometryArenaRange_t* pRange);
+
+/**
+* @brief Vertices and indices in use and the largest allocation that can still succeed
+*/
+ASEXPORT void asGeometryArenaGetStats(uint32_t* pUsedVertices, uint32_t* pUsedIndices, uint32_t* pLargestFreeVertices, uint32_t* pLargestFreeIndices);
+
+ASEXPORT asBufferHandle_t asGeometryArenaGetVertexBuffer();
+ASEXPORT asBufferHandle_t asGeometryArenaGetIndexBuffer(); /**< 32 bit indices*/
+
+/**
+* @brief Bind the vertex buffer, index buffer and AS_DESCSET_GEOMETRY_ARENA (in a command buffer with a Scene pipeline layout)
+*/
+ASEXPORT void asGeometryArenaBindCmd(asGfxAPIs api, void* pCmdBuff, void* pLayout);
+
+ASEXPORT asResults asInitGeometryArena();
+ASEXPORT asResults asShutdownGeometryArena();
+
+#if ASTRENGINE_VK /*Vulkan Stuff*/
+/**
+* @brief Set layout for AS_DESCSET_GEOMETRY_ARENA
+*/
+ASEXPORT void asVkGetGeometryArenaDescSetLayout(void* pDest);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,539 @@
+#include "asMipGeneration.h"
+#include "../thread/asJobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_MIPGEN_SSE2 1
+#include <emmintrin.h>
+#else
+#define AS_MIPGEN_SSE2 0
+#endif
+
+#define MIPGEN_KAISER_WIDTH 3.0f /*Support in destination pixels on each side*/
+#define MIPGEN_KAISER_ALPHA 4.0f
+#define MIPGEN_MIN_BAND_ROWS 16 /*Bands re-filter the source rows they share, keep them tall enough*/
+#define MIPGEN_LINEAR_MAX 65535.0f
+
+/*Pixels are one vector of linear RGBA*/
+#if AS_MIPGEN_SSE2
+typedef __m128 mipPixel;
+#else
+typedef struct { float v[4]; } mipPixel;
+#endif
+
+static inline mipPixel _mipZero()
+{
+#if AS_MIPGEN_SSE2
+	return _mm_setzero_ps();
+#else
+	return (mipPixel) { { 0.0f, 0.0f, 0.0f, 0.0f } };
+#endif
+}
+
+static inline mipPixel _mipLoad(const float* pSrc)
+{
+#if AS_MIPGEN_SSE2
+	return _mm_loadu_ps(pSrc);
+#else
+	mipPixel result;
+	memcpy(result.v, pSrc, sizeof(float) * 4);
+	return result;
+#endif
+}
+
+static inline void _mipStore(float* pDst, mipPixel pixel)
+{
+#if AS_MIPGEN_SSE2
+	_mm_storeu_ps(pDst, pixel);
+#else
+	memcpy(pDst, pixel.v, sizeof(float) * 4);
+#endif
+}
+
+static inline mipPixel _mipMulAdd(mipPixel acc, float weight, mipPixel pixel)
+{
+#if AS_MIPGEN_SSE2
+	return _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weight), pixel));
+#else
+	for (int c = 0; c < 4; c++)
+		acc.v[c] += weight * pixel.v[c];
+	return acc;
+#endif
+}
+
+/*Filter Kernels*/
+
+/*Each destination pixel reads a contiguous span of source pixels (edges are clamped into the span)*/
+typedef struct {
+	uint32_t* pFirst;
+	uint32_t* pCount;
+	float* pWeights; /*maxTaps per destination pixel*/
+	uint32_t maxTaps;
+} mipKernel;
+
+static float _mipBessel0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 20; k++)
+	{
+		const float half = x / (2.0f * (float)k);
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+static float _mipKaiser(float t)
+{
+	const float pi = 3.14159265358979f;
+	if (fabsf(t) >= MIPGEN_KAISER_WIDTH)
+		return 0.0f;
+	const float x = t / MIPGEN_KAISER_WIDTH;
+	const float window = _mipBessel0(MIPGEN_KAISER_ALPHA * sqrtf(1.0f - x * x)) / _mipBessel0(MIPGEN_KAISER_ALPHA);
+	const float sinc = fabsf(t) < 1e-5f ? 1.0f : sinf(pi * t) / (pi * t);
+	return sinc * window;
+}
+
+static void _mipFreeKernel(mipKernel* pKernel)
+{
+	asFree(pKernel->pFirst);
+	asFree(pKernel->pCount);
+	asFree(pKernel->pWeights);
+	memset(pKernel, 0, sizeof(mipKernel));
+}
+
+static asResults _mipBuildKernel(asMipFilter filter, uint32_t srcSize, uint32_t dstSize, mipKernel* pOut)
+{
+	const float scale = (float)srcSize / (float)dstSize;
+	const float radius = filter == AS_MIPFILTER_KAISER ? scale * MIPGEN_KAISER_WIDTH : scale * 0.5f;
+	pOut->maxTaps = (uint32_t)ceilf(radius * 2.0f) + 2;
+	pOut->pFirst = asMalloc(sizeof(uint32_t) * dstSize);
+	pOut->pCount = asMalloc(sizeof(uint32_t) * dstSize);
+	pOut->pWeights = asMalloc(sizeof(float) * dstSize * pOut->maxTaps);
+	if (!pOut->pFirst || !pOut->pCount || !pOut->pWeights)
+	{
+		_mipFreeKernel(pOut);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	for (uint32_t d = 0; d < dstSize; d++)
+	{
+		const float center = ((float)d + 0.5f) * scale;
+		const int32_t lo = (int32_t)floorf(center - radius);
+		const int32_t hi = (int32_t)ceilf(center + radius);
+		const int32_t first = lo > 0 ? lo : 0;
+		const int32_t last = hi - 1 < (int32_t)srcSize - 1 ? hi - 1 : (int32_t)srcSize - 1;
+		float* pWeights = &pOut->pWeights[d * pOut->maxTaps];
+		memset(pWeights, 0, sizeof(float) * pOut->maxTaps);
+		float total = 0.0f;
+		for (int32_t i = lo; i < hi; i++)
+		{
+			float weight;
+			if (filter == AS_MIPFILTER_KAISER)
+			{
+				weight = _mipKaiser(((float)i + 0.5f - center) / scale);
+			}
+			else
+			{
+				const float start = (float)i > center - radius ? (float)i : center - radius;
+				const float end = (float)(i + 1) < center + radius ? (float)(i + 1) : center + radius;
+				weight = end > start ? end - start : 0.0f;
+			}
+			const int32_t clamped = i < first ? first : (i > last ? last : i);
+			pWeights[clamped - first] += weight;
+			total += weight;
+		}
+		for (int32_t i = 0; i <= last - first; i++)
+			pWeights[i] /= total;
+		pOut->pFirst[d] = (uint32_t)first;
+		pOut->pCount[d] = (uint32_t)(last - first + 1);
+	}
+	return AS_SUCCESS;
+}
+
+/*Levels*/
+
+typedef struct {
+	const asMipGenDesc_t* pDesc;
+	/*Source is either the 8 bit top level or the previous 16 bit linear level*/
+	const uint8_t* pSrc8;
+	const uint16_t* pSrc16;
+	uint32_t srcWidth;
+	uint32_t srcHeight;
+	const float* pDecode8; /*8 bit color to linear*/
+	mipKernel horizontal;
+	mipKernel vertical;
+	/*Filtered level in 16 bit linear*/
+	uint16_t* pDst16;
+	uint32_t dstWidth;
+	uint32_t dstHeight;
+	/*Final 8 bit level*/
+	uint8_t* pDst8;
+	const uint8_t* pEncode16; /*16 bit linear color to 8 bit*/
+	float alphaScale;
+	asResults result;
+} mipLevel;
+
+typedef struct {
+	mipLevel* pLevel;
+	uint32_t firstRow;
+	uint32_t rowCount;
+} mipBand;
+
+static void _mipDecodeRow(const mipLevel* pLevel, uint32_t row, float* pOut)
+{
+	if (pLevel->pSrc8)
+	{
+		const uint8_t* pSrc = pLevel->pSrc8 + (size_t)row * pLevel->srcWidth * 4;
+		for (uint32_t x = 0; x < pLevel->srcWidth; x++)
+		{
+			pOut[x * 4 + 0] = pLevel->pDecode8[pSrc[x * 4 + 0]];
+			pOut[x * 4 + 1] = pLevel->pDecode8[pSrc[x * 4 + 1]];
+			pOut[x * 4 + 2] = pLevel->pDecode8[pSrc[x * 4 + 2]];
+			pOut[x * 4 + 3] = (float)pSrc[x * 4 + 3] * (1.0f / 255.0f);
+		}
+		return;
+	}
+	const uint16_t* pSrc = pLevel->pSrc16 + (size_t)row * pLevel->srcWidth * 4;
+#if AS_MIPGEN_SSE2
+	const __m128 normalize = _mm_set1_ps(1.0f / MIPGEN_LINEAR_MAX);
+	for (uint32_t x = 0; x < pLevel->srcWidth; x++)
+	{
+		const __m128i packed = _mm_loadl_epi64((const __m128i*)(pSrc + x * 4));
+		const __m128 values = _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+		_mm_storeu_ps(pOut + x * 4, _mm_mul_ps(values, normalize));
+	}
+#else
+	for (uint32_t i = 0; i < pLevel->srcWidth * 4; i++)
+		pOut[i] = (float)pSrc[i] * (1.0f / MIPGEN_LINEAR_MAX);
+#endif
+}
+
+static void _mipFilterRow(const mipKernel* pKernel, const float* pSrc, uint32_t dstWidth, float* pOut)
+{
+	for (uint32_t x = 0; x < dstWidth; x++)
+	{
+		const float* pWeights = &pKernel->pWeights[x * pKernel->maxTaps];
+		const float* pTaps = pSrc + (size_t)pKernel->pFirst[x] * 4;
+		mipPixel acc = _mipZero();
+		for (uint32_t t = 0; t < pKernel->pCount[x]; t++)
+			acc = _mipMulAdd(acc, pWeights[t], _mipLoad(pTaps + t * 4));
+		_mipStore(pOut + x * 4, acc);
+	}
+}
+
+static void _mipStoreRow(const mipLevel* pLevel, float* pRow, uint16_t* pOut)
+{
+	const bool normalMap = pLevel->pDesc->flags & AS_MIPGEN_FLAG_NORMALMAP;
+	for (uint32_t x = 0; x < pLevel->dstWidth; x++)
+	{
+		float* pPixel = pRow + x * 4;
+		if (normalMap)
+		{
+			float n[3] = { pPixel[0] * 2.0f - 1.0f, pPixel[1] * 2.0f - 1.0f, pPixel[2] * 2.0f - 1.0f };
+			const float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length > 1e-6f)
+			{
+				for (int c = 0; c < 3; c++)
+					pPixel[c] = n[c] / length * 0.5f + 0.5f;
+			}
+		}
+		for (int c = 0; c < 4; c++)
+		{
+			const float v = pPixel[c] < 0.0f ? 0.0f : (pPixel[c] > 1.0f ? 1.0f : pPixel[c]);
+			pOut[x * 4 + c] = (uint16_t)(v * MIPGEN_LINEAR_MAX + 0.5f);
+		}
+	}
+}
+
+/*Filter a band of destination rows into the 16 bit level*/
+static void _mipFilterBand(void* pUserData)
+{
+	const mipBand* pBand = (const mipBand*)pUserData;
+	mipLevel* pLevel = pBand->pLevel;
+	const mipKernel* pVertical = &pLevel->vertical;
+	const uint32_t lastRow = pBand->firstRow + pBand->rowCount - 1;
+	const uint32_t srcFirst = pVertical->pFirst[pBand->firstRow];
+	const uint32_t srcCount = pVertical->pFirst[lastRow] + pVertical->pCount[lastRow] - srcFirst;
+
+	/*Horizontally filter every source row the band touches, then filter those vertically*/
+	float* pDecoded = asMalloc(sizeof(float) * 4 * pLevel->srcWidth);
+	float* pRows = asMalloc(sizeof(float) * 4 * pLevel->dstWidth * srcCount);
+	float* pAcc = asMalloc(sizeof(float) * 4 * pLevel->dstWidth);
+	if (!pDecoded || !pRows || !pAcc)
+	{
+		pLevel->result = AS_FAILURE_OUT_OF_MEMORY;
+		asFree(pDecoded);
+		asFree(pRows);
+		asFree(pAcc);
+		return;
+	}
+	for (uint32_t i = 0; i < srcCount; i++)
+	{
+		_mipDecodeRow(pLevel, srcFirst + i, pDecoded);
+		_mipFilterRow(&pLevel->horizontal, pDecoded, pLevel->dstWidth, pRows + (size_t)i * pLevel->dstWidth * 4);
+	}
+	for (uint32_t y = pBand->firstRow; y <= lastRow; y++)
+	{
+		const float* pWeights = &pVertical->pWeights[y * pVertical->maxTaps];
+		for (uint32_t x = 0; x < pLevel->dstWidth; x++)
+			_mipStore(pAcc + x * 4, _mipZero());
+		for (uint32_t t = 0; t < pVertical->pCount[y]; t++)
+		{
+			const float* pRow = pRows + (size_t)(pVertical->pFirst[y] + t - srcFirst) * pLevel->dstWidth * 4;
+			for (uint32_t x = 0; x < pLevel->dstWidth; x++)
+				_mipStore(pAcc + x * 4, _mipMulAdd(_mipLoad(pAcc + x * 4), pWeights[t], _mipLoad(pRow + x * 4)));
+		}
+		_mipStoreRow(pLevel, pAcc, pLevel->pDst16 + (size_t)y * pLevel->dstWidth * 4);
+	}
+	asFree(pDecoded);
+	asFree(pRows);
+	asFree(pAcc);
+}
+
+/*Convert a band of the 16 bit level into the 8 bit output*/
+static void _mipQuantizeBand(void* pUserData)
+{
+	const mipBand* pBand = (const mipBand*)pUserData;
+	const mipLevel* pLevel = pBand->pLevel;
+	const size_t start = (size_t)pBand->firstRow * pLevel->dstWidth * 4;
+	const size_t end = start + (size_t)pBand->rowCount * pLevel->dstWidth * 4;
+	for (size_t i = start; i < end; i += 4)
+	{
+		pLevel->pDst8[i + 0] = pLevel->pEncode16[pLevel->pDst16[i + 0]];
+		pLevel->pDst8[i + 1] = pLevel->pEncode16[pLevel->pDst16[i + 1]];
+		pLevel->pDst8[i + 2] = pLevel->pEncode16[pLevel->pDst16[i + 2]];
+		const float alpha = (float)pLevel->pDst16[i + 3] * pLevel->alphaScale * (255.0f / MIPGEN_LINEAR_MAX);
+		pLevel->pDst8[i + 3] = (uint8_t)(alpha > 255.0f ? 255.0f : alpha + 0.5f);
+	}
+}
+
+static asResults _mipRunBands(mipLevel* pLevel, asJobEntryFunc fpBand)
+{
+	const uint32_t workers = (uint32_t)asJobSystem_GetWorkerCount() + 1;
+	uint32_t rowsPerBand = pLevel->dstHeight / (workers * 4);
+	if (rowsPerBand < MIPGEN_MIN_BAND_ROWS) { rowsPerBand = MIPGEN_MIN_BAND_ROWS; }
+	const uint32_t bandCount = (pLevel->dstHeight + rowsPerBand - 1) / rowsPerBand;
+
+	mipBand* pBands = asMalloc(sizeof(mipBand) * bandCount);
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * bandCount);
+	if (!pBands || !pJobs)
+	{
+		asFree(pBands);
+		asFree(pJobs);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < bandCount; i++)
+	{
+		pBands[i].pLevel = pLevel;
+		pBands[i].firstRow = i * rowsPerBand;
+		pBands[i].rowCount = pBands[i].firstRow + rowsPerBand > pLevel->dstHeight ? pLevel->dstHeight - pBands[i].firstRow : rowsPerBand;
+		pJobs[i].fpEntry = fpBand;
+		pJobs[i].pUserData = &pBands[i];
+	}
+
+	asJobCounter counter;
+	asResults result = asJobSystem_CreateCounter(&counter);
+	if (result == AS_SUCCESS)
+	{
+		result = asJobSystem_Dispatch(pJobs, bandCount, counter);
+		asJobSystem_WaitForCounter(counter);
+		asJobSystem_ReleaseCounter(counter);
+	}
+	asFree(pJobs);
+	asFree(pBands);
+	return result != AS_SUCCESS ? result : pLevel->result;
+}
+
+/*Alpha Coverage*/
+
+static float _mipCoverage8(const uint8_t* pRGBA, size_t pixelCount, float cutoff)
+{
+	size_t passed = 0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		if ((float)pRGBA[i * 4 + 3] * (1.0f / 255.0f) > cutoff)
+			passed++;
+	}
+	return (float)passed / (float)pixelCount;
+}
+
+static float _mipScaledCoverage(const uint32_t* pAtOrAbove, size_t pixelCount, float cutoff, float scale)
+{
+	/*Passes once the rounded 8 bit alpha is above the cutoff*/
+	const float passing = floorf(cutoff * 255.0f) + 1.0f;
+	if (passing > 255.0f || scale <= 0.0f)
+		return 0.0f;
+	const float threshold = ceilf((passing - 0.5f) * MIPGEN_LINEAR_MAX / (255.0f * scale));
+	if (threshold > MIPGEN_LINEAR_MAX)
+		return 0.0f;
+	return (float)pAtOrAbove[(uint32_t)threshold] / (float)pixelCount;
+}
+
+/*Find the alpha scale that gets closest to the target coverage*/
+static float _mipCoverageScale(const uint16_t* pRGBA, size_t pixelCount, float cutoff, float targetCoverage, uint32_t* pHistogram)
+{
+	/*Count of pixels at or above each alpha*/
+	memset(pHistogram, 0, sizeof(uint32_t) * 65536);
+	for (size_t i = 0; i < pixelCount; i++)
+		pHistogram[pRGBA[i * 4 + 3]]++;
+	for (int32_t i = 65534; i >= 0; i--)
+		pHistogram[i] += pHistogram[i + 1];
+
+	/*Coverage only steps up with the scale, search for the step that crosses the target*/
+	float lo = 0.0f;
+	float hi = 4.0f;
+	for (int iter = 0; iter < 20; iter++)
+	{
+		const float scale = (lo + hi) * 0.5f;
+		if (_mipScaledCoverage(pHistogram, pixelCount, cutoff, scale) < targetCoverage)
+			lo = scale;
+		else
+			hi = scale;
+	}
+	const float loError = targetCoverage - _mipScaledCoverage(pHistogram, pixelCount, cutoff, lo);
+	const float hiError = _mipScaledCoverage(pHistogram, pixelCount, cutoff, hi) - targetCoverage;
+	return loError < hiError ? lo : hi;
+}
+
+/*Interface*/
+
+ASEXPORT asMipGenDesc_t asMipGenDesc_Init()
+{
+	asMipGenDesc_t result = (asMipGenDesc_t) { 0 };
+	result.filter = AS_MIPFILTER_BOX;
+	result.flags = AS_MIPGEN_FLAG_SRGB;
+	result.alphaCutoff = 0.5f;
+	return result;
+}
+
+ASEXPORT uint32_t asMipGen_GetMipCount(uint32_t width, uint32_t height, uint32_t maxMips)
+{
+	uint32_t count = 1;
+	while ((width > 1 || height > 1) && count < AS_TEXTURE_MAX_REGIONS && (!maxMips || count < maxMips))
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		count++;
+	}
+	return count;
+}
+
+ASEXPORT size_t asMipGen_GetChainSize(uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	size_t size = 0;
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		size += (size_t)width * height * 4;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return size;
+}
+
+ASEXPORT asResults asMipGen_GenerateRGBA8(const asMipGenDesc_t* pDesc, const uint8_t* pRGBA, uint32_t width, uint32_t height, uint8_t* pDst, asTextureDesc_t* pTexture)
+{
+	if (!pDesc || !pRGBA || !pDst || !pTexture || !width || !height) { return AS_FAILURE_INVALID_PARAM; }
+	const uint32_t mipCount = asMipGen_GetMipCount(width, height, pDesc->maxMips);
+
+	/*Regions are packed one after another*/
+	pTexture->type = AS_TEXTURETYPE_2D;
+	pTexture->format = AS_COLORFORMAT_RGBA8_UNORM;
+	pTexture->width = width;
+	pTexture->height = height;
+	pTexture->depth = 1;
+	pTexture->mips = mipCount;
+	pTexture->initialContentsRegionCount = mipCount;
+	pTexture->pInitialContentsRegions = NULL;
+	pTexture->pInitialContentsBuffer = pDst;
+	pTexture->initialContentsBufferSize = asMipGen_GetChainSize(width, height, mipCount);
+	size_t offset = 0;
+	for (uint32_t i = 0, w = width, h = height; i < mipCount; i++)
+	{
+		asTextureContentRegion_t* pRegion = &pTexture->arrInitialContentsRegions[i];
+		memset(pRegion, 0, sizeof(asTextureContentRegion_t));
+		pRegion->bufferStart = offset;
+		pRegion->bufferSize = w * h * 4;
+		pRegion->extent[0] = w;
+		pRegion->extent[1] = h;
+		pRegion->extent[2] = 1;
+		pRegion->mipLevel = i;
+		pRegion->layerCount = 1;
+		offset += pRegion->bufferSize;
+		w = w > 1 ? w / 2 : 1;
+		h = h > 1 ? h / 2 : 1;
+	}
+	memcpy(pDst, pRGBA, (size_t)width * height * 4);
+	if (mipCount == 1)
+		return AS_SUCCESS;
+
+	/*Lookup tables between the stored and linear values of the color channels*/
+	const bool srgb = (pDesc->flags & AS_MIPGEN_FLAG_SRGB) && !(pDesc->flags & AS_MIPGEN_FLAG_NORMALMAP);
+	const uint32_t levelSize = (width > 1 ? width / 2 : 1) * (height > 1 ? height / 2 : 1) * 4;
+	float* pDecode8 = asMalloc(sizeof(float) * 256);
+	uint8_t* pEncode16 = asMalloc(65536);
+	uint16_t* pLevels[2] = { asMalloc(sizeof(uint16_t) * levelSize), asMalloc(sizeof(uint16_t) * levelSize) };
+	uint32_t* pHistogram = (pDesc->flags & AS_MIPGEN_FLAG_ALPHA_COVERAGE) ? asMalloc(sizeof(uint32_t) * 65536) : NULL;
+	if (!pDecode8 || !pEncode16 || !pLevels[0] || !pLevels[1] || ((pDesc->flags & AS_MIPGEN_FLAG_ALPHA_COVERAGE) && !pHistogram))
+	{
+		asFree(pDecode8);
+		asFree(pEncode16);
+		asFree(pLevels[0]);
+		asFree(pLevels[1]);
+		asFree(pHistogram);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (int i = 0; i < 256; i++)
+	{
+		const float v = (float)i / 255.0f;
+		pDecode8[i] = srgb ? (v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f)) : v;
+	}
+	for (int i = 0; i < 65536; i++)
+	{
+		const float v = (float)i / MIPGEN_LINEAR_MAX;
+		const float encoded = srgb ? (v <= 0.0031308f ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f) : v;
+		pEncode16[i] = (uint8_t)(encoded * 255.0f + 0.5f);
+	}
+	const float targetCoverage = pHistogram ? _mipCoverage8(pRGBA, (size_t)width * height, pDesc->alphaCutoff) : 0.0f;
+
+	/*Each level is filtered from the 16 bit linear level above it*/
+	asResults result = AS_SUCCESS;
+	for (uint32_t i = 1; i < mipCount && result == AS_SUCCESS; i++)
+	{
+		const asTextureContentRegion_t* pSrcRegion = &pTexture->arrInitialContentsRegions[i - 1];
+		const asTextureContentRegion_t* pRegion = &pTexture->arrInitialContentsRegions[i];
+		mipLevel level;
+		memset(&level, 0, sizeof(level));
+		level.pDesc = pDesc;
+		level.pSrc8 = i == 1 ? pRGBA : NULL;
+		level.pSrc16 = i == 1 ? NULL : pLevels[i % 2];
+		level.srcWidth = pSrcRegion->extent[0];
+		level.srcHeight = pSrcRegion->extent[1];
+		level.pDecode8 = pDecode8;
+		level.pDst16 = pLevels[(i + 1) % 2];
+		level.dstWidth = pRegion->extent[0];
+		level.dstHeight = pRegion->extent[1];
+		level.pDst8 = pDst + pRegion->bufferStart;
+		level.pEncode16 = pEncode16;
+		level.alphaScale = 1.0f;
+		level.result = AS_SUCCESS;
+		result = _mipBuildKernel(pDesc->filter, level.srcWidth, level.dstWidth, &level.horizontal);
+		if (result == AS_SUCCESS)
+			result = _mipBuildKernel(pDesc->filter, level.srcHeight, level.dstHeight, &level.vertical);
+		if (result == AS_SUCCESS)
+			result = _mipRunBands(&level, _mipFilterBand);
+		if (result == AS_SUCCESS && pHistogram)
+			level.alphaScale = _mipCoverageScale(level.pDst16, (size_t)level.dstWidth * level.dstHeight, pDesc->alphaCutoff, targetCoverage, pHistogram);
+		if (result == AS_SUCCESS)
+			result = _mipRunBands(&level, _mipQuantizeBand);
+		_mipFreeKernel(&level.horizontal);
+		_mipFreeKernel(&level.vertical);
+	}
+
+	asFree(pDecode8);
+	asFree(pEncode16);
+	asFree(pLevels[0]);
+	asFree(pLevels[1]);
+	asFree(pHistogram);
+	return result;
+}
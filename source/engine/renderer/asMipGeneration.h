@@ -0,0 +1,73 @@
+#ifndef _ASMIPGENERATION_H_
+#define _ASMIPGENERATION_H_
+
+#include "../common/asCommon.h"
+#include "asRendererCore.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Mip chain generation for 8 bit RGBA images
+* Levels are filtered in linear space from the level above (kept at 16 bits between levels)
+* and split into bands of rows across the job system. Meant for cooking textures offline
+*/
+
+/**
+* @brief Downsampling filter
+*/
+typedef enum {
+	AS_MIPFILTER_BOX, /**< Average of the covered pixels (sharp and fast)*/
+	AS_MIPFILTER_KAISER, /**< Kaiser windowed sinc (less aliasing, slightly ringing)*/
+	AS_MIPFILTER_COUNT
+} asMipFilter;
+
+/**
+* @brief How the color channels are stored
+*/
+typedef enum {
+	AS_MIPGEN_FLAG_SRGB = 1 << 0, /**< Color channels are sRGB encoded, filter after decoding them (alpha is always linear)*/
+	AS_MIPGEN_FLAG_NORMALMAP = 1 << 1, /**< RGB is a unit vector packed into 0-1, renormalized after filtering (ignores sRGB)*/
+	AS_MIPGEN_FLAG_ALPHA_COVERAGE = 1 << 2, /**< Scale the alpha of each level so as many pixels pass the alpha test as in the top level*/
+} asMipGenFlags;
+
+/**
+* @brief Description for generating a mip chain
+*/
+typedef struct {
+	asMipFilter filter; /**< Downsampling filter*/
+	uint32_t flags; /**< asMipGenFlags*/
+	float alphaCutoff; /**< Alpha test reference for AS_MIPGEN_FLAG_ALPHA_COVERAGE*/
+	uint32_t maxMips; /**< Limit on the amount of levels including the top (0 for a full chain)*/
+} asMipGenDesc_t;
+
+/**
+* @brief Set the defaults for mip generation (box filtered sRGB color)
+*/
+ASEXPORT asMipGenDesc_t asMipGenDesc_Init();
+
+/**
+* @brief Amount of levels in a chain (never more than AS_TEXTURE_MAX_REGIONS)
+* @param maxMips limit on the amount of levels (0 for a full chain)
+*/
+ASEXPORT uint32_t asMipGen_GetMipCount(uint32_t width, uint32_t height, uint32_t maxMips);
+
+/**
+* @brief Size of a packed 8 bit RGBA chain
+*/
+ASEXPORT size_t asMipGen_GetChainSize(uint32_t width, uint32_t height, uint32_t mipCount);
+
+/**
+* @brief Generate a mip chain and describe it as the initial contents of an RGBA8 2D texture
+* fills out the type, format, extents, mips and a region per mip, other members are left as they are
+* @param pRGBA top level of 8 bit RGBA pixels with rows packed together (copied as is into the first region)
+* @param pDst asMipGen_GetChainSize() bytes for asMipGen_GetMipCount() levels, becomes the initial contents buffer
+* @note levels are filtered on the job system, jobs run inline if it is not running
+*/
+ASEXPORT asResults asMipGen_GenerateRGBA8(const asMipGenDesc_t* pDesc, const uint8_t* pRGBA, uint32_t width, uint32_t height, uint8_t* pDst, asTextureDesc_t* pTexture);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -4,6 +4,19 @@
 #include "vulkan/asVulkanBackend.h"
 #endif
 
+ASEXPORT bool asShaderCodePathIsOptional(const asShaderTypeRegistration* pShaderType, int32_t codePathIdx)
+{
+	for (size_t i = 0; i < pShaderType->pipelineCount; i++)
+	{
+		if (pShaderType->pipelines[i].flags & AS_PIPELINEFLAG_OPTIONAL) { continue; }
+		for (size_t j = 0; j < pShaderType->pipelines[i].codePathIdxCount; j++)
+		{
+			if (pShaderType->pipelines[i].codePathIdxs[j] == codePathIdx) { return false; }
+		}
+	}
+	return true;
+}
+
 ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx, asQualityLevel quality)
 {
 	/*Get Variant Data*/
@@ -23,6 +36,9 @@ ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx,
 	/*Create Each Pipeline*/
 	for (int i = 0; i < pShaderType->pipelineCount; i++)
 	{
+		pShaderfx->pipelines[i] = NULL;
+		const bool optional = pShaderType->pipelines[i].flags & AS_PIPELINEFLAG_OPTIONAL;
+		bool skipPipeline = false;
 #if ASTRENGINE_VK
 		int stageCount = 0;
 		VkShaderModule shaderModules[AS_SHADER_MAX_CODEPATHS];
@@ -35,6 +51,16 @@ ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx,
 		for (int j = 0; j < pShaderType->pipelines[i].codePathIdxCount; j++)
 		{
 			int32_t codePathIndex = pShaderType->pipelines[i].codePathIdxs[j];
+#if ASTRENGINE_VK
+			/*Task and mesh stages need device support*/
+			const asShaderStage stage = pShaderType->codePaths[codePathIndex].stage;
+			if ((stage == AS_SHADERSTAGE_TASK || stage == AS_SHADERSTAGE_MESH) && !asVkMeshShaderSupported)
+			{
+				if (!optional) { return AS_FAILURE_UNKNOWN_FORMAT; }
+				skipPipeline = true;
+				break;
+			}
+#endif
 			asShaderFxProgramDesc* pDesc = NULL;
 			int minQuality = -1;
 			for (int k = 0; k < codeSectionCount; k++) /*Search for Shader to Add*/
@@ -49,8 +75,12 @@ ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx,
 					minQuality = pCodeSections[k].quality;
 				}
 			}
-			if (!pDesc) { return AS_FAILURE_UNKNOWN_FORMAT; }
-			stageCount++;
+			if (!pDesc)
+			{
+				if (!optional) { return AS_FAILURE_UNKNOWN_FORMAT; }
+				skipPipeline = true;
+				break;
+			}
 #if ASTRENGINE_VK
 			/*Don't Create Redundant Copies*/
 			if (shaderModules[codePathIndex] != 0) { continue; }
@@ -64,17 +94,19 @@ ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx,
 			createInfo.pCode = pSpirv;
 			vkCreateShaderModule(asVkDevice, &createInfo, AS_VK_MEMCB, &shaderModules[codePathIndex]);
 
-			/*Describe Stage*/
-			stageCreateInfos[codePathIndex] = (VkPipelineShaderStageCreateInfo){ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
-			stageCreateInfos[codePathIndex].module = shaderModules[codePathIndex];
-			stageCreateInfos[codePathIndex].pName = pShaderType->codePaths[codePathIndex].entry;
-			stageCreateInfos[codePathIndex].stage = asVkConvertToNativeStage(pShaderType->codePaths[codePathIndex].stage);
-			stageCreateInfos[codePathIndex].pSpecializationInfo = NULL; /*Pipeline Specialization is not implimented*/
+			/*Describe Stage (packed in code path order as pipelines take a contiguous list)*/
+			stageCreateInfos[stageCount] = (VkPipelineShaderStageCreateInfo){ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+			stageCreateInfos[stageCount].module = shaderModules[codePathIndex];
+			stageCreateInfos[stageCount].pName = pShaderType->codePaths[codePathIndex].entry;
+			stageCreateInfos[stageCount].stage = asVkConvertToNativeStage(pShaderType->codePaths[codePathIndex].stage);
+			stageCreateInfos[stageCount].pSpecializationInfo = NULL; /*Pipeline Specialization is not implimented*/
+			stageCount++;
 #endif
 		}
 
 #if ASTRENGINE_VK
-		if (pShaderType->pipelines[i].type == AS_PIPELINETYPE_GRAPHICS)
+		if (skipPipeline) { asDebugLog("Optional pipeline \"%s\" of \"%s\" left out", pShaderType->pipelines[i].name, variantName); }
+		else if (pShaderType->pipelines[i].type == AS_PIPELINETYPE_GRAPHICS)
 		{
 			VkGraphicsPipelineCreateInfo gfxPipelineInfo = (VkGraphicsPipelineCreateInfo){ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
 			gfxPipelineInfo.pStages = stageCreateInfos;
@@ -108,7 +140,10 @@ ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx,
 		else { return AS_FAILURE_UNKNOWN_FORMAT; }
 
 		/*Free Shader Modules*/
-		for (int j = 0; j < pShaderType->codePathCount; j++) { vkDestroyShaderModule(asVkDevice, shaderModules[j], AS_VK_MEMCB); }
+		for (int j = 0; j < pShaderType->codePathCount; j++)
+		{
+			if (shaderModules[j] != VK_NULL_HANDLE) { vkDestroyShaderModule(asVkDevice, shaderModules[j], AS_VK_MEMCB); }
+		}
 #endif
 	}
 	return AS_SUCCESS;
@@ -23,6 +23,8 @@ typedef enum {
 	AS_SHADERSTAGE_GEOMETRY, /**< Geometry shader*/
 	AS_SHADERSTAGE_FRAGMENT, /**< Fragment shader (sometimes referred to as pixel shaders)*/
 	AS_SHADERSTAGE_COMPUTE, /**< Compute shaders*/
+	AS_SHADERSTAGE_TASK, /**< Task (amplification) shader launching mesh shader workgroups*/
+	AS_SHADERSTAGE_MESH, /**< Mesh shader outputting primitives straight to the rasterizer*/
 	AS_SHADERSTAGE_COUNT,
 	AS_SHADERSTAGE_MAX = UINT32_MAX
 } asShaderStage;
@@ -98,6 +100,14 @@ typedef asResults(*asGfxPipelineFillCb)(
 	asPipelineHandle* pOutPipeline,
 	void* pUserData);
 
+/**
+* @brief pipeline flags
+*/
+typedef enum {
+	AS_PIPELINEFLAG_OPTIONAL = 1 << 0, /**< Left NULL instead of failing when the shader has no code for it or the device can't run it*/
+	AS_PIPELINEFLAG_MAX = UINT32_MAX
+} asPipelineFlags;
+
 typedef struct {
 	const char* name;
 	asPipelineType type;
@@ -105,6 +115,7 @@ typedef struct {
 	void* pUserData;
 	size_t codePathIdxCount;
 	int32_t codePathIdxs[AS_SHADER_MAX_CODEPATHS];
+	uint32_t flags; /**< asPipelineFlags*/
 } asShaderTypePipelineVar;
 
 typedef struct {
@@ -119,9 +130,14 @@ ASEXPORT const asShaderTypeRegistration* asShaderFindTypeRegistrationByName(cons
 
 typedef struct {
 	asShaderTypeRegistration* registration;
-	asPipelineHandle pipelines[AS_SHADER_MAX_PIPELINES]; /*Must match as defined in variants*/
+	asPipelineHandle pipelines[AS_SHADER_MAX_PIPELINES]; /*Must match as defined in variants (NULL for missing optional pipelines)*/
 } asShaderFx;
 
+/**
+* @brief Whether a code path is only used by optional pipelines (the shader may leave it out)
+*/
+ASEXPORT bool asShaderCodePathIsOptional(const asShaderTypeRegistration* pShaderType, int32_t codePathIdx);
+
 ASEXPORT asResults asCreateShaderFx(asBinReader* pAsbin, asShaderFx* pShaderfx, asQualityLevel minQuality);
 
 ASEXPORT void asFreeShaderFx(asShaderFx* pShaderfx);
@@ -16,6 +16,7 @@
 
 #include "../common/preferences/asPreferences.h"
 #include "asBindlessTexturePool.h"
+#include "asTextureStreamer.h"
 
 #include "asSceneRenderer.h"
 
@@ -81,6 +82,94 @@ ASEXPORT uint32_t asTextureCalcPitch(asColorFormat format, uint32_t width)
 
 /*Texture*/
 
+/*Copies into images must start on a multiple of 4 and of the texel block size*/
+static size_t _textureUploadAlignment(asColorFormat format)
+{
+	switch (format)
+	{
+	case AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK:
+	case AS_COLORFORMAT_RGBA16_UNORM:
+	case AS_COLORFORMAT_RGBA16_UINT:
+	case AS_COLORFORMAT_RGBA16_SFLOAT:
+		return 8;
+	case AS_COLORFORMAT_BC3_UNORM_BLOCK:
+	case AS_COLORFORMAT_BC5_UNORM_BLOCK:
+	case AS_COLORFORMAT_BC6H_UFLOAT_BLOCK:
+	case AS_COLORFORMAT_BC7_UNORM_BLOCK:
+	case AS_COLORFORMAT_RGBA32_SFLOAT:
+	case AS_COLORFORMAT_RGBA32_UINT:
+		return 16;
+	case AS_COLORFORMAT_RGB16_SFLOAT:
+	case AS_COLORFORMAT_RGB32_SFLOAT:
+		return 12;
+	default:
+		return 4;
+	}
+}
+
+static const asTextureContentRegion_t* _textureSizedRegions(const asTextureDesc_t* pDesc)
+{
+	const asTextureContentRegion_t* pRegions = pDesc->pInitialContentsRegions ?
+		pDesc->pInitialContentsRegions : pDesc->arrInitialContentsRegions;
+	if (!pDesc->initialContentsRegionCount)
+		return NULL;
+	for (size_t i = 0; i < pDesc->initialContentsRegionCount; i++)
+	{
+		if (!pRegions[i].bufferSize)
+			return NULL;
+	}
+	return pRegions;
+}
+
+ASEXPORT size_t asTextureDesc_GetUploadSize(const asTextureDesc_t* pDesc)
+{
+	const asTextureContentRegion_t* pRegions = _textureSizedRegions(pDesc);
+	if (!pRegions)
+		return pDesc->initialContentsBufferSize;
+	const size_t alignment = _textureUploadAlignment(pDesc->format);
+	size_t offset = 0;
+	for (size_t i = 0; i < pDesc->initialContentsRegionCount; i++)
+		offset = ((offset + alignment - 1) / alignment) * alignment + pRegions[i].bufferSize;
+	return offset;
+}
+
+ASEXPORT asResults asTextureDesc_WriteUpload(const asTextureDesc_t* pDesc, void* pDst, asTextureContentRegion_t* pOutRegions)
+{
+	const asTextureContentRegion_t* pRegions = _textureSizedRegions(pDesc);
+	if (!pRegions)
+	{
+		/*Unknown region sizes, upload the buffer as is*/
+		if (!pDesc->pInitialContentsBuffer)
+			return AS_FAILURE_INVALID_PARAM;
+		memcpy(pDst, pDesc->pInitialContentsBuffer, pDesc->initialContentsBufferSize);
+		memcpy(pOutRegions, pDesc->pInitialContentsRegions ? pDesc->pInitialContentsRegions : pDesc->arrInitialContentsRegions,
+			sizeof(asTextureContentRegion_t) * pDesc->initialContentsRegionCount);
+		return AS_SUCCESS;
+	}
+
+	/*Pack only the region data (skips any headers or padding in the source)*/
+	const size_t alignment = _textureUploadAlignment(pDesc->format);
+	size_t offset = 0;
+	for (size_t i = 0; i < pDesc->initialContentsRegionCount; i++)
+	{
+		offset = ((offset + alignment - 1) / alignment) * alignment;
+		pOutRegions[i] = pRegions[i];
+		pOutRegions[i].bufferStart = offset;
+		if (pDesc->pfnWriteInitialContents)
+		{
+			asResults result = pDesc->pfnWriteInitialContents((unsigned char*)pDst + offset, &pRegions[i], pDesc->pWriteInitialContentsUserData);
+			if (result != AS_SUCCESS)
+				return result;
+		}
+		else
+		{
+			memcpy((unsigned char*)pDst + offset, (const unsigned char*)pDesc->pInitialContentsBuffer + pRegions[i].bufferStart, pRegions[i].bufferSize);
+		}
+		offset += pRegions[i].bufferSize;
+	}
+	return AS_SUCCESS;
+}
+
 ASEXPORT asTextureDesc_t asTextureDesc_Init()
 {
 	asTextureDesc_t result = (asTextureDesc_t) { 0 };
@@ -108,6 +197,7 @@ static int32_t gfxSettingsWinMode = 0;
 static int32_t gfxSettingsWinWidth = 1280;
 static int32_t gfxSettingsWinHeight = 720;
 static int32_t gfxSettingsDevice = -1;
+static int32_t gfxSettingsShowMemory = 0;
 
 void* gpCustomWindow;
 asAppInfo_t* gpAppInfo;
@@ -162,9 +252,8 @@ asResourceType_t shaderFxResourceType;
 ASEXPORT asShaderFx* asShaderFxManagerGetShaderFx(asResourceFileID_t resourceFileId)
 {
 	/*Get Existing*/
-	asResourceDataMapping_t dataMap = asResource_GetExistingDataMapping(resourceFileId, shaderFxResourceType);
+	asResourceDataMapping_t dataMap = asResource_AcquireExistingDataMapping(resourceFileId, shaderFxResourceType, 1);
 	if (dataMap.ptr != NULL) {
-		asResource_IncrimentReferences(resourceFileId, 1);
 		return dataMap.ptr;
 	}
 
@@ -196,7 +285,7 @@ ASEXPORT asShaderFx* asShaderFxManagerGetShaderFx(asResourceFileID_t resourceFil
 
 	/*Create Mappings*/
 	dataMap.ptr = pFx;
-	asResource_Create(resourceFileId, dataMap, shaderFxResourceType, 1);
+	asResource_CreateSized(resourceFileId, dataMap, shaderFxResourceType, 1, sizeof(asShaderFx) + fileSize);
 	return pFx;
 }
 
@@ -208,6 +297,7 @@ ASEXPORT void asShaderFxManagerDereferenceShaderFx(asResourceFileID_t resourceFi
 void _ShaderFxManagerInit()
 {
 	shaderFxResourceType = asResource_RegisterType("ASFX", 4);
+	asResource_SetCacheBudget(shaderFxResourceType, 16 * 1024 * 1024);
 }
 
 void _ShaderFxGC()
@@ -219,7 +309,7 @@ void _ShaderFxGC()
 	{
 		for (size_t i = 0; i < count; i++)
 		{
-			asFreeShaderFx(pToDelete->ptr);
+			asFreeShaderFx(pToDelete[i].ptr);
 		}
 	}
 	asResource_ClearDeletionQueue(shaderFxResourceType);
@@ -250,6 +340,8 @@ ASEXPORT void asInitGfx(asAppInfo_t *pAppInfo, void* pCustomWindow)
 		"Window height");
 	asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "deviceIndex", &gfxSettingsDevice, -1, 64, true, NULL, NULL,
 		"Render device index (GPU) (-1: Autoselect)");
+	asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "debugGpuMemory", &gfxSettingsShowMemory, 0, 1, false, NULL, NULL,
+		"Show GPU memory heaps and the largest consumers");
 	asPreferencesRegisterNullFunction(asGetGlobalPrefs(), "applySettings", _applySettings, NULL,
 		"Reinitialize the implimentations as necessary for Settings");
 	asPreferencesLoadSection(asGetGlobalPrefs(), "gfx");
@@ -261,6 +353,7 @@ ASEXPORT void asInitGfx(asAppInfo_t *pAppInfo, void* pCustomWindow)
 #endif
 	_ShaderFxManagerInit();
 	asInitTexturePool();
+	asInitTextureStreamer();
 	asInitSceneRenderer();
 }
 
@@ -281,9 +374,52 @@ ASEXPORT void asGfxTriggerResizeEvent()
 	asTriggerResizeSceneRenderer();
 }
 
+#define AS_GPU_MEMORY_DEBUG_CONSUMERS 16
+
+void _asGpuMemoryDebug()
+{
+	if (!gfxSettingsShowMemory) { return; }
+#if ASTRENGINE_DEARIMGUI
+	if (igBegin("GPU Memory", NULL, ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		asGpuMemoryStats_t stats;
+		asGetGpuMemoryStats(&stats);
+		igText("Budget: %s", stats.driverBudget ? "Driver" : "Estimated");
+		for (uint32_t i = 0; i < stats.heapCount; i++)
+		{
+			const asGpuMemoryHeapStats_t* pHeap = &stats.heaps[i];
+			char overlay[64];
+			snprintf(overlay, 64, "%.1f / %.1f MB",
+				(double)pHeap->usage / (1024.0 * 1024.0), (double)pHeap->budget / (1024.0 * 1024.0));
+			igSeparator();
+			igText("Heap %u (%s) %.1f MB", i, pHeap->deviceLocal ? "Device" : "Host", (double)pHeap->size / (1024.0 * 1024.0));
+			igProgressBar(pHeap->budget ? (float)pHeap->usage / (float)pHeap->budget : 0.0f, (ImVec2) { 256.0f, 0.0f }, overlay);
+			igText("Engine: %.1f MB in %u allocations", (double)pHeap->allocatedBytes / (1024.0 * 1024.0), pHeap->allocationCount);
+		}
+		igSeparator();
+		asGpuMemoryConsumer_t consumers[AS_GPU_MEMORY_DEBUG_CONSUMERS];
+		const size_t consumerCount = asGetGpuMemoryConsumers(consumers, AS_GPU_MEMORY_DEBUG_CONSUMERS);
+		igText("Largest Consumers");
+		igColumns(3, "consumers", true);
+		for (size_t i = 0; i < consumerCount; i++)
+		{
+			igText("%s", consumers[i].pLabel);
+			igNextColumn();
+			igText("%.2f MB", (double)consumers[i].bytes / (1024.0 * 1024.0));
+			igNextColumn();
+			igText("%u", consumers[i].count);
+			igNextColumn();
+		}
+		igColumns(1, NULL, false);
+	}
+	igEnd();
+#endif
+}
+
 ASEXPORT void asGfxInternalDebugDraws()
 {
 	_asTexturePoolDebug();
+	_asGpuMemoryDebug();
 	asSceneRendererUploadDebugDraws(0);
 }
 
@@ -302,6 +438,7 @@ ASEXPORT void asGfxRenderFrame()
 #if ASTRENGINE_VK
 	asVkInitFrame();
 #endif
+	asTextureStreamerUpdate();
 	asTexturePoolUpdate();
 	asSceneRendererDraw(0);
 #if ASTRENGINE_NUKLEAR
@@ -327,7 +464,9 @@ ASEXPORT void asShutdownGfx()
 #if ASTRENGINE_DEARIMGUI
 	asShutdownGfxImGui();
 #endif
+	asShutdownTextureStreamer();
 	asShutdownTexturePool();
+	asResource_FlushCache(shaderFxResourceType);
 	_ShaderFxGC();
 #if ASTRENGINE_VK
 	asVkFinalShutdown();
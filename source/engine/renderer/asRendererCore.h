@@ -137,6 +137,7 @@ typedef enum {
 	AS_TEXTUREUSAGE_SAMPLED = 1 << 2,
 	AS_TEXTUREUSAGE_RENDERTARGET = 1 << 3,
 	AS_TEXTUREUSAGE_DEPTHBUFFER = 1 << 4,
+	AS_TEXTUREUSAGE_STORAGE = 1 << 5, /**< Written by compute shaders as a storage image*/
 	AS_TEXTUREUSAGE_MAX = UINT32_MAX
 } asTextureUsageFlags;
 
@@ -155,12 +156,13 @@ typedef enum {
 * @brief Specifies a region of content in an image
 */
 typedef struct {
-	uint32_t bufferStart; /**< Starting position of this region in the buffer*/
+	uint64_t bufferStart; /**< Starting position of this region in the buffer (64 bit like VkDeviceSize, packed uploads may pass 4GB)*/
 	uint32_t offset[3]; /**< UVW Offset of the region in pixels*/
 	uint32_t extent[3]; /**< UVW Extent of the region in pixels*/
 	uint32_t mipLevel; /**< Which mip level this region belongs to*/
 	uint32_t layer; /**< Which layer this region belongs to*/
 	uint32_t layerCount; /**< How many layers this region has in it*/
+	uint32_t bufferSize; /**< Size of this region in the buffer (0 if unknown, the whole buffer is then uploaded as is)*/
 } asTextureContentRegion_t;
 
 #define AS_TEXTURE_MAX_REGIONS 16
@@ -183,6 +185,8 @@ typedef struct {
 	asTextureContentRegion_t* pInitialContentsRegions; /**< Used to map buffer data to parts of the texture image (if NULL look into asTextureDesc_t::arrInitialContentsRegions)*/
 	asTextureContentRegion_t arrInitialContentsRegions[AS_TEXTURE_MAX_REGIONS]; /**< Used to map buffer data to parts of the texture image (if NULL same above)*/
 	const char* pDebugLabel; /**< Debug name of the texture that should appear in debuggers*/
+	asResults (*pfnWriteInitialContents)(void* pDst, const asTextureContentRegion_t* pRegion, void* pUserData); /**< Optional, writes each region straight into upload memory instead of copying from the buffer (every region needs a bufferSize)*/
+	void* pWriteInitialContentsUserData; /**< Passed to asTextureDesc_t::pfnWriteInitialContents*/
 } asTextureDesc_t;
 
 /**
@@ -190,6 +194,18 @@ typedef struct {
 */
 ASEXPORT asTextureDesc_t asTextureDesc_Init();
 
+/**
+* @brief Get the size of upload (staging) memory needed for the initial contents of a texture
+* regions with a bufferSize are packed at the alignment copies require, otherwise the whole buffer is used
+*/
+ASEXPORT size_t asTextureDesc_GetUploadSize(const asTextureDesc_t* pDesc);
+
+/**
+* @brief Write the initial contents of a texture into upload memory (usually a mapped staging buffer)
+* @param pOutRegions filled with the regions relative to pDst (needs room for asTextureDesc_t::initialContentsRegionCount)
+*/
+ASEXPORT asResults asTextureDesc_WriteUpload(const asTextureDesc_t* pDesc, void* pDst, asTextureContentRegion_t* pOutRegions);
+
 /**
 * @brief Calculate the pitch of a texture
 */
@@ -211,6 +227,16 @@ typedef asHandle_t asTextureHandle_t;
 */
 ASEXPORT asTextureHandle_t asCreateTexture(asTextureDesc_t *pDesc);
 
+/**
+* @brief Create many textures at once
+* device textures share pooled memory (released textures give their space back to later batches) and their initial contents are packed into one staging buffer,
+* copied with a single transfer queue submission (split into a few when the staging memory fills up)
+* @param pOutHandles filled with a handle for each description
+* textures whose initial contents fail to write get an invalid handle (the rest are still created) and the failure is returned
+* @warning not guaranteed to be threadsafe
+*/
+ASEXPORT asResults asCreateTextures(asTextureDesc_t* pDescs, size_t count, asTextureHandle_t* pOutHandles);
+
 /**
 * @brief API independent mechanism for releasing texture resources
 * @warning not guaranteed to be immideate/threadsafe
@@ -220,7 +246,7 @@ ASEXPORT void asReleaseTexture(asTextureHandle_t hndl);
 /**
 * @brief Maximum number of textures
 */
-#define AS_MAX_TEXTURES 1024
+#define AS_MAX_TEXTURES 65536
 
 /*Buffers*/
 
@@ -266,6 +292,24 @@ typedef asHandle_t asBufferHandle_t;
 */
 ASEXPORT asBufferHandle_t asCreateBuffer(asBufferDesc_t *pDesc);
 
+/**
+* @brief A range of a buffer to write
+*/
+typedef struct {
+	asBufferHandle_t buffer;
+	size_t dstOffset; /**< Bytes into the buffer*/
+	size_t size; /**< Bytes to write*/
+	const void* pData;
+} asBufferUploadRegion_t;
+
+/**
+* @brief Write ranges of existing buffers, regions of device buffers are copied through a single staging buffer and submission
+* (device buffers need AS_BUFFERUSAGE_TRANSFER_DST)
+* @return AS_FAILURE_OUT_OF_BOUNDS if a region is past the end of its buffer
+* @warning waits for the copy to finish, not guaranteed to be threadsafe
+*/
+ASEXPORT asResults asUploadBufferRegions(const asBufferUploadRegion_t* pRegions, size_t count);
+
 /**
 * @brief API independent mechanism for releasing buffer resources
 * @warning not guaranteed to be immideate/threadsafe
@@ -277,6 +321,61 @@ ASEXPORT void asReleaseBuffer(asBufferHandle_t hndl);
 */
 #define AS_MAX_BUFFERS 2048
 
+/*Memory Statistics*/
+
+/**
+* @brief Maximum number of memory heaps reported
+*/
+#define AS_GPU_MAX_MEMORY_HEAPS 16
+
+/**
+* @brief Usage of a GPU memory heap
+*/
+typedef struct {
+	uint64_t size; /**< Total size of the heap*/
+	uint64_t budget; /**< Bytes the application can use before the driver starts paging (estimated from the size without driver support)*/
+	uint64_t usage; /**< Bytes the application uses in the heap (only the engine's own allocations without driver support)*/
+	uint64_t allocatedBytes; /**< Bytes the engine allocated from the heap*/
+	uint32_t allocationCount; /**< Number of allocations the engine made from the heap*/
+	bool deviceLocal; /**< Heap is video memory*/
+} asGpuMemoryHeapStats_t;
+
+/**
+* @brief Usage of every GPU memory heap (updated at the start of every frame)
+*/
+typedef struct {
+	uint32_t heapCount;
+	bool driverBudget; /**< Budgets and usage come from the driver*/
+	asGpuMemoryHeapStats_t heaps[AS_GPU_MAX_MEMORY_HEAPS];
+} asGpuMemoryStats_t;
+
+/**
+* @brief Get the usage and budget of every GPU memory heap
+*/
+ASEXPORT void asGetGpuMemoryStats(asGpuMemoryStats_t* pStats);
+
+/**
+* @brief Bytes of video memory left before going over budget (negative once over it)
+* meant as the signal for streaming and caches to evict against
+* Unused space of the shared texture memory counts as left since new textures fill it first
+*/
+ASEXPORT int64_t asGetGpuMemoryHeadroom();
+
+/**
+* @brief GPU memory used by resources sharing a debug label
+*/
+typedef struct {
+	const char* pLabel; /**< Valid until the renderer shuts down*/
+	uint64_t bytes;
+	uint32_t count; /**< Number of resources*/
+} asGpuMemoryConsumer_t;
+
+/**
+* @brief Get the largest users of GPU memory grouped by debug label (largest first)
+* @return number of consumers written to pOut
+*/
+ASEXPORT size_t asGetGpuMemoryConsumers(asGpuMemoryConsumer_t* pOut, size_t maxCount);
+
 /*Screen Management*/
 
 /**
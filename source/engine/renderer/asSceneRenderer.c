@@ -1,6 +1,7 @@
 #include "asSceneRenderer.h"
 
 #include "asBindlessTexturePool.h"
+#include "asComputeSkinning.h"
 #include "cglm/box.h"
 
 #if ASTRENGINE_VK
@@ -25,6 +26,7 @@ VkDescriptorPool sceneDescriptorPool;
 struct primInstanceData {
 	uint16_t previousFrameTransform;
 	uint16_t currentFrameTransform;
+	int32_t materialIdx; /*For draws merged from the geometry arena*/
 };
 
 struct asPrimitiveSubmissionQueueT {
@@ -32,6 +34,8 @@ struct asPrimitiveSubmissionQueueT {
 	int32_t currentFrame;
 
 	asBufferHandle_t offsetBuffs[AS_MAX_INFLIGHT];
+	asBufferHandle_t indirectBuffs[AS_MAX_INFLIGHT]; /*Draws of the geometry arena*/
+	void* _IndirectBufferMappings[AS_MAX_INFLIGHT];
 
 	uint32_t primitiveGroupMax;
 	uint32_t initialPrimitiveGroupCount;
@@ -51,6 +55,10 @@ struct asPrimitiveSubmissionQueueT {
 
 	asRenderGraphStage graphStage;
 	asGfxViewer viewer;
+	bool depthOnly;
+
+	asClusterCullBatch clusterBatch; /*NULL when prims are drawn whole*/
+	uint32_t* pClusterJobs; /*Job of each prim (UINT32_MAX when drawn whole)*/
 };
 
 enum SubmissionQueueState {
@@ -123,6 +131,8 @@ struct asGfxViewerT
 {
 	struct viewerUbo* sceneUboData[AS_MAX_INFLIGHT];
 	asBufferHandle_t sceneUboBuffer[AS_MAX_INFLIGHT];
+	int32_t screenIdx; /*Of the last params*/
+	int32_t viewportIdx;
 };
 
 void sceneViewport_FlushGPU(struct asGfxViewerT* pViewer)
@@ -150,6 +160,13 @@ struct scenePushConstants
 	int32_t transformOffsetCurrent;
 	int32_t transformOffsetLast;
 	int32_t debugIdx;
+	int32_t clusterJob; /*Read by task and mesh shaders (see SceneMeshlet.glsl)*/
+	int32_t instanceData; /*Transforms and material come from the instance attributes (merged geometry arena draws of the "arena" pipeline)*/
+	int32_t _pad0[2]; /*vec3 members are 16 byte aligned in ScenePushConstants.glsl*/
+	float positionScale[3]; /*Dequantization of the position stream (depth pipeline)*/
+	float _pad1;
+	float positionOffset[3];
+	float _pad2;
 };
 
 ASEXPORT asResults asSceneRendererCreateViewer(asGfxViewer* ppViewer)
@@ -231,6 +248,8 @@ const int currentUboIdx = asVkCurrentFrame;
 
 	pUboData->time = desc.time;
 	pUboData->debug = desc.debugState;
+	viewer->screenIdx = desc.screenIdx;
+	viewer->viewportIdx = desc.viewportIdx;
 
 	sceneViewport_FlushGPU(viewer);
 	return AS_SUCCESS;
@@ -253,6 +272,7 @@ struct asSceneRendererTransformPoolT
 	vec3 boundingBox[2];
 
 	int32_t currentFrame;
+	int32_t populatedFrame; /*Buffer holding the transforms of the last populate*/
 };
 
 ASEXPORT asResults asSceneRendererTransformPoolCreate(asSceneRendererTransformPool* pPool, uint32_t transformMax)
@@ -316,6 +336,7 @@ ASEXPORT asResults asSceneRendererTransformPoolPopulateEnd(asSceneRendererTransf
 	/*Update Continuous Recording*/
 	asVkAllocation_t xformAlloc = asVkGetAllocFromBuffer(pool->transformBuffs[pool->currentFrame]);
 	asVkFlushMemory(xformAlloc);
+	pool->populatedFrame = pool->currentFrame;
 	pool->currentFrame = asVkCurrentFrame;
 	#endif
 	return AS_SUCCESS;
@@ -336,9 +357,39 @@ ASEXPORT asResults asSceneRendererTransformPoolDestroy(asSceneRendererTransformP
 	return AS_SUCCESS;
 }
 
+/*Whether a Scene FX has the "arena" pipeline, the only one that reads the instance attributes of merged draws*/
+static bool _sceneHasArenaPipeline(const asShaderFx* pShaderFx)
+{
+	return pShaderFx && pShaderFx->registration->pipelineCount > 3 && pShaderFx->pipelines[3];
+}
+
+/*Pipeline that draws the position stream of a prim in depth only queues ("depth" for 16 bit streams, "depthFloat" for float ones), 0 when there is none*/
+static uint32_t _scenePositionStreamPipeline(const asGfxPrimativeGroupDesc* pPrim)
+{
+	const uint32_t pipeline = (pPrim->flags & AS_GFX_DRAW_FLAG_QUANTIZED_POSITIONS) ? 2 : 4;
+	if (!asHandleValid(pPrim->positionBuffer) || pPrim->pShaderFx->registration->pipelineCount <= pipeline || !pPrim->pShaderFx->pipelines[pipeline])
+		return 0;
+	return pipeline;
+}
+
+/*Whether a prim can join the multi draw of an earlier geometry arena prim*/
+static bool _sceneArenaCanMerge(const asGfxPrimativeGroupDesc* pFirst, const asGfxPrimativeGroupDesc* pNext, bool nextClusterCulled)
+{
+	return (pNext->flags & AS_GFX_DRAW_FLAG_GEOMETRY_ARENA) && !nextClusterCulled && _sceneHasArenaPipeline(pNext->pShaderFx) &&
+		pNext->pShaderFx->pipelines[3] == pFirst->pShaderFx->pipelines[3] &&
+		pNext->stencilWriteBits == pFirst->stencilWriteBits &&
+		pNext->debugState == pFirst->debugState;
+}
+
 /*Record Command Buffer*/
 void recordSecondaryCommands(uint32_t primCount,
 	asGfxPrimativeGroupDesc* pPrims,
+	asClusterCullBatch clusterBatch,
+	uint32_t* pClusterJobs,
+	asBufferHandle_t instanceBuffer,
+	asBufferHandle_t indirectBuffer,
+	void* pIndirectMapping,
+	bool depthOnly,
 	asRenderGraphStage graphStage,
 	asGfxViewer pViewport,
 	float viewport[4],
@@ -384,6 +435,17 @@ void recordSecondaryCommands(uint32_t primCount,
 	//vkCmdBindDescriptorSets(vCmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
 	//	scenePipelineLayout, AS_DESCSET_VIEWER_UBO, 1, &pViewport->vDescriptorSets[bufferedFrame], 0, NULL);
 
+	/*Instance Data and Geometry Arena (bound once for every prim drawn from the arena)*/
+	VkBuffer instanceBuff = asVkGetBufferFromBuffer(instanceBuffer);
+	VkDeviceSize instanceByteOffset = 0;
+	vkCmdBindVertexBuffers(vCmd, 1, 1, &instanceBuff, &instanceByteOffset);
+	asGeometryArenaBindCmd(AS_GFXAPI_VULKAN, &vCmd, &scenePipelineLayout);
+	bool arenaBound = true;
+	const bool multiDraw = asVkDeviceFeatures.multiDrawIndirect && asVkDeviceFeatures.drawIndirectFirstInstance;
+	VkDrawIndexedIndirectCommand* pIndirect = (VkDrawIndexedIndirectCommand*)pIndirectMapping;
+	uint32_t indirectCount = 0;
+	uint32_t instanceDataStart = 0; /*Instances are laid out in prim order (see asSceneRendererSubmissionQueuePopulateEnd())*/
+
 	VkPipeline lastPipeline = VK_NULL_HANDLE;
 	uint32_t lastStencilWrite = 0;
 	bool firstLoop = true;
@@ -392,10 +454,21 @@ void recordSecondaryCommands(uint32_t primCount,
 		const asGfxPrimativeGroupDesc prim = pPrims[i];
 		const uint32_t instanceCount = prim.baseInstanceCount * 1;
 		const uint32_t instanceStart = 0;
+		const uint32_t primInstanceData = instanceDataStart;
+		instanceDataStart += prim.baseInstanceCount;
 
 		/*Bind Pipeline*/
 		if (!prim.pShaderFx) { continue; }
-		VkPipeline nextPipeline = (VkPipeline)prim.pShaderFx->pipelines[0]; /*Todo: Pipeline Selection*/
+		const bool clusterCulled = clusterBatch && pClusterJobs[i] != UINT32_MAX;
+		const bool meshShaders = clusterCulled && asClusterCullingUseMeshShaders(prim.pShaderFx);
+		/*Depth only prims with a position stream skip the rest of the vertex (skinned prims keep the full vertex for skinning)*/
+		const uint32_t positionPipeline = (depthOnly && !clusterCulled && !(prim.flags & AS_GFX_DRAW_FLAG_GEOMETRY_ARENA) &&
+			!(prim.flags & AS_GFX_DRAW_FLAG_HW_SKINNED)) ? _scenePositionStreamPipeline(&prim) : 0;
+		const bool positionStream = positionPipeline != 0;
+		/*Arena prims of shaders without the "arena" pipeline are drawn one by one with the transforms and material of the push constants*/
+		const bool arenaPrim = !clusterCulled && (prim.flags & AS_GFX_DRAW_FLAG_GEOMETRY_ARENA);
+		const bool arenaPipeline = arenaPrim && _sceneHasArenaPipeline(prim.pShaderFx);
+		VkPipeline nextPipeline = (VkPipeline)prim.pShaderFx->pipelines[meshShaders ? 1 : (positionStream ? positionPipeline : (arenaPipeline ? 3 : 0))]; /*Todo: Pipeline Selection*/
 		if (nextPipeline != lastPipeline)
 		{
 			vkCmdBindPipeline(vCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, nextPipeline);
@@ -408,20 +481,93 @@ void recordSecondaryCommands(uint32_t primCount,
 		pushConstants.transformOffsetCurrent = prim.transformOffset;
 		pushConstants.debugIdx = prim.debugState;
 		pushConstants.materialIdx = prim.materialId;
-		vkCmdPushConstants(vCmd, scenePipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(struct scenePushConstants), &pushConstants);
-
-		/*Bind Vertex Buffer*/
-		if (asHandleValid(prim.vertexBuffer))
+		pushConstants.clusterJob = clusterCulled ? (int32_t)pClusterJobs[i] : -1;
+		pushConstants.instanceData = arenaPipeline ? 1 : 0;
+		if (prim.flags & AS_GFX_DRAW_FLAG_QUANTIZED_POSITIONS)
 		{
-			VkBuffer vBuff = asVkGetBufferFromBuffer(prim.vertexBuffer);
-			VkDeviceSize byteOffset = prim.vertexByteOffset;
-			vkCmdBindVertexBuffers(vCmd, 0, 1, &vBuff, &byteOffset);
+			memcpy(pushConstants.positionScale, prim.positionScale, sizeof(pushConstants.positionScale));
+			memcpy(pushConstants.positionOffset, prim.positionOffset, sizeof(pushConstants.positionOffset));
+		}
+		else
+		{
+			/*Float streams are used as is*/
+			pushConstants.positionScale[0] = pushConstants.positionScale[1] = pushConstants.positionScale[2] = 1.0f;
 		}
+		vkCmdPushConstants(vCmd, scenePipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(struct scenePushConstants), &pushConstants);
 
 		/*Stencil Write*/
 		if (lastStencilWrite != prim.stencilWriteBits || firstLoop)
 		{
 			vkCmdSetStencilWriteMask(vCmd, VK_STENCIL_FRONT_AND_BACK, prim.stencilWriteBits);
+			lastStencilWrite = prim.stencilWriteBits;
+		}
+		firstLoop = false;
+
+		/*Meshlets that survived GPU Culling*/
+		if (clusterCulled)
+		{
+			asClusterCullBatchDrawCmd(clusterBatch, pClusterJobs[i], meshShaders, AS_GFXAPI_VULKAN, &vCmd, &scenePipelineLayout);
+			arenaBound = false;
+			continue;
+		}
+
+		/*Geometry Arena (following prims with the same state are merged into one multi draw)*/
+		if (arenaPrim)
+		{
+			if (!arenaBound)
+			{
+				asGeometryArenaBindCmd(AS_GFXAPI_VULKAN, &vCmd, &scenePipelineLayout);
+				arenaBound = true;
+			}
+			if (!arenaPipeline)
+			{
+				vkCmdDrawIndexed(vCmd, prim.indexCount, instanceCount, prim.indexStart, (int32_t)prim.vertexStart, instanceStart);
+				continue;
+			}
+			const uint32_t firstCommand = indirectCount;
+			pIndirect[indirectCount++] = (VkDrawIndexedIndirectCommand){
+				prim.indexCount, instanceCount, prim.indexStart, (int32_t)prim.vertexStart, primInstanceData
+			};
+			while (i + 1 < primCount && indirectCount - firstCommand < asVkDeviceProperties.limits.maxDrawIndirectCount)
+			{
+				const asGfxPrimativeGroupDesc* pNext = &pPrims[i + 1];
+				if (!_sceneArenaCanMerge(&prim, pNext, clusterBatch && pClusterJobs[i + 1] != UINT32_MAX)) { break; }
+				pIndirect[indirectCount++] = (VkDrawIndexedIndirectCommand){
+					pNext->indexCount, pNext->baseInstanceCount, pNext->indexStart, (int32_t)pNext->vertexStart, instanceDataStart
+				};
+				instanceDataStart += pNext->baseInstanceCount;
+				i++;
+			}
+			if (multiDraw)
+			{
+				vkCmdDrawIndexedIndirect(vCmd, asVkGetBufferFromBuffer(indirectBuffer),
+					firstCommand * sizeof(VkDrawIndexedIndirectCommand), indirectCount - firstCommand, sizeof(VkDrawIndexedIndirectCommand));
+			}
+			else /*Same draws one by one*/
+			{
+				for (uint32_t c = firstCommand; c < indirectCount; c++)
+				{
+					const VkDrawIndexedIndirectCommand draw = pIndirect[c];
+					vkCmdDrawIndexed(vCmd, draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+				}
+			}
+			continue;
+		}
+
+		/*Bind Vertex Buffer*/
+		if (positionStream)
+		{
+			VkBuffer pBuff = asVkGetBufferFromBuffer(prim.positionBuffer);
+			VkDeviceSize byteOffset = prim.positionByteOffset;
+			vkCmdBindVertexBuffers(vCmd, 0, 1, &pBuff, &byteOffset);
+			arenaBound = false;
+		}
+		else if (asHandleValid(prim.vertexBuffer))
+		{
+			VkBuffer vBuff = asVkGetBufferFromBuffer(prim.vertexBuffer);
+			VkDeviceSize byteOffset = prim.vertexByteOffset;
+			vkCmdBindVertexBuffers(vCmd, 0, 1, &vBuff, &byteOffset);
+			arenaBound = false;
 		}
 
 		/*Indexed Draw*/
@@ -431,6 +577,7 @@ void recordSecondaryCommands(uint32_t primCount,
 			VkBuffer iBuff = asVkGetBufferFromBuffer(prim.indexBuffer);
 			VkIndexType iType = prim.flags & AS_GFX_DRAW_FLAG_UINT32_INDICES ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
 			vkCmdBindIndexBuffer(vCmd, iBuff, prim.indexByteOffset, iType);
+			arenaBound = false;
 
 			vkCmdDrawIndexed(vCmd, prim.indexCount, instanceCount, prim.indexStart, prim.vertexStart, instanceStart);
 		}
@@ -438,9 +585,8 @@ void recordSecondaryCommands(uint32_t primCount,
 		{
 			vkCmdDraw(vCmd, prim.vertexCount, instanceCount, prim.vertexStart, instanceStart);
 		}
-
-		firstLoop = false;
 	}
+	if (indirectCount) { asVkFlushMemory(asVkGetAllocFromBuffer(indirectBuffer)); }
 
 	vkEndCommandBuffer(vCmd);
 #endif
@@ -470,9 +616,12 @@ ASEXPORT asResults asSceneRendererSubmissionQueueCreate(asPrimitiveSubmissionQue
 	queue->primitiveGroupMax = pDesc->maxPrimitives;
 	queue->instanceMax = pDesc->maxInstances;
 	queue->transformPool = pDesc->transformPool;
+	queue->viewer = pDesc->viewer;
+	queue->graphStage = pDesc->graphStage;
+	queue->depthOnly = pDesc->depthOnly;
 
 	asBufferDesc_t offsetBuffDesc = asBufferDesc_Init();
-	offsetBuffDesc.usageFlags = AS_BUFFERUSAGE_STORAGE;
+	offsetBuffDesc.usageFlags = AS_BUFFERUSAGE_STORAGE | AS_BUFFERUSAGE_VERTEX; /*Instance attributes of geometry arena draws*/
 	offsetBuffDesc.pDebugLabel = "InstanceOffsetBuffer";
 	offsetBuffDesc.bufferSize = queue->instanceMax * sizeof(struct primInstanceData);
 	offsetBuffDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
@@ -482,6 +631,21 @@ ASEXPORT asResults asSceneRendererSubmissionQueueCreate(asPrimitiveSubmissionQue
 #if ASTRENGINE_VK
 		asVkAllocation_t offsAlloc = asVkGetAllocFromBuffer(queue->offsetBuffs[i]);
 		asVkMapMemory(offsAlloc, 0, offsAlloc.size, &queue->_InstanceBufferMappings[i]);
+#endif
+	}
+	asBufferDesc_t indirectBuffDesc = asBufferDesc_Init();
+	indirectBuffDesc.usageFlags = AS_BUFFERUSAGE_INDIRECT;
+	indirectBuffDesc.pDebugLabel = "ArenaIndirectBuffer";
+	indirectBuffDesc.cpuAccess = AS_GPURESOURCEACCESS_STREAM;
+#if ASTRENGINE_VK
+	indirectBuffDesc.bufferSize = queue->primitiveGroupMax * sizeof(VkDrawIndexedIndirectCommand);
+#endif
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		queue->indirectBuffs[i] = asCreateBuffer(&indirectBuffDesc);
+#if ASTRENGINE_VK
+		asVkAllocation_t indirectAlloc = asVkGetAllocFromBuffer(queue->indirectBuffs[i]);
+		asVkMapMemory(indirectAlloc, 0, indirectAlloc.size, &queue->_IndirectBufferMappings[i]);
 #endif
 	}
 	const size_t allocSize = (size_t)queue->primitiveGroupMax * sizeof(asGfxPrimativeGroupDesc);
@@ -489,6 +653,14 @@ ASEXPORT asResults asSceneRendererSubmissionQueueCreate(asPrimitiveSubmissionQue
 	ASASSERT(queue->pInitialPrimGroups);
 	memset(queue->pInitialPrimGroups, 0, allocSize);
 
+	/*GPU Cluster Culling*/
+	queue->pClusterJobs = asMalloc((size_t)queue->primitiveGroupMax * sizeof(uint32_t));
+	ASASSERT(queue->pClusterJobs);
+	if (pDesc->maxClusterDraws && asClusterCullingAvailable())
+	{
+		asClusterCullBatchCreate(&queue->clusterBatch, queue->primitiveGroupMax, pDesc->maxClusterDraws);
+	}
+
 #if ASTRENGINE_VK
 	/*Create Command Buffer Pool*/
 	VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
@@ -516,7 +688,19 @@ ASEXPORT asResults asSceneRendererSubmissionQueueDestroy(asPrimitiveSubmissionQu
 #endif
 		asReleaseBuffer(queue->offsetBuffs[i]);
 	}
+	for (int i = 0; i < AS_MAX_INFLIGHT; i++)
+	{
+		if (!asHandleValid(queue->indirectBuffs[i])) {
+			continue;
+		}
+#if ASTRENGINE_VK
+		asVkUnmapMemory(asVkGetAllocFromBuffer(queue->indirectBuffs[i]));
+#endif
+		asReleaseBuffer(queue->indirectBuffs[i]);
+	}
 	asFree(queue->pInitialPrimGroups);
+	asFree(queue->pClusterJobs);
+	asClusterCullBatchDestroy(queue->clusterBatch);
 #if ASTRENGINE_VK
 	vkDestroyCommandPool(asVkDevice, queue->vCommandPool, AS_VK_MEMCB);
 #endif
@@ -541,7 +725,8 @@ void primQueueRecordCmds(asPrimitiveSubmissionQueue queue)
 	vkWaitForFences(asVkDevice, 1, &asVkInFlightFences[asVkCurrentFrame], VK_TRUE, UINT64_MAX);
 
 	/*Update Continuous Recording*/
-	asVkAllocation_t indexAlloc = asVkGetAllocFromBuffer(queue->offsetBuffs[queue->currentFrame]);
+	const int32_t populatedFrame = queue->currentFrame;
+	asVkAllocation_t indexAlloc = asVkGetAllocFromBuffer(queue->offsetBuffs[populatedFrame]);
 	asVkFlushMemory(indexAlloc);
 	queue->currentFrame = asVkCurrentFrame;
 #endif
@@ -567,6 +752,12 @@ void primQueueRecordCmds(asPrimitiveSubmissionQueue queue)
 	/*Build Command Buffers*/
 	recordSecondaryCommands(queue->initialPrimitiveGroupCount,
 		queue->pInitialPrimGroups,
+		queue->clusterBatch,
+		queue->pClusterJobs,
+		queue->offsetBuffs[populatedFrame],
+		queue->indirectBuffs[queue->currentFrame],
+		queue->_IndirectBufferMappings[queue->currentFrame],
+		queue->depthOnly,
 		queue->graphStage,
 		queue->viewer,
 		(float[]){(float)width, (float)height, 0.0f, 0.0f},
@@ -591,16 +782,51 @@ ASEXPORT asResults asSceneRendererSubmissionQueuePopulateEnd(asPrimitiveSubmissi
 		const uint16_t instanceCount = queue->pInitialPrimGroups[g].baseInstanceCount;
 		const uint16_t transformOffset = queue->pInitialPrimGroups[g].transformOffset;
 		const uint16_t transformOffsetPrev = queue->pInitialPrimGroups[g].transformOffsetPreviousFrame;
+		const int32_t materialIdx = queue->pInitialPrimGroups[g].materialId;
 		for (uint16_t i = 0; i < instanceCount; i++)
 		{
 			queue->pInstanceTransformOffsets[nextInstanceOffset + i] = (struct primInstanceData){
 				transformOffsetPrev + i,
 				transformOffset + i,
+				materialIdx,
 			};
 		}
 		nextInstanceOffset += instanceCount;
 	}
 	queue->instanceCount = nextInstanceOffset;
+
+	/*Cluster Culling Jobs*/
+	for (uint32_t g = 0; g < queue->initialPrimitiveGroupCount; g++) { queue->pClusterJobs[g] = UINT32_MAX; }
+	if (queue->clusterBatch && queue->viewer)
+	{
+		asClusterCullBatchBegin(queue->clusterBatch);
+		for (uint32_t g = 0; g < queue->initialPrimitiveGroupCount; g++)
+		{
+			const asGfxPrimativeGroupDesc* pPrim = &queue->pInitialPrimGroups[g];
+			if (!(pPrim->flags & AS_GFX_DRAW_FLAG_CLUSTER_CULLED) || !pPrim->clusterGeometry) { continue; }
+			asClusterJobDesc job = { 0 };
+			job.geometry = pPrim->clusterGeometry;
+			job.firstMeshlet = pPrim->meshletStart;
+			job.meshletCount = pPrim->meshletCount;
+			job.instanceCount = pPrim->baseInstanceCount;
+			job.transformOffset = pPrim->transformOffset;
+			job.transformOffsetPreviousFrame = pPrim->transformOffsetPreviousFrame;
+			job.flags = pPrim->flags & AS_GFX_DRAW_FLAG_DOUBLE_SIDED ? AS_CLUSTER_JOB_NO_CONE : 0;
+			/*Drawn whole once the batch is full*/
+			asClusterCullBatchAddJob(queue->clusterBatch, &job, &queue->pClusterJobs[g]);
+		}
+#if ASTRENGINE_VK
+		const struct viewerUbo* pUboData = queue->viewer->sceneUboData[asVkCurrentFrame];
+		asClusterViewDesc view;
+		glm_mat4_copy((vec4*)pUboData->viewMatrix[0], view.viewMatrix);
+		glm_mat4_copy((vec4*)pUboData->projMatrix[0], view.projMatrix);
+		glm_vec3_copy((float*)pUboData->viewPosition, view.viewPosition);
+		view.transformBuffer = queue->transformPool->transformBuffs[queue->transformPool->populatedFrame];
+		/*The pyramid is built from the depth of screen 0 (depth only queues may be drawing shadows)*/
+		view.depthPyramidView = !queue->depthOnly && queue->viewer->screenIdx == 0 && queue->viewer->viewportIdx == 0;
+		asClusterCullBatchEnd(queue->clusterBatch, &view);
+#endif
+	}
 	queue->state = SUBMISSION_QUEUE_STATE_RECORDED;
 	return AS_SUCCESS;
 }
@@ -617,7 +843,7 @@ ASEXPORT asResults asSceneRendererSubmissionQueuePrepareFrameSubmit(asPrimitiveS
 ASEXPORT asResults asSceneRendererSubmissionAddPrimitiveGroups(asPrimitiveSubmissionQueue queue, uint32_t primitiveCount, asGfxPrimativeGroupDesc* pDescs)
 {
 	ASASSERT(queue->transformPool);
-	if (queue->initialPrimitiveGroupCount + primitiveCount > queue->transformPool->transformMax) { return AS_FAILURE_OUT_OF_BOUNDS; }
+	if (queue->initialPrimitiveGroupCount + primitiveCount > queue->primitiveGroupMax) { return AS_FAILURE_OUT_OF_BOUNDS; }
 	memcpy(queue->pInitialPrimGroups + queue->initialPrimitiveGroupCount, pDescs, primitiveCount * sizeof(asGfxPrimativeGroupDesc));
 	queue->initialPrimitiveGroupCount += primitiveCount;
 	return AS_SUCCESS;
@@ -668,10 +894,15 @@ ASEXPORT asResults _asFillGfxPipeline_Scene(
 	pGraphicsPipelineDesc->basePipelineHandle = VK_NULL_HANDLE;
 	pGraphicsPipelineDesc->basePipelineIndex = 0;
 
+	/*Depth only pipelines read the position stream (16 bit or float) and write no color*/
+	const bool floatPositions = !strcmp(pipelineName, "depthFloat");
+	const bool depthOnly = floatPositions || !strcmp(pipelineName, "depth");
+
 	/*Color Blending*/
 	VkPipelineColorBlendAttachmentState attachmentBlends[] = {
 		settings.blendMode? AS_VK_INIT_HELPER_ATTACHMENT_BLEND_MIX(VK_TRUE) : AS_VK_INIT_HELPER_ATTACHMENT_BLEND_MIX(VK_FALSE)
 	};
+	if (depthOnly) { attachmentBlends[0].colorWriteMask = 0; }
 	pGraphicsPipelineDesc->pColorBlendState = &AS_VK_INIT_HELPER_PIPE_COLOR_BLEND_STATE(ASARRAYLEN(attachmentBlends), attachmentBlends);
 	/*Depth Stencil*/
 	pGraphicsPipelineDesc->pDepthStencilState = &AS_VK_INIT_HELPER_PIPE_DEPTH_STENCIL_STATE(
@@ -718,7 +949,8 @@ ASEXPORT asResults _asFillGfxPipeline_Scene(
 	size_t boneIdxOffset = offsetof(asVertexGeneric, boneIdx); /*Set to 0 for non-skined*/
 	size_t boneWeightOffset = offsetof(asVertexGeneric, boneWeight);
 	VkVertexInputBindingDescription vertexBindings[] = {
-		AS_VK_INIT_HELPER_VERTEX_BINDING(0, vtxSize, VK_VERTEX_INPUT_RATE_VERTEX)
+		AS_VK_INIT_HELPER_VERTEX_BINDING(0, vtxSize, VK_VERTEX_INPUT_RATE_VERTEX),
+		AS_VK_INIT_HELPER_VERTEX_BINDING(1, sizeof(struct primInstanceData), VK_VERTEX_INPUT_RATE_INSTANCE)
 	};
 	VkVertexInputAttributeDescription vertexAttributes[] = {
 		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(0, 0, VK_FORMAT_R32G32B32_SFLOAT, posOffset),
@@ -729,10 +961,25 @@ ASEXPORT asResults _asFillGfxPipeline_Scene(
 		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(5, 0, VK_FORMAT_R8G8B8A8_UNORM, colorOffset),
 		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(6, 0, VK_FORMAT_R16G16B16A16_UINT, boneIdxOffset),
 		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(7, 0, VK_FORMAT_R8G8B8A8_UNORM, boneWeightOffset),
+		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(8, 1, VK_FORMAT_R16G16_UINT, offsetof(struct primInstanceData, previousFrameTransform)),
+		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(9, 1, VK_FORMAT_R32_SINT, offsetof(struct primInstanceData, materialIdx)),
+	};
+	VkVertexInputBindingDescription positionBindings[] = {
+		AS_VK_INIT_HELPER_VERTEX_BINDING(0, floatPositions ? sizeof(float) * 3 : sizeof(uint16_t) * 4, VK_VERTEX_INPUT_RATE_VERTEX),
+		AS_VK_INIT_HELPER_VERTEX_BINDING(1, sizeof(struct primInstanceData), VK_VERTEX_INPUT_RATE_INSTANCE)
 	};
-	pGraphicsPipelineDesc->pVertexInputState = &AS_VK_INIT_HELPER_PIPE_VERTEX_STATE(
-		ASARRAYLEN(vertexBindings), vertexBindings,
-		ASARRAYLEN(vertexAttributes), vertexAttributes);
+	VkVertexInputAttributeDescription positionAttributes[] = {
+		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(0, 0, floatPositions ? VK_FORMAT_R32G32B32_SFLOAT : VK_FORMAT_R16G16B16A16_UNORM, 0),
+		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(8, 1, VK_FORMAT_R16G16_UINT, offsetof(struct primInstanceData, previousFrameTransform)),
+		AS_VK_INIT_HELPER_VERTEX_ATTRIBUTE(9, 1, VK_FORMAT_R32_SINT, offsetof(struct primInstanceData, materialIdx)),
+	};
+	pGraphicsPipelineDesc->pVertexInputState = depthOnly ?
+		&AS_VK_INIT_HELPER_PIPE_VERTEX_STATE(
+			ASARRAYLEN(positionBindings), positionBindings,
+			ASARRAYLEN(positionAttributes), positionAttributes) :
+		&AS_VK_INIT_HELPER_PIPE_VERTEX_STATE(
+			ASARRAYLEN(vertexBindings), vertexBindings,
+			ASARRAYLEN(vertexAttributes), vertexAttributes);
 
 	pGraphicsPipelineDesc->renderPass = sceneRenderPass;
 	pGraphicsPipelineDesc->subpass = 0;
@@ -830,6 +1077,9 @@ void _destroyScreenResources()
 
 ASEXPORT asResults asInitSceneRenderer()
 {
+	asInitClusterCulling();
+	asInitComputeSkinning();
+	asInitGeometryArena();
 #if ASTRENGINE_VK
 	/*Descriptor Set Layout*/
 	{
@@ -847,9 +1097,11 @@ ASEXPORT asResults asInitSceneRenderer()
 	}
 	/*Setup Pipeline Layout*/
 	{
-		VkDescriptorSetLayout descSetLayouts[2] = { 0 };
+		VkDescriptorSetLayout descSetLayouts[5] = { 0 };
 		asVkGetTexturePoolDescSetLayout(&descSetLayouts[0]);
 		descSetLayouts[1] = sceneViewDescSetLayout;
+		asVkGetClusterCullingDescSetLayouts(&descSetLayouts[AS_DESCSET_CLUSTER_FRAME], &descSetLayouts[AS_DESCSET_CLUSTER_GEOMETRY]);
+		asVkGetGeometryArenaDescSetLayout(&descSetLayouts[AS_DESCSET_GEOMETRY_ARENA]);
 
 		VkPipelineLayoutCreateInfo createInfo = (VkPipelineLayoutCreateInfo){ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
 		createInfo.setLayoutCount = ASARRAYLEN(descSetLayouts);
@@ -919,6 +1171,7 @@ ASEXPORT asResults asTriggerResizeSceneRenderer()
 {
 	_destroyScreenResources();
 	_createScreenResources();
+	asTriggerResizeClusterCulling();
 	/*for (int i = 0; i < arrlen(mainSceneViewport.pPrimQueues); i++)
 	{
 		const struct asPrimitiveSubmissionQueueT* pPrimQueue = mainSceneViewport.pPrimQueues[i];
@@ -1042,6 +1295,12 @@ ASEXPORT asResults asSceneRendererDraw(int32_t screenIndex)
 	beginInfo.renderArea = (VkRect2D){ {0,0},{width, height} };
 	beginInfo.renderPass = sceneRenderPass;
 	beginInfo.framebuffer = sceneFramebuffer;
+	/*Skin once for every pass that draws the skinned vertices*/
+	asComputeSkinningRecordCmds(AS_GFXAPI_VULKAN, &vCmd);
+
+	/*Cull Meshlets*/
+	asClusterCullingRecordCmds(AS_GFXAPI_VULKAN, &vCmd);
+
 	vkCmdBeginRenderPass(vCmd, &beginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
 	//Todo: execute render graph
@@ -1049,6 +1308,9 @@ ASEXPORT asResults asSceneRendererDraw(int32_t screenIndex)
 	//executeVpSubmissionQueues(vCmd, &mainSceneViewport, 7); /*Render GUI*/
 
 	vkCmdEndRenderPass(vCmd);
+
+	/*Depth Pyramid for Occlusion Culling next Frame*/
+	asClusterCullingBuildDepthPyramidCmds(AS_GFXAPI_VULKAN, &vCmd);
 	vkEndCommandBuffer(vCmd);
 #endif
 	/*Invalidate all command buffers for frame*/
@@ -1070,5 +1332,8 @@ ASEXPORT asResults asShutdownSceneRenderer()
 	vkDestroyDescriptorSetLayout(asVkDevice, sceneViewDescSetLayout, AS_VK_MEMCB);
 #endif
 	_destroyScreenResources();
+	asShutdownClusterCulling();
+	asShutdownComputeSkinning();
+	asShutdownGeometryArena();
 	return AS_SUCCESS;
 }
\ No newline at end of file
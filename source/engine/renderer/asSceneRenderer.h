@@ -4,6 +4,8 @@
 #include "engine/common/asCommon.h"
 #include "engine/renderer/asRendererCore.h"
 #include "engine/renderer/asRenderGraph.h"
+#include "engine/renderer/asClusterCulling.h"
+#include "engine/renderer/asGeometryArena.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,8 +62,10 @@ typedef struct {
 
 	uint32_t maxPrimitives; /**< Maximum number of uploaded primatives*/
 	uint32_t maxInstances; /**< Maximum number of instances (post batching)*/
+	uint32_t maxClusterDraws; /**< Maximum meshlet instances of AS_GFX_DRAW_FLAG_CLUSTER_CULLED prims (0 draws them whole)*/
 	bool disableInstanceSort; /**< Disable sorting of instances*/
 	bool disableInstanceMerge; /**< Disable merging of instances*/
+	bool depthOnly; /**< Depth prepass or shadow pass, prims with a positionBuffer draw only their position stream*/
 } asPrimitiveSubmissionQueueDesc;
 /**
 * Primitive Submission Queue 
@@ -85,6 +89,10 @@ typedef int32_t asGfxDrawFlags;
 typedef enum {
 	AS_GFX_DRAW_FLAG_UINT32_INDICES = 1 << 0, /**< Uses uint32_t for indices instead of uint16_t*/
 	AS_GFX_DRAW_FLAG_HW_SKINNED = 1 << 1, /**< Use Hardware Skinning to Offset into Transforms by Bone Index*/
+	AS_GFX_DRAW_FLAG_CLUSTER_CULLED = 1 << 2, /**< Cull the meshlets of clusterGeometry on the GPU (see asClusterCulling.h)*/
+	AS_GFX_DRAW_FLAG_DOUBLE_SIDED = 1 << 3, /**< Skip backface culling of meshlets by their normal cone*/
+	AS_GFX_DRAW_FLAG_GEOMETRY_ARENA = 1 << 4, /**< vertexStart and indexStart are into the geometry arena (the buffers above are ignored, see asGeometryArena.h)*/
+	AS_GFX_DRAW_FLAG_QUANTIZED_POSITIONS = 1 << 5, /**< positionBuffer holds the 16 bit position stream of an asMdl (AS_MODEL_FLAG_QUANTIZED_POSITIONS) instead of the float one*/
 } asGfxInstanceFlagBits;
 
 typedef struct {
@@ -95,11 +103,20 @@ typedef struct {
 	uint32_t vertexStart; /**< Beginning Vertex*/
 	uint32_t vertexCount; /**< Vertex count (only used if index buffer is unspecified)*/
 	asBufferHandle_t vertexBuffer; /**< Vertex Buffer (optional)*/
+
+	uint32_t positionByteOffset; /**< Position buffer offset in bytes*/
+	asBufferHandle_t positionBuffer; /**< Position stream drawn instead of the vertex buffer by depth only queues (optional, indexed like the vertex buffer)*/
+	float positionScale[3]; /**< Dequantization of the position stream (see asModel_t, unused for float streams)*/
+	float positionOffset[3];
 	
 	uint32_t indexByteOffset; /**< Index offset*/
 	uint32_t indexStart; /**< Beginning Index*/
 	uint32_t indexCount; /**< Index count*/
 	asBufferHandle_t indexBuffer; /**< Index Buffer (optional)*/
+
+	asClusterGeometry clusterGeometry; /**< Meshlets drawn with AS_GFX_DRAW_FLAG_CLUSTER_CULLED (the buffers above are drawn whole without culling)*/
+	uint32_t meshletStart; /**< First meshlet (see asModelLod_t::firstMeshlet)*/
+	uint32_t meshletCount; /**< Meshlet count*/
 	
 	asShaderFx* pShaderFx; /**< Shader FX to Apply*/
 	int32_t materialId; /**< Material index to Bind*/
@@ -9,6 +9,8 @@
 #endif
 
 #include "engine/renderer/asSceneRenderer.h"
+#include "engine/renderer/asClusterCulling.h"
+#include "engine/renderer/asComputeSkinning.h"
 
 asShaderTypeRegistration shaderTypes[] =
 {
@@ -52,17 +54,59 @@ asShaderTypeRegistration shaderTypes[] =
 	},
 	{ /*3D Scene*/
 		.name = "Scene",
-		.pipelineCount = 1,
-		.pipelines = { /*Simplified Rendering Pipeline*/
-			"basic",
-			AS_PIPELINETYPE_GRAPHICS,
-			_asFillGfxPipeline_Scene, /*Callback Function*/
-			NULL, /*Callback Data*/
-			2, { /*Code Path Mappings*/
-				0, 1
-			}
+		.pipelineCount = 5,
+		.pipelines = {
+			{ /*Simplified Rendering Pipeline*/
+				"basic",
+				AS_PIPELINETYPE_GRAPHICS,
+				_asFillGfxPipeline_Scene, /*Callback Function*/
+				NULL, /*Callback Data*/
+				2, { /*Code Path Mappings*/
+					0, 1
+				}
+			},
+			{ /*Meshlets drawn by task and mesh shaders (when the device has them, see SceneMeshlet.glsl)*/
+				"meshlet",
+				AS_PIPELINETYPE_GRAPHICS,
+				_asFillGfxPipeline_Scene, /*Callback Function*/
+				NULL, /*Callback Data*/
+				3, { /*Code Path Mappings*/
+					2, 3, 4
+				},
+				AS_PIPELINEFLAG_OPTIONAL
+			},
+			{ /*Depth prepass and shadows from the 16 bit position stream (no fragment stage)*/
+				"depth",
+				AS_PIPELINETYPE_GRAPHICS,
+				_asFillGfxPipeline_Scene, /*Callback Function*/
+				NULL, /*Callback Data*/
+				1, { /*Code Path Mappings*/
+					5
+				},
+				AS_PIPELINEFLAG_OPTIONAL
+			},
+			{ /*Merged geometry arena draws reading transforms and material from the instance attributes (see GeometryArena.glsl)*/
+				"arena",
+				AS_PIPELINETYPE_GRAPHICS,
+				_asFillGfxPipeline_Scene, /*Callback Function*/
+				NULL, /*Callback Data*/
+				2, { /*Code Path Mappings*/
+					6, 7
+				},
+				AS_PIPELINEFLAG_OPTIONAL
+			},
+			{ /*Depth prepass and shadows from the float position stream (the "depth" vertex stage with an unit scale)*/
+				"depthFloat",
+				AS_PIPELINETYPE_GRAPHICS,
+				_asFillGfxPipeline_Scene, /*Callback Function*/
+				NULL, /*Callback Data*/
+				1, { /*Code Path Mappings*/
+					8
+				},
+				AS_PIPELINEFLAG_OPTIONAL
+			},
 		},
-		.codePathCount = 2,
+		.codePathCount = 9,
 		.codePaths = {
 			{ /*Vertex*/
 				"basic",
@@ -86,6 +130,152 @@ asShaderTypeRegistration shaderTypes[] =
 					{"TYPE_SCENE","1"}
 				}
 			},
+			{ /*Task*/
+				"meshlet",
+				"main",
+				AS_SHADERSTAGE_TASK,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_MESHLET","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Mesh*/
+				"meshlet",
+				"main",
+				AS_SHADERSTAGE_MESH,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_MESHLET","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Fragment*/
+				"meshlet",
+				"main",
+				AS_SHADERSTAGE_FRAGMENT,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_MESHLET","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Vertex*/
+				"depth",
+				"main",
+				AS_SHADERSTAGE_VERTEX,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_DEPTH_ONLY","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Vertex*/
+				"arena",
+				"main",
+				AS_SHADERSTAGE_VERTEX,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_GEOMETRY_ARENA","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Fragment*/
+				"arena",
+				"main",
+				AS_SHADERSTAGE_FRAGMENT,
+				AS_QUALITY_LOW,
+				2, /*Macros*/
+				{
+					{"RENDER_GEOMETRY_ARENA","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+			{ /*Vertex*/
+				"depthFloat",
+				"main",
+				AS_SHADERSTAGE_VERTEX,
+				AS_QUALITY_LOW,
+				3, /*Macros*/
+				{
+					{"RENDER_DEPTH_ONLY","1"},
+					{"RENDER_DEPTH_FLOAT_POSITIONS","1"},
+					{"TYPE_SCENE","1"}
+				}
+			},
+		}
+	},
+	{ /*GPU Cluster Culling*/
+		.name = "ClusterCull",
+		.pipelineCount = 2,
+		.pipelines = {
+			{ /*Hierarchical Depth Reduction*/
+				"hiz",
+				AS_PIPELINETYPE_COMPUTE,
+				_asFillGfxPipeline_ClusterCull, /*Callback Function*/
+				NULL, /*Callback Data*/
+				1, { /*Code Path Mappings*/
+					0
+				}
+			},
+			{ /*Meshlet Culling*/
+				"cull",
+				AS_PIPELINETYPE_COMPUTE,
+				_asFillGfxPipeline_ClusterCull, /*Callback Function*/
+				NULL, /*Callback Data*/
+				1, { /*Code Path Mappings*/
+					1
+				}
+			},
+		},
+		.codePathCount = 2,
+		.codePaths = {
+			{ /*Compute*/
+				"hiz",
+				"main",
+				AS_SHADERSTAGE_COMPUTE,
+				AS_QUALITY_LOW,
+				1, /*Macros*/
+				{{"CLUSTER_HIZ","1"}}
+			},
+			{ /*Compute*/
+				"cull",
+				"main",
+				AS_SHADERSTAGE_COMPUTE,
+				AS_QUALITY_LOW,
+				1, /*Macros*/
+				{{"CLUSTER_CULL","1"}}
+			},
+		}
+	},
+	{ /*Compute Skinning*/
+		.name = "Skinning",
+		.pipelineCount = 1,
+		.pipelines = {
+			{ /*Skin into the Cache*/
+				"skin",
+				AS_PIPELINETYPE_COMPUTE,
+				_asFillGfxPipeline_Skinning, /*Callback Function*/
+				NULL, /*Callback Data*/
+				1, { /*Code Path Mappings*/
+					0
+				}
+			},
+		},
+		.codePathCount = 1,
+		.codePaths = {
+			{ /*Compute*/
+				"skin",
+				"main",
+				AS_SHADERSTAGE_COMPUTE,
+				AS_QUALITY_LOW,
+				0 /*Macros*/
+			},
 		}
 	},
 };
@@ -0,0 +1,569 @@
+#include "asTextureAtlas.h"
+#include "../common/asBin.h"
+
+/*Packing*/
+
+struct atlasSkylineNode {
+	uint32_t x;
+	uint32_t y; /**< Lowest free row at this span*/
+	uint32_t width;
+};
+
+struct atlasPage {
+	struct atlasSkylineNode* pNodes; /**< Spans covering the whole page width from left to right*/
+	uint32_t nodeCount;
+	uint32_t nodeCapacity;
+};
+
+struct atlasPackOrder {
+	uint32_t width;
+	uint32_t height;
+	size_t index;
+};
+
+static int _atlasCompareOrder(const void* pA, const void* pB)
+{
+	const struct atlasPackOrder* a = (const struct atlasPackOrder*)pA;
+	const struct atlasPackOrder* b = (const struct atlasPackOrder*)pB;
+	if (a->height != b->height)
+		return a->height > b->height ? -1 : 1;
+	if (a->width != b->width)
+		return a->width > b->width ? -1 : 1;
+	return a->index < b->index ? -1 : a->index > b->index;
+}
+
+/*Top of an image placed at the start of a span (false if it leaves the page)*/
+static bool _atlasSkylineFit(const struct atlasPage* pPage, uint32_t node, uint32_t width, uint32_t height, uint32_t pageSize, uint32_t* pY)
+{
+	const uint32_t x = pPage->pNodes[node].x;
+	if (x + width > pageSize)
+		return false;
+	uint32_t y = 0;
+	for (uint32_t covered = 0; covered < width; node++)
+	{
+		if (pPage->pNodes[node].y > y)
+			y = pPage->pNodes[node].y;
+		if (y + height > pageSize)
+			return false;
+		covered += pPage->pNodes[node].width;
+	}
+	*pY = y;
+	return true;
+}
+
+static bool _atlasSkylineInsert(struct atlasPage* pPage, uint32_t node, uint32_t y, uint32_t width, uint32_t height)
+{
+	if (pPage->nodeCount == pPage->nodeCapacity)
+	{
+		const uint32_t capacity = pPage->nodeCapacity ? pPage->nodeCapacity * 2 : 64;
+		struct atlasSkylineNode* pNodes = asRealloc(pPage->pNodes, sizeof(struct atlasSkylineNode) * capacity);
+		if (!pNodes)
+			return false;
+		pPage->pNodes = pNodes;
+		pPage->nodeCapacity = capacity;
+	}
+	struct atlasSkylineNode* pNodes = pPage->pNodes;
+	memmove(&pNodes[node + 1], &pNodes[node], sizeof(struct atlasSkylineNode) * (pPage->nodeCount - node));
+	pNodes[node] = (struct atlasSkylineNode){ pNodes[node + 1].x, y + height, width };
+	pPage->nodeCount++;
+
+	/*Trim the spans now under the image*/
+	for (uint32_t i = node + 1; i < pPage->nodeCount;)
+	{
+		const uint32_t end = pNodes[i - 1].x + pNodes[i - 1].width;
+		if (pNodes[i].x >= end)
+			break;
+		const uint32_t overlap = end - pNodes[i].x;
+		if (pNodes[i].width > overlap)
+		{
+			pNodes[i].x += overlap;
+			pNodes[i].width -= overlap;
+			break;
+		}
+		memmove(&pNodes[i], &pNodes[i + 1], sizeof(struct atlasSkylineNode) * (pPage->nodeCount - i - 1));
+		pPage->nodeCount--;
+	}
+	/*Merge neighbours at the same height*/
+	for (uint32_t i = 0; i + 1 < pPage->nodeCount;)
+	{
+		if (pNodes[i].y == pNodes[i + 1].y)
+		{
+			pNodes[i].width += pNodes[i + 1].width;
+			memmove(&pNodes[i + 1], &pNodes[i + 2], sizeof(struct atlasSkylineNode) * (pPage->nodeCount - i - 2));
+			pPage->nodeCount--;
+		}
+		else
+		{
+			i++;
+		}
+	}
+	return true;
+}
+
+ASEXPORT asResults asTextureAtlas_Pack(asTextureAtlasRect_t* pRects, size_t count, uint32_t maxPageSize, uint32_t padding,
+	uint32_t* pPageWidth, uint32_t* pPageHeight, uint32_t* pPageCount)
+{
+	*pPageWidth = 0;
+	*pPageHeight = 0;
+	*pPageCount = 0;
+	if (!count)
+		return AS_SUCCESS;
+	struct atlasPackOrder* pOrder = asMalloc(sizeof(struct atlasPackOrder) * count);
+	if (!pOrder)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	for (size_t i = 0; i < count; i++)
+	{
+		pOrder[i] = (struct atlasPackOrder){ pRects[i].width + padding * 2, pRects[i].height + padding * 2, i };
+		if (!pRects[i].width || !pRects[i].height)
+		{
+			asFree(pOrder);
+			return AS_FAILURE_INVALID_PARAM;
+		}
+		if (pOrder[i].width > maxPageSize || pOrder[i].height > maxPageSize)
+		{
+			asFree(pOrder);
+			return AS_FAILURE_OUT_OF_BOUNDS;
+		}
+	}
+	/*Tallest first keeps the skyline flat*/
+	qsort(pOrder, count, sizeof(struct atlasPackOrder), _atlasCompareOrder);
+
+	struct atlasPage pages[AS_TEXTURE_ATLAS_MAX_PAGES];
+	uint32_t pageCount = 0;
+	uint32_t usedWidth = 0;
+	uint32_t usedHeight = 0;
+	asResults result = AS_SUCCESS;
+	for (size_t i = 0; i < count && result == AS_SUCCESS; i++)
+	{
+		const uint32_t width = pOrder[i].width;
+		const uint32_t height = pOrder[i].height;
+		uint32_t bestPage = UINT32_MAX;
+		uint32_t bestNode = 0;
+		uint32_t bestY = 0;
+		for (uint32_t p = 0; p < pageCount && bestPage == UINT32_MAX; p++)
+		{
+			/*Lowest top edge, leftmost on ties*/
+			for (uint32_t n = 0; n < pages[p].nodeCount; n++)
+			{
+				uint32_t y;
+				if (_atlasSkylineFit(&pages[p], n, width, height, maxPageSize, &y) &&
+					(bestPage == UINT32_MAX || y < bestY))
+				{
+					bestPage = p;
+					bestNode = n;
+					bestY = y;
+				}
+			}
+		}
+		if (bestPage == UINT32_MAX)
+		{
+			if (pageCount == AS_TEXTURE_ATLAS_MAX_PAGES)
+			{
+				result = AS_FAILURE_OUT_OF_BOUNDS;
+				break;
+			}
+			struct atlasPage* pPage = &pages[pageCount];
+			pPage->pNodes = asMalloc(sizeof(struct atlasSkylineNode) * 64);
+			pPage->nodeCount = 1;
+			pPage->nodeCapacity = 64;
+			if (!pPage->pNodes)
+			{
+				result = AS_FAILURE_OUT_OF_MEMORY;
+				break;
+			}
+			pPage->pNodes[0] = (struct atlasSkylineNode){ 0, 0, maxPageSize };
+			bestPage = pageCount;
+			pageCount++;
+		}
+		const uint32_t x = pages[bestPage].pNodes[bestNode].x;
+		if (!_atlasSkylineInsert(&pages[bestPage], bestNode, bestY, width, height))
+		{
+			result = AS_FAILURE_OUT_OF_MEMORY;
+			break;
+		}
+		asTextureAtlasRect_t* pRect = &pRects[pOrder[i].index];
+		pRect->page = bestPage;
+		pRect->x = x + padding;
+		pRect->y = bestY + padding;
+		if (x + width > usedWidth)
+			usedWidth = x + width;
+		if (bestY + height > usedHeight)
+			usedHeight = bestY + height;
+	}
+	for (uint32_t p = 0; p < pageCount; p++)
+		asFree(pages[p].pNodes);
+	asFree(pOrder);
+	if (result != AS_SUCCESS)
+		return result;
+
+	/*Pages are trimmed to what was used (a lone page is often much smaller than the limit)*/
+	*pPageWidth = usedWidth;
+	*pPageHeight = usedHeight;
+	*pPageCount = pageCount;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asTextureAtlas_Compose(const asTextureAtlasSource_t* pSources, const asTextureAtlasRect_t* pRects, size_t count, uint32_t padding,
+	uint32_t pageWidth, uint32_t pageHeight, uint32_t pageCount, uint8_t* pPages)
+{
+	const size_t pageSize = (size_t)pageWidth * pageHeight * 4;
+	memset(pPages, 0, pageSize * pageCount);
+	for (size_t i = 0; i < count; i++)
+	{
+		const asTextureAtlasSource_t* pSrc = &pSources[i];
+		const asTextureAtlasRect_t* pRect = &pRects[i];
+		uint8_t* pPage = pPages + pageSize * pRect->page;
+		/*Padding repeats the edge pixels*/
+		for (int64_t row = -(int64_t)padding; row < (int64_t)pSrc->height + padding; row++)
+		{
+			const uint32_t srcRow = row < 0 ? 0 : (row >= pSrc->height ? pSrc->height - 1 : (uint32_t)row);
+			const uint8_t* pSrcRow = pSrc->pRGBA + (size_t)srcRow * pSrc->width * 4;
+			uint8_t* pDstRow = pPage + ((size_t)(pRect->y + row) * pageWidth + pRect->x) * 4;
+			for (uint32_t p = 1; p <= padding; p++)
+			{
+				memcpy(pDstRow - p * 4, pSrcRow, 4);
+				memcpy(pDstRow + ((size_t)pSrc->width + p - 1) * 4, pSrcRow + ((size_t)pSrc->width - 1) * 4, 4);
+			}
+			memcpy(pDstRow, pSrcRow, (size_t)pSrc->width * 4);
+		}
+	}
+}
+
+ASEXPORT asTextureAtlasDesc_t asTextureAtlasDesc_Init()
+{
+	asTextureAtlasDesc_t result = (asTextureAtlasDesc_t) { 0 };
+	result.maxPageSize = 2048;
+	result.padding = 1;
+	return result;
+}
+
+/*File*/
+
+typedef struct {
+	uint32_t version;
+	uint32_t pageWidth;
+	uint32_t pageHeight;
+	uint32_t pageCount;
+	uint32_t imageCount;
+	uint32_t reserved;
+} asTextureAtlasFileHeader_t;
+
+typedef struct {
+	asHash64_t nameHash;
+	uint32_t page;
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	uint32_t reserved;
+} asTextureAtlasFileImage_t;
+
+struct atlasName {
+	asHash64_t hash;
+	uint32_t image;
+};
+
+static int _atlasCompareNames(const void* pA, const void* pB)
+{
+	const struct atlasName* a = (const struct atlasName*)pA;
+	const struct atlasName* b = (const struct atlasName*)pB;
+	return a->hash < b->hash ? -1 : a->hash > b->hash;
+}
+
+static asHash64_t _atlasHashName(const char* pName)
+{
+	return asHashBytes64_xxHash(pName, strlen(pName));
+}
+
+static int _atlasCompareFileImages(const void* pA, const void* pB)
+{
+	const asTextureAtlasFileImage_t* a = (const asTextureAtlasFileImage_t*)pA;
+	const asTextureAtlasFileImage_t* b = (const asTextureAtlasFileImage_t*)pB;
+	return a->nameHash < b->nameHash ? -1 : a->nameHash > b->nameHash;
+}
+
+/*Pack and compose the sources (pages are allocated for the caller)*/
+static asResults _atlasBuildPages(const asTextureAtlasDesc_t* pDesc, const asTextureAtlasSource_t* pSources, size_t count,
+	asTextureAtlasRect_t** ppRects, uint8_t** ppPages, uint32_t* pPageWidth, uint32_t* pPageHeight, uint32_t* pPageCount)
+{
+	*ppPages = NULL;
+	*ppRects = asMalloc(sizeof(asTextureAtlasRect_t) * (count + 1));
+	if (!*ppRects)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	for (size_t i = 0; i < count; i++)
+	{
+		(*ppRects)[i] = (asTextureAtlasRect_t){ .width = pSources[i].width, .height = pSources[i].height };
+		if (!pSources[i].pRGBA)
+			return AS_FAILURE_INVALID_PARAM;
+	}
+	asResults result = asTextureAtlas_Pack(*ppRects, count, pDesc->maxPageSize, pDesc->padding, pPageWidth, pPageHeight, pPageCount);
+	if (result != AS_SUCCESS)
+		return result;
+	*ppPages = asMalloc((size_t)*pPageWidth * *pPageHeight * 4 * *pPageCount + 8);
+	if (!*ppPages)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	asTextureAtlas_Compose(pSources, *ppRects, count, pDesc->padding, *pPageWidth, *pPageHeight, *pPageCount, *ppPages);
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asTextureAtlas_WriteFile(const asTextureAtlasDesc_t* pDesc, const asTextureAtlasSource_t* pSources, size_t count, const char* pPath)
+{
+	if (!count || count > UINT32_MAX) { return AS_FAILURE_INVALID_PARAM; }
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!pSources[i].pName) { return AS_FAILURE_INVALID_PARAM; }
+	}
+	asTextureAtlasRect_t* pRects;
+	uint8_t* pPages;
+	asTextureAtlasFileHeader_t header;
+	memset(&header, 0, sizeof(header));
+	asResults result = _atlasBuildPages(pDesc, pSources, count, &pRects, &pPages, &header.pageWidth, &header.pageHeight, &header.pageCount);
+	asTextureAtlasFileImage_t* pImages = result == AS_SUCCESS ? asMalloc(sizeof(asTextureAtlasFileImage_t) * count) : NULL;
+	if (result == AS_SUCCESS && !pImages)
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	if (result == AS_SUCCESS)
+	{
+		/*Images are sorted by name so they can be searched in place*/
+		header.version = AS_TEXTURE_ATLAS_VERSION;
+		header.imageCount = (uint32_t)count;
+		for (size_t i = 0; i < count; i++)
+		{
+			pImages[i] = (asTextureAtlasFileImage_t){
+				.nameHash = _atlasHashName(pSources[i].pName),
+				.page = pRects[i].page,
+				.x = pRects[i].x,
+				.y = pRects[i].y,
+				.width = pRects[i].width,
+				.height = pRects[i].height
+			};
+		}
+		qsort(pImages, count, sizeof(asTextureAtlasFileImage_t), _atlasCompareFileImages);
+		for (size_t i = 1; i < count && result == AS_SUCCESS; i++)
+		{
+			if (pImages[i].nameHash == pImages[i - 1].nameHash)
+				result = AS_FAILURE_DUPLICATE_ENTRY;
+		}
+	}
+	if (result == AS_SUCCESS)
+	{
+		/*Padded to keep the asBin section table that follows aligned*/
+		const size_t pagesSize = (size_t)header.pageWidth * header.pageHeight * 4 * header.pageCount;
+		memset(pPages + pagesSize, 0, 8);
+		asBinWriter writer;
+		result = asBinWriterOpen(&writer, AS_TEXTURE_ATLAS_TAG, pPath, 3);
+		if (result == AS_SUCCESS)
+		{
+			asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "ATLSHEAD", 0 }, (unsigned char*)&header, sizeof(header));
+			asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "IMAGES", 0 }, (unsigned char*)pImages, sizeof(asTextureAtlasFileImage_t) * count);
+			asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "PAGEDATA", 0 }, pPages, (pagesSize + 7u) & ~(size_t)7u);
+			result = asBinWriterClose(&writer);
+		}
+	}
+	asFree(pImages);
+	asFree(pPages);
+	asFree(pRects);
+	return result;
+}
+
+/*Runtime*/
+
+static void _atlasFree(asTextureAtlas_t* pAtlas)
+{
+	asFree(pAtlas->pImages);
+	asFree(pAtlas->pNameHashes);
+	asFree(pAtlas->pNameImages);
+	memset(pAtlas, 0, sizeof(asTextureAtlas_t));
+}
+
+/*Every page is uploaded in one batch and takes one pool slot*/
+static asResults _atlasCreatePages(asTextureAtlas_t* pAtlas, const uint8_t* pPages, uint32_t pageWidth, uint32_t pageHeight, uint32_t pageCount,
+	const char* pDebugLabel)
+{
+	const size_t pageSize = (size_t)pageWidth * pageHeight * 4;
+	asTextureDesc_t* pDescs = asMalloc(sizeof(asTextureDesc_t) * pageCount);
+	if (!pDescs)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < pageCount; i++)
+	{
+		asTextureDesc_t* pDesc = &pDescs[i];
+		*pDesc = asTextureDesc_Init();
+		pDesc->usageFlags = AS_TEXTUREUSAGE_SAMPLED;
+		pDesc->cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+		pDesc->format = AS_COLORFORMAT_RGBA8_UNORM;
+		pDesc->width = pageWidth;
+		pDesc->height = pageHeight;
+		pDesc->initialContentsBufferSize = pageSize;
+		pDesc->pInitialContentsBuffer = pPages + pageSize * i;
+		pDesc->initialContentsRegionCount = 1;
+		asTextureContentRegion_t* pRegion = &pDesc->arrInitialContentsRegions[0];
+		pRegion->extent[0] = pageWidth;
+		pRegion->extent[1] = pageHeight;
+		pRegion->extent[2] = 1;
+		pRegion->layerCount = 1;
+		pRegion->bufferSize = (uint32_t)pageSize;
+		pDesc->pDebugLabel = pDebugLabel ? pDebugLabel : "TextureAtlas";
+	}
+	asResults result = asCreateTextures(pDescs, pageCount, pAtlas->pages);
+	asFree(pDescs);
+	if (result != AS_SUCCESS)
+		return result;
+	pAtlas->pageCount = pageCount;
+	for (uint32_t i = 0; i < pageCount && result == AS_SUCCESS; i++)
+		result = asTexturePoolAddFromHandle(pAtlas->pages[i], &pAtlas->pageIndices[i]);
+	return result;
+}
+
+static void _atlasSetImage(asTextureAtlas_t* pAtlas, uint32_t index, uint32_t page, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+	uint32_t pageWidth, uint32_t pageHeight)
+{
+	asTextureAtlasImage_t* pImage = &pAtlas->pImages[index];
+	pImage->textureIndex = pAtlas->pageIndices[page];
+	pImage->page = page;
+	pImage->uvMin[0] = (float)x / (float)pageWidth;
+	pImage->uvMin[1] = (float)y / (float)pageHeight;
+	pImage->uvMax[0] = (float)(x + width) / (float)pageWidth;
+	pImage->uvMax[1] = (float)(y + height) / (float)pageHeight;
+	pImage->width = width;
+	pImage->height = height;
+}
+
+ASEXPORT asResults asCreateTextureAtlas(asTextureAtlas_t* pOut, const asTextureAtlasDesc_t* pDesc, const asTextureAtlasSource_t* pSources, size_t count)
+{
+	memset(pOut, 0, sizeof(asTextureAtlas_t));
+	if (!count || count > UINT32_MAX) { return AS_FAILURE_INVALID_PARAM; }
+	asTextureAtlasRect_t* pRects;
+	uint8_t* pPages;
+	uint32_t pageWidth, pageHeight, pageCount;
+	asResults result = _atlasBuildPages(pDesc, pSources, count, &pRects, &pPages, &pageWidth, &pageHeight, &pageCount);
+	if (result == AS_SUCCESS)
+		result = _atlasCreatePages(pOut, pPages, pageWidth, pageHeight, pageCount, pDesc->pDebugLabel);
+	asFree(pPages);
+
+	/*Images keep the order of the sources, named ones can also be found by name*/
+	struct atlasName* pNames = result == AS_SUCCESS ? asMalloc(sizeof(struct atlasName) * count) : NULL;
+	pOut->pImages = result == AS_SUCCESS ? asMalloc(sizeof(asTextureAtlasImage_t) * count) : NULL;
+	if (result == AS_SUCCESS && (!pNames || !pOut->pImages))
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	if (result == AS_SUCCESS)
+	{
+		pOut->imageCount = (uint32_t)count;
+		for (uint32_t i = 0; i < pOut->imageCount; i++)
+		{
+			_atlasSetImage(pOut, i, pRects[i].page, pRects[i].x, pRects[i].y, pRects[i].width, pRects[i].height, pageWidth, pageHeight);
+			if (pSources[i].pName)
+			{
+				pNames[pOut->nameCount].hash = _atlasHashName(pSources[i].pName);
+				pNames[pOut->nameCount].image = i;
+				pOut->nameCount++;
+			}
+		}
+		qsort(pNames, pOut->nameCount, sizeof(struct atlasName), _atlasCompareNames);
+		pOut->pNameHashes = asMalloc(sizeof(asHash64_t) * (pOut->nameCount + 1));
+		pOut->pNameImages = asMalloc(sizeof(uint32_t) * (pOut->nameCount + 1));
+		if (!pOut->pNameHashes || !pOut->pNameImages)
+			result = AS_FAILURE_OUT_OF_MEMORY;
+		for (uint32_t i = 0; i < pOut->nameCount && result == AS_SUCCESS; i++)
+		{
+			pOut->pNameHashes[i] = pNames[i].hash;
+			pOut->pNameImages[i] = pNames[i].image;
+		}
+	}
+	asFree(pNames);
+	asFree(pRects);
+	if (result != AS_SUCCESS)
+		asReleaseTextureAtlas(pOut);
+	return result;
+}
+
+ASEXPORT asResults asCreateTextureAtlasFromData(asTextureAtlas_t* pOut, const void* pBlob, size_t blobSize, const char* pDebugLabel)
+{
+	memset(pOut, 0, sizeof(asTextureAtlas_t));
+	asBinReader reader;
+	asTextureAtlasFileHeader_t* pHeader = NULL;
+	asTextureAtlasFileImage_t* pImages = NULL;
+	unsigned char* pPages = NULL;
+	size_t headerSize = 0, imagesSize = 0, pagesSize = 0;
+	asResults result = asBinReaderOpenMemory(&reader, AS_TEXTURE_ATLAS_TAG, (unsigned char*)pBlob, blobSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "ATLSHEAD", 0 }, (unsigned char**)&pHeader, &headerSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "IMAGES", 0 }, (unsigned char**)&pImages, &imagesSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "PAGEDATA", 0 }, &pPages, &pagesSize);
+	if (result != AS_SUCCESS)
+		return result;
+	const unsigned char* pEnd = (const unsigned char*)pBlob + blobSize;
+	if (headerSize != sizeof(asTextureAtlasFileHeader_t) ||
+		(const unsigned char*)pHeader + headerSize > pEnd ||
+		(const unsigned char*)pImages + imagesSize > pEnd ||
+		pPages + pagesSize > pEnd ||
+		pHeader->version != AS_TEXTURE_ATLAS_VERSION)
+		return AS_FAILURE_UNKNOWN_FORMAT;
+	if (!pHeader->pageCount || pHeader->pageCount > AS_TEXTURE_ATLAS_MAX_PAGES ||
+		imagesSize != sizeof(asTextureAtlasFileImage_t) * pHeader->imageCount ||
+		pagesSize < (size_t)pHeader->pageWidth * pHeader->pageHeight * 4 * pHeader->pageCount)
+		return AS_FAILURE_OUT_OF_BOUNDS;
+	for (uint32_t i = 0; i < pHeader->imageCount; i++)
+	{
+		const asTextureAtlasFileImage_t* pImage = &pImages[i];
+		if (pImage->page >= pHeader->pageCount ||
+			(uint64_t)pImage->x + pImage->width > pHeader->pageWidth ||
+			(uint64_t)pImage->y + pImage->height > pHeader->pageHeight)
+			return AS_FAILURE_OUT_OF_BOUNDS;
+	}
+
+	/*Images are already sorted by name*/
+	pOut->pImages = asMalloc(sizeof(asTextureAtlasImage_t) * (pHeader->imageCount + 1));
+	pOut->pNameHashes = asMalloc(sizeof(asHash64_t) * (pHeader->imageCount + 1));
+	pOut->pNameImages = asMalloc(sizeof(uint32_t) * (pHeader->imageCount + 1));
+	if (!pOut->pImages || !pOut->pNameHashes || !pOut->pNameImages)
+	{
+		_atlasFree(pOut);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	result = _atlasCreatePages(pOut, pPages, pHeader->pageWidth, pHeader->pageHeight, pHeader->pageCount, pDebugLabel);
+	if (result != AS_SUCCESS)
+	{
+		asReleaseTextureAtlas(pOut);
+		return result;
+	}
+	pOut->imageCount = pHeader->imageCount;
+	pOut->nameCount = pHeader->imageCount;
+	for (uint32_t i = 0; i < pHeader->imageCount; i++)
+	{
+		const asTextureAtlasFileImage_t* pImage = &pImages[i];
+		_atlasSetImage(pOut, i, pImage->page, pImage->x, pImage->y, pImage->width, pImage->height, pHeader->pageWidth, pHeader->pageHeight);
+		pOut->pNameHashes[i] = pImage->nameHash;
+		pOut->pNameImages[i] = i;
+	}
+	return AS_SUCCESS;
+}
+
+ASEXPORT const asTextureAtlasImage_t* asTextureAtlas_Find(const asTextureAtlas_t* pAtlas, const char* pName)
+{
+	const asHash64_t hash = _atlasHashName(pName);
+	uint32_t low = 0;
+	uint32_t high = pAtlas->nameCount;
+	while (low < high)
+	{
+		const uint32_t mid = low + (high - low) / 2;
+		if (pAtlas->pNameHashes[mid] < hash)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low < pAtlas->nameCount && pAtlas->pNameHashes[low] == hash)
+		return &pAtlas->pImages[pAtlas->pNameImages[low]];
+	return NULL;
+}
+
+ASEXPORT void asReleaseTextureAtlas(asTextureAtlas_t* pAtlas)
+{
+	for (uint32_t i = 0; i < pAtlas->pageCount; i++)
+	{
+		if (pAtlas->pageIndices[i] != AS_TEXTURE_POOL_MISSING_INDEX)
+			asTexturePoolRelease(pAtlas->pageIndices[i]);
+		asReleaseTexture(pAtlas->pages[i]);
+	}
+	_atlasFree(pAtlas);
+}
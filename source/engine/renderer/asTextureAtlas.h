@@ -0,0 +1,135 @@
+#ifndef _ASTEXTUREATLAS_H_
+#define _ASTEXTUREATLAS_H_
+
+#include "../common/asCommon.h"
+#include "asRendererCore.h"
+#include "asBindlessTexturePool.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Atlases for small UI and sprite images (asBin "ATLS")
+* Images are packed into a few shared 8 bit RGBA pages, each page takes a single slot in the bindless pool
+* so thousands of distinct images can be drawn by their slot and UV rectangle (ImTextureID is the slot).
+* Packing works the same when cooking and at runtime
+*/
+
+#define AS_TEXTURE_ATLAS_TAG "ATLS"
+#define AS_TEXTURE_ATLAS_VERSION 1
+#define AS_TEXTURE_ATLAS_MAX_PAGES 64
+
+/**
+* @brief Placement of an image in an atlas
+*/
+typedef struct {
+	uint32_t width; /**< Width of the image in pixels (input)*/
+	uint32_t height; /**< Height of the image in pixels (input)*/
+	uint32_t page; /**< Page the image was placed on*/
+	uint32_t x; /**< Left of the image on its page (past the padding)*/
+	uint32_t y; /**< Top of the image on its page (past the padding)*/
+} asTextureAtlasRect_t;
+
+/**
+* @brief Pack images into as few pages as possible (skyline bottom left, tallest images first)
+* @param maxPageSize largest width and height of a page
+* @param padding pixels kept around each image (filled with its edges when composed so filtering does not bleed)
+* @param pPageWidth filled with the width every page needs (only as large as the packed images)
+* @param pPageHeight filled with the height every page needs (only as large as the packed images)
+* @return AS_FAILURE_OUT_OF_BOUNDS if an image does not fit on a page or more than AS_TEXTURE_ATLAS_MAX_PAGES are needed
+*/
+ASEXPORT asResults asTextureAtlas_Pack(asTextureAtlasRect_t* pRects, size_t count, uint32_t maxPageSize, uint32_t padding,
+	uint32_t* pPageWidth, uint32_t* pPageHeight, uint32_t* pPageCount);
+
+/**
+* @brief An image to place in an atlas
+*/
+typedef struct {
+	const uint8_t* pRGBA; /**< 8 bit RGBA pixels with rows packed together*/
+	uint32_t width;
+	uint32_t height;
+	const char* pName; /**< Name to find the image by (optional)*/
+} asTextureAtlasSource_t;
+
+/**
+* @brief Copy packed images into their pages
+* @param pPages pageWidth * pageHeight * 4 bytes for every page, cleared to transparent first
+*/
+ASEXPORT void asTextureAtlas_Compose(const asTextureAtlasSource_t* pSources, const asTextureAtlasRect_t* pRects, size_t count, uint32_t padding,
+	uint32_t pageWidth, uint32_t pageHeight, uint32_t pageCount, uint8_t* pPages);
+
+/**
+* @brief Description for building an atlas
+*/
+typedef struct {
+	uint32_t maxPageSize; /**< Largest width and height of a page*/
+	uint32_t padding; /**< Pixels kept around each image*/
+	const char* pDebugLabel; /**< Debug name of the pages*/
+} asTextureAtlasDesc_t;
+
+/**
+* @brief Set the defaults for an atlas (up to 2048x2048 pages with a pixel of padding)
+*/
+ASEXPORT asTextureAtlasDesc_t asTextureAtlasDesc_Init();
+
+/**
+* @brief Pack images and write them out as an atlas file (meant for cooking)
+* every source needs a name
+*/
+ASEXPORT asResults asTextureAtlas_WriteFile(const asTextureAtlasDesc_t* pDesc, const asTextureAtlasSource_t* pSources, size_t count, const char* pPath);
+
+/**
+* @brief Where an image of an atlas is drawn from
+*/
+typedef struct {
+	asBindlessTextureIndex textureIndex; /**< Pool slot of the page*/
+	uint32_t page; /**< Page of the atlas*/
+	float uvMin[2]; /**< Top left UV on the page*/
+	float uvMax[2]; /**< Bottom right UV on the page*/
+	uint32_t width; /**< Width in pixels*/
+	uint32_t height; /**< Height in pixels*/
+} asTextureAtlasImage_t;
+
+/**
+* @brief A set of pages in the texture pool and the images on them
+*/
+typedef struct {
+	asTextureHandle_t pages[AS_TEXTURE_ATLAS_MAX_PAGES];
+	asBindlessTextureIndex pageIndices[AS_TEXTURE_ATLAS_MAX_PAGES];
+	uint32_t pageCount;
+	uint32_t imageCount;
+	asTextureAtlasImage_t* pImages; /**< In the order of the sources (or the order of the file)*/
+	uint32_t nameCount;
+	asHash64_t* pNameHashes; /**< Sorted hashes of the image names*/
+	uint32_t* pNameImages; /**< Image of each name hash*/
+} asTextureAtlas_t;
+
+/**
+* @brief Pack images into pages, upload them together and add the pages to the texture pool
+* @param pOut images are in the same order as the sources
+*/
+ASEXPORT asResults asCreateTextureAtlas(asTextureAtlas_t* pOut, const asTextureAtlasDesc_t* pDesc, const asTextureAtlasSource_t* pSources, size_t count);
+
+/**
+* @brief Create an atlas from a cooked atlas file (pages are uploaded straight from the data, no copies)
+* meant for mapped files (asResourceFileView_t), the data only needs to stay valid during the call
+*/
+ASEXPORT asResults asCreateTextureAtlasFromData(asTextureAtlas_t* pOut, const void* pBlob, size_t blobSize, const char* pDebugLabel);
+
+/**
+* @brief Find an image by the name it was packed with
+* @return NULL if the atlas has no image by that name
+*/
+ASEXPORT const asTextureAtlasImage_t* asTextureAtlas_Find(const asTextureAtlas_t* pAtlas, const char* pName);
+
+/**
+* @brief Release the pages of an atlas from the pool
+* @warning the pages must not be in use by frames in flight
+*/
+ASEXPORT void asReleaseTextureAtlas(asTextureAtlas_t* pAtlas);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,30 +1,31 @@
 #include "tiny_ktx/tinyktx.h"
 #include "asTextureFromKtx.h"
 
-struct ktxFromBlobData
+struct ktxSourceData
 {
 	int64_t pos;
-	void* pKtxBlob;
+	const void* pKtxBlob; /*Either a blob*/
+	asResourceLoader_t* pLoader; /*Or a loader*/
 	size_t blobSize;
 	asResults error;
 };
 
 void ktxError(void* user, char const* msg)
 {
-	struct ktxFromBlobData* pData = (struct ktxFromBlobData*)user;
+	struct ktxSourceData* pData = (struct ktxSourceData*)user;
 	asDebugError("KTX Error: %s", msg);
 	pData->error = AS_FAILURE_UNKNOWN;
 }
 
 int64_t ktxTellBlob(void* user)
 {
-	struct ktxFromBlobData* pData = (struct ktxFromBlobData*)user;
+	struct ktxSourceData* pData = (struct ktxSourceData*)user;
 	return pData->pos;
 }
 
 bool ktxSeekBlob(void* user, int64_t offset)
 {
-	struct ktxFromBlobData* pData = (struct ktxFromBlobData*)user;
+	struct ktxSourceData* pData = (struct ktxSourceData*)user;
 	pData->pos = offset < pData->blobSize ? offset : pData->blobSize;
 	return (bool)(pData->pos < pData->blobSize);
 }
@@ -41,9 +42,17 @@ void ktxFree(void* user, void* memory)
 
 size_t ktxReadBlob(void* user, void* buffer, size_t byteCount)
 {
-	struct ktxFromBlobData* pData = (struct ktxFromBlobData*)user;
+	struct ktxSourceData* pData = (struct ktxSourceData*)user;
 	size_t actualRead = byteCount <= pData->blobSize - pData->pos ? byteCount : pData->blobSize - pData->pos;
-	memcpy(buffer, (unsigned char*)pData->pKtxBlob + pData->pos, actualRead);
+	if (pData->pLoader)
+	{
+		asResourceLoader_SetReadPoint(pData->pLoader, (size_t)pData->pos);
+		asResourceLoader_Read(pData->pLoader, actualRead, buffer);
+	}
+	else
+	{
+		memcpy(buffer, (const unsigned char*)pData->pKtxBlob + pData->pos, actualRead);
+	}
 	pData->pos += actualRead;
 	return actualRead;
 }
@@ -71,15 +80,38 @@ asColorFormat convertInternalFormat(TinyKtx_ContextHandle ctx)
 	}
 }
 
-#define KTX_TMP_RETURNIFERROR() if(blobData.error != AS_SUCCESS){return blobData.error;}
-ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBlob, size_t blobSize)
+static TinyKtx_Format convertToKtxFormat(asColorFormat format)
+{
+	switch (format) {
+	default: return TKTX_UNDEFINED;
+	case AS_COLORFORMAT_RGBA8_UNORM: return TKTX_R8G8B8A8_UNORM;
+	case AS_COLORFORMAT_RGBA16_UNORM: return TKTX_R16G16B16A16_UNORM;
+	case AS_COLORFORMAT_RGBA16_UINT: return TKTX_R16G16B16A16_UINT;
+	case AS_COLORFORMAT_RGBA16_SFLOAT: return TKTX_R16G16B16A16_SFLOAT;
+	case AS_COLORFORMAT_RGBA32_SFLOAT: return TKTX_R32G32B32A32_SFLOAT;
+	case AS_COLORFORMAT_A2R10G10B10_UNORM: return TKTX_A2R10G10B10_UNORM_PACK32;
+	case AS_COLORFORMAT_B10G11R11_UFLOAT: return TKTX_B10G11R11_UFLOAT_PACK32;
+	case AS_COLORFORMAT_R8_UNORM: return TKTX_R8_UNORM;
+	case AS_COLORFORMAT_R16_UNORM: return TKTX_R16_UNORM;
+	case AS_COLORFORMAT_R16_SFLOAT: return TKTX_R16_SFLOAT;
+	case AS_COLORFORMAT_R32_SFLOAT: return TKTX_R32_SFLOAT;
+	case AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK: return TKTX_BC1_RGBA_UNORM_BLOCK;
+	case AS_COLORFORMAT_BC3_UNORM_BLOCK: return TKTX_BC3_UNORM_BLOCK;
+	case AS_COLORFORMAT_BC5_UNORM_BLOCK: return TKTX_BC5_UNORM_BLOCK;
+	case AS_COLORFORMAT_BC6H_UFLOAT_BLOCK: return TKTX_BC6H_UFLOAT_BLOCK;
+	case AS_COLORFORMAT_BC7_UNORM_BLOCK: return TKTX_BC7_UNORM_BLOCK;
+	}
+}
+
+/*Reads the header and the mip sizes only, regions are filled with the location of each mip within the source*/
+#define KTX_TMP_RETURNIFERROR() if(pSrc->error != AS_SUCCESS){TinyKtx_DestroyContext(ctx); return pSrc->error;}
+static asResults _ktxDescFromSource(asTextureDesc_t* pOut, struct ktxSourceData* pSrc)
 {
 	/*Defaults*/
 	*pOut = asTextureDesc_Init();
 
 	/*Create Ktx Read Context*/
-	struct ktxFromBlobData blobData = { 0, pKtxBlob, blobSize, AS_SUCCESS };
-	TinyKtx_ContextHandle ctx = TinyKtx_CreateContext(&(TinyKtx_Callbacks) 
+	TinyKtx_ContextHandle ctx = TinyKtx_CreateContext(&(TinyKtx_Callbacks)
 	{
 		.errorFn = ktxError,
 		.tellFn = ktxTellBlob,
@@ -88,12 +120,13 @@ ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBl
 		.allocFn = ktxMalloc,
 		.freeFn = ktxFree
 	},
-	&blobData);
-	KTX_TMP_RETURNIFERROR();
-	
+	pSrc);
+	if (!ctx) { return AS_FAILURE_OUT_OF_MEMORY; }
+
 	/*Read Header*/
 	TinyKtx_ReadHeader(ctx);
 	KTX_TMP_RETURNIFERROR();
+	const int64_t firstImagePos = pSrc->pos;
 
 	/*Fill out Extents*/
 	const uint32_t width = pOut->width = TinyKtx_Width(ctx);
@@ -103,6 +136,7 @@ ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBl
 	const uint32_t completeDepth = pOut->depth = (depth > 1 ? depth : slices);
 	const uint32_t mipCount = TinyKtx_NumberOfMipmaps(ctx);
 	pOut->mips = mipCount;
+	if (mipCount > AS_TEXTURE_MAX_REGIONS) { TinyKtx_DestroyContext(ctx); return AS_FAILURE_OUT_OF_BOUNDS; }
 
 	/*Decide on Type*/
 	if (TinyKtx_Is2D(ctx)) {
@@ -116,24 +150,22 @@ ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBl
 		}
 	}
 	else if (TinyKtx_Is3D(ctx)) { pOut->type = AS_TEXTURETYPE_3D; }
-	else { return AS_FAILURE_UNKNOWN_FORMAT; }
+	else { TinyKtx_DestroyContext(ctx); return AS_FAILURE_UNKNOWN_FORMAT; }
 
 	/*Decide on Format*/
 	pOut->format = convertInternalFormat(ctx);
-	if (pOut->format == AS_COLORFORMAT_MAX) { return AS_FAILURE_UNKNOWN_FORMAT; }
-	
-	/*Get Dest Image Size*/
-	size_t finalImageSize = 0;
-	for (uint32_t i = 0; i < mipCount; i++){ finalImageSize += TinyKtx_ImageSize(ctx, i);}
-	pOut->initialContentsBufferSize = finalImageSize;
-	pOut->pInitialContentsBuffer = asMalloc(finalImageSize);
-	pOut->initialContentsRegionCount = mipCount;
+	if (pOut->format == AS_COLORFORMAT_MAX) { TinyKtx_DestroyContext(ctx); return AS_FAILURE_UNKNOWN_FORMAT; }
 
-	size_t buffStart = 0;
+	/*Locate each mip (each one is preceded by its size and padded to 4 bytes)*/
+	pOut->initialContentsRegionCount = mipCount;
+	int64_t mipPos = firstImagePos;
+	size_t totalSize = 0;
 	uint32_t w = width, h = height, d = depth;
 	for (uint32_t i = 0; i < mipCount; i++)
 	{
-		const imgBuffSize = TinyKtx_ImageSize(ctx, i);
+		const uint32_t imgBuffSize = TinyKtx_ImageSize(ctx, i);
+		KTX_TMP_RETURNIFERROR();
+		if (!imgBuffSize || mipPos + sizeof(uint32_t) + imgBuffSize > pSrc->blobSize) { TinyKtx_DestroyContext(ctx); return AS_FAILURE_OUT_OF_BOUNDS; }
 		asTextureContentRegion_t* region = &pOut->arrInitialContentsRegions[i];
 		region->extent[0] = w;
 		region->extent[1] = h;
@@ -142,21 +174,142 @@ ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBl
 		region->layerCount = slices;
 		region->mipLevel = i;
 		memset(region->offset, 0, sizeof(uint32_t) * 3);
-		region->bufferStart = buffStart;
-		const void* mipData = TinyKtx_ImageRawData(ctx, i);
-		memcpy((unsigned char*)pOut->pInitialContentsBuffer + buffStart, mipData, imgBuffSize);
+		region->bufferStart = mipPos + sizeof(uint32_t);
+		region->bufferSize = imgBuffSize;
 
 		if (w > 1) w = w / 2;
 		if (h > 1) h = h / 2;
 		if (d > 1) d = d / 2;
-		buffStart += imgBuffSize;
+		mipPos += (imgBuffSize + sizeof(uint32_t) + 3u) & ~3u;
+		totalSize += imgBuffSize;
 	}
+	pOut->initialContentsBufferSize = totalSize;
 
-	KTX_TMP_RETURNIFERROR();
+	TinyKtx_DestroyContext(ctx);
+	return pSrc->error;
+}
+
+ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBlob, size_t blobSize)
+{
+	struct ktxSourceData srcData = { 0, pKtxBlob, NULL, blobSize, AS_SUCCESS };
+	asResults result = _ktxDescFromSource(pOut, &srcData);
+	if (result != AS_SUCCESS)
+		return result;
+
+	/*Copy each mip into a tightly packed buffer*/
+	unsigned char* pBuffer = asMalloc(pOut->initialContentsBufferSize);
+	if (!pBuffer)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	size_t buffStart = 0;
+	for (uint32_t i = 0; i < pOut->initialContentsRegionCount; i++)
+	{
+		asTextureContentRegion_t* region = &pOut->arrInitialContentsRegions[i];
+		memcpy(pBuffer + buffStart, (unsigned char*)pKtxBlob + region->bufferStart, region->bufferSize);
+		region->bufferStart = buffStart;
+		buffStart += region->bufferSize;
+	}
+	pOut->pInitialContentsBuffer = pBuffer;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asTextureDesc_FromKtxDataInPlace(asTextureDesc_t* pOut, const void* pKtxBlob, size_t blobSize)
+{
+	struct ktxSourceData srcData = { 0, pKtxBlob, NULL, blobSize, AS_SUCCESS };
+	asResults result = _ktxDescFromSource(pOut, &srcData);
+	if (result != AS_SUCCESS)
+		return result;
+
+	/*Regions already point at the mips within the blob*/
+	pOut->pInitialContentsBuffer = pKtxBlob;
+	pOut->initialContentsBufferSize = blobSize;
+	return AS_SUCCESS;
+}
+
+static asResults _ktxWriteFromLoader(void* pDst, const asTextureContentRegion_t* pRegion, void* pUserData)
+{
+	asResourceLoader_t* pLoader = (asResourceLoader_t*)pUserData;
+	asResults result = asResourceLoader_SetReadPoint(pLoader, pRegion->bufferStart);
+	if (result != AS_SUCCESS)
+		return result;
+	return asResourceLoader_Read(pLoader, pRegion->bufferSize, pDst);
+}
+
+ASEXPORT asResults asTextureDesc_FromKtxLoader(asTextureDesc_t* pOut, asResourceLoader_t* pLoader)
+{
+	struct ktxSourceData srcData = { 0, NULL, pLoader, asResourceLoader_GetContentSize(pLoader), AS_SUCCESS };
+	asResults result = _ktxDescFromSource(pOut, &srcData);
+	if (result != AS_SUCCESS)
+		return result;
+
+	/*Regions point at the mips within the file, they are read when the upload memory is ready*/
+	pOut->pfnWriteInitialContents = _ktxWriteFromLoader;
+	pOut->pWriteInitialContentsUserData = pLoader;
 	return AS_SUCCESS;
 }
 
 ASEXPORT void asTextureDesc_FreeKtxData(asTextureDesc_t* pOut)
 {
-	asFree(pOut->pInitialContentsBuffer);
+	asFree((void*)pOut->pInitialContentsBuffer);
+	pOut->pInitialContentsBuffer = NULL;
+}
+
+struct ktxWriteData
+{
+	FILE* fp;
+	bool failed;
+};
+
+static void ktxWriteError(void* user, char const* msg)
+{
+	struct ktxWriteData* pData = (struct ktxWriteData*)user;
+	asDebugError("KTX Error: %s", msg);
+	pData->failed = true;
+}
+
+static void ktxWriteFile(void* user, void const* buffer, size_t byteCount)
+{
+	struct ktxWriteData* pData = (struct ktxWriteData*)user;
+	if (!pData->failed && fwrite(buffer, 1, byteCount, pData->fp) != byteCount)
+		pData->failed = true;
+}
+
+ASEXPORT asResults asTextureDesc_WriteKtxFile(const asTextureDesc_t* pDesc, const char* pPath)
+{
+	const TinyKtx_Format format = convertToKtxFormat(pDesc->format);
+	if (format == TKTX_UNDEFINED) { return AS_FAILURE_UNKNOWN_FORMAT; }
+	const asTextureContentRegion_t* pRegions = pDesc->pInitialContentsRegions ? pDesc->pInitialContentsRegions : pDesc->arrInitialContentsRegions;
+	const uint32_t mipCount = (uint32_t)pDesc->initialContentsRegionCount;
+	if (!pDesc->pInitialContentsBuffer || !mipCount || mipCount > AS_TEXTURE_MAX_REGIONS) { return AS_FAILURE_INVALID_PARAM; }
+
+	/*One region per mip in order*/
+	uint32_t mipSizes[AS_TEXTURE_MAX_REGIONS];
+	const void* pMips[AS_TEXTURE_MAX_REGIONS];
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		if (pRegions[i].mipLevel != i || !pRegions[i].bufferSize) { return AS_FAILURE_INVALID_PARAM; }
+		if ((size_t)pRegions[i].bufferStart + pRegions[i].bufferSize > pDesc->initialContentsBufferSize) { return AS_FAILURE_OUT_OF_BOUNDS; }
+		mipSizes[i] = pRegions[i].bufferSize;
+		pMips[i] = (const unsigned char*)pDesc->pInitialContentsBuffer + pRegions[i].bufferStart;
+	}
+
+	struct ktxWriteData writeData = { NULL, false };
+	writeData.fp = fopen(pPath, "wb");
+	if (!writeData.fp) { return AS_FAILURE_FILE_INACCESSIBLE; }
+	const bool cubemap = pDesc->type == AS_TEXTURETYPE_CUBE || pDesc->type == AS_TEXTURETYPE_CUBEARRAY;
+	const bool array = pDesc->type == AS_TEXTURETYPE_2DARRAY || pDesc->type == AS_TEXTURETYPE_CUBEARRAY;
+	const bool written = TinyKtx_WriteImage(&(TinyKtx_WriteCallbacks)
+	{
+		.errorFn = ktxWriteError,
+		.allocFn = ktxMalloc,
+		.freeFn = ktxFree,
+		.writeFn = ktxWriteFile
+	},
+	&writeData,
+	pDesc->width,
+	pDesc->height,
+	pDesc->type == AS_TEXTURETYPE_3D ? pDesc->depth : 0,
+	array ? pDesc->depth : 0,
+	mipCount, format, cubemap, mipSizes, pMips);
+	fclose(writeData.fp);
+	return (written && !writeData.failed) ? AS_SUCCESS : AS_FAILURE_FILE_INACCESSIBLE;
 }
@@ -3,18 +3,43 @@
 
 #include "../common/asCommon.h"
 #include "asRendererCore.h"
+#include "../resource/asResource.h"
 #ifdef __cplusplus
 extern "C" {
 #endif 
 
 /**
 * @brief Fills out the data for a texture description from ktx (usually loaded from a file)
-* user is responsible for freeing ktx data
+* the mips are copied into a new buffer, user is responsible for freeing ktx data
+* @warning free the description with asTextureDesc_FreeKtxData()
 */
 ASEXPORT asResults asTextureDesc_FromKtxData(asTextureDesc_t* pOut, void* pKtxBlob, size_t blobSize);
 
+/**
+* @brief Fills out the data for a texture description that points directly at the mips inside the ktx data (no copies)
+* meant for mapped files (asResourceFileView_t), the data must stay valid until the texture is created
+* @warning do not call asTextureDesc_FreeKtxData() on the result
+*/
+ASEXPORT asResults asTextureDesc_FromKtxDataInPlace(asTextureDesc_t* pOut, const void* pKtxBlob, size_t blobSize);
+
+/**
+* @brief Fills out the data for a texture description by reading only the ktx header from a loader
+* the mips are read from the loader straight into upload memory when the texture is created
+* @warning the loader must stay open until the texture is created, do not call asTextureDesc_FreeKtxData() on the result
+*/
+ASEXPORT asResults asTextureDesc_FromKtxLoader(asTextureDesc_t* pOut, asResourceLoader_t* pLoader);
+
+/**
+* @brief Free the buffer allocated by asTextureDesc_FromKtxData()
+*/
 ASEXPORT void asTextureDesc_FreeKtxData(asTextureDesc_t* pOut);
 
+/**
+* @brief Write a texture description out as a ktx file (meant for cooking)
+* each region of the initial contents must be a whole mip in order, starting at the top mip
+*/
+ASEXPORT asResults asTextureDesc_WriteKtxFile(const asTextureDesc_t* pDesc, const char* pPath);
+
 #ifdef __cplusplus
 }
 #endif
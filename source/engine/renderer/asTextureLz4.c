@@ -0,0 +1,292 @@
+#include "asTextureLz4.h"
+#include "../common/asBin.h"
+#include "../thread/asJobSystem.h"
+
+#include "lz4/lz4.h"
+#include "lz4/lz4hc.h"
+
+#define LZ4TEX_CHUNK_PADDED(_size) (((_size) + sizeof(uint32_t) + 3u) & ~(size_t)3u)
+
+static uint32_t _lz4ChunkCount(uint32_t size)
+{
+	return (uint32_t)((size + (size_t)AS_TEXTURE_LZ4_CHUNK_SIZE - 1) / AS_TEXTURE_LZ4_CHUNK_SIZE);
+}
+
+static uint32_t _lz4ChunkSize(uint32_t size, uint32_t chunk)
+{
+	const size_t start = (size_t)chunk * AS_TEXTURE_LZ4_CHUNK_SIZE;
+	return (uint32_t)(size - start < AS_TEXTURE_LZ4_CHUNK_SIZE ? size - start : AS_TEXTURE_LZ4_CHUNK_SIZE);
+}
+
+/*Chunks are independent so each one is a job both ways*/
+struct lz4ChunkJob {
+	const unsigned char* pSrc;
+	unsigned char* pDst;
+	uint32_t srcSize;
+	uint32_t dstSize; /**< Capacity before compressing, result after*/
+	int32_t level;
+	bool failed;
+};
+
+static void _lz4CompressJob(void* pUserData)
+{
+	struct lz4ChunkJob* pJob = (struct lz4ChunkJob*)pUserData;
+	const int written = LZ4_compress_HC((const char*)pJob->pSrc, (char*)pJob->pDst, (int)pJob->srcSize, (int)pJob->dstSize, pJob->level);
+	/*Chunks that do not shrink are stored as is*/
+	if (written <= 0 || (uint32_t)written >= pJob->srcSize)
+	{
+		memcpy(pJob->pDst, pJob->pSrc, pJob->srcSize);
+		pJob->dstSize = pJob->srcSize;
+	}
+	else
+	{
+		pJob->dstSize = (uint32_t)written;
+	}
+}
+
+static void _lz4DecompressJob(void* pUserData)
+{
+	struct lz4ChunkJob* pJob = (struct lz4ChunkJob*)pUserData;
+	if (pJob->srcSize == pJob->dstSize)
+	{
+		memcpy(pJob->pDst, pJob->pSrc, pJob->dstSize);
+		return;
+	}
+	const int read = LZ4_decompress_safe((const char*)pJob->pSrc, (char*)pJob->pDst, (int)pJob->srcSize, (int)pJob->dstSize);
+	pJob->failed = read != (int)pJob->dstSize;
+}
+
+static asResults _lz4RunJobs(struct lz4ChunkJob* pJobData, uint32_t jobCount, asJobEntryFunc fpEntry)
+{
+	if (jobCount == 1)
+	{
+		fpEntry(pJobData);
+		return AS_SUCCESS;
+	}
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * jobCount);
+	if (!pJobs)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < jobCount; i++)
+	{
+		pJobs[i].fpEntry = fpEntry;
+		pJobs[i].pUserData = &pJobData[i];
+	}
+	asJobCounter counter;
+	asResults result = asJobSystem_CreateCounter(&counter);
+	if (result == AS_SUCCESS)
+	{
+		result = asJobSystem_Dispatch(pJobs, jobCount, counter);
+		asJobSystem_WaitForCounter(counter);
+		asJobSystem_ReleaseCounter(counter);
+	}
+	asFree(pJobs);
+	return result;
+}
+
+ASEXPORT asResults asTextureDesc_WriteLz4File(const asTextureDesc_t* pDesc, const char* pPath, int32_t compressionLevel)
+{
+	const asTextureContentRegion_t* pRegions = pDesc->pInitialContentsRegions ? pDesc->pInitialContentsRegions : pDesc->arrInitialContentsRegions;
+	const uint32_t mipCount = (uint32_t)pDesc->initialContentsRegionCount;
+	if (!pDesc->pInitialContentsBuffer || !mipCount || mipCount > AS_TEXTURE_MAX_REGIONS) { return AS_FAILURE_INVALID_PARAM; }
+
+	/*One region per mip in order*/
+	asTextureLz4Header_t header;
+	memset(&header, 0, sizeof(header));
+	header.version = AS_TEXTURE_LZ4_VERSION;
+	header.type = (uint32_t)pDesc->type;
+	header.format = (uint32_t)pDesc->format;
+	header.width = pDesc->width;
+	header.height = pDesc->height;
+	header.depth = pDesc->depth;
+	header.mipCount = mipCount;
+	uint32_t chunkCount = 0;
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		if (pRegions[i].mipLevel != i || !pRegions[i].bufferSize) { return AS_FAILURE_INVALID_PARAM; }
+		if ((size_t)pRegions[i].bufferStart + pRegions[i].bufferSize > pDesc->initialContentsBufferSize) { return AS_FAILURE_OUT_OF_BOUNDS; }
+		header.mips[i].size = pRegions[i].bufferSize;
+		memcpy(header.mips[i].extent, pRegions[i].extent, sizeof(uint32_t) * 3);
+		header.mips[i].layerCount = pRegions[i].layerCount;
+		chunkCount += _lz4ChunkCount(pRegions[i].bufferSize);
+	}
+
+	/*Compress every chunk of every mip at once*/
+	const size_t chunkBound = (size_t)LZ4_compressBound(AS_TEXTURE_LZ4_CHUNK_SIZE);
+	struct lz4ChunkJob* pJobData = asMalloc(sizeof(struct lz4ChunkJob) * chunkCount);
+	unsigned char* pScratch = asMalloc(chunkBound * chunkCount);
+	if (!pJobData || !pScratch)
+	{
+		asFree(pJobData);
+		asFree(pScratch);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	const int32_t level = compressionLevel > 0 ? compressionLevel : LZ4HC_CLEVEL_DEFAULT;
+	uint32_t job = 0;
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		const unsigned char* pMip = (const unsigned char*)pDesc->pInitialContentsBuffer + pRegions[i].bufferStart;
+		for (uint32_t c = 0; c < _lz4ChunkCount(pRegions[i].bufferSize); c++, job++)
+		{
+			pJobData[job] = (struct lz4ChunkJob){
+				.pSrc = pMip + (size_t)c * AS_TEXTURE_LZ4_CHUNK_SIZE,
+				.pDst = pScratch + chunkBound * job,
+				.srcSize = _lz4ChunkSize(pRegions[i].bufferSize, c),
+				.dstSize = (uint32_t)chunkBound,
+				.level = level
+			};
+		}
+	}
+	asResults result = _lz4RunJobs(pJobData, chunkCount, _lz4CompressJob);
+
+	/*Pack the chunks behind their sizes*/
+	size_t dataSize = 0;
+	for (uint32_t c = 0; c < chunkCount; c++)
+		dataSize += LZ4TEX_CHUNK_PADDED(pJobData[c].dstSize);
+	dataSize = (dataSize + 7u) & ~(size_t)7u; /*Keeps the asBin section table that follows aligned*/
+	unsigned char* pData = result == AS_SUCCESS ? asMalloc(dataSize) : NULL;
+	if (result == AS_SUCCESS && !pData)
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	if (result == AS_SUCCESS && dataSize > UINT32_MAX)
+		result = AS_FAILURE_OUT_OF_BOUNDS;
+	if (result == AS_SUCCESS)
+	{
+		size_t offset = 0;
+		job = 0;
+		for (uint32_t i = 0; i < mipCount; i++)
+		{
+			header.mips[i].offset = (uint32_t)offset;
+			for (uint32_t c = 0; c < _lz4ChunkCount(header.mips[i].size); c++, job++)
+			{
+				const uint32_t size = pJobData[job].dstSize;
+				memcpy(pData + offset, &size, sizeof(uint32_t));
+				memcpy(pData + offset + sizeof(uint32_t), pJobData[job].pDst, size);
+				memset(pData + offset + sizeof(uint32_t) + size, 0, LZ4TEX_CHUNK_PADDED(size) - size - sizeof(uint32_t));
+				offset += LZ4TEX_CHUNK_PADDED(size);
+			}
+			header.mips[i].compressedSize = (uint32_t)offset - header.mips[i].offset;
+		}
+		memset(pData + offset, 0, dataSize - offset);
+
+		asBinWriter writer;
+		result = asBinWriterOpen(&writer, AS_TEXTURE_LZ4_TAG, pPath, 2);
+		if (result == AS_SUCCESS)
+		{
+			asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "TEXHEADR", 0 }, (unsigned char*)&header, sizeof(header));
+			asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "MIPDATA", 0 }, pData, dataSize);
+			result = asBinWriterClose(&writer);
+		}
+	}
+	asFree(pData);
+	asFree(pScratch);
+	asFree(pJobData);
+	return result;
+}
+
+/*The user data is the start of the mip data section, regions point at the first chunk of their mip*/
+static asResults _lz4WriteRegion(void* pDst, const asTextureContentRegion_t* pRegion, void* pUserData)
+{
+	const unsigned char* pMip = (const unsigned char*)pUserData + pRegion->bufferStart;
+	const uint32_t chunkCount = _lz4ChunkCount(pRegion->bufferSize);
+	struct lz4ChunkJob smallJob;
+	struct lz4ChunkJob* pJobData = chunkCount > 1 ? asMalloc(sizeof(struct lz4ChunkJob) * chunkCount) : &smallJob;
+	if (!pJobData)
+		return AS_FAILURE_OUT_OF_MEMORY;
+
+	/*Chunks were validated when the description was made*/
+	size_t offset = 0;
+	for (uint32_t c = 0; c < chunkCount; c++)
+	{
+		uint32_t size;
+		memcpy(&size, pMip + offset, sizeof(uint32_t));
+		pJobData[c] = (struct lz4ChunkJob){
+			.pSrc = pMip + offset + sizeof(uint32_t),
+			.pDst = (unsigned char*)pDst + (size_t)c * AS_TEXTURE_LZ4_CHUNK_SIZE,
+			.srcSize = size,
+			.dstSize = _lz4ChunkSize(pRegion->bufferSize, c)
+		};
+		offset += LZ4TEX_CHUNK_PADDED(size);
+	}
+	asResults result = _lz4RunJobs(pJobData, chunkCount, _lz4DecompressJob);
+	for (uint32_t c = 0; c < chunkCount && result == AS_SUCCESS; c++)
+	{
+		if (pJobData[c].failed)
+			result = AS_FAILURE_DECOMPRESSION_ERROR;
+	}
+	if (pJobData != &smallJob)
+		asFree(pJobData);
+	return result;
+}
+
+ASEXPORT asResults asTextureDesc_FromLz4Data(asTextureDesc_t* pOut, const void* pBlob, size_t blobSize)
+{
+	/*Defaults*/
+	*pOut = asTextureDesc_Init();
+
+	asBinReader reader;
+	asTextureLz4Header_t* pHeader = NULL;
+	unsigned char* pData = NULL;
+	size_t headerSize = 0, dataSize = 0;
+	asResults result = asBinReaderOpenMemory(&reader, AS_TEXTURE_LZ4_TAG, (unsigned char*)pBlob, blobSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "TEXHEADR", 0 }, (unsigned char**)&pHeader, &headerSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "MIPDATA", 0 }, &pData, &dataSize);
+	if (result != AS_SUCCESS)
+		return result;
+	const unsigned char* pEnd = (const unsigned char*)pBlob + blobSize;
+	if (headerSize != sizeof(asTextureLz4Header_t) ||
+		(const unsigned char*)pHeader + headerSize > pEnd ||
+		pData + dataSize > pEnd ||
+		pHeader->version != AS_TEXTURE_LZ4_VERSION)
+		return AS_FAILURE_UNKNOWN_FORMAT;
+	if (pHeader->type >= AS_TEXTURETYPE_COUNT || pHeader->format >= AS_COLORFORMAT_COUNT)
+		return AS_FAILURE_UNKNOWN_FORMAT;
+	if (!pHeader->mipCount || pHeader->mipCount > AS_TEXTURE_MAX_REGIONS)
+		return AS_FAILURE_OUT_OF_BOUNDS;
+
+	pOut->type = (asTextureType)pHeader->type;
+	pOut->format = (asColorFormat)pHeader->format;
+	pOut->width = pHeader->width;
+	pOut->height = pHeader->height;
+	pOut->depth = pHeader->depth;
+	pOut->mips = pHeader->mipCount;
+
+	/*Walk the chunks of each mip once so decoding can trust them*/
+	pOut->initialContentsRegionCount = pHeader->mipCount;
+	size_t totalSize = 0;
+	for (uint32_t i = 0; i < pHeader->mipCount; i++)
+	{
+		const asTextureLz4Mip_t* pMip = &pHeader->mips[i];
+		if (!pMip->size || (size_t)pMip->offset + pMip->compressedSize > dataSize)
+			return AS_FAILURE_OUT_OF_BOUNDS;
+		size_t offset = 0;
+		for (uint32_t c = 0; c < _lz4ChunkCount(pMip->size); c++)
+		{
+			uint32_t size;
+			if (offset + sizeof(uint32_t) > pMip->compressedSize)
+				return AS_FAILURE_OUT_OF_BOUNDS;
+			memcpy(&size, pData + pMip->offset + offset, sizeof(uint32_t));
+			if (!size || size > _lz4ChunkSize(pMip->size, c))
+				return AS_FAILURE_UNKNOWN_FORMAT;
+			offset += LZ4TEX_CHUNK_PADDED(size);
+		}
+		if (offset != pMip->compressedSize)
+			return AS_FAILURE_UNKNOWN_FORMAT;
+
+		asTextureContentRegion_t* region = &pOut->arrInitialContentsRegions[i];
+		memcpy(region->extent, pMip->extent, sizeof(uint32_t) * 3);
+		region->layer = 0;
+		region->layerCount = pMip->layerCount;
+		region->mipLevel = i;
+		memset(region->offset, 0, sizeof(uint32_t) * 3);
+		region->bufferStart = pMip->offset;
+		region->bufferSize = pMip->size;
+		totalSize += pMip->size;
+	}
+	pOut->initialContentsBufferSize = totalSize;
+
+	/*Mips are decoded when the upload memory is ready*/
+	pOut->pfnWriteInitialContents = _lz4WriteRegion;
+	pOut->pWriteInitialContentsUserData = pData;
+	return AS_SUCCESS;
+}
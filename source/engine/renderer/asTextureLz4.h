@@ -0,0 +1,66 @@
+#ifndef _ASTEXTURELZ4_H_
+#define _ASTEXTURELZ4_H_
+
+#include "../common/asCommon.h"
+#include "asRendererCore.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief LZ4 supercompressed textures (asBin "ATLZ")
+* Each mip is compressed on its own in fixed size chunks so mips can be read separately
+* and decoded straight into upload memory on the job system
+*/
+
+#define AS_TEXTURE_LZ4_TAG "ATLZ"
+#define AS_TEXTURE_LZ4_VERSION 1
+#define AS_TEXTURE_LZ4_CHUNK_SIZE (256 * 1024) /**< Uncompressed bytes per independently decoded chunk*/
+
+/**
+* @brief Location of a mip within the "MIPDATA" section
+* the mip is a series of chunks, each one is a uint32_t compressed size followed by the data padded to 4 bytes
+* a chunk with a compressed size equal to its uncompressed size is stored as is
+*/
+typedef struct {
+	uint32_t offset; /**< Start of the first chunk in the data section*/
+	uint32_t compressedSize; /**< Bytes of every chunk including the size prefixes and padding*/
+	uint32_t size; /**< Uncompressed size of the mip*/
+	uint32_t extent[3]; /**< UVW Extent of the mip in pixels*/
+	uint32_t layerCount; /**< How many layers the mip has in it*/
+} asTextureLz4Mip_t;
+
+/**
+* @brief Header of a supercompressed texture ("TEXHEADR" section)
+*/
+typedef struct {
+	uint32_t version; /**< AS_TEXTURE_LZ4_VERSION*/
+	uint32_t type; /**< asTextureType*/
+	uint32_t format; /**< asColorFormat*/
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t mipCount;
+	uint32_t reserved;
+	asTextureLz4Mip_t mips[AS_TEXTURE_MAX_REGIONS];
+} asTextureLz4Header_t;
+
+/**
+* @brief Write the initial contents of a texture description as a supercompressed texture (meant for cooking)
+* each region of the initial contents must be a whole mip in order, starting at the top mip
+* @param compressionLevel LZ4HC level (0 for the default), chunks are compressed on the job system
+*/
+ASEXPORT asResults asTextureDesc_WriteLz4File(const asTextureDesc_t* pDesc, const char* pPath, int32_t compressionLevel);
+
+/**
+* @brief Fills out the data for a texture description that decodes the mips straight from the supercompressed data
+* the chunks of each mip are decoded on the job system when the texture writes its upload memory
+* meant for mapped files (asResourceFileView_t), the data must stay valid until the texture is created
+*/
+ASEXPORT asResults asTextureDesc_FromLz4Data(asTextureDesc_t* pOut, const void* pBlob, size_t blobSize);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
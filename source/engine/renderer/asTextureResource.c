@@ -0,0 +1,48 @@
+#include "asTextureResource.h"
+#include "asTextureFromKtx.h"
+#include "asTextureLz4.h"
+
+static const uint8_t textureKtxIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+ASEXPORT asResults asTextureResource_Open(asTextureResource_t* pTexture, asResourceFileID_t id)
+{
+	memset(pTexture, 0, sizeof(asTextureResource_t));
+	pTexture->desc = asTextureDesc_Init();
+	asResults result = asResourceLoader_Open(&pTexture->_loader, id);
+	if (result != AS_SUCCESS)
+		return result;
+
+	/*Ktx starts with its identifier, anything else has to be supercompressed*/
+	uint8_t identifier[sizeof(textureKtxIdentifier)];
+	const bool ktx = asResourceLoader_GetContentSize(&pTexture->_loader) >= sizeof(identifier) &&
+		asResourceLoader_Read(&pTexture->_loader, sizeof(identifier), identifier) == AS_SUCCESS &&
+		!memcmp(identifier, textureKtxIdentifier, sizeof(identifier));
+	if (ktx)
+	{
+		result = asResourceLoader_SetReadPoint(&pTexture->_loader, 0);
+		if (result == AS_SUCCESS)
+			result = asTextureDesc_FromKtxLoader(&pTexture->desc, &pTexture->_loader);
+		if (result != AS_SUCCESS)
+			asResourceLoader_Close(&pTexture->_loader);
+		return result;
+	}
+
+	/*The chunks are decoded from the mapping when the upload memory is ready*/
+	asResourceLoader_Close(&pTexture->_loader);
+	result = asResourceFileView_Open(&pTexture->_view, id);
+	if (result != AS_SUCCESS)
+		return result;
+	pTexture->_mapped = true;
+	result = asTextureDesc_FromLz4Data(&pTexture->desc, pTexture->_view.pData, pTexture->_view.size);
+	if (result != AS_SUCCESS)
+		asResourceFileView_Close(&pTexture->_view);
+	return result;
+}
+
+ASEXPORT void asTextureResource_Close(asTextureResource_t* pTexture)
+{
+	if (pTexture->_mapped)
+		asResourceFileView_Close(&pTexture->_view);
+	else
+		asResourceLoader_Close(&pTexture->_loader);
+}
@@ -0,0 +1,43 @@
+#ifndef _ASTEXTURERESOURCE_H_
+#define _ASTEXTURERESOURCE_H_
+
+#include "../common/asCommon.h"
+#include "../resource/asResource.h"
+#include "asRendererCore.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Runtime loading of cooked textures
+* Supercompressed textures (asBin "ATLZ", from the "texturelz4" cook processor) are mapped and decoded straight into upload memory,
+* ktx textures (from the "texture" cook processor) have their mips read straight into upload memory
+*/
+
+/**
+* @brief A cooked texture resource opened for creation
+* @warning the description refers back into this struct, do not move it until the texture is created
+*/
+typedef struct {
+	asTextureDesc_t desc; /**< Pass to asCreateTexture() or asCreateTextures() before closing*/
+	asResourceLoader_t _loader;
+	asResourceFileView_t _view;
+	bool _mapped;
+} asTextureResource_t;
+
+/**
+* @brief Open a cooked texture resource, the format is told apart by its contents
+* nothing is left open on failure
+*/
+ASEXPORT asResults asTextureResource_Open(asTextureResource_t* pTexture, asResourceFileID_t id);
+
+/**
+* @brief Release the file once the texture has been created
+*/
+ASEXPORT void asTextureResource_Close(asTextureResource_t* pTexture);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
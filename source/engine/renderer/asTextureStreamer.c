@@ -0,0 +1,613 @@
+#include "asTextureStreamer.h"
+#include "asTextureFromKtx.h"
+
+#include "../resource/asResourceAsyncIO.h"
+#include "../common/preferences/asPreferences.h"
+
+#include "stb/stb_ds.h"
+
+int32_t gTextureStreamBudgetMB = 512;
+int32_t gTextureStreamBaseSize = 64;
+int32_t gTextureStreamMaxLoads = 8;
+int32_t gTextureStreamLingerFrames = 120;
+
+#define AS_TEXTURE_STREAM_NO_LOAD UINT32_MAX
+#define AS_TEXTURE_STREAM_MAX_PIXELS 65536.0f
+
+struct textureStreamEntry
+{
+	asResourceFileID_t id;
+	asTextureDesc_t desc; /*Full mip chain, regions point at the mips within the file*/
+	asTextureHandle_t baseTexture; /*Low mips (always resident)*/
+	uint32_t baseMip;
+	size_t baseBytes;
+	asTextureHandle_t streamedTexture; /*Higher mips (invalid when demoted)*/
+	size_t streamedBytes;
+	uint32_t residentMip; /*Largest mip currently referenced by the pool slot*/
+	uint32_t wantedMip;
+	float requestedPixels; /*Largest request since the last update*/
+	float priorityPixels; /*Last non zero request*/
+	uint64_t lastRequestFrame;
+	/*Load in flight*/
+	uint32_t loadingMip;
+	size_t loadingBytes;
+	asResourceLoader_t loader;
+	asResourceReadBatch batch;
+	asResourceReadRequest_t requests[AS_TEXTURE_MAX_REGIONS];
+	unsigned char* pLoadBuffer;
+};
+
+struct textureStreamRelease
+{
+	asTextureHandle_t hndl;
+	uint64_t frame;
+	size_t bytes;
+};
+
+struct
+{
+	struct textureStreamEntry* pEntries[AS_MAX_POOLED_TEXTURES]; /*By pool slot*/
+	asBindlessTextureIndex* pSlots; /*Slots in use*/
+	struct textureStreamRelease* pReleases; /*Textures waiting for the pool to stop referencing them*/
+	asBindlessTextureIndex* pSortScratch;
+	asBindlessTextureIndex* pFinished; /*Slots whose loads completed this update*/
+	asTextureDesc_t* pFinishDescs;
+	asTextureHandle_t* pFinishTextures;
+	uint64_t frame;
+	size_t budget;
+	size_t frameBudget; /*Budget clamped to the video memory the device has left*/
+	uint64_t baseBytes;
+	uint64_t streamedBytes;
+	uint64_t pendingBytes;
+	uint64_t releasingBytes; /*Still allocated until their release*/
+	uint32_t pendingLoads;
+	uint64_t promotions;
+	uint64_t demotions;
+} texStream;
+
+/*Mips*/
+
+static size_t _streamMipBytes(const struct textureStreamEntry* pEntry, uint32_t firstMip)
+{
+	size_t bytes = 0;
+	for (uint32_t i = firstMip; i < pEntry->desc.initialContentsRegionCount; i++)
+		bytes += pEntry->desc.arrInitialContentsRegions[i].bufferSize;
+	return bytes;
+}
+
+static uint32_t _streamMipForPixels(const struct textureStreamEntry* pEntry, float pixels)
+{
+	const uint32_t largest = pEntry->desc.width > pEntry->desc.height ? pEntry->desc.width : pEntry->desc.height;
+	uint32_t mip = 0;
+	while (mip < pEntry->baseMip && (float)(largest >> (mip + 1)) >= pixels)
+		mip++;
+	return mip;
+}
+
+/*Description of the mip chain starting at firstMip (regions still point into the file)*/
+static void _streamSubDesc(const struct textureStreamEntry* pEntry, uint32_t firstMip, asTextureDesc_t* pOut)
+{
+	*pOut = pEntry->desc;
+	pOut->width = pEntry->desc.width >> firstMip ? pEntry->desc.width >> firstMip : 1;
+	pOut->height = pEntry->desc.height >> firstMip ? pEntry->desc.height >> firstMip : 1;
+	if (pEntry->desc.type == AS_TEXTURETYPE_3D)
+		pOut->depth = pEntry->desc.depth >> firstMip ? pEntry->desc.depth >> firstMip : 1;
+	pOut->mips = pEntry->desc.mips - firstMip;
+	pOut->initialContentsRegionCount = pEntry->desc.initialContentsRegionCount - firstMip;
+	for (uint32_t i = 0; i < pOut->initialContentsRegionCount; i++)
+	{
+		pOut->arrInitialContentsRegions[i] = pEntry->desc.arrInitialContentsRegions[i + firstMip];
+		pOut->arrInitialContentsRegions[i].mipLevel = i;
+	}
+	pOut->pInitialContentsRegions = NULL;
+	pOut->pInitialContentsBuffer = NULL;
+	pOut->pfnWriteInitialContents = NULL;
+	pOut->pWriteInitialContentsUserData = NULL;
+	int32_t nameLength;
+	asResource_GetFileName(pEntry->id, &pOut->pDebugLabel, &nameLength);
+}
+
+/*Residency*/
+
+static void _streamReleaseLater(asTextureHandle_t hndl, size_t bytes)
+{
+	struct textureStreamRelease release = { hndl, texStream.frame + AS_TEXTURE_POOL_UPDATE_LATENCY, bytes };
+	arrput(texStream.pReleases, release);
+	texStream.releasingBytes += bytes;
+}
+
+static void _streamDemote(struct textureStreamEntry* pEntry, asBindlessTextureIndex slot)
+{
+	if (!asHandleValid(pEntry->streamedTexture))
+		return;
+	asTexturePoolRemap(slot, pEntry->baseTexture);
+	_streamReleaseLater(pEntry->streamedTexture, pEntry->streamedBytes);
+	pEntry->streamedTexture = asHandle_Invalidate();
+	texStream.streamedBytes -= pEntry->streamedBytes;
+	pEntry->streamedBytes = 0;
+	pEntry->residentMip = pEntry->baseMip;
+	texStream.demotions++;
+}
+
+static void _streamEndLoad(struct textureStreamEntry* pEntry)
+{
+	if (pEntry->loadingMip == AS_TEXTURE_STREAM_NO_LOAD)
+		return;
+	if (pEntry->batch)
+	{
+		asResourceReadBatch_Wait(pEntry->batch);
+		asResourceReadBatch_Release(pEntry->batch);
+		pEntry->batch = NULL;
+	}
+	asResourceLoader_Close(&pEntry->loader);
+	asFree(pEntry->pLoadBuffer);
+	pEntry->pLoadBuffer = NULL;
+	texStream.pendingBytes -= pEntry->loadingBytes - pEntry->streamedBytes;
+	texStream.pendingLoads--;
+	pEntry->loadingBytes = 0;
+	pEntry->loadingMip = AS_TEXTURE_STREAM_NO_LOAD;
+}
+
+static asResults _streamBeginLoad(struct textureStreamEntry* pEntry, uint32_t mip)
+{
+	asResults result = asResourceLoader_Open(&pEntry->loader, pEntry->id);
+	if (result != AS_SUCCESS)
+		return result;
+	pEntry->loadingBytes = _streamMipBytes(pEntry, mip);
+	pEntry->pLoadBuffer = asMalloc(pEntry->loadingBytes);
+	if (!pEntry->pLoadBuffer)
+	{
+		asResourceLoader_Close(&pEntry->loader);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+
+	/*Every mip from the requested one down is read into one buffer*/
+	size_t offset = 0;
+	const uint32_t count = (uint32_t)pEntry->desc.initialContentsRegionCount - mip;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const asTextureContentRegion_t* pRegion = &pEntry->desc.arrInitialContentsRegions[mip + i];
+		pEntry->requests[i] = (asResourceReadRequest_t){
+			.pLoader = &pEntry->loader,
+			.offset = pRegion->bufferStart,
+			.size = pRegion->bufferSize,
+			.pDest = pEntry->pLoadBuffer + offset,
+			.result = AS_SUCCESS,
+			.flags = 0
+		};
+		offset += pRegion->bufferSize;
+	}
+	result = asResourceReadBatch_Submit(pEntry->requests, count, &pEntry->batch);
+	if (result != AS_SUCCESS)
+	{
+		asResourceLoader_Close(&pEntry->loader);
+		asFree(pEntry->pLoadBuffer);
+		pEntry->pLoadBuffer = NULL;
+		pEntry->batch = NULL;
+		return result;
+	}
+	/*Only the growth counts, the current streamed texture is replaced when the load finishes*/
+	pEntry->loadingMip = mip;
+	texStream.pendingBytes += pEntry->loadingBytes - pEntry->streamedBytes;
+	texStream.pendingLoads++;
+	return AS_SUCCESS;
+}
+
+/*Description of the larger texture from the loaded mips (false if the load failed)*/
+static bool _streamFinishDesc(struct textureStreamEntry* pEntry, asTextureDesc_t* pDesc)
+{
+	const uint32_t mip = pEntry->loadingMip;
+	const uint32_t count = (uint32_t)pEntry->desc.initialContentsRegionCount - mip;
+	bool failed = false;
+	for (uint32_t i = 0; i < count; i++)
+		failed |= pEntry->requests[i].result != AS_SUCCESS;
+	if (failed)
+	{
+		asDebugWarning("Failed to stream texture mips: %llx", pEntry->id);
+		_streamEndLoad(pEntry);
+		return false;
+	}
+
+	_streamSubDesc(pEntry, mip, pDesc);
+	size_t offset = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		pDesc->arrInitialContentsRegions[i].bufferStart = offset;
+		offset += pDesc->arrInitialContentsRegions[i].bufferSize;
+	}
+	pDesc->pInitialContentsBuffer = pEntry->pLoadBuffer;
+	pDesc->initialContentsBufferSize = offset;
+	return true;
+}
+
+/*Swap the slot over to the larger texture*/
+static void _streamSwapIn(struct textureStreamEntry* pEntry, asBindlessTextureIndex slot, asTextureHandle_t texture)
+{
+	const uint32_t mip = pEntry->loadingMip;
+	const size_t bytes = pEntry->loadingBytes;
+	_streamEndLoad(pEntry);
+	if (!asHandleValid(texture))
+	{
+		/*Creation failed, keep what is resident (the mip is asked for again on a later update)*/
+		asDebugWarning("Failed to create streamed texture: %llx", pEntry->id);
+		return;
+	}
+
+	if (asHandleValid(pEntry->streamedTexture))
+		_streamReleaseLater(pEntry->streamedTexture, pEntry->streamedBytes);
+	texStream.streamedBytes += bytes;
+	texStream.streamedBytes -= pEntry->streamedBytes;
+	pEntry->streamedTexture = texture;
+	pEntry->streamedBytes = bytes;
+	pEntry->residentMip = mip;
+	asTexturePoolRemap(slot, texture);
+	texStream.promotions++;
+}
+
+/*Every load that completed is created in one batch (a single upload submission)*/
+static void _streamFinishLoads()
+{
+	const size_t count = arrlenu(texStream.pFinished);
+	arrsetlen(texStream.pFinishDescs, count);
+	size_t loaded = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (_streamFinishDesc(texStream.pEntries[texStream.pFinished[i]], &texStream.pFinishDescs[loaded]))
+			texStream.pFinished[loaded++] = texStream.pFinished[i];
+	}
+	arrsetlen(texStream.pFinishTextures, loaded);
+	if (loaded)
+		asCreateTextures(texStream.pFinishDescs, loaded, texStream.pFinishTextures);
+	for (size_t i = 0; i < loaded; i++)
+		_streamSwapIn(texStream.pEntries[texStream.pFinished[i]], texStream.pFinished[i], texStream.pFinishTextures[i]);
+	arrsetlen(texStream.pFinished, 0);
+}
+
+/*Least important first: not requested for the longest, then smallest on screen*/
+static int _streamImportance(const struct textureStreamEntry* a, const struct textureStreamEntry* b)
+{
+	if (a->lastRequestFrame != b->lastRequestFrame)
+		return a->lastRequestFrame < b->lastRequestFrame ? -1 : 1;
+	if (a->priorityPixels != b->priorityPixels)
+		return a->priorityPixels < b->priorityPixels ? -1 : 1;
+	return 0;
+}
+
+static int _streamCompareImportance(const void* pA, const void* pB)
+{
+	return _streamImportance(texStream.pEntries[*(const asBindlessTextureIndex*)pA], texStream.pEntries[*(const asBindlessTextureIndex*)pB]);
+}
+
+/*Most needed first: furthest from the wanted mip, then largest on screen*/
+static int _streamCompareUrgency(const void* pA, const void* pB)
+{
+	const struct textureStreamEntry* a = texStream.pEntries[*(const asBindlessTextureIndex*)pA];
+	const struct textureStreamEntry* b = texStream.pEntries[*(const asBindlessTextureIndex*)pB];
+	const uint32_t aMissing = a->residentMip - a->wantedMip;
+	const uint32_t bMissing = b->residentMip - b->wantedMip;
+	if (aMissing != bMissing)
+		return aMissing > bMissing ? -1 : 1;
+	if (a->priorityPixels != b->priorityPixels)
+		return a->priorityPixels > b->priorityPixels ? -1 : 1;
+	return 0;
+}
+
+static bool _streamFits(size_t addBytes)
+{
+	return texStream.streamedBytes + texStream.pendingBytes + addBytes <= texStream.frameBudget;
+}
+
+static bool _streamCanDemote(const struct textureStreamEntry* pVictim, const struct textureStreamEntry* pFor)
+{
+	return pVictim != pFor && asHandleValid(pVictim->streamedTexture) && pVictim->loadingMip == AS_TEXTURE_STREAM_NO_LOAD;
+}
+
+/*Demote less important textures until the bytes fit (nothing is demoted if they can't)*/
+static bool _streamMakeRoom(const struct textureStreamEntry* pFor, size_t addBytes)
+{
+	const size_t victimCount = arrlenu(texStream.pSortScratch);
+	if (pFor)
+	{
+		size_t reclaimable = 0;
+		for (size_t i = 0; i < victimCount; i++)
+		{
+			const struct textureStreamEntry* pVictim = texStream.pEntries[texStream.pSortScratch[i]];
+			if (_streamImportance(pVictim, pFor) >= 0)
+				break; /*Everything after is at least as important*/
+			if (_streamCanDemote(pVictim, pFor))
+				reclaimable += pVictim->streamedBytes;
+		}
+		if (texStream.streamedBytes + texStream.pendingBytes + addBytes > texStream.frameBudget + reclaimable)
+			return false;
+	}
+	for (size_t i = 0; i < victimCount && !_streamFits(addBytes); i++)
+	{
+		const asBindlessTextureIndex slot = texStream.pSortScratch[i];
+		if (_streamCanDemote(texStream.pEntries[slot], pFor))
+			_streamDemote(texStream.pEntries[slot], slot);
+	}
+	return _streamFits(addBytes);
+}
+
+/*Interface*/
+
+ASEXPORT asResults asInitTextureStreamer()
+{
+	memset(&texStream, 0, sizeof(texStream));
+	if (asGetGlobalPrefs())
+	{
+		asPreferencesRegisterOpenSection(asGetGlobalPrefs(), "textureStream");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "budgetMB", &gTextureStreamBudgetMB, 0, 65536, true, NULL, NULL,
+			"Memory budget for streamed texture mips in MB (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "baseSize", &gTextureStreamBaseSize, 1, 16384, true, NULL, NULL,
+			"Largest mip kept resident for every streamed texture (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "maxLoads", &gTextureStreamMaxLoads, 1, 256, true, NULL, NULL,
+			"Textures loaded at once");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "lingerFrames", &gTextureStreamLingerFrames, 0, 100000, true, NULL, NULL,
+			"Frames a request keeps mips resident after the last one");
+		asPreferencesLoadSection(asGetGlobalPrefs(), "textureStream");
+	}
+	texStream.budget = (size_t)gTextureStreamBudgetMB * 1024 * 1024;
+	texStream.frameBudget = texStream.budget;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asShutdownTextureStreamer()
+{
+	while (arrlenu(texStream.pSlots))
+		asTextureStreamer_Remove(texStream.pSlots[0]);
+	for (size_t i = 0; i < arrlenu(texStream.pReleases); i++)
+		asReleaseTexture(texStream.pReleases[i].hndl);
+	arrfree(texStream.pReleases);
+	arrfree(texStream.pSlots);
+	arrfree(texStream.pSortScratch);
+	arrfree(texStream.pFinished);
+	arrfree(texStream.pFinishDescs);
+	arrfree(texStream.pFinishTextures);
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asTextureStreamer_Add(asResourceFileID_t id, asBindlessTextureIndex* pTextureIndex)
+{
+	asResourceLoader_t loader;
+	asResults result = asResourceLoader_Open(&loader, id);
+	if (result != AS_SUCCESS)
+		return result;
+	struct textureStreamEntry* pEntry = asMalloc(sizeof(struct textureStreamEntry));
+	memset(pEntry, 0, sizeof(struct textureStreamEntry));
+	pEntry->id = id;
+	pEntry->loadingMip = AS_TEXTURE_STREAM_NO_LOAD;
+	pEntry->streamedTexture = asHandle_Invalidate();
+	result = asTextureDesc_FromKtxLoader(&pEntry->desc, &loader);
+	if (result != AS_SUCCESS)
+	{
+		asResourceLoader_Close(&loader);
+		asFree(pEntry);
+		return result;
+	}
+	pEntry->desc.cpuAccess = AS_GPURESOURCEACCESS_DEVICE;
+
+	/*Only the mips up to the base size are loaded now*/
+	uint32_t baseMip = 0;
+	while (baseMip + 1 < pEntry->desc.mips &&
+		((pEntry->desc.width >> baseMip) > (uint32_t)gTextureStreamBaseSize || (pEntry->desc.height >> baseMip) > (uint32_t)gTextureStreamBaseSize))
+		baseMip++;
+	pEntry->baseMip = baseMip;
+	pEntry->residentMip = baseMip;
+	pEntry->wantedMip = baseMip;
+	pEntry->baseBytes = _streamMipBytes(pEntry, baseMip);
+
+	asTextureDesc_t baseDesc;
+	_streamSubDesc(pEntry, baseMip, &baseDesc);
+	baseDesc.pfnWriteInitialContents = pEntry->desc.pfnWriteInitialContents;
+	baseDesc.pWriteInitialContentsUserData = &loader;
+	result = asCreateTextures(&baseDesc, 1, &pEntry->baseTexture);
+	asResourceLoader_Close(&loader);
+	pEntry->desc.pfnWriteInitialContents = NULL;
+	pEntry->desc.pWriteInitialContentsUserData = NULL;
+	if (result != AS_SUCCESS)
+	{
+		asFree(pEntry);
+		return result;
+	}
+
+	asBindlessTextureIndex slot;
+	result = asTexturePoolAddFromHandle(pEntry->baseTexture, &slot);
+	if (result != AS_SUCCESS)
+	{
+		asReleaseTexture(pEntry->baseTexture);
+		asFree(pEntry);
+		return result;
+	}
+	texStream.pEntries[slot] = pEntry;
+	arrput(texStream.pSlots, slot);
+	texStream.baseBytes += pEntry->baseBytes;
+	if (pTextureIndex) { *pTextureIndex = slot; }
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asTextureStreamer_Remove(asBindlessTextureIndex textureIndex)
+{
+	if (textureIndex < 0 || textureIndex >= AS_MAX_POOLED_TEXTURES || !texStream.pEntries[textureIndex])
+		return AS_FAILURE_DATA_DOES_NOT_EXIST;
+	struct textureStreamEntry* pEntry = texStream.pEntries[textureIndex];
+	_streamEndLoad(pEntry);
+	asTexturePoolRelease(textureIndex);
+	if (asHandleValid(pEntry->streamedTexture))
+		_streamReleaseLater(pEntry->streamedTexture, pEntry->streamedBytes);
+	_streamReleaseLater(pEntry->baseTexture, pEntry->baseBytes);
+	texStream.streamedBytes -= pEntry->streamedBytes;
+	texStream.baseBytes -= pEntry->baseBytes;
+	texStream.pEntries[textureIndex] = NULL;
+	for (size_t i = 0; i < arrlenu(texStream.pSlots); i++)
+	{
+		if (texStream.pSlots[i] == textureIndex)
+		{
+			arrdelswap(texStream.pSlots, i);
+			break;
+		}
+	}
+	asFree(pEntry);
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asTextureStreamer_RequestResolution(asBindlessTextureIndex textureIndex, float pixels)
+{
+	if (textureIndex < 0 || textureIndex >= AS_MAX_POOLED_TEXTURES || !texStream.pEntries[textureIndex])
+		return;
+	struct textureStreamEntry* pEntry = texStream.pEntries[textureIndex];
+	if (pixels > pEntry->requestedPixels)
+		pEntry->requestedPixels = pixels;
+}
+
+ASEXPORT void asTextureStreamer_RequestFromBounds(asBindlessTextureIndex textureIndex, int32_t screenIdx, const float viewPosition[3], float fov, bool ortho,
+	const float boundMin[3], const float boundMax[3], float texelDensity)
+{
+	int32_t width, height;
+	if (asGetRenderDimensions(screenIdx, true, &width, &height) != AS_SUCCESS)
+		return;
+	float center[3];
+	float radius = 0.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		center[i] = (boundMin[i] + boundMax[i]) * 0.5f;
+		radius += (boundMax[i] - boundMin[i]) * (boundMax[i] - boundMin[i]);
+	}
+	radius = sqrtf(radius) * 0.5f;
+
+	/*Projected diameter of the bounding sphere in pixels*/
+	float pixels;
+	if (ortho)
+	{
+		pixels = fov > 0.0f ? (radius / fov) * (float)height : AS_TEXTURE_STREAM_MAX_PIXELS;
+	}
+	else
+	{
+		float distance = 0.0f;
+		for (int i = 0; i < 3; i++)
+			distance += (center[i] - viewPosition[i]) * (center[i] - viewPosition[i]);
+		distance = sqrtf(distance) - radius;
+		const float halfFov = tanf(glm_rad(fov * 0.5f));
+		pixels = distance > 0.0001f && halfFov > 0.0f ?
+			(radius / (distance * halfFov)) * (float)height : AS_TEXTURE_STREAM_MAX_PIXELS;
+	}
+	pixels *= texelDensity;
+	asTextureStreamer_RequestResolution(textureIndex, pixels < AS_TEXTURE_STREAM_MAX_PIXELS ? pixels : AS_TEXTURE_STREAM_MAX_PIXELS);
+}
+
+ASEXPORT void asTextureStreamer_SetBudget(size_t budgetBytes)
+{
+	texStream.budget = budgetBytes;
+	texStream.frameBudget = budgetBytes;
+}
+
+ASEXPORT void asTextureStreamer_GetStats(asTextureStreamerStats_t* pStats)
+{
+	memset(pStats, 0, sizeof(asTextureStreamerStats_t));
+	pStats->textureCount = (uint32_t)arrlenu(texStream.pSlots);
+	for (size_t i = 0; i < arrlenu(texStream.pSlots); i++)
+	{
+		if (asHandleValid(texStream.pEntries[texStream.pSlots[i]]->streamedTexture))
+			pStats->streamedCount++;
+	}
+	pStats->pendingLoads = texStream.pendingLoads;
+	pStats->baseBytes = texStream.baseBytes;
+	pStats->streamedBytes = texStream.streamedBytes;
+	pStats->budgetBytes = texStream.budget;
+	pStats->frameBudgetBytes = texStream.frameBudget;
+	pStats->promotions = texStream.promotions;
+	pStats->demotions = texStream.demotions;
+}
+
+ASEXPORT asResults asTextureStreamerUpdate()
+{
+	texStream.frame++;
+
+	/*Release textures the pool no longer references*/
+	for (size_t i = 0; i < arrlenu(texStream.pReleases); i++)
+	{
+		if (texStream.frame >= texStream.pReleases[i].frame)
+		{
+			asReleaseTexture(texStream.pReleases[i].hndl);
+			texStream.releasingBytes -= texStream.pReleases[i].bytes;
+			arrdelswap(texStream.pReleases, i);
+			i--;
+		}
+	}
+
+	/*Swap in finished loads and work out what each texture needs*/
+	const size_t slotCount = arrlenu(texStream.pSlots);
+	arrsetlen(texStream.pSortScratch, 0);
+	for (size_t i = 0; i < slotCount; i++)
+	{
+		const asBindlessTextureIndex slot = texStream.pSlots[i];
+		struct textureStreamEntry* pEntry = texStream.pEntries[slot];
+		if (pEntry->batch && asResourceReadBatch_IsComplete(pEntry->batch))
+			arrput(texStream.pFinished, slot);
+
+		if (pEntry->requestedPixels > 0.0f)
+		{
+			pEntry->wantedMip = _streamMipForPixels(pEntry, pEntry->requestedPixels);
+			pEntry->priorityPixels = pEntry->requestedPixels;
+			pEntry->lastRequestFrame = texStream.frame;
+			pEntry->requestedPixels = 0.0f;
+		}
+		else if (texStream.frame - pEntry->lastRequestFrame > (uint64_t)gTextureStreamLingerFrames)
+		{
+			pEntry->wantedMip = pEntry->baseMip;
+		}
+
+		/*No longer needed at all*/
+		if (pEntry->wantedMip == pEntry->baseMip && pEntry->loadingMip == AS_TEXTURE_STREAM_NO_LOAD)
+			_streamDemote(pEntry, slot);
+		arrput(texStream.pSortScratch, slot);
+	}
+	_streamFinishLoads();
+
+	/*Never stream into more video memory than the device has left
+	(what is streamed or waiting for release counts as available since it would be given back)*/
+	const int64_t headroom = asGetGpuMemoryHeadroom();
+	if (headroom >= (int64_t)texStream.budget)
+	{
+		texStream.frameBudget = texStream.budget;
+	}
+	else
+	{
+		const int64_t available = (int64_t)(texStream.streamedBytes + texStream.pendingBytes + texStream.releasingBytes) + headroom;
+		texStream.frameBudget = available <= 0 ? 0 : ((size_t)available < texStream.budget ? (size_t)available : texStream.budget);
+	}
+
+	/*Stay under budget (it may have shrunk)*/
+	if (!slotCount)
+		return AS_SUCCESS;
+	qsort(texStream.pSortScratch, slotCount, sizeof(asBindlessTextureIndex), _streamCompareImportance);
+	_streamMakeRoom(NULL, 0);
+
+	/*Promote the most needed textures, demoting less important ones to make room*/
+	asBindlessTextureIndex* pCandidates = NULL;
+	for (size_t i = 0; i < slotCount; i++)
+	{
+		const struct textureStreamEntry* pEntry = texStream.pEntries[texStream.pSlots[i]];
+		if (pEntry->loadingMip == AS_TEXTURE_STREAM_NO_LOAD && pEntry->wantedMip < pEntry->residentMip)
+			arrput(pCandidates, texStream.pSlots[i]);
+	}
+	const size_t candidateCount = arrlenu(pCandidates);
+	if (candidateCount)
+		qsort(pCandidates, candidateCount, sizeof(asBindlessTextureIndex), _streamCompareUrgency);
+	for (size_t i = 0; i < candidateCount && texStream.pendingLoads < (uint32_t)gTextureStreamMaxLoads; i++)
+	{
+		struct textureStreamEntry* pEntry = texStream.pEntries[pCandidates[i]];
+		/*Fall back to smaller mips if the wanted one can't fit*/
+		for (uint32_t mip = pEntry->wantedMip; mip < pEntry->residentMip; mip++)
+		{
+			const size_t bytes = _streamMipBytes(pEntry, mip);
+			if (!_streamFits(bytes - pEntry->streamedBytes) && !_streamMakeRoom(pEntry, bytes - pEntry->streamedBytes))
+				continue;
+			if (_streamBeginLoad(pEntry, mip) != AS_SUCCESS)
+				asDebugWarning("Failed to begin streaming texture mips: %llx", pEntry->id);
+			break;
+		}
+	}
+	arrfree(pCandidates);
+	return AS_SUCCESS;
+}
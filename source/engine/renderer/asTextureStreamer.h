@@ -0,0 +1,93 @@
+#ifndef _ASTEXTURESTREAMER_H_
+#define _ASTEXTURESTREAMER_H_
+
+#include "../common/asCommon.h"
+#include "asRendererCore.h"
+#include "asBindlessTexturePool.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Mip streaming for ktx textures in the bindless pool
+* Only the low mips of a streamed texture are loaded up front, the higher mips are read asynchronously
+* once something requests the resolution and the pool slot is swapped to the larger texture when it is ready.
+* Streamed mips are demoted again when no longer requested or to stay under the streaming budget (lowered while video memory is short).
+* All functions are meant for the render thread
+*/
+
+/**
+* @brief Streaming statistics
+*/
+typedef struct {
+	uint32_t textureCount; /**< Textures managed by the streamer*/
+	uint32_t streamedCount; /**< Textures currently holding higher mips*/
+	uint32_t pendingLoads; /**< Reads in flight*/
+	uint64_t baseBytes; /**< Bytes of the always resident low mips*/
+	uint64_t streamedBytes; /**< Bytes of the streamed textures*/
+	uint64_t budgetBytes; /**< Budget for streamed textures*/
+	uint64_t frameBudgetBytes; /**< Budget this frame (lower when video memory is short)*/
+	uint64_t promotions; /**< Streamed textures swapped in so far*/
+	uint64_t demotions; /**< Streamed textures dropped so far*/
+} asTextureStreamerStats_t;
+
+/**
+* @brief Initializes the texture streamer using the "textureStream" preferences
+* @warning The renderer init should handle this for you
+*/
+ASEXPORT asResults asInitTextureStreamer();
+
+/**
+* @brief Shutdown the texture streamer (releases every streamed texture)
+* @warning The renderer shutdown should handle this for you
+*/
+ASEXPORT asResults asShutdownTextureStreamer();
+
+/**
+* @brief Advance loads, swap finished textures into the pool and demote what is over budget
+* @warning The renderer should call this every frame before updating the texture pool
+*/
+ASEXPORT asResults asTextureStreamerUpdate();
+
+/**
+* @brief Load the low mips of a ktx texture into the pool and stream the rest on request
+* @param pTextureIndex filled with the pool slot (stays the same as mips are streamed in and out)
+* Fails (adding nothing) if the file can't be read or the base texture can't be created
+*/
+ASEXPORT asResults asTextureStreamer_Add(asResourceFileID_t id, asBindlessTextureIndex* pTextureIndex);
+
+/**
+* @brief Stop streaming a texture and release it from the pool
+*/
+ASEXPORT asResults asTextureStreamer_Remove(asBindlessTextureIndex textureIndex);
+
+/**
+* @brief Request a resolution (in pixels across the largest side) for this frame
+* the largest request each frame wins, requests linger for a while to avoid thrashing
+*/
+ASEXPORT void asTextureStreamer_RequestResolution(asBindlessTextureIndex textureIndex, float pixels);
+
+/**
+* @brief Request a resolution from the estimated screen size of an instance's bounds
+* view values match asGfxViewerParamsDesc (fov is the half height when ortho)
+* @param texelDensity how many times the texture covers the object (1 for a plain unwrap)
+*/
+ASEXPORT void asTextureStreamer_RequestFromBounds(asBindlessTextureIndex textureIndex, int32_t screenIdx, const float viewPosition[3], float fov, bool ortho,
+	const float boundMin[3], const float boundMax[3], float texelDensity);
+
+/**
+* @brief Set the budget for streamed mips (the low mips are not counted)
+* initialized from the "textureStream" preferences
+*/
+ASEXPORT void asTextureStreamer_SetBudget(size_t budgetBytes);
+
+/**
+* @brief Get streaming statistics
+*/
+ASEXPORT void asTextureStreamer_GetStats(asTextureStreamerStats_t* pStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
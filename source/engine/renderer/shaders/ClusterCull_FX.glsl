@@ -0,0 +1,73 @@
+#version 450
+#pragma asShaderType ClusterCull
+/*Compiled to shaders/core/ClusterCull_FX.asfx (see asClusterCulling.h)*/
+
+#ifdef CLUSTER_HIZ /*Reduce a level of the depth pyramid (the farthest depth of the texels it covers)*/
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D srcLevel;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D dstLevel;
+
+layout(push_constant) uniform HizPushConstants {
+	ivec2 srcSize;
+	ivec2 dstSize;
+} pushConstants;
+
+void main()
+{
+	const ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, pushConstants.dstSize))) { return; }
+
+	/*The first level is a power of two below the depth buffer so a texel can cover up to 3x3 of it*/
+	const vec2 ratio = vec2(pushConstants.srcSize) / vec2(pushConstants.dstSize);
+	const ivec2 srcMin = ivec2(floor(vec2(texel) * ratio));
+	const ivec2 srcMax = min(ivec2(ceil(vec2(texel + 1) * ratio)), pushConstants.srcSize) - 1;
+	float depth = 1.0;
+	for (int y = srcMin.y; y <= srcMax.y; y++)
+	{
+		for (int x = srcMin.x; x <= srcMax.x; x++)
+		{
+			depth = min(depth, texelFetch(srcLevel, ivec2(x, y), 0).r);
+		}
+	}
+	imageStore(dstLevel, texel, vec4(depth));
+}
+#endif
+
+#ifdef CLUSTER_CULL /*Cull meshlet instances of jobs sharing geometry and write their indirect draws*/
+#define AS_CLUSTER_FRAME_SET 0
+#define AS_CLUSTER_GEOMETRY_SET 1
+#include "ClusterCulling.glsl"
+
+layout(local_size_x = AS_CLUSTER_CULL_GROUP_SIZE) in;
+
+layout(push_constant) uniform CullPushConstants {
+	uint firstJob;
+} pushConstants;
+
+void main()
+{
+	const uint jobIdx = pushConstants.firstJob + gl_WorkGroupID.y;
+	const asClusterJob job = clusterJobs[jobIdx];
+	const uint drawCount = job.meshletCount * job.instanceCount;
+	const bool compact = (clusterView.flags & CLUSTER_CULL_FLAG_COMPACT) != 0;
+
+	/*Dispatches are clamped to maxComputeWorkGroupCount[0], groups stride over the rest*/
+	for (uint drawIdx = gl_GlobalInvocationID.x; drawIdx < drawCount; drawIdx += gl_NumWorkGroups.x * AS_CLUSTER_CULL_GROUP_SIZE)
+	{
+		const uint meshletIdx = job.firstMeshlet + (drawIdx % job.meshletCount);
+		const uint instance = drawIdx / job.meshletCount;
+		const bool visible = asClusterVisible(job, meshletIdx, instance);
+		if (compact && !visible) { continue; }
+
+		/*Appended and counted or kept in place with no instances*/
+		const uint slot = job.firstDraw + (compact ? atomicAdd(clusterCounts[jobIdx], 1) : drawIdx);
+		const asMeshlet meshlet = clusterMeshlets[meshletIdx];
+		clusterDraws[slot].indexCount = asMeshletTriangleCount(meshlet) * 3;
+		clusterDraws[slot].instanceCount = visible ? 1 : 0;
+		clusterDraws[slot].firstIndex = meshlet.firstIndex;
+		clusterDraws[slot].vertexOffset = int(meshlet.baseVertex);
+		clusterDraws[slot].firstInstance = instance;
+	}
+}
+#endif
@@ -0,0 +1,208 @@
+/*Cluster culling shared by ClusterCull_FX.glsl and the task shaders of Scene FX (see asClusterCulling.h)
+Layouts match the structures in asClusterCulling.c and asModelRuntime.h*/
+#ifndef AS_CLUSTER_CULLING_GLSL
+#define AS_CLUSTER_CULLING_GLSL
+
+/*Scene pipelines bind the cluster sets after the texture pool and viewer*/
+#ifndef AS_CLUSTER_FRAME_SET
+#define AS_CLUSTER_FRAME_SET 2
+#endif
+#ifndef AS_CLUSTER_GEOMETRY_SET
+#define AS_CLUSTER_GEOMETRY_SET 3
+#endif
+
+#define AS_CLUSTER_CULL_GROUP_SIZE 64
+#define AS_CLUSTER_TASK_GROUP_SIZE 32
+#define AS_CLUSTER_VERTEX_WORDS 11 /*sizeof(asVertexGeneric) / 4*/
+
+#define CLUSTER_CULL_FLAG_COMPACT 1
+#define CLUSTER_CULL_FLAG_OCCLUSION 2
+#define CLUSTER_CULL_FLAG_PERSPECTIVE 4
+
+#define AS_CLUSTER_JOB_NO_CONE 1
+#define AS_CLUSTER_JOB_NO_OCCLUSION 2
+#define AS_CLUSTER_JOB_OCTAHEDRAL_NORMALS 4
+
+struct asMeshlet {
+	vec3 center;
+	float radius;
+	vec3 coneApex;
+	float coneCutoff;
+	vec3 coneAxis;
+	uint firstIndex;
+	uint baseVertex;
+	uint firstVertex;
+	uint firstTriangle; /*Bytes*/
+	uint counts; /*Vertices in the low 16 bits, triangles in the high*/
+};
+
+struct asClusterJob {
+	uint firstMeshlet;
+	uint meshletCount;
+	uint instanceCount;
+	uint firstDraw;
+	uint transformOffset;
+	uint transformOffsetPreviousFrame;
+	uint flags;
+	uint _pad;
+};
+
+struct asInstanceTransform {
+	vec4 positionTime;
+	vec4 rotation;
+	vec4 scaleOpacity;
+	vec4 boundMinSphere;
+	vec4 boundMaxRandom;
+	vec4 customProps;
+};
+
+struct asDrawIndexedCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout(std140, set = AS_CLUSTER_FRAME_SET, binding = 0) uniform ClusterView {
+	mat4 viewProj;
+	mat4 view;
+	mat4 prevView;
+	vec4 frustumPlanes[5];
+	vec4 viewPosition;
+	float P00;
+	float P11;
+	float znear;
+	uint flags;
+	float pyramidWidth;
+	float pyramidHeight;
+	uint pyramidMips;
+} clusterView;
+layout(std430, set = AS_CLUSTER_FRAME_SET, binding = 1) readonly buffer ClusterJobs { asClusterJob clusterJobs[]; };
+layout(std430, set = AS_CLUSTER_FRAME_SET, binding = 2) readonly buffer ClusterTransforms { asInstanceTransform clusterTransforms[]; };
+layout(std430, set = AS_CLUSTER_FRAME_SET, binding = 3) buffer ClusterDraws { asDrawIndexedCommand clusterDraws[]; };
+layout(std430, set = AS_CLUSTER_FRAME_SET, binding = 4) buffer ClusterCounts { uint clusterCounts[]; };
+layout(set = AS_CLUSTER_FRAME_SET, binding = 5) uniform sampler2D clusterDepthPyramid;
+
+layout(std430, set = AS_CLUSTER_GEOMETRY_SET, binding = 0) readonly buffer ClusterMeshlets { asMeshlet clusterMeshlets[]; };
+layout(std430, set = AS_CLUSTER_GEOMETRY_SET, binding = 1) readonly buffer ClusterMeshletVertices { uint clusterMeshletVertices[]; };
+layout(std430, set = AS_CLUSTER_GEOMETRY_SET, binding = 2) readonly buffer ClusterMeshletTriangles { uint clusterMeshletTriangles[]; };
+layout(std430, set = AS_CLUSTER_GEOMETRY_SET, binding = 3) readonly buffer ClusterVertices { uint clusterVertices[]; };
+
+uint asMeshletVertexCount(asMeshlet meshlet) { return meshlet.counts & 0xFFFF; }
+uint asMeshletTriangleCount(asMeshlet meshlet) { return meshlet.counts >> 16; }
+
+/*Vertex index (into clusterVertices) of a corner of a meshlet*/
+uint asMeshletVertex(asMeshlet meshlet, uint localVertex)
+{
+	return meshlet.baseVertex + clusterMeshletVertices[meshlet.firstVertex + localVertex];
+}
+
+/*Local vertices of a triangle of a meshlet*/
+uvec3 asMeshletTriangle(asMeshlet meshlet, uint triangle)
+{
+	uvec3 result;
+	for (uint i = 0; i < 3; i++)
+	{
+		const uint byteOffset = meshlet.firstTriangle + (triangle * 3) + i;
+		result[i] = (clusterMeshletTriangles[byteOffset >> 2] >> ((byteOffset & 3) * 8)) & 0xFF;
+	}
+	return result;
+}
+
+vec3 asClusterVertexPosition(uint vertex)
+{
+	const uint word = vertex * AS_CLUSTER_VERTEX_WORDS;
+	return uintBitsToFloat(uvec3(clusterVertices[word], clusterVertices[word + 1], clusterVertices[word + 2]));
+}
+
+vec3 asClusterRotate(vec4 q, vec3 v)
+{
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + (q.w * v));
+}
+
+vec3 asClusterTransformPoint(asInstanceTransform xform, vec3 p)
+{
+	return asClusterRotate(xform.rotation, p * xform.scaleOpacity.xyz) + xform.positionTime.xyz;
+}
+
+/*2D bounds of a view space sphere (Z towards the camera) in UV space of the depth pyramid
+(Mara and McGuire 2013, "2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere")*/
+bool asClusterProjectSphere(vec3 viewCenter, float radius, out vec4 aabb)
+{
+	const vec3 c = vec3(viewCenter.xy, -viewCenter.z);
+	if (c.z < radius + clusterView.znear) { return false; }
+
+	const vec2 cx = -c.xz;
+	const vec2 vx = vec2(sqrt(dot(cx, cx) - (radius * radius)), radius);
+	const vec2 minx = mat2(vx.x, vx.y, -vx.y, vx.x) * cx;
+	const vec2 maxx = mat2(vx.x, -vx.y, vx.y, vx.x) * cx;
+
+	const vec2 cy = -c.yz;
+	const vec2 vy = vec2(sqrt(dot(cy, cy) - (radius * radius)), radius);
+	const vec2 miny = mat2(vy.x, vy.y, -vy.y, vy.x) * cy;
+	const vec2 maxy = mat2(vy.x, -vy.y, vy.y, vy.x) * cy;
+
+	aabb = vec4(minx.x / minx.y * clusterView.P00, miny.x / miny.y * clusterView.P11,
+		maxx.x / maxx.y * clusterView.P00, maxy.x / maxy.y * clusterView.P11);
+	aabb = (aabb.xwzy * vec4(0.5, -0.5, 0.5, -0.5)) + vec4(0.5);
+	return true;
+}
+
+/*Whether any part of a sphere can be in front of the depth drawn last frame (reversed depth, the pyramid keeps the farthest)*/
+bool asClusterDepthVisible(vec3 prevViewCenter, float radius)
+{
+	vec4 aabb;
+	if (!asClusterProjectSphere(prevViewCenter, radius, aabb)) { return true; }
+	const vec2 pyramidSize = vec2(clusterView.pyramidWidth, clusterView.pyramidHeight);
+	const vec2 extent = (aabb.zw - aabb.xy) * pyramidSize;
+	const int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, int(clusterView.pyramidMips) - 1);
+	const ivec2 levelSize = textureSize(clusterDepthPyramid, level);
+	const ivec2 minTexel = clamp(ivec2(aabb.xy * vec2(levelSize)), ivec2(0), levelSize - 1);
+	const ivec2 maxTexel = clamp(ivec2(aabb.zw * vec2(levelSize)), ivec2(0), levelSize - 1);
+	const float depth = min(
+		min(texelFetch(clusterDepthPyramid, minTexel, level).r, texelFetch(clusterDepthPyramid, ivec2(maxTexel.x, minTexel.y), level).r),
+		min(texelFetch(clusterDepthPyramid, ivec2(minTexel.x, maxTexel.y), level).r, texelFetch(clusterDepthPyramid, maxTexel, level).r));
+	const float sphereDepth = clusterView.znear / (-prevViewCenter.z - radius);
+	return sphereDepth >= depth;
+}
+
+/*Frustum, normal cone and occlusion tests of a meshlet of a job for an instance*/
+bool asClusterVisible(asClusterJob job, uint meshletIdx, uint instance)
+{
+	const asMeshlet meshlet = clusterMeshlets[meshletIdx];
+	const asInstanceTransform xform = clusterTransforms[job.transformOffset + instance];
+	const vec3 scale = abs(xform.scaleOpacity.xyz);
+	const float maxScale = max(scale.x, max(scale.y, scale.z));
+	const vec3 center = asClusterTransformPoint(xform, meshlet.center);
+	const float radius = meshlet.radius * maxScale;
+
+	/*Frustum*/
+	for (int i = 0; i < 5; i++)
+	{
+		if (dot(clusterView.frustumPlanes[i].xyz, center) + clusterView.frustumPlanes[i].w < -radius) { return false; }
+	}
+
+	/*Normal Cone (only holds with uniform scale, mirroring flips the winding)*/
+	const bool perspective = (clusterView.flags & CLUSTER_CULL_FLAG_PERSPECTIVE) != 0;
+	const bool uniformScale = all(greaterThan(xform.scaleOpacity.xyz, vec3(0.0))) &&
+		all(lessThan(abs(scale - vec3(maxScale)), vec3(maxScale * 0.001)));
+	if (perspective && uniformScale && (job.flags & AS_CLUSTER_JOB_NO_CONE) == 0 && meshlet.coneCutoff < 1.0)
+	{
+		const vec3 apex = asClusterTransformPoint(xform, meshlet.coneApex);
+		const vec3 axis = normalize(asClusterRotate(xform.rotation, meshlet.coneAxis));
+		if (dot(normalize(apex - clusterView.viewPosition.xyz), axis) >= meshlet.coneCutoff) { return false; }
+	}
+
+	/*Occlusion (against last frame with the transform of last frame)*/
+	if ((clusterView.flags & CLUSTER_CULL_FLAG_OCCLUSION) != 0 && (job.flags & AS_CLUSTER_JOB_NO_OCCLUSION) == 0)
+	{
+		const asInstanceTransform prevXform = clusterTransforms[job.transformOffsetPreviousFrame + instance];
+		const vec3 prevCenter = asClusterTransformPoint(prevXform, meshlet.center);
+		const vec3 prevViewCenter = (clusterView.prevView * vec4(prevCenter, 1.0)).xyz;
+		if (!asClusterDepthVisible(prevViewCenter, radius)) { return false; }
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*Vertex pulling from the geometry arena for Scene FX (see asGeometryArena.h)
+Layouts match asVertexGeneric in asModelRuntime.h and primInstanceData in asSceneRenderer.c*/
+#ifndef AS_GEOMETRY_ARENA_GLSL
+#define AS_GEOMETRY_ARENA_GLSL
+
+/*Scene pipelines bind the arena after the cluster sets*/
+#ifndef AS_GEOMETRY_ARENA_SET
+#define AS_GEOMETRY_ARENA_SET 4
+#endif
+
+#define AS_ARENA_VERTEX_WORDS 11 /*sizeof(asVertexGeneric) / 4*/
+
+layout(std430, set = AS_GEOMETRY_ARENA_SET, binding = 0) readonly buffer ArenaVertices { uint arenaVertices[]; };
+layout(std430, set = AS_GEOMETRY_ARENA_SET, binding = 1) readonly buffer ArenaIndices { uint arenaIndices[]; };
+
+/*Per instance data of Scene pipelines (vertex binding 1), the "arena" pipeline (RENDER_GEOMETRY_ARENA) reads these instead of the push constants*/
+layout(location = 8) in uvec2 inInstanceTransforms; /*Previous frame, current frame*/
+layout(location = 9) in int inInstanceMaterial;
+
+/*Draws from the arena index the whole arena with gl_VertexIndex (the first vertex of the range is added by the draw)*/
+vec3 asArenaVertexPosition(uint vertex)
+{
+	const uint word = vertex * AS_ARENA_VERTEX_WORDS;
+	return uintBitsToFloat(uvec3(arenaVertices[word], arenaVertices[word + 1], arenaVertices[word + 2]));
+}
+
+/*Packed like the vertex attributes (A2R10G10B10 normal and tangent, 16 bit float UVs)*/
+uint asArenaVertexWord(uint vertex, uint word)
+{
+	return arenaVertices[(vertex * AS_ARENA_VERTEX_WORDS) + word];
+}
+
+vec4 asArenaVertexNormal(uint vertex)
+{
+	const int p = int(asArenaVertexWord(vertex, 3));
+	return max(vec4(bitfieldExtract(p, 20, 10), bitfieldExtract(p, 10, 10), bitfieldExtract(p, 0, 10), 0) / vec4(511.0, 511.0, 511.0, 1.0), vec4(-1.0));
+}
+
+vec4 asArenaVertexTangent(uint vertex)
+{
+	const int p = int(asArenaVertexWord(vertex, 4));
+	return max(vec4(bitfieldExtract(p, 20, 10), bitfieldExtract(p, 10, 10), bitfieldExtract(p, 0, 10), bitfieldExtract(p, 30, 2)) / vec4(511.0, 511.0, 511.0, 1.0), vec4(-1.0));
+}
+
+vec2 asArenaVertexUV(uint vertex, uint channel)
+{
+	return unpackHalf2x16(asArenaVertexWord(vertex, 5 + channel));
+}
+
+vec4 asArenaVertexColor(uint vertex)
+{
+	return unpackUnorm4x8(asArenaVertexWord(vertex, 7));
+}
+
+#endif
@@ -0,0 +1,18 @@
+/*Position only vertices of the "depth" and "depthFloat" Scene FX pipelines (RENDER_DEPTH_ONLY, see positionBuffer in asSceneRenderer.h)
+Layout matches the position stream of asModel_t in asModelRuntime.h*/
+#ifndef AS_POSITION_STREAM_GLSL
+#define AS_POSITION_STREAM_GLSL
+
+#include "ScenePushConstants.glsl"
+
+/*16 bit UNORM XYZ over the bounds of the model (W is padding),
+or float XYZ with RENDER_DEPTH_FLOAT_POSITIONS (pushed with an unit scale and no offset)*/
+layout(location = 0) in vec4 inStreamPosition;
+
+/*Dequantize with positionScale and positionOffset of the push constants*/
+vec3 asPositionStreamDecode()
+{
+	return scenePushConstants.positionOffset + scenePushConstants.positionScale * inStreamPosition.xyz;
+}
+
+#endif
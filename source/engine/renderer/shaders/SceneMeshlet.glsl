@@ -0,0 +1,126 @@
+/*Task, mesh and fragment stages of the "meshlet" Scene FX pipeline (RENDER_MESHLET, see asClusterCulling.h)
+Included by Scene FX before anything else, define AS_SCENE_MESHLET_CUSTOM_FRAGMENT to shade the meshlets with a fragment stage of its own (inputs at the locations written by the mesh stage)
+Task workgroups cull AS_CLUSTER_TASK_GROUP_SIZE meshlets of the job in clusterJob for one instance (asClusterCullBatchDrawCmd() dispatches meshlets x instances)*/
+#ifndef AS_SCENE_MESHLET_GLSL
+#define AS_SCENE_MESHLET_GLSL
+
+#if defined(AS_STAGE_TASK) || defined(AS_STAGE_MESH)
+#extension GL_EXT_mesh_shader : require
+#endif
+
+#include "ClusterCulling.glsl"
+#include "ScenePushConstants.glsl"
+
+#define AS_MESHLET_MAX_VERTICES 64 /*AS_MODEL_MESHLET_MAX_VERTICES*/
+#define AS_MESHLET_MAX_TRIANGLES 124 /*AS_MODEL_MESHLET_MAX_TRIANGLES*/
+
+#if defined(AS_STAGE_TASK) || defined(AS_STAGE_MESH)
+/*Meshlets of the workgroup that survived culling*/
+struct asMeshletPayload {
+	uint instance;
+	uint meshlets[AS_CLUSTER_TASK_GROUP_SIZE];
+};
+taskPayloadSharedEXT asMeshletPayload meshletPayload;
+#endif
+
+#ifdef AS_STAGE_TASK
+layout(local_size_x = AS_CLUSTER_TASK_GROUP_SIZE) in;
+
+shared uint meshletVisibleCount;
+
+void main()
+{
+	const asClusterJob job = clusterJobs[scenePushConstants.clusterJob];
+	const uint local = gl_LocalInvocationID.x;
+	const uint meshlet = (gl_WorkGroupID.x * AS_CLUSTER_TASK_GROUP_SIZE) + local;
+	const uint instance = gl_WorkGroupID.y;
+	if (local == 0)
+	{
+		meshletVisibleCount = 0;
+		meshletPayload.instance = instance;
+	}
+	barrier();
+
+	if (meshlet < job.meshletCount && asClusterVisible(job, job.firstMeshlet + meshlet, instance))
+	{
+		meshletPayload.meshlets[atomicAdd(meshletVisibleCount, 1)] = job.firstMeshlet + meshlet;
+	}
+	barrier();
+	EmitMeshTasksEXT(meshletVisibleCount, 1, 1);
+}
+#endif
+
+#ifdef AS_STAGE_MESH
+layout(local_size_x = AS_CLUSTER_TASK_GROUP_SIZE) in;
+layout(triangles, max_vertices = AS_MESHLET_MAX_VERTICES, max_primitives = AS_MESHLET_MAX_TRIANGLES) out;
+
+/*Interpolants of the fragment stage*/
+layout(location = 0) out vec3 outWorldPosition[];
+layout(location = 1) out vec3 outNormal[];
+layout(location = 2) out vec2 outUV[];
+layout(location = 3) out vec4 outColor[];
+layout(location = 4) flat out int outMaterial[];
+
+/*Packed like the vertex attributes (A2R10G10B10 or octahedral RG16 normal, 16 bit float UVs)
+Normals are decoded like asSkinDecodeSnorm10() and asSkinDecodeOctahedral() of Skinning_FX.glsl*/
+vec3 asClusterVertexNormal(uint vertex, uint jobFlags)
+{
+	const int p = int(clusterVertices[(vertex * AS_CLUSTER_VERTEX_WORDS) + 3]);
+	if ((jobFlags & AS_CLUSTER_JOB_OCTAHEDRAL_NORMALS) == 0)
+	{
+		return max(vec3(bitfieldExtract(p, 20, 10), bitfieldExtract(p, 10, 10), bitfieldExtract(p, 0, 10)) / 511.0, vec3(-1.0));
+	}
+	vec2 xy = max(vec2(bitfieldExtract(p, 0, 16), bitfieldExtract(p, 16, 16)) / 32767.0, vec2(-1.0));
+	const float z = (1.0 - abs(xy.x)) - abs(xy.y);
+	const float t = max(-z, 0.0);
+	xy += mix(vec2(t), vec2(-t), greaterThanEqual(xy, vec2(0.0)));
+	return normalize(vec3(xy, z));
+}
+
+void main()
+{
+	const asClusterJob job = clusterJobs[scenePushConstants.clusterJob];
+	const asMeshlet meshlet = clusterMeshlets[meshletPayload.meshlets[gl_WorkGroupID.x]];
+	const asInstanceTransform xform = clusterTransforms[job.transformOffset + meshletPayload.instance];
+	const uint vertexCount = asMeshletVertexCount(meshlet);
+	const uint triangleCount = asMeshletTriangleCount(meshlet);
+	SetMeshOutputsEXT(vertexCount, triangleCount);
+
+	for (uint v = gl_LocalInvocationID.x; v < vertexCount; v += AS_CLUSTER_TASK_GROUP_SIZE)
+	{
+		const uint vertex = asMeshletVertex(meshlet, v);
+		const uint word = vertex * AS_CLUSTER_VERTEX_WORDS;
+		const vec3 worldPosition = asClusterTransformPoint(xform, asClusterVertexPosition(vertex));
+		gl_MeshVerticesEXT[v].gl_Position = clusterView.viewProj * vec4(worldPosition, 1.0);
+		outWorldPosition[v] = worldPosition;
+		outNormal[v] = asClusterRotate(xform.rotation, asClusterVertexNormal(vertex, job.flags) / xform.scaleOpacity.xyz);
+		outUV[v] = unpackHalf2x16(clusterVertices[word + 5]);
+		outColor[v] = unpackUnorm4x8(clusterVertices[word + 7]);
+		outMaterial[v] = scenePushConstants.materialIdx;
+	}
+	for (uint t = gl_LocalInvocationID.x; t < triangleCount; t += AS_CLUSTER_TASK_GROUP_SIZE)
+	{
+		gl_PrimitiveTriangleIndicesEXT[t] = asMeshletTriangle(meshlet, t);
+	}
+}
+#endif
+
+#if defined(AS_STAGE_FRAGMENT) && !defined(AS_SCENE_MESHLET_CUSTOM_FRAGMENT)
+layout(location = 0) in vec3 inWorldPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) flat in int inMaterial;
+
+layout(location = 0) out vec4 outColor;
+
+/*Vertex color lit from the camera, enough to check which meshlets survived culling*/
+void main()
+{
+	const vec3 toView = normalize(clusterView.viewPosition.xyz - inWorldPosition);
+	const float lighting = 0.25 + (0.75 * abs(dot(normalize(inNormal), toView)));
+	outColor = vec4(inColor.rgb * lighting, inColor.a);
+}
+#endif
+
+#endif
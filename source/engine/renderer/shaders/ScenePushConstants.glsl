@@ -0,0 +1,17 @@
+/*Push constants of every Scene FX pipeline
+Layout matches scenePushConstants in asSceneRenderer.c*/
+#ifndef AS_SCENE_PUSH_CONSTANTS_GLSL
+#define AS_SCENE_PUSH_CONSTANTS_GLSL
+
+layout(push_constant) uniform ScenePushConstants {
+	layout(offset = 0) int materialIdx;
+	layout(offset = 4) int transformOffsetCurrent;
+	layout(offset = 8) int transformOffsetLast;
+	layout(offset = 12) int debugIdx;
+	layout(offset = 16) int clusterJob; /*Job of the cluster batch bound to the "meshlet" pipeline (-1 when drawn whole)*/
+	layout(offset = 20) int instanceData; /*Transforms and material come from the instance attributes (the "arena" pipeline, see GeometryArena.glsl)*/
+	layout(offset = 32) vec3 positionScale; /*Dequantization of the position stream (the "depth" and "depthFloat" pipelines, see PositionStream.glsl)*/
+	layout(offset = 48) vec3 positionOffset;
+} scenePushConstants;
+
+#endif
@@ -0,0 +1,134 @@
+#version 450
+#pragma asShaderType Skinning
+/*Compiled to shaders/core/Skinning_FX.asfx (see asComputeSkinning.h)
+Layouts match the structures in asComputeSkinning.c, asModelRuntime.h and asAnimation.h
+The CPU port in tools/animbenchmark/AnimBenchmark.c checks the math against the palettes (keep the two in step)*/
+
+#define AS_SKIN_GROUP_SIZE 64
+#define AS_SKIN_VERTEX_WORDS 11 /*sizeof(asVertexGeneric) / 4*/
+#define AS_SKIN_JOB_OCTAHEDRAL_NORMALS 1
+
+layout(local_size_x = AS_SKIN_GROUP_SIZE) in;
+
+struct asSkinJob {
+	uint firstSourceVertex;
+	uint vertexCount;
+	uint firstPalette;
+	uint firstCacheVertex;
+	uint flags;
+	uint _pad0;
+	uint _pad1;
+	uint _pad2;
+};
+
+/*First three rows of a column major affine matrix (asAnimPaletteMatrix_t)*/
+struct asSkinMatrix {
+	vec4 rows[3];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer SkinJobs { asSkinJob skinJobs[]; };
+layout(std430, set = 0, binding = 1) readonly buffer SkinPalettes { asSkinMatrix skinPalettes[]; };
+layout(std430, set = 0, binding = 2) writeonly buffer SkinCache { uint skinCache[]; };
+layout(std430, set = 1, binding = 0) readonly buffer SkinSource { uint skinSource[]; };
+
+layout(push_constant) uniform SkinPushConstants {
+	uint firstJob;
+} pushConstants;
+
+/*Packing matches asVertexEncoding.c (XYZ from the high bits down, round to nearest even)*/
+vec3 asSkinDecodeSnorm10(uint packed)
+{
+	const int p = int(packed);
+	return max(vec3(bitfieldExtract(p, 20, 10), bitfieldExtract(p, 10, 10), bitfieldExtract(p, 0, 10)) / 511.0, vec3(-1.0));
+}
+
+uint asSkinEncodeSnorm10(vec3 v, uint w)
+{
+	const uvec3 q = uvec3(ivec3(roundEven(clamp(v, -1.0, 1.0) * 511.0))) & 0x3FF;
+	return q.z | (q.y << 10) | (q.x << 20) | (w << 30);
+}
+
+vec3 asSkinDecodeOctahedral(uint packed)
+{
+	const int p = int(packed);
+	vec2 xy = max(vec2(bitfieldExtract(p, 0, 16), bitfieldExtract(p, 16, 16)) / 32767.0, vec2(-1.0));
+	const float z = (1.0 - abs(xy.x)) - abs(xy.y);
+	const float t = max(-z, 0.0);
+	xy += mix(vec2(t), vec2(-t), greaterThanEqual(xy, vec2(0.0)));
+	return normalize(vec3(xy, z));
+}
+
+/*Skinned zero vectors (vertices without tangents) stay zero*/
+vec3 asSkinNormalize(vec3 v)
+{
+	const float size = length(v);
+	return size > 0.0 ? v / size : v;
+}
+
+uint asSkinEncodeOctahedral(vec3 n)
+{
+	float sum = (abs(n.x) + abs(n.y)) + abs(n.z);
+	sum = sum > 0.0 ? sum : 1.0;
+	vec2 xy = n.xy / sum;
+	if (n.z < 0.0)
+	{
+		xy = (vec2(1.0) - abs(xy.yx)) * mix(vec2(-1.0), vec2(1.0), greaterThanEqual(xy, vec2(0.0)));
+	}
+	const uvec2 q = uvec2(ivec2(roundEven(clamp(xy, -1.0, 1.0) * 32767.0))) & 0xFFFF;
+	return q.x | (q.y << 16);
+}
+
+void main()
+{
+	const asSkinJob job = skinJobs[pushConstants.firstJob + gl_WorkGroupID.y];
+	const uint vertex = gl_GlobalInvocationID.x;
+	if (vertex >= job.vertexCount) { return; }
+	const uint src = (job.firstSourceVertex + vertex) * AS_SKIN_VERTEX_WORDS;
+	const uint dst = (job.firstCacheVertex + vertex) * AS_SKIN_VERTEX_WORDS;
+
+	/*UVs, color, bones and weights are copied as they are*/
+	for (uint i = 5; i < AS_SKIN_VERTEX_WORDS; i++)
+	{
+		skinCache[dst + i] = skinSource[src + i];
+	}
+
+	/*Blend the matrices of the bones (vertices without weights keep the bind pose)*/
+	const uvec4 bones = uvec4(skinSource[src + 8] & 0xFFFF, skinSource[src + 8] >> 16, skinSource[src + 9] & 0xFFFF, skinSource[src + 9] >> 16);
+	const vec4 weights = unpackUnorm4x8(skinSource[src + 10]);
+	if (dot(weights, vec4(1.0)) <= 0.0)
+	{
+		for (uint i = 0; i < 5; i++)
+		{
+			skinCache[dst + i] = skinSource[src + i];
+		}
+		return;
+	}
+	vec4 rows[3] = vec4[3](vec4(0.0), vec4(0.0), vec4(0.0));
+	for (uint i = 0; i < 4; i++)
+	{
+		if (weights[i] <= 0.0) { continue; }
+		const asSkinMatrix bone = skinPalettes[job.firstPalette + bones[i]];
+		rows[0] += bone.rows[0] * weights[i];
+		rows[1] += bone.rows[1] * weights[i];
+		rows[2] += bone.rows[2] * weights[i];
+	}
+	const mat3 rotation = transpose(mat3(rows[0].xyz, rows[1].xyz, rows[2].xyz));
+
+	/*Position*/
+	const vec4 position = vec4(uintBitsToFloat(uvec3(skinSource[src], skinSource[src + 1], skinSource[src + 2])), 1.0);
+	skinCache[dst] = floatBitsToUint(dot(rows[0], position));
+	skinCache[dst + 1] = floatBitsToUint(dot(rows[1], position));
+	skinCache[dst + 2] = floatBitsToUint(dot(rows[2], position));
+
+	/*Normal*/
+	const bool octahedral = (job.flags & AS_SKIN_JOB_OCTAHEDRAL_NORMALS) != 0;
+	const uint packedNormal = skinSource[src + 3];
+	const vec3 normal = octahedral ? asSkinDecodeOctahedral(packedNormal) : asSkinDecodeSnorm10(packedNormal);
+	const vec3 skinnedNormal = asSkinNormalize(rotation * normal);
+	skinCache[dst + 3] = octahedral ? asSkinEncodeOctahedral(skinnedNormal) : asSkinEncodeSnorm10(skinnedNormal, 0);
+
+	/*Tangent (bitangent sign stays in W)*/
+	const uint packedTangent = skinSource[src + 4];
+	const vec3 skinnedTangent = asSkinNormalize(rotation * asSkinDecodeSnorm10(packedTangent));
+	skinCache[dst + 4] = asSkinEncodeSnorm10(skinnedTangent, packedTangent >> 30);
+}
@@ -2,6 +2,7 @@
 #if ASTRENGINE_VK
 #include <SDL_vulkan.h>
 #include "../asRendererCore.h"
+#include "../../common/asHashing.h"
 
 typedef struct{
 	float customParams[AS_MAX_GLOBAL_CUSTOM_PARAMS][4];
@@ -16,8 +17,16 @@ VkPhysicalDevice asVkPhysicalDevice = VK_NULL_HANDLE;
 
 VkPhysicalDeviceProperties asVkDeviceProperties;
 VkPhysicalDeviceFeatures asVkDeviceFeatures;
+VkPhysicalDeviceDescriptorIndexingPropertiesEXT asVkDescriptorIndexingProps;
 VkPhysicalDeviceMemoryProperties asVkDeviceMemProps;
 
+bool asVkDrawIndirectCountSupported;
+bool asVkMeshShaderSupported;
+PFN_vkCmdDrawIndexedIndirectCountKHR asVkCmdDrawIndexedIndirectCount;
+#ifdef VK_EXT_mesh_shader
+PFN_vkCmdDrawMeshTasksEXT asVkCmdDrawMeshTasks;
+#endif
+
 VkDevice asVkDevice;
 VkQueue asVkQueue_GFX;
 VkQueue asVkQueue_Present;
@@ -26,6 +35,7 @@ VkQueue asVkQueue_Transfer;
 asVkQueueFamilyIndices_t asVkQueueFamilyIndices;
 
 VkCommandPool asVkGeneralCommandPool;
+VkCommandPool vTransferCommandPool;
 uint32_t asVkCurrentFrame = 0;
 VkFence asVkInFlightFences[AS_MAX_INFLIGHT];
 
@@ -43,7 +53,9 @@ bool vIsQueueFamilyComplete(asVkQueueFamilyIndices_t indices)
 }
 
 const char* deviceReqExtensions[] = {
-	VK_KHR_SWAPCHAIN_EXTENSION_NAME
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+	VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
 };
 
 #if AS_VK_VALIDATION
@@ -101,7 +113,7 @@ VkDebugReportCallbackEXT vDbgCallback;
 
 asVkQueueFamilyIndices_t vFindQueueFamilyIndices(VkPhysicalDevice gpu)
 {
-	asVkQueueFamilyIndices_t result = (asVkQueueFamilyIndices_t) { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+	asVkQueueFamilyIndices_t result = (asVkQueueFamilyIndices_t) { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
 	uint32_t queueFamilyCount;
 	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, NULL);
 	VkQueueFamilyProperties *queueFamilyProps = asMalloc(sizeof(VkQueueFamilyProperties) * queueFamilyCount);
@@ -123,6 +135,16 @@ asVkQueueFamilyIndices_t vFindQueueFamilyIndices(VkPhysicalDevice gpu)
 		if (vIsQueueFamilyComplete(result))
 			break;
 	}
+	/*Prefer a dedicated transfer family (copy engine) so uploads run beside rendering*/
+	for (uint32_t i = 0; i < queueFamilyCount; i++)
+	{
+		if (queueFamilyProps[i].queueCount > 0 && queueFamilyProps[i].queueFlags & VK_QUEUE_TRANSFER_BIT &&
+			!(queueFamilyProps[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+		{
+			result.transferIdx = i;
+			break;
+		}
+	}
 	asFree(queueFamilyProps);
 	return result;
 }
@@ -248,6 +270,22 @@ bool vDeviceHasRequiredFeatures(VkPhysicalDeviceFeatures *pFeatures)
 	return true;
 }
 
+bool vDeviceHasRequiredDescriptorIndexing(VkPhysicalDevice gpu)
+{
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
+	VkPhysicalDeviceFeatures2 features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	features.pNext = &indexingFeatures;
+	vkGetPhysicalDeviceFeatures2(gpu, &features);
+	if (!indexingFeatures.runtimeDescriptorArray || /*Bindless texture pool*/
+		!indexingFeatures.shaderSampledImageArrayNonUniformIndexing ||
+		!indexingFeatures.descriptorBindingPartiallyBound ||
+		!indexingFeatures.descriptorBindingVariableDescriptorCount ||
+		!indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+		!indexingFeatures.descriptorBindingUpdateUnusedWhilePending)
+		return false;
+	return true;
+}
+
 VkPhysicalDevice vPickBestDevice(VkPhysicalDevice* pGpus, uint32_t count)
 {
 	int64_t bestGPUIdx = -1;
@@ -268,6 +306,8 @@ VkPhysicalDevice vPickBestDevice(VkPhysicalDevice* pGpus, uint32_t count)
 			continue;
 		if (!vDeviceHasRequiredExtensions(pGpus[i])) /*Doesn't have the required extensions*/
 			continue;
+		if (!vDeviceHasRequiredDescriptorIndexing(pGpus[i])) /*Can't hold the bindless texture pool*/
+			continue;
 		int32_t vSwapchainScore = vQueryAndRateSwapChainSupport(pGpus[i], vMainScreen.surface, NULL, NULL, NULL);
 		if (vSwapchainScore < 0) /*Swapchain is unusable*/
 			continue;
@@ -308,16 +348,38 @@ int32_t asVkFindMemoryType(uint32_t typeBitsReq, VkMemoryPropertyFlags requiredP
 	return vFindMemoryType(&asVkDeviceMemProps, typeBitsReq, requiredProps);
 }
 
+/*Allocations grouped by the debug label of what they were made for*/
+struct vMemoryConsumer_t
+{
+	asHash64_t labelHash;
+	char label[64];
+	VkDeviceSize bytes;
+	uint32_t count;
+};
+
 struct vMemoryAllocator_t
 {
 	uint32_t allocCount;
 	VkDeviceSize *pTypeAllocationSizes;
+	uint32_t *pTypeAllocationCounts;
+	VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS]; /*Refreshed every frame*/
+	VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS];
+	VkDeviceSize heapPooledFreeBytes[VK_MAX_MEMORY_HEAPS]; /*Unused space of suballocated blocks (reused before allocating more)*/
+	struct vMemoryConsumer_t* pConsumers;
+	uint32_t consumerCount;
 };
 void vMemoryAllocator_Init(struct vMemoryAllocator_t* pAllocator)
 {
 	pAllocator->allocCount = 0;
 	pAllocator->pTypeAllocationSizes = (VkDeviceSize*)asMalloc(asVkDeviceMemProps.memoryTypeCount * sizeof(VkDeviceSize));
 	memset(pAllocator->pTypeAllocationSizes, 0, asVkDeviceMemProps.memoryTypeCount * sizeof(VkDeviceSize));
+	pAllocator->pTypeAllocationCounts = (uint32_t*)asMalloc(asVkDeviceMemProps.memoryTypeCount * sizeof(uint32_t));
+	memset(pAllocator->pTypeAllocationCounts, 0, asVkDeviceMemProps.memoryTypeCount * sizeof(uint32_t));
+	memset(pAllocator->heapBudgets, 0, sizeof(pAllocator->heapBudgets));
+	memset(pAllocator->heapUsages, 0, sizeof(pAllocator->heapUsages));
+	memset(pAllocator->heapPooledFreeBytes, 0, sizeof(pAllocator->heapPooledFreeBytes));
+	pAllocator->pConsumers = NULL;
+	pAllocator->consumerCount = 0;
 }
 
 void vMemoryAllocator_Shutdown(struct vMemoryAllocator_t* pAllocator)
@@ -325,6 +387,91 @@ void vMemoryAllocator_Shutdown(struct vMemoryAllocator_t* pAllocator)
 	pAllocator->allocCount = 0;
 	if(pAllocator->pTypeAllocationSizes)
 		asFree(pAllocator->pTypeAllocationSizes);
+	if (pAllocator->pTypeAllocationCounts)
+		asFree(pAllocator->pTypeAllocationCounts);
+	asFree(pAllocator->pConsumers);
+	pAllocator->pConsumers = NULL;
+	pAllocator->consumerCount = 0;
+}
+
+VkDeviceSize vMemoryAllocator_HeapAllocatedBytes(struct vMemoryAllocator_t* pAllocator, uint32_t heap, uint32_t* pCount)
+{
+	VkDeviceSize bytes = 0;
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < asVkDeviceMemProps.memoryTypeCount; i++)
+	{
+		if (asVkDeviceMemProps.memoryTypes[i].heapIndex != heap)
+			continue;
+		bytes += pAllocator->pTypeAllocationSizes[i];
+		count += pAllocator->pTypeAllocationCounts[i];
+	}
+	if (pCount)
+		*pCount = count;
+	return bytes;
+}
+
+bool vMemoryBudgetExtensionFound;
+
+/*Budgets come from the driver when it supports VK_EXT_memory_budget,
+otherwise most of each heap is assumed to be ours and only our own allocations count as used*/
+void vMemoryAllocator_UpdateBudget(struct vMemoryAllocator_t* pAllocator)
+{
+	if (vMemoryBudgetExtensionFound)
+	{
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = (VkPhysicalDeviceMemoryBudgetPropertiesEXT) { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+		VkPhysicalDeviceMemoryProperties2 memProps = (VkPhysicalDeviceMemoryProperties2) { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+		memProps.pNext = &budgetProps;
+		vkGetPhysicalDeviceMemoryProperties2(asVkPhysicalDevice, &memProps);
+		for (uint32_t i = 0; i < asVkDeviceMemProps.memoryHeapCount; i++)
+		{
+			pAllocator->heapBudgets[i] = budgetProps.heapBudget[i];
+			pAllocator->heapUsages[i] = budgetProps.heapUsage[i];
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < asVkDeviceMemProps.memoryHeapCount; i++)
+		{
+			pAllocator->heapBudgets[i] = asVkDeviceMemProps.memoryHeaps[i].size / 10 * 8;
+			pAllocator->heapUsages[i] = vMemoryAllocator_HeapAllocatedBytes(pAllocator, i, NULL);
+		}
+	}
+}
+
+/*Returns the consumer to pass back to vMemoryAllocator_RemoveConsumer()*/
+uint32_t vMemoryAllocator_AddConsumer(struct vMemoryAllocator_t* pAllocator, const char* pLabel, VkDeviceSize bytes)
+{
+	if (!pLabel)
+		pLabel = "(unnamed)";
+	const asHash64_t hash = asHashBytes64_xxHash(pLabel, strlen(pLabel));
+	uint32_t index = 0;
+	while (index < pAllocator->consumerCount && pAllocator->pConsumers[index].labelHash != hash)
+		index++;
+	if (index == pAllocator->consumerCount)
+	{
+		pAllocator->pConsumers = asRealloc(pAllocator->pConsumers, sizeof(struct vMemoryConsumer_t) * (pAllocator->consumerCount + 1));
+		pAllocator->consumerCount++;
+		struct vMemoryConsumer_t* pConsumer = &pAllocator->pConsumers[index];
+		memset(pConsumer, 0, sizeof(*pConsumer));
+		pConsumer->labelHash = hash;
+		strncat(pConsumer->label, pLabel, sizeof(pConsumer->label) - 1);
+	}
+	pAllocator->pConsumers[index].bytes += bytes;
+	pAllocator->pConsumers[index].count++;
+	return index;
+}
+
+void vMemoryAllocator_RemoveConsumer(struct vMemoryAllocator_t* pAllocator, uint32_t index, VkDeviceSize bytes)
+{
+	pAllocator->pConsumers[index].bytes -= bytes;
+	pAllocator->pConsumers[index].count--;
+}
+
+/*Change the size counted for an allocation of a consumer (suballocated blocks as their use changes)*/
+void vMemoryAllocator_ResizeConsumer(struct vMemoryAllocator_t* pAllocator, uint32_t index, VkDeviceSize oldBytes, VkDeviceSize newBytes)
+{
+	pAllocator->pConsumers[index].bytes -= oldBytes;
+	pAllocator->pConsumers[index].bytes += newBytes;
 }
 
 struct vMemoryAllocator_t vMainAllocator;
@@ -333,6 +480,7 @@ void asVkAlloc(asVkAllocation_t *pMem, VkDeviceSize size, uint32_t type)
 {
 	vMainAllocator.allocCount++;
 	vMainAllocator.pTypeAllocationSizes[type] += size;
+	vMainAllocator.pTypeAllocationCounts[type]++;
 
 	VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
 	allocInfo.allocationSize = size;
@@ -347,12 +495,72 @@ void asVkFree(asVkAllocation_t* pMem)
 {
 	vMainAllocator.allocCount--;
 	vMainAllocator.pTypeAllocationSizes[pMem->memType] -= pMem->size;
+	vMainAllocator.pTypeAllocationCounts[pMem->memType]--;
 	vkFreeMemory(asVkDevice, pMem->memHandle, AS_VK_MEMCB);
 	pMem->memHandle = VK_NULL_HANDLE;
 	pMem->size = 0;
 	pMem->offset = 0;
 }
 
+ASEXPORT void asGetGpuMemoryStats(asGpuMemoryStats_t* pStats)
+{
+	memset(pStats, 0, sizeof(*pStats));
+	pStats->driverBudget = vMemoryBudgetExtensionFound;
+	pStats->heapCount = asVkDeviceMemProps.memoryHeapCount < AS_GPU_MAX_MEMORY_HEAPS ?
+		asVkDeviceMemProps.memoryHeapCount : AS_GPU_MAX_MEMORY_HEAPS;
+	for (uint32_t i = 0; i < pStats->heapCount; i++)
+	{
+		asGpuMemoryHeapStats_t* pHeap = &pStats->heaps[i];
+		pHeap->size = asVkDeviceMemProps.memoryHeaps[i].size;
+		pHeap->budget = vMainAllocator.heapBudgets[i];
+		pHeap->usage = vMainAllocator.heapUsages[i];
+		pHeap->allocatedBytes = vMemoryAllocator_HeapAllocatedBytes(&vMainAllocator, i, &pHeap->allocationCount);
+		pHeap->deviceLocal = (asVkDeviceMemProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
+}
+
+ASEXPORT int64_t asGetGpuMemoryHeadroom()
+{
+	int64_t headroom = 0;
+	bool found = false;
+	for (uint32_t i = 0; i < asVkDeviceMemProps.memoryHeapCount; i++)
+	{
+		if (!(asVkDeviceMemProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+			continue;
+		headroom += (int64_t)vMainAllocator.heapBudgets[i] - (int64_t)vMainAllocator.heapUsages[i] +
+			(int64_t)vMainAllocator.heapPooledFreeBytes[i];
+		found = true;
+	}
+	return found ? headroom : INT64_MAX;
+}
+
+ASEXPORT size_t asGetGpuMemoryConsumers(asGpuMemoryConsumer_t* pOut, size_t maxCount)
+{
+	/*Keep the largest in order as they are found*/
+	size_t count = 0;
+	for (uint32_t i = 0; i < vMainAllocator.consumerCount; i++)
+	{
+		const struct vMemoryConsumer_t* pConsumer = &vMainAllocator.pConsumers[i];
+		if (!pConsumer->count)
+			continue;
+		size_t slot = count;
+		while (slot > 0 && pOut[slot - 1].bytes < pConsumer->bytes)
+		{
+			if (slot < maxCount)
+				pOut[slot] = pOut[slot - 1];
+			slot--;
+		}
+		if (slot >= maxCount)
+			continue;
+		pOut[slot].pLabel = pConsumer->label;
+		pOut[slot].bytes = pConsumer->bytes;
+		pOut[slot].count = pConsumer->count;
+		if (count < maxCount)
+			count++;
+	}
+	return count;
+}
+
 void asVkMapMemory(asVkAllocation_t mem, VkDeviceSize offset, VkDeviceSize size, void** ppData)
 {
 	vkMapMemory(asVkDevice, mem.memHandle, mem.offset + offset, size, 0, ppData);
@@ -379,20 +587,180 @@ struct vTexture_t
 	asTextureType textureType;
 	asGpuResourceUploadType cpuAccess;
 	asVkAllocation_t alloc;
+	int32_t memoryBlock; /*Shared memory block the allocation is part of (-1 when the texture owns it)*/
+	uint32_t memoryConsumer; /*Debug label the memory is counted under (UINT32_MAX when none)*/
 	VkImage image;
 	VkImageView view;
 };
 
+/*Device memory shared by textures created together
+Released ranges go on a free list that later batches fill before allocating more, the block is freed once all of it is unused*/
+#define AS_VK_TEXTURE_BLOCK_SIZE (64 * 1024 * 1024)
+#define AS_VK_TEXTURE_BLOCK_CONSUMER "Unused Texture Block Memory"
+
+struct vTextureBlockRange_t
+{
+	VkDeviceSize offset;
+	VkDeviceSize size;
+};
+
+struct vTextureMemoryBlock_t
+{
+	asVkAllocation_t alloc;
+	struct vTextureBlockRange_t* pFree; /*Sorted by offset, neighbours are always merged*/
+	uint32_t freeCount;
+	uint32_t freeCapacity;
+	VkDeviceSize freeBytes;
+	uint32_t refCount;
+	uint32_t memoryConsumer; /*The unused space is counted under AS_VK_TEXTURE_BLOCK_CONSUMER*/
+};
+
+struct vTextureManager_t
+{
+	asHandleManager_t handleManager;
+	struct vTexture_t* textures;
+	struct vTextureMemoryBlock_t* pBlocks;
+	uint32_t blockCount;
+};
+struct vTextureManager_t vMainTextureManager;
+
+VkDeviceSize vAlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+/*Keeps the consumer stats and the budget headroom in step with the unused space of the block*/
+void vTextureBlock_SetFreeBytes(struct vTextureMemoryBlock_t* pBlock, VkDeviceSize freeBytes)
+{
+	const uint32_t heap = asVkDeviceMemProps.memoryTypes[pBlock->alloc.memType].heapIndex;
+	vMemoryAllocator_ResizeConsumer(&vMainAllocator, pBlock->memoryConsumer, pBlock->freeBytes, freeBytes);
+	vMainAllocator.heapPooledFreeBytes[heap] -= pBlock->freeBytes;
+	vMainAllocator.heapPooledFreeBytes[heap] += freeBytes;
+	pBlock->freeBytes = freeBytes;
+}
+
+void vTextureBlock_InsertRange(struct vTextureMemoryBlock_t* pBlock, uint32_t at, VkDeviceSize offset, VkDeviceSize size)
+{
+	if (pBlock->freeCount == pBlock->freeCapacity)
+	{
+		pBlock->freeCapacity = pBlock->freeCapacity ? pBlock->freeCapacity * 2 : 8;
+		pBlock->pFree = asRealloc(pBlock->pFree, sizeof(struct vTextureBlockRange_t) * pBlock->freeCapacity);
+	}
+	memmove(&pBlock->pFree[at + 1], &pBlock->pFree[at], sizeof(struct vTextureBlockRange_t) * (pBlock->freeCount - at));
+	pBlock->pFree[at].offset = offset;
+	pBlock->pFree[at].size = size;
+	pBlock->freeCount++;
+}
+
+void vTextureBlock_RemoveRange(struct vTextureMemoryBlock_t* pBlock, uint32_t at)
+{
+	memmove(&pBlock->pFree[at], &pBlock->pFree[at + 1], sizeof(struct vTextureBlockRange_t) * (pBlock->freeCount - at - 1));
+	pBlock->freeCount--;
+}
+
+/*First fit, returns false if no free range can hold the size*/
+bool vTextureBlock_Alloc(struct vTextureMemoryBlock_t* pBlock, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* pOffset)
+{
+	if (pBlock->alloc.memHandle == VK_NULL_HANDLE || pBlock->freeBytes < size)
+		return false;
+	for (uint32_t i = 0; i < pBlock->freeCount; i++)
+	{
+		const struct vTextureBlockRange_t range = pBlock->pFree[i];
+		const VkDeviceSize offset = vAlignUp(range.offset, alignment);
+		if (offset + size > range.offset + range.size)
+			continue;
+		const VkDeviceSize lead = offset - range.offset;
+		const VkDeviceSize tail = range.offset + range.size - (offset + size);
+		if (lead)
+		{
+			pBlock->pFree[i].size = lead;
+			if (tail)
+				vTextureBlock_InsertRange(pBlock, i + 1, offset + size, tail);
+		}
+		else if (tail)
+		{
+			pBlock->pFree[i].offset = offset + size;
+			pBlock->pFree[i].size = tail;
+		}
+		else
+		{
+			vTextureBlock_RemoveRange(pBlock, i);
+		}
+		pBlock->refCount++;
+		vTextureBlock_SetFreeBytes(pBlock, pBlock->freeBytes - size);
+		*pOffset = offset;
+		return true;
+	}
+	return false;
+}
+
+int32_t vTextureManager_CreateBlock(struct vTextureManager_t* pMan, VkDeviceSize size, uint32_t type)
+{
+	uint32_t index = 0;
+	while (index < pMan->blockCount && pMan->pBlocks[index].alloc.memHandle != VK_NULL_HANDLE)
+		index++;
+	if (index == pMan->blockCount)
+	{
+		pMan->pBlocks = asRealloc(pMan->pBlocks, sizeof(struct vTextureMemoryBlock_t) * (pMan->blockCount + 1));
+		pMan->blockCount++;
+	}
+	struct vTextureMemoryBlock_t* pBlock = &pMan->pBlocks[index];
+	memset(pBlock, 0, sizeof(*pBlock));
+	asVkAlloc(&pBlock->alloc, size, type);
+	pBlock->memoryConsumer = vMemoryAllocator_AddConsumer(&vMainAllocator, AS_VK_TEXTURE_BLOCK_CONSUMER, 0);
+	vTextureBlock_SetFreeBytes(pBlock, size);
+	vTextureBlock_InsertRange(pBlock, 0, 0, size);
+	return (int32_t)index;
+}
+
+/*Return a range of a block to its free list, the memory goes back to the device once the whole block is unused*/
+void vTextureManager_ReleaseRange(struct vTextureManager_t* pMan, int32_t index, VkDeviceSize offset, VkDeviceSize size)
+{
+	struct vTextureMemoryBlock_t* pBlock = &pMan->pBlocks[index];
+	uint32_t at = 0;
+	while (at < pBlock->freeCount && pBlock->pFree[at].offset < offset)
+		at++;
+	vTextureBlock_InsertRange(pBlock, at, offset, size);
+	if (at + 1 < pBlock->freeCount && pBlock->pFree[at].offset + pBlock->pFree[at].size == pBlock->pFree[at + 1].offset)
+	{
+		pBlock->pFree[at].size += pBlock->pFree[at + 1].size;
+		vTextureBlock_RemoveRange(pBlock, at + 1);
+	}
+	if (at > 0 && pBlock->pFree[at - 1].offset + pBlock->pFree[at - 1].size == pBlock->pFree[at].offset)
+	{
+		pBlock->pFree[at - 1].size += pBlock->pFree[at].size;
+		vTextureBlock_RemoveRange(pBlock, at);
+	}
+	vTextureBlock_SetFreeBytes(pBlock, pBlock->freeBytes + size);
+	pBlock->refCount--;
+	if (!pBlock->refCount)
+	{
+		vTextureBlock_SetFreeBytes(pBlock, 0);
+		vMemoryAllocator_RemoveConsumer(&vMainAllocator, pBlock->memoryConsumer, 0);
+		asFree(pBlock->pFree);
+		pBlock->pFree = NULL;
+		pBlock->freeCount = 0;
+		pBlock->freeCapacity = 0;
+		asVkFree(&pBlock->alloc);
+	}
+}
+
 void _invalidateTexture(struct vTexture_t* pTex)
 {
 	pTex->alloc.memHandle = VK_NULL_HANDLE;
+	pTex->memoryBlock = -1;
+	pTex->memoryConsumer = UINT32_MAX;
 	pTex->image = VK_NULL_HANDLE;
 	pTex->view = VK_NULL_HANDLE;
 }
 
 void _destroyTexture(struct vTexture_t* pTex)
 {
-	if (pTex->alloc.memHandle != VK_NULL_HANDLE)
+	if (pTex->memoryConsumer != UINT32_MAX)
+		vMemoryAllocator_RemoveConsumer(&vMainAllocator, pTex->memoryConsumer, pTex->alloc.size);
+	if (pTex->memoryBlock >= 0)
+		vTextureManager_ReleaseRange(&vMainTextureManager, pTex->memoryBlock, pTex->alloc.offset, pTex->alloc.size);
+	else if (pTex->alloc.memHandle != VK_NULL_HANDLE)
 		asVkFree(&pTex->alloc);
 	if (pTex->image != VK_NULL_HANDLE)
 		vkDestroyImage(asVkDevice, pTex->image, AS_VK_MEMCB);
@@ -401,19 +769,14 @@ void _destroyTexture(struct vTexture_t* pTex)
 	_invalidateTexture(pTex);
 }
 
-struct vTextureManager_t
-{
-	asHandleManager_t handleManager;
-	struct vTexture_t* textures;
-};
-struct vTextureManager_t vMainTextureManager;
-
 void vTextureManager_Init(struct vTextureManager_t* pMan)
 {
 	asHandleManagerCreate(&pMan->handleManager, AS_MAX_TEXTURES);
 	pMan->textures = (struct vTexture_t*)asMalloc(sizeof(pMan->textures[0]) * AS_MAX_TEXTURES);
 	for (int i = 0; i < AS_MAX_TEXTURES; i++)
 		_invalidateTexture(&pMan->textures[i]);
+	pMan->pBlocks = NULL;
+	pMan->blockCount = 0;
 }
 
 void vTextureManager_Shutdown(struct vTextureManager_t* pMan)
@@ -424,6 +787,7 @@ void vTextureManager_Shutdown(struct vTextureManager_t* pMan)
 		_destroyTexture(&pMan->textures[i]);
 	}
 	asFree(pMan->textures);
+	asFree(pMan->pBlocks);
 }
 
 VkFormat asVkConvertToNativePixelFormat(asColorFormat format)
@@ -493,6 +857,10 @@ VkShaderStageFlagBits asVkConvertToNativeStage(asShaderStage stage)
 	case AS_SHADERSTAGE_TESS_CONTROL: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
 	case AS_SHADERSTAGE_TESS_EVALUATION: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
 	case AS_SHADERSTAGE_GEOMETRY: return VK_SHADER_STAGE_GEOMETRY_BIT;
+#ifdef VK_EXT_mesh_shader
+	case AS_SHADERSTAGE_TASK: return VK_SHADER_STAGE_TASK_BIT_EXT;
+	case AS_SHADERSTAGE_MESH: return VK_SHADER_STAGE_MESH_BIT_EXT;
+#endif
 	default: return VK_SHADER_STAGE_ALL;
 	};
 }
@@ -546,12 +914,93 @@ VkImageUsageFlags vDecodeTextureUsageFlags(uint32_t abstractFlags)
 		initial |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 	if ((abstractFlags & AS_TEXTUREUSAGE_TRANSFER_SRC) == AS_TEXTUREUSAGE_TRANSFER_SRC)
 		initial |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	if ((abstractFlags & AS_TEXTUREUSAGE_STORAGE) == AS_TEXTUREUSAGE_STORAGE)
+		initial |= VK_IMAGE_USAGE_STORAGE_BIT;
 	return initial;
 }
 
+/*Device textures with initial contents are uploaded through the transfer queue*/
+bool vTextureNeedsUpload(const asTextureDesc_t* pDesc)
+{
+	return pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE &&
+		(pDesc->pInitialContentsBuffer || pDesc->pfnWriteInitialContents) &&
+		!((pDesc->usageFlags & AS_TEXTUREUSAGE_RENDERTARGET) == AS_TEXTUREUSAGE_RENDERTARGET);
+}
+
+void vTextureFillImageInfo(const asTextureDesc_t* pDesc, VkImageCreateInfo* pInfo)
+{
+	*pInfo = (VkImageCreateInfo) { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	pInfo->imageType = vConvertTextureTypeToImageType(pDesc->type);
+	pInfo->format = asVkConvertToNativePixelFormat(pDesc->format);
+	pInfo->extent.height = pDesc->height;
+	pInfo->extent.width = pDesc->width;
+	if (pDesc->type == AS_TEXTURETYPE_3D){
+		pInfo->extent.depth = pDesc->depth;
+		pInfo->arrayLayers = 1;
+	}
+	else{
+		pInfo->extent.depth = 1;
+		pInfo->arrayLayers = pDesc->depth;
+	}
+	pInfo->mipLevels = pDesc->mips;
+	pInfo->samples = VK_SAMPLE_COUNT_1_BIT;
+	if (pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE)
+		pInfo->tiling = VK_IMAGE_TILING_OPTIMAL;
+	else
+		pInfo->tiling = VK_IMAGE_TILING_LINEAR;
+	pInfo->flags = 0;
+	pInfo->usage = vDecodeTextureUsageFlags(pDesc->usageFlags);
+	if ((pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE) && (pDesc->pInitialContentsBuffer || pDesc->pfnWriteInitialContents))
+		pInfo->usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	pInfo->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	pInfo->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+}
+
+void vTextureCreateView(struct vTexture_t* pTex, const asTextureDesc_t* pDesc)
+{
+	VkImageViewCreateInfo createInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	createInfo.image = pTex->image;
+	createInfo.viewType = vConvertTextureTypeToViewType(pDesc->type);
+	createInfo.format = asVkConvertToNativePixelFormat(pDesc->format);
+	createInfo.subresourceRange.aspectMask =
+		pDesc->format == AS_COLORFORMAT_DEPTH ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+	createInfo.subresourceRange.baseArrayLayer = 0;
+	createInfo.subresourceRange.baseMipLevel = 0;
+	createInfo.subresourceRange.layerCount = pDesc->type != AS_TEXTURETYPE_3D ? pDesc->depth : 1;
+	createInfo.subresourceRange.levelCount = pDesc->mips;
+	AS_VK_CHECK(vkCreateImageView(asVkDevice, &createInfo, AS_VK_MEMCB, &pTex->view),
+		"vkCreateImageView() Failed to create an image view");
+}
+
+void vTextureSetDebugName(struct vTexture_t* pTex, const asTextureDesc_t* pDesc)
+{
+#if AS_VK_VALIDATION
+	if (pDesc->pDebugLabel && vMarkersExtensionFound)
+	{
+		VkDebugMarkerObjectNameInfoEXT imageInfo = (VkDebugMarkerObjectNameInfoEXT){ VK_STRUCTURE_TYPE_DEBUG_MARKER_OBJECT_NAME_INFO_EXT };
+		VkDebugMarkerObjectNameInfoEXT viewInfo = imageInfo;
+		imageInfo.object = (uint64_t)pTex->image;
+		imageInfo.objectType = VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT;
+		imageInfo.pObjectName = pDesc->pDebugLabel;
+		vkDebugMarkerSetObjectName(asVkDevice, &imageInfo);
+		viewInfo.object = (uint64_t)pTex->view;
+		viewInfo.objectType = VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_VIEW_EXT;
+		viewInfo.pObjectName = pDesc->pDebugLabel;
+		vkDebugMarkerSetObjectName(asVkDevice, &viewInfo);
+	}
+#endif
+}
+
 ASEXPORT asTextureHandle_t asCreateTexture(asTextureDesc_t *pDesc)
 {
 	asTextureHandle_t hndl = (asTextureHandle_t) { 0 };
+	if (vTextureNeedsUpload(pDesc))
+	{
+		/*The contents could not be written, there is no texture to hand out*/
+		if (asCreateTextures(pDesc, 1, &hndl) != AS_SUCCESS)
+			return asHandle_Invalidate();
+		return hndl;
+	}
 	vkDeviceWaitIdle(asVkDevice);
 	hndl = asCreateHandle(&vMainTextureManager.handleManager);
 	struct vTexture_t *pTex = &vMainTextureManager.textures[hndl._index];
@@ -559,32 +1008,8 @@ ASEXPORT asTextureHandle_t asCreateTexture(asTextureDesc_t *pDesc)
 	pTex->cpuAccess = pDesc->cpuAccess;
 	/*Image*/
 	{
-		VkImageCreateInfo createInfo = (VkImageCreateInfo) { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-		createInfo.imageType = vConvertTextureTypeToImageType(pDesc->type);
-		createInfo.format = asVkConvertToNativePixelFormat(pDesc->format);
-		createInfo.extent.height = pDesc->height;
-		createInfo.extent.width = pDesc->width;
-		if (pDesc->type == AS_TEXTURETYPE_3D){
-			createInfo.extent.depth = pDesc->depth;
-			createInfo.arrayLayers = 1;
-		}
-		else{
-			createInfo.extent.depth = 1;
-			createInfo.arrayLayers = pDesc->depth;
-		}
-		createInfo.mipLevels = pDesc->mips;
-		createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		if (pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE)
-			createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		else
-			createInfo.tiling = VK_IMAGE_TILING_LINEAR;
-		createInfo.flags = 0;
-		createInfo.usage = vDecodeTextureUsageFlags(pDesc->usageFlags);
-		if ((pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE) && pDesc->pInitialContentsBuffer)
-			createInfo.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-		createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
+		VkImageCreateInfo createInfo;
+		vTextureFillImageInfo(pDesc, &createInfo);
 		if (pDesc->cpuAccess != AS_GPURESOURCEACCESS_STREAM){
 			AS_VK_CHECK(vkCreateImage(asVkDevice, &createInfo, AS_VK_MEMCB, &pTex->image), 
 				"vkCreateImage() Failed to create an image");
@@ -603,148 +1028,335 @@ ASEXPORT asTextureHandle_t asCreateTexture(asTextureDesc_t *pDesc)
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
 			vkBindImageMemory(asVkDevice, pTex->image, pTex->alloc.memHandle, pTex->alloc.offset);
 		}
+		pTex->memoryConsumer = vMemoryAllocator_AddConsumer(&vMainAllocator, pDesc->pDebugLabel, pTex->alloc.size);
 	}
 	/*View*/
+	vTextureCreateView(pTex, pDesc);
+	/*Uploading is currently unsupported for dynamic textures... 
+	you probably shouldn't be doing it this way either.
+	upload to a staging buffer first then copy to a texture
+	this should make it a lot faster to access texel*/
+	/*Debug Markers*/
+	vTextureSetDebugName(pTex, pDesc);
+	return hndl;
+}
+
+/*Batched Texture Uploads*/
+
+#define AS_VK_TEXTURE_BATCH_STAGING_SIZE (128 * 1024 * 1024)
+#define AS_VK_TEXTURE_STAGING_ALIGNMENT 48 /*Multiple of every texel block size (16) and of 12 byte texels*/
+
+struct vTextureUpload_t
+{
+	size_t index; /*Into the output handles*/
+	asTextureDesc_t* pDesc;
+	struct vTexture_t* pTex;
+	VkMemoryRequirements memReq;
+	uint32_t memoryType;
+	VkDeviceSize stagingOffset;
+	VkDeviceSize stagingSize;
+	asTextureContentRegion_t* pRegions; /*Relative to stagingOffset*/
+};
+
+/*Copy every upload out of the staging buffer with a single transfer submission and wait for it*/
+void vTextureUploadFlush(VkBuffer stagingBuffer, struct vTextureUpload_t* pUploads, size_t count, VkFence fence, VkSemaphore ownershipSemaphore)
+{
+	const bool handover = asVkQueueFamilyIndices.transferIdx != asVkQueueFamilyIndices.graphicsIdx;
+	VkImageMemoryBarrier* pBarriers = asMalloc(sizeof(VkImageMemoryBarrier) * count);
+	VkBufferImageCopy* pCopies = NULL;
+	size_t copyCapacity = 0;
+
+	VkCommandBufferAllocateInfo cmdAlloc = (VkCommandBufferAllocateInfo) { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	cmdAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	cmdAlloc.commandPool = vTransferCommandPool;
+	cmdAlloc.commandBufferCount = 1;
+	VkCommandBuffer transferCmd;
+	vkAllocateCommandBuffers(asVkDevice, &cmdAlloc, &transferCmd);
+	VkCommandBufferBeginInfo beginInfo = (VkCommandBufferBeginInfo){ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(transferCmd, &beginInfo);
+
+	/*Transition every image for copy at once*/
+	for (size_t i = 0; i < count; i++)
 	{
-		VkImageViewCreateInfo createInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-		createInfo.image = pTex->image;
-		createInfo.viewType = vConvertTextureTypeToViewType(pDesc->type);
-		createInfo.format = asVkConvertToNativePixelFormat(pDesc->format);
-		createInfo.subresourceRange.aspectMask =
-			pDesc->format == AS_COLORFORMAT_DEPTH ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-		createInfo.subresourceRange.baseArrayLayer = 0;
-		createInfo.subresourceRange.baseMipLevel = 0;
-		createInfo.subresourceRange.layerCount = pDesc->type != AS_TEXTURETYPE_3D ? pDesc->depth : 1;
-		createInfo.subresourceRange.levelCount = pDesc->mips;
-		AS_VK_CHECK(vkCreateImageView(asVkDevice, &createInfo, AS_VK_MEMCB, &pTex->view),
-			"vkCreateImageView() Failed to create an image view");
+		const asTextureDesc_t* pDesc = pUploads[i].pDesc;
+		pBarriers[i] = (VkImageMemoryBarrier){ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+		pBarriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		pBarriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		pBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		pBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		pBarriers[i].image = pUploads[i].pTex->image;
+		pBarriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		pBarriers[i].subresourceRange.baseMipLevel = 0;
+		pBarriers[i].subresourceRange.levelCount = pDesc->mips;
+		pBarriers[i].subresourceRange.baseArrayLayer = 0;
+		pBarriers[i].subresourceRange.layerCount = pDesc->type == AS_TEXTURETYPE_3D ? 1 : pDesc->depth;
+		pBarriers[i].srcAccessMask = 0;
+		pBarriers[i].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 	}
-	/*Upload Data*/
+	vkCmdPipelineBarrier(transferCmd,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, NULL, 0, NULL, (uint32_t)count, pBarriers);
+
+	/*Copy the regions of each image*/
+	for (size_t i = 0; i < count; i++)
 	{
-		if (pDesc->pInitialContentsBuffer && !((pDesc->usageFlags & AS_TEXTUREUSAGE_RENDERTARGET) == AS_TEXTUREUSAGE_RENDERTARGET))
+		const asTextureContentRegion_t* pRegions = pUploads[i].pRegions;
+		const size_t regionCount = pUploads[i].pDesc->initialContentsRegionCount;
+		if (regionCount > copyCapacity)
 		{
-			if (pDesc->cpuAccess == AS_GPURESOURCEACCESS_DEVICE) /*Requires Staging*/
+			copyCapacity = regionCount;
+			pCopies = asRealloc(pCopies, sizeof(VkBufferImageCopy) * copyCapacity);
+		}
+		for (size_t r = 0; r < regionCount; r++)
+		{
+			VkBufferImageCopy* pCpy = &pCopies[r];
+			pCpy->bufferImageHeight = 0;
+			pCpy->bufferRowLength = 0;
+			pCpy->bufferOffset = pUploads[i].stagingOffset + pRegions[r].bufferStart;
+			pCpy->imageExtent.width = pRegions[r].extent[0];
+			pCpy->imageExtent.height = pRegions[r].extent[1];
+			pCpy->imageExtent.depth = pRegions[r].extent[2];
+			pCpy->imageOffset.x = pRegions[r].offset[0];
+			pCpy->imageOffset.y = pRegions[r].offset[1];
+			pCpy->imageOffset.z = pRegions[r].offset[2];
+			pCpy->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; /*Uploading depth is unsupported*/
+			pCpy->imageSubresource.layerCount = pRegions[r].layerCount;
+			pCpy->imageSubresource.baseArrayLayer = pRegions[r].layer;
+			pCpy->imageSubresource.mipLevel = pRegions[r].mipLevel;
+		}
+		if (regionCount)
+			vkCmdCopyBufferToImage(transferCmd, stagingBuffer, pUploads[i].pTex->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regionCount, pCopies);
+	}
+
+	/*Transition to shader input optimal layout (released to the graphics family when the transfer queue is its own)*/
+	for (size_t i = 0; i < count; i++)
+	{
+		pBarriers[i].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		pBarriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		pBarriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		pBarriers[i].dstAccessMask = handover ? 0 : VK_ACCESS_SHADER_READ_BIT;
+		pBarriers[i].srcQueueFamilyIndex = handover ? asVkQueueFamilyIndices.transferIdx : VK_QUEUE_FAMILY_IGNORED;
+		pBarriers[i].dstQueueFamilyIndex = handover ? asVkQueueFamilyIndices.graphicsIdx : VK_QUEUE_FAMILY_IGNORED;
+	}
+	vkCmdPipelineBarrier(transferCmd,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, handover ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0, 0, NULL, 0, NULL, (uint32_t)count, pBarriers);
+	vkEndCommandBuffer(transferCmd);
+
+	/*Execute*/
+	VkSubmitInfo submitInfo = (VkSubmitInfo){ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &transferCmd;
+	VkCommandBuffer acquireCmd = VK_NULL_HANDLE;
+	if (!handover)
+	{
+		vkQueueSubmit(asVkQueue_Transfer, 1, &submitInfo, fence);
+	}
+	else
+	{
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &ownershipSemaphore;
+		vkQueueSubmit(asVkQueue_Transfer, 1, &submitInfo, VK_NULL_HANDLE);
+
+		/*Matching acquire on the graphics queue*/
+		cmdAlloc.commandPool = asVkGeneralCommandPool;
+		vkAllocateCommandBuffers(asVkDevice, &cmdAlloc, &acquireCmd);
+		vkBeginCommandBuffer(acquireCmd, &beginInfo);
+		for (size_t i = 0; i < count; i++)
+		{
+			pBarriers[i].srcAccessMask = 0;
+			pBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		}
+		vkCmdPipelineBarrier(acquireCmd,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0, 0, NULL, 0, NULL, (uint32_t)count, pBarriers);
+		vkEndCommandBuffer(acquireCmd);
+		const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		VkSubmitInfo acquireInfo = (VkSubmitInfo){ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		acquireInfo.waitSemaphoreCount = 1;
+		acquireInfo.pWaitSemaphores = &ownershipSemaphore;
+		acquireInfo.pWaitDstStageMask = &waitStage;
+		acquireInfo.commandBufferCount = 1;
+		acquireInfo.pCommandBuffers = &acquireCmd;
+		vkQueueSubmit(asVkQueue_GFX, 1, &acquireInfo, fence);
+	}
+	vkWaitForFences(asVkDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+	vkResetFences(asVkDevice, 1, &fence);
+	vkFreeCommandBuffers(asVkDevice, vTransferCommandPool, 1, &transferCmd);
+	if (acquireCmd != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(asVkDevice, asVkGeneralCommandPool, 1, &acquireCmd);
+	asFree(pCopies);
+	asFree(pBarriers);
+}
+
+ASEXPORT asResults asCreateTextures(asTextureDesc_t* pDescs, size_t count, asTextureHandle_t* pOutHandles)
+{
+	if (!count)
+		return AS_SUCCESS;
+	struct vTextureUpload_t* pUploads = asMalloc(sizeof(struct vTextureUpload_t) * count);
+	if (!pUploads)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	/*No device wait, each flush waits on its own upload fence*/
+
+	/*Create every image first so memory can be laid out for the whole batch*/
+	size_t uploadCount = 0;
+	size_t regionCount = 0;
+	VkDeviceSize pooledSizes[VK_MAX_MEMORY_TYPES] = { 0 };
+	for (size_t i = 0; i < count; i++)
+	{
+		asTextureDesc_t* pDesc = &pDescs[i];
+		if (!vTextureNeedsUpload(pDesc))
+		{
+			pOutHandles[i] = asCreateTexture(pDesc);
+			continue;
+		}
+		pOutHandles[i] = asCreateHandle(&vMainTextureManager.handleManager);
+		struct vTexture_t* pTex = &vMainTextureManager.textures[pOutHandles[i]._index];
+		pTex->textureType = pDesc->type;
+		pTex->cpuAccess = pDesc->cpuAccess;
+		VkImageCreateInfo createInfo;
+		vTextureFillImageInfo(pDesc, &createInfo);
+		AS_VK_CHECK(vkCreateImage(asVkDevice, &createInfo, AS_VK_MEMCB, &pTex->image),
+			"vkCreateImage() Failed to create an image");
+
+		struct vTextureUpload_t* pUpload = &pUploads[uploadCount++];
+		pUpload->index = i;
+		pUpload->pDesc = pDesc;
+		pUpload->pTex = pTex;
+		vkGetImageMemoryRequirements(asVkDevice, pTex->image, &pUpload->memReq);
+		pUpload->memoryType = (uint32_t)asVkFindMemoryType(pUpload->memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (pUpload->memReq.size < AS_VK_TEXTURE_BLOCK_SIZE)
+			pooledSizes[pUpload->memoryType] += pUpload->memReq.size + pUpload->memReq.alignment;
+		pUpload->stagingSize = vAlignUp(asTextureDesc_GetUploadSize(pDesc), AS_VK_TEXTURE_STAGING_ALIGNMENT);
+		regionCount += pDesc->initialContentsRegionCount;
+	}
+
+	/*Pack images into the free space of existing blocks, then into new blocks (each only as large as what is left of the batch),
+	large ones get their own memory*/
+	for (size_t i = 0; i < uploadCount; i++)
+	{
+		struct vTextureUpload_t* pUpload = &pUploads[i];
+		struct vTexture_t* pTex = pUpload->pTex;
+		const uint32_t type = pUpload->memoryType;
+		if (pUpload->memReq.size >= AS_VK_TEXTURE_BLOCK_SIZE)
+		{
+			asVkAlloc(&pTex->alloc, pUpload->memReq.size, type);
+		}
+		else
+		{
+			VkDeviceSize offset = 0;
+			int32_t block = -1;
+			for (uint32_t b = 0; b < vMainTextureManager.blockCount && block < 0; b++)
 			{
-				/*Upload initial contents to GPU*/
-				VkBuffer stagingBuffer;
-				asVkAllocation_t stagingAlloc;
-				{
-					VkBufferCreateInfo bufferInfo = (VkBufferCreateInfo) { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-					bufferInfo.size = pDesc->initialContentsBufferSize;
-					bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-					bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-					AS_VK_CHECK(vkCreateBuffer(asVkDevice, &bufferInfo, AS_VK_MEMCB, &stagingBuffer),
-						"vkCreateBuffer() Failed to create a staging buffer");
-					VkMemoryRequirements memReq;
-					vkGetBufferMemoryRequirements(asVkDevice, stagingBuffer, &memReq);
-					asVkAlloc(&stagingAlloc, memReq.size, asVkFindMemoryType(memReq.memoryTypeBits,
-						VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-					vkBindBufferMemory(asVkDevice, stagingBuffer, stagingAlloc.memHandle, stagingAlloc.offset);
-					void* pData;
-					vkMapMemory(asVkDevice, stagingAlloc.memHandle, stagingAlloc.offset, pDesc->initialContentsBufferSize, 0, &pData);
-					memcpy(pData, pDesc->pInitialContentsBuffer, pDesc->initialContentsBufferSize);
-					vkUnmapMemory(asVkDevice, stagingAlloc.memHandle);
-				}
-				/*Copy staging contents into image*/
-				{
-					VkCommandBufferAllocateInfo cmdAlloc = (VkCommandBufferAllocateInfo) { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
-					cmdAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-					cmdAlloc.commandPool = asVkGeneralCommandPool;
-					cmdAlloc.commandBufferCount = 1;
-					VkCommandBuffer tmpCmd;
-					vkAllocateCommandBuffers(asVkDevice, &cmdAlloc, &tmpCmd);
-					VkCommandBufferBeginInfo beginInfo = (VkCommandBufferBeginInfo){ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
-					beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-					vkBeginCommandBuffer(tmpCmd, &beginInfo);
-					/*Transition image layout for copy*/
-					VkImageMemoryBarrier toTransferDst = (VkImageMemoryBarrier){ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-					toTransferDst.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-					toTransferDst.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-					toTransferDst.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					toTransferDst.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					toTransferDst.image = pTex->image;
-					toTransferDst.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					toTransferDst.subresourceRange.baseMipLevel = 0;
-					toTransferDst.subresourceRange.levelCount = pDesc->mips;
-					toTransferDst.subresourceRange.baseArrayLayer = 0;
-					toTransferDst.subresourceRange.layerCount = pDesc->type == AS_TEXTURETYPE_3D ? 1 : pDesc->depth;
-					toTransferDst.srcAccessMask = 0;
-					toTransferDst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					vkCmdPipelineBarrier(tmpCmd,
-						VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-						0, 0, NULL, 0, NULL, 1, &toTransferDst);
-					/*Copy each region*/
-					const asTextureContentRegion_t* pRegions = pDesc->pInitialContentsRegions ?
-						pDesc->pInitialContentsRegions : pDesc->arrInitialContentsRegions;
-					for (uint32_t i = 0; i < pDesc->initialContentsRegionCount; i++)
-					{
-						VkBufferImageCopy cpy;
-						cpy.bufferImageHeight = 0;
-						cpy.bufferRowLength = 0;
-						cpy.bufferOffset = pRegions[i].bufferStart;
-						cpy.imageExtent.width = pRegions[i].extent[0];
-						cpy.imageExtent.height = pRegions[i].extent[1];
-						cpy.imageExtent.depth = pRegions[i].extent[2];
-						cpy.imageOffset.x = pRegions[i].offset[0];
-						cpy.imageOffset.y = pRegions[i].offset[1];
-						cpy.imageOffset.z = pRegions[i].offset[2];
-						cpy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT; /*Uploading depth is unsupported*/
-						cpy.imageSubresource.layerCount = pRegions[i].layerCount;
-						cpy.imageSubresource.baseArrayLayer = pRegions[i].layer;
-						cpy.imageSubresource.mipLevel = pRegions[i].mipLevel;
-						vkCmdCopyBufferToImage(tmpCmd, stagingBuffer, pTex->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &cpy);
-					}
-					/*Transition to shader input optimal layout*/
-					VkImageMemoryBarrier toFinal = toTransferDst;
-					toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-					toFinal.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-					toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					toFinal.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					vkCmdPipelineBarrier(tmpCmd,
-						VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-						0, 0, NULL, 0, NULL, 1, &toFinal);
-					/*Execute*/
-					vkEndCommandBuffer(tmpCmd);
-					VkSubmitInfo submitInfo = (VkSubmitInfo){ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-					submitInfo.commandBufferCount = 1;
-					submitInfo.pCommandBuffers = &tmpCmd;
-					vkQueueSubmit(asVkQueue_Transfer, 1, &submitInfo, VK_NULL_HANDLE); 
-					vkQueueWaitIdle(asVkQueue_Transfer); /*TODO: Resource Synchonization*/
-					vkFreeCommandBuffers(asVkDevice, asVkGeneralCommandPool, 1, &tmpCmd);
-				}
-				/*Free staging data*/
-				vkDestroyBuffer(asVkDevice, stagingBuffer, AS_VK_MEMCB);
-				asVkFree(&stagingAlloc);
+				struct vTextureMemoryBlock_t* pBlock = &vMainTextureManager.pBlocks[b];
+				if (pBlock->alloc.memType == type &&
+					vTextureBlock_Alloc(pBlock, pUpload->memReq.size, pUpload->memReq.alignment, &offset))
+					block = (int32_t)b;
 			}
-			else 
+			if (block < 0)
 			{
-				/*Uploading is currently unsupported for dynamic textures... 
-				you probably shouldn't be doing it this way either.
-				upload to a staging buffer first then copy to a texture
-				this should make it a lot faster to access texel*/
+				const VkDeviceSize blockSize = pooledSizes[type] < AS_VK_TEXTURE_BLOCK_SIZE ? pooledSizes[type] : AS_VK_TEXTURE_BLOCK_SIZE;
+				block = vTextureManager_CreateBlock(&vMainTextureManager, blockSize, type);
+				vTextureBlock_Alloc(&vMainTextureManager.pBlocks[block], pUpload->memReq.size, pUpload->memReq.alignment, &offset);
 			}
+			pooledSizes[type] -= pUpload->memReq.size + pUpload->memReq.alignment;
+			pTex->memoryBlock = block;
+			pTex->alloc = vMainTextureManager.pBlocks[block].alloc;
+			pTex->alloc.offset = offset;
+			pTex->alloc.size = pUpload->memReq.size;
 		}
+		vkBindImageMemory(asVkDevice, pTex->image, pTex->alloc.memHandle, pTex->alloc.offset);
+		pTex->memoryConsumer = vMemoryAllocator_AddConsumer(&vMainAllocator, pUpload->pDesc->pDebugLabel, pTex->alloc.size);
+		vTextureCreateView(pTex, pUpload->pDesc);
+		vTextureSetDebugName(pTex, pUpload->pDesc);
 	}
-#if AS_VK_VALIDATION
-	/*Debug Markers*/
+
+	/*One staging buffer for the batch (capped, so very large batches are split into a few submissions)*/
+	VkDeviceSize stagingSize = 0;
+	VkDeviceSize largestUpload = 0;
+	for (size_t i = 0; i < uploadCount; i++)
 	{
-		if (pDesc->pDebugLabel && vMarkersExtensionFound)
+		stagingSize += pUploads[i].stagingSize;
+		if (pUploads[i].stagingSize > largestUpload)
+			largestUpload = pUploads[i].stagingSize;
+	}
+	if (stagingSize > AS_VK_TEXTURE_BATCH_STAGING_SIZE)
+		stagingSize = largestUpload > AS_VK_TEXTURE_BATCH_STAGING_SIZE ? largestUpload : AS_VK_TEXTURE_BATCH_STAGING_SIZE;
+	if (!stagingSize)
+		stagingSize = AS_VK_TEXTURE_STAGING_ALIGNMENT;
+	VkBuffer stagingBuffer;
+	asVkAllocation_t stagingAlloc;
+	{
+		VkBufferCreateInfo bufferInfo = (VkBufferCreateInfo) { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferInfo.size = stagingSize;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		AS_VK_CHECK(vkCreateBuffer(asVkDevice, &bufferInfo, AS_VK_MEMCB, &stagingBuffer),
+			"vkCreateBuffer() Failed to create a staging buffer");
+		VkMemoryRequirements memReq;
+		vkGetBufferMemoryRequirements(asVkDevice, stagingBuffer, &memReq);
+		asVkAlloc(&stagingAlloc, memReq.size, asVkFindMemoryType(memReq.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+		vkBindBufferMemory(asVkDevice, stagingBuffer, stagingAlloc.memHandle, stagingAlloc.offset);
+	}
+	unsigned char* pStaging;
+	vkMapMemory(asVkDevice, stagingAlloc.memHandle, stagingAlloc.offset, stagingSize, 0, (void**)&pStaging);
+	VkFence fence;
+	VkSemaphore ownershipSemaphore;
+	VkFenceCreateInfo fenceInfo = (VkFenceCreateInfo){ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	AS_VK_CHECK(vkCreateFence(asVkDevice, &fenceInfo, AS_VK_MEMCB, &fence),
+		"vkCreateFence() Failed to create upload fence");
+	VkSemaphoreCreateInfo semaphoreInfo = (VkSemaphoreCreateInfo){ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	AS_VK_CHECK(vkCreateSemaphore(asVkDevice, &semaphoreInfo, AS_VK_MEMCB, &ownershipSemaphore),
+		"vkCreateSemaphore() Failed to create upload semaphore");
+
+	/*Contents go straight into the mapping (no intermediate copies), flushed whenever it fills up*/
+	asResults result = AS_SUCCESS;
+	asTextureContentRegion_t* pRegions = asMalloc(sizeof(asTextureContentRegion_t) * (regionCount + 1));
+	asTextureContentRegion_t* pNextRegions = pRegions;
+	size_t first = 0;
+	size_t written = 0; /*Uploads that failed to write are dropped, so the ones to flush are packed down*/
+	VkDeviceSize offset = 0;
+	for (size_t i = 0; i <= uploadCount; i++)
+	{
+		if (i == uploadCount || offset + pUploads[i].stagingSize > stagingSize)
 		{
-			VkDebugMarkerObjectNameInfoEXT imageInfo = (VkDebugMarkerObjectNameInfoEXT){ VK_STRUCTURE_TYPE_DEBUG_MARKER_OBJECT_NAME_INFO_EXT };
-			VkDebugMarkerObjectNameInfoEXT viewInfo = imageInfo;
-			imageInfo.object = (uint64_t)pTex->image;
-			imageInfo.objectType = VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT;
-			imageInfo.pObjectName = pDesc->pDebugLabel;
-			vkDebugMarkerSetObjectName(asVkDevice, &imageInfo);
-			viewInfo.object = (uint64_t)pTex->view;
-			viewInfo.objectType = VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_VIEW_EXT;
-			viewInfo.pObjectName = pDesc->pDebugLabel;
-			vkDebugMarkerSetObjectName(asVkDevice, &viewInfo);
+			if (written > first)
+				vTextureUploadFlush(stagingBuffer, &pUploads[first], written - first, fence, ownershipSemaphore);
+			first = written;
+			offset = 0;
+			if (i == uploadCount)
+				break;
 		}
+		struct vTextureUpload_t upload = pUploads[i];
+		upload.stagingOffset = offset;
+		upload.pRegions = pNextRegions;
+		const asResults writeResult = asTextureDesc_WriteUpload(upload.pDesc, pStaging + offset, upload.pRegions);
+		if (writeResult != AS_SUCCESS)
+		{
+			/*The image never reached the GPU, so it can go right away*/
+			asDebugError("Failed to write the initial contents of texture: %s", upload.pDesc->pDebugLabel ? upload.pDesc->pDebugLabel : "(unnamed)");
+			_destroyTexture(upload.pTex);
+			asDestroyHandle(&vMainTextureManager.handleManager, pOutHandles[upload.index]);
+			pOutHandles[upload.index] = asHandle_Invalidate();
+			result = writeResult;
+			continue;
+		}
+		pUploads[written++] = upload;
+		pNextRegions += upload.pDesc->initialContentsRegionCount;
+		offset += upload.stagingSize;
 	}
-#endif
-	
-	return hndl;
+
+	/*Free staging data*/
+	vkUnmapMemory(asVkDevice, stagingAlloc.memHandle);
+	vkDestroySemaphore(asVkDevice, ownershipSemaphore, AS_VK_MEMCB);
+	vkDestroyFence(asVkDevice, fence, AS_VK_MEMCB);
+	vkDestroyBuffer(asVkDevice, stagingBuffer, AS_VK_MEMCB);
+	asVkFree(&stagingAlloc);
+	asFree(pRegions);
+	asFree(pUploads);
+	return result;
 }
 
 ASEXPORT void asReleaseTexture(asTextureHandle_t hndl)
@@ -775,17 +1387,21 @@ struct vBuffer_t
 {
 	asGpuResourceUploadType cpuAccess;
 	asVkAllocation_t alloc;
+	uint32_t memoryConsumer; /*Debug label the memory is counted under (UINT32_MAX when none)*/
 	VkBuffer buffer;
 };
 
 void _invalidateBuffer(struct vBuffer_t* pBuf)
 {
 	pBuf->alloc.memHandle = VK_NULL_HANDLE;
+	pBuf->memoryConsumer = UINT32_MAX;
 	pBuf->buffer = VK_NULL_HANDLE;
 }
 
 void _destroyBuffer(struct vBuffer_t* pBuf)
 {
+	if (pBuf->memoryConsumer != UINT32_MAX)
+		vMemoryAllocator_RemoveConsumer(&vMainAllocator, pBuf->memoryConsumer, pBuf->alloc.size);
 	if (pBuf->alloc.memHandle != VK_NULL_HANDLE)
 		asVkFree(&pBuf->alloc);
 	if (pBuf->buffer != VK_NULL_HANDLE)
@@ -872,6 +1488,7 @@ ASEXPORT asBufferHandle_t asCreateBuffer(asBufferDesc_t *pDesc)
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
 			vkBindBufferMemory(asVkDevice, pBuff->buffer, pBuff->alloc.memHandle, pBuff->alloc.offset);
 		}
+		pBuff->memoryConsumer = vMemoryAllocator_AddConsumer(&vMainAllocator, pDesc->pDebugLabel, pBuff->alloc.size);
 	}
 	/*Upload Data*/
 	{
@@ -940,8 +1557,8 @@ ASEXPORT asBufferHandle_t asCreateBuffer(asBufferDesc_t *pDesc)
 					VkSubmitInfo submitInfo = (VkSubmitInfo) { VK_STRUCTURE_TYPE_SUBMIT_INFO };
 					submitInfo.commandBufferCount = 1;
 					submitInfo.pCommandBuffers = &tmpCmd;
-					vkQueueSubmit(asVkQueue_Transfer, 1, &submitInfo, VK_NULL_HANDLE);
-					vkQueueWaitIdle(asVkQueue_Transfer); /*Todo: Proper Synchonization*/
+					vkQueueSubmit(asVkQueue_GFX, 1, &submitInfo, VK_NULL_HANDLE); /*Recorded on the general (graphics) pool*/
+					vkQueueWaitIdle(asVkQueue_GFX); /*Todo: Proper Synchonization*/
 					vkFreeCommandBuffers(asVkDevice, asVkGeneralCommandPool, 1, &tmpCmd);
 				}
 				/*Free staging data*/
@@ -981,6 +1598,111 @@ ASEXPORT void asReleaseBuffer(asBufferHandle_t hndl)
 	asDestroyHandle(&vMainBufferManager.handleManager, hndl);
 }
 
+ASEXPORT asResults asUploadBufferRegions(const asBufferUploadRegion_t* pRegions, size_t count)
+{
+	if (!count) { return AS_SUCCESS; }
+	if (!pRegions) { return AS_FAILURE_INVALID_PARAM; }
+	VkDeviceSize stagingSize = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!asHandleValid(pRegions[i].buffer)) { return AS_FAILURE_INVALID_PARAM; }
+		const struct vBuffer_t* pBuff = &vMainBufferManager.buffers[pRegions[i].buffer._index];
+		if (pRegions[i].dstOffset + pRegions[i].size > pBuff->alloc.size) { return AS_FAILURE_OUT_OF_BOUNDS; }
+		if (pBuff->cpuAccess == AS_GPURESOURCEACCESS_DEVICE) { stagingSize += pRegions[i].size; }
+	}
+
+	/*Simple map and memcpy*/
+	for (size_t i = 0; i < count; i++)
+	{
+		struct vBuffer_t* pBuff = &vMainBufferManager.buffers[pRegions[i].buffer._index];
+		if (pBuff->cpuAccess == AS_GPURESOURCEACCESS_DEVICE || !pRegions[i].size) { continue; }
+		unsigned char* pData;
+		vkMapMemory(asVkDevice, pBuff->alloc.memHandle, pBuff->alloc.offset, pBuff->alloc.size, 0, (void**)&pData);
+		memcpy(pData + pRegions[i].dstOffset, pRegions[i].pData, pRegions[i].size);
+		vkUnmapMemory(asVkDevice, pBuff->alloc.memHandle);
+		asVkFlushMemory(pBuff->alloc);
+	}
+	if (!stagingSize) { return AS_SUCCESS; }
+
+	/*Every device region through one staging buffer*/
+	VkBuffer stagingBuffer;
+	asVkAllocation_t stagingAlloc;
+	{
+		VkBufferCreateInfo bufferInfo = (VkBufferCreateInfo) { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferInfo.size = stagingSize;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		AS_VK_CHECK(vkCreateBuffer(asVkDevice, &bufferInfo, AS_VK_MEMCB, &stagingBuffer),
+			"vkCreateBuffer() Failed to create a staging buffer");
+		VkMemoryRequirements memReq;
+		vkGetBufferMemoryRequirements(asVkDevice, stagingBuffer, &memReq);
+		asVkAlloc(&stagingAlloc, memReq.size, asVkFindMemoryType(memReq.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+		vkBindBufferMemory(asVkDevice, stagingBuffer, stagingAlloc.memHandle, stagingAlloc.offset);
+	}
+	VkBufferCopy* pCopies = asMalloc(count * sizeof(VkBufferCopy));
+	ASASSERT(pCopies);
+	{
+		unsigned char* pStaging;
+		vkMapMemory(asVkDevice, stagingAlloc.memHandle, stagingAlloc.offset, stagingSize, 0, (void**)&pStaging);
+		VkDeviceSize offset = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			pCopies[i] = (VkBufferCopy){ 0 };
+			if (vMainBufferManager.buffers[pRegions[i].buffer._index].cpuAccess != AS_GPURESOURCEACCESS_DEVICE) { continue; }
+			memcpy(pStaging + offset, pRegions[i].pData, pRegions[i].size);
+			pCopies[i].srcOffset = offset;
+			pCopies[i].dstOffset = pRegions[i].dstOffset;
+			pCopies[i].size = pRegions[i].size;
+			offset += pRegions[i].size;
+		}
+		vkUnmapMemory(asVkDevice, stagingAlloc.memHandle);
+	}
+	/*Copy staging contents into the buffers*/
+	{
+		VkCommandBufferAllocateInfo cmdAlloc = (VkCommandBufferAllocateInfo) { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		cmdAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cmdAlloc.commandPool = asVkGeneralCommandPool;
+		cmdAlloc.commandBufferCount = 1;
+		VkCommandBuffer tmpCmd;
+		vkAllocateCommandBuffers(asVkDevice, &cmdAlloc, &tmpCmd);
+		VkCommandBufferBeginInfo beginInfo = (VkCommandBufferBeginInfo) { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(tmpCmd, &beginInfo);
+		/*Earlier reads of the buffers are done before they are written*/
+		VkMemoryBarrier toTransferDst = (VkMemoryBarrier) { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		toTransferDst.srcAccessMask = 0;
+		toTransferDst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(tmpCmd,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 1, &toTransferDst, 0, NULL, 0, NULL);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!pCopies[i].size) { continue; }
+			vkCmdCopyBuffer(tmpCmd, stagingBuffer, vMainBufferManager.buffers[pRegions[i].buffer._index].buffer, 1, &pCopies[i]);
+		}
+		VkMemoryBarrier toFinal = (VkMemoryBarrier) { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toFinal.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(tmpCmd,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0, 1, &toFinal, 0, NULL, 0, NULL);
+		/*Execute*/
+		vkEndCommandBuffer(tmpCmd);
+		VkSubmitInfo submitInfo = (VkSubmitInfo) { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &tmpCmd;
+		vkQueueSubmit(asVkQueue_GFX, 1, &submitInfo, VK_NULL_HANDLE); /*Recorded on the general (graphics) pool*/
+		vkQueueWaitIdle(asVkQueue_GFX);
+		vkFreeCommandBuffers(asVkDevice, asVkGeneralCommandPool, 1, &tmpCmd);
+	}
+	/*Free staging data*/
+	asFree(pCopies);
+	vkDestroyBuffer(asVkDevice, stagingBuffer, AS_VK_MEMCB);
+	asVkFree(&stagingAlloc);
+	return AS_SUCCESS;
+}
+
 VkBuffer asVkGetBufferFromBuffer(asBufferHandle_t hndl)
 {
 	return vMainBufferManager.buffers[hndl._index].buffer;
@@ -1386,10 +2108,18 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 		vkGetPhysicalDeviceProperties(asVkPhysicalDevice, &asVkDeviceProperties);
 		vkGetPhysicalDeviceFeatures(asVkPhysicalDevice, &asVkDeviceFeatures);
 		vkGetPhysicalDeviceMemoryProperties(asVkPhysicalDevice, &asVkDeviceMemProps);
+		asVkDescriptorIndexingProps = (VkPhysicalDeviceDescriptorIndexingPropertiesEXT){ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT };
+		VkPhysicalDeviceProperties2 properties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+		properties2.pNext = &asVkDescriptorIndexingProps;
+		vkGetPhysicalDeviceProperties2(asVkPhysicalDevice, &properties2);
 
 		asFree(gpus);
 	}
 	/*Find Extensions*/
+	bool drawIndirectCountFound = false;
+	bool meshShaderFound = false;
+	bool spirv14Found = false;
+	bool floatControlsFound = false;
 	{
 		uint32_t extCount;
 		vkEnumerateDeviceExtensionProperties(asVkPhysicalDevice, NULL, &extCount, NULL);
@@ -1399,6 +2129,22 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 		{
 			for (uint32_t ii = 0; ii < extCount; ii++)
 			{
+				/*Memory Budget Extension*/
+				if (strcmp(availible[ii].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+				{
+					vMemoryBudgetExtensionFound = true;
+				}
+				/*GPU Driven Drawing Extensions*/
+				if (strcmp(availible[ii].extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+					drawIndirectCountFound = true;
+				if (strcmp(availible[ii].extensionName, VK_KHR_SPIRV_1_4_EXTENSION_NAME) == 0)
+					spirv14Found = true;
+				if (strcmp(availible[ii].extensionName, VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME) == 0)
+					floatControlsFound = true;
+#ifdef VK_EXT_mesh_shader
+				if (strcmp(availible[ii].extensionName, VK_EXT_MESH_SHADER_EXTENSION_NAME) == 0)
+					meshShaderFound = true;
+#endif
 #if AS_VK_VALIDATION
 				/*Debug Markers Extension*/
 				if (strcmp(availible[ii].extensionName, VK_EXT_DEBUG_MARKER_EXTENSION_NAME) == 0)
@@ -1410,6 +2156,17 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 		}
 		asFree(availible);
 	}
+#ifdef VK_EXT_mesh_shader
+	/*Mesh shaders need SPIR-V 1.4 on Vulkan 1.1 and both the task and mesh stages*/
+	VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+	if (meshShaderFound && spirv14Found && floatControlsFound)
+	{
+		VkPhysicalDeviceFeatures2 features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+		features.pNext = &meshShaderFeatures;
+		vkGetPhysicalDeviceFeatures2(asVkPhysicalDevice, &features);
+		asVkMeshShaderSupported = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+	}
+#endif
 #if AS_VK_VALIDATION
 	/*Setup Validation Debug Callback*/
 	{
@@ -1443,13 +2200,14 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 			asFatalError("Device does not have the necessary queues for rendering", -1);
 
 		uint32_t uniqueIdxCount = 0;
-		uint32_t uniqueIndices[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+		uint32_t uniqueIndices[4] = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
 		/*ONLY create a list of unique indices*/
 		{
-			uint32_t nonUniqueIndices[3] = 
+			uint32_t nonUniqueIndices[4] = 
 			{ asVkQueueFamilyIndices.graphicsIdx, 
 			asVkQueueFamilyIndices.presentIdx,
-			asVkQueueFamilyIndices.computeIdx };
+			asVkQueueFamilyIndices.computeIdx,
+			asVkQueueFamilyIndices.transferIdx };
 			bool found;
 			for (uint32_t i = 0; i < ASARRAYLEN(nonUniqueIndices); i++) { /*Add items*/
 				found = false;
@@ -1465,7 +2223,7 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 				}
 			}
 		}
-		VkDeviceQueueCreateInfo queueCreateInfos[3];
+		VkDeviceQueueCreateInfo queueCreateInfos[4];
 		float defaultPriority = 1.0f;
 		for (uint32_t i = 0; i < uniqueIdxCount; i++)
 		{
@@ -1485,8 +2243,28 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 		enabledFeatures.wideLines = VK_TRUE;
 		if(asVkDeviceFeatures.samplerAnisotropy)
 			enabledFeatures.samplerAnisotropy = VK_TRUE;
+		/*Indirect draws written by the GPU (cluster culling)*/
+		if (asVkDeviceFeatures.multiDrawIndirect)
+			enabledFeatures.multiDrawIndirect = VK_TRUE;
+		if (asVkDeviceFeatures.drawIndirectFirstInstance)
+			enabledFeatures.drawIndirectFirstInstance = VK_TRUE;
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabledIndexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
+		enabledIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		enabledIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		enabledIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		enabledIndexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+		enabledIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		enabledIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
 
 		VkDeviceCreateInfo createInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+		createInfo.pNext = &enabledIndexingFeatures;
+#ifdef VK_EXT_mesh_shader
+		VkPhysicalDeviceMeshShaderFeaturesEXT enabledMeshShaderFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+		enabledMeshShaderFeatures.taskShader = VK_TRUE;
+		enabledMeshShaderFeatures.meshShader = VK_TRUE;
+		if (asVkMeshShaderSupported)
+			enabledIndexingFeatures.pNext = &enabledMeshShaderFeatures;
+#endif
 		createInfo.pQueueCreateInfos = queueCreateInfos;
 		createInfo.queueCreateInfoCount = uniqueIdxCount;
 		createInfo.pEnabledFeatures = &enabledFeatures;
@@ -1501,12 +2279,38 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 #endif
 
 		/*Extensions*/
-		createInfo.enabledExtensionCount = ASARRAYLEN(deviceReqExtensions);
-		createInfo.ppEnabledExtensionNames = deviceReqExtensions;
+		const char* enabledExtensions[ASARRAYLEN(deviceReqExtensions) + 5];
+		uint32_t enabledExtensionCount = 0;
+		for (uint32_t i = 0; i < ASARRAYLEN(deviceReqExtensions); i++)
+			enabledExtensions[enabledExtensionCount++] = deviceReqExtensions[i];
+		if (vMemoryBudgetExtensionFound)
+			enabledExtensions[enabledExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+		if (drawIndirectCountFound)
+			enabledExtensions[enabledExtensionCount++] = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+#ifdef VK_EXT_mesh_shader
+		if (asVkMeshShaderSupported)
+		{
+			enabledExtensions[enabledExtensionCount++] = VK_EXT_MESH_SHADER_EXTENSION_NAME;
+			enabledExtensions[enabledExtensionCount++] = VK_KHR_SPIRV_1_4_EXTENSION_NAME;
+			enabledExtensions[enabledExtensionCount++] = VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME;
+		}
+#endif
+		createInfo.enabledExtensionCount = enabledExtensionCount;
+		createInfo.ppEnabledExtensionNames = enabledExtensions;
 
 		AS_VK_CHECK(vkCreateDevice(asVkPhysicalDevice, &createInfo, AS_VK_MEMCB, &asVkDevice),
 			"vkCreateDevice() failed to create the device");
 
+		/*Optional Draw Functions*/
+		if (drawIndirectCountFound)
+			asVkCmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(asVkDevice, "vkCmdDrawIndexedIndirectCountKHR");
+		asVkDrawIndirectCountSupported = asVkCmdDrawIndexedIndirectCount != NULL;
+#ifdef VK_EXT_mesh_shader
+		if (asVkMeshShaderSupported)
+			asVkCmdDrawMeshTasks = (PFN_vkCmdDrawMeshTasksEXT)vkGetDeviceProcAddr(asVkDevice, "vkCmdDrawMeshTasksEXT");
+		asVkMeshShaderSupported = asVkCmdDrawMeshTasks != NULL;
+#endif
+
 		vkGetDeviceQueue(asVkDevice, asVkQueueFamilyIndices.graphicsIdx, 0, &asVkQueue_GFX);
 		vkGetDeviceQueue(asVkDevice, asVkQueueFamilyIndices.presentIdx, 0, &asVkQueue_Present);
 		vkGetDeviceQueue(asVkDevice, asVkQueueFamilyIndices.computeIdx, 0, &asVkQueue_Compute);
@@ -1531,12 +2335,19 @@ void asVkInit(asAppInfo_t *pAppInfo, int32_t deviceIndex)
 		AS_VK_CHECK(vkCreateCommandPool(asVkDevice, &createInfo, AS_VK_MEMCB, &asVkGeneralCommandPool),
 			"vkCreateCommandPool() Failed to create general command pool");
 
+		/*Texture uploads are recorded on the transfer family and handed over to graphics*/
+		createInfo.queueFamilyIndex = asVkQueueFamilyIndices.transferIdx;
+		createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		AS_VK_CHECK(vkCreateCommandPool(asVkDevice, &createInfo, AS_VK_MEMCB, &vTransferCommandPool),
+			"vkCreateCommandPool() Failed to create transfer command pool");
+
 		vPrimaryCommandBufferManager_Init(&vMainGraphicsBufferManager, asVkQueueFamilyIndices.graphicsIdx, 64);
 		vPrimaryCommandBufferManager_Init(&vMainComputeBufferManager, asVkQueueFamilyIndices.computeIdx, 32);
 	}
 	/*Memory Management*/
 	{
 		vMemoryAllocator_Init(&vMainAllocator);
+		vMemoryAllocator_UpdateBudget(&vMainAllocator);
 	}
 	/*Texture, Buffers and Shaders*/
 	{
@@ -1620,6 +2431,9 @@ void asVkInitFrame()
 	/*Secure Frame Resources (reset if used)*/
 	vPrimaryCommandBufferManager_SecureFrame(&vMainGraphicsBufferManager, asVkCurrentFrame);
 	vPrimaryCommandBufferManager_SecureFrame(&vMainComputeBufferManager, asVkCurrentFrame);
+
+	/*Memory Budget*/
+	vMemoryAllocator_UpdateBudget(&vMainAllocator);
 }
 
 void asVkDrawFrame()
@@ -1655,6 +2469,8 @@ void asVkFinalShutdown()
 
 	if (asVkGeneralCommandPool != VK_NULL_HANDLE)
 		vkDestroyCommandPool(asVkDevice, asVkGeneralCommandPool, AS_VK_MEMCB);
+	if (vTransferCommandPool != VK_NULL_HANDLE)
+		vkDestroyCommandPool(asVkDevice, vTransferCommandPool, AS_VK_MEMCB);
 
 	for (uint32_t i = 0; i < AS_MAX_INFLIGHT; i++){
 		if (asVkInFlightFences[i] != VK_NULL_HANDLE)
@@ -77,6 +77,28 @@ extern VkPhysicalDeviceProperties asVkDeviceProperties;
 */
 extern VkPhysicalDeviceFeatures asVkDeviceFeatures;
 /**
+* @brief descriptor indexing limits of the GPU (used by the bindless texture pool)
+*/
+extern VkPhysicalDeviceDescriptorIndexingPropertiesEXT asVkDescriptorIndexingProps;
+/**
+* @brief draws can take their count from a buffer (VK_KHR_draw_indirect_count)
+*/
+extern bool asVkDrawIndirectCountSupported;
+/**
+* @brief task and mesh shaders can be used (VK_EXT_mesh_shader)
+*/
+extern bool asVkMeshShaderSupported;
+/**
+* @brief vkCmdDrawIndexedIndirectCountKHR() when asVkDrawIndirectCountSupported
+*/
+extern PFN_vkCmdDrawIndexedIndirectCountKHR asVkCmdDrawIndexedIndirectCount;
+#ifdef VK_EXT_mesh_shader
+/**
+* @brief vkCmdDrawMeshTasksEXT() when asVkMeshShaderSupported
+*/
+extern PFN_vkCmdDrawMeshTasksEXT asVkCmdDrawMeshTasks;
+#endif
+/**
 * @brief memory properties of the GPU
 */
 extern VkPhysicalDeviceMemoryProperties asVkDeviceMemProps;
@@ -6,9 +6,18 @@
 
 #if defined(unix) || defined(__unix__) || defined(__unix)
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include <SDL_filesystem.h>
+#include <SDL_atomic.h>
+
+#include "asResourceAsyncIO.h"
+#include "asResourceManifest.h"
+#include "asResourceTrace.h"
+#include "../common/preferences/asPreferences.h"
 
 #include "stb/stb_ds.h"
 #include "mattias/strpool.h"
@@ -92,27 +101,59 @@ ASEXPORT const char* asResource_GetBinFolderPath()
 struct fInfo { STRPOOL_U64 nameId; int64_t start; int64_t size; };
 struct
 {
-	struct { asResourceFileID_t key; struct fInfo value; }*fileMap;
+	asResourceManifest manifest; /*Mapped binary manifest (preferred)*/
+	struct { asResourceFileID_t key; struct fInfo value; }*fileMap; /*Parsed text manifest (fallback)*/
 	strpool_t strPool;
 } resourceLookupPool;
 
-ASEXPORT asResults asResourceLoader_Open(asResourceLoader_t * loader, asResourceFileID_t id)
+static const char* _resourceLookup(asResourceFileID_t id, int64_t* pStart, int64_t* pSize)
 {
-	size_t resourceIndex = hmgeti(resourceLookupPool.fileMap, id);
-	if (resourceIndex == SIZE_MAX)
+	if (resourceLookupPool.manifest)
 	{
-		asDebugWarning("Unknown Resource ID: %llx (Not registered in Manifest?)", id);
-		return AS_FAILURE_FILE_NOT_FOUND;
+		const asResourceManifestEntry_t* pEntry = asResourceManifest_Find(resourceLookupPool.manifest, id);
+		if (!pEntry)
+			return NULL;
+		if (pStart) { *pStart = pEntry->start; }
+		if (pSize) { *pSize = pEntry->size; }
+		return asResourceManifest_GetName(resourceLookupPool.manifest, pEntry);
 	}
-
-	const char* relativeName = strpool_cstr(&resourceLookupPool.strPool,
+	size_t resourceIndex = hmgeti(resourceLookupPool.fileMap, id);
+	if (resourceIndex == SIZE_MAX)
+		return NULL;
+	if (pStart) { *pStart = resourceLookupPool.fileMap[resourceIndex].value.start; }
+	if (pSize) { *pSize = resourceLookupPool.fileMap[resourceIndex].value.size; }
+	return strpool_cstr(&resourceLookupPool.strPool,
 		resourceLookupPool.fileMap[resourceIndex].value.nameId);
+}
+
+/*64 bit file offsets (long is 32 bit on Windows, package ranges can start past 2GB)*/
+static int _resourceSeek(FILE* fp, int64_t offset, int origin)
+{
+#ifdef _WIN32
+	return _fseeki64(fp, offset, origin);
+#else
+	return fseeko(fp, (off_t)offset, origin);
+#endif
+}
+
+static int64_t _resourceTell(FILE* fp)
+{
+#ifdef _WIN32
+	return _ftelli64(fp);
+#else
+	return (int64_t)ftello(fp);
+#endif
+}
+
+ASEXPORT asResults asResourceLoader_Open(asResourceLoader_t * loader, asResourceFileID_t id)
+{
+	const char* relativeName = _resourceLookup(id, &loader->_buffOffset, &loader->_buffSize);
 	if (!relativeName)
 	{
-		return AS_FAILURE_UNKNOWN;
+		asDebugWarning("Unknown Resource ID: %llx (Not registered in Manifest?)", id);
+		return AS_FAILURE_FILE_NOT_FOUND;
 	}
-	loader->_buffSize = resourceLookupPool.fileMap[resourceIndex].value.size;
-	loader->_buffOffset = resourceLookupPool.fileMap[resourceIndex].value.start;
+	loader->_id = id;
 
 	/*create full filepath*/
 	char fileName[1024];
@@ -123,11 +164,11 @@ ASEXPORT asResults asResourceLoader_Open(asResourceLoader_t * loader, asResource
 		return AS_FAILURE_FILE_INACCESSIBLE;
 	if (loader->_buffSize < 0)
 	{
-		fseek(loader->_fileHndl, 0, SEEK_END);
-		loader->_buffSize = ftell(loader->_fileHndl);
+		_resourceSeek(loader->_fileHndl, 0, SEEK_END);
+		loader->_buffSize = _resourceTell(loader->_fileHndl);
 	}
 
-	fseek(loader->_fileHndl, (long)loader->_buffOffset, SEEK_SET);
+	_resourceSeek(loader->_fileHndl, loader->_buffOffset, SEEK_SET);
 	return AS_SUCCESS;
 }
 
@@ -139,6 +180,24 @@ ASEXPORT asResults asResourceLoader_OpenByPath(asResourceLoader_t* loader, asRes
 	return asResourceLoader_Open(loader, resID);
 }
 
+ASEXPORT asResults asResourceLoader_OpenFileRange(asResourceLoader_t* loader, const char* pFullPath, int64_t start, int64_t size)
+{
+	loader->_id = 0;
+	loader->_buffOffset = start;
+	loader->_buffSize = size;
+	loader->_fileHndl = fopen(pFullPath, "rb");
+	if (!loader->_fileHndl)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	if (loader->_buffSize < 0)
+	{
+		_resourceSeek(loader->_fileHndl, 0, SEEK_END);
+		loader->_buffSize = _resourceTell(loader->_fileHndl) - start;
+	}
+
+	_resourceSeek(loader->_fileHndl, loader->_buffOffset, SEEK_SET);
+	return AS_SUCCESS;
+}
+
 ASEXPORT void asResourceLoader_Close(asResourceLoader_t* loader)
 {
 	fclose(loader->_fileHndl);
@@ -151,116 +210,679 @@ ASEXPORT size_t asResourceLoader_GetContentSize(asResourceLoader_t * loader)
 
 ASEXPORT asResults asResourceLoader_SetReadPoint(asResourceLoader_t * loader, size_t pos)
 {
-	fseek(loader->_fileHndl, (long)(loader->_buffOffset + pos), SEEK_SET);
+	_resourceSeek(loader->_fileHndl, loader->_buffOffset + (int64_t)pos, SEEK_SET);
 	return AS_SUCCESS;
 }
 
 ASEXPORT asResults asResourceLoader_Read(asResourceLoader_t * loader, size_t size, void * buff)
 {
+	if (loader->_id)
+		asResourceTrace_Record(loader->_id, (uint64_t)(_resourceTell(loader->_fileHndl) - loader->_buffOffset), size);
 	fread(buff, size, 1, loader->_fileHndl);
 	return AS_SUCCESS;
 }
 
 ASEXPORT asResults asResourceLoader_ReadAll(asResourceLoader_t * loader, size_t size, void * buff)
 {
-	fseek(loader->_fileHndl, (long)loader->_buffOffset, SEEK_SET);
+	asResourceTrace_Record(loader->_id, 0, (uint64_t)loader->_buffSize);
+	_resourceSeek(loader->_fileHndl, loader->_buffOffset, SEEK_SET);
 	fread(buff, loader->_buffSize, 1, loader->_fileHndl);
 	return AS_SUCCESS;
 }
 
-/*Resource data mapping*/
+/*Mapped file views*/
+
+ASEXPORT asResults asResourceFileView_OpenFileRange(asResourceFileView_t* pView, const char* pFullPath, int64_t start, int64_t size)
+{
+	memset(pView, 0, sizeof(asResourceFileView_t));
+	uint64_t fileSize;
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(pFullPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	LARGE_INTEGER sizeInfo;
+	if (!GetFileSizeEx(hFile, &sizeInfo) || !sizeInfo.QuadPart)
+	{
+		CloseHandle(hFile);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	fileSize = (uint64_t)sizeInfo.QuadPart;
+#else
+	int fd = open(pFullPath, O_RDONLY);
+	if (fd < 0)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	struct stat info;
+	if (fstat(fd, &info) || !info.st_size)
+	{
+		close(fd);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	fileSize = (uint64_t)info.st_size;
+#endif
+	if (size < 0)
+		size = (int64_t)fileSize - start;
+	if (start < 0 || size < 0 || (uint64_t)(start + size) > fileSize)
+	{
+#ifdef _WIN32
+		CloseHandle(hFile);
+#else
+		close(fd);
+#endif
+		return AS_FAILURE_OUT_OF_BOUNDS;
+	}
+
+	/*Map the whole file (mappings have to start on a page boundary anyways)*/
+#ifdef _WIN32
+	HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* pMapped = hMapping ? MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!pMapped)
+	{
+		if (hMapping)
+			CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	pView->_hFile = hFile;
+	pView->_hMapping = hMapping;
+#else
+	void* pMapped = mmap(NULL, (size_t)fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMapped == MAP_FAILED)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	madvise((unsigned char*)pMapped + (start & ~(int64_t)4095), (size_t)(size + (start & 4095)), MADV_WILLNEED);
+#endif
+	pView->_pMapped = pMapped;
+	pView->_mappedSize = (size_t)fileSize;
+	pView->pData = (unsigned char*)pMapped + start;
+	pView->size = (size_t)size;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asResourceFileView_Open(asResourceFileView_t* pView, asResourceFileID_t id)
+{
+	int64_t start, size;
+	const char* relativeName = _resourceLookup(id, &start, &size);
+	if (!relativeName)
+	{
+		asDebugWarning("Unknown Resource ID: %llx (Not registered in Manifest?)", id);
+		return AS_FAILURE_FILE_NOT_FOUND;
+	}
+	char fileName[1024];
+	strncpy(fileName, resourceDir, 1024);
+	strncat(fileName, relativeName, strlen(relativeName));
+	asResults result = asResourceFileView_OpenFileRange(pView, fileName, start, size);
+	if (result == AS_SUCCESS)
+		asResourceTrace_Record(id, 0, (uint64_t)pView->size);
+	return result;
+}
+
+ASEXPORT void asResourceFileView_Close(asResourceFileView_t* pView)
+{
+	if (!pView->_pMapped)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(pView->_pMapped);
+	CloseHandle(pView->_hMapping);
+	CloseHandle(pView->_hFile);
+#else
+	munmap(pView->_pMapped, pView->_mappedSize);
+#endif
+	memset(pView, 0, sizeof(asResourceFileView_t));
+}
+
+/*Resource data mapping (sharded registry)*/
+
+#define AS_RESOURCE_REGISTRY_SHARDS 64 /*Must be a power of two*/
+#define AS_RESOURCE_REGISTRY_BLOCK 256 /*Entries per storage block (entries never move once created)*/
+#define AS_RESOURCE_MAX_TYPES 64
+#define AS_RESOURCE_DEAD_REFERENCES -1 /*Released and handed to a deletion queue*/
+#define AS_RESOURCE_CACHED_REFERENCES -2 /*Unreferenced but resident in the cache (only changed with the cache locked)*/
+/*Zero references is still a live resource (created without initial references), only a release queues it*/
 
 struct _resourceDat
 {
+	asResourceFileID_t id;
 	asResourceDataMapping_t mapping;
-	int32_t references;
+	SDL_atomic_t references;
+	SDL_atomic_t generation; /*Bumped by every create so releases can tell a new mapping from the one they referenced*/
 	asHash32_t type;
+	size_t size; /*Resident bytes (0 is never cached)*/
+	struct _resourceDat* pLruPrev; /*Global cache list*/
+	struct _resourceDat* pLruNext;
+	struct _resourceDat* pTypeLruPrev; /*Per type cache list*/
+	struct _resourceDat* pTypeLruNext;
 };
-struct { asResourceFileID_t key; struct _resourceDat value; }*resMap = NULL;
+
+struct _resourceShard
+{
+	SDL_SpinLock lock;
+	uint32_t* pSlots; /*Open addressing table of entry index + 1 (0 is empty)*/
+	uint32_t slotCapacity;
+	uint32_t entryCount;
+	struct _resourceDat** ppBlocks; /*stb_ds array*/
+};
+
+struct _resourceShard resShards[AS_RESOURCE_REGISTRY_SHARDS];
+
+static struct _resourceShard* _resourceShardFor(asResourceFileID_t id)
+{
+	return &resShards[id & (AS_RESOURCE_REGISTRY_SHARDS - 1)];
+}
+
+static struct _resourceDat* _resourceShardEntry(struct _resourceShard* pShard, uint32_t index)
+{
+	return &pShard->ppBlocks[index / AS_RESOURCE_REGISTRY_BLOCK][index % AS_RESOURCE_REGISTRY_BLOCK];
+}
+
+/*Must be called with the shard locked*/
+static struct _resourceDat* _resourceShardFind(struct _resourceShard* pShard, asResourceFileID_t id)
+{
+	if (!pShard->slotCapacity)
+		return NULL;
+	uint32_t mask = pShard->slotCapacity - 1;
+	for (uint32_t slot = (uint32_t)(id >> 6) & mask;; slot = (slot + 1) & mask)
+	{
+		if (!pShard->pSlots[slot])
+			return NULL;
+		struct _resourceDat* pEntry = _resourceShardEntry(pShard, pShard->pSlots[slot] - 1);
+		if (pEntry->id == id)
+			return pEntry;
+	}
+}
+
+/*Must be called with the shard locked*/
+static void _resourceShardInsertSlot(struct _resourceShard* pShard, asResourceFileID_t id, uint32_t index)
+{
+	uint32_t mask = pShard->slotCapacity - 1;
+	uint32_t slot = (uint32_t)(id >> 6) & mask;
+	while (pShard->pSlots[slot])
+		slot = (slot + 1) & mask;
+	pShard->pSlots[slot] = index + 1;
+}
+
+/*Must be called with the shard locked*/
+static struct _resourceDat* _resourceShardAdd(struct _resourceShard* pShard, asResourceFileID_t id)
+{
+	/*Grow the table at 70% load*/
+	if ((pShard->entryCount + 1) * 10 > pShard->slotCapacity * 7)
+	{
+		uint32_t newCapacity = pShard->slotCapacity ? pShard->slotCapacity * 2 : 64;
+		uint32_t* pNewSlots = asMalloc(sizeof(uint32_t) * newCapacity);
+		ASASSERT(pNewSlots);
+		memset(pNewSlots, 0, sizeof(uint32_t) * newCapacity);
+		asFree(pShard->pSlots);
+		pShard->pSlots = pNewSlots;
+		pShard->slotCapacity = newCapacity;
+		for (uint32_t i = 0; i < pShard->entryCount; i++)
+			_resourceShardInsertSlot(pShard, _resourceShardEntry(pShard, i)->id, i);
+	}
+	if (pShard->entryCount == arrlen(pShard->ppBlocks) * AS_RESOURCE_REGISTRY_BLOCK)
+	{
+		struct _resourceDat* pBlock = asMalloc(sizeof(struct _resourceDat) * AS_RESOURCE_REGISTRY_BLOCK);
+		ASASSERT(pBlock);
+		arrput(pShard->ppBlocks, pBlock);
+	}
+	uint32_t index = pShard->entryCount++;
+	struct _resourceDat* pEntry = _resourceShardEntry(pShard, index);
+	memset(pEntry, 0, sizeof(struct _resourceDat));
+	pEntry->id = id;
+	SDL_AtomicSet(&pEntry->references, AS_RESOURCE_DEAD_REFERENCES);
+	_resourceShardInsertSlot(pShard, id, index);
+	return pEntry;
+}
+
+/*Entries are never removed or moved so the pointer stays valid without the lock*/
+static struct _resourceDat* _resourceGet(asResourceFileID_t id)
+{
+	struct _resourceShard* pShard = _resourceShardFor(id);
+	SDL_AtomicLock(&pShard->lock);
+	struct _resourceDat* pEntry = _resourceShardFind(pShard, id);
+	SDL_AtomicUnlock(&pShard->lock);
+	return pEntry;
+}
+
+static void _resourceShutdownRegistry()
+{
+	for (size_t i = 0; i < AS_RESOURCE_REGISTRY_SHARDS; i++)
+	{
+		for (size_t j = 0; j < (size_t)arrlen(resShards[i].ppBlocks); j++)
+			asFree(resShards[i].ppBlocks[j]);
+		arrfree(resShards[i].ppBlocks);
+		asFree(resShards[i].pSlots);
+	}
+	memset(resShards, 0, sizeof(resShards));
+}
+
+/*Types (deletion queues and cache accounting)*/
+
+struct _resourceTypeInfo
+{
+	asResourceType_t type;
+	SDL_SpinLock lock;
+	asResourceDataMapping_t* pPending; /*Producers append here (stb_ds array)*/
+	asResourceDataMapping_t* pConsuming; /*Handed to the consumer (stb_ds array)*/
+	/*Cache (guarded by the cache lock)*/
+	size_t cacheBudget;
+	size_t cachedBytes;
+	size_t cachedCount;
+	size_t evictions;
+	struct _resourceDat* pLruHead; /*Most recently released*/
+	struct _resourceDat* pLruTail;
+	/*Lookups*/
+	SDL_atomic_t hits;
+	SDL_atomic_t cacheHits;
+	SDL_atomic_t misses;
+};
+
+struct _resourceTypeInfo resTypes[AS_RESOURCE_MAX_TYPES];
+SDL_atomic_t resTypeCount;
+SDL_SpinLock resTypeRegistrationLock;
+
+static struct _resourceTypeInfo* _resourceFindType(asResourceType_t type)
+{
+	int count = SDL_AtomicGet(&resTypeCount);
+	for (int i = 0; i < count; i++)
+	{
+		if (resTypes[i].type == type)
+			return &resTypes[i];
+	}
+	return NULL;
+}
+
+static void _resourcePushDeletion(struct _resourceTypeInfo* pType, asResourceDataMapping_t mapping)
+{
+	if (!pType)
+		return;
+	SDL_AtomicLock(&pType->lock);
+	arrput(pType->pPending, mapping);
+	SDL_AtomicUnlock(&pType->lock);
+}
+
+static void _resourceShutdownTypes()
+{
+	for (int i = 0; i < SDL_AtomicGet(&resTypeCount); i++)
+	{
+		arrfree(resTypes[i].pPending);
+		arrfree(resTypes[i].pConsuming);
+	}
+	memset(resTypes, 0, sizeof(resTypes));
+	SDL_AtomicSet(&resTypeCount, 0);
+}
+
+/*Cache*/
+
+struct
+{
+	SDL_SpinLock lock; /*Taken after a shard lock, never before*/
+	size_t budget;
+	size_t cachedBytes;
+	struct _resourceDat* pLruHead; /*Most recently released*/
+	struct _resourceDat* pLruTail;
+} resCache;
+
+int32_t gResourceCacheBudgetMB = 256;
+
+static bool _resourceCacheable(struct _resourceDat* pEntry, struct _resourceTypeInfo* pType)
+{
+	return pType && pEntry->size && pType->cacheBudget && resCache.budget;
+}
+
+/*Must be called with the cache locked*/
+static void _resourceCacheLink(struct _resourceDat* pEntry, struct _resourceTypeInfo* pType)
+{
+	pEntry->pLruPrev = NULL;
+	pEntry->pLruNext = resCache.pLruHead;
+	if (resCache.pLruHead)
+		resCache.pLruHead->pLruPrev = pEntry;
+	else
+		resCache.pLruTail = pEntry;
+	resCache.pLruHead = pEntry;
+	resCache.cachedBytes += pEntry->size;
+
+	pEntry->pTypeLruPrev = NULL;
+	pEntry->pTypeLruNext = pType->pLruHead;
+	if (pType->pLruHead)
+		pType->pLruHead->pTypeLruPrev = pEntry;
+	else
+		pType->pLruTail = pEntry;
+	pType->pLruHead = pEntry;
+	pType->cachedBytes += pEntry->size;
+	pType->cachedCount++;
+}
+
+/*Must be called with the cache locked*/
+static void _resourceCacheUnlink(struct _resourceDat* pEntry, struct _resourceTypeInfo* pType)
+{
+	if (pEntry->pLruPrev)
+		pEntry->pLruPrev->pLruNext = pEntry->pLruNext;
+	else
+		resCache.pLruHead = pEntry->pLruNext;
+	if (pEntry->pLruNext)
+		pEntry->pLruNext->pLruPrev = pEntry->pLruPrev;
+	else
+		resCache.pLruTail = pEntry->pLruPrev;
+	resCache.cachedBytes -= pEntry->size;
+
+	if (pEntry->pTypeLruPrev)
+		pEntry->pTypeLruPrev->pTypeLruNext = pEntry->pTypeLruNext;
+	else
+		pType->pLruHead = pEntry->pTypeLruNext;
+	if (pEntry->pTypeLruNext)
+		pEntry->pTypeLruNext->pTypeLruPrev = pEntry->pTypeLruPrev;
+	else
+		pType->pLruTail = pEntry->pTypeLruPrev;
+	pType->cachedBytes -= pEntry->size;
+	pType->cachedCount--;
+
+	pEntry->pLruPrev = pEntry->pLruNext = NULL;
+	pEntry->pTypeLruPrev = pEntry->pTypeLruNext = NULL;
+}
+
+/*Must be called with the cache locked, cached entries only leave the cache with the lock held so no swap is needed*/
+static void _resourceCacheEvict(struct _resourceDat* pEntry)
+{
+	struct _resourceTypeInfo* pType = _resourceFindType(pEntry->type);
+	_resourceCacheUnlink(pEntry, pType);
+	SDL_AtomicSet(&pEntry->references, AS_RESOURCE_DEAD_REFERENCES);
+	pType->evictions++;
+	_resourcePushDeletion(pType, pEntry->mapping);
+}
+
+/*Must be called with the cache locked*/
+static void _resourceCacheTrim(struct _resourceTypeInfo* pType)
+{
+	while (pType && pType->pLruTail && pType->cachedBytes > pType->cacheBudget)
+		_resourceCacheEvict(pType->pLruTail);
+	while (resCache.pLruTail && resCache.cachedBytes > resCache.budget)
+		_resourceCacheEvict(resCache.pLruTail);
+}
+
+/*Try to take references on an entry, reviving it from the cache if needed (returns the previous count)*/
+static int _resourceAddReferences(struct _resourceDat* pEntry, uint32_t addRefCount)
+{
+	for (;;)
+	{
+		int current = SDL_AtomicGet(&pEntry->references);
+		if (current == AS_RESOURCE_DEAD_REFERENCES)
+			return current; /*Already released*/
+		if (current == AS_RESOURCE_CACHED_REFERENCES)
+		{
+			bool revived = false;
+			SDL_AtomicLock(&resCache.lock);
+			if (SDL_AtomicCAS(&pEntry->references, AS_RESOURCE_CACHED_REFERENCES, (int)addRefCount))
+			{
+				_resourceCacheUnlink(pEntry, _resourceFindType(pEntry->type));
+				revived = true;
+			}
+			SDL_AtomicUnlock(&resCache.lock);
+			if (revived)
+				return current;
+		}
+		else if (SDL_AtomicCAS(&pEntry->references, current, current + (int)addRefCount))
+		{
+			return current;
+		}
+	}
+}
+
+static void _resourceCountLookup(struct _resourceTypeInfo* pType, int references)
+{
+	if (!pType)
+		return;
+	if (references >= 0)
+		SDL_AtomicAdd(&pType->hits, 1);
+	else if (references == AS_RESOURCE_CACHED_REFERENCES)
+		SDL_AtomicAdd(&pType->cacheHits, 1);
+	else
+		SDL_AtomicAdd(&pType->misses, 1);
+}
+
+ASEXPORT void asResource_CreateSized(asResourceFileID_t id, asResourceDataMapping_t mapping, asHash32_t type, int32_t initialRefs, size_t size)
+{
+	struct _resourceShard* pShard = _resourceShardFor(id);
+	SDL_AtomicLock(&pShard->lock);
+	struct _resourceDat* pEntry = _resourceShardFind(pShard, id);
+	if (!pEntry)
+		pEntry = _resourceShardAdd(pShard, id);
+	if (SDL_AtomicGet(&pEntry->references) == AS_RESOURCE_CACHED_REFERENCES)
+	{
+		/*Replacing a cached mapping, let the old one be deleted*/
+		SDL_AtomicLock(&resCache.lock);
+		if (SDL_AtomicGet(&pEntry->references) == AS_RESOURCE_CACHED_REFERENCES)
+			_resourceCacheEvict(pEntry);
+		SDL_AtomicUnlock(&resCache.lock);
+	}
+	pEntry->mapping = mapping;
+	pEntry->type = type;
+	pEntry->size = size;
+	SDL_AtomicAdd(&pEntry->generation, 1);
+	SDL_AtomicSet(&pEntry->references, initialRefs > 0 ? initialRefs : 0);
+	SDL_AtomicUnlock(&pShard->lock);
+}
 
 ASEXPORT void asResource_Create(asResourceFileID_t id, asResourceDataMapping_t mapping, asHash32_t type, int32_t initialRefs)
 {
-	struct _resourceDat data;
-	data.mapping = mapping;
-	data.references = initialRefs;
-	data.type = type;
-	hmput(resMap, id, data);
+	asResource_CreateSized(id, mapping, type, initialRefs, 0);
 }
 
 ASEXPORT asResourceDataMapping_t asResource_GetExistingDataMapping(asResourceFileID_t id, asHash32_t requiredType)
 {
-	struct _resourceDat resource = hmget(resMap, id);
-	if (resource.type == requiredType)
+	asResourceDataMapping_t result = { .hndl = asHandle_Invalidate(), .ptr = NULL };
+	int references = AS_RESOURCE_DEAD_REFERENCES;
+	struct _resourceShard* pShard = _resourceShardFor(id);
+	SDL_AtomicLock(&pShard->lock);
+	struct _resourceDat* pEntry = _resourceShardFind(pShard, id);
+	if (pEntry && pEntry->type == requiredType)
 	{
-		return resource.mapping;
+		references = SDL_AtomicGet(&pEntry->references);
+		if (references != AS_RESOURCE_DEAD_REFERENCES)
+			result = pEntry->mapping;
 	}
-	return (asResourceDataMapping_t){ .hndl = asHandle_Invalidate(), .ptr = NULL };
+	SDL_AtomicUnlock(&pShard->lock);
+	_resourceCountLookup(_resourceFindType(requiredType), references);
+	return result;
 }
 
-/*Deletion*/
+ASEXPORT asResourceDataMapping_t asResource_AcquireExistingDataMapping(asResourceFileID_t id, asHash32_t requiredType, uint32_t addRefCount)
+{
+	asResourceDataMapping_t result = { .hndl = asHandle_Invalidate(), .ptr = NULL };
+	int references = AS_RESOURCE_DEAD_REFERENCES;
+	struct _resourceShard* pShard = _resourceShardFor(id);
+	SDL_AtomicLock(&pShard->lock);
+	struct _resourceDat* pEntry = _resourceShardFind(pShard, id);
+	if (pEntry && pEntry->type == requiredType)
+	{
+		/*The shard lock keeps the mapping from being replaced until the references are taken*/
+		references = _resourceAddReferences(pEntry, addRefCount);
+		if (references != AS_RESOURCE_DEAD_REFERENCES)
+			result = pEntry->mapping;
+	}
+	SDL_AtomicUnlock(&pShard->lock);
+	_resourceCountLookup(_resourceFindType(requiredType), references);
+	return result;
+}
 
-struct { asHash32_t key; asResourceDataMapping_t* value; }*resDeleteLists = NULL;
+/*Deletion*/
 
 ASEXPORT asResourceType_t asResource_RegisterType(const char* typeName, size_t strSize)
 {
 	asHash32_t type = asHashBytes32_xxHash(typeName, strSize);
-	asResourceDataMapping_t* arr = NULL;
-	arrsetcap(arr, 64);
-	hmput(resDeleteLists, type, arr);
+	SDL_AtomicLock(&resTypeRegistrationLock);
+	if (!_resourceFindType(type))
+	{
+		int index = SDL_AtomicGet(&resTypeCount);
+		if (index >= AS_RESOURCE_MAX_TYPES)
+		{
+			asFatalError("Too many resource types", -1);
+		}
+		memset(&resTypes[index], 0, sizeof(struct _resourceTypeInfo));
+		resTypes[index].type = type;
+		arrsetcap(resTypes[index].pPending, 64);
+		arrsetcap(resTypes[index].pConsuming, 64);
+		SDL_AtomicSet(&resTypeCount, index + 1); /*Publish after the queue is ready*/
+	}
+	SDL_AtomicUnlock(&resTypeRegistrationLock);
 	return type;
 }
 
 ASEXPORT size_t asResource_GetDeletionQueue(asResourceType_t type, size_t* pCount, asResourceDataMapping_t ** ppMappings)
 {
-	asResourceDataMapping_t* map = hmget(resDeleteLists, type);
-	ASASSERT(map);
-	*ppMappings = map;
-	if (pCount) { *pCount = arrlen(map); }
-	return arrlen(map);
+	struct _resourceTypeInfo* pQueue = _resourceFindType(type);
+	ASASSERT(pQueue);
+	/*Take everything released so far, later releases wait for the next call*/
+	SDL_AtomicLock(&pQueue->lock);
+	if (!arrlen(pQueue->pConsuming))
+	{
+		asResourceDataMapping_t* pSwap = pQueue->pConsuming;
+		pQueue->pConsuming = pQueue->pPending;
+		pQueue->pPending = pSwap;
+	}
+	else if (arrlen(pQueue->pPending))
+	{
+		size_t start = arraddn(pQueue->pConsuming, arrlen(pQueue->pPending));
+		memcpy(&pQueue->pConsuming[start], pQueue->pPending, sizeof(asResourceDataMapping_t) * arrlen(pQueue->pPending));
+		arrsetlen(pQueue->pPending, 0);
+	}
+	SDL_AtomicUnlock(&pQueue->lock);
+	*ppMappings = pQueue->pConsuming;
+	if (pCount) { *pCount = arrlen(pQueue->pConsuming); }
+	return arrlen(pQueue->pConsuming);
 }
 
 ASEXPORT void asResource_ClearDeletionQueue(asResourceType_t type)
 {
-	asResourceDataMapping_t* map = hmget(resDeleteLists, type);
-	ASASSERT(map);
-	arrdeln(map, 0, arrlen(map));
+	struct _resourceTypeInfo* pQueue = _resourceFindType(type);
+	ASASSERT(pQueue);
+	arrsetlen(pQueue->pConsuming, 0);
 }
 
-ASEXPORT void asResource_GetFileName(asResourceFileID_t id, const char ** ppName, int32_t * pNameLength)
+ASEXPORT void asResource_SetCacheBudget(asResourceType_t type, size_t budgetBytes)
 {
-	size_t resourceIndex = hmgeti(resourceLookupPool.fileMap, id);
-	*ppName = strpool_cstr(&resourceLookupPool.strPool,
-		resourceLookupPool.fileMap[resourceIndex].value.nameId);
-	*pNameLength = (int32_t)strlen(*ppName);
+	struct _resourceTypeInfo* pType = _resourceFindType(type);
+	ASASSERT(pType);
+	SDL_AtomicLock(&resCache.lock);
+	pType->cacheBudget = budgetBytes;
+	_resourceCacheTrim(pType);
+	SDL_AtomicUnlock(&resCache.lock);
 }
 
-ASEXPORT void asResource_IncrimentReferences(asResourceFileID_t id, uint32_t addRefCount)
+ASEXPORT void asResource_SetGlobalCacheBudget(size_t budgetBytes)
+{
+	SDL_AtomicLock(&resCache.lock);
+	resCache.budget = budgetBytes;
+	_resourceCacheTrim(NULL);
+	SDL_AtomicUnlock(&resCache.lock);
+}
+
+ASEXPORT void asResource_FlushCache(asResourceType_t type)
+{
+	SDL_AtomicLock(&resCache.lock);
+	if (type)
+	{
+		struct _resourceTypeInfo* pType = _resourceFindType(type);
+		while (pType && pType->pLruTail)
+			_resourceCacheEvict(pType->pLruTail);
+	}
+	else
+	{
+		while (resCache.pLruTail)
+			_resourceCacheEvict(resCache.pLruTail);
+	}
+	SDL_AtomicUnlock(&resCache.lock);
+}
+
+ASEXPORT void asResource_GetCacheStats(asResourceType_t type, asResourceCacheStats_t* pStats)
 {
-	struct _resourceDat* res;
-	if (res = &hmget(resMap, id))
+	memset(pStats, 0, sizeof(asResourceCacheStats_t));
+	SDL_AtomicLock(&resCache.lock);
+	for (int i = 0; i < SDL_AtomicGet(&resTypeCount); i++)
 	{
-		if (res->references >= 0)
-			res->references += addRefCount;
+		struct _resourceTypeInfo* pType = &resTypes[i];
+		if (type && pType->type != type)
+			continue;
+		pStats->hits += (uint32_t)SDL_AtomicGet(&pType->hits);
+		pStats->cacheHits += (uint32_t)SDL_AtomicGet(&pType->cacheHits);
+		pStats->misses += (uint32_t)SDL_AtomicGet(&pType->misses);
+		pStats->evictions += pType->evictions;
+		pStats->cachedBytes += pType->cachedBytes;
+		pStats->cachedCount += pType->cachedCount;
+		if (type)
+			pStats->budgetBytes = pType->cacheBudget < resCache.budget ? pType->cacheBudget : resCache.budget;
 	}
+	if (!type)
+		pStats->budgetBytes = resCache.budget;
+	SDL_AtomicUnlock(&resCache.lock);
+}
+
+ASEXPORT void asResource_GetFileName(asResourceFileID_t id, const char ** ppName, int32_t * pNameLength)
+{
+	*ppName = _resourceLookup(id, NULL, NULL);
+	*pNameLength = *ppName ? (int32_t)strlen(*ppName) : 0;
+}
+
+ASEXPORT void asResource_IncrimentReferences(asResourceFileID_t id, uint32_t addRefCount)
+{
+	struct _resourceDat* pEntry = _resourceGet(id);
+	if (!pEntry)
+		return;
+	_resourceAddReferences(pEntry, addRefCount);
 }
 
 ASEXPORT void asResource_DeincrimentReferences(asResourceFileID_t id, uint32_t subRefCount)
 {
-	struct _resourceDat* res;
-	if (res = &hmget(resMap, id))
+	struct _resourceShard* pShard = _resourceShardFor(id);
+	struct _resourceDat* pEntry = _resourceGet(id);
+	if (!pEntry)
+		return;
+	for (;;)
 	{
-		if (res->references >= 0)
+		const int generation = SDL_AtomicGet(&pEntry->generation);
+		int current = SDL_AtomicGet(&pEntry->references);
+		if (current < 0)
+			return; /*Already released or cached*/
+		int next = current - (int)subRefCount;
+		if (next > 0)
 		{
-			if ((res->references -= subRefCount) <= 0)
+			if (SDL_AtomicCAS(&pEntry->references, current, next))
+				return;
+			continue;
+		}
+		/*The final release reads the type and mapping under the shard lock so a re-create can't replace them underneath it,
+		a re-create in between may have set the count back to the same value so the generation is checked too*/
+		bool released = false;
+		SDL_AtomicLock(&pShard->lock);
+		if (SDL_AtomicGet(&pEntry->generation) != generation)
+		{
+			SDL_AtomicUnlock(&pShard->lock);
+			return; /*The mapping these references were on has been replaced*/
+		}
+		if (SDL_AtomicGet(&pEntry->references) != current)
+		{
+			SDL_AtomicUnlock(&pShard->lock);
+			continue;
+		}
+		struct _resourceTypeInfo* pType = _resourceFindType(pEntry->type);
+		if (_resourceCacheable(pEntry, pType))
+		{
+			/*Keep it resident, the budget decides when it goes*/
+			SDL_AtomicLock(&resCache.lock);
+			if (SDL_AtomicCAS(&pEntry->references, current, AS_RESOURCE_CACHED_REFERENCES))
 			{
-				asResourceDataMapping_t* map;
-				if (map = hmget(resDeleteLists, res->type))
-				{
-					arrput(map, res->mapping);
-				}
-				res->references--; /*prevent multiple removals*/
+				_resourceCacheLink(pEntry, pType);
+				_resourceCacheTrim(pType);
+				released = true;
 			}
+			SDL_AtomicUnlock(&resCache.lock);
+		}
+		/*Only the thread that wins the swap to dead queues the removal*/
+		else if (SDL_AtomicCAS(&pEntry->references, current, AS_RESOURCE_DEAD_REFERENCES))
+		{
+			_resourcePushDeletion(pType, pEntry->mapping);
+			released = true;
 		}
+		SDL_AtomicUnlock(&pShard->lock);
+		if (released)
+			return;
 	}
 }
 
@@ -312,6 +934,20 @@ void _generateResourceEntires(const char* manifestPath)
 	}
 }
 
+/*Last write of a file (0 when missing)*/
+static int64_t _fileModifiedTime(const char* pPath)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(pPath, GetFileExInfoStandard, &data))
+		return 0;
+	return ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat info;
+	return stat(pPath, &info) ? 0 : (int64_t)info.st_mtime;
+#endif
+}
+
 /*Manager*/
 
 ASEXPORT void asInitResource()
@@ -322,27 +958,55 @@ ASEXPORT void asInitResource()
 		asDebugLog("Resource Path: %s", resourceDir);
 	}
 
-	/*Get Manifest Path*/
+	/*Get Manifest Paths*/
+	char binaryManifestPath[1024];
+	memset(binaryManifestPath, 0, 1024);
+	strncpy(binaryManifestPath, resourceDir, 1024 - 16);
+	strncat(binaryManifestPath, AS_RESOURCE_MANIFEST_NAME, 16);
 	char manifestPath[1024];
 	memset(manifestPath, 0, 1024);
 	strncpy(manifestPath, resourceDir, 1024-14);
-	strncat(manifestPath, "resources.cfg", 14);
-	asDebugLog("Resource Manifest: %s", manifestPath);
+	strncat(manifestPath, AS_RESOURCE_MANIFEST_CFG_NAME, 14);
 
 	/*Initialize Manager*/
-	struct _resourceDat defRes;
-	defRes.mapping.hndl = asHandle_Invalidate();
-	defRes.mapping.ptr = NULL;
-	defRes.references = 0;
-	defRes.type = 0;
-	hmdefault(resMap, defRes);
 	strpool_init(&resourceLookupPool.strPool, &strpool_default_config);
-	_generateResourceEntires(manifestPath);
+	/*The MANIFEST phase writes both, a text manifest newer than the binary one was edited or regenerated without it*/
+	const bool binaryStale = _fileModifiedTime(manifestPath) > _fileModifiedTime(binaryManifestPath);
+	if (binaryStale)
+		asDebugWarning("Resource Manifest: %s is older than %s (ignored)", binaryManifestPath, manifestPath);
+	if (!binaryStale && asResourceManifest_Open(&resourceLookupPool.manifest, binaryManifestPath) == AS_SUCCESS)
+	{
+		asDebugLog("Resource Manifest: %s", binaryManifestPath);
+	}
+	else
+	{
+		asDebugLog("Resource Manifest: %s", manifestPath);
+		resourceLookupPool.manifest = NULL;
+		_generateResourceEntires(manifestPath);
+	}
+
+	/*Cache Budget*/
+	if (asGetGlobalPrefs())
+	{
+		asPreferencesRegisterOpenSection(asGetGlobalPrefs(), "resource");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "cacheBudgetMB", &gResourceCacheBudgetMB, 0, 1024 * 64, true, NULL, NULL, "Memory in MB unreferenced resources may keep resident before eviction (Requires Restart)");
+		asPreferencesLoadSection(asGetGlobalPrefs(), "resource");
+	}
+	asResource_SetGlobalCacheBudget((size_t)gResourceCacheBudgetMB * 1024 * 1024);
+
+	asInitResourceAsyncIO();
+	asInitResourceTrace();
 }
 
 ASEXPORT void asShutdownResource()
 {
-	hmfree(resMap);
+	asShutdownResourceTrace();
+	asShutdownResourceAsyncIO();
+	_resourceShutdownRegistry();
+	_resourceShutdownTypes();
+	memset(&resCache, 0, sizeof(resCache));
+	asResourceManifest_Close(resourceLookupPool.manifest);
+	resourceLookupPool.manifest = NULL;
 	hmfree(resourceLookupPool.fileMap);
 	strpool_term(&resourceLookupPool.strPool);
 }
\ No newline at end of file
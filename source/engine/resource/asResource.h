@@ -58,6 +58,7 @@ typedef struct
 	FILE* _fileHndl;
 	int64_t _buffOffset;
 	int64_t _buffSize;
+	asResourceFileID_t _id; /*0 when opened by path (not traced)*/
 } asResourceLoader_t;
 
 /**
@@ -70,6 +71,12 @@ ASEXPORT asResults asResourceLoader_Open(asResourceLoader_t* loader, asResourceF
 */
 ASEXPORT asResults asResourceLoader_OpenByPath(asResourceLoader_t* loader, asResourceFileID_t* pId, char* path, size_t pathLength);
 
+/**
+* @brief Open a byte range of a file by full path (used for packages and tools)
+* @param size size of the range (negative reads to the end of the file)
+*/
+ASEXPORT asResults asResourceLoader_OpenFileRange(asResourceLoader_t* loader, const char* pFullPath, int64_t start, int64_t size);
+
 /**
 * @brief Release the file
 */
@@ -100,6 +107,36 @@ ASEXPORT asResults asResourceLoader_Read(asResourceLoader_t* loader, size_t size
 */
 ASEXPORT asResults asResourceLoader_ReadAll(asResourceLoader_t* loader, size_t size, void* buff);
 
+/**
+* @brief a read only view of a resource file mapped into memory (no copies are made when reading)
+*/
+typedef struct
+{
+	const void* pData; /**< Start of the resource contents*/
+	size_t size; /**< Size of the resource contents*/
+	void* _pMapped;
+	size_t _mappedSize;
+	void* _hFile;
+	void* _hMapping;
+} asResourceFileView_t;
+
+/**
+* @brief Map a resource file into memory (abstacts into the package system)
+* pages are read by the OS on first access
+*/
+ASEXPORT asResults asResourceFileView_Open(asResourceFileView_t* pView, asResourceFileID_t id);
+
+/**
+* @brief Map a byte range of a file by full path (used for packages and tools)
+* @param size size of the range (negative maps to the end of the file)
+*/
+ASEXPORT asResults asResourceFileView_OpenFileRange(asResourceFileView_t* pView, const char* pFullPath, int64_t start, int64_t size);
+
+/**
+* @brief Unmap the file, pointers into the view are invalid afterwards
+*/
+ASEXPORT void asResourceFileView_Close(asResourceFileView_t* pView);
+
 /**
 * @brief Maps to data associated with a resource
 */
@@ -111,15 +148,37 @@ typedef struct
 
 /**
 * @brief Set the mapping for the data associated with the resource
+* initialRefs may be 0, the resource then stays resident until the first release
+* thread safe, replaces (and revives) any existing mapping for the id
+* @warning resources created without a size are never cached
 */
 ASEXPORT void asResource_Create(asResourceFileID_t id, asResourceDataMapping_t mapping, asHash32_t type, int32_t initialRefs);
 
+/**
+* @brief Set the mapping for the data associated with the resource along with its resident size
+* once released the resource stays in the cache until its type or the global budget is exceeded
+* only types given a budget with asResource_SetCacheBudget() are cached (the engine only budgets "ASFX" shaders),
+* every other type is queued for deletion on release exactly like asResource_Create()
+* thread safe, replaces (and revives) any existing mapping for the id
+*/
+ASEXPORT void asResource_CreateSized(asResourceFileID_t id, asResourceDataMapping_t mapping, asHash32_t type, int32_t initialRefs, size_t size);
+
 /**
 * @brief Get a data handle for an already loaded resource
-* Returns invalid handle if no handle is associated
+* Returns invalid handle if no handle is associated (or it was released)
+* thread safe
+* @warning a cached resource may be evicted before references are added, prefer asResource_AcquireExistingDataMapping()
 */
 ASEXPORT asResourceDataMapping_t asResource_GetExistingDataMapping(asResourceFileID_t id, asHash32_t requiredType);
 
+/**
+* @brief Get a data handle for an already loaded resource and add references to it in one step
+* Unreferenced resources are taken back out of the cache
+* Returns invalid handle (and adds nothing) if no handle is associated (or it was released)
+* thread safe
+*/
+ASEXPORT asResourceDataMapping_t asResource_AcquireExistingDataMapping(asResourceFileID_t id, asHash32_t requiredType, uint32_t addRefCount);
+
 /**
 * @brief Get the filename as a null terminated string
 * Returns null if no handle is associated
@@ -128,11 +187,13 @@ ASEXPORT void asResource_GetFileName(asResourceFileID_t id, const char** ppName,
 
 /**
 * @brief Incriment the references to a resource
+* thread safe (atomic), does nothing once the resource has been released
 */
 ASEXPORT void asResource_IncrimentReferences(asResourceFileID_t id, uint32_t addRefCount);
 
 /**
 * @brief Deincriment the references to a resource
+* thread safe (atomic), when references reach zero the mapping is either cached or queued for deletion (exactly once)
 */
 ASEXPORT void asResource_DeincrimentReferences(asResourceFileID_t id, uint32_t subRefCount);
 
@@ -142,6 +203,7 @@ ASEXPORT void asResource_DeincrimentReferences(asResourceFileID_t id, uint32_t s
 ASEXPORT asResourceType_t asResource_RegisterType(const char* typeName, size_t strSize);
 /**
 * @brief Get deletion queue by type
+* any thread may release resources, but only one thread may consume each type's queue
 */
 ASEXPORT size_t asResource_GetDeletionQueue(asResourceType_t type, size_t* pCount, asResourceDataMapping_t** ppMappings);
 
@@ -150,6 +212,42 @@ ASEXPORT size_t asResource_GetDeletionQueue(asResourceType_t type, size_t* pCoun
 */
 ASEXPORT void asResource_ClearDeletionQueue(asResourceType_t type);
 
+/**
+* @brief Resource cache statistics
+*/
+typedef struct
+{
+	uint64_t hits; /**< Lookups that found a referenced resource*/
+	uint64_t cacheHits; /**< Lookups that found an unreferenced resource still in the cache*/
+	uint64_t misses; /**< Lookups that found nothing (the caller has to load it)*/
+	uint64_t evictions; /**< Cached resources handed to the deletion queue to stay under budget*/
+	uint64_t cachedBytes; /**< Bytes currently held by unreferenced resources*/
+	uint64_t cachedCount; /**< Unreferenced resources currently held*/
+	uint64_t budgetBytes; /**< Effective budget*/
+} asResourceCacheStats_t;
+
+/**
+* @brief Set the budget for unreferenced resources of a type
+* 0 (the default) disables caching for the type, the global budget always applies as well
+*/
+ASEXPORT void asResource_SetCacheBudget(asResourceType_t type, size_t budgetBytes);
+
+/**
+* @brief Set the budget for all unreferenced resources (0 disables the cache)
+* initialized from the "resource" preferences
+*/
+ASEXPORT void asResource_SetGlobalCacheBudget(size_t budgetBytes);
+
+/**
+* @brief Evict every cached resource of a type (0 for all types) into the deletion queues
+*/
+ASEXPORT void asResource_FlushCache(asResourceType_t type);
+
+/**
+* @brief Get cache statistics for a type (0 for all types)
+*/
+ASEXPORT void asResource_GetCacheStats(asResourceType_t type, asResourceCacheStats_t* pStats);
+
 #ifdef __cplusplus
 }
 #endif
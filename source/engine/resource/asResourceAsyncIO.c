@@ -0,0 +1,726 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /*O_DIRECT*/
+#endif
+#include "asResourceAsyncIO.h"
+#include "asResourceTrace.h"
+#include "../thread/asJobSystem.h"
+#include "../common/preferences/asPreferences.h"
+
+#include <SDL_thread.h>
+#include <SDL_atomic.h>
+
+#include "stb/stb_ds.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define AS_IO_URING_SUPPORTED 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+#define AS_IO_URING_ENTRIES 256
+#define AS_IO_MAX_SINGLE_READ 0x7FFFF000 /*Largest single read Linux will service*/
+
+int32_t gIoUseIoUring = 1;
+int32_t gIoDirectIO = 0;
+int32_t gIoDirectIOMinKB = 1024;
+
+struct _readOp
+{
+	asResourceReadRequest_t* pRequest;
+	asResourceReadBatch batch;
+	uint64_t fileOffset;
+	size_t completed;
+	int fd;
+	int32_t bufferIndex;
+	bool direct;
+};
+
+struct _directFile
+{
+	FILE* fp;
+	int fd;
+};
+
+struct asResourceReadBatchT
+{
+	asResourceAsyncIOBackend backend;
+	SDL_atomic_t remaining;
+	asJobCounter counter;
+	struct _directFile* pDirectFiles; /*stb_ds array*/
+	size_t opCount;
+	struct _readOp* pOps;
+};
+
+struct
+{
+	asResourceAsyncIOBackend backend;
+	bool directIO;
+	size_t directIOMinSize;
+	SDL_mutex* pLock;
+} asyncIO;
+
+/*Positional Reads (Job System Backend)*/
+
+static asResults _positionalRead(FILE* fp, uint64_t offset, size_t size, void* pDest)
+{
+	uint8_t* pDst = (uint8_t*)pDest;
+#ifdef _WIN32
+	HANDLE hndl = (HANDLE)_get_osfhandle(_fileno(fp));
+	while (size)
+	{
+		DWORD chunk = size > AS_IO_MAX_SINGLE_READ ? AS_IO_MAX_SINGLE_READ : (DWORD)size;
+		DWORD bytesRead = 0;
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		if (!ReadFile(hndl, pDst, chunk, &bytesRead, &overlapped))
+			return AS_FAILURE_FILE_INACCESSIBLE;
+		if (!bytesRead)
+			return AS_FAILURE_OUT_OF_BOUNDS;
+		pDst += bytesRead;
+		offset += bytesRead;
+		size -= bytesRead;
+	}
+#else
+	int fd = fileno(fp);
+	while (size)
+	{
+		size_t chunk = size > AS_IO_MAX_SINGLE_READ ? AS_IO_MAX_SINGLE_READ : size;
+		ssize_t bytesRead = pread(fd, pDst, chunk, (off_t)offset);
+		if (bytesRead < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return AS_FAILURE_FILE_INACCESSIBLE;
+		}
+		if (!bytesRead)
+			return AS_FAILURE_OUT_OF_BOUNDS;
+		pDst += bytesRead;
+		offset += (uint64_t)bytesRead;
+		size -= (size_t)bytesRead;
+	}
+#endif
+	return AS_SUCCESS;
+}
+
+static void _readOpFinish(struct _readOp* pOp, asResults result)
+{
+	pOp->pRequest->result = result;
+	SDL_AtomicAdd(&pOp->batch->remaining, -1);
+}
+
+static void _readOpJob(void* pUserData)
+{
+	struct _readOp* pOp = (struct _readOp*)pUserData;
+	_readOpFinish(pOp, _positionalRead(pOp->pRequest->pLoader->_fileHndl,
+		pOp->fileOffset, pOp->pRequest->size, pOp->pRequest->pDest));
+}
+
+/*io_uring Backend*/
+
+#if AS_IO_URING_SUPPORTED
+struct
+{
+	int fd;
+	uint32_t sqEntries;
+	uint32_t cqEntries;
+	uint32_t* pSqHead;
+	uint32_t* pSqTail;
+	uint32_t* pSqMask;
+	uint32_t* pSqArray;
+	uint32_t* pCqHead;
+	uint32_t* pCqTail;
+	uint32_t* pCqMask;
+	struct io_uring_sqe* pSqes;
+	struct io_uring_cqe* pCqes;
+	void* pSqRingMap;
+	size_t sqRingMapSize;
+	void* pCqRingMap;
+	size_t cqRingMapSize;
+	size_t sqesMapSize;
+	uint32_t unsubmitted;
+	uint32_t inFlight;
+	struct _readOp** pPending; /*stb_ds array used as a fifo*/
+	size_t pendingCursor;
+	struct iovec* pRegisteredBuffers; /*stb_ds array*/
+	bool failed; /*io_uring_enter stopped working, only completions of reads already in flight are reaped*/
+} ioUring = { .fd = -1 };
+
+static void _ioUringShutdown()
+{
+	if (ioUring.fd < 0)
+		return;
+	if (ioUring.pSqes)
+		munmap(ioUring.pSqes, ioUring.sqesMapSize);
+	if (ioUring.pCqRingMap && ioUring.pCqRingMap != ioUring.pSqRingMap)
+		munmap(ioUring.pCqRingMap, ioUring.cqRingMapSize);
+	if (ioUring.pSqRingMap)
+		munmap(ioUring.pSqRingMap, ioUring.sqRingMapSize);
+	close(ioUring.fd);
+	arrfree(ioUring.pPending);
+	arrfree(ioUring.pRegisteredBuffers);
+	memset(&ioUring, 0, sizeof(ioUring));
+	ioUring.fd = -1;
+}
+
+static asResults _ioUringInit(uint32_t entries)
+{
+	if (ioUring.fd >= 0)
+		return AS_SUCCESS;
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if (fd < 0)
+	{
+		asDebugWarning("io_uring unavailable (errno %d)", errno);
+		return AS_FAILURE_UNSUPPORTED_HARDWARE;
+	}
+	ioUring.fd = fd;
+	ioUring.sqEntries = params.sq_entries;
+	ioUring.cqEntries = params.cq_entries;
+
+	/*Map rings*/
+	ioUring.sqRingMapSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	ioUring.cqRingMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap)
+	{
+		if (ioUring.cqRingMapSize > ioUring.sqRingMapSize)
+			ioUring.sqRingMapSize = ioUring.cqRingMapSize;
+		ioUring.cqRingMapSize = ioUring.sqRingMapSize;
+	}
+	ioUring.pSqRingMap = mmap(NULL, ioUring.sqRingMapSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (ioUring.pSqRingMap == MAP_FAILED)
+	{
+		ioUring.pSqRingMap = NULL;
+		_ioUringShutdown();
+		return AS_FAILURE_UNSUPPORTED_HARDWARE;
+	}
+	if (singleMap)
+	{
+		ioUring.pCqRingMap = ioUring.pSqRingMap;
+	}
+	else
+	{
+		ioUring.pCqRingMap = mmap(NULL, ioUring.cqRingMapSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (ioUring.pCqRingMap == MAP_FAILED)
+		{
+			ioUring.pCqRingMap = NULL;
+			_ioUringShutdown();
+			return AS_FAILURE_UNSUPPORTED_HARDWARE;
+		}
+	}
+	ioUring.sqesMapSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	ioUring.pSqes = mmap(NULL, ioUring.sqesMapSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (ioUring.pSqes == MAP_FAILED)
+	{
+		ioUring.pSqes = NULL;
+		_ioUringShutdown();
+		return AS_FAILURE_UNSUPPORTED_HARDWARE;
+	}
+
+	uint8_t* pSq = (uint8_t*)ioUring.pSqRingMap;
+	ioUring.pSqHead = (uint32_t*)(pSq + params.sq_off.head);
+	ioUring.pSqTail = (uint32_t*)(pSq + params.sq_off.tail);
+	ioUring.pSqMask = (uint32_t*)(pSq + params.sq_off.ring_mask);
+	ioUring.pSqArray = (uint32_t*)(pSq + params.sq_off.array);
+	uint8_t* pCq = (uint8_t*)ioUring.pCqRingMap;
+	ioUring.pCqHead = (uint32_t*)(pCq + params.cq_off.head);
+	ioUring.pCqTail = (uint32_t*)(pCq + params.cq_off.tail);
+	ioUring.pCqMask = (uint32_t*)(pCq + params.cq_off.ring_mask);
+	ioUring.pCqes = (struct io_uring_cqe*)(pCq + params.cq_off.cqes);
+	asDebugLog("io_uring initialized (%u entries)", ioUring.sqEntries);
+	return AS_SUCCESS;
+}
+
+static int32_t _ioUringFindRegisteredBuffer(void* pDest, size_t size)
+{
+	for (int32_t i = 0; i < (int32_t)arrlen(ioUring.pRegisteredBuffers); i++)
+	{
+		uint8_t* pStart = (uint8_t*)ioUring.pRegisteredBuffers[i].iov_base;
+		if ((uint8_t*)pDest >= pStart &&
+			(uint8_t*)pDest + size <= pStart + ioUring.pRegisteredBuffers[i].iov_len)
+			return i;
+	}
+	return -1;
+}
+
+static bool _ioUringQueueOp(struct _readOp* pOp)
+{
+	uint32_t tail = *ioUring.pSqTail;
+	uint32_t head = __atomic_load_n(ioUring.pSqHead, __ATOMIC_ACQUIRE);
+	if (tail - head >= ioUring.sqEntries)
+		return false;
+	/*Never allow more in flight than the completion ring can hold*/
+	if (ioUring.inFlight + ioUring.unsubmitted >= ioUring.cqEntries)
+		return false;
+
+	size_t remaining = pOp->pRequest->size - pOp->completed;
+	if (remaining > AS_IO_MAX_SINGLE_READ)
+		remaining = AS_IO_MAX_SINGLE_READ;
+	uint32_t idx = tail & *ioUring.pSqMask;
+	struct io_uring_sqe* pSqe = &ioUring.pSqes[idx];
+	memset(pSqe, 0, sizeof(*pSqe));
+	pSqe->fd = pOp->fd;
+	pSqe->off = pOp->fileOffset + pOp->completed;
+	pSqe->addr = (uint64_t)(uintptr_t)((uint8_t*)pOp->pRequest->pDest + pOp->completed);
+	pSqe->len = (uint32_t)remaining;
+	pSqe->user_data = (uint64_t)(uintptr_t)pOp;
+	if (pOp->bufferIndex >= 0)
+	{
+		pSqe->opcode = IORING_OP_READ_FIXED;
+		pSqe->buf_index = (uint16_t)pOp->bufferIndex;
+	}
+	else
+	{
+		pSqe->opcode = IORING_OP_READ;
+	}
+	ioUring.pSqArray[idx] = idx;
+	__atomic_store_n(ioUring.pSqTail, tail + 1, __ATOMIC_RELEASE);
+	ioUring.unsubmitted++;
+	return true;
+}
+
+static void _ioUringCompleteOp(struct _readOp* pOp, int32_t res)
+{
+	if (res == -EAGAIN || res == -EINTR)
+	{
+		arrput(ioUring.pPending, pOp);
+		return;
+	}
+	if (res == -EINVAL && pOp->direct)
+	{
+		/*Filesystem rejected the direct read, retry through the page cache*/
+		pOp->direct = false;
+		pOp->fd = fileno(pOp->pRequest->pLoader->_fileHndl);
+		arrput(ioUring.pPending, pOp);
+		return;
+	}
+	if (res < 0)
+	{
+		_readOpFinish(pOp, AS_FAILURE_FILE_INACCESSIBLE);
+		return;
+	}
+	if (res == 0)
+	{
+		_readOpFinish(pOp, AS_FAILURE_OUT_OF_BOUNDS);
+		return;
+	}
+	pOp->completed += (size_t)res;
+	if (pOp->completed < pOp->pRequest->size)
+	{
+		/*Short read, direct reads need aligned remainders*/
+		if (pOp->direct && (pOp->completed % AS_RESOURCE_DIRECT_IO_ALIGNMENT))
+		{
+			pOp->direct = false;
+			pOp->fd = fileno(pOp->pRequest->pLoader->_fileHndl);
+		}
+		arrput(ioUring.pPending, pOp);
+		return;
+	}
+	_readOpFinish(pOp, AS_SUCCESS);
+}
+
+/*Reads the ring can no longer submit finish on the calling thread with positional reads (the job system path)*/
+static void _ioUringFallbackOp(struct _readOp* pOp)
+{
+	_readOpFinish(pOp, _positionalRead(pOp->pRequest->pLoader->_fileHndl, pOp->fileOffset + pOp->completed,
+		pOp->pRequest->size - pOp->completed, (uint8_t*)pOp->pRequest->pDest + pOp->completed));
+}
+
+/*io_uring_enter failed for good: take back what was queued and stop giving new batches to io_uring,
+reads already in flight still complete through the completion ring*/
+static void _ioUringAbandonQueued()
+{
+	uint32_t tail = *ioUring.pSqTail;
+	for (uint32_t i = 0; i < ioUring.unsubmitted; i++)
+	{
+		struct io_uring_sqe* pSqe = &ioUring.pSqes[(tail - 1 - i) & *ioUring.pSqMask];
+		_ioUringFallbackOp((struct _readOp*)(uintptr_t)pSqe->user_data);
+	}
+	__atomic_store_n(ioUring.pSqTail, tail - ioUring.unsubmitted, __ATOMIC_RELEASE);
+	ioUring.unsubmitted = 0;
+	for (size_t i = ioUring.pendingCursor; i < (size_t)arrlen(ioUring.pPending); i++)
+		_ioUringFallbackOp(ioUring.pPending[i]);
+	arrsetlen(ioUring.pPending, 0);
+	ioUring.pendingCursor = 0;
+	ioUring.failed = true;
+	asyncIO.backend = AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM;
+}
+
+/*Must be called with the async io lock held*/
+static void _ioUringPump(bool wait)
+{
+	/*Fill the submission ring from pending reads*/
+	if (ioUring.failed)
+		_ioUringAbandonQueued();
+	while (!ioUring.failed && ioUring.pendingCursor < (size_t)arrlen(ioUring.pPending))
+	{
+		if (!_ioUringQueueOp(ioUring.pPending[ioUring.pendingCursor]))
+			break;
+		ioUring.pendingCursor++;
+	}
+	if (ioUring.pendingCursor == (size_t)arrlen(ioUring.pPending))
+	{
+		arrsetlen(ioUring.pPending, 0);
+		ioUring.pendingCursor = 0;
+	}
+
+	/*Submit (and optionally wait)*/
+	unsigned flags = 0;
+	unsigned minComplete = 0;
+	if (wait && (ioUring.inFlight + ioUring.unsubmitted))
+	{
+		flags = IORING_ENTER_GETEVENTS;
+		minComplete = 1;
+	}
+	if (!ioUring.failed && (ioUring.unsubmitted || flags))
+	{
+		int submitted = (int)syscall(__NR_io_uring_enter, ioUring.fd, ioUring.unsubmitted, minComplete, flags, NULL, 0);
+		if (submitted >= 0)
+		{
+			ioUring.unsubmitted -= (uint32_t)submitted;
+			ioUring.inFlight += (uint32_t)submitted;
+		}
+		else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+		{
+			asDebugWarning("io_uring_enter failed (errno %d), falling back to the job system", errno);
+			_ioUringAbandonQueued();
+		}
+	}
+
+	/*Reap completions*/
+	uint32_t head = *ioUring.pCqHead;
+	while (head != __atomic_load_n(ioUring.pCqTail, __ATOMIC_ACQUIRE))
+	{
+		struct io_uring_cqe* pCqe = &ioUring.pCqes[head & *ioUring.pCqMask];
+		struct _readOp* pOp = (struct _readOp*)(uintptr_t)pCqe->user_data;
+		int32_t res = pCqe->res;
+		head++;
+		ioUring.inFlight--;
+		_ioUringCompleteOp(pOp, res);
+	}
+	__atomic_store_n(ioUring.pCqHead, head, __ATOMIC_RELEASE);
+}
+
+static int _batchGetDirectFd(asResourceReadBatch batch, FILE* fp)
+{
+	for (size_t i = 0; i < (size_t)arrlen(batch->pDirectFiles); i++)
+	{
+		if (batch->pDirectFiles[i].fp == fp)
+			return batch->pDirectFiles[i].fd;
+	}
+	/*Reopen the same file without the page cache*/
+	char procPath[64];
+	snprintf(procPath, 64, "/proc/self/fd/%d", fileno(fp));
+	struct _directFile directFile;
+	directFile.fp = fp;
+	directFile.fd = open(procPath, O_RDONLY | O_DIRECT);
+	arrput(batch->pDirectFiles, directFile);
+	return directFile.fd;
+}
+#endif
+
+/*Interface*/
+
+static void _asyncIOEnsureLock()
+{
+	if (!asyncIO.pLock)
+	{
+		asyncIO.pLock = SDL_CreateMutex();
+		if (!asyncIO.pLock)
+			asFatalError("Failed to create async io lock", -1);
+	}
+}
+
+ASEXPORT asResults asResourceAsyncIO_SetBackend(asResourceAsyncIOBackend backend)
+{
+	_asyncIOEnsureLock();
+	if (backend == AS_RESOURCE_ASYNCIO_BACKEND_IO_URING)
+	{
+#if AS_IO_URING_SUPPORTED
+		if (_ioUringInit(AS_IO_URING_ENTRIES) == AS_SUCCESS && !ioUring.failed)
+		{
+			asyncIO.backend = backend;
+			return AS_SUCCESS;
+		}
+#endif
+		asyncIO.backend = AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM;
+		return AS_FAILURE_UNSUPPORTED_HARDWARE;
+	}
+	asyncIO.backend = AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResourceAsyncIOBackend asResourceAsyncIO_GetBackend()
+{
+	return asyncIO.backend;
+}
+
+ASEXPORT void asResourceAsyncIO_SetDirectIO(bool enable, size_t minSize)
+{
+	asyncIO.directIO = enable;
+	asyncIO.directIOMinSize = minSize < AS_RESOURCE_DIRECT_IO_ALIGNMENT ? AS_RESOURCE_DIRECT_IO_ALIGNMENT : minSize;
+}
+
+ASEXPORT asResults asResourceAsyncIO_RegisterBuffers(void** ppBuffers, size_t* pSizes, size_t count)
+{
+#if AS_IO_URING_SUPPORTED
+	if (ioUring.fd < 0)
+		return AS_SUCCESS;
+	asResourceAsyncIO_UnregisterBuffers();
+	for (size_t i = 0; i < count; i++)
+	{
+		struct iovec vec;
+		vec.iov_base = ppBuffers[i];
+		vec.iov_len = pSizes[i];
+		arrput(ioUring.pRegisteredBuffers, vec);
+	}
+	if (syscall(__NR_io_uring_register, ioUring.fd, IORING_REGISTER_BUFFERS,
+		ioUring.pRegisteredBuffers, (unsigned)count) < 0)
+	{
+		asDebugWarning("io_uring buffer registration failed (errno %d)", errno);
+		arrsetlen(ioUring.pRegisteredBuffers, 0);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+#endif
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asResourceAsyncIO_UnregisterBuffers()
+{
+#if AS_IO_URING_SUPPORTED
+	if (ioUring.fd < 0 || !arrlen(ioUring.pRegisteredBuffers))
+		return;
+	syscall(__NR_io_uring_register, ioUring.fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+	arrsetlen(ioUring.pRegisteredBuffers, 0);
+#endif
+}
+
+ASEXPORT void* asResourceAsyncIO_AllocAligned(size_t size)
+{
+#ifdef _WIN32
+	return _aligned_malloc(size, AS_RESOURCE_DIRECT_IO_ALIGNMENT);
+#else
+	void* pBuffer = NULL;
+	if (posix_memalign(&pBuffer, AS_RESOURCE_DIRECT_IO_ALIGNMENT, size))
+		return NULL;
+	return pBuffer;
+#endif
+}
+
+ASEXPORT void asResourceAsyncIO_FreeAligned(void* pBuffer)
+{
+#ifdef _WIN32
+	_aligned_free(pBuffer);
+#else
+	free(pBuffer);
+#endif
+}
+
+ASEXPORT asResults asResourceReadBatch_Submit(asResourceReadRequest_t* pRequests, size_t count, asResourceReadBatch* pBatch)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!pRequests[i].pLoader || !pRequests[i].pLoader->_fileHndl || (!pRequests[i].pDest && pRequests[i].size))
+			return AS_FAILURE_INVALID_PARAM;
+		if (pRequests[i].offset + pRequests[i].size > asResourceLoader_GetContentSize(pRequests[i].pLoader))
+			return AS_FAILURE_OUT_OF_BOUNDS;
+	}
+	for (size_t i = 0; i < count; i++)
+		asResourceTrace_Record(pRequests[i].pLoader->_id, pRequests[i].offset, pRequests[i].size);
+
+	asResourceReadBatch batch = asMalloc(sizeof(struct asResourceReadBatchT) + sizeof(struct _readOp) * count);
+	if (!batch)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	memset(batch, 0, sizeof(struct asResourceReadBatchT));
+	batch->backend = asyncIO.backend;
+	batch->opCount = count;
+	batch->pOps = (struct _readOp*)(batch + 1);
+	SDL_AtomicSet(&batch->remaining, (int)count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		struct _readOp* pOp = &batch->pOps[i];
+		pOp->pRequest = &pRequests[i];
+		pOp->batch = batch;
+		pOp->fileOffset = (uint64_t)pRequests[i].pLoader->_buffOffset + pRequests[i].offset;
+		pOp->completed = 0;
+		pOp->fd = -1;
+		pOp->bufferIndex = -1;
+		pOp->direct = false;
+		pRequests[i].result = AS_FAILURE_UNKNOWN;
+	}
+
+#if AS_IO_URING_SUPPORTED
+	if (batch->backend == AS_RESOURCE_ASYNCIO_BACKEND_IO_URING)
+	{
+		SDL_LockMutex(asyncIO.pLock);
+		for (size_t i = 0; i < count; i++)
+		{
+			struct _readOp* pOp = &batch->pOps[i];
+			if (!pOp->pRequest->size)
+			{
+				_readOpFinish(pOp, AS_SUCCESS);
+				continue;
+			}
+			pOp->fd = fileno(pOp->pRequest->pLoader->_fileHndl);
+			if (asyncIO.directIO && !(pOp->pRequest->flags & AS_RESOURCE_READ_FLAG_CACHED) &&
+				pOp->pRequest->size >= asyncIO.directIOMinSize &&
+				!(pOp->fileOffset % AS_RESOURCE_DIRECT_IO_ALIGNMENT) &&
+				!(pOp->pRequest->size % AS_RESOURCE_DIRECT_IO_ALIGNMENT) &&
+				!((uintptr_t)pOp->pRequest->pDest % AS_RESOURCE_DIRECT_IO_ALIGNMENT))
+			{
+				int directFd = _batchGetDirectFd(batch, pOp->pRequest->pLoader->_fileHndl);
+				if (directFd >= 0)
+				{
+					pOp->fd = directFd;
+					pOp->direct = true;
+				}
+			}
+			pOp->bufferIndex = _ioUringFindRegisteredBuffer(pOp->pRequest->pDest, pOp->pRequest->size);
+			arrput(ioUring.pPending, pOp);
+		}
+		_ioUringPump(false);
+		SDL_UnlockMutex(asyncIO.pLock);
+		*pBatch = batch;
+		return AS_SUCCESS;
+	}
+#endif
+
+	/*Job system fallback*/
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * (count ? count : 1));
+	if (!pJobs || asJobSystem_CreateCounter(&batch->counter) != AS_SUCCESS)
+	{
+		asFree(pJobs);
+		asFree(batch);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		pJobs[i].fpEntry = _readOpJob;
+		pJobs[i].pUserData = &batch->pOps[i];
+	}
+	asResults result = asJobSystem_Dispatch(pJobs, count, batch->counter);
+	asFree(pJobs);
+	if (result != AS_SUCCESS)
+	{
+		asJobSystem_ReleaseCounter(batch->counter);
+		asFree(batch);
+		return result;
+	}
+	*pBatch = batch;
+	return AS_SUCCESS;
+}
+
+ASEXPORT bool asResourceReadBatch_IsComplete(asResourceReadBatch batch)
+{
+#if AS_IO_URING_SUPPORTED
+	if (batch->backend == AS_RESOURCE_ASYNCIO_BACKEND_IO_URING && SDL_AtomicGet(&batch->remaining) > 0)
+	{
+		if (SDL_TryLockMutex(asyncIO.pLock) == 0)
+		{
+			_ioUringPump(false);
+			SDL_UnlockMutex(asyncIO.pLock);
+		}
+	}
+#endif
+	return SDL_AtomicGet(&batch->remaining) <= 0;
+}
+
+ASEXPORT asResults asResourceReadBatch_Wait(asResourceReadBatch batch)
+{
+#if AS_IO_URING_SUPPORTED
+	if (batch->backend == AS_RESOURCE_ASYNCIO_BACKEND_IO_URING)
+	{
+		while (SDL_AtomicGet(&batch->remaining) > 0)
+		{
+			SDL_LockMutex(asyncIO.pLock);
+			if (SDL_AtomicGet(&batch->remaining) > 0)
+				_ioUringPump(true);
+			SDL_UnlockMutex(asyncIO.pLock);
+		}
+	}
+#endif
+	if (batch->counter)
+		asJobSystem_WaitForCounter(batch->counter);
+
+	for (size_t i = 0; i < batch->opCount; i++)
+	{
+		if (batch->pOps[i].pRequest->result != AS_SUCCESS)
+			return batch->pOps[i].pRequest->result;
+	}
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asResourceReadBatch_Release(asResourceReadBatch batch)
+{
+	if (!batch)
+		return;
+	asResourceReadBatch_Wait(batch);
+	if (batch->counter)
+		asJobSystem_ReleaseCounter(batch->counter);
+#ifndef _WIN32
+	for (size_t i = 0; i < (size_t)arrlen(batch->pDirectFiles); i++)
+	{
+		if (batch->pDirectFiles[i].fd >= 0)
+			close(batch->pDirectFiles[i].fd);
+	}
+#endif
+	arrfree(batch->pDirectFiles);
+	asFree(batch);
+}
+
+ASEXPORT void asInitResourceAsyncIO()
+{
+	_asyncIOEnsureLock();
+	if (asGetGlobalPrefs())
+	{
+		asPreferencesRegisterOpenSection(asGetGlobalPrefs(), "io");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "useIoUring", &gIoUseIoUring, 0, 1, true, NULL, NULL, "Use io_uring for async reads where available (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "directIO", &gIoDirectIO, 0, 1, true, NULL, NULL, "Bypass the page cache for large aligned reads (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "directIOMinKB", &gIoDirectIOMinKB, 4, 1024 * 1024, true, NULL, NULL, "Smallest read in KB that may bypass the page cache (Requires Restart)");
+		asPreferencesLoadSection(asGetGlobalPrefs(), "io");
+	}
+	asResourceAsyncIO_SetDirectIO(gIoDirectIO != 0, (size_t)gIoDirectIOMinKB * 1024);
+	if (gIoUseIoUring)
+	{
+		if (asResourceAsyncIO_SetBackend(AS_RESOURCE_ASYNCIO_BACKEND_IO_URING) == AS_SUCCESS)
+		{
+			asDebugLog("Async IO Backend: %s", "io_uring");
+			return;
+		}
+	}
+	asResourceAsyncIO_SetBackend(AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM);
+	asDebugLog("Async IO Backend: %s", "job system");
+}
+
+ASEXPORT void asShutdownResourceAsyncIO()
+{
+#if AS_IO_URING_SUPPORTED
+	_ioUringShutdown();
+#endif
+	asyncIO.backend = AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM;
+	if (asyncIO.pLock)
+	{
+		SDL_DestroyMutex(asyncIO.pLock);
+		asyncIO.pLock = NULL;
+	}
+}
@@ -0,0 +1,132 @@
+#ifndef _ASRESOURCEASYNCIO_H_
+#define _ASRESOURCEASYNCIO_H_
+
+#include "../common/asCommon.h"
+#include "asResource.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Batched asynchronous reads from opened resource loaders
+* Linux uses io_uring when available, everything else falls back to the job system
+*/
+
+/**
+* @brief alignment required of offsets, sizes and buffers for direct (uncached) reads
+*/
+#define AS_RESOURCE_DIRECT_IO_ALIGNMENT 4096
+
+/**
+* @brief Async IO backends
+*/
+typedef enum {
+	AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM, /**< Blocking positional reads on the job system workers*/
+	AS_RESOURCE_ASYNCIO_BACKEND_IO_URING, /**< Linux io_uring submission/completion rings*/
+	AS_RESOURCE_ASYNCIO_BACKEND_COUNT,
+	AS_RESOURCE_ASYNCIO_BACKEND_MAX = UINT32_MAX
+} asResourceAsyncIOBackend;
+
+/**
+* @brief Read hints
+*/
+typedef enum {
+	AS_RESOURCE_READ_FLAG_CACHED = 1 << 0, /**< Never bypass the page cache (reads meant to warm it)*/
+	AS_RESOURCE_READ_FLAG_MAX = UINT32_MAX
+} asResourceReadFlags;
+
+/**
+* @brief A single read in a batch
+*/
+typedef struct {
+	asResourceLoader_t* pLoader; /**< Opened loader to read from (must remain open until the batch is complete)*/
+	size_t offset; /**< Offset relative to the start of the resource*/
+	size_t size; /**< Bytes to read*/
+	void* pDest; /**< Destination buffer*/
+	asResults result; /**< Written once the read is complete*/
+	uint32_t flags; /**< asResourceReadFlags*/
+} asResourceReadRequest_t;
+
+/**
+* @brief an opaque handle to a group of reads in flight
+*/
+typedef struct asResourceReadBatchT* asResourceReadBatch;
+
+/**
+* @brief Initializes async IO using the "io" preferences
+* @warning The resource manager init should handle this for you
+*/
+ASEXPORT void asInitResourceAsyncIO();
+
+/**
+* @brief Shutdown async IO
+* @warning The resource manager shutdown should handle this for you
+*/
+ASEXPORT void asShutdownResourceAsyncIO();
+
+/**
+* @brief Switch backend (no batches may be in flight)
+* returns AS_FAILURE_UNSUPPORTED_HARDWARE and stays on the job system if the backend is unavailable
+*/
+ASEXPORT asResults asResourceAsyncIO_SetBackend(asResourceAsyncIOBackend backend);
+
+/**
+* @brief Get the active backend
+*/
+ASEXPORT asResourceAsyncIOBackend asResourceAsyncIO_GetBackend();
+
+/**
+* @brief Allow uncached reads for large aligned requests (bypasses the page cache where supported)
+* @param minSize requests smaller than this always use cached reads
+*/
+ASEXPORT void asResourceAsyncIO_SetDirectIO(bool enable, size_t minSize);
+
+/**
+* @brief Register long lived destination buffers with the kernel (replaces any previously registered)
+* reads landing entirely inside a registered buffer skip per-request page pinning
+* @warning no batches may be in flight, does nothing on backends without registered buffer support
+*/
+ASEXPORT asResults asResourceAsyncIO_RegisterBuffers(void** ppBuffers, size_t* pSizes, size_t count);
+
+/**
+* @brief Unregister all destination buffers
+*/
+ASEXPORT void asResourceAsyncIO_UnregisterBuffers();
+
+/**
+* @brief Allocate a buffer aligned for direct reads
+*/
+ASEXPORT void* asResourceAsyncIO_AllocAligned(size_t size);
+
+/**
+* @brief Free a buffer from asResourceAsyncIO_AllocAligned()
+*/
+ASEXPORT void asResourceAsyncIO_FreeAligned(void* pBuffer);
+
+/**
+* @brief Submit a batch of reads
+* @warning requests must remain valid until the batch is released
+*/
+ASEXPORT asResults asResourceReadBatch_Submit(asResourceReadRequest_t* pRequests, size_t count, asResourceReadBatch* pBatch);
+
+/**
+* @brief Check if every read in the batch is complete (never blocks)
+*/
+ASEXPORT bool asResourceReadBatch_IsComplete(asResourceReadBatch batch);
+
+/**
+* @brief Wait for every read in the batch to complete
+* @return AS_SUCCESS or the first failure from the requests
+*/
+ASEXPORT asResults asResourceReadBatch_Wait(asResourceReadBatch batch);
+
+/**
+* @brief Release a batch (waits if it is not complete)
+*/
+ASEXPORT void asResourceReadBatch_Release(asResourceReadBatch batch);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
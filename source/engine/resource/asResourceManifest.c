@@ -0,0 +1,422 @@
+#include "asResourceManifest.h"
+#include "../common/asBin.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define CUTE_FILES_IMPLEMENTATION
+#include "cute/cute_files.h"
+#include "stb/stb_ds.h"
+
+#define AS_RESOURCE_MANIFEST_TAG "AMAN"
+#define AS_RESOURCE_OVERRIDE_EXT ".ASRC_OVERRIDE"
+#define AS_RESOURCE_PAKCFG_EXT ".ASRC_PAKCFG"
+#define AS_RESOURCE_PAK_CACHE_DIR "_ASPAK_CACHE_"
+
+typedef struct {
+	uint32_t version;
+	uint32_t entryCount;
+	uint64_t stringBlobSize;
+} asResourceManifestHeader_t;
+
+struct asResourceManifestT
+{
+	unsigned char* pMapped;
+	size_t mappedSize;
+#ifdef _WIN32
+	HANDLE hFile;
+	HANDLE hMapping;
+#endif
+	const asResourceManifestEntry_t* pEntries;
+	size_t entryCount;
+	const char* pStrings;
+	size_t stringsSize;
+};
+
+/*Mapping*/
+
+static asResults _manifestMap(asResourceManifest manifest, const char* pPath)
+{
+#ifdef _WIN32
+	manifest->hFile = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (manifest->hFile == INVALID_HANDLE_VALUE)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(manifest->hFile, &fileSize) || !fileSize.QuadPart)
+	{
+		CloseHandle(manifest->hFile);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	manifest->hMapping = CreateFileMappingA(manifest->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!manifest->hMapping)
+	{
+		CloseHandle(manifest->hFile);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	manifest->pMapped = MapViewOfFile(manifest->hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!manifest->pMapped)
+	{
+		CloseHandle(manifest->hMapping);
+		CloseHandle(manifest->hFile);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	manifest->mappedSize = (size_t)fileSize.QuadPart;
+#else
+	int fd = open(pPath, O_RDONLY);
+	if (fd < 0)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	struct stat info;
+	if (fstat(fd, &info) || !info.st_size)
+	{
+		close(fd);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	void* pMapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMapped == MAP_FAILED)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	manifest->pMapped = pMapped;
+	manifest->mappedSize = (size_t)info.st_size;
+#endif
+	return AS_SUCCESS;
+}
+
+static void _manifestUnmap(asResourceManifest manifest)
+{
+	if (!manifest->pMapped)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(manifest->pMapped);
+	CloseHandle(manifest->hMapping);
+	CloseHandle(manifest->hFile);
+#else
+	munmap(manifest->pMapped, manifest->mappedSize);
+#endif
+	manifest->pMapped = NULL;
+}
+
+ASEXPORT asResults asResourceManifest_Open(asResourceManifest* pManifest, const char* pPath)
+{
+	asResourceManifest manifest = asMalloc(sizeof(struct asResourceManifestT));
+	if (!manifest)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	memset(manifest, 0, sizeof(struct asResourceManifestT));
+	asResults result = _manifestMap(manifest, pPath);
+	if (result != AS_SUCCESS)
+	{
+		asFree(manifest);
+		return result;
+	}
+
+	/*Validate and point into the mapping*/
+	asBinReader reader;
+	asResourceManifestHeader_t* pHeader = NULL;
+	unsigned char* pEntries = NULL;
+	unsigned char* pStrings = NULL;
+	size_t headerSize = 0, entriesSize = 0, stringsSize = 0;
+	result = asBinReaderOpenMemory(&reader, AS_RESOURCE_MANIFEST_TAG, manifest->pMapped, manifest->mappedSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "MANHEADR", 0 }, (unsigned char**)&pHeader, &headerSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "IDTABLE", 0 }, &pEntries, &entriesSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "STRBLOB", 0 }, &pStrings, &stringsSize);
+	if (result == AS_SUCCESS)
+	{
+		if (headerSize != sizeof(asResourceManifestHeader_t) ||
+			pHeader->version != AS_RESOURCE_MANIFEST_VERSION ||
+			entriesSize != pHeader->entryCount * sizeof(asResourceManifestEntry_t) ||
+			stringsSize != pHeader->stringBlobSize ||
+			(uintptr_t)pEntries % sizeof(uint64_t))
+			result = AS_FAILURE_UNKNOWN_FORMAT;
+	}
+	if (result != AS_SUCCESS)
+	{
+		asDebugWarning("Invalid resource manifest: %s", pPath);
+		_manifestUnmap(manifest);
+		asFree(manifest);
+		return result;
+	}
+
+	manifest->pEntries = (const asResourceManifestEntry_t*)pEntries;
+	manifest->entryCount = pHeader->entryCount;
+	manifest->pStrings = (const char*)pStrings;
+	manifest->stringsSize = stringsSize;
+	*pManifest = manifest;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asResourceManifest_Close(asResourceManifest manifest)
+{
+	if (!manifest)
+		return;
+	_manifestUnmap(manifest);
+	asFree(manifest);
+}
+
+ASEXPORT const asResourceManifestEntry_t* asResourceManifest_Find(asResourceManifest manifest, asResourceFileID_t id)
+{
+	size_t low = 0;
+	size_t high = manifest->entryCount;
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		asResourceFileID_t midId = manifest->pEntries[mid].id;
+		if (midId == id)
+			return &manifest->pEntries[mid];
+		if (midId < id)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return NULL;
+}
+
+ASEXPORT const char* asResourceManifest_GetName(asResourceManifest manifest, const asResourceManifestEntry_t* pEntry)
+{
+	if ((size_t)pEntry->nameOffset + pEntry->nameLength >= manifest->stringsSize)
+		return NULL;
+	return &manifest->pStrings[pEntry->nameOffset];
+}
+
+ASEXPORT size_t asResourceManifest_GetEntries(asResourceManifest manifest, const asResourceManifestEntry_t** ppEntries)
+{
+	if (ppEntries)
+		*ppEntries = manifest->pEntries;
+	return manifest->entryCount;
+}
+
+/*Generation (MANIFEST phase)*/
+
+struct _manifestCollector
+{
+	const char* pResourceDir;
+	size_t resourceDirLength;
+	asResourceManifestEntry_t* pEntries; /*stb_ds array*/
+	char* pStrings; /*stb_ds array*/
+	char** ppOverrideNames; /*stb_ds array (parallel to pEntries, NULL when not overridden)*/
+	char** ppPackagedFiles; /*stb_ds array*/
+};
+
+static bool _hasSuffix(const char* pStr, const char* pSuffix)
+{
+	size_t strLen = strlen(pStr);
+	size_t suffixLen = strlen(pSuffix);
+	return strLen >= suffixLen && !strcmp(pStr + strLen - suffixLen, pSuffix);
+}
+
+static char* _readOverride(const char* pFullPath)
+{
+	char overridePath[CUTE_FILES_MAX_PATH + 32];
+	snprintf(overridePath, sizeof(overridePath), "%s%s", pFullPath, AS_RESOURCE_OVERRIDE_EXT);
+	FILE* fp = fopen(overridePath, "rb");
+	if (!fp)
+		return NULL;
+	char buff[1024];
+	size_t length = fread(buff, 1, 1023, fp);
+	fclose(fp);
+	buff[length] = '\0';
+	/*Trim and turn '@' back into '/'*/
+	while (length && (buff[length - 1] == '\n' || buff[length - 1] == '\r' || buff[length - 1] == ' '))
+		buff[--length] = '\0';
+	for (size_t i = 0; i < length; i++)
+	{
+		if (buff[i] == '@')
+			buff[i] = '/';
+	}
+	remove(overridePath);
+	if (!length)
+		return NULL;
+	char* pResult = asMalloc(length + 1);
+	memcpy(pResult, buff, length + 1);
+	return pResult;
+}
+
+static void _collectFile(const char* pPath, const char* pName, void* pUserData)
+{
+	struct _manifestCollector* pCollector = (struct _manifestCollector*)pUserData;
+	if (_hasSuffix(pName, AS_RESOURCE_OVERRIDE_EXT) ||
+		_hasSuffix(pName, AS_RESOURCE_PAKCFG_EXT) ||
+		asIsStringEqual(pName, AS_RESOURCE_MANIFEST_NAME) ||
+		asIsStringEqual(pName, AS_RESOURCE_MANIFEST_CFG_NAME))
+		return;
+
+	char fullPath[CUTE_FILES_MAX_PATH];
+	strncpy(fullPath, pPath, CUTE_FILES_MAX_PATH - 1);
+	fullPath[CUTE_FILES_MAX_PATH - 1] = '\0';
+	for (char* c = fullPath; *c; c++)
+	{
+		if (*c == '\\')
+			*c = '/';
+	}
+	if (strncmp(fullPath, pCollector->pResourceDir, pCollector->resourceDirLength))
+		return;
+	const char* pRelative = fullPath + pCollector->resourceDirLength;
+	size_t relativeLength = strlen(pRelative);
+
+	/*Packaged content is resolved by the PACK phase*/
+	if (strstr(pRelative, AS_RESOURCE_PAK_CACHE_DIR))
+	{
+		char* pCopy = asMalloc(relativeLength + 1);
+		memcpy(pCopy, pRelative, relativeLength + 1);
+		arrput(pCollector->ppPackagedFiles, pCopy);
+		return;
+	}
+
+	char* pOverride = _readOverride(fullPath);
+	asResourceManifestEntry_t entry;
+	entry.id = pOverride ?
+		asResource_FileIDFromRelativePath(pOverride, strlen(pOverride)) :
+		asResource_FileIDFromRelativePath(pRelative, relativeLength);
+	entry.nameOffset = (uint32_t)arrlen(pCollector->pStrings);
+	entry.nameLength = (uint32_t)relativeLength;
+	entry.start = 0; /*Stray files always start at byte 0*/
+	entry.size = -1; /*Determined when opened so files may be edited without regenerating*/
+	size_t stringStart = arraddn(pCollector->pStrings, relativeLength + 1);
+	memcpy(&pCollector->pStrings[stringStart], pRelative, relativeLength + 1);
+	arrput(pCollector->pEntries, entry);
+	arrput(pCollector->ppOverrideNames, pOverride);
+}
+
+static int _compareEntries(const void* pA, const void* pB)
+{
+	const asResourceManifestEntry_t* pEntryA = (const asResourceManifestEntry_t*)pA;
+	const asResourceManifestEntry_t* pEntryB = (const asResourceManifestEntry_t*)pB;
+	if (pEntryA->id < pEntryB->id)
+		return -1;
+	return pEntryA->id > pEntryB->id;
+}
+
+static asResults _writeCfg(struct _manifestCollector* pCollector, const char* pPath)
+{
+	FILE* fp = fopen(pPath, "wb");
+	if (!fp)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	fprintf(fp, "[files]\n");
+	for (size_t i = 0; i < (size_t)arrlen(pCollector->pEntries); i++)
+	{
+		fprintf(fp, "%s=%s\n",
+			pCollector->ppOverrideNames[i] ? pCollector->ppOverrideNames[i] : "_PATH_",
+			&pCollector->pStrings[pCollector->pEntries[i].nameOffset]);
+	}
+	fprintf(fp, "[aspak]\n");
+	for (size_t i = 0; i < (size_t)arrlen(pCollector->ppPackagedFiles); i++)
+		fprintf(fp, "_PATH_=%s\n", pCollector->ppPackagedFiles[i]);
+	fclose(fp);
+	return AS_SUCCESS;
+}
+
+static asResults _writeBinary(struct _manifestCollector* pCollector, const char* pPath)
+{
+	/*Drop collisions like the text manifest does when it is loaded (the last file with an id wins)*/
+	struct { asResourceFileID_t key; size_t value; }* pLastIndex = NULL;
+	size_t count = arrlen(pCollector->pEntries);
+	for (size_t i = 0; i < count; i++)
+		hmput(pLastIndex, pCollector->pEntries[i].id, i);
+	size_t unique = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (hmget(pLastIndex, pCollector->pEntries[i].id) != i)
+		{
+			asDebugWarning("Resource ID collision: %s (skipped)", &pCollector->pStrings[pCollector->pEntries[i].nameOffset]);
+			continue;
+		}
+		pCollector->pEntries[unique++] = pCollector->pEntries[i];
+	}
+	hmfree(pLastIndex);
+	qsort(pCollector->pEntries, unique, sizeof(asResourceManifestEntry_t), _compareEntries);
+
+	/*Keep the blob padded so following sections stay aligned*/
+	while (arrlen(pCollector->pStrings) % sizeof(uint64_t))
+		arrput(pCollector->pStrings, '\0');
+
+	asResourceManifestHeader_t header;
+	header.version = AS_RESOURCE_MANIFEST_VERSION;
+	header.entryCount = (uint32_t)unique;
+	header.stringBlobSize = arrlen(pCollector->pStrings);
+
+	asBinWriter writer;
+	asResults result = asBinWriterOpen(&writer, AS_RESOURCE_MANIFEST_TAG, pPath, 3);
+	if (result != AS_SUCCESS)
+		return result;
+	asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "MANHEADR", 0 }, (unsigned char*)&header, sizeof(header));
+	asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "IDTABLE", 0 }, (unsigned char*)pCollector->pEntries, unique * sizeof(asResourceManifestEntry_t));
+	asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "STRBLOB", 0 }, (unsigned char*)pCollector->pStrings, arrlen(pCollector->pStrings));
+	return asBinWriterClose(&writer);
+}
+
+struct _traverseContext
+{
+	asResourceFileCallback fpCallback;
+	void* pUserData;
+};
+
+static void _traverseFile(cf_file_t* pFile, void* pUserData)
+{
+	struct _traverseContext* pContext = (struct _traverseContext*)pUserData;
+	pContext->fpCallback(pFile->path, pFile->name, pContext->pUserData);
+}
+
+ASEXPORT void asResourceManifest_TraverseFiles(const char* pDir, asResourceFileCallback fpCallback, void* pUserData)
+{
+	struct _traverseContext context = { fpCallback, pUserData };
+	cf_traverse(pDir, _traverseFile, &context);
+}
+
+ASEXPORT asResults asResourceManifest_Generate(const char* pResourceDir)
+{
+	struct _manifestCollector collector;
+	memset(&collector, 0, sizeof(collector));
+
+	/*Normalize the directory (forward slashes, trailing slash)*/
+	char resourceDir[CUTE_FILES_MAX_PATH];
+	size_t dirLength = strlen(pResourceDir);
+	if (!dirLength || dirLength >= CUTE_FILES_MAX_PATH - 2)
+		return AS_FAILURE_INVALID_PARAM;
+	memcpy(resourceDir, pResourceDir, dirLength + 1);
+	for (size_t i = 0; i < dirLength; i++)
+	{
+		if (resourceDir[i] == '\\')
+			resourceDir[i] = '/';
+	}
+	if (resourceDir[dirLength - 1] != '/')
+	{
+		resourceDir[dirLength++] = '/';
+		resourceDir[dirLength] = '\0';
+	}
+	collector.pResourceDir = resourceDir;
+	collector.resourceDirLength = dirLength;
+
+	/*Traverse without the trailing slash*/
+	char traversePath[CUTE_FILES_MAX_PATH];
+	memcpy(traversePath, resourceDir, dirLength - 1);
+	traversePath[dirLength - 1] = '\0';
+	asResourceManifest_TraverseFiles(traversePath, _collectFile, &collector);
+	asDebugLog("Manifest: %d files, %d packaged", (int)arrlen(collector.pEntries), (int)arrlen(collector.ppPackagedFiles));
+
+	/*Write outputs*/
+	char outPath[CUTE_FILES_MAX_PATH + 32];
+	snprintf(outPath, sizeof(outPath), "%s%s", resourceDir, AS_RESOURCE_MANIFEST_CFG_NAME);
+	asResults result = _writeCfg(&collector, outPath);
+	if (result == AS_SUCCESS)
+	{
+		snprintf(outPath, sizeof(outPath), "%s%s", resourceDir, AS_RESOURCE_MANIFEST_NAME);
+		result = _writeBinary(&collector, outPath);
+	}
+
+	for (size_t i = 0; i < (size_t)arrlen(collector.ppOverrideNames); i++)
+		asFree(collector.ppOverrideNames[i]);
+	for (size_t i = 0; i < (size_t)arrlen(collector.ppPackagedFiles); i++)
+		asFree(collector.ppPackagedFiles[i]);
+	arrfree(collector.ppOverrideNames);
+	arrfree(collector.ppPackagedFiles);
+	arrfree(collector.pEntries);
+	arrfree(collector.pStrings);
+	return result;
+}
@@ -0,0 +1,87 @@
+#ifndef _ASRESOURCEMANIFEST_H_
+#define _ASRESOURCEMANIFEST_H_
+
+#include "../common/asCommon.h"
+#include "asResource.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Precompiled binary resource manifest (MANIFEST phase output)
+* An asBin ("AMAN") containing an ID table sorted by asResourceFileID_t and a blob of null terminated names.
+* The runtime maps the file and searches the table in place.
+*/
+
+#define AS_RESOURCE_MANIFEST_NAME "resources.asman"
+#define AS_RESOURCE_MANIFEST_CFG_NAME "resources.cfg"
+#define AS_RESOURCE_MANIFEST_VERSION 1
+
+/**
+* @brief A single manifest entry (stored as is on disk)
+*/
+typedef struct {
+	asResourceFileID_t id; /**< Hash of the (possibly overridden) relative name*/
+	uint32_t nameOffset; /**< Offset of the real relative path in the string blob*/
+	uint32_t nameLength; /**< Length of the real relative path (excluding the terminator)*/
+	int64_t start; /**< Offset of the content in the file*/
+	int64_t size; /**< Size of the content (negative means the whole file)*/
+} asResourceManifestEntry_t;
+
+/**
+* @brief an opaque mapped manifest
+*/
+typedef struct asResourceManifestT* asResourceManifest;
+
+/**
+* @brief Map a binary manifest
+*/
+ASEXPORT asResults asResourceManifest_Open(asResourceManifest* pManifest, const char* pPath);
+
+/**
+* @brief Unmap a binary manifest
+*/
+ASEXPORT void asResourceManifest_Close(asResourceManifest manifest);
+
+/**
+* @brief Find an entry by ID (binary search over the mapped table)
+* Returns NULL if the ID is not in the manifest
+*/
+ASEXPORT const asResourceManifestEntry_t* asResourceManifest_Find(asResourceManifest manifest, asResourceFileID_t id);
+
+/**
+* @brief Get the null terminated relative path of an entry
+*/
+ASEXPORT const char* asResourceManifest_GetName(asResourceManifest manifest, const asResourceManifestEntry_t* pEntry);
+
+/**
+* @brief Get the sorted entry table
+*/
+ASEXPORT size_t asResourceManifest_GetEntries(asResourceManifest manifest, const asResourceManifestEntry_t** ppEntries);
+
+/**
+* @brief Called for every regular file found by asResourceManifest_TraverseFiles()
+* @param pPath full path of the file, pName the file name only
+*/
+typedef void (*asResourceFileCallback)(const char* pPath, const char* pName, void* pUserData);
+
+/**
+* @brief Visit every file under a directory recursively (hidden directories are skipped)
+* Shared by the MANIFEST phase and the COOK phase
+* @param pDir the directory without a trailing slash
+*/
+ASEXPORT void asResourceManifest_TraverseFiles(const char* pDir, asResourceFileCallback fpCallback, void* pUserData);
+
+/**
+* @brief Run the MANIFEST phase over a cooked resource directory
+* Collects every file (applying and removing ASRC_OVERRIDE files),
+* then writes both the text manifest (resources.cfg) and the binary manifest (resources.asman)
+* @param pResourceDir the resource directory (with a trailing slash)
+*/
+ASEXPORT asResults asResourceManifest_Generate(const char* pResourceDir);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
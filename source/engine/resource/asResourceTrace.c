@@ -0,0 +1,488 @@
+#include "asResourceTrace.h"
+#include "asResourceAsyncIO.h"
+#include "asUserFiles.h"
+#include "../common/asBin.h"
+#include "../common/preferences/asPreferences.h"
+
+#include <SDL_atomic.h>
+
+#include "stb/stb_ds.h"
+
+#define AS_RESOURCE_TRACE_TAG "ATRC"
+#define AS_RESOURCE_PLAN_TAG "APLN"
+#define AS_RESOURCE_PREFETCH_BATCH_BYTES (8 * 1024 * 1024)
+#define AS_RESOURCE_PREFETCH_BATCH_READS 64
+
+typedef struct {
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t count;
+} asResourceTraceHeader_t;
+
+int32_t gResourceTraceRecord = 0;
+int32_t gResourcePrefetch = 1;
+int32_t gResourcePrefetchWindowMB = 64;
+
+/*Recording*/
+
+struct
+{
+	SDL_atomic_t recording;
+	SDL_SpinLock lock;
+	asTimer_t timer;
+	asResourceTraceEvent_t* pEvents; /*stb_ds array*/
+} resTrace;
+
+/*Prefetch*/
+
+struct
+{
+	SDL_atomic_t active;
+	SDL_SpinLock lock; /*Guards the indices and stats*/
+	SDL_SpinLock pumpLock; /*Held by asResourcePrefetch_Update() while issuing reads*/
+	asResourceTraceEvent_t* pPlan;
+	size_t planCount;
+	uint64_t* pPlanEnd; /*Running byte total at the end of each plan entry*/
+	struct { asResourceFileID_t key; size_t value; }* pFirstIndex; /*First plan entry of each resource (stb_ds hashmap)*/
+	size_t demandIndex; /*Plan entries before this have been read by the application*/
+	size_t issueIndex; /*Next plan entry to read ahead*/
+	uint64_t issueOffset; /*Progress through a plan entry larger than a batch*/
+	uint64_t windowBytes;
+
+	/*Batch in flight*/
+	asResourceReadBatch batch;
+	asResourceLoader_t loaders[AS_RESOURCE_PREFETCH_BATCH_READS];
+	asResourceReadRequest_t requests[AS_RESOURCE_PREFETCH_BATCH_READS];
+	size_t requestCount;
+	unsigned char* pScratch;
+
+	asResourcePrefetchStats_t stats;
+} resPrefetch;
+
+static uint64_t _prefetchPlanStart(size_t index)
+{
+	return index ? resPrefetch.pPlanEnd[index - 1] : 0;
+}
+
+static void _prefetchRetireBatch()
+{
+	asResourceReadBatch_Release(resPrefetch.batch);
+	for (size_t i = 0; i < resPrefetch.requestCount; i++)
+		asResourceLoader_Close(&resPrefetch.loaders[i]);
+	resPrefetch.batch = NULL;
+	resPrefetch.requestCount = 0;
+}
+
+/*Must be called with the pump lock held*/
+static void _prefetchPump()
+{
+	if (resPrefetch.batch)
+	{
+		if (!asResourceReadBatch_IsComplete(resPrefetch.batch))
+			return;
+		_prefetchRetireBatch();
+	}
+
+	SDL_AtomicLock(&resPrefetch.lock);
+	if (resPrefetch.issueIndex < resPrefetch.demandIndex)
+	{
+		/*Demand overtook us, no point reading what was already loaded*/
+		resPrefetch.issueIndex = resPrefetch.demandIndex;
+		resPrefetch.issueOffset = 0;
+	}
+	size_t issueIndex = resPrefetch.issueIndex;
+	uint64_t issueOffset = resPrefetch.issueOffset;
+	uint64_t windowEnd = _prefetchPlanStart(resPrefetch.demandIndex) + resPrefetch.windowBytes;
+	SDL_AtomicUnlock(&resPrefetch.lock);
+
+	size_t count = 0;
+	size_t scratchUsed = 0;
+	uint64_t issuedBytes = 0;
+	uint64_t issuedEntries = 0;
+	while (issueIndex < resPrefetch.planCount &&
+		count < AS_RESOURCE_PREFETCH_BATCH_READS &&
+		scratchUsed < AS_RESOURCE_PREFETCH_BATCH_BYTES &&
+		_prefetchPlanStart(issueIndex) + issueOffset < windowEnd)
+	{
+		const asResourceTraceEvent_t* pEntry = &resPrefetch.pPlan[issueIndex];
+		asResourceLoader_t* pLoader = &resPrefetch.loaders[count];
+		if (asResourceLoader_Open(pLoader, pEntry->id) != AS_SUCCESS)
+		{
+			issueIndex++;
+			issueOffset = 0;
+			continue;
+		}
+		pLoader->_id = 0; /*Read ahead is not demand*/
+		uint64_t contentSize = asResourceLoader_GetContentSize(pLoader);
+		uint64_t offset = pEntry->offset + issueOffset;
+		uint64_t size = pEntry->size - issueOffset;
+		if (offset >= contentSize)
+		{
+			/*Stale plan*/
+			asResourceLoader_Close(pLoader);
+			issueIndex++;
+			issueOffset = 0;
+			continue;
+		}
+		if (offset + size > contentSize)
+			size = contentSize - offset;
+		if (size > AS_RESOURCE_PREFETCH_BATCH_BYTES - scratchUsed)
+			size = AS_RESOURCE_PREFETCH_BATCH_BYTES - scratchUsed;
+
+		asResourceReadRequest_t* pRequest = &resPrefetch.requests[count];
+		memset(pRequest, 0, sizeof(asResourceReadRequest_t));
+		pRequest->pLoader = pLoader;
+		pRequest->offset = (size_t)offset;
+		pRequest->size = (size_t)size;
+		pRequest->pDest = resPrefetch.pScratch + scratchUsed;
+		pRequest->flags = AS_RESOURCE_READ_FLAG_CACHED;
+		scratchUsed += (size_t)size;
+		issuedBytes += size;
+		count++;
+
+		if (offset + size >= pEntry->offset + pEntry->size || offset + size >= contentSize)
+		{
+			issueIndex++;
+			issueOffset = 0;
+			issuedEntries++;
+		}
+		else
+		{
+			issueOffset += size;
+		}
+	}
+
+	if (count)
+	{
+		resPrefetch.requestCount = count;
+		if (asResourceReadBatch_Submit(resPrefetch.requests, count, &resPrefetch.batch) != AS_SUCCESS)
+			_prefetchRetireBatch();
+	}
+
+	SDL_AtomicLock(&resPrefetch.lock);
+	resPrefetch.issueIndex = issueIndex;
+	resPrefetch.issueOffset = issueOffset;
+	resPrefetch.stats.issuedBytes += issuedBytes;
+	resPrefetch.stats.issuedEntries += issuedEntries;
+	SDL_AtomicUnlock(&resPrefetch.lock);
+}
+
+static void _prefetchTryPump()
+{
+	if (!SDL_AtomicTryLock(&resPrefetch.pumpLock))
+		return;
+	_prefetchPump();
+	SDL_AtomicUnlock(&resPrefetch.pumpLock);
+}
+
+static void _prefetchDemand(asResourceFileID_t id)
+{
+	SDL_AtomicLock(&resPrefetch.lock);
+	ptrdiff_t mapIndex = hmgeti(resPrefetch.pFirstIndex, id);
+	if (mapIndex < 0)
+	{
+		resPrefetch.stats.unplanned++;
+	}
+	else
+	{
+		size_t planIndex = resPrefetch.pFirstIndex[mapIndex].value;
+		if (planIndex < resPrefetch.issueIndex)
+			resPrefetch.stats.demandHits++;
+		else
+			resPrefetch.stats.demandMisses++;
+		if (planIndex + 1 > resPrefetch.demandIndex)
+			resPrefetch.demandIndex = planIndex + 1;
+	}
+	SDL_AtomicUnlock(&resPrefetch.lock);
+	/*Only the window moves here, opening plan files would stall the thread that asked for the resource*/
+}
+
+static void _prefetchStart(asResourceTraceEvent_t* pPlan, size_t count)
+{
+	memset(&resPrefetch, 0, sizeof(resPrefetch));
+	resPrefetch.pPlan = pPlan;
+	resPrefetch.planCount = count;
+	resPrefetch.windowBytes = (uint64_t)gResourcePrefetchWindowMB * 1024 * 1024;
+	resPrefetch.pPlanEnd = asMalloc(sizeof(uint64_t) * count);
+	resPrefetch.pScratch = asResourceAsyncIO_AllocAligned(AS_RESOURCE_PREFETCH_BATCH_BYTES);
+	ASASSERT(resPrefetch.pPlanEnd && resPrefetch.pScratch);
+	uint64_t total = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		total += pPlan[i].size;
+		resPrefetch.pPlanEnd[i] = total;
+		if (hmgeti(resPrefetch.pFirstIndex, pPlan[i].id) < 0)
+			hmput(resPrefetch.pFirstIndex, pPlan[i].id, i);
+	}
+	resPrefetch.stats.planEntries = count;
+	SDL_AtomicSet(&resPrefetch.active, 1);
+	asDebugLog("Resource Prefetch: %zu entries, %.1f MB", count, (double)total / (1024.0 * 1024.0));
+}
+
+static void _prefetchStop()
+{
+	if (!SDL_AtomicGet(&resPrefetch.active))
+		return;
+	SDL_AtomicSet(&resPrefetch.active, 0);
+	SDL_AtomicLock(&resPrefetch.pumpLock);
+	if (resPrefetch.batch)
+		_prefetchRetireBatch();
+	SDL_AtomicUnlock(&resPrefetch.pumpLock);
+	asResourceAsyncIO_FreeAligned(resPrefetch.pScratch);
+	asFree(resPrefetch.pPlanEnd);
+	asFree(resPrefetch.pPlan);
+	hmfree(resPrefetch.pFirstIndex);
+	memset(&resPrefetch, 0, sizeof(resPrefetch));
+}
+
+ASEXPORT void asResourcePrefetch_Update()
+{
+	if (SDL_AtomicGet(&resPrefetch.active))
+		_prefetchTryPump();
+}
+
+ASEXPORT void asResourcePrefetch_GetStats(asResourcePrefetchStats_t* pStats)
+{
+	SDL_AtomicLock(&resPrefetch.lock);
+	*pStats = resPrefetch.stats;
+	SDL_AtomicUnlock(&resPrefetch.lock);
+}
+
+/*Trace*/
+
+ASEXPORT void asResourceTrace_Record(asResourceFileID_t id, uint64_t offset, uint64_t size)
+{
+	if (!id)
+		return;
+	if (SDL_AtomicGet(&resTrace.recording))
+	{
+		SDL_AtomicLock(&resTrace.lock);
+		asResourceTraceEvent_t event;
+		event.id = id;
+		event.offset = offset;
+		event.size = size;
+		event.timeUs = asTimerMicroseconds(resTrace.timer, asTimerTicksElapsed(resTrace.timer));
+		arrput(resTrace.pEvents, event);
+		SDL_AtomicUnlock(&resTrace.lock);
+	}
+	if (SDL_AtomicGet(&resPrefetch.active))
+		_prefetchDemand(id);
+}
+
+ASEXPORT void asResourceTrace_SetRecording(bool enable)
+{
+	SDL_AtomicLock(&resTrace.lock);
+	if (enable)
+	{
+		arrsetlen(resTrace.pEvents, 0);
+		resTrace.timer = asTimerStart();
+	}
+	SDL_AtomicSet(&resTrace.recording, enable ? 1 : 0);
+	SDL_AtomicUnlock(&resTrace.lock);
+}
+
+static asResults _writeEvents(const char* pPath, char tag[4], asBinSectionIdentifier headerId, asBinSectionIdentifier eventsId, const asResourceTraceEvent_t* pEvents, size_t count)
+{
+	asResourceTraceHeader_t header = { 0 };
+	header.version = AS_RESOURCE_TRACE_VERSION;
+	header.count = count;
+	asBinWriter writer;
+	asResults result = asBinWriterOpen(&writer, tag, pPath, 2);
+	if (result != AS_SUCCESS)
+		return result;
+	asBinWriterAddSection(&writer, headerId, (unsigned char*)&header, sizeof(header));
+	asBinWriterAddSection(&writer, eventsId, (unsigned char*)pEvents, count * sizeof(asResourceTraceEvent_t));
+	return asBinWriterClose(&writer);
+}
+
+static asResults _loadEvents(const char* pPath, char tag[4], asBinSectionIdentifier headerId, asBinSectionIdentifier eventsId, asResourceTraceEvent_t** ppEvents, size_t* pCount)
+{
+	*ppEvents = NULL;
+	*pCount = 0;
+	FILE* fp = fopen(pPath, "rb");
+	if (!fp)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	fseek(fp, 0, SEEK_END);
+	size_t fileSize = (size_t)ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	unsigned char* pData = asMalloc(fileSize);
+	ASASSERT(pData);
+	size_t readSize = fread(pData, 1, fileSize, fp);
+	fclose(fp);
+	if (readSize != fileSize)
+	{
+		asFree(pData);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+
+	asBinReader reader;
+	asResourceTraceHeader_t* pHeader = NULL;
+	unsigned char* pEvents = NULL;
+	size_t headerSize, eventsSize;
+	asResults result = asBinReaderOpenMemory(&reader, tag, pData, fileSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, headerId, (unsigned char**)&pHeader, &headerSize);
+	if (result == AS_SUCCESS)
+		result = asBinReaderGetSection(&reader, eventsId, &pEvents, &eventsSize);
+	if (result == AS_SUCCESS &&
+		(headerSize < sizeof(asResourceTraceHeader_t) ||
+		pHeader->version != AS_RESOURCE_TRACE_VERSION ||
+		eventsSize < pHeader->count * sizeof(asResourceTraceEvent_t)))
+	{
+		result = AS_FAILURE_UNKNOWN_FORMAT;
+	}
+	if (result == AS_SUCCESS && pHeader->count)
+	{
+		*ppEvents = asMalloc((size_t)pHeader->count * sizeof(asResourceTraceEvent_t));
+		ASASSERT(*ppEvents);
+		memcpy(*ppEvents, pEvents, (size_t)pHeader->count * sizeof(asResourceTraceEvent_t));
+		*pCount = (size_t)pHeader->count;
+	}
+	asFree(pData);
+	return result;
+}
+
+ASEXPORT asResults asResourceTrace_Write(const char* pPath)
+{
+	SDL_AtomicLock(&resTrace.lock);
+	asResults result = _writeEvents(pPath, AS_RESOURCE_TRACE_TAG,
+		(asBinSectionIdentifier) { "TRHEADER", 0 }, (asBinSectionIdentifier) { "EVENTS", 0 },
+		resTrace.pEvents, arrlen(resTrace.pEvents));
+	SDL_AtomicUnlock(&resTrace.lock);
+	return result;
+}
+
+ASEXPORT asResults asResourceTrace_Load(const char* pPath, asResourceTraceEvent_t** ppEvents, size_t* pCount)
+{
+	return _loadEvents(pPath, AS_RESOURCE_TRACE_TAG,
+		(asBinSectionIdentifier) { "TRHEADER", 0 }, (asBinSectionIdentifier) { "EVENTS", 0 },
+		ppEvents, pCount);
+}
+
+/*Plan*/
+
+typedef struct {
+	asResourceTraceEvent_t event;
+	size_t order;
+} _traceSortItem;
+
+static int _traceSortCompare(const void* pA, const void* pB)
+{
+	const _traceSortItem* a = (const _traceSortItem*)pA;
+	const _traceSortItem* b = (const _traceSortItem*)pB;
+	if (a->event.timeUs != b->event.timeUs)
+		return a->event.timeUs < b->event.timeUs ? -1 : 1;
+	return a->order < b->order ? -1 : (a->order > b->order ? 1 : 0);
+}
+
+ASEXPORT asResults asResourcePlan_Build(const asResourceTraceEvent_t* pEvents, size_t count, asResourceTraceEvent_t** ppPlan, size_t* pPlanCount)
+{
+	*ppPlan = NULL;
+	*pPlanCount = 0;
+	if (!count)
+		return AS_SUCCESS;
+
+	/*Order by time (several traces interleave by their time since start)*/
+	_traceSortItem* pSorted = asMalloc(sizeof(_traceSortItem) * count);
+	ASASSERT(pSorted);
+	for (size_t i = 0; i < count; i++)
+	{
+		pSorted[i].event = pEvents[i];
+		pSorted[i].order = i;
+	}
+	qsort(pSorted, count, sizeof(_traceSortItem), _traceSortCompare);
+
+	asResourceTraceEvent_t* pPlan = asMalloc(sizeof(asResourceTraceEvent_t) * count);
+	ASASSERT(pPlan);
+	size_t planCount = 0;
+	struct { asResourceFileID_t key; size_t value; }* pLastIndex = NULL; /*Most recent plan entry of each resource*/
+	for (size_t i = 0; i < count; i++)
+	{
+		const asResourceTraceEvent_t* pEvent = &pSorted[i].event;
+		if (!pEvent->size)
+			continue;
+		ptrdiff_t mapIndex = hmgeti(pLastIndex, pEvent->id);
+		if (mapIndex >= 0)
+		{
+			asResourceTraceEvent_t* pLast = &pPlan[pLastIndex[mapIndex].value];
+			uint64_t lastEnd = pLast->offset + pLast->size;
+			/*Already covered*/
+			if (pEvent->offset >= pLast->offset && pEvent->offset + pEvent->size <= lastEnd)
+				continue;
+			/*Continues the previous plan entry, extend it*/
+			if (pLastIndex[mapIndex].value == planCount - 1 &&
+				pEvent->offset >= pLast->offset && pEvent->offset <= lastEnd)
+			{
+				pLast->size = pEvent->offset + pEvent->size - pLast->offset;
+				continue;
+			}
+		}
+		pPlan[planCount] = *pEvent;
+		hmput(pLastIndex, pEvent->id, planCount);
+		planCount++;
+	}
+	hmfree(pLastIndex);
+	asFree(pSorted);
+
+	*ppPlan = pPlan;
+	*pPlanCount = planCount;
+	return AS_SUCCESS;
+}
+
+ASEXPORT asResults asResourcePlan_Write(const char* pPath, const asResourceTraceEvent_t* pPlan, size_t count)
+{
+	return _writeEvents(pPath, AS_RESOURCE_PLAN_TAG,
+		(asBinSectionIdentifier) { "PLNHEADR", 0 }, (asBinSectionIdentifier) { "PLAN", 0 },
+		pPlan, count);
+}
+
+ASEXPORT asResults asResourcePlan_Load(const char* pPath, asResourceTraceEvent_t** ppPlan, size_t* pCount)
+{
+	return _loadEvents(pPath, AS_RESOURCE_PLAN_TAG,
+		(asBinSectionIdentifier) { "PLNHEADR", 0 }, (asBinSectionIdentifier) { "PLAN", 0 },
+		ppPlan, pCount);
+}
+
+/*Manager*/
+
+ASEXPORT void asInitResourceTrace()
+{
+	if (asGetGlobalPrefs())
+	{
+		asPreferencesRegisterOpenSection(asGetGlobalPrefs(), "prefetch");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "traceRecord", &gResourceTraceRecord, 0, 1, true, NULL, NULL, "Record resource reads to " AS_RESOURCE_TRACE_NAME " in the user folder (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "enable", &gResourcePrefetch, 0, 1, true, NULL, NULL, "Read ahead along " AS_RESOURCE_PLAN_NAME " when present (Requires Restart)");
+		asPreferencesRegisterParamInt32(asGetGlobalPrefs(), "windowMB", &gResourcePrefetchWindowMB, 1, 4096, true, NULL, NULL, "How far in MB reads may run ahead of demand (Requires Restart)");
+		asPreferencesLoadSection(asGetGlobalPrefs(), "prefetch");
+	}
+	if (gResourceTraceRecord)
+	{
+		asDebugLog("%s", "Resource Trace: Recording");
+		asResourceTrace_SetRecording(true);
+	}
+	if (gResourcePrefetch)
+	{
+		char planPath[1024];
+		snprintf(planPath, 1024, "%s%s", asResource_GetResourceFolderPath(), AS_RESOURCE_PLAN_NAME);
+		asResourceTraceEvent_t* pPlan;
+		size_t planCount;
+		if (asResourcePlan_Load(planPath, &pPlan, &planCount) == AS_SUCCESS && planCount)
+			_prefetchStart(pPlan, planCount);
+	}
+}
+
+ASEXPORT void asShutdownResourceTrace()
+{
+	_prefetchStop();
+	if (SDL_AtomicGet(&resTrace.recording))
+	{
+		asResourceTrace_SetRecording(false);
+		char tracePath[1024];
+		asUserFileMakePath(AS_RESOURCE_TRACE_NAME, tracePath, 1024);
+		if (asResourceTrace_Write(tracePath) == AS_SUCCESS)
+			asDebugLog("Resource Trace: %d reads written to %s", (int)arrlen(resTrace.pEvents), tracePath);
+		else
+			asDebugWarning("Resource Trace: could not write %s", tracePath);
+	}
+	arrfree(resTrace.pEvents);
+}
@@ -0,0 +1,110 @@
+#ifndef _ASRESOURCETRACE_H_
+#define _ASRESOURCETRACE_H_
+
+#include "../common/asCommon.h"
+#include "asResource.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief Resource access tracing and trace-guided prefetch
+* A run can record every resource read (ID, offset, size, time) to a user file,
+* asPrefetchPlan turns traces into a preload plan (resources.asplan) shipped with the resources,
+* and on later runs the async loader reads ahead of demand along that plan to warm the page cache
+*/
+
+#define AS_RESOURCE_TRACE_NAME "resource_trace.astrace"
+#define AS_RESOURCE_PLAN_NAME "resources.asplan"
+#define AS_RESOURCE_TRACE_VERSION 1
+
+/**
+* @brief A single recorded read (trace events and plan entries share the layout, stored as is on disk)
+*/
+typedef struct {
+	asResourceFileID_t id; /**< Resource that was read*/
+	uint64_t offset; /**< Offset relative to the start of the resource*/
+	uint64_t size; /**< Bytes read*/
+	uint64_t timeUs; /**< Microseconds since recording started (first access for plan entries)*/
+} asResourceTraceEvent_t;
+
+/**
+* @brief Prefetch statistics
+*/
+typedef struct {
+	uint64_t planEntries; /**< Entries in the loaded plan*/
+	uint64_t issuedEntries; /**< Plan entries read ahead so far*/
+	uint64_t issuedBytes; /**< Bytes read ahead so far*/
+	uint64_t demandHits; /**< Demand reads that had already been read ahead*/
+	uint64_t demandMisses; /**< Demand reads in the plan that had not been read ahead yet*/
+	uint64_t unplanned; /**< Demand reads not in the plan*/
+} asResourcePrefetchStats_t;
+
+/**
+* @brief Initializes tracing and prefetch using the "prefetch" preferences
+* @warning The resource manager init should handle this for you
+*/
+ASEXPORT void asInitResourceTrace();
+
+/**
+* @brief Shutdown tracing and prefetch (writes the trace if recording)
+* @warning The resource manager shutdown should handle this for you
+*/
+ASEXPORT void asShutdownResourceTrace();
+
+/**
+* @brief Note a demand read of a resource (records it and moves the prefetch window, never opens files itself)
+* @warning the resource loaders and async reads call this for you
+*/
+ASEXPORT void asResourceTrace_Record(asResourceFileID_t id, uint64_t offset, uint64_t size);
+
+/**
+* @brief Start or stop recording (recording restarts the clock and discards previous events)
+*/
+ASEXPORT void asResourceTrace_SetRecording(bool enable);
+
+/**
+* @brief Write the events recorded so far (asBin "ATRC")
+*/
+ASEXPORT asResults asResourceTrace_Write(const char* pPath);
+
+/**
+* @brief Load a trace written by asResourceTrace_Write()
+* @param ppEvents filled with an array that must be freed with asFree()
+*/
+ASEXPORT asResults asResourceTrace_Load(const char* pPath, asResourceTraceEvent_t** ppEvents, size_t* pCount);
+
+/**
+* @brief Build a preload plan from trace events
+* Duplicate reads are dropped, entries are ordered by first access and adjacent ranges of the same resource are merged
+* @param ppPlan filled with an array that must be freed with asFree()
+*/
+ASEXPORT asResults asResourcePlan_Build(const asResourceTraceEvent_t* pEvents, size_t count, asResourceTraceEvent_t** ppPlan, size_t* pPlanCount);
+
+/**
+* @brief Write a preload plan (asBin "APLN")
+*/
+ASEXPORT asResults asResourcePlan_Write(const char* pPath, const asResourceTraceEvent_t* pPlan, size_t count);
+
+/**
+* @brief Load a preload plan, this is also the access order the PACK phase should lay packages out in
+* @param ppPlan filled with an array that must be freed with asFree()
+*/
+ASEXPORT asResults asResourcePlan_Load(const char* pPath, asResourceTraceEvent_t** ppPlan, size_t* pCount);
+
+/**
+* @brief Keep prefetch reads moving (called once per frame by the engine loop)
+* All read ahead is opened and submitted from here so demand reads on other threads are never held up by it
+*/
+ASEXPORT void asResourcePrefetch_Update();
+
+/**
+* @brief Get prefetch statistics
+*/
+ASEXPORT void asResourcePrefetch_GetStats(asResourcePrefetchStats_t* pStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,237 @@
+#include "asJobSystem.h"
+
+#include <SDL_thread.h>
+#include <SDL_atomic.h>
+#include <SDL_cpuinfo.h>
+
+#define AS_JOBSYSTEM_MAX_WORKERS 64
+
+struct asJobCounterT
+{
+	SDL_atomic_t remaining;
+};
+
+struct _queuedJob
+{
+	asJobDesc_t desc;
+	asJobCounter counter;
+};
+
+/*Job Queue (ring buffer, grows as needed)*/
+struct
+{
+	struct _queuedJob* pJobs;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	SDL_mutex* pMutex;
+	SDL_cond* pJobAvailable;
+	SDL_cond* pJobComplete;
+	SDL_Thread* pWorkers[AS_JOBSYSTEM_MAX_WORKERS];
+	int32_t workerCount;
+	bool running;
+} jobSystem;
+
+static asResults _jobQueueReserve(size_t count)
+{
+	if (count <= jobSystem.capacity)
+		return AS_SUCCESS;
+	size_t newCapacity = jobSystem.capacity ? jobSystem.capacity : 256;
+	while (newCapacity < count)
+		newCapacity *= 2;
+	struct _queuedJob* pNewJobs = asMalloc(sizeof(struct _queuedJob) * newCapacity);
+	if (!pNewJobs)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	/*Unwrap the ring*/
+	for (size_t i = 0; i < jobSystem.count; i++)
+		pNewJobs[i] = jobSystem.pJobs[(jobSystem.head + i) % jobSystem.capacity];
+	asFree(jobSystem.pJobs);
+	jobSystem.pJobs = pNewJobs;
+	jobSystem.capacity = newCapacity;
+	jobSystem.head = 0;
+	return AS_SUCCESS;
+}
+
+/*Must be called with the queue mutex locked*/
+static bool _jobQueuePop(struct _queuedJob* pOut)
+{
+	if (!jobSystem.count)
+		return false;
+	*pOut = jobSystem.pJobs[jobSystem.head];
+	jobSystem.head = (jobSystem.head + 1) % jobSystem.capacity;
+	jobSystem.count--;
+	return true;
+}
+
+static void _jobExecute(struct _queuedJob* pJob)
+{
+	pJob->desc.fpEntry(pJob->desc.pUserData);
+	if (pJob->counter)
+	{
+		if (SDL_AtomicAdd(&pJob->counter->remaining, -1) == 1)
+		{
+			SDL_LockMutex(jobSystem.pMutex);
+			SDL_CondBroadcast(jobSystem.pJobComplete);
+			SDL_UnlockMutex(jobSystem.pMutex);
+		}
+	}
+}
+
+static int _jobWorkerMain(void* pUserData)
+{
+	struct _queuedJob job;
+	for (;;)
+	{
+		SDL_LockMutex(jobSystem.pMutex);
+		while (jobSystem.running && !jobSystem.count)
+			SDL_CondWait(jobSystem.pJobAvailable, jobSystem.pMutex);
+		if (!_jobQueuePop(&job))
+		{
+			/*Not running and nothing left to do*/
+			SDL_UnlockMutex(jobSystem.pMutex);
+			break;
+		}
+		SDL_UnlockMutex(jobSystem.pMutex);
+		_jobExecute(&job);
+	}
+	return 0;
+}
+
+ASEXPORT void asInitJobSystem(int32_t workerCount)
+{
+	memset(&jobSystem, 0, sizeof(jobSystem));
+	if (workerCount <= 0)
+		workerCount = SDL_GetCPUCount() - 1;
+	if (workerCount < 1)
+		workerCount = 1;
+	if (workerCount > AS_JOBSYSTEM_MAX_WORKERS)
+		workerCount = AS_JOBSYSTEM_MAX_WORKERS;
+
+	jobSystem.pMutex = SDL_CreateMutex();
+	jobSystem.pJobAvailable = SDL_CreateCond();
+	jobSystem.pJobComplete = SDL_CreateCond();
+	if (!jobSystem.pMutex || !jobSystem.pJobAvailable || !jobSystem.pJobComplete)
+	{
+		asFatalError("Failed to create job system sync primitives", -1);
+	}
+	_jobQueueReserve(256);
+	jobSystem.running = true;
+
+	for (int32_t i = 0; i < workerCount; i++)
+	{
+		char threadName[32];
+		snprintf(threadName, 32, "asJobWorker%d", i);
+		jobSystem.pWorkers[i] = SDL_CreateThread(_jobWorkerMain, threadName, NULL);
+		if (!jobSystem.pWorkers[i])
+		{
+			asDebugWarning("Could only create %d job workers", i);
+			break;
+		}
+		jobSystem.workerCount++;
+	}
+	asDebugLog("Job System Workers: %d", jobSystem.workerCount);
+}
+
+ASEXPORT void asShutdownJobSystem()
+{
+	if (!jobSystem.pMutex)
+		return;
+	SDL_LockMutex(jobSystem.pMutex);
+	jobSystem.running = false;
+	SDL_CondBroadcast(jobSystem.pJobAvailable);
+	SDL_UnlockMutex(jobSystem.pMutex);
+	for (int32_t i = 0; i < jobSystem.workerCount; i++)
+		SDL_WaitThread(jobSystem.pWorkers[i], NULL);
+
+	SDL_DestroyCond(jobSystem.pJobComplete);
+	SDL_DestroyCond(jobSystem.pJobAvailable);
+	SDL_DestroyMutex(jobSystem.pMutex);
+	asFree(jobSystem.pJobs);
+	memset(&jobSystem, 0, sizeof(jobSystem));
+}
+
+ASEXPORT int32_t asJobSystem_GetWorkerCount()
+{
+	return jobSystem.workerCount;
+}
+
+ASEXPORT asResults asJobSystem_CreateCounter(asJobCounter* pCounter)
+{
+	asJobCounter counter = asMalloc(sizeof(struct asJobCounterT));
+	if (!counter)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	SDL_AtomicSet(&counter->remaining, 0);
+	*pCounter = counter;
+	return AS_SUCCESS;
+}
+
+ASEXPORT void asJobSystem_ReleaseCounter(asJobCounter counter)
+{
+	ASASSERT(asJobSystem_IsCounterComplete(counter));
+	asFree(counter);
+}
+
+ASEXPORT asResults asJobSystem_Dispatch(const asJobDesc_t* pJobs, size_t count, asJobCounter counter)
+{
+	if (!count)
+		return AS_SUCCESS;
+	if (counter)
+		SDL_AtomicAdd(&counter->remaining, (int)count);
+
+	/*No workers, run inline*/
+	if (!jobSystem.running)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			struct _queuedJob job = { pJobs[i], counter };
+			_jobExecute(&job);
+		}
+		return AS_SUCCESS;
+	}
+
+	SDL_LockMutex(jobSystem.pMutex);
+	if (_jobQueueReserve(jobSystem.count + count) != AS_SUCCESS)
+	{
+		SDL_UnlockMutex(jobSystem.pMutex);
+		if (counter)
+			SDL_AtomicAdd(&counter->remaining, -(int)count);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		struct _queuedJob* pDst = &jobSystem.pJobs[(jobSystem.head + jobSystem.count) % jobSystem.capacity];
+		pDst->desc = pJobs[i];
+		pDst->counter = counter;
+		jobSystem.count++;
+	}
+	if (count == 1)
+		SDL_CondSignal(jobSystem.pJobAvailable);
+	else
+		SDL_CondBroadcast(jobSystem.pJobAvailable);
+	SDL_UnlockMutex(jobSystem.pMutex);
+	return AS_SUCCESS;
+}
+
+ASEXPORT bool asJobSystem_IsCounterComplete(asJobCounter counter)
+{
+	return SDL_AtomicGet(&counter->remaining) <= 0;
+}
+
+ASEXPORT void asJobSystem_WaitForCounter(asJobCounter counter)
+{
+	struct _queuedJob job;
+	while (!asJobSystem_IsCounterComplete(counter))
+	{
+		SDL_LockMutex(jobSystem.pMutex);
+		if (_jobQueuePop(&job))
+		{
+			SDL_UnlockMutex(jobSystem.pMutex);
+			_jobExecute(&job);
+			continue;
+		}
+		/*Nothing to help with, sleep until something finishes*/
+		if (!asJobSystem_IsCounterComplete(counter))
+			SDL_CondWaitTimeout(jobSystem.pJobComplete, jobSystem.pMutex, 1);
+		SDL_UnlockMutex(jobSystem.pMutex);
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef _ASJOBSYSTEM_H_
+#define _ASJOBSYSTEM_H_
+
+#include "../common/asCommon.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* @file
+* @brief A small worker thread pool for background work (IO, cooking, decompression)
+*/
+
+/**
+* @brief Job entry point
+*/
+typedef void (*asJobEntryFunc)(void* pUserData);
+
+/**
+* @brief Describes a single job
+*/
+typedef struct {
+	asJobEntryFunc fpEntry;
+	void* pUserData;
+} asJobDesc_t;
+
+/**
+* @brief an opaque counter that reaches zero once all jobs dispatched against it are complete
+*/
+typedef struct asJobCounterT* asJobCounter;
+
+/**
+* @brief Initializes the job system
+* @param workerCount number of worker threads (0 or less picks based on cpu count)
+* @warning The engine ignite should handle this for you
+*/
+ASEXPORT void asInitJobSystem(int32_t workerCount);
+
+/**
+* @brief Shutdown the job system (waits for queued jobs to finish)
+* @warning The engine shutdown should handle this for you
+*/
+ASEXPORT void asShutdownJobSystem();
+
+/**
+* @brief Get the number of worker threads (0 if jobs execute inline)
+*/
+ASEXPORT int32_t asJobSystem_GetWorkerCount();
+
+/**
+* @brief Create a job counter
+*/
+ASEXPORT asResults asJobSystem_CreateCounter(asJobCounter* pCounter);
+
+/**
+* @brief Release a job counter
+* @warning the counter must be complete
+*/
+ASEXPORT void asJobSystem_ReleaseCounter(asJobCounter counter);
+
+/**
+* @brief Queue jobs for the workers
+* jobs run inline on the calling thread if the job system is not initialized
+* @param counter (optional) counter incrimented by count and deincrimented as each job finishes
+*/
+ASEXPORT asResults asJobSystem_Dispatch(const asJobDesc_t* pJobs, size_t count, asJobCounter counter);
+
+/**
+* @brief Check if every job associated with a counter is complete
+*/
+ASEXPORT bool asJobSystem_IsCounterComplete(asJobCounter counter);
+
+/**
+* @brief Wait for every job associated with a counter to complete
+* the calling thread helps execute queued jobs while waiting
+*/
+ASEXPORT void asJobSystem_WaitForCounter(asJobCounter counter);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
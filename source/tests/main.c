@@ -21,7 +21,7 @@
 
 #include "engine/guiTools/cmdConsole/asCmdConsole.h"
 //#include "engine/flecs/asFlecsImplimentation.h"
-#include "engine/renderer/asTextureFromKtx.h"
+#include "engine/renderer/asTextureResource.h"
 #include "engine/renderer/asBindlessTexturePool.h"
 
 #include "engine/renderer/asSceneRenderer.h"
@@ -337,23 +337,16 @@ int main(int argc, char* argv[])
 	/*Test texture creation*/
 	{
 		asResourceType_t resourceType_Texture = asResource_RegisterType("TEXTURE", 7);
-		asResourceLoader_t file;
-		asResourceFileID_t resID;
-		if (asResourceLoader_OpenByPath(&file, &resID, "test_image", 11) != AS_SUCCESS)
+		asResourceFileID_t resID = asResource_FileIDFromRelativePath("test_image", 11);
+
+		/*Mips are read (ktx) or decoded (supercompressed) straight into staging memory*/
+		asTextureResource_t image;
+		if (asTextureResource_Open(&image, resID) != AS_SUCCESS)
 		{
 			asFatalError("Failed to open image", -1);
 		}
-
-		size_t fSize = asResourceLoader_GetContentSize(&file);
-		unsigned char* fContents = asMalloc(fSize);
-		asResourceLoader_ReadAll(&file, fSize, fContents);
-		asResourceLoader_Close(&file);
-
-		/*Todo: Load KTX*/
-		asTextureDesc_t desc = asTextureDesc_Init();
-		asTextureDesc_FromKtxData(&desc, fContents, fSize);
-		texture = asCreateTexture(&desc);
-		asTextureDesc_FreeKtxData(&desc);
+		texture = asCreateTexture(&image.desc);
+		asTextureResource_Close(&image);
 
 		//asTexturePoolAddFromHandle(texture, NULL);
 
@@ -0,0 +1,735 @@
+#include "engine/common/asCommon.h"
+#include "engine/common/asTime.h"
+#include "engine/thread/asJobSystem.h"
+#include "engine/animation/asAnimation.h"
+#include "engine/model/builder/asAnimationBuilder.h"
+#include "engine/model/runtime/asModelRuntime.h"
+#include "engine/model/runtime/asVertexEncoding.h"
+
+#include <math.h>
+
+/*A generated skeleton with generated clips is compressed and checked against its samples,
+the SSE2 and scalar paths are checked against each other, the math of the compute skinning shader is checked against the palettes
+and then a crowd is evaluated every frame (two blended layers per character) on one thread and across the job workers*/
+#define BENCH_SEED 0x616e696d42656e63ull
+#define BENCH_BONE_COUNT 64
+#define BENCH_CHARACTER_COUNT 300
+#define BENCH_FRAMES 240
+#define BENCH_FRAME_TIME (1.0f / 60.0f)
+#define BENCH_TEST_POSES 1000
+#define BENCH_SKIN_POSES 16
+#define BENCH_SKIN_VERTICES 4096
+
+static uint64_t _xorshift64(uint64_t* pState)
+{
+	uint64_t x = *pState;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *pState = x;
+}
+
+static float _randomUnit(uint64_t* pState)
+{
+	return (float)(_xorshift64(pState) >> 40) / (float)(1 << 24);
+}
+
+static void _axisAngle(const float axis[3], float angle, float out[4])
+{
+	const float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	const float s = sinf(angle * 0.5f) / length;
+	out[0] = axis[0] * s;
+	out[1] = axis[1] * s;
+	out[2] = axis[2] * s;
+	out[3] = cosf(angle * 0.5f);
+}
+
+/*------------------------------------GENERATED DATA------------------------------------*/
+
+/*A branching tree, the last bone only moves its children so has no palette entry*/
+static void _buildSkeleton(asAnimBuilderBone_t* pBones, uint32_t boneCount)
+{
+	mat4* pModel = asMalloc(sizeof(mat4) * boneCount);
+	for (uint32_t i = 0; i < boneCount; i++)
+	{
+		asAnimBuilderBone_t* pBone = &pBones[i];
+		memset(pBone, 0, sizeof(asAnimBuilderBone_t));
+		snprintf(pBone->name, AS_ANIM_MAX_NAME, "bone_%u", i);
+		pBone->parent = i ? (int32_t)(i - 1) / 3 : -1;
+		pBone->paletteIndex = i == boneCount - 1 ? AS_ANIM_NO_PALETTE : boneCount - 2 - i;
+		const float axis[3] = { 0.3f, 1.0f, 0.1f * (float)(i % 5) };
+		_axisAngle(axis, 0.1f * (float)(i % 7), pBone->restRotation);
+		pBone->restTranslation[1] = 0.1f * (float)(i % 4 + 1);
+		pBone->restScale[0] = pBone->restScale[1] = pBone->restScale[2] = 1.0f;
+
+		/*Inverse of the rest pose in model space*/
+		versor q = { pBone->restRotation[0], pBone->restRotation[1], pBone->restRotation[2], pBone->restRotation[3] };
+		mat4 local;
+		glm_quat_mat4(q, local);
+		memcpy(local[3], pBone->restTranslation, sizeof(float) * 3);
+		if (pBone->parent >= 0)
+			glm_mat4_mul(pModel[pBone->parent], local, pModel[i]);
+		else
+			glm_mat4_copy(local, pModel[i]);
+		glm_mat4_inv(pModel[i], pBone->inverseBind);
+	}
+	asFree(pModel);
+}
+
+typedef struct {
+	asAnimBuilderClip_t clip;
+	float* pRotations;
+	float* pTranslations;
+	float* pScales;
+} benchClip;
+
+/*Every bone swings around its own axis, the root walks and bobs and a few bones squash,
+the idle clip only breathes with a few bones so most of its tracks are constant*/
+static void _buildClip(benchClip* pOut, const asAnimBuilderBone_t* pBones, uint32_t boneCount, bool idle)
+{
+	asAnimBuilderClip_t* pClip = &pOut->clip;
+	memset(pOut, 0, sizeof(benchClip));
+	snprintf(pClip->name, AS_ANIM_MAX_NAME, "%s", idle ? "idle" : "walk");
+	pClip->sampleRate = 30.0f;
+	pClip->frameCount = idle ? 121 : 61;
+	const uint32_t frames = pClip->frameCount;
+	pOut->pRotations = asMalloc(sizeof(float) * 4 * frames * boneCount);
+	pOut->pTranslations = asMalloc(sizeof(float) * 3 * frames * boneCount);
+	pOut->pScales = idle ? NULL : asMalloc(sizeof(float) * 3 * frames * boneCount);
+	for (uint32_t b = 0; b < boneCount; b++)
+	{
+		const float axis[3] = { 1.0f, 0.2f * (float)(b % 3), 0.5f - 0.1f * (float)(b % 11) };
+		const bool moving = !idle || b % 8 == 0;
+		for (uint32_t f = 0; f < frames; f++)
+		{
+			const float t = (float)f / (float)(frames - 1);
+			const float phase = 6.2831853f * t + 0.37f * (float)b;
+			float swing[4];
+			_axisAngle(axis, moving ? (idle ? 0.05f : 0.6f) * sinf(phase) : 0.0f, swing);
+			versor rest = { pBones[b].restRotation[0], pBones[b].restRotation[1], pBones[b].restRotation[2], pBones[b].restRotation[3] };
+			versor q;
+			glm_quat_mul(rest, swing, q);
+			memcpy(&pOut->pRotations[(b * frames + f) * 4], q, sizeof(float) * 4);
+
+			float* pT = &pOut->pTranslations[(b * frames + f) * 3];
+			memcpy(pT, pBones[b].restTranslation, sizeof(float) * 3);
+			if (b == 0 && !idle)
+			{
+				pT[1] += 0.05f * sinf(2.0f * phase);
+				pT[2] += 1.5f * t;
+			}
+			if (pOut->pScales)
+			{
+				float* pS = &pOut->pScales[(b * frames + f) * 3];
+				pS[0] = pS[2] = 1.0f;
+				pS[1] = b % 16 == 5 ? 1.0f + 0.2f * sinf(phase) : 1.0f;
+			}
+		}
+	}
+	pClip->pRotations = pOut->pRotations;
+	pClip->pTranslations = pOut->pTranslations;
+	pClip->pScales = pOut->pScales;
+}
+
+static void _freeClip(benchClip* pClip)
+{
+	asFree(pClip->pRotations);
+	asFree(pClip->pTranslations);
+	asFree(pClip->pScales);
+}
+
+/*------------------------------------TESTS------------------------------------*/
+
+/*Angle between rotations from the chord between them (acos() near 1 is too coarse)*/
+static double _rotationError(const float* a, const float* b)
+{
+	double lengthA = 0.0, lengthB = 0.0;
+	for (int c = 0; c < 4; c++)
+	{
+		lengthA += (double)a[c] * a[c];
+		lengthB += (double)b[c] * b[c];
+	}
+	double minus = 0.0, plus = 0.0;
+	for (int c = 0; c < 4; c++)
+	{
+		const double dA = a[c] / sqrt(lengthA), dB = b[c] / sqrt(lengthB);
+		minus += (dA - dB) * (dA - dB);
+		plus += (dA + dB) * (dA + dB);
+	}
+	const double chord = sqrt(minus < plus ? minus : plus) * 0.5;
+	return 4.0 * asin(chord < 1.0 ? chord : 1.0);
+}
+
+/*Every frame sampled back from the relocated blob has to be within tolerance of the source,
+sampling forward with a cache has to give exactly what a search gives*/
+static int _testCompression(const asAnimation_t* pAnim, const benchClip* pClips, uint32_t clipCount, const asAnimBuilderCompressDesc_t* pDesc)
+{
+	int result = 0;
+	const uint32_t boneCount = pAnim->boneCount;
+	asAnimSoaTransform_t* pPose = asMalloc(sizeof(asAnimSoaTransform_t) * AS_ANIM_SOA_COUNT(boneCount));
+	asAnimSoaTransform_t* pCachedPose = asMalloc(sizeof(asAnimSoaTransform_t) * AS_ANIM_SOA_COUNT(boneCount));
+	asAnimSamplingCache_t cache;
+	asAnimSamplingCache_Init(&cache, boneCount);
+	for (uint32_t i = 0; i < clipCount; i++)
+	{
+		const asAnimBuilderClip_t* pSrc = &pClips[i].clip;
+		const asAnimClip_t* pClip = asAnimation_FindClip(pAnim, pSrc->name);
+		if (!pClip || !asAnimation_IsClipCompatible(pAnim, pClip))
+		{
+			asDebugLog("[ERROR]> Clip %s is missing", pSrc->name);
+			result |= 1;
+			continue;
+		}
+		double maxErrors[3] = { 0.0, 0.0, 0.0 };
+		bool cacheMatches = true;
+		for (uint32_t f = 0; f < pSrc->frameCount; f++)
+		{
+			const float time = (float)f / pSrc->sampleRate;
+			asAnimation_SampleClip(pClip, time, NULL, pPose);
+			asAnimation_SampleClip(pClip, time, &cache, pCachedPose);
+			cacheMatches &= memcmp(pPose, pCachedPose, sizeof(asAnimSoaTransform_t) * AS_ANIM_SOA_COUNT(boneCount)) == 0;
+			for (uint32_t b = 0; b < boneCount; b++)
+			{
+				const asAnimSoaTransform_t* pSoa = &pPose[b / 4];
+				const uint32_t lane = b % 4;
+				const size_t sample = (size_t)b * pSrc->frameCount + f;
+				const float q[4] = { pSoa->rotation[0][lane], pSoa->rotation[1][lane], pSoa->rotation[2][lane], pSoa->rotation[3][lane] };
+				const double error = _rotationError(q, &pSrc->pRotations[sample * 4]);
+				maxErrors[0] = error > maxErrors[0] ? error : maxErrors[0];
+				double distance = 0.0;
+				double scale = 0.0;
+				for (int c = 0; c < 3; c++)
+				{
+					const double d = (double)pSoa->translation[c][lane] - (double)pSrc->pTranslations[sample * 3 + c];
+					distance += d * d;
+					const double s = fabs((double)pSoa->scale[c][lane] - (pSrc->pScales ? (double)pSrc->pScales[sample * 3 + c] : 1.0));
+					scale = s > scale ? s : scale;
+				}
+				maxErrors[1] = sqrt(distance) > maxErrors[1] ? sqrt(distance) : maxErrors[1];
+				maxErrors[2] = scale > maxErrors[2] ? scale : maxErrors[2];
+			}
+		}
+		/*Sampling by time lands a hair off the frames so allow for float error*/
+		const bool withinTolerance = maxErrors[0] <= pDesc->rotationTolerance + 1e-5 &&
+			maxErrors[1] <= pDesc->translationTolerance + 1e-5 && maxErrors[2] <= pDesc->scaleTolerance + 1e-5;
+		asDebugLog("%s: %u frames, %u keys, errors %.6f rad %.6f units %.6f scale%s", pSrc->name, pClip->frameCount, pClip->keyCount,
+			maxErrors[0], maxErrors[1], maxErrors[2], withinTolerance ? "" : " (over tolerance)");
+		if (!withinTolerance || !cacheMatches)
+		{
+			asDebugLog("[ERROR]> %s does not sample back correctly (cache %s)", pSrc->name, cacheMatches ? "matches" : "differs");
+			result |= 1;
+		}
+	}
+	asAnimSamplingCache_Free(&cache);
+	asFree(pPose);
+	asFree(pCachedPose);
+	return result;
+}
+
+/*Broken blobs are refused without being touched*/
+static int _testRelocate(const void* pBlob, size_t size)
+{
+	int result = 0;
+	uint8_t* pCopy = asMalloc(size);
+	asAnimation_t* pAnim;
+	const size_t corruptions[3] = { 0, offsetof(asAnimation_t, bones), offsetof(asAnimation_t, clips) };
+	for (int i = 0; i < 3; i++)
+	{
+		memcpy(pCopy, pBlob, size);
+		pCopy[corruptions[i] + 3] ^= 0x40;
+		uint8_t* pExpected = asMalloc(size);
+		memcpy(pExpected, pCopy, size);
+		if (asAnimation_Relocate(pCopy, size, &pAnim) == AS_SUCCESS || memcmp(pCopy, pExpected, size) != 0)
+		{
+			asDebugLog("[ERROR]> Corrupt blob %d was accepted or modified", i);
+			result |= 1;
+		}
+		asFree(pExpected);
+	}
+	memcpy(pCopy, pBlob, size);
+	if (asAnimation_Relocate(pCopy, size - AS_ANIM_ALIGNMENT, &pAnim) == AS_SUCCESS)
+	{
+		asDebugLog("%s", "[ERROR]> Truncated blob was accepted");
+		result |= 1;
+	}
+	asFree(pCopy);
+	return result;
+}
+
+static void _randomDesc(uint64_t* pState, const asAnimation_t* pAnim, asAnimEvaluateDesc_t* pDesc, asAnimPaletteMatrix_t* pPalette)
+{
+	memset(pDesc, 0, sizeof(asAnimEvaluateDesc_t));
+	pDesc->pSkeleton = pAnim;
+	pDesc->pPalette = pPalette;
+	pDesc->layerCount = 2;
+	for (uint32_t l = 0; l < 2; l++)
+	{
+		pDesc->layers[l].pClip = &pAnim->clips.ptr[l % pAnim->clipCount];
+		pDesc->layers[l].time = _randomUnit(pState) * pDesc->layers[l].pClip->duration;
+		pDesc->layers[l].weight = _randomUnit(pState);
+	}
+}
+
+/*The SSE2 paths do the same operations in the same order as the scalar ones*/
+static int _testSimd(const asAnimation_t* pAnim, uint64_t seed)
+{
+	if (!asAnimation_SetSimdEnabled(true))
+	{
+		asDebugLog("%s", "SSE2 is not available, skipping the SIMD comparison");
+		return 0;
+	}
+	const size_t paletteSize = sizeof(asAnimPaletteMatrix_t) * pAnim->paletteCount;
+	asAnimPaletteMatrix_t* pScalar = asMalloc(paletteSize);
+	asAnimPaletteMatrix_t* pSimd = asMalloc(paletteSize);
+	uint64_t state = seed;
+	size_t mismatches = 0;
+	float maxDifference = 0.0f;
+	for (int i = 0; i < BENCH_TEST_POSES; i++)
+	{
+		asAnimEvaluateDesc_t desc;
+		_randomDesc(&state, pAnim, &desc, pScalar);
+		asAnimation_SetSimdEnabled(false);
+		asAnimation_Evaluate(&desc);
+		desc.pPalette = pSimd;
+		asAnimation_SetSimdEnabled(true);
+		asAnimation_Evaluate(&desc);
+		if (memcmp(pScalar, pSimd, paletteSize) == 0)
+			continue;
+		mismatches++;
+		const float* pA = &pScalar[0].rows[0][0];
+		const float* pB = &pSimd[0].rows[0][0];
+		for (size_t f = 0; f < paletteSize / sizeof(float); f++)
+			maxDifference = fabsf(pA[f] - pB[f]) > maxDifference ? fabsf(pA[f] - pB[f]) : maxDifference;
+	}
+	asFree(pScalar);
+	asFree(pSimd);
+	asDebugLog("SSE2 against scalar: %zu of %d palettes differ (largest difference %g)", mismatches, BENCH_TEST_POSES, maxDifference);
+	return mismatches ? 1 : 0;
+}
+
+/*------------------------------------SKINNING------------------------------------*/
+
+/*CPU port of Skinning_FX.glsl (keep the two in step), skins the words of one asVertexGeneric*/
+#define SKIN_VERTEX_WORDS (sizeof(asVertexGeneric) / 4)
+
+static float _skinSnorm(int32_t packed, int offset, int bits, float scale)
+{
+	const int32_t value = (int32_t)((uint32_t)packed << (32 - offset - bits)) >> (32 - bits); /*bitfieldExtract() of an int*/
+	const float result = (float)value / scale;
+	return result > -1.0f ? result : -1.0f;
+}
+
+static void _skinDecodeSnorm10(uint32_t packed, float out[3])
+{
+	out[0] = _skinSnorm((int32_t)packed, 20, 10, 511.0f);
+	out[1] = _skinSnorm((int32_t)packed, 10, 10, 511.0f);
+	out[2] = _skinSnorm((int32_t)packed, 0, 10, 511.0f);
+}
+
+static uint32_t _skinEncodeSnorm10(const float v[3], uint32_t w)
+{
+	uint32_t q[3];
+	for (int c = 0; c < 3; c++)
+	{
+		const float clamped = v[c] < -1.0f ? -1.0f : (v[c] > 1.0f ? 1.0f : v[c]);
+		q[c] = (uint32_t)(int32_t)nearbyintf(clamped * 511.0f) & 0x3FF; /*roundEven()*/
+	}
+	return q[2] | (q[1] << 10) | (q[0] << 20) | (w << 30);
+}
+
+static void _skinDecodeOctahedral(uint32_t packed, float out[3])
+{
+	float xy[2] = { _skinSnorm((int32_t)packed, 0, 16, 32767.0f), _skinSnorm((int32_t)packed, 16, 16, 32767.0f) };
+	const float z = (1.0f - fabsf(xy[0])) - fabsf(xy[1]);
+	const float t = -z > 0.0f ? -z : 0.0f;
+	xy[0] += xy[0] >= 0.0f ? -t : t;
+	xy[1] += xy[1] >= 0.0f ? -t : t;
+	const float length = sqrtf(xy[0] * xy[0] + xy[1] * xy[1] + z * z);
+	out[0] = xy[0] / length;
+	out[1] = xy[1] / length;
+	out[2] = z / length;
+}
+
+static uint32_t _skinEncodeOctahedral(const float n[3])
+{
+	float sum = (fabsf(n[0]) + fabsf(n[1])) + fabsf(n[2]);
+	sum = sum > 0.0f ? sum : 1.0f;
+	float xy[2] = { n[0] / sum, n[1] / sum };
+	if (n[2] < 0.0f)
+	{
+		const float x = (1.0f - fabsf(xy[1])) * (xy[0] >= 0.0f ? 1.0f : -1.0f);
+		const float y = (1.0f - fabsf(xy[0])) * (xy[1] >= 0.0f ? 1.0f : -1.0f);
+		xy[0] = x;
+		xy[1] = y;
+	}
+	uint32_t q[2];
+	for (int c = 0; c < 2; c++)
+	{
+		const float clamped = xy[c] < -1.0f ? -1.0f : (xy[c] > 1.0f ? 1.0f : xy[c]);
+		q[c] = (uint32_t)(int32_t)nearbyintf(clamped * 32767.0f) & 0xFFFF;
+	}
+	return q[0] | (q[1] << 16);
+}
+
+static void _skinNormalize(float v[3])
+{
+	const float size = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	if (size > 0.0f)
+	{
+		for (int c = 0; c < 3; c++)
+			v[c] /= size;
+	}
+}
+
+static void _skinVertex(const uint32_t* pSrc, const asAnimPaletteMatrix_t* pPalette, bool octahedral, uint32_t* pDst)
+{
+	for (size_t i = 5; i < SKIN_VERTEX_WORDS; i++)
+		pDst[i] = pSrc[i];
+	const uint32_t bones[4] = { pSrc[8] & 0xFFFF, pSrc[8] >> 16, pSrc[9] & 0xFFFF, pSrc[9] >> 16 };
+	float weights[4];
+	for (int i = 0; i < 4; i++)
+		weights[i] = (float)((pSrc[10] >> (i * 8)) & 0xFF) / 255.0f; /*unpackUnorm4x8()*/
+	if (weights[0] + weights[1] + weights[2] + weights[3] <= 0.0f)
+	{
+		memcpy(pDst, pSrc, sizeof(uint32_t) * 5);
+		return;
+	}
+	float rows[3][4] = { { 0.0f } };
+	for (int i = 0; i < 4; i++)
+	{
+		if (weights[i] <= 0.0f)
+			continue;
+		for (int r = 0; r < 3; r++)
+		{
+			for (int c = 0; c < 4; c++)
+				rows[r][c] += pPalette[bones[i]].rows[r][c] * weights[i];
+		}
+	}
+
+	float position[3];
+	memcpy(position, pSrc, sizeof(position));
+	for (int r = 0; r < 3; r++)
+	{
+		const float skinned = rows[r][0] * position[0] + rows[r][1] * position[1] + rows[r][2] * position[2] + rows[r][3];
+		memcpy(&pDst[r], &skinned, sizeof(float));
+	}
+
+	float normal[3], tangent[3], skinnedNormal[3], skinnedTangent[3];
+	if (octahedral)
+		_skinDecodeOctahedral(pSrc[3], normal);
+	else
+		_skinDecodeSnorm10(pSrc[3], normal);
+	_skinDecodeSnorm10(pSrc[4], tangent);
+	for (int r = 0; r < 3; r++)
+	{
+		skinnedNormal[r] = rows[r][0] * normal[0] + rows[r][1] * normal[1] + rows[r][2] * normal[2];
+		skinnedTangent[r] = rows[r][0] * tangent[0] + rows[r][1] * tangent[1] + rows[r][2] * tangent[2];
+	}
+	_skinNormalize(skinnedNormal);
+	_skinNormalize(skinnedTangent);
+	pDst[3] = octahedral ? _skinEncodeOctahedral(skinnedNormal) : _skinEncodeSnorm10(skinnedNormal, 0);
+	pDst[4] = _skinEncodeSnorm10(skinnedTangent, pSrc[4] >> 30);
+}
+
+static double _skinAngle(const float a[3], const float b[3])
+{
+	const double dot = (double)a[0] * b[0] + (double)a[1] * b[1] + (double)a[2] * b[2];
+	const double lengths = sqrt(((double)a[0] * a[0] + (double)a[1] * a[1] + (double)a[2] * a[2]) *
+		((double)b[0] * b[0] + (double)b[1] * b[1] + (double)b[2] * b[2]));
+	const double cosine = lengths > 0.0 ? dot / lengths : 1.0;
+	return acos(cosine < 1.0 ? (cosine > -1.0 ? cosine : -1.0) : 1.0);
+}
+
+/*Vertices skinned by the port of the shader from the palette have to land within the packing error
+of the unpacked vertices skinned in double precision by the model matrices and inverse binds of the bones*/
+static int _testSkinning(const asAnimation_t* pAnim, uint64_t seed)
+{
+	int result = 0;
+	const uint32_t paletteCount = pAnim->paletteCount;
+	uint32_t* pPaletteBones = asMalloc(sizeof(uint32_t) * paletteCount);
+	for (uint32_t b = 0; b < pAnim->boneCount; b++)
+	{
+		if (pAnim->bones.ptr[b].paletteIndex != AS_ANIM_NO_PALETTE)
+			pPaletteBones[pAnim->bones.ptr[b].paletteIndex] = b;
+	}
+	asAnimPaletteMatrix_t* pPalette = asMalloc(sizeof(asAnimPaletteMatrix_t) * paletteCount);
+	mat4* pModel = asMalloc(sizeof(mat4) * pAnim->boneCount);
+
+	/*Bind pose vertices, every 64th without weights*/
+	uint64_t state = seed;
+	float* pPositions = asMalloc(sizeof(float) * 3 * BENCH_SKIN_VERTICES);
+	float* pNormals = asMalloc(sizeof(float) * 3 * BENCH_SKIN_VERTICES);
+	float* pTangents = asMalloc(sizeof(float) * 4 * BENCH_SKIN_VERTICES);
+	uint16_t* pBoneIds = asMalloc(sizeof(uint16_t) * 4 * BENCH_SKIN_VERTICES);
+	float* pWeights = asMalloc(sizeof(float) * 4 * BENCH_SKIN_VERTICES);
+	for (uint32_t v = 0; v < BENCH_SKIN_VERTICES; v++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			pPositions[v * 3 + c] = 2.0f * _randomUnit(&state) - 1.0f;
+			pNormals[v * 3 + c] = 2.0f * _randomUnit(&state) - 1.0f;
+			pTangents[v * 4 + c] = 2.0f * _randomUnit(&state) - 1.0f;
+		}
+		_skinNormalize(&pNormals[v * 3]);
+		_skinNormalize(&pTangents[v * 4]);
+		pTangents[v * 4 + 3] = v % 2 ? 1.0f : -1.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			pBoneIds[v * 4 + i] = (uint16_t)(_xorshift64(&state) % paletteCount);
+			pWeights[v * 4 + i] = v % 64 == 0 ? 0.0f : _randomUnit(&state) * (float)(i + 1);
+		}
+	}
+	asVertexGeneric* pSource = asMalloc(sizeof(asVertexGeneric) * BENCH_SKIN_VERTICES);
+	uint32_t* pSkinned = asMalloc(sizeof(asVertexGeneric) * BENCH_SKIN_VERTICES);
+
+	for (int encoding = 0; encoding < 2; encoding++)
+	{
+		const bool octahedral = encoding == 1;
+		asVertexGenericStreams_t streams = { 0 };
+		streams.pPositions = pPositions;
+		streams.pNormals = pNormals;
+		streams.pTangents = pTangents;
+		streams.pBoneIds = pBoneIds;
+		streams.pBoneWeights = pWeights;
+		streams.normalEncoding = octahedral ? AS_VERTEX_NORMAL_OCTAHEDRAL : AS_VERTEX_NORMAL_SNORM10;
+		asVertexGeneric_encodeBatch(pSource, BENCH_SKIN_VERTICES, &streams);
+
+		double maxPosition = 0.0, maxNormal = 0.0, maxTangent = 0.0;
+		size_t wrongWords = 0, encodeMismatches = 0;
+		for (int p = 0; p < BENCH_SKIN_POSES; p++)
+		{
+			asAnimEvaluateDesc_t desc;
+			_randomDesc(&state, pAnim, &desc, pPalette);
+			desc.pModelMatrices = pModel;
+			asAnimation_Evaluate(&desc);
+			for (uint32_t v = 0; v < BENCH_SKIN_VERTICES; v++)
+			{
+				const uint32_t* pSrc = (const uint32_t*)&pSource[v];
+				uint32_t* pDst = &pSkinned[v * SKIN_VERTEX_WORDS];
+				_skinVertex(pSrc, pPalette, octahedral, pDst);
+				if (memcmp(&pDst[5], &pSrc[5], sizeof(uint32_t) * (SKIN_VERTEX_WORDS - 5)) != 0)
+					wrongWords++;
+
+				/*Reference from the unpacked attributes*/
+				float position[3], normal[3], tangent[4], weights[4];
+				memcpy(position, pSrc, sizeof(position));
+				asVertexDecode_Normals(normal, &pSrc[3], 1, streams.normalEncoding);
+				asVertexDecode_Tangents(tangent, &pSrc[4], 1);
+				asVertexDecode_BoneWeights(weights, &pSrc[10], 1);
+				double skin[4][4] = { { 0.0 } };
+				const bool weighted = weights[0] + weights[1] + weights[2] + weights[3] > 0.0f;
+				for (int i = 0; i < 4 && weighted; i++)
+				{
+					const uint32_t bone = pPaletteBones[pSource[v].boneIdx[i]];
+					for (int c = 0; c < 4; c++)
+					{
+						for (int r = 0; r < 4; r++)
+						{
+							double value = 0.0;
+							for (int k = 0; k < 4; k++)
+								value += (double)pModel[bone][k][r] * pAnim->inverseBinds.ptr[bone][c][k];
+							skin[c][r] += value * weights[i];
+						}
+					}
+				}
+				if (!weighted)
+				{
+					for (int c = 0; c < 4; c++)
+						skin[c][c] = 1.0;
+				}
+				float expected[3][3];
+				for (int r = 0; r < 3; r++)
+				{
+					expected[0][r] = (float)(skin[0][r] * position[0] + skin[1][r] * position[1] + skin[2][r] * position[2] + skin[3][r]);
+					expected[1][r] = (float)(skin[0][r] * normal[0] + skin[1][r] * normal[1] + skin[2][r] * normal[2]);
+					expected[2][r] = (float)(skin[0][r] * tangent[0] + skin[1][r] * tangent[1] + skin[2][r] * tangent[2]);
+				}
+
+				float skinnedPosition[3], skinnedNormal[3], skinnedTangent[4];
+				memcpy(skinnedPosition, pDst, sizeof(skinnedPosition));
+				asVertexDecode_Normals(skinnedNormal, &pDst[3], 1, streams.normalEncoding);
+				asVertexDecode_Tangents(skinnedTangent, &pDst[4], 1);
+				for (int c = 0; c < 3; c++)
+				{
+					const double error = fabs((double)skinnedPosition[c] - expected[0][c]);
+					maxPosition = error > maxPosition ? error : maxPosition;
+				}
+				const double normalError = _skinAngle(skinnedNormal, expected[1]);
+				const double tangentError = _skinAngle(skinnedTangent, expected[2]);
+				maxNormal = normalError > maxNormal ? normalError : maxNormal;
+				maxTangent = tangentError > maxTangent ? tangentError : maxTangent;
+				if (skinnedTangent[3] != tangent[3])
+					wrongWords++;
+
+				/*The shader packs like the vertex encoders*/
+				float unpacked[3];
+				memcpy(unpacked, expected[1], sizeof(unpacked));
+				_skinNormalize(unpacked);
+				uint32_t shaderPacked = octahedral ? _skinEncodeOctahedral(unpacked) : _skinEncodeSnorm10(unpacked, 0);
+				uint32_t encoderPacked;
+				asVertexEncode_Normals(&encoderPacked, unpacked, 1, streams.normalEncoding);
+				if (shaderPacked != encoderPacked)
+					encodeMismatches++;
+			}
+		}
+		/*Packing twice (bind pose and skinned) at 10 bits or 16 bits for octahedral normals*/
+		const double normalTolerance = octahedral ? 0.0002 : 0.006;
+		const bool withinTolerance = maxPosition <= 1e-4 && maxNormal <= normalTolerance && maxTangent <= 0.006;
+		asDebugLog("Skinning (%s normals): errors %.7f units %.6f rad normals %.6f rad tangents, %zu copied words differ, %zu packings differ%s",
+			octahedral ? "octahedral" : "10 bit", maxPosition, maxNormal, maxTangent, wrongWords, encodeMismatches,
+			withinTolerance ? "" : " (over tolerance)");
+		if (!withinTolerance || wrongWords || encodeMismatches)
+		{
+			asDebugLog("%s", "[ERROR]> Skinning does not match the palette");
+			result |= 1;
+		}
+	}
+	asFree(pPaletteBones);
+	asFree(pPalette);
+	asFree(pModel);
+	asFree(pPositions);
+	asFree(pNormals);
+	asFree(pTangents);
+	asFree(pBoneIds);
+	asFree(pWeights);
+	asFree(pSource);
+	asFree(pSkinned);
+	return result;
+}
+
+/*------------------------------------BENCHMARK------------------------------------*/
+
+typedef enum {
+	BENCH_PASS_SCALAR,
+	BENCH_PASS_SIMD,
+	BENCH_PASS_JOBS,
+	BENCH_PASS_COUNT
+} benchPass;
+
+static const char* gPassNames[BENCH_PASS_COUNT] = { "scalar, one thread", "SSE2, one thread", "SSE2, job workers" };
+
+static int _benchmark(const asAnimation_t* pAnim, size_t characterCount, uint64_t seed)
+{
+	asAnimEvaluateDesc_t* pDescs = asMalloc(sizeof(asAnimEvaluateDesc_t) * characterCount);
+	asAnimSamplingCache_t* pCaches = asMalloc(sizeof(asAnimSamplingCache_t) * characterCount * 2);
+	asAnimPaletteMatrix_t* pPalettes = asMalloc(sizeof(asAnimPaletteMatrix_t) * pAnim->paletteCount * characterCount);
+	if (!pDescs || !pCaches || !pPalettes)
+	{
+		asDebugLog("%s", "[ERROR]> Out of memory");
+		return 2;
+	}
+	asDebugLog("%zu characters of %u bones with 2 layers, %d workers", characterCount, pAnim->boneCount, asJobSystem_GetWorkerCount());
+	int result = 0;
+	for (int pass = 0; pass < BENCH_PASS_COUNT; pass++)
+	{
+		uint64_t state = seed;
+		for (size_t c = 0; c < characterCount; c++)
+		{
+			_randomDesc(&state, pAnim, &pDescs[c], &pPalettes[pAnim->paletteCount * c]);
+			for (uint32_t l = 0; l < 2; l++)
+			{
+				asAnimSamplingCache_Init(&pCaches[c * 2 + l], pAnim->boneCount);
+				pDescs[c].layers[l].pCache = &pCaches[c * 2 + l];
+			}
+		}
+		asAnimation_SetSimdEnabled(pass != BENCH_PASS_SCALAR);
+		double worstMs = 0.0;
+		uint64_t totalTicks = 0;
+		asTimer_t timer = asTimerStart();
+		for (int frame = 0; frame < BENCH_FRAMES; frame++)
+		{
+			/*Play the clips forward and loop them*/
+			for (size_t c = 0; c < characterCount; c++)
+			{
+				for (uint32_t l = 0; l < 2; l++)
+				{
+					asAnimLayer_t* pLayer = &pDescs[c].layers[l];
+					pLayer->time += BENCH_FRAME_TIME;
+					if (pLayer->time > pLayer->pClip->duration)
+						pLayer->time -= pLayer->pClip->duration;
+				}
+			}
+			timer = asTimerRestart(timer);
+			asResults evalResult = AS_SUCCESS;
+			if (pass == BENCH_PASS_JOBS)
+				evalResult = asAnimation_EvaluateBatch(pDescs, characterCount);
+			for (size_t c = 0; pass != BENCH_PASS_JOBS && c < characterCount && evalResult == AS_SUCCESS; c++)
+				evalResult = asAnimation_Evaluate(&pDescs[c]);
+			const uint64_t ticks = asTimerTicksElapsed(timer);
+			if (evalResult != AS_SUCCESS)
+			{
+				asDebugLog("[ERROR]> Evaluation failed (%d)", evalResult);
+				result |= 1;
+				break;
+			}
+			totalTicks += ticks;
+			const double ms = asTimerSeconds(timer, ticks) * 1000.0;
+			worstMs = ms > worstMs ? ms : worstMs;
+		}
+		const double averageMs = asTimerSeconds(timer, totalTicks) * 1000.0 / BENCH_FRAMES;
+		asDebugLog("%s: %.3f ms per frame (worst %.3f ms), %.2f us per character", gPassNames[pass], averageMs, worstMs,
+			averageMs * 1000.0 / (double)characterCount);
+		for (size_t c = 0; c < characterCount * 2; c++)
+			asAnimSamplingCache_Free(&pCaches[c]);
+	}
+	asAnimation_SetSimdEnabled(true);
+	asFree(pDescs);
+	asFree(pCaches);
+	asFree(pPalettes);
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Skeletal Animation Benchmark...");
+	const size_t characterCount = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : BENCH_CHARACTER_COUNT;
+
+	asAnimBuilderBone_t* pBones = asMalloc(sizeof(asAnimBuilderBone_t) * BENCH_BONE_COUNT);
+	benchClip clips[2];
+	_buildSkeleton(pBones, BENCH_BONE_COUNT);
+	_buildClip(&clips[0], pBones, BENCH_BONE_COUNT, false);
+	_buildClip(&clips[1], pBones, BENCH_BONE_COUNT, true);
+	const asAnimBuilderClip_t builderClips[2] = { clips[0].clip, clips[1].clip };
+
+	const asAnimBuilderCompressDesc_t desc = asAnimBuilderCompressDesc_Init();
+	asAnimBuilderStats_t stats;
+	void* pBlob;
+	size_t size;
+	asTimer_t timer = asTimerStart();
+	asResults buildResult = asAnimBuilder_Build(pBones, BENCH_BONE_COUNT, builderClips, 2, &desc, &pBlob, &size, &stats);
+	const double buildSeconds = asTimerSeconds(timer, asTimerTicksElapsed(timer));
+	if (buildResult != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Could not build the animation (%d)", buildResult);
+		return 3;
+	}
+	asDebugLog("Compressed in %.1f ms: %u constant and %u animated tracks, %u keys, %zu bytes from %zu (%.1fx)", buildSeconds * 1000.0,
+		stats.constantTracks, stats.animatedTracks, stats.keyCount, stats.size, stats.sampledSize, (double)stats.sampledSize / (double)stats.size);
+	asDebugLog("Largest errors while fitting: %.6f rad %.6f units %.6f scale", stats.maxRotationError, stats.maxTranslationError, stats.maxScaleError);
+
+	int result = _testRelocate(pBlob, size);
+	asAnimation_t* pAnim;
+	if (asAnimation_Relocate(pBlob, size, &pAnim) != AS_SUCCESS)
+	{
+		asDebugLog("%s", "[ERROR]> Could not relocate the animation");
+		return 3;
+	}
+	asAnimation_SetSimdEnabled(false);
+	result |= _testCompression(pAnim, clips, 2, &desc);
+	asAnimation_SetSimdEnabled(true);
+	result |= _testCompression(pAnim, clips, 2, &desc);
+	result |= _testSimd(pAnim, BENCH_SEED);
+	result |= _testSkinning(pAnim, BENCH_SEED);
+
+	if (!result)
+	{
+		asInitJobSystem(0);
+		result |= _benchmark(pAnim, characterCount ? characterCount : BENCH_CHARACTER_COUNT, BENCH_SEED);
+		asShutdownJobSystem();
+	}
+	asFree(pBlob);
+	_freeClip(&clips[0]);
+	_freeClip(&clips[1]);
+	asFree(pBones);
+	return result;
+}
@@ -0,0 +1,1772 @@
+#include "engine/common/asCommon.h"
+#include "engine/common/asBin.h"
+#include "engine/thread/asJobSystem.h"
+#include "engine/renderer/asBlockCompression.h"
+#include "engine/renderer/asMipGeneration.h"
+#include "engine/renderer/asTextureAtlas.h"
+#include "engine/renderer/asTextureFromKtx.h"
+#include "engine/renderer/asTextureLz4.h"
+#include "engine/model/builder/asMeshBuildingAPI.h"
+#include "engine/model/builder/asAnimationBuilder.h"
+#include "engine/resource/asResourceManifest.h"
+
+#include <SDL_filesystem.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <spawn.h>
+extern char** environ;
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb/stb_image.h"
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf/cgltf.h"
+
+/*COOK phase: run file processors over source directories into the build resource directory*/
+
+#define COOK_MAX_PATH 1024
+#define COOK_CONFIG_NAME "cook.cfg"
+#define COOK_CACHE_EXT ".ascookcache"
+#define COOK_CACHE_TAG "ACOK"
+#define COOK_CACHE_VERSION 1
+#define COOK_OVERRIDE_EXT ".ASRC_OVERRIDE"
+#define COOK_PAKCFG_EXT ".ASRC_PAKCFG"
+#define COOK_PAK_CACHE_DIR "_ASPAK_CACHE_/"
+
+/*Processors*/
+
+typedef struct cookItem cookItem;
+typedef asResults(*cookProcessFunc)(const cookItem* pItem);
+typedef asHash64_t(*cookDependencyFunc)(const cookItem* pItem);
+
+typedef struct {
+	const char* pName;
+	uint32_t version; /*Bump whenever the output for the same input and settings changes*/
+	const char* pOutputExtension; /*Replaces the source extension (NULL keeps it)*/
+	cookProcessFunc fpProcess;
+	cookDependencyFunc fpHashDependencies; /*Hash of the other files the output is made from (NULL if only the source)*/
+} cookProcessor;
+
+struct cookItem {
+	char sourcePath[COOK_MAX_PATH];
+	char outputPath[COOK_MAX_PATH];
+	const cookProcessor* pProcessor;
+	const char* pSettings; /*Owned by the source directory config*/
+	const char* pOverride; /*Owned by the source directory config*/
+	asHash64_t outputId;
+	asHash64_t inputHash;
+	asResults result;
+	bool cooked;
+};
+
+char gShaderCompilerPath[COOK_MAX_PATH];
+
+static unsigned char* _readFile(const char* pPath, size_t* pSize)
+{
+	FILE* fp = fopen(pPath, "rb");
+	if (!fp)
+		return NULL;
+	fseek(fp, 0, SEEK_END);
+	size_t size = (size_t)ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	unsigned char* pData = asMalloc(size ? size : 1);
+	if (pData && size && fread(pData, size, 1, fp) != 1)
+	{
+		asFree(pData);
+		pData = NULL;
+	}
+	fclose(fp);
+	*pSize = size;
+	return pData;
+}
+
+static void _makeParentDirs(const char* pPath)
+{
+	char dir[COOK_MAX_PATH];
+	strncpy(dir, pPath, COOK_MAX_PATH - 1);
+	dir[COOK_MAX_PATH - 1] = '\0';
+	/*Several jobs may race to create the same directory, existing directories are fine*/
+	for (char* c = dir + 1; *c; c++)
+	{
+		if (*c != '/')
+			continue;
+		*c = '\0';
+#ifdef _WIN32
+		_mkdir(dir);
+#else
+		mkdir(dir, 0755);
+#endif
+		*c = '/';
+	}
+}
+
+static asResults _processCopy(const cookItem* pItem)
+{
+	size_t size;
+	unsigned char* pData = _readFile(pItem->sourcePath, &size);
+	if (!pData)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	FILE* fp = fopen(pItem->outputPath, "wb");
+	if (!fp)
+	{
+		asFree(pData);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	size_t written = size ? fwrite(pData, size, 1, fp) : 1;
+	fclose(fp);
+	asFree(pData);
+	return written == 1 ? AS_SUCCESS : AS_FAILURE_FILE_INACCESSIBLE;
+}
+
+/*Run a tool and wait for it, arguments are passed as is (no shell), returns the exit code or -1*/
+static int _runProcess(const char* const* ppArgs)
+{
+#ifdef _WIN32
+	/*Windows takes one command line, quote each argument (the first is also how the exe is found)*/
+	char commandLine[COOK_MAX_PATH * 8];
+	size_t length = 0;
+	for (const char* const* ppArg = ppArgs; *ppArg && length < sizeof(commandLine); ppArg++)
+		length += snprintf(commandLine + length, sizeof(commandLine) - length, "%s\"%s\"", length ? " " : "", *ppArg);
+	if (length >= sizeof(commandLine))
+		return -1;
+	STARTUPINFOA startupInfo;
+	memset(&startupInfo, 0, sizeof(startupInfo));
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo;
+	if (!CreateProcessA(NULL, commandLine, NULL, NULL, FALSE, 0, NULL, NULL, &startupInfo, &processInfo))
+		return -1;
+	WaitForSingleObject(processInfo.hProcess, INFINITE);
+	DWORD exitCode = (DWORD)-1;
+	GetExitCodeProcess(processInfo.hProcess, &exitCode);
+	CloseHandle(processInfo.hThread);
+	CloseHandle(processInfo.hProcess);
+	return (int)exitCode;
+#else
+	pid_t pid;
+	if (posix_spawn(&pid, ppArgs[0], NULL, NULL, (char* const*)ppArgs, environ) != 0)
+		return -1;
+	int status;
+	while (waitpid(pid, &status, 0) < 0)
+	{
+		if (errno != EINTR)
+			return -1;
+	}
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+static asResults _processShader(const cookItem* pItem)
+{
+	/*Settings are the reflection info asShaderCompiler expects*/
+	const char* args[] = {
+		gShaderCompilerPath, pItem->sourcePath, pItem->outputPath, "SPIR-V", pItem->pSettings ? pItem->pSettings : "", NULL
+	};
+	const int exitCode = _runProcess(args);
+	if (exitCode != 0)
+	{
+		asDebugLog("[ERROR]> %s exited with %d for %s", gShaderCompilerPath, exitCode, pItem->sourcePath);
+		return AS_FAILURE_UNKNOWN;
+	}
+	return AS_SUCCESS;
+}
+
+#define COOK_SHADER_MAX_INCLUDE_DEPTH 64 /*Same limit as asShaderCompiler*/
+
+/*Includes resolve against the directory of the including file like the asShaderCompiler include callback*/
+static void _hashShaderIncludes(const char* pPath, asHash64_t hashes[2], int depth)
+{
+	size_t size;
+	char* pText = (char*)_readFile(pPath, &size);
+	if (!pText)
+		return;
+	const char* pDirEnd = strrchr(pPath, '/');
+	const int dirLength = pDirEnd ? (int)(pDirEnd - pPath + 1) : 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		/*Only directives at the start of a line*/
+		if (i && pText[i - 1] != '\n')
+			continue;
+		size_t c = i;
+		while (c < size && (pText[c] == ' ' || pText[c] == '\t'))
+			c++;
+		if (c + 8 >= size || strncmp(&pText[c], "#include", 8))
+			continue;
+		c += 8;
+		while (c < size && (pText[c] == ' ' || pText[c] == '\t'))
+			c++;
+		if (c >= size || (pText[c] != '"' && pText[c] != '<'))
+			continue;
+		const char close = pText[c] == '"' ? '"' : '>';
+		const size_t nameStart = ++c;
+		while (c < size && pText[c] != close && pText[c] != '\n')
+			c++;
+		if (c >= size || pText[c] != close)
+			continue;
+
+		char includePath[COOK_MAX_PATH];
+		snprintf(includePath, COOK_MAX_PATH, "%.*s%.*s", dirLength, pPath, (int)(c - nameStart), &pText[nameStart]);
+		size_t includeSize;
+		unsigned char* pInclude = _readFile(includePath, &includeSize);
+		hashes[1] = pInclude ? asHashBytes64_xxHash(pInclude, includeSize) : 0;
+		hashes[0] = asHashBytes64_xxHash(hashes, sizeof(asHash64_t) * 2);
+		asFree(pInclude);
+		if (pInclude && depth < COOK_SHADER_MAX_INCLUDE_DEPTH)
+			_hashShaderIncludes(includePath, hashes, depth + 1);
+	}
+	asFree(pText);
+}
+
+static asHash64_t _hashShaderDependencies(const cookItem* pItem)
+{
+	asHash64_t hashes[2] = { 0, 0 };
+	_hashShaderIncludes(pItem->sourcePath, hashes, 0);
+	return hashes[0];
+}
+
+/*Settings are space separated:
+format=bc1|bc3|bc5|bc7|rgba8 quality=fast|normal|high mips=0|1 mipfilter=box|kaiser
+srgb=0|1 (color is sRGB, on by default) normalmap=0|1 alphatest=cutoff (keeps alpha tested coverage in the mips)
+lz4level=1-12 (texturelz4 only, LZ4HC level, 9 by default)*/
+typedef struct {
+	asColorFormat format;
+	asBlockCompressQuality quality;
+	bool mips;
+	asMipGenDesc_t mipGen;
+	int32_t lz4Level;
+} cookTextureSettings;
+
+static bool _isToken(const char* pToken, size_t length, const char* pName)
+{
+	return strlen(pName) == length && !strncmp(pToken, pName, length);
+}
+
+static void _parseTextureSettings(const char* pSettings, cookTextureSettings* pOut)
+{
+	pOut->format = AS_COLORFORMAT_BC7_UNORM_BLOCK;
+	pOut->quality = AS_BLOCKCOMPRESS_QUALITY_NORMAL;
+	pOut->mips = true;
+	pOut->mipGen = asMipGenDesc_Init();
+	pOut->lz4Level = 0;
+	for (const char* pToken = pSettings; pToken && *pToken;)
+	{
+		pToken += strspn(pToken, " \t");
+		const size_t length = strcspn(pToken, " \t");
+		if (_isToken(pToken, length, "format=bc1")) { pOut->format = AS_COLORFORMAT_BC1_RGBA_UNORM_BLOCK; }
+		else if (_isToken(pToken, length, "format=bc3")) { pOut->format = AS_COLORFORMAT_BC3_UNORM_BLOCK; }
+		else if (_isToken(pToken, length, "format=bc5")) { pOut->format = AS_COLORFORMAT_BC5_UNORM_BLOCK; }
+		else if (_isToken(pToken, length, "format=bc7")) { pOut->format = AS_COLORFORMAT_BC7_UNORM_BLOCK; }
+		else if (_isToken(pToken, length, "format=rgba8")) { pOut->format = AS_COLORFORMAT_RGBA8_UNORM; }
+		else if (_isToken(pToken, length, "quality=fast")) { pOut->quality = AS_BLOCKCOMPRESS_QUALITY_FAST; }
+		else if (_isToken(pToken, length, "quality=normal")) { pOut->quality = AS_BLOCKCOMPRESS_QUALITY_NORMAL; }
+		else if (_isToken(pToken, length, "quality=high")) { pOut->quality = AS_BLOCKCOMPRESS_QUALITY_HIGH; }
+		else if (_isToken(pToken, length, "mips=0")) { pOut->mips = false; }
+		else if (_isToken(pToken, length, "mips=1")) { pOut->mips = true; }
+		else if (_isToken(pToken, length, "mipfilter=box")) { pOut->mipGen.filter = AS_MIPFILTER_BOX; }
+		else if (_isToken(pToken, length, "mipfilter=kaiser")) { pOut->mipGen.filter = AS_MIPFILTER_KAISER; }
+		else if (_isToken(pToken, length, "srgb=0")) { pOut->mipGen.flags &= ~AS_MIPGEN_FLAG_SRGB; }
+		else if (_isToken(pToken, length, "srgb=1")) { pOut->mipGen.flags |= AS_MIPGEN_FLAG_SRGB; }
+		else if (_isToken(pToken, length, "normalmap=0")) { pOut->mipGen.flags &= ~AS_MIPGEN_FLAG_NORMALMAP; }
+		else if (_isToken(pToken, length, "normalmap=1")) { pOut->mipGen.flags |= AS_MIPGEN_FLAG_NORMALMAP; }
+		else if (length > 10 && !strncmp(pToken, "alphatest=", 10))
+		{
+			pOut->mipGen.flags |= AS_MIPGEN_FLAG_ALPHA_COVERAGE;
+			pOut->mipGen.alphaCutoff = strtof(pToken + 10, NULL);
+		}
+		else if (length > 9 && !strncmp(pToken, "lz4level=", 9)) { pOut->lz4Level = (int32_t)strtol(pToken + 9, NULL, 10); }
+		else if (length) { asDebugLog("Unknown texture setting \"%.*s\"", (int)length, pToken); }
+		pToken += length;
+	}
+	pOut->mipGen.maxMips = pOut->mips ? 0 : 1;
+}
+
+static asResults _writeTexture(const cookItem* pItem, const cookTextureSettings* pSettings, const asTextureDesc_t* pDesc, bool lz4)
+{
+	if (lz4)
+		return asTextureDesc_WriteLz4File(pDesc, pItem->outputPath, pSettings->lz4Level);
+	return asTextureDesc_WriteKtxFile(pDesc, pItem->outputPath);
+}
+
+static asResults _cookTexture(const cookItem* pItem, bool lz4)
+{
+	cookTextureSettings settings;
+	_parseTextureSettings(pItem->pSettings, &settings);
+
+	int width, height, channels;
+	stbi_uc* pPixels = stbi_load(pItem->sourcePath, &width, &height, &channels, 4);
+	if (!pPixels)
+	{
+		asDebugLog("[ERROR]> Could not load image %s (%s)", pItem->sourcePath, stbi_failure_reason());
+		return AS_FAILURE_PARSE_ERROR;
+	}
+
+	/*Mip chain in RGBA8 laid out as texture regions*/
+	asTextureDesc_t desc = asTextureDesc_Init();
+	const uint32_t mipCount = asMipGen_GetMipCount((uint32_t)width, (uint32_t)height, settings.mipGen.maxMips);
+	uint8_t* pChain = asMalloc(asMipGen_GetChainSize((uint32_t)width, (uint32_t)height, mipCount));
+	asResults result = pChain ? AS_SUCCESS : AS_FAILURE_OUT_OF_MEMORY;
+	if (result == AS_SUCCESS)
+		result = asMipGen_GenerateRGBA8(&settings.mipGen, pPixels, (uint32_t)width, (uint32_t)height, pChain, &desc);
+	stbi_image_free(pPixels);
+	if (result != AS_SUCCESS || settings.format == AS_COLORFORMAT_RGBA8_UNORM)
+	{
+		if (result == AS_SUCCESS)
+			result = _writeTexture(pItem, &settings, &desc, lz4);
+		asFree(pChain);
+		return result;
+	}
+
+	/*Encode each region into the same layout*/
+	asTextureDesc_t encoded = desc;
+	encoded.format = settings.format;
+	size_t totalSize = 0;
+	for (uint32_t i = 0; i < desc.mips; i++)
+	{
+		asTextureContentRegion_t* pRegion = &encoded.arrInitialContentsRegions[i];
+		pRegion->bufferStart = (uint32_t)totalSize;
+		pRegion->bufferSize = (uint32_t)asBlockCompressGetSize(settings.format, pRegion->extent[0], pRegion->extent[1]);
+		totalSize += pRegion->bufferSize;
+	}
+	uint8_t* pOutput = asMalloc(totalSize);
+	if (!pOutput)
+	{
+		asFree(pChain);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	for (uint32_t i = 0; i < desc.mips && result == AS_SUCCESS; i++)
+	{
+		const asTextureContentRegion_t* pSrc = &desc.arrInitialContentsRegions[i];
+		result = asBlockCompressImage(settings.format, settings.quality, pChain + pSrc->bufferStart, pSrc->extent[0], pSrc->extent[1],
+			pOutput + encoded.arrInitialContentsRegions[i].bufferStart);
+	}
+	asFree(pChain);
+
+	encoded.pInitialContentsBuffer = pOutput;
+	encoded.initialContentsBufferSize = totalSize;
+	if (result == AS_SUCCESS)
+		result = _writeTexture(pItem, &settings, &encoded, lz4);
+	asFree(pOutput);
+	return result;
+}
+
+static asResults _processTexture(const cookItem* pItem)
+{
+	return _cookTexture(pItem, false);
+}
+
+static asResults _processTextureLz4(const cookItem* pItem)
+{
+	return _cookTexture(pItem, true);
+}
+
+/*Atlas lists are text with an image path per line relative to the list ('#' starts a comment),
+images are named by their path as written. Settings: pagesize=N (largest page, 2048 by default) padding=N (1 by default)*/
+typedef struct {
+	char* pText; /*Contents of the list with every entry terminated*/
+	char** ppNames;
+	size_t count;
+} cookAtlasList;
+
+static asResults _loadAtlasList(const cookItem* pItem, cookAtlasList* pOut)
+{
+	size_t size;
+	memset(pOut, 0, sizeof(cookAtlasList));
+	pOut->pText = (char*)_readFile(pItem->sourcePath, &size);
+	if (!pOut->pText)
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	pOut->pText = asRealloc(pOut->pText, size + 1);
+	ASASSERT(pOut->pText);
+	pOut->pText[size] = '\0';
+	size_t capacity = 0;
+	for (char* pLine = pOut->pText; *pLine;)
+	{
+		const size_t length = strcspn(pLine, "\r\n");
+		char* pNext = pLine + length + strspn(pLine + length, "\r\n");
+		pLine[length] = '\0';
+		char* pComment = strchr(pLine, '#');
+		if (pComment)
+			*pComment = '\0';
+		pLine += strspn(pLine, " \t");
+		for (char* pEnd = pLine + strlen(pLine); pEnd > pLine && (pEnd[-1] == ' ' || pEnd[-1] == '\t'); pEnd--)
+			pEnd[-1] = '\0';
+		if (*pLine)
+		{
+			if (pOut->count == capacity)
+			{
+				capacity = capacity ? capacity * 2 : 64;
+				pOut->ppNames = asRealloc(pOut->ppNames, sizeof(char*) * capacity);
+				ASASSERT(pOut->ppNames);
+			}
+			pOut->ppNames[pOut->count] = pLine;
+			pOut->count++;
+		}
+		pLine = pNext;
+	}
+	return AS_SUCCESS;
+}
+
+static void _freeAtlasList(cookAtlasList* pList)
+{
+	asFree(pList->ppNames);
+	asFree(pList->pText);
+}
+
+static void _relativePath(const cookItem* pItem, const char* pName, char pOut[COOK_MAX_PATH])
+{
+	const char* pDirEnd = strrchr(pItem->sourcePath, '/');
+	const int dirLength = pDirEnd ? (int)(pDirEnd - pItem->sourcePath + 1) : 0;
+	snprintf(pOut, COOK_MAX_PATH, "%.*s%s", dirLength, pItem->sourcePath, pName);
+}
+
+static asHash64_t _hashAtlasDependencies(const cookItem* pItem)
+{
+	cookAtlasList list;
+	if (_loadAtlasList(pItem, &list) != AS_SUCCESS)
+		return 0;
+	asHash64_t hashes[2] = { 0, 0 };
+	for (size_t i = 0; i < list.count; i++)
+	{
+		char path[COOK_MAX_PATH];
+		_relativePath(pItem, list.ppNames[i], path);
+		size_t size;
+		unsigned char* pData = _readFile(path, &size);
+		hashes[1] = pData ? asHashBytes64_xxHash(pData, size) : 0;
+		hashes[0] = asHashBytes64_xxHash(hashes, sizeof(hashes));
+		asFree(pData);
+	}
+	_freeAtlasList(&list);
+	return hashes[0];
+}
+
+static asResults _processAtlas(const cookItem* pItem)
+{
+	asTextureAtlasDesc_t desc = asTextureAtlasDesc_Init();
+	for (const char* pToken = pItem->pSettings; pToken && *pToken;)
+	{
+		pToken += strspn(pToken, " \t");
+		const size_t length = strcspn(pToken, " \t");
+		if (length > 9 && !strncmp(pToken, "pagesize=", 9)) { desc.maxPageSize = (uint32_t)strtoul(pToken + 9, NULL, 10); }
+		else if (length > 8 && !strncmp(pToken, "padding=", 8)) { desc.padding = (uint32_t)strtoul(pToken + 8, NULL, 10); }
+		else if (length) { asDebugLog("Unknown atlas setting \"%.*s\"", (int)length, pToken); }
+		pToken += length;
+	}
+
+	cookAtlasList list;
+	asResults result = _loadAtlasList(pItem, &list);
+	if (result != AS_SUCCESS)
+		return result;
+	asTextureAtlasSource_t* pSources = asMalloc(sizeof(asTextureAtlasSource_t) * (list.count + 1));
+	if (!pSources)
+	{
+		_freeAtlasList(&list);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	memset(pSources, 0, sizeof(asTextureAtlasSource_t) * (list.count + 1));
+	for (size_t i = 0; i < list.count && result == AS_SUCCESS; i++)
+	{
+		char path[COOK_MAX_PATH];
+		_relativePath(pItem, list.ppNames[i], path);
+		int width, height, channels;
+		pSources[i].pRGBA = stbi_load(path, &width, &height, &channels, 4);
+		pSources[i].width = (uint32_t)width;
+		pSources[i].height = (uint32_t)height;
+		pSources[i].pName = list.ppNames[i];
+		if (!pSources[i].pRGBA)
+		{
+			asDebugLog("[ERROR]> Could not load image %s (%s)", path, stbi_failure_reason());
+			result = AS_FAILURE_PARSE_ERROR;
+		}
+	}
+	if (result == AS_SUCCESS)
+		result = asTextureAtlas_WriteFile(&desc, pSources, list.count, pItem->outputPath);
+	for (size_t i = 0; i < list.count; i++)
+		stbi_image_free((void*)pSources[i].pRGBA);
+	asFree(pSources);
+	_freeAtlasList(&list);
+	return result;
+}
+
+/*Models are glTF/GLB scenes baked into one asMdl with a submesh per node primitive (skinned primitives stay in mesh space),
+material textures keep their paths relative to the model so they are cooked on their own.
+Settings: optimize=0|1 (vertex cache, overdraw and vertex fetch order, on by default)
+tangents=0|1 (MikkTSpace tangents when the primitive has none, on by default) lods=1-8 (levels including the full mesh, 1 by default)
+normals=snorm|octahedral (10 bit SNORM XYZ or 16 bit octahedral normals, snorm by default)
+meshlets=0|1 (every level split into meshlets for GPU culling, on by default)
+positions=float|unorm16 (position only stream for depth and shadow passes, 16 bit over the model bounds or float, float by default)*/
+typedef struct {
+	bool optimize;
+	bool tangents;
+	bool meshlets;
+	bool quantizePositions;
+	uint32_t lodCount;
+	asVertexNormalEncoding normalEncoding;
+} cookModelSettings;
+
+typedef struct {
+	const cookModelSettings* pSettings;
+	const cgltf_primitive* pPrimitive;
+	mat4 transform;
+	asMeshBuilderSubmesh_t submesh;
+	uint32_t flags; /*asModelFlags*/
+	asResults result;
+} cookModelSubmesh;
+
+static void _parseModelSettings(const char* pSettings, cookModelSettings* pOut)
+{
+	pOut->optimize = true;
+	pOut->tangents = true;
+	pOut->meshlets = true;
+	pOut->quantizePositions = false;
+	pOut->lodCount = 1;
+	pOut->normalEncoding = AS_VERTEX_NORMAL_SNORM10;
+	for (const char* pToken = pSettings; pToken && *pToken;)
+	{
+		pToken += strspn(pToken, " \t");
+		const size_t length = strcspn(pToken, " \t");
+		if (_isToken(pToken, length, "optimize=0")) { pOut->optimize = false; }
+		else if (_isToken(pToken, length, "optimize=1")) { pOut->optimize = true; }
+		else if (_isToken(pToken, length, "tangents=0")) { pOut->tangents = false; }
+		else if (_isToken(pToken, length, "tangents=1")) { pOut->tangents = true; }
+		else if (_isToken(pToken, length, "meshlets=0")) { pOut->meshlets = false; }
+		else if (_isToken(pToken, length, "meshlets=1")) { pOut->meshlets = true; }
+		else if (_isToken(pToken, length, "normals=snorm")) { pOut->normalEncoding = AS_VERTEX_NORMAL_SNORM10; }
+		else if (_isToken(pToken, length, "normals=octahedral")) { pOut->normalEncoding = AS_VERTEX_NORMAL_OCTAHEDRAL; }
+		else if (_isToken(pToken, length, "positions=float")) { pOut->quantizePositions = false; }
+		else if (_isToken(pToken, length, "positions=unorm16")) { pOut->quantizePositions = true; }
+		else if (length > 5 && !strncmp(pToken, "lods=", 5)) { pOut->lodCount = (uint32_t)strtoul(pToken + 5, NULL, 10); }
+		else if (length) { asDebugLog("Unknown model setting \"%.*s\"", (int)length, pToken); }
+		pToken += length;
+	}
+	if (pOut->lodCount < 1 || pOut->lodCount > AS_MESH_BUILDER_MAX_LODS)
+		pOut->lodCount = pOut->lodCount < 1 ? 1 : AS_MESH_BUILDER_MAX_LODS;
+}
+
+static asResults _cookSubmesh(cookModelSubmesh* pSubmesh)
+{
+	const cgltf_primitive* pPrim = pSubmesh->pPrimitive;
+	const cgltf_accessor* pAccessors[8] = { NULL };
+	enum { POSITION, NORMAL, TANGENT, TEXCOORD0, TEXCOORD1, COLOR, JOINTS, WEIGHTS };
+	for (cgltf_size i = 0; i < pPrim->attributes_count; i++)
+	{
+		const cgltf_attribute* pAttrib = &pPrim->attributes[i];
+		switch (pAttrib->type)
+		{
+		case cgltf_attribute_type_position: pAccessors[POSITION] = pAttrib->data; break;
+		case cgltf_attribute_type_normal: pAccessors[NORMAL] = pAttrib->data; break;
+		case cgltf_attribute_type_tangent: pAccessors[TANGENT] = pAttrib->data; break;
+		case cgltf_attribute_type_texcoord: if (pAttrib->index < 2) { pAccessors[TEXCOORD0 + pAttrib->index] = pAttrib->data; } break;
+		case cgltf_attribute_type_color: if (pAttrib->index == 0) { pAccessors[COLOR] = pAttrib->data; } break;
+		case cgltf_attribute_type_joints: if (pAttrib->index == 0) { pAccessors[JOINTS] = pAttrib->data; } break;
+		case cgltf_attribute_type_weights: if (pAttrib->index == 0) { pAccessors[WEIGHTS] = pAttrib->data; } break;
+		default: break;
+		}
+	}
+	if (pPrim->type != cgltf_primitive_type_triangles || !pAccessors[POSITION])
+		return AS_SUCCESS;
+	const bool skinned = pAccessors[JOINTS] && pAccessors[WEIGHTS];
+	const bool generateTangents = !pAccessors[TANGENT] && pAccessors[TEXCOORD0] && pSubmesh->pSettings->tangents;
+	const uint32_t indexCount = (uint32_t)(pPrim->indices ? pPrim->indices->count : pAccessors[POSITION]->count) / 3 * 3;
+
+	/*Normals follow the inverse transpose, mirrored nodes flip the winding back*/
+	mat3 basis, normalBasis;
+	glm_mat4_pick3(pSubmesh->transform, basis);
+	glm_mat3_inv(basis, normalBasis);
+	glm_mat3_transpose(normalBasis);
+	const bool mirrored = glm_mat3_det(basis) < 0.0f;
+
+	/*Corners are expanded so flat normals and split tangents need no special cases, welding shares them again*/
+	float* pPositions = asMalloc(sizeof(float) * 3 * (indexCount + 1));
+	float* pNormals = asMalloc(sizeof(float) * 3 * (indexCount + 1));
+	float* pUVs = asMalloc(sizeof(float) * 2 * (indexCount + 1));
+	float* pTangents = asMalloc(sizeof(float) * 4 * (indexCount + 1));
+	uint32_t* pCorners = asMalloc(sizeof(uint32_t) * (indexCount + 1));
+	asMeshBuilderMesh_t* pMesh = &pSubmesh->submesh.mesh;
+	pMesh->pVertices = asMalloc(sizeof(asVertexGeneric) * (indexCount + 1));
+	pMesh->pIndices = asMalloc(sizeof(uint32_t) * (indexCount + 1));
+	asResults result = AS_SUCCESS;
+	if (!pPositions || !pNormals || !pUVs || !pTangents || !pCorners || !pMesh->pVertices || !pMesh->pIndices)
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < indexCount && result == AS_SUCCESS; i++)
+	{
+		const uint32_t corner = mirrored && i % 3 ? i - i % 3 + 3 - i % 3 : i;
+		pCorners[corner] = pPrim->indices ? (uint32_t)cgltf_accessor_read_index(pPrim->indices, i) : i;
+		if (pCorners[corner] >= pAccessors[POSITION]->count)
+			result = AS_FAILURE_PARSE_ERROR;
+	}
+	for (uint32_t i = 0; i < indexCount && result == AS_SUCCESS; i++)
+	{
+		vec3 position = { 0.0f, 0.0f, 0.0f };
+		cgltf_accessor_read_float(pAccessors[POSITION], pCorners[i], position, 3);
+		glm_mat4_mulv3(pSubmesh->transform, position, 1.0f, &pPositions[i * 3]);
+		if (pAccessors[NORMAL])
+		{
+			vec3 normal = { 0.0f, 0.0f, 1.0f };
+			cgltf_accessor_read_float(pAccessors[NORMAL], pCorners[i], normal, 3);
+			glm_mat3_mulv(normalBasis, normal, &pNormals[i * 3]);
+			glm_vec3_normalize(&pNormals[i * 3]);
+		}
+		pUVs[i * 2 + 0] = 0.0f;
+		pUVs[i * 2 + 1] = 0.0f;
+		if (pAccessors[TEXCOORD0])
+			cgltf_accessor_read_float(pAccessors[TEXCOORD0], pCorners[i], &pUVs[i * 2], 2);
+		vec4 tangent = { 1.0f, 0.0f, 0.0f, 1.0f };
+		if (pAccessors[TANGENT])
+		{
+			vec4 source = { 1.0f, 0.0f, 0.0f, 1.0f };
+			cgltf_accessor_read_float(pAccessors[TANGENT], pCorners[i], source, 4);
+			glm_mat3_mulv(basis, source, tangent);
+			glm_vec3_normalize(tangent);
+			tangent[3] = mirrored ? -source[3] : source[3];
+		}
+		memcpy(&pTangents[i * 4], tangent, sizeof(tangent));
+		pMesh->pIndices[i] = i;
+	}
+	if (result == AS_SUCCESS && !pAccessors[NORMAL])
+	{
+		/*Flat normals as glTF asks for when they are missing*/
+		for (uint32_t i = 0; i < indexCount; i += 3)
+		{
+			vec3 e0, e1, normal;
+			glm_vec3_sub(&pPositions[(i + 1) * 3], &pPositions[i * 3], e0);
+			glm_vec3_sub(&pPositions[(i + 2) * 3], &pPositions[i * 3], e1);
+			glm_vec3_crossn(e0, e1, normal);
+			for (uint32_t k = 0; k < 3; k++)
+				glm_vec3_copy(normal, &pNormals[(i + k) * 3]);
+		}
+	}
+	if (result == AS_SUCCESS && generateTangents)
+		result = asMeshBuilder_GenerateTangents(pPositions, pNormals, pUVs, pMesh->pIndices, indexCount, pTangents);
+
+	/*The rest of the attributes are gathered into arrays so the whole submesh is encoded in one batch*/
+	float* pUV1s = pAccessors[TEXCOORD1] ? asMalloc(sizeof(float) * 2 * (indexCount + 1)) : NULL;
+	uint8_t* pColors = asMalloc(sizeof(uint8_t) * 4 * (indexCount + 1));
+	uint16_t* pBoneIds = skinned ? asMalloc(sizeof(uint16_t) * 4 * (indexCount + 1)) : NULL;
+	float* pWeights = skinned ? asMalloc(sizeof(float) * 4 * (indexCount + 1)) : NULL;
+	if (result == AS_SUCCESS && (!pColors || (pAccessors[TEXCOORD1] && !pUV1s) || (skinned && (!pBoneIds || !pWeights))))
+		result = AS_FAILURE_OUT_OF_MEMORY;
+	for (uint32_t i = 0; i < indexCount && result == AS_SUCCESS; i++)
+	{
+		if (pUV1s)
+		{
+			pUV1s[i * 2 + 0] = 0.0f;
+			pUV1s[i * 2 + 1] = 0.0f;
+			cgltf_accessor_read_float(pAccessors[TEXCOORD1], pCorners[i], &pUV1s[i * 2], 2);
+		}
+		vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		if (pAccessors[COLOR])
+			cgltf_accessor_read_float(pAccessors[COLOR], pCorners[i], color, cgltf_num_components(pAccessors[COLOR]->type));
+		for (int c = 0; c < 4; c++)
+			pColors[i * 4 + c] = (uint8_t)(glm_clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+		if (skinned)
+		{
+			cgltf_uint joints[4] = { 0 };
+			memset(&pWeights[i * 4], 0, sizeof(float) * 4);
+			cgltf_accessor_read_uint(pAccessors[JOINTS], pCorners[i], joints, 4);
+			cgltf_accessor_read_float(pAccessors[WEIGHTS], pCorners[i], &pWeights[i * 4], 4);
+			for (int j = 0; j < 4; j++)
+				pBoneIds[i * 4 + j] = (uint16_t)joints[j];
+		}
+	}
+	if (result == AS_SUCCESS)
+	{
+		/*Weights are normalized by the encoder*/
+		const asVertexGenericStreams_t streams = {
+			.pPositions = pPositions,
+			.pNormals = pNormals,
+			.pTangents = pAccessors[TANGENT] || generateTangents ? pTangents : NULL,
+			.pUVs = { pUVs, pUV1s },
+			.pColors = pColors,
+			.pBoneIds = pBoneIds,
+			.pBoneWeights = pWeights,
+			.normalEncoding = pSubmesh->pSettings->normalEncoding,
+		};
+		asVertexGeneric_encodeBatch(pMesh->pVertices, indexCount, &streams);
+	}
+	asFree(pUV1s);
+	asFree(pColors);
+	asFree(pBoneIds);
+	asFree(pWeights);
+	asFree(pPositions);
+	asFree(pNormals);
+	asFree(pUVs);
+	asFree(pTangents);
+	asFree(pCorners);
+	if (result != AS_SUCCESS)
+		return result;
+
+	pMesh->vertexCount = indexCount;
+	pMesh->indexCount = indexCount;
+	result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_WELD);
+	if (result == AS_SUCCESS && pSubmesh->pSettings->lodCount > 1)
+	{
+		asMeshBuilderLodDesc_t lodDesc = asMeshBuilderLodDesc_Init();
+		lodDesc.lodCount = pSubmesh->pSettings->lodCount;
+		for (uint32_t i = 0; i < lodDesc.lodCount; i++)
+			lodDesc.ratios[i] = 1.0f / (float)(1u << i);
+		result = asMeshBuilder_GenerateLods(pMesh, &lodDesc);
+	}
+	if (result == AS_SUCCESS && pSubmesh->pSettings->optimize)
+		result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_ALL & ~AS_MESHOPTIMIZE_WELD);
+	if (result == AS_SUCCESS && pSubmesh->pSettings->meshlets)
+	{
+		asMeshBuilderMeshletDesc_t meshletDesc = asMeshBuilderMeshletDesc_Init();
+		result = asMeshBuilder_BuildMeshlets(pMesh, &meshletDesc);
+	}
+	pSubmesh->flags = (skinned ? AS_MODEL_FLAG_SKINNED : 0) | (pAccessors[TANGENT] || generateTangents ? AS_MODEL_FLAG_TANGENTS : 0) |
+		(pSubmesh->pSettings->normalEncoding == AS_VERTEX_NORMAL_OCTAHEDRAL ? AS_MODEL_FLAG_OCTAHEDRAL_NORMALS : 0) |
+		(pSubmesh->pSettings->quantizePositions ? AS_MODEL_FLAG_QUANTIZED_POSITIONS : 0);
+	return result;
+}
+
+static void _cookSubmeshJob(void* pUserData)
+{
+	cookModelSubmesh* pSubmesh = (cookModelSubmesh*)pUserData;
+	pSubmesh->result = _cookSubmesh(pSubmesh);
+}
+
+static const char* _modelTexturePath(const cgltf_texture_view* pView, const char* pModelPath)
+{
+	if (!pView->texture || !pView->texture->image)
+		return NULL;
+	const char* pUri = pView->texture->image->uri;
+	if (!pUri || !strncmp(pUri, "data:", 5))
+	{
+		asDebugLog("[WARNING]> Embedded images are not cooked, %s needs its textures as separate files", pModelPath);
+		return NULL;
+	}
+	return pUri;
+}
+
+/*Names and paths point into the glTF data until the model is written*/
+static void _modelMaterial(const cgltf_material* pSrc, const char* pModelPath, asModelMaterial_t* pOut)
+{
+	memset(pOut, 0, sizeof(asModelMaterial_t));
+	for (int i = 0; i < 4; i++)
+		pOut->baseColor[i] = 1.0f;
+	pOut->metallic = 1.0f;
+	pOut->roughness = 1.0f;
+	pOut->normalScale = 1.0f;
+	pOut->occlusionStrength = 1.0f;
+	pOut->alphaCutoff = 0.5f;
+	pOut->alphaMode = AS_MODEL_ALPHA_OPAQUE;
+	if (!pSrc)
+	{
+		pOut->name.ptr = "default";
+		return;
+	}
+	pOut->name.ptr = pSrc->name;
+	if (pSrc->has_pbr_metallic_roughness)
+	{
+		const cgltf_pbr_metallic_roughness* pPbr = &pSrc->pbr_metallic_roughness;
+		memcpy(pOut->baseColor, pPbr->base_color_factor, sizeof(float) * 4);
+		pOut->metallic = pPbr->metallic_factor;
+		pOut->roughness = pPbr->roughness_factor;
+		pOut->textures[AS_MODEL_TEXTURE_BASECOLOR].ptr = _modelTexturePath(&pPbr->base_color_texture, pModelPath);
+		pOut->textures[AS_MODEL_TEXTURE_METALLICROUGHNESS].ptr = _modelTexturePath(&pPbr->metallic_roughness_texture, pModelPath);
+	}
+	pOut->textures[AS_MODEL_TEXTURE_NORMAL].ptr = _modelTexturePath(&pSrc->normal_texture, pModelPath);
+	pOut->textures[AS_MODEL_TEXTURE_OCCLUSION].ptr = _modelTexturePath(&pSrc->occlusion_texture, pModelPath);
+	pOut->textures[AS_MODEL_TEXTURE_EMISSIVE].ptr = _modelTexturePath(&pSrc->emissive_texture, pModelPath);
+	if (pSrc->normal_texture.texture)
+		pOut->normalScale = pSrc->normal_texture.scale;
+	if (pSrc->occlusion_texture.texture)
+		pOut->occlusionStrength = pSrc->occlusion_texture.scale;
+	memcpy(pOut->emissive, pSrc->emissive_factor, sizeof(float) * 3);
+	pOut->alphaCutoff = pSrc->alpha_cutoff;
+	pOut->alphaMode = pSrc->alpha_mode == cgltf_alpha_mode_mask ? AS_MODEL_ALPHA_MASK :
+		(pSrc->alpha_mode == cgltf_alpha_mode_blend ? AS_MODEL_ALPHA_BLEND : AS_MODEL_ALPHA_OPAQUE);
+	pOut->doubleSided = pSrc->double_sided ? 1 : 0;
+}
+
+static void _addModelSubmeshes(cookModelSubmesh** ppSubmeshes, size_t* pCount, const cookModelSettings* pSettings,
+	const cgltf_node* pNode, const cgltf_mesh* pMesh)
+{
+	*ppSubmeshes = asRealloc(*ppSubmeshes, sizeof(cookModelSubmesh) * (*pCount + pMesh->primitives_count));
+	ASASSERT(*ppSubmeshes);
+	for (cgltf_size p = 0; p < pMesh->primitives_count; p++)
+	{
+		cookModelSubmesh* pSubmesh = &(*ppSubmeshes)[(*pCount)++];
+		memset(pSubmesh, 0, sizeof(cookModelSubmesh));
+		pSubmesh->pSettings = pSettings;
+		pSubmesh->pPrimitive = &pMesh->primitives[p];
+		glm_mat4_identity(pSubmesh->transform);
+		if (pNode && !pNode->skin)
+			cgltf_node_transform_world(pNode, (float*)pSubmesh->transform);
+		const char* pName = pNode && pNode->name ? pNode->name : (pMesh->name ? pMesh->name : "mesh");
+		if (pMesh->primitives_count > 1)
+			snprintf(pSubmesh->submesh.name, AS_MODEL_MAX_NAME, "%s.%u", pName, (uint32_t)p);
+		else
+			snprintf(pSubmesh->submesh.name, AS_MODEL_MAX_NAME, "%s", pName);
+	}
+}
+
+static asHash64_t _hashModelDependencies(const cookItem* pItem)
+{
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+	cgltf_data* pData = NULL;
+	if (cgltf_parse_file(&options, pItem->sourcePath, &pData) != cgltf_result_success)
+		return 0;
+	asHash64_t hashes[2] = { 0, 0 };
+	for (cgltf_size i = 0; i < pData->buffers_count; i++)
+	{
+		const char* pUri = pData->buffers[i].uri;
+		if (!pUri || !strncmp(pUri, "data:", 5))
+			continue;
+		char path[COOK_MAX_PATH];
+		_relativePath(pItem, pUri, path);
+		size_t size;
+		unsigned char* pBuffer = _readFile(path, &size);
+		hashes[1] = pBuffer ? asHashBytes64_xxHash(pBuffer, size) : 0;
+		hashes[0] = asHashBytes64_xxHash(hashes, sizeof(hashes));
+		asFree(pBuffer);
+	}
+	cgltf_free(pData);
+	return hashes[0];
+}
+
+static asResults _processModel(const cookItem* pItem)
+{
+	cookModelSettings settings;
+	_parseModelSettings(pItem->pSettings, &settings);
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+	cgltf_data* pData = NULL;
+	if (cgltf_parse_file(&options, pItem->sourcePath, &pData) != cgltf_result_success ||
+		cgltf_load_buffers(&options, pData, pItem->sourcePath) != cgltf_result_success)
+	{
+		asDebugLog("[ERROR]> Could not load glTF %s", pItem->sourcePath);
+		if (pData)
+			cgltf_free(pData);
+		return AS_FAILURE_PARSE_ERROR;
+	}
+
+	/*Every node that places a mesh (or every mesh if there are no nodes)*/
+	cookModelSubmesh* pSubmeshes = NULL;
+	size_t submeshCount = 0;
+	for (cgltf_size i = 0; i < pData->nodes_count; i++)
+	{
+		if (pData->nodes[i].mesh)
+			_addModelSubmeshes(&pSubmeshes, &submeshCount, &settings, &pData->nodes[i], pData->nodes[i].mesh);
+	}
+	if (!pData->nodes_count)
+	{
+		for (cgltf_size i = 0; i < pData->meshes_count; i++)
+			_addModelSubmeshes(&pSubmeshes, &submeshCount, &settings, NULL, &pData->meshes[i]);
+	}
+
+	/*Submeshes are built in parallel (waiting helps run them so this is fine from inside a cook job)*/
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * (submeshCount ? submeshCount : 1));
+	for (size_t i = 0; i < submeshCount; i++)
+	{
+		pJobs[i].fpEntry = _cookSubmeshJob;
+		pJobs[i].pUserData = &pSubmeshes[i];
+	}
+	asJobCounter counter;
+	asJobSystem_CreateCounter(&counter);
+	asJobSystem_Dispatch(pJobs, submeshCount, counter);
+	asJobSystem_WaitForCounter(counter);
+	asJobSystem_ReleaseCounter(counter);
+	asFree(pJobs);
+
+	/*Materials in glTF order, primitives without one share a default at the end*/
+	asResults result = AS_SUCCESS;
+	uint32_t flags = 0;
+	uint32_t materialCount = (uint32_t)pData->materials_count;
+	asMeshBuilderSubmesh_t* pBuilt = asMalloc(sizeof(asMeshBuilderSubmesh_t) * (submeshCount ? submeshCount : 1));
+	asModelMaterial_t* pMaterials = asMalloc(sizeof(asModelMaterial_t) * (materialCount + 1));
+	uint32_t builtCount = 0;
+	for (size_t i = 0; i < submeshCount; i++)
+	{
+		if (pSubmeshes[i].result != AS_SUCCESS)
+		{
+			asDebugLog("[ERROR]> Could not build %s in %s (%d)", pSubmeshes[i].submesh.name, pItem->sourcePath, (int)pSubmeshes[i].result);
+			result = pSubmeshes[i].result;
+		}
+		if (!pSubmeshes[i].submesh.mesh.indexCount)
+			continue;
+		const cgltf_material* pMaterial = pSubmeshes[i].pPrimitive->material;
+		pSubmeshes[i].submesh.materialIndex = pMaterial ? (uint32_t)(pMaterial - pData->materials) : (uint32_t)pData->materials_count;
+		if (!pMaterial)
+			materialCount = (uint32_t)pData->materials_count + 1;
+		pBuilt[builtCount++] = pSubmeshes[i].submesh;
+		flags |= pSubmeshes[i].flags;
+	}
+	for (uint32_t i = 0; i < materialCount; i++)
+		_modelMaterial(i < pData->materials_count ? &pData->materials[i] : NULL, pItem->sourcePath, &pMaterials[i]);
+	if (result == AS_SUCCESS)
+		result = asMeshBuilder_WriteModelFile(pItem->outputPath, pBuilt, builtCount, pMaterials, materialCount, flags);
+
+	for (size_t i = 0; i < submeshCount; i++)
+	{
+		asFree(pSubmeshes[i].submesh.mesh.pVertices);
+		asFree(pSubmeshes[i].submesh.mesh.pIndices);
+		asFree(pSubmeshes[i].submesh.mesh.pMeshlets);
+		asFree(pSubmeshes[i].submesh.mesh.pMeshletVertices);
+		asFree(pSubmeshes[i].submesh.mesh.pMeshletTriangles);
+	}
+	asFree(pSubmeshes);
+	asFree(pBuilt);
+	asFree(pMaterials);
+	cgltf_free(pData);
+	return result;
+}
+
+/*Animations are the first skin of a glTF/GLB and every animation of it sampled at a fixed rate and compressed into an asAnim
+(see asAnimation.h), bones are the skin joints ordered parents first and keep their joint index as their palette index
+so the bone ids of the skinned model still match. Map an extension of its own to this processor (glTF is read from the content).
+Settings: rate=frames per second the clips are sampled at (30 by default)
+rotation=radians translation=units scale=factor (largest error the compression may add, asAnimBuilderCompressDesc_Init() by default)*/
+typedef struct {
+	float rate;
+	asAnimBuilderCompressDesc_t compress;
+} cookAnimationSettings;
+
+static void _parseAnimationSettings(const char* pSettings, cookAnimationSettings* pOut)
+{
+	pOut->rate = 30.0f;
+	pOut->compress = asAnimBuilderCompressDesc_Init();
+	for (const char* pToken = pSettings; pToken && *pToken;)
+	{
+		pToken += strspn(pToken, " \t");
+		const size_t length = strcspn(pToken, " \t");
+		if (length > 5 && !strncmp(pToken, "rate=", 5)) { pOut->rate = strtof(pToken + 5, NULL); }
+		else if (length > 9 && !strncmp(pToken, "rotation=", 9)) { pOut->compress.rotationTolerance = strtof(pToken + 9, NULL); }
+		else if (length > 12 && !strncmp(pToken, "translation=", 12)) { pOut->compress.translationTolerance = strtof(pToken + 12, NULL); }
+		else if (length > 6 && !strncmp(pToken, "scale=", 6)) { pOut->compress.scaleTolerance = strtof(pToken + 6, NULL); }
+		else if (length) { asDebugLog("Unknown animation setting \"%.*s\"", (int)length, pToken); }
+		pToken += length;
+	}
+	if (!(pOut->rate > 0.0f))
+		pOut->rate = 30.0f;
+}
+
+static int32_t _animationJointIndex(const cgltf_skin* pSkin, const cgltf_node* pNode)
+{
+	for (cgltf_size i = 0; pNode && i < pSkin->joints_count; i++)
+	{
+		if (pSkin->joints[i] == pNode)
+			return (int32_t)i;
+	}
+	return -1;
+}
+
+static void _animationNodeTRS(const cgltf_node* pNode, float rotation[4], float translation[3], float scale[3])
+{
+	if (pNode->has_matrix)
+	{
+		mat4 m, r;
+		vec4 t;
+		versor q;
+		memcpy(m, pNode->matrix, sizeof(mat4));
+		glm_decompose(m, t, r, scale);
+		glm_mat4_quat(r, q);
+		memcpy(rotation, q, sizeof(versor));
+		memcpy(translation, t, sizeof(float) * 3);
+		return;
+	}
+	const float identity[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const float one[3] = { 1.0f, 1.0f, 1.0f };
+	memcpy(rotation, pNode->has_rotation ? pNode->rotation : identity, sizeof(float) * 4);
+	memcpy(translation, pNode->has_translation ? pNode->translation : identity, sizeof(float) * 3);
+	memcpy(scale, pNode->has_scale ? pNode->scale : one, sizeof(float) * 3);
+}
+
+static bool _animationIsIdentity(mat4 m)
+{
+	mat4 identity = GLM_MAT4_IDENTITY_INIT;
+	return !memcmp(m, identity, sizeof(mat4));
+}
+
+/*Nodes between a joint and its parent joint (or the scene root) are folded into the joint*/
+static void _animationBake(mat4 between, float rotation[4], float translation[3], float scale[3])
+{
+	/*cglm wants its vectors aligned*/
+	mat4 local, m, r;
+	vec4 t;
+	versor q;
+	memcpy(q, rotation, sizeof(versor));
+	glm_quat_mat4(q, local);
+	for (int c = 0; c < 3; c++)
+	{
+		glm_vec4_scale(local[c], scale[c], local[c]);
+		local[3][c] = translation[c];
+	}
+	glm_mat4_mul(between, local, m);
+	glm_decompose(m, t, r, scale);
+	glm_mat4_quat(r, q);
+	memcpy(rotation, q, sizeof(versor));
+	memcpy(translation, t, sizeof(float) * 3);
+}
+
+/*Value of a sampler at a time as glTF interpolates it (rotations slerped or renormalized)*/
+static void _animationSample(const cgltf_animation_sampler* pSampler, cgltf_size components, float time, float* pOut)
+{
+	const cgltf_size keyCount = pSampler->input->count;
+	const bool cubic = pSampler->interpolation == cgltf_interpolation_type_cubic_spline;
+	const cgltf_size stride = cubic ? 3 : 1;
+	cgltf_size low = 0, high = keyCount ? keyCount - 1 : 0;
+	float lowTime = 0.0f, highTime = 0.0f;
+	cgltf_accessor_read_float(pSampler->input, low, &lowTime, 1);
+	cgltf_accessor_read_float(pSampler->input, high, &highTime, 1);
+	if (keyCount < 2 || time <= lowTime || time >= highTime)
+	{
+		cgltf_accessor_read_float(pSampler->output, (keyCount < 2 || time <= lowTime ? low : high) * stride + (cubic ? 1 : 0), pOut, components);
+		return;
+	}
+	while (high - low > 1)
+	{
+		const cgltf_size mid = (low + high) / 2;
+		float midTime;
+		cgltf_accessor_read_float(pSampler->input, mid, &midTime, 1);
+		if (midTime <= time)
+		{
+			low = mid;
+			lowTime = midTime;
+		}
+		else
+		{
+			high = mid;
+			highTime = midTime;
+		}
+	}
+	const float dt = highTime - lowTime;
+	const float alpha = dt > 0.0f ? (time - lowTime) / dt : 0.0f;
+	versor a = { 0 }, b = { 0 };
+	cgltf_accessor_read_float(pSampler->output, low * stride + (cubic ? 1 : 0), a, components);
+	if (pSampler->interpolation == cgltf_interpolation_type_step)
+	{
+		memcpy(pOut, a, sizeof(float) * components);
+		return;
+	}
+	cgltf_accessor_read_float(pSampler->output, high * stride + (cubic ? 1 : 0), b, components);
+	if (cubic)
+	{
+		float outTangent[4] = { 0 }, inTangent[4] = { 0 };
+		cgltf_accessor_read_float(pSampler->output, low * 3 + 2, outTangent, components);
+		cgltf_accessor_read_float(pSampler->output, high * 3, inTangent, components);
+		const float t2 = alpha * alpha, t3 = t2 * alpha;
+		for (cgltf_size c = 0; c < components; c++)
+		{
+			pOut[c] = (2.0f * t3 - 3.0f * t2 + 1.0f) * a[c] + (t3 - 2.0f * t2 + alpha) * dt * outTangent[c] +
+				(-2.0f * t3 + 3.0f * t2) * b[c] + (t3 - t2) * dt * inTangent[c];
+		}
+		if (components == 4)
+		{
+			memcpy(a, pOut, sizeof(versor));
+			glm_quat_normalize(a);
+			memcpy(pOut, a, sizeof(versor));
+		}
+		return;
+	}
+	if (components == 4)
+	{
+		versor q;
+		glm_quat_slerp(a, b, alpha, q);
+		memcpy(pOut, q, sizeof(versor));
+		return;
+	}
+	for (cgltf_size c = 0; c < components; c++)
+		pOut[c] = a[c] + (b[c] - a[c]) * alpha;
+}
+
+typedef struct {
+	asAnimBuilderClip_t clip;
+	float* pRotations;
+	float* pTranslations;
+	float* pScales;
+} cookAnimationClip;
+
+static asResults _sampleAnimationClip(const cgltf_animation* pAnimation, const cgltf_skin* pSkin, const int32_t* pJointBones,
+	mat4* pBetween, uint32_t boneCount, float rate, cookAnimationClip* pOut)
+{
+	/*Clips run from 0 to the last key of any joint*/
+	float duration = 0.0f;
+	for (cgltf_size i = 0; i < pAnimation->channels_count; i++)
+	{
+		const cgltf_animation_channel* pChannel = &pAnimation->channels[i];
+		if (_animationJointIndex(pSkin, pChannel->target_node) < 0 || !pChannel->sampler->input->count)
+			continue;
+		float last = 0.0f;
+		cgltf_accessor_read_float(pChannel->sampler->input, pChannel->sampler->input->count - 1, &last, 1);
+		duration = last > duration ? last : duration;
+	}
+	const float frames = ceilf(duration * rate - 0.001f) + 1.0f;
+	asAnimBuilderClip_t* pClip = &pOut->clip;
+	pClip->sampleRate = rate;
+	pClip->frameCount = frames < (float)AS_ANIM_MAX_FRAMES ? (uint32_t)frames : AS_ANIM_MAX_FRAMES;
+	const size_t sampleCount = (size_t)pClip->frameCount * boneCount;
+	pOut->pRotations = asMalloc(sizeof(float) * 4 * (sampleCount + 1));
+	pOut->pTranslations = asMalloc(sizeof(float) * 3 * (sampleCount + 1));
+	pOut->pScales = asMalloc(sizeof(float) * 3 * (sampleCount + 1));
+	if (!pOut->pRotations || !pOut->pTranslations || !pOut->pScales)
+		return AS_FAILURE_OUT_OF_MEMORY;
+
+	/*Joints start from their own node transform, then every channel on them is sampled*/
+	for (uint32_t b = 0; b < boneCount; b++)
+	{
+		float rotation[4], translation[3], scale[3];
+		_animationNodeTRS(pSkin->joints[pJointBones[b]], rotation, translation, scale);
+		for (uint32_t f = 0; f < pClip->frameCount; f++)
+		{
+			memcpy(&pOut->pRotations[((size_t)b * pClip->frameCount + f) * 4], rotation, sizeof(rotation));
+			memcpy(&pOut->pTranslations[((size_t)b * pClip->frameCount + f) * 3], translation, sizeof(translation));
+			memcpy(&pOut->pScales[((size_t)b * pClip->frameCount + f) * 3], scale, sizeof(scale));
+		}
+	}
+	for (cgltf_size i = 0; i < pAnimation->channels_count; i++)
+	{
+		const cgltf_animation_channel* pChannel = &pAnimation->channels[i];
+		const int32_t joint = _animationJointIndex(pSkin, pChannel->target_node);
+		if (joint < 0 || !pChannel->sampler->input->count)
+			continue;
+		uint32_t bone = 0;
+		while (pJointBones[bone] != joint)
+			bone++;
+		float* pDst = NULL;
+		cgltf_size components = 3;
+		switch (pChannel->target_path)
+		{
+		case cgltf_animation_path_type_rotation: pDst = pOut->pRotations; components = 4; break;
+		case cgltf_animation_path_type_translation: pDst = pOut->pTranslations; break;
+		case cgltf_animation_path_type_scale: pDst = pOut->pScales; break;
+		default: continue; /*Morph weights are not part of a pose*/
+		}
+		for (uint32_t f = 0; f < pClip->frameCount; f++)
+		{
+			const float time = (float)f / rate;
+			_animationSample(pChannel->sampler, components, time < duration ? time : duration,
+				&pDst[((size_t)bone * pClip->frameCount + f) * components]);
+		}
+	}
+	for (uint32_t b = 0; b < boneCount; b++)
+	{
+		if (_animationIsIdentity(pBetween[b]))
+			continue;
+		for (uint32_t f = 0; f < pClip->frameCount; f++)
+		{
+			const size_t sample = (size_t)b * pClip->frameCount + f;
+			_animationBake(pBetween[b], &pOut->pRotations[sample * 4], &pOut->pTranslations[sample * 3], &pOut->pScales[sample * 3]);
+		}
+	}
+	pClip->pRotations = pOut->pRotations;
+	pClip->pTranslations = pOut->pTranslations;
+	pClip->pScales = pOut->pScales;
+	return AS_SUCCESS;
+}
+
+static asResults _processAnimation(const cookItem* pItem)
+{
+	cookAnimationSettings settings;
+	_parseAnimationSettings(pItem->pSettings, &settings);
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+	cgltf_data* pData = NULL;
+	if (cgltf_parse_file(&options, pItem->sourcePath, &pData) != cgltf_result_success ||
+		cgltf_load_buffers(&options, pData, pItem->sourcePath) != cgltf_result_success)
+	{
+		asDebugLog("[ERROR]> Could not load glTF %s", pItem->sourcePath);
+		if (pData)
+			cgltf_free(pData);
+		return AS_FAILURE_PARSE_ERROR;
+	}
+	if (!pData->skins_count || !pData->skins[0].joints_count || pData->skins[0].joints_count > AS_ANIM_MAX_BONES)
+	{
+		asDebugLog("[ERROR]> %s needs a skin of 1 to %d joints", pItem->sourcePath, AS_ANIM_MAX_BONES);
+		cgltf_free(pData);
+		return AS_FAILURE_INVALID_PARAM;
+	}
+	const cgltf_skin* pSkin = &pData->skins[0];
+	const uint32_t boneCount = (uint32_t)pSkin->joints_count;
+
+	/*Joints sorted by how many joints are above them so parents come first*/
+	int32_t* pJointBones = asMalloc(sizeof(int32_t) * boneCount);
+	uint32_t* pDepths = asMalloc(sizeof(uint32_t) * boneCount);
+	asAnimBuilderBone_t* pBones = asMalloc(sizeof(asAnimBuilderBone_t) * boneCount);
+	mat4* pBetween = asMalloc(sizeof(mat4) * boneCount);
+	cookAnimationClip* pClips = asMalloc(sizeof(cookAnimationClip) * (pData->animations_count + 1));
+	asAnimBuilderClip_t* pBuilderClips = asMalloc(sizeof(asAnimBuilderClip_t) * (pData->animations_count + 1));
+	asResults result = pJointBones && pDepths && pBones && pBetween && pClips && pBuilderClips ? AS_SUCCESS : AS_FAILURE_OUT_OF_MEMORY;
+	if (pClips)
+		memset(pClips, 0, sizeof(cookAnimationClip) * (pData->animations_count + 1));
+	for (uint32_t j = 0; j < boneCount && result == AS_SUCCESS; j++)
+	{
+		pDepths[j] = 0;
+		for (const cgltf_node* pNode = pSkin->joints[j]->parent; pNode; pNode = pNode->parent)
+			pDepths[j] += _animationJointIndex(pSkin, pNode) >= 0 ? 1 : 0;
+		uint32_t slot = j;
+		while (slot > 0 && pDepths[pJointBones[slot - 1]] > pDepths[j])
+		{
+			pJointBones[slot] = pJointBones[slot - 1];
+			slot--;
+		}
+		pJointBones[slot] = (int32_t)j;
+	}
+	for (uint32_t b = 0; b < boneCount && result == AS_SUCCESS; b++)
+	{
+		const cgltf_node* pJoint = pSkin->joints[pJointBones[b]];
+		asAnimBuilderBone_t* pBone = &pBones[b];
+		memset(pBone, 0, sizeof(asAnimBuilderBone_t));
+		if (pJoint->name)
+			snprintf(pBone->name, AS_ANIM_MAX_NAME, "%s", pJoint->name);
+		else
+			snprintf(pBone->name, AS_ANIM_MAX_NAME, "joint%d", pJointBones[b]);
+		pBone->paletteIndex = (uint32_t)pJointBones[b];
+		pBone->parent = -1;
+		glm_mat4_identity(pBetween[b]);
+		const cgltf_node* pNode = pJoint->parent;
+		for (; pNode && _animationJointIndex(pSkin, pNode) < 0; pNode = pNode->parent)
+		{
+			mat4 local;
+			cgltf_node_transform_local(pNode, (float*)local);
+			glm_mat4_mul(local, pBetween[b], pBetween[b]);
+		}
+		for (uint32_t parent = 0; pNode && parent < b; parent++)
+		{
+			if (pSkin->joints[pJointBones[parent]] == pNode)
+				pBone->parent = (int32_t)parent;
+		}
+		_animationNodeTRS(pJoint, pBone->restRotation, pBone->restTranslation, pBone->restScale);
+		if (!_animationIsIdentity(pBetween[b]))
+			_animationBake(pBetween[b], pBone->restRotation, pBone->restTranslation, pBone->restScale);
+		glm_mat4_identity(pBone->inverseBind);
+		if (pSkin->inverse_bind_matrices)
+			cgltf_accessor_read_float(pSkin->inverse_bind_matrices, (cgltf_size)pJointBones[b], (float*)pBone->inverseBind, 16);
+	}
+
+	uint32_t clipCount = 0;
+	for (cgltf_size i = 0; i < pData->animations_count && result == AS_SUCCESS; i++)
+	{
+		cookAnimationClip* pClip = &pClips[clipCount++];
+		if (pData->animations[i].name)
+			snprintf(pClip->clip.name, AS_ANIM_MAX_NAME, "%s", pData->animations[i].name);
+		else
+			snprintf(pClip->clip.name, AS_ANIM_MAX_NAME, "clip%u", (uint32_t)i);
+		result = _sampleAnimationClip(&pData->animations[i], pSkin, pJointBones, pBetween, boneCount, settings.rate, pClip);
+		pBuilderClips[clipCount - 1] = pClip->clip;
+	}
+	if (result == AS_SUCCESS)
+	{
+		asAnimBuilderStats_t stats;
+		result = asAnimBuilder_WriteFile(pItem->outputPath, pBones, boneCount, pBuilderClips, clipCount, &settings.compress, &stats);
+		if (result == AS_SUCCESS)
+		{
+			asDebugLog("%s: %u bones, %u clips, %u keys, %zu bytes from %zu", pItem->sourcePath, boneCount, clipCount,
+				stats.keyCount, stats.size, stats.sampledSize);
+		}
+	}
+
+	for (uint32_t i = 0; pClips && i < clipCount; i++)
+	{
+		asFree(pClips[i].pRotations);
+		asFree(pClips[i].pTranslations);
+		asFree(pClips[i].pScales);
+	}
+	asFree(pJointBones);
+	asFree(pDepths);
+	asFree(pBones);
+	asFree(pBetween);
+	asFree(pClips);
+	asFree(pBuilderClips);
+	cgltf_free(pData);
+	return result;
+}
+
+const cookProcessor gProcessors[] = {
+	{ "copy", 1, NULL, _processCopy, NULL },
+	{ "shader", 1, ".asfx", _processShader, _hashShaderDependencies },
+	{ "texture", 3, ".ktx", _processTexture, NULL },
+	{ "texturelz4", 2, ".astex", _processTextureLz4, NULL },
+	{ "atlas", 1, ".asatlas", _processAtlas, _hashAtlasDependencies },
+	{ "model", 5, ".asmdl", _processModel, _hashModelDependencies },
+	{ "animation", 1, ".asanim", _processAnimation, _hashModelDependencies },
+};
+
+static const cookProcessor* _findProcessor(const char* pName)
+{
+	for (size_t i = 0; i < ASARRAYLEN(gProcessors); i++)
+	{
+		if (asIsStringEqual(gProcessors[i].pName, pName))
+			return &gProcessors[i];
+	}
+	return NULL;
+}
+
+/*Source directory configuration (cook.cfg at the root of each source directory)
+[processors] source extension = processor name (unlisted extensions are copied)
+[settings] relative source path or processor name = settings string (part of the content hash, paths win)
+[overrides] relative source path = resource name to load it as
+[packages] relative path prefix = packageOut*/
+
+typedef struct {
+	char* pName;
+	char* pValue;
+} cookProp;
+
+typedef struct {
+	cookProp* pProps;
+	size_t count;
+} cookPropList;
+
+typedef struct {
+	char path[COOK_MAX_PATH];
+	size_t pathLength;
+	cookPropList processors;
+	cookPropList settings;
+	cookPropList overrides;
+	cookPropList packages;
+} cookSourceDir;
+
+static char* _copyString(const char* pStr)
+{
+	size_t length = strlen(pStr);
+	char* pCopy = asMalloc(length + 1);
+	memcpy(pCopy, pStr, length + 1);
+	return pCopy;
+}
+
+static void _loadPropList(asCfgFile_t* pCfg, const char* pSection, cookPropList* pList)
+{
+	memset(pList, 0, sizeof(cookPropList));
+	if (asCfgOpenSection(pCfg, pSection) != 0)
+		return;
+	const char* pName;
+	const char* pValue;
+	while (!asCfgGetNextProp(pCfg, &pName, &pValue))
+	{
+		pList->pProps = asRealloc(pList->pProps, sizeof(cookProp) * (pList->count + 1));
+		pList->pProps[pList->count].pName = _copyString(pName);
+		pList->pProps[pList->count].pValue = _copyString(pValue);
+		pList->count++;
+	}
+}
+
+static void _freePropList(cookPropList* pList)
+{
+	for (size_t i = 0; i < pList->count; i++)
+	{
+		asFree(pList->pProps[i].pName);
+		asFree(pList->pProps[i].pValue);
+	}
+	asFree(pList->pProps);
+}
+
+static const char* _findProp(const cookPropList* pList, const char* pName)
+{
+	for (size_t i = 0; i < pList->count; i++)
+	{
+		if (asIsStringEqual(pList->pProps[i].pName, pName))
+			return pList->pProps[i].pValue;
+	}
+	return NULL;
+}
+
+static const cookProp* _findPrefixProp(const cookPropList* pList, const char* pPath)
+{
+	for (size_t i = 0; i < pList->count; i++)
+	{
+		if (!strncmp(pList->pProps[i].pName, pPath, strlen(pList->pProps[i].pName)))
+			return &pList->pProps[i];
+	}
+	return NULL;
+}
+
+static void _normalizeDir(char* pDir, size_t* pLength)
+{
+	size_t length = strlen(pDir);
+	for (size_t i = 0; i < length; i++)
+	{
+		if (pDir[i] == '\\')
+			pDir[i] = '/';
+	}
+	if (length && pDir[length - 1] != '/' && length < COOK_MAX_PATH - 1)
+	{
+		pDir[length++] = '/';
+		pDir[length] = '\0';
+	}
+	*pLength = length;
+}
+
+/*Collection*/
+
+typedef struct {
+	cookSourceDir* pSource;
+	const char* pOutputDir;
+	cookItem* pItems;
+	size_t itemCount;
+	size_t itemCapacity;
+} cookCollector;
+
+static void _collectFile(const char* pPath, const char* pName, void* pUserData)
+{
+	cookCollector* pCollector = (cookCollector*)pUserData;
+	cookSourceDir* pSource = pCollector->pSource;
+	if (asIsStringEqual(pName, COOK_CONFIG_NAME))
+		return;
+
+	char sourcePath[COOK_MAX_PATH];
+	strncpy(sourcePath, pPath, COOK_MAX_PATH - 1);
+	sourcePath[COOK_MAX_PATH - 1] = '\0';
+	for (char* c = sourcePath; *c; c++)
+	{
+		if (*c == '\\')
+			*c = '/';
+	}
+	if (strncmp(sourcePath, pSource->path, pSource->pathLength))
+		return;
+	const char* pRelative = sourcePath + pSource->pathLength;
+
+	/*Pick the processor from the extension*/
+	const char* pExt = strrchr(pName, '.');
+	const char* pProcessorName = pExt ? _findProp(&pSource->processors, pExt) : NULL;
+	const cookProcessor* pProcessor = _findProcessor(pProcessorName ? pProcessorName : "copy");
+	if (!pProcessor)
+	{
+		asDebugLog("[ERROR]> Unknown processor \"%s\" for %s", pProcessorName, sourcePath);
+		return;
+	}
+
+	if (pCollector->itemCount == pCollector->itemCapacity)
+	{
+		pCollector->itemCapacity = pCollector->itemCapacity ? pCollector->itemCapacity * 2 : 256;
+		pCollector->pItems = asRealloc(pCollector->pItems, sizeof(cookItem) * pCollector->itemCapacity);
+		ASASSERT(pCollector->pItems);
+	}
+	cookItem* pItem = &pCollector->pItems[pCollector->itemCount];
+	memset(pItem, 0, sizeof(cookItem));
+	strncpy(pItem->sourcePath, sourcePath, COOK_MAX_PATH - 1);
+	pItem->pProcessor = pProcessor;
+	pItem->pSettings = _findProp(&pSource->settings, pRelative);
+	if (!pItem->pSettings)
+		pItem->pSettings = _findProp(&pSource->settings, pProcessor->pName);
+	pItem->pOverride = _findProp(&pSource->overrides, pRelative);
+
+	/*Mirror the path (packaged content goes into the package cache)*/
+	size_t relativeLength = strlen(pRelative);
+	if (pProcessor->pOutputExtension && pExt)
+		relativeLength -= strlen(pExt);
+	const bool packaged = _findPrefixProp(&pSource->packages, pRelative) != NULL;
+	int written = snprintf(pItem->outputPath, COOK_MAX_PATH, "%s%s%.*s%s",
+		pCollector->pOutputDir,
+		packaged ? COOK_PAK_CACHE_DIR : "",
+		(int)relativeLength, pRelative,
+		pProcessor->pOutputExtension && pExt ? pProcessor->pOutputExtension : "");
+	if (written < 0 || written >= COOK_MAX_PATH)
+	{
+		asDebugLog("[ERROR]> Output path too long for %s", sourcePath);
+		return;
+	}
+	const char* pOutputRelative = pItem->outputPath + strlen(pCollector->pOutputDir);
+	pItem->outputId = asHashBytes64_xxHash(pOutputRelative, strlen(pOutputRelative));
+	pCollector->itemCount++;
+}
+
+/*Cache (sorted outputId/inputHash pairs stored beside the output directory)*/
+
+typedef struct {
+	asHash64_t outputId;
+	asHash64_t inputHash;
+} cookCacheEntry;
+
+typedef struct {
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t count;
+} cookCacheHeader;
+
+typedef struct {
+	cookCacheEntry* pEntries;
+	size_t count;
+} cookCache;
+
+static int _compareCacheEntries(const void* pA, const void* pB)
+{
+	const cookCacheEntry* a = (const cookCacheEntry*)pA;
+	const cookCacheEntry* b = (const cookCacheEntry*)pB;
+	if (a->outputId < b->outputId)
+		return -1;
+	return a->outputId > b->outputId;
+}
+
+static void _loadCache(cookCache* pCache, const char* pPath)
+{
+	memset(pCache, 0, sizeof(cookCache));
+	size_t size;
+	unsigned char* pData = _readFile(pPath, &size);
+	if (!pData)
+		return;
+	asBinReader reader;
+	cookCacheHeader* pHeader;
+	unsigned char* pEntries;
+	size_t headerSize, entriesSize;
+	if (asBinReaderOpenMemory(&reader, COOK_CACHE_TAG, pData, size) == AS_SUCCESS &&
+		asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "CKHEADER", 0 }, (unsigned char**)&pHeader, &headerSize) == AS_SUCCESS &&
+		asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "ENTRIES", 0 }, &pEntries, &entriesSize) == AS_SUCCESS &&
+		headerSize >= sizeof(cookCacheHeader) &&
+		pHeader->version == COOK_CACHE_VERSION &&
+		entriesSize >= pHeader->count * sizeof(cookCacheEntry) &&
+		pHeader->count)
+	{
+		pCache->count = (size_t)pHeader->count;
+		pCache->pEntries = asMalloc(sizeof(cookCacheEntry) * pCache->count);
+		memcpy(pCache->pEntries, pEntries, sizeof(cookCacheEntry) * pCache->count);
+	}
+	asFree(pData);
+}
+
+static asResults _writeCache(cookItem* pItems, size_t count, const char* pPath)
+{
+	cookCacheEntry* pEntries = asMalloc(sizeof(cookCacheEntry) * (count ? count : 1));
+	size_t entryCount = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		/*Failed items are left out so they run again next time*/
+		if (pItems[i].result != AS_SUCCESS)
+			continue;
+		pEntries[entryCount].outputId = pItems[i].outputId;
+		pEntries[entryCount].inputHash = pItems[i].inputHash;
+		entryCount++;
+	}
+	qsort(pEntries, entryCount, sizeof(cookCacheEntry), _compareCacheEntries);
+
+	cookCacheHeader header = { 0 };
+	header.version = COOK_CACHE_VERSION;
+	header.count = entryCount;
+	asBinWriter writer;
+	asResults result = asBinWriterOpen(&writer, COOK_CACHE_TAG, pPath, 2);
+	if (result == AS_SUCCESS)
+	{
+		asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "CKHEADER", 0 }, (unsigned char*)&header, sizeof(header));
+		asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "ENTRIES", 0 }, (unsigned char*)pEntries, entryCount * sizeof(cookCacheEntry));
+		result = asBinWriterClose(&writer);
+	}
+	asFree(pEntries);
+	return result;
+}
+
+/*Cooking*/
+
+cookCache gCache;
+bool gForceCook = false;
+
+static void _cookJob(void* pUserData)
+{
+	cookItem* pItem = (cookItem*)pUserData;
+	size_t size;
+	unsigned char* pData = _readFile(pItem->sourcePath, &size);
+	if (!pData)
+	{
+		pItem->result = AS_FAILURE_FILE_INACCESSIBLE;
+		return;
+	}
+
+	/*Content, processor version and settings all decide the output*/
+	struct {
+		asHash64_t content;
+		asHash64_t settings;
+		asHash64_t processor;
+		uint64_t version;
+	} key;
+	memset(&key, 0, sizeof(key));
+	key.content = asHashBytes64_xxHash(pData, size);
+	key.settings = pItem->pSettings ? asHashBytes64_xxHash(pItem->pSettings, strlen(pItem->pSettings)) : 0;
+	key.processor = asHashBytes64_xxHash(pItem->pProcessor->pName, strlen(pItem->pProcessor->pName));
+	key.version = pItem->pProcessor->version;
+	if (pItem->pProcessor->fpHashDependencies)
+	{
+		asHash64_t contents[2] = { key.content, pItem->pProcessor->fpHashDependencies(pItem) };
+		key.content = asHashBytes64_xxHash(contents, sizeof(contents));
+	}
+	pItem->inputHash = asHashBytes64_xxHash(&key, sizeof(key));
+	asFree(pData);
+
+	if (!gForceCook)
+	{
+		cookCacheEntry search = { pItem->outputId, 0 };
+		cookCacheEntry* pCached = bsearch(&search, gCache.pEntries, gCache.count, sizeof(cookCacheEntry), _compareCacheEntries);
+		FILE* fp = pCached && pCached->inputHash == pItem->inputHash ? fopen(pItem->outputPath, "rb") : NULL;
+		if (fp)
+		{
+			fclose(fp);
+			pItem->result = AS_SUCCESS;
+			return;
+		}
+	}
+
+	_makeParentDirs(pItem->outputPath);
+	pItem->result = pItem->pProcessor->fpProcess(pItem);
+	pItem->cooked = true;
+	if (pItem->result != AS_SUCCESS)
+		asDebugLog("[ERROR]> %s failed on %s (%d)", pItem->pProcessor->pName, pItem->sourcePath, (int)pItem->result);
+}
+
+/*The MANIFEST phase consumes these, so they are written every run*/
+static void _writeOverride(const cookItem* pItem)
+{
+	char path[COOK_MAX_PATH + 16];
+	snprintf(path, sizeof(path), "%s%s", pItem->outputPath, COOK_OVERRIDE_EXT);
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		asDebugLog("[ERROR]> Could not write override: %s", path);
+		return;
+	}
+	for (const char* c = pItem->pOverride; *c; c++)
+		fputc(*c == '/' ? '@' : *c, fp);
+	fclose(fp);
+}
+
+static void _writePackageConfigs(const cookSourceDir* pSource, const char* pOutputDir)
+{
+	for (size_t i = 0; i < pSource->packages.count; i++)
+	{
+		const cookProp* pPackage = &pSource->packages.pProps[i];
+		char path[COOK_MAX_PATH * 2];
+		int length = snprintf(path, sizeof(path), "%s%s", pOutputDir, COOK_PAK_CACHE_DIR);
+		for (const char* c = pPackage->pValue; *c && length < (int)sizeof(path) - 16; c++)
+			path[length++] = *c == '/' ? '@' : *c;
+		snprintf(path + length, sizeof(path) - length, "%s", COOK_PAKCFG_EXT);
+		_makeParentDirs(path);
+		FILE* fp = fopen(path, "wb");
+		if (!fp)
+		{
+			asDebugLog("[ERROR]> Could not write package config: %s", path);
+			continue;
+		}
+		fprintf(fp, "%s\n", pPackage->pName);
+		fclose(fp);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Asset Cook...");
+
+	/*Options*/
+	int32_t jobs = 0;
+	int argi = 1;
+	for (; argi < argc && argv[argi][0] == '-'; argi++)
+	{
+		if (asIsStringEqual(argv[argi], "-f"))
+			gForceCook = true;
+		else if (asIsStringEqual(argv[argi], "-j") && argi + 1 < argc)
+			jobs = atoi(argv[++argi]);
+	}
+	if (argc - argi < 2)
+	{
+		asDebugLog("Usage: %s [-f] [-j jobs] [output resource directory] [source directory] [more source directories...]", argv[0]);
+		return 1;
+	}
+
+	char outputDir[COOK_MAX_PATH];
+	size_t outputDirLength;
+	strncpy(outputDir, argv[argi], COOK_MAX_PATH - 2);
+	outputDir[COOK_MAX_PATH - 2] = '\0';
+	_normalizeDir(outputDir, &outputDirLength);
+
+	char cachePath[COOK_MAX_PATH + 16];
+	snprintf(cachePath, sizeof(cachePath), "%.*s%s", (int)outputDirLength - 1, outputDir, COOK_CACHE_EXT);
+
+	char* pBinDir = SDL_GetBasePath();
+	snprintf(gShaderCompilerPath, COOK_MAX_PATH, "%sasShaderCompiler", pBinDir ? pBinDir : "");
+	SDL_free(pBinDir);
+
+	/*Scan*/
+	asTimer_t timer = asTimerStart();
+	size_t sourceCount = (size_t)(argc - argi - 1);
+	cookSourceDir* pSources = asMalloc(sizeof(cookSourceDir) * sourceCount);
+	memset(pSources, 0, sizeof(cookSourceDir) * sourceCount);
+	cookCollector collector;
+	memset(&collector, 0, sizeof(collector));
+	collector.pOutputDir = outputDir;
+	for (size_t i = 0; i < sourceCount; i++)
+	{
+		cookSourceDir* pSource = &pSources[i];
+		strncpy(pSource->path, argv[argi + 1 + i], COOK_MAX_PATH - 2);
+		_normalizeDir(pSource->path, &pSource->pathLength);
+
+		char configPath[COOK_MAX_PATH + 16];
+		snprintf(configPath, sizeof(configPath), "%s%s", pSource->path, COOK_CONFIG_NAME);
+		FILE* fp = fopen(configPath, "rb");
+		if (fp)
+		{
+			fclose(fp);
+			asCfgFile_t* pCfg = asCfgLoad(configPath);
+			_loadPropList(pCfg, "processors", &pSource->processors);
+			_loadPropList(pCfg, "settings", &pSource->settings);
+			_loadPropList(pCfg, "overrides", &pSource->overrides);
+			_loadPropList(pCfg, "packages", &pSource->packages);
+			asCfgFree(pCfg);
+		}
+
+		/*Traverse without the trailing slash*/
+		char traversePath[COOK_MAX_PATH];
+		memcpy(traversePath, pSource->path, pSource->pathLength - 1);
+		traversePath[pSource->pathLength - 1] = '\0';
+		collector.pSource = pSource;
+		asResourceManifest_TraverseFiles(traversePath, _collectFile, &collector);
+	}
+	asDebugLog("%zu files in %zu source directories", collector.itemCount, sourceCount);
+
+	/*Cook everything out of date on every core*/
+	_loadCache(&gCache, cachePath);
+	asInitJobSystem(jobs > 0 ? jobs - 1 : 0);
+	asJobDesc_t* pJobs = asMalloc(sizeof(asJobDesc_t) * (collector.itemCount ? collector.itemCount : 1));
+	for (size_t i = 0; i < collector.itemCount; i++)
+	{
+		pJobs[i].fpEntry = _cookJob;
+		pJobs[i].pUserData = &collector.pItems[i];
+	}
+	asJobCounter counter;
+	asJobSystem_CreateCounter(&counter);
+	asJobSystem_Dispatch(pJobs, collector.itemCount, counter);
+	asJobSystem_WaitForCounter(counter);
+	asJobSystem_ReleaseCounter(counter);
+	asShutdownJobSystem();
+	asFree(pJobs);
+
+	/*Overrides, package configs and the new cache*/
+	size_t cookedCount = 0;
+	size_t failedCount = 0;
+	for (size_t i = 0; i < collector.itemCount; i++)
+	{
+		cookItem* pItem = &collector.pItems[i];
+		if (pItem->result != AS_SUCCESS)
+		{
+			failedCount++;
+			continue;
+		}
+		if (pItem->cooked)
+			cookedCount++;
+		if (pItem->pOverride)
+			_writeOverride(pItem);
+	}
+	for (size_t i = 0; i < sourceCount; i++)
+		_writePackageConfigs(&pSources[i], outputDir);
+	asResults result = _writeCache(collector.pItems, collector.itemCount, cachePath);
+	if (result != AS_SUCCESS)
+		asDebugLog("[ERROR]> Could not write cook cache: %s", cachePath);
+
+	asDebugLog("Cooked %zu, up to date %zu, failed %zu in %.3f seconds",
+		cookedCount, collector.itemCount - cookedCount - failedCount, failedCount,
+		asTimerSeconds(timer, asTimerTicksElapsed(timer)));
+
+	for (size_t i = 0; i < sourceCount; i++)
+	{
+		_freePropList(&pSources[i].processors);
+		_freePropList(&pSources[i].settings);
+		_freePropList(&pSources[i].overrides);
+		_freePropList(&pSources[i].packages);
+	}
+	asFree(pSources);
+	asFree(collector.pItems);
+	asFree(gCache.pEntries);
+	return failedCount ? 2 : (result != AS_SUCCESS ? 3 : 0);
+}
@@ -0,0 +1,283 @@
+#include "engine/common/asCommon.h"
+#include "engine/resource/asResource.h"
+#include "engine/resource/asResourceAsyncIO.h"
+#include "engine/thread/asJobSystem.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*Synthetic package layout (regenerated from the seed, nothing is stored besides the package itself)*/
+#define BENCH_SEED 0x6173494f42656e63ull
+#define BENCH_ARENA_SIZE (256ull * 1024 * 1024)
+#define BENCH_WRITE_CHUNK (8ull * 1024 * 1024)
+
+typedef struct {
+	uint64_t offset;
+	uint64_t size;
+} benchEntry;
+
+static uint64_t _xorshift64(uint64_t* pState)
+{
+	uint64_t x = *pState;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *pState = x;
+}
+
+/*Mixed sizes: mostly small, some medium, few large (textures, meshes, audio)*/
+static uint64_t _entrySize(uint64_t* pRng)
+{
+	uint64_t roll = _xorshift64(pRng) % 100;
+	uint64_t r = _xorshift64(pRng);
+	if (roll < 60)
+		return 4096 + r % (60 * 1024);
+	if (roll < 90)
+		return 64 * 1024 + r % (960 * 1024);
+	return 1024 * 1024 + r % (15 * 1024 * 1024);
+}
+
+static benchEntry* _buildLayout(uint64_t packageSize, size_t* pCount)
+{
+	size_t capacity = 1024;
+	size_t count = 0;
+	benchEntry* pEntries = asMalloc(sizeof(benchEntry) * capacity);
+	uint64_t rng = BENCH_SEED;
+	uint64_t offset = 0;
+	for (;;)
+	{
+		uint64_t size = _entrySize(&rng);
+		if (offset + size > packageSize)
+			break;
+		if (count == capacity)
+		{
+			capacity *= 2;
+			pEntries = asRealloc(pEntries, sizeof(benchEntry) * capacity);
+		}
+		pEntries[count].offset = offset;
+		pEntries[count].size = size;
+		count++;
+		/*Packages align entries for direct reads*/
+		offset = (offset + size + AS_RESOURCE_DIRECT_IO_ALIGNMENT - 1) & ~(uint64_t)(AS_RESOURCE_DIRECT_IO_ALIGNMENT - 1);
+	}
+	*pCount = count;
+	return pEntries;
+}
+
+static int _writePackage(const char* pPath, uint64_t packageSize, const benchEntry* pEntries, size_t count)
+{
+	FILE* fp = fopen(pPath, "rb");
+	if (fp)
+	{
+		fseek(fp, 0, SEEK_END);
+		uint64_t existingSize = (uint64_t)ftell(fp);
+		fclose(fp);
+		if (existingSize == packageSize)
+		{
+			asDebugLog("Reusing package: %s", pPath);
+			return 0;
+		}
+	}
+
+	asDebugLog("Writing %" PRIu64 " MB synthetic package (%zu entries): %s", packageSize / (1024 * 1024), count, pPath);
+	fp = fopen(pPath, "wb");
+	if (!fp)
+	{
+		asDebugLog("[ERROR]> Could not open file: %s", pPath);
+		return 3;
+	}
+	uint8_t* pChunk = asMalloc(BENCH_WRITE_CHUNK);
+	uint64_t rng = BENCH_SEED ^ 0xFFFF;
+	size_t nextEntry = 0;
+	for (uint64_t written = 0; written < packageSize; written += BENCH_WRITE_CHUNK)
+	{
+		uint64_t chunkSize = packageSize - written < BENCH_WRITE_CHUNK ? packageSize - written : BENCH_WRITE_CHUNK;
+		for (uint64_t i = 0; i < chunkSize; i += 8)
+		{
+			uint64_t v = _xorshift64(&rng);
+			memcpy(pChunk + i, &v, chunkSize - i < 8 ? chunkSize - i : 8);
+		}
+		/*Stamp each entry with its index for verification*/
+		while (nextEntry < count && pEntries[nextEntry].offset < written + chunkSize)
+		{
+			uint64_t stamp = (uint64_t)nextEntry ^ BENCH_SEED;
+			memcpy(pChunk + (pEntries[nextEntry].offset - written), &stamp, 8);
+			nextEntry++;
+		}
+		if (fwrite(pChunk, (size_t)chunkSize, 1, fp) != 1)
+		{
+			asDebugLog("[ERROR]> Write failed: %s", pPath);
+			asFree(pChunk);
+			fclose(fp);
+			return 3;
+		}
+	}
+	asFree(pChunk);
+	fclose(fp);
+	return 0;
+}
+
+static void _dropPageCache(const char* pPath)
+{
+#if defined(__linux__)
+	int fd = open(pPath, O_RDONLY);
+	if (fd >= 0)
+	{
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+#endif
+}
+
+typedef enum {
+	BENCH_MODE_FREAD,
+	BENCH_MODE_BATCHED,
+} benchMode;
+
+static int _runPass(const char* pName, benchMode mode, const char* pPath, const benchEntry* pEntries, size_t count, uint8_t* pArena, size_t batchSize)
+{
+	_dropPageCache(pPath);
+
+	asResourceLoader_t loader;
+	if (asResourceLoader_OpenFileRange(&loader, pPath, 0, -1) != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Could not open package: %s", pPath);
+		return 3;
+	}
+	asResourceReadRequest_t* pRequests = asMalloc(sizeof(asResourceReadRequest_t) * batchSize);
+	uint64_t totalBytes = 0;
+	size_t mismatches = 0;
+
+	asTimer_t timer = asTimerStart();
+	size_t entry = 0;
+	while (entry < count)
+	{
+		/*Gather a batch that fits in the arena*/
+		size_t batchCount = 0;
+		size_t arenaOffset = 0;
+		while (entry + batchCount < count && batchCount < batchSize)
+		{
+			const benchEntry* pEntry = &pEntries[entry + batchCount];
+			size_t alignedSize = (size_t)((pEntry->size + AS_RESOURCE_DIRECT_IO_ALIGNMENT - 1) & ~(uint64_t)(AS_RESOURCE_DIRECT_IO_ALIGNMENT - 1));
+			if (arenaOffset + alignedSize > BENCH_ARENA_SIZE)
+				break;
+			pRequests[batchCount].pLoader = &loader;
+			pRequests[batchCount].offset = (size_t)pEntry->offset;
+			/*Round the tail up so large reads stay eligible for direct io (stays inside the package)*/
+			pRequests[batchCount].size = pEntry->offset + alignedSize <= (uint64_t)asResourceLoader_GetContentSize(&loader) ? alignedSize : (size_t)pEntry->size;
+			pRequests[batchCount].pDest = pArena + arenaOffset;
+			pRequests[batchCount].flags = 0;
+			arenaOffset += alignedSize;
+			batchCount++;
+		}
+
+		if (mode == BENCH_MODE_FREAD)
+		{
+			for (size_t i = 0; i < batchCount; i++)
+			{
+				asResourceLoader_SetReadPoint(&loader, pRequests[i].offset);
+				asResourceLoader_Read(&loader, pRequests[i].size, pRequests[i].pDest);
+			}
+		}
+		else
+		{
+			asResourceReadBatch batch = NULL;
+			if (asResourceReadBatch_Submit(pRequests, batchCount, &batch) != AS_SUCCESS ||
+				asResourceReadBatch_Wait(batch) != AS_SUCCESS)
+			{
+				asDebugLog("[ERROR]> Batch read failed at entry %zu", entry);
+				asResourceReadBatch_Release(batch);
+				asFree(pRequests);
+				asResourceLoader_Close(&loader);
+				return 4;
+			}
+			asResourceReadBatch_Release(batch);
+		}
+
+		for (size_t i = 0; i < batchCount; i++)
+		{
+			uint64_t stamp;
+			memcpy(&stamp, pRequests[i].pDest, 8);
+			if (stamp != ((uint64_t)(entry + i) ^ BENCH_SEED))
+				mismatches++;
+			totalBytes += pEntries[entry + i].size;
+		}
+		entry += batchCount;
+	}
+	double seconds = asTimerSeconds(timer, asTimerTicksElapsed(timer));
+
+	asFree(pRequests);
+	asResourceLoader_Close(&loader);
+	asDebugLog("%-32s %8.2f MB/s %10.0f reads/s %8.3f s%s",
+		pName,
+		(double)totalBytes / (1024.0 * 1024.0) / seconds,
+		(double)count / seconds,
+		seconds,
+		mismatches ? " [DATA MISMATCH]" : "");
+	return mismatches ? 5 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Resource IO Benchmark...");
+
+	const char* pPath = argc > 1 ? argv[1] : "asIoBenchmark.aspak";
+	uint64_t packageSize = (argc > 2 ? strtoull(argv[2], NULL, 10) : 2048) * 1024 * 1024;
+	size_t batchSize = argc > 3 ? (size_t)strtoull(argv[3], NULL, 10) : 64;
+	if (!packageSize || !batchSize)
+	{
+		asDebugLog("Usage: %s [package path] [package size MB] [reads per batch]", argv[0]);
+		return 1;
+	}
+
+	size_t count;
+	benchEntry* pEntries = _buildLayout(packageSize, &count);
+	int result = _writePackage(pPath, packageSize, pEntries, count);
+	if (result)
+		return result;
+
+	asInitJobSystem(0);
+	uint8_t* pArena = asResourceAsyncIO_AllocAligned(BENCH_ARENA_SIZE);
+	if (!pArena)
+	{
+		asDebugLog("[ERROR]> Could not allocate %d MB arena", (int)(BENCH_ARENA_SIZE / (1024 * 1024)));
+		return 2;
+	}
+	memset(pArena, 0, BENCH_ARENA_SIZE);
+
+	asDebugLog("%zu entries, %zu reads per batch, %d workers", count, batchSize, asJobSystem_GetWorkerCount());
+	result |= _runPass("fread (sequential)", BENCH_MODE_FREAD, pPath, pEntries, count, pArena, batchSize);
+
+	asResourceAsyncIO_SetBackend(AS_RESOURCE_ASYNCIO_BACKEND_JOBSYSTEM);
+	asResourceAsyncIO_SetDirectIO(false, 0);
+	result |= _runPass("job system", BENCH_MODE_BATCHED, pPath, pEntries, count, pArena, batchSize);
+
+	if (asResourceAsyncIO_SetBackend(AS_RESOURCE_ASYNCIO_BACKEND_IO_URING) == AS_SUCCESS)
+	{
+		result |= _runPass("io_uring", BENCH_MODE_BATCHED, pPath, pEntries, count, pArena, batchSize);
+
+		asResourceAsyncIO_SetDirectIO(true, 256 * 1024);
+		result |= _runPass("io_uring + direct", BENCH_MODE_BATCHED, pPath, pEntries, count, pArena, batchSize);
+
+		void* pBuffers[] = { pArena };
+		size_t bufferSizes[] = { BENCH_ARENA_SIZE };
+		if (asResourceAsyncIO_RegisterBuffers(pBuffers, bufferSizes, 1) == AS_SUCCESS)
+		{
+			result |= _runPass("io_uring + direct + registered", BENCH_MODE_BATCHED, pPath, pEntries, count, pArena, batchSize);
+			asResourceAsyncIO_UnregisterBuffers();
+		}
+	}
+	else
+	{
+		asDebugLog("%s", "io_uring unavailable, skipping io_uring passes");
+	}
+
+	asShutdownResourceAsyncIO();
+	asResourceAsyncIO_FreeAligned(pArena);
+	asShutdownJobSystem();
+	asFree(pEntries);
+	return result;
+}
@@ -0,0 +1,326 @@
+#include "engine/common/asCommon.h"
+#include "engine/resource/asResource.h"
+#include "engine/renderer/asTextureFromKtx.h"
+#include "engine/renderer/asTextureLz4.h"
+#include "engine/thread/asJobSystem.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*Synthetic texture set: BC7 textures with a full mip chain stored back to back (like a package)*/
+#define BENCH_SEED 0x61734b7478426e63ull
+#define BENCH_KTX_HEADER_SIZE 64
+#define BENCH_GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define BENCH_GL_RGBA 0x1908
+
+static const uint8_t benchKtxIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+static uint64_t _xorshift64(uint64_t* pState)
+{
+	uint64_t x = *pState;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *pState = x;
+}
+
+static uint32_t _mipCount(uint32_t dimension)
+{
+	uint32_t count = 1;
+	while (dimension > 1)
+	{
+		dimension /= 2;
+		count++;
+	}
+	return count;
+}
+
+static uint32_t _mipSize(uint32_t dimension, uint32_t mip)
+{
+	uint32_t d = dimension >> mip;
+	uint32_t blocks = (d + 3) / 4;
+	return (blocks ? blocks : 1) * (blocks ? blocks : 1) * 16;
+}
+
+static size_t _ktxFileSize(uint32_t dimension)
+{
+	size_t size = BENCH_KTX_HEADER_SIZE;
+	for (uint32_t i = 0; i < _mipCount(dimension); i++)
+		size += sizeof(uint32_t) + ((_mipSize(dimension, i) + 3) & ~3u);
+	return size;
+}
+
+/*Compressible textures repeat each 64 bytes of noise so the LZ4 chunks really get decoded*/
+static void _writeKtx(uint8_t* pDst, uint32_t dimension, uint64_t* pRng, bool compressible)
+{
+	uint32_t header[13] = {
+		0x04030201, /*endianness*/
+		0, 1, 0, /*glType, glTypeSize, glFormat (compressed)*/
+		BENCH_GL_COMPRESSED_RGBA_BPTC_UNORM, BENCH_GL_RGBA,
+		dimension, dimension, 0, /*width, height, depth*/
+		0, 1, _mipCount(dimension), 0 /*array elements, faces, mips, key/value bytes*/
+	};
+	memcpy(pDst, benchKtxIdentifier, 12);
+	memcpy(pDst + 12, header, sizeof(header));
+	uint8_t* pPos = pDst + BENCH_KTX_HEADER_SIZE;
+	for (uint32_t i = 0; i < _mipCount(dimension); i++)
+	{
+		uint32_t size = _mipSize(dimension, i);
+		memcpy(pPos, &size, sizeof(uint32_t));
+		pPos += sizeof(uint32_t);
+		for (uint32_t j = 0; j < size; j += 8)
+		{
+			uint64_t v = compressible && j >= 64 ? 0 : _xorshift64(pRng);
+			if (compressible && j >= 64)
+				memcpy(&v, pPos + j - 64, 8);
+			memcpy(pPos + j, &v, 8);
+		}
+		pPos += (size + 3) & ~3u;
+	}
+}
+
+static int _writeSet(const char* pPath, uint32_t dimension, size_t count)
+{
+	const size_t fileSize = _ktxFileSize(dimension);
+	FILE* fp = fopen(pPath, "rb");
+	if (fp)
+	{
+		fseek(fp, 0, SEEK_END);
+		uint64_t existingSize = (uint64_t)ftell(fp);
+		fclose(fp);
+		if (existingSize == (uint64_t)fileSize * count)
+		{
+			asDebugLog("Reusing texture set: %s", pPath);
+			return 0;
+		}
+	}
+
+	asDebugLog("Writing %zu MB synthetic texture set (%zu textures): %s", (fileSize * count) / (1024 * 1024), count, pPath);
+	fp = fopen(pPath, "wb");
+	if (!fp)
+	{
+		asDebugLog("[ERROR]> Could not open file: %s", pPath);
+		return 3;
+	}
+	uint8_t* pFile = asMalloc(fileSize);
+	uint64_t rng = BENCH_SEED;
+	for (size_t i = 0; i < count; i++)
+	{
+		_writeKtx(pFile, dimension, &rng, false);
+		if (fwrite(pFile, fileSize, 1, fp) != 1)
+		{
+			asDebugLog("[ERROR]> Write failed: %s", pPath);
+			asFree(pFile);
+			fclose(fp);
+			return 3;
+		}
+	}
+	asFree(pFile);
+	fclose(fp);
+	return 0;
+}
+
+static void _dropPageCache(const char* pPath)
+{
+#if defined(__linux__)
+	int fd = open(pPath, O_RDONLY);
+	if (fd >= 0)
+	{
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+#endif
+}
+
+typedef enum {
+	BENCH_MODE_COPY, /*Read the file into memory, copy the mips out, copy into staging*/
+	BENCH_MODE_MAPPED, /*Map the file, copy the mips straight from the mapping into staging*/
+	BENCH_MODE_DIRECT, /*Read the header, read the mips straight into staging*/
+} benchMode;
+
+static int _runPass(const char* pName, benchMode mode, const char* pPath, uint32_t dimension, size_t count, uint8_t* pStaging, uint64_t* pHashes)
+{
+	_dropPageCache(pPath);
+
+	const size_t fileSize = _ktxFileSize(dimension);
+	asTextureContentRegion_t regions[AS_TEXTURE_MAX_REGIONS];
+	uint64_t totalBytes = 0;
+	uint64_t ticks = 0;
+	size_t failures = 0;
+	size_t mismatches = 0;
+	asTimer_t timer = asTimerStart();
+	for (size_t i = 0; i < count; i++)
+	{
+		const int64_t start = (int64_t)(fileSize * i);
+		asTextureDesc_t desc;
+		asResults result = AS_SUCCESS;
+		timer = asTimerRestart(timer);
+		if (mode == BENCH_MODE_COPY)
+		{
+			asResourceLoader_t loader;
+			result = asResourceLoader_OpenFileRange(&loader, pPath, start, (int64_t)fileSize);
+			if (result == AS_SUCCESS)
+			{
+				uint8_t* pBlob = asMalloc(fileSize);
+				asResourceLoader_ReadAll(&loader, fileSize, pBlob);
+				asResourceLoader_Close(&loader);
+				result = asTextureDesc_FromKtxData(&desc, pBlob, fileSize);
+				if (result == AS_SUCCESS)
+				{
+					result = asTextureDesc_WriteUpload(&desc, pStaging, regions);
+					asTextureDesc_FreeKtxData(&desc);
+				}
+				asFree(pBlob);
+			}
+		}
+		else if (mode == BENCH_MODE_MAPPED)
+		{
+			asResourceFileView_t view;
+			result = asResourceFileView_OpenFileRange(&view, pPath, start, (int64_t)fileSize);
+			if (result == AS_SUCCESS)
+			{
+				result = asTextureDesc_FromKtxDataInPlace(&desc, view.pData, view.size);
+				if (result == AS_SUCCESS)
+					result = asTextureDesc_WriteUpload(&desc, pStaging, regions);
+				asResourceFileView_Close(&view);
+			}
+		}
+		else
+		{
+			asResourceLoader_t loader;
+			result = asResourceLoader_OpenFileRange(&loader, pPath, start, (int64_t)fileSize);
+			if (result == AS_SUCCESS)
+			{
+				result = asTextureDesc_FromKtxLoader(&desc, &loader);
+				if (result == AS_SUCCESS)
+					result = asTextureDesc_WriteUpload(&desc, pStaging, regions);
+				asResourceLoader_Close(&loader);
+			}
+		}
+		ticks += asTimerTicksElapsed(timer);
+
+		/*Every path must leave the same bytes in staging*/
+		if (result != AS_SUCCESS)
+		{
+			failures++;
+			continue;
+		}
+		const size_t uploadSize = asTextureDesc_GetUploadSize(&desc);
+		const uint64_t hash = asHashBytes64_xxHash(pStaging, uploadSize);
+		if (!pHashes[i])
+			pHashes[i] = hash;
+		else if (pHashes[i] != hash)
+			mismatches++;
+		totalBytes += uploadSize;
+	}
+	double seconds = asTimerSeconds(timer, ticks);
+
+	asDebugLog("%-32s %8.2f MB/s %8.1f textures/s %8.3f s%s%s",
+		pName,
+		(double)totalBytes / (1024.0 * 1024.0) / seconds,
+		(double)count / seconds,
+		seconds,
+		failures ? " [LOAD FAILED]" : "",
+		mismatches ? " [DATA MISMATCH]" : "");
+	return (failures || mismatches) ? 5 : 0;
+}
+
+/*Cook a texture to the supercompressed format and load it back the way the runtime does, the staging bytes must match the ktx*/
+static int _runRoundTrip(const char* pPath, uint32_t dimension, uint8_t* pStaging, bool compressible)
+{
+	const size_t fileSize = _ktxFileSize(dimension);
+	uint8_t* pKtx = asMalloc(fileSize);
+	uint64_t rng = BENCH_SEED;
+	_writeKtx(pKtx, dimension, &rng, compressible);
+
+	asTextureContentRegion_t regions[AS_TEXTURE_MAX_REGIONS];
+	asTextureDesc_t desc;
+	uint64_t ktxHash = 0;
+	asResults result = asTextureDesc_FromKtxDataInPlace(&desc, pKtx, fileSize);
+	if (result == AS_SUCCESS)
+		result = asTextureDesc_WriteUpload(&desc, pStaging, regions);
+	if (result == AS_SUCCESS)
+	{
+		ktxHash = asHashBytes64_xxHash(pStaging, asTextureDesc_GetUploadSize(&desc));
+		result = asTextureDesc_WriteLz4File(&desc, pPath, 0);
+	}
+	asFree(pKtx);
+
+	uint64_t lz4Hash = 0;
+	size_t cookedSize = 0;
+	if (result == AS_SUCCESS)
+	{
+		memset(pStaging, 0, fileSize);
+		asResourceFileView_t view;
+		result = asResourceFileView_OpenFileRange(&view, pPath, 0, -1);
+		if (result == AS_SUCCESS)
+		{
+			cookedSize = view.size;
+			result = asTextureDesc_FromLz4Data(&desc, view.pData, view.size);
+			if (result == AS_SUCCESS)
+				result = asTextureDesc_WriteUpload(&desc, pStaging, regions);
+			if (result == AS_SUCCESS)
+				lz4Hash = asHashBytes64_xxHash(pStaging, asTextureDesc_GetUploadSize(&desc));
+			asResourceFileView_Close(&view);
+		}
+	}
+	remove(pPath);
+
+	asDebugLog("%-32s %8.1f%% of ktx%s%s",
+		compressible ? "lz4 round trip (compressible)" : "lz4 round trip (noise)",
+		100.0 * (double)cookedSize / (double)fileSize,
+		result != AS_SUCCESS ? " [LOAD FAILED]" : "",
+		result == AS_SUCCESS && lz4Hash != ktxHash ? " [DATA MISMATCH]" : "");
+	return (result != AS_SUCCESS || lz4Hash != ktxHash) ? 5 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Texture Load Benchmark...");
+
+	const char* pPath = argc > 1 ? argv[1] : "asKtxBenchmark.ktxset";
+	uint64_t setSize = (argc > 2 ? strtoull(argv[2], NULL, 10) : 4096) * 1024 * 1024;
+	uint32_t dimension = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 2048;
+	if (!setSize || dimension < 4 || _mipCount(dimension) > AS_TEXTURE_MAX_REGIONS)
+	{
+		asDebugLog("Usage: %s [texture set path] [set size MB] [texture dimension]", argv[0]);
+		return 1;
+	}
+
+	const size_t fileSize = _ktxFileSize(dimension);
+	const size_t count = (size_t)(setSize / fileSize) ? (size_t)(setSize / fileSize) : 1;
+	int result = _writeSet(pPath, dimension, count);
+	if (result)
+		return result;
+
+	/*Stands in for a mapped staging allocation (no device in a tool)*/
+	uint8_t* pStaging = asMalloc(fileSize);
+	uint64_t* pHashes = asMalloc(sizeof(uint64_t) * count);
+	if (!pStaging || !pHashes)
+	{
+		asDebugLog("%s", "[ERROR]> Out of memory");
+		return 2;
+	}
+	memset(pStaging, 0, fileSize);
+	memset(pHashes, 0, sizeof(uint64_t) * count);
+
+	asDebugLog("%zu textures of %ux%u BC7 (%u mips), %.1f MB each", count, dimension, dimension, _mipCount(dimension), (double)fileSize / (1024.0 * 1024.0));
+	result |= _runPass("copy (read all + unpack)", BENCH_MODE_COPY, pPath, dimension, count, pStaging, pHashes);
+	result |= _runPass("mapped (in place)", BENCH_MODE_MAPPED, pPath, dimension, count, pStaging, pHashes);
+	result |= _runPass("direct (read into staging)", BENCH_MODE_DIRECT, pPath, dimension, count, pStaging, pHashes);
+
+	/*Chunks are compressed and decoded on the job system*/
+	char roundTripPath[1024];
+	snprintf(roundTripPath, sizeof(roundTripPath), "%s.astex", pPath);
+	asInitJobSystem(0);
+	result |= _runRoundTrip(roundTripPath, dimension, pStaging, false);
+	result |= _runRoundTrip(roundTripPath, dimension, pStaging, true);
+	asShutdownJobSystem();
+
+	asFree(pHashes);
+	asFree(pStaging);
+	return result;
+}
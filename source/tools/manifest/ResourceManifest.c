@@ -0,0 +1,32 @@
+#include "engine/common/asCommon.h"
+#include "engine/resource/asResourceManifest.h"
+
+/*MANIFEST phase: run after cooking, before packing*/
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Resource Manifest Generator...");
+
+	char resourcePath[1024];
+	memset(resourcePath, 0, 1024);
+	if (argc < 2) /*Resource Path*/
+	{
+		asDebugLog("%s", "Input (full) Resource Directory Path:");
+		fgets(resourcePath, 1024, stdin);
+		for (int i = 0; i < 1024; i++) { if (resourcePath[i] == '\n') { resourcePath[i] = '\0'; } }
+	}
+	else
+	{
+		strncat(resourcePath, argv[1], 1023);
+		asDebugLog("%s", resourcePath);
+	}
+
+	asTimer_t timer = asTimerStart();
+	asResults result = asResourceManifest_Generate(resourcePath);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Manifest generation failed: %d", (int)result);
+		return (int)result;
+	}
+	asDebugLog("Manifest written in %.3f seconds", asTimerSeconds(timer, asTimerTicksElapsed(timer)));
+	return 0;
+}
@@ -0,0 +1,330 @@
+#include "engine/common/asCommon.h"
+#include "engine/model/builder/asMeshBuildingAPI.h"
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf/cgltf.h"
+
+/*Generated meshes come the way some exporters hand them over: every triangle has its own vertices*/
+#define BENCH_SEED 0x61734d6573684263ull
+
+static uint64_t _xorshift64(uint64_t* pState)
+{
+	uint64_t x = *pState;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *pState = x;
+}
+
+static void _encodeVertex(asVertexGeneric* pVertex, const float* pPos, const float* pNormal, const float* pUv)
+{
+	memset(pVertex, 0, sizeof(asVertexGeneric));
+	asVertexGeneric_encodePosition(pVertex, pPos);
+	if (pNormal)
+		asVertexGeneric_encodeNormal(pVertex, pNormal);
+	if (pUv)
+		asVertexGeneric_encodeUV(pVertex, 0, pUv);
+	const uint8_t white[4] = { 255, 255, 255, 255 };
+	asVertexGeneric_encodeColor(pVertex, white);
+}
+
+/*UV sphere split into separate triangles in a random order*/
+static void _buildSphere(asMeshBuilderMesh_t* pMesh, uint32_t rings, uint32_t segments)
+{
+	const uint32_t triCount = rings * segments * 2;
+	pMesh->vertexCount = triCount * 3;
+	pMesh->indexCount = triCount * 3;
+	pMesh->pVertices = asMalloc(sizeof(asVertexGeneric) * pMesh->vertexCount);
+	pMesh->pIndices = asMalloc(sizeof(uint32_t) * pMesh->indexCount);
+	uint32_t* pOrder = asMalloc(sizeof(uint32_t) * triCount);
+	for (uint32_t i = 0; i < triCount; i++)
+		pOrder[i] = i;
+	uint64_t rng = BENCH_SEED;
+	for (uint32_t i = triCount - 1; i > 0; i--)
+	{
+		const uint32_t j = (uint32_t)(_xorshift64(&rng) % (i + 1));
+		const uint32_t tmp = pOrder[i];
+		pOrder[i] = pOrder[j];
+		pOrder[j] = tmp;
+	}
+	for (uint32_t r = 0; r < rings; r++)
+	{
+		for (uint32_t s = 0; s < segments; s++)
+		{
+			const uint32_t grid[4][2] = { { r, s }, { r + 1, s }, { r + 1, s + 1 }, { r, s + 1 } };
+			const uint32_t quad[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+			for (uint32_t t = 0; t < 2; t++)
+			{
+				const uint32_t tri = pOrder[(r * segments + s) * 2 + t];
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					const uint32_t* pGrid = grid[quad[t][k]];
+					const float theta = (float)pGrid[0] / (float)rings * GLM_PIf;
+					const float phi = (float)(pGrid[1] % segments) / (float)segments * 2.0f * GLM_PIf;
+					vec3 normal = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+					vec2 uv = { (float)pGrid[1] / (float)segments, (float)pGrid[0] / (float)rings };
+					_encodeVertex(&pMesh->pVertices[tri * 3 + k], normal, normal, uv);
+					pMesh->pIndices[tri * 3 + k] = tri * 3 + k;
+				}
+			}
+		}
+	}
+	asFree(pOrder);
+}
+
+static bool _loadPrimitive(asMeshBuilderMesh_t* pMesh, const cgltf_primitive* pPrim)
+{
+	const cgltf_accessor* pPositions = NULL;
+	const cgltf_accessor* pNormals = NULL;
+	const cgltf_accessor* pUvs = NULL;
+	for (cgltf_size i = 0; i < pPrim->attributes_count; i++)
+	{
+		const cgltf_attribute* pAttrib = &pPrim->attributes[i];
+		if (pAttrib->type == cgltf_attribute_type_position)
+			pPositions = pAttrib->data;
+		else if (pAttrib->type == cgltf_attribute_type_normal)
+			pNormals = pAttrib->data;
+		else if (pAttrib->type == cgltf_attribute_type_texcoord && pAttrib->index == 0)
+			pUvs = pAttrib->data;
+	}
+	if (pPrim->type != cgltf_primitive_type_triangles || !pPositions || !pPositions->count)
+		return false;
+
+	pMesh->vertexCount = (uint32_t)pPositions->count;
+	pMesh->indexCount = (uint32_t)(pPrim->indices ? pPrim->indices->count : pPositions->count) / 3 * 3;
+	pMesh->pVertices = asMalloc(sizeof(asVertexGeneric) * pMesh->vertexCount);
+	pMesh->pIndices = asMalloc(sizeof(uint32_t) * (pMesh->indexCount ? pMesh->indexCount : 1));
+	for (uint32_t i = 0; i < pMesh->vertexCount; i++)
+	{
+		float pos[3] = { 0 };
+		float normal[3] = { 0 };
+		float uv[2] = { 0 };
+		cgltf_accessor_read_float(pPositions, i, pos, 3);
+		if (pNormals)
+			cgltf_accessor_read_float(pNormals, i, normal, 3);
+		if (pUvs)
+			cgltf_accessor_read_float(pUvs, i, uv, 2);
+		_encodeVertex(&pMesh->pVertices[i], pos, pNormals ? normal : NULL, pUvs ? uv : NULL);
+	}
+	for (uint32_t i = 0; i < pMesh->indexCount; i++)
+		pMesh->pIndices[i] = pPrim->indices ? (uint32_t)cgltf_accessor_read_index(pPrim->indices, i) : i;
+	return true;
+}
+
+struct benchTotals
+{
+	uint64_t triangles;
+	uint64_t transformedBefore[2];
+	uint64_t transformedAfter[2];
+	double seconds;
+};
+
+/*Every triangle of a level in exactly one meshlet, in its index range and inside its bounding sphere*/
+static bool _checkMeshlets(const asMeshBuilderMesh_t* pMesh, uint32_t firstIndex, uint32_t indexCount, uint32_t firstMeshlet, uint32_t meshletCount)
+{
+	uint32_t nextIndex = firstIndex;
+	for (uint32_t m = firstMeshlet; m < firstMeshlet + meshletCount; m++)
+	{
+		const asModelMeshlet_t* pMeshlet = &pMesh->pMeshlets[m];
+		if (pMeshlet->firstIndex != nextIndex || pMeshlet->vertexCount > AS_MODEL_MESHLET_MAX_VERTICES ||
+			pMeshlet->triangleCount == 0 || pMeshlet->triangleCount > AS_MODEL_MESHLET_MAX_TRIANGLES || pMeshlet->coneCutoff > 1.0f)
+		{
+			return false;
+		}
+		const uint32_t* pVertices = &pMesh->pMeshletVertices[pMeshlet->firstVertex];
+		const uint8_t* pTriangles = &pMesh->pMeshletTriangles[pMeshlet->firstTriangle];
+		for (uint32_t i = 0; i < pMeshlet->triangleCount * 3u; i++)
+		{
+			if (pTriangles[i] >= pMeshlet->vertexCount || pVertices[pTriangles[i]] != pMesh->pIndices[pMeshlet->firstIndex + i])
+				return false;
+		}
+		for (uint32_t i = 0; i < pMeshlet->vertexCount; i++)
+		{
+			if (glm_vec3_distance((float*)pMeshlet->center, (float*)pMesh->pVertices[pVertices[i]].position) > pMeshlet->radius * 1.0001f + 1e-6f)
+				return false;
+		}
+		nextIndex += pMeshlet->triangleCount * 3u;
+	}
+	return nextIndex == firstIndex + indexCount;
+}
+
+static const uint32_t benchCacheSizes[2] = { 16, AS_MESH_BUILDER_CACHE_SIZE };
+
+static int _runMesh(const char* pName, asMeshBuilderMesh_t* pMesh, struct benchTotals* pTotals)
+{
+	/*Compare against the authored triangle order once duplicates are welded (unwelded vertices never hit the cache)*/
+	const uint32_t authoredVertexCount = pMesh->vertexCount;
+	asTimer_t timer = asTimerStart();
+	asResults result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_WELD);
+	uint64_t ticks = asTimerTicksElapsed(timer);
+	asVertexCacheStats_t before[2];
+	for (int i = 0; i < 2; i++)
+		before[i] = asMeshBuilder_AnalyzeVertexCache(pMesh->pIndices, pMesh->indexCount, pMesh->vertexCount, benchCacheSizes[i]);
+	const uint32_t weldedVertexCount = pMesh->vertexCount;
+
+	timer = asTimerRestart(timer);
+	if (result == AS_SUCCESS)
+		result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_ALL & ~AS_MESHOPTIMIZE_WELD);
+	ticks += asTimerTicksElapsed(timer);
+	const double seconds = asTimerSeconds(timer, ticks);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> %s: optimization failed (%d)", pName, result);
+		return 4;
+	}
+
+	asVertexCacheStats_t after[2];
+	for (int i = 0; i < 2; i++)
+		after[i] = asMeshBuilder_AnalyzeVertexCache(pMesh->pIndices, pMesh->indexCount, pMesh->vertexCount, benchCacheSizes[i]);
+	asDebugLog("%-32s %8u tris %8u -> %8u -> %8u verts  ACMR(%u) %.3f -> %.3f  ATVR(%u) %.3f -> %.3f  ACMR(%u) %.3f -> %.3f  %u bit indices %8.2f ms",
+		pName, pMesh->indexCount / 3, authoredVertexCount, weldedVertexCount, pMesh->vertexCount,
+		benchCacheSizes[0], before[0].acmr, after[0].acmr,
+		benchCacheSizes[0], before[0].atvr, after[0].atvr,
+		benchCacheSizes[1], before[1].acmr, after[1].acmr,
+		asMeshBuilder_GetIndexSize(pMesh->vertexCount) * 8, seconds * 1000.0);
+
+	/*Levels of detail of the optimized mesh*/
+	asMeshBuilderLodDesc_t lodDesc = asMeshBuilderLodDesc_Init();
+	timer = asTimerRestart(timer);
+	result = asMeshBuilder_GenerateLods(pMesh, &lodDesc);
+	if (result == AS_SUCCESS)
+		result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_VERTEX_CACHE | AS_MESHOPTIMIZE_OVERDRAW);
+	const double lodSeconds = asTimerSeconds(timer, asTimerTicksElapsed(timer));
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> %s: level of detail generation failed (%d)", pName, result);
+		return 4;
+	}
+	for (uint32_t i = 1; i < pMesh->lodCount; i++)
+	{
+		const asMeshBuilderLod_t* pLod = &pMesh->lods[i];
+		const asVertexCacheStats_t lodStats = asMeshBuilder_AnalyzeVertexCache(&pMesh->pIndices[pLod->firstIndex], pLod->indexCount,
+			pMesh->vertexCount, AS_MESH_BUILDER_CACHE_SIZE);
+		asDebugLog("%-32s   lod %u %8u tris (%5.1f%%)  error %f  ACMR(%u) %.3f",
+			"", i, pLod->indexCount / 3, (double)pLod->indexCount * 100.0 / (double)pMesh->lods[0].indexCount, pLod->error,
+			AS_MESH_BUILDER_CACHE_SIZE, lodStats.acmr);
+	}
+	asDebugLog("%-32s   %u levels %8.2f ms", "", pMesh->lodCount, lodSeconds * 1000.0);
+
+	/*Meshlets of every level, their order is what the vertex cache sees now*/
+	asMeshBuilderMeshletDesc_t meshletDesc = asMeshBuilderMeshletDesc_Init();
+	timer = asTimerRestart(timer);
+	result = asMeshBuilder_BuildMeshlets(pMesh, &meshletDesc);
+	const double meshletSeconds = asTimerSeconds(timer, asTimerTicksElapsed(timer));
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> %s: meshlet generation failed (%d)", pName, result);
+		return 4;
+	}
+	uint32_t culledCones = 0;
+	for (uint32_t i = 0; i < pMesh->meshletCount; i++)
+		culledCones += pMesh->pMeshlets[i].coneCutoff < 1.0f;
+	for (uint32_t i = 0; i < pMesh->lodCount; i++)
+	{
+		const asMeshBuilderLod_t* pLod = &pMesh->lods[i];
+		if (!_checkMeshlets(pMesh, pLod->firstIndex, pLod->indexCount, pLod->firstMeshlet, pLod->meshletCount))
+		{
+			asDebugLog("[ERROR]> %s: meshlets of lod %u do not match its triangles", pName, i);
+			return 4;
+		}
+	}
+	const asMeshBuilderLod_t* pFull = &pMesh->lods[0];
+	const asVertexCacheStats_t meshletStats = asMeshBuilder_AnalyzeVertexCache(&pMesh->pIndices[pFull->firstIndex], pFull->indexCount,
+		pMesh->vertexCount, AS_MESH_BUILDER_CACHE_SIZE);
+	asDebugLog("%-32s   %u meshlets (%u in lod 0)  %.1f verts %.1f tris each  %u cullable cones  ACMR(%u) %.3f %8.2f ms",
+		"", pMesh->meshletCount, pFull->meshletCount,
+		(double)pMesh->meshletVertexCount / (double)(pMesh->meshletCount ? pMesh->meshletCount : 1),
+		(double)(pMesh->indexCount / 3) / (double)(pMesh->meshletCount ? pMesh->meshletCount : 1),
+		culledCones, AS_MESH_BUILDER_CACHE_SIZE, meshletStats.acmr, meshletSeconds * 1000.0);
+
+	pTotals->triangles += pMesh->lods[0].indexCount / 3;
+	for (int i = 0; i < 2; i++)
+	{
+		pTotals->transformedBefore[i] += before[i].verticesTransformed;
+		pTotals->transformedAfter[i] += after[i].verticesTransformed;
+	}
+	pTotals->seconds += seconds;
+	return 0;
+}
+
+static int _runFile(const char* pPath, struct benchTotals* pTotals)
+{
+	cgltf_options options;
+	memset(&options, 0, sizeof(options));
+	cgltf_data* pData = NULL;
+	if (cgltf_parse_file(&options, pPath, &pData) != cgltf_result_success ||
+		cgltf_load_buffers(&options, pData, pPath) != cgltf_result_success)
+	{
+		asDebugLog("[ERROR]> Could not load glTF: %s", pPath);
+		if (pData)
+			cgltf_free(pData);
+		return 3;
+	}
+	int result = 0;
+	for (cgltf_size m = 0; m < pData->meshes_count; m++)
+	{
+		for (cgltf_size p = 0; p < pData->meshes[m].primitives_count; p++)
+		{
+			asMeshBuilderMesh_t mesh;
+			memset(&mesh, 0, sizeof(mesh));
+			if (!_loadPrimitive(&mesh, &pData->meshes[m].primitives[p]))
+				continue;
+			char name[64];
+			snprintf(name, 64, "%s[%zu]", pData->meshes[m].name ? pData->meshes[m].name : "mesh", (size_t)p);
+			result |= _runMesh(name, &mesh, pTotals);
+			asFree(mesh.pVertices);
+			asFree(mesh.pIndices);
+			asFree(mesh.pMeshlets);
+			asFree(mesh.pMeshletVertices);
+			asFree(mesh.pMeshletTriangles);
+		}
+	}
+	cgltf_free(pData);
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Mesh Optimization and Simplification Benchmark...");
+	struct benchTotals totals;
+	memset(&totals, 0, sizeof(totals));
+	int result = 0;
+
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			asDebugLog("%s", argv[i]);
+			result |= _runFile(argv[i], &totals);
+		}
+	}
+	else
+	{
+		asDebugLog("%s", "No glTF files given, using generated spheres (usage: asMeshBenchmark [model.gltf/glb]...)");
+		const uint32_t sizes[3][2] = { { 16, 32 }, { 64, 128 }, { 256, 512 } };
+		for (int i = 0; i < 3; i++)
+		{
+			asMeshBuilderMesh_t mesh;
+			memset(&mesh, 0, sizeof(mesh));
+			char name[64];
+			snprintf(name, 64, "sphere %ux%u", sizes[i][0], sizes[i][1]);
+			_buildSphere(&mesh, sizes[i][0], sizes[i][1]);
+			result |= _runMesh(name, &mesh, &totals);
+			asFree(mesh.pVertices);
+			asFree(mesh.pIndices);
+			asFree(mesh.pMeshlets);
+			asFree(mesh.pMeshletVertices);
+			asFree(mesh.pMeshletTriangles);
+		}
+	}
+
+	if (totals.triangles)
+	{
+		asDebugLog("Total %" PRIu64 " tris  ACMR(%u) %.3f -> %.3f  ACMR(%u) %.3f -> %.3f  %.2f ms",
+			totals.triangles,
+			benchCacheSizes[0], (double)totals.transformedBefore[0] / (double)totals.triangles, (double)totals.transformedAfter[0] / (double)totals.triangles,
+			benchCacheSizes[1], (double)totals.transformedBefore[1] / (double)totals.triangles, (double)totals.transformedAfter[1] / (double)totals.triangles,
+			totals.seconds * 1000.0);
+	}
+	return result;
+}
@@ -0,0 +1,499 @@
+#include "engine/common/asCommon.h"
+#include "engine/common/asBin.h"
+#include "engine/model/builder/asMeshBuildingAPI.h"
+#include "engine/common/reflection/asReflectIOBinary.h"
+
+/*Reflected equivalent of an asMdl: every table is a reflection section parsed field by field into its own allocation*/
+#define BENCH_ITERATIONS 32
+#define BENCH_MAX_PATH 256
+#define BENCH_REFLECT_TAG "AMDR"
+
+#include "engine/common/reflection/asReflectDefine.h"
+
+#define REFLECT_MACRO_BenchModelHeader AS_REFLECT_STRUCT(benchModelHeader,\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, flags, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, vertexCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, indexCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, indexSize, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, submeshCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchModelHeader, uint32_t, materialCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchModelHeader, float, boundsMin, 3, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchModelHeader, float, boundsMax, 3, AS_REFLECT_FORMAT_NONE)\
+)
+REFLECT_MACRO_BenchModelHeader
+
+#define REFLECT_MACRO_BenchSubmesh AS_REFLECT_STRUCT(benchSubmesh,\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, char, name, AS_MODEL_MAX_NAME, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchSubmesh, uint32_t, materialIndex, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchSubmesh, uint32_t, vertexOffset, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchSubmesh, uint32_t, vertexCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchSubmesh, uint32_t, lodCount, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, uint32_t, lodFirstIndex, AS_MODEL_MAX_LODS, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, uint32_t, lodIndexCount, AS_MODEL_MAX_LODS, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, float, lodError, AS_MODEL_MAX_LODS, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, float, boundsMin, 3, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchSubmesh, float, boundsMax, 3, AS_REFLECT_FORMAT_NONE)\
+)
+REFLECT_MACRO_BenchSubmesh
+
+#define REFLECT_MACRO_BenchMaterial AS_REFLECT_STRUCT(benchMaterial,\
+	AS_REFLECT_ENTRY_ARRAY(benchMaterial, char, name, AS_MODEL_MAX_NAME, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchMaterial, char, textures, AS_MODEL_TEXTURE_COUNT * BENCH_MAX_PATH, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchMaterial, float, baseColor, 4, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_ARRAY(benchMaterial, float, emissive, 3, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, float, metallic, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, float, roughness, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, float, normalScale, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, float, occlusionStrength, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, float, alphaCutoff, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, uint32_t, alphaMode, AS_REFLECT_FORMAT_NONE)\
+	AS_REFLECT_ENTRY_SINGLE(benchMaterial, uint32_t, doubleSided, AS_REFLECT_FORMAT_NONE)\
+)
+REFLECT_MACRO_BenchMaterial
+
+#include "engine/common/reflection/asReflectImpliment.h"
+asReflectContainer benchModelHeaderReflectData = REFLECT_MACRO_BenchModelHeader;
+asReflectContainer benchSubmeshReflectData = REFLECT_MACRO_BenchSubmesh;
+asReflectContainer benchMaterialReflectData = REFLECT_MACRO_BenchMaterial;
+asReflectContainer benchVertexReflectData = REFLECT_MACRO_Vertex_Generic;
+
+typedef struct {
+	benchModelHeader header;
+	benchSubmesh* pSubmeshes;
+	benchMaterial* pMaterials;
+	asVertexGeneric* pVertices;
+	void* pIndices;
+} benchReflectedModel;
+
+static void _freeReflectedModel(benchReflectedModel* pModel)
+{
+	asFree(pModel->pSubmeshes);
+	asFree(pModel->pMaterials);
+	asFree(pModel->pVertices);
+	asFree(pModel->pIndices);
+	memset(pModel, 0, sizeof(benchReflectedModel));
+}
+
+static asResults _addReflectedSection(asBinWriter* pWriter, asBinSectionIdentifier identifier, const asReflectContainer* pReflectData, const void* pSrc, uint32_t count)
+{
+	const size_t size = asReflectGetBinarySize(pReflectData, count);
+	unsigned char* pDump = asMalloc(size);
+	if (!pDump)
+		return AS_FAILURE_OUT_OF_MEMORY;
+	asResults result = asReflectSaveToBinary(pDump, size, pReflectData, pSrc, count);
+	if (result == AS_SUCCESS)
+		result = asBinWriterAddSection(pWriter, identifier, pDump, size);
+	asFree(pDump);
+	return result;
+}
+
+/*Same content as the asMdl with names and paths stored inline*/
+static asResults _writeReflectedModel(const char* pPath, const asModel_t* pModel)
+{
+	benchModelHeader header = { 0 };
+	header.flags = pModel->flags;
+	header.vertexCount = pModel->vertexCount;
+	header.indexCount = pModel->indexCount;
+	header.indexSize = pModel->indexSize;
+	header.submeshCount = pModel->submeshCount;
+	header.materialCount = pModel->materialCount;
+	memcpy(header.boundsMin, pModel->boundsMin, sizeof(float) * 3);
+	memcpy(header.boundsMax, pModel->boundsMax, sizeof(float) * 3);
+
+	benchSubmesh* pSubmeshes = asMalloc(sizeof(benchSubmesh) * (pModel->submeshCount + 1));
+	benchMaterial* pMaterials = asMalloc(sizeof(benchMaterial) * (pModel->materialCount + 1));
+	if (!pSubmeshes || !pMaterials)
+	{
+		asFree(pSubmeshes);
+		asFree(pMaterials);
+		return AS_FAILURE_OUT_OF_MEMORY;
+	}
+	memset(pSubmeshes, 0, sizeof(benchSubmesh) * (pModel->submeshCount + 1));
+	memset(pMaterials, 0, sizeof(benchMaterial) * (pModel->materialCount + 1));
+	for (uint32_t i = 0; i < pModel->submeshCount; i++)
+	{
+		const asModelSubmesh_t* pSrc = &pModel->submeshes.ptr[i];
+		benchSubmesh* pDst = &pSubmeshes[i];
+		strncpy(pDst->name, pSrc->name.ptr, AS_MODEL_MAX_NAME - 1);
+		pDst->materialIndex = pSrc->materialIndex;
+		pDst->vertexOffset = pSrc->vertexOffset;
+		pDst->vertexCount = pSrc->vertexCount;
+		pDst->lodCount = pSrc->lodCount;
+		for (uint32_t l = 0; l < pSrc->lodCount; l++)
+		{
+			pDst->lodFirstIndex[l] = pSrc->lods[l].firstIndex;
+			pDst->lodIndexCount[l] = pSrc->lods[l].indexCount;
+			pDst->lodError[l] = pSrc->lods[l].error;
+		}
+		memcpy(pDst->boundsMin, pSrc->boundsMin, sizeof(float) * 3);
+		memcpy(pDst->boundsMax, pSrc->boundsMax, sizeof(float) * 3);
+	}
+	for (uint32_t i = 0; i < pModel->materialCount; i++)
+	{
+		const asModelMaterial_t* pSrc = &pModel->materials.ptr[i];
+		benchMaterial* pDst = &pMaterials[i];
+		strncpy(pDst->name, pSrc->name.ptr, AS_MODEL_MAX_NAME - 1);
+		for (int t = 0; t < AS_MODEL_TEXTURE_COUNT; t++)
+			strncpy(&pDst->textures[t * BENCH_MAX_PATH], pSrc->textures[t].ptr, BENCH_MAX_PATH - 1);
+		memcpy(pDst->baseColor, pSrc->baseColor, sizeof(float) * 4);
+		memcpy(pDst->emissive, pSrc->emissive, sizeof(float) * 3);
+		pDst->metallic = pSrc->metallic;
+		pDst->roughness = pSrc->roughness;
+		pDst->normalScale = pSrc->normalScale;
+		pDst->occlusionStrength = pSrc->occlusionStrength;
+		pDst->alphaCutoff = pSrc->alphaCutoff;
+		pDst->alphaMode = (uint32_t)pSrc->alphaMode;
+		pDst->doubleSided = pSrc->doubleSided;
+	}
+
+	asBinWriter writer;
+	asResults result = asBinWriterOpen(&writer, BENCH_REFLECT_TAG, pPath, 8);
+	if (result == AS_SUCCESS)
+	{
+		result = _addReflectedSection(&writer, (asBinSectionIdentifier) { "HEADER", 0 }, &benchModelHeaderReflectData, &header, 1);
+		if (result == AS_SUCCESS)
+			result = _addReflectedSection(&writer, (asBinSectionIdentifier) { "SUBMESH", 0 }, &benchSubmeshReflectData, pSubmeshes, pModel->submeshCount);
+		if (result == AS_SUCCESS)
+			result = _addReflectedSection(&writer, (asBinSectionIdentifier) { "MATERIAL", 0 }, &benchMaterialReflectData, pMaterials, pModel->materialCount);
+		if (result == AS_SUCCESS)
+			result = _addReflectedSection(&writer, (asBinSectionIdentifier) { "VERTICES", 0 }, &benchVertexReflectData, pModel->vertices.ptr, pModel->vertexCount);
+		if (result == AS_SUCCESS)
+			result = asBinWriterAddSection(&writer, (asBinSectionIdentifier) { "INDICES", 0 },
+				pModel->indices.ptr, (size_t)pModel->indexCount * pModel->indexSize);
+		asBinWriterClose(&writer);
+	}
+	asFree(pSubmeshes);
+	asFree(pMaterials);
+	return result;
+}
+
+static asResults _loadReflectedSection(asBinReader* pReader, asBinSectionIdentifier identifier, const asReflectContainer* pReflectData, uint32_t count, void** ppOut)
+{
+	unsigned char* pSection = NULL;
+	size_t size = 0;
+	asResults result = asBinReaderGetSection(pReader, identifier, &pSection, &size);
+	if (result != AS_SUCCESS)
+		return result;
+	if (!*ppOut)
+	{
+		*ppOut = asMalloc((size_t)pReflectData->binarySize * (count ? count : 1));
+		if (!*ppOut)
+			return AS_FAILURE_OUT_OF_MEMORY;
+		memset(*ppOut, 0, (size_t)pReflectData->binarySize * (count ? count : 1));
+	}
+	return asReflectLoadFromBinary(*ppOut, pReflectData->binarySize, count, pReflectData, pSection, size, NULL, NULL);
+}
+
+static asResults _parseReflectedModel(unsigned char* pData, size_t size, benchReflectedModel* pOut)
+{
+	memset(pOut, 0, sizeof(benchReflectedModel));
+	asBinReader reader;
+	asResults result = asBinReaderOpenMemory(&reader, BENCH_REFLECT_TAG, pData, size);
+	if (result != AS_SUCCESS)
+		return result;
+	void* pHeader = &pOut->header;
+	result = _loadReflectedSection(&reader, (asBinSectionIdentifier) { "HEADER", 0 }, &benchModelHeaderReflectData, 1, &pHeader);
+	if (result == AS_SUCCESS)
+		result = _loadReflectedSection(&reader, (asBinSectionIdentifier) { "SUBMESH", 0 }, &benchSubmeshReflectData, pOut->header.submeshCount, (void**)&pOut->pSubmeshes);
+	if (result == AS_SUCCESS)
+		result = _loadReflectedSection(&reader, (asBinSectionIdentifier) { "MATERIAL", 0 }, &benchMaterialReflectData, pOut->header.materialCount, (void**)&pOut->pMaterials);
+	if (result == AS_SUCCESS)
+		result = _loadReflectedSection(&reader, (asBinSectionIdentifier) { "VERTICES", 0 }, &benchVertexReflectData, pOut->header.vertexCount, (void**)&pOut->pVertices);
+	if (result == AS_SUCCESS)
+	{
+		unsigned char* pSection = NULL;
+		size_t indicesSize = 0;
+		result = asBinReaderGetSection(&reader, (asBinSectionIdentifier) { "INDICES", 0 }, &pSection, &indicesSize);
+		if (result == AS_SUCCESS && indicesSize != (size_t)pOut->header.indexCount * pOut->header.indexSize)
+			result = AS_FAILURE_PARSE_ERROR;
+		if (result == AS_SUCCESS)
+		{
+			pOut->pIndices = asMalloc(indicesSize ? indicesSize : 1);
+			if (pOut->pIndices)
+				memcpy(pOut->pIndices, pSection, indicesSize);
+			else
+				result = AS_FAILURE_OUT_OF_MEMORY;
+		}
+	}
+	if (result != AS_SUCCESS)
+		_freeReflectedModel(pOut);
+	return result;
+}
+
+static asResults _readFile(const char* pPath, unsigned char** ppData, size_t* pSize)
+{
+	FILE* fp = fopen(pPath, "rb");
+	if (!fp)
+		return AS_FAILURE_FILE_NOT_FOUND;
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	*ppData = size > 0 ? asMalloc((size_t)size) : NULL;
+	if (!*ppData || fread(*ppData, (size_t)size, 1, fp) != 1)
+	{
+		asFree(*ppData);
+		*ppData = NULL;
+		fclose(fp);
+		return AS_FAILURE_FILE_INACCESSIBLE;
+	}
+	fclose(fp);
+	*pSize = (size_t)size;
+	return AS_SUCCESS;
+}
+
+/*Indexed UV sphere split into submeshes along the rings*/
+static asResults _writeSphereModel(const char* pPath, uint32_t rings, uint32_t segments, uint32_t submeshCount, uint32_t flags)
+{
+	asMeshBuilderSubmesh_t submeshes[8];
+	asModelMaterial_t materials[2];
+	memset(submeshes, 0, sizeof(submeshes));
+	memset(materials, 0, sizeof(materials));
+	const char* textures[2][AS_MODEL_TEXTURE_COUNT] = {
+		{ "textures/body_albedo.ktx", "textures/body_normal.ktx", "textures/body_orm.ktx", "textures/body_orm.ktx", NULL },
+		{ "textures/trim_albedo.ktx", "textures/trim_normal.ktx", NULL, NULL, "textures/trim_emissive.ktx" },
+	};
+	for (int i = 0; i < 2; i++)
+	{
+		materials[i].name.ptr = i ? "trim" : "body";
+		for (int t = 0; t < AS_MODEL_TEXTURE_COUNT; t++)
+			materials[i].textures[t].ptr = textures[i][t];
+		for (int c = 0; c < 4; c++)
+			materials[i].baseColor[c] = 1.0f;
+		materials[i].roughness = 1.0f;
+		materials[i].normalScale = 1.0f;
+		materials[i].occlusionStrength = 1.0f;
+		materials[i].alphaCutoff = 0.5f;
+	}
+
+	asResults result = AS_SUCCESS;
+	const uint32_t ringsPerSubmesh = rings / submeshCount;
+	for (uint32_t m = 0; m < submeshCount && result == AS_SUCCESS; m++)
+	{
+		asMeshBuilderSubmesh_t* pSubmesh = &submeshes[m];
+		asMeshBuilderMesh_t* pMesh = &pSubmesh->mesh;
+		snprintf(pSubmesh->name, AS_MODEL_MAX_NAME, "band%u", m);
+		pSubmesh->materialIndex = m % 2;
+		const uint32_t firstRing = m * ringsPerSubmesh;
+		const uint32_t bandRings = m + 1 == submeshCount ? rings - firstRing : ringsPerSubmesh;
+		pMesh->vertexCount = (bandRings + 1) * (segments + 1);
+		pMesh->indexCount = bandRings * segments * 6;
+		pMesh->pVertices = asMalloc(sizeof(asVertexGeneric) * pMesh->vertexCount);
+		pMesh->pIndices = asMalloc(sizeof(uint32_t) * pMesh->indexCount);
+		if (!pMesh->pVertices || !pMesh->pIndices)
+		{
+			result = AS_FAILURE_OUT_OF_MEMORY;
+			break;
+		}
+		for (uint32_t r = 0; r <= bandRings; r++)
+		{
+			for (uint32_t s = 0; s <= segments; s++)
+			{
+				const float theta = (float)(firstRing + r) / (float)rings * GLM_PIf;
+				const float phi = (float)s / (float)segments * 2.0f * GLM_PIf;
+				vec3 normal = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+				vec3 tangent = { -sinf(phi), 0.0f, cosf(phi) };
+				vec2 uv = { (float)s / (float)segments, (float)(firstRing + r) / (float)rings };
+				const uint8_t white[4] = { 255, 255, 255, 255 };
+				asVertexGeneric* pVertex = &pMesh->pVertices[r * (segments + 1) + s];
+				memset(pVertex, 0, sizeof(asVertexGeneric));
+				asVertexGeneric_encodePosition(pVertex, normal);
+				asVertexGeneric_encodeNormal(pVertex, normal);
+				asVertexGeneric_encodeTangent(pVertex, tangent, 1);
+				asVertexGeneric_encodeUV(pVertex, 0, uv);
+				asVertexGeneric_encodeColor(pVertex, white);
+			}
+		}
+		uint32_t* pIndex = pMesh->pIndices;
+		for (uint32_t r = 0; r < bandRings; r++)
+		{
+			for (uint32_t s = 0; s < segments; s++)
+			{
+				const uint32_t v = r * (segments + 1) + s;
+				const uint32_t quad[6] = { v, v + segments + 1, v + segments + 2, v, v + segments + 2, v + 1 };
+				memcpy(pIndex, quad, sizeof(quad));
+				pIndex += 6;
+			}
+		}
+		result = asMeshBuilder_Optimize(pMesh, AS_MESHOPTIMIZE_VERTEX_CACHE | AS_MESHOPTIMIZE_VERTEX_FETCH);
+	}
+	if (result == AS_SUCCESS)
+		result = asMeshBuilder_WriteModelFile(pPath, submeshes, submeshCount, materials, 2, AS_MODEL_FLAG_TANGENTS | flags);
+	for (uint32_t m = 0; m < submeshCount; m++)
+	{
+		asFree(submeshes[m].mesh.pVertices);
+		asFree(submeshes[m].mesh.pIndices);
+	}
+	return result;
+}
+
+/*Both paths must end up with the same vertices and indices*/
+static bool _isSameModel(const asModel_t* pModel, const benchReflectedModel* pReflected)
+{
+	if (pModel->vertexCount != pReflected->header.vertexCount ||
+		pModel->indexCount != pReflected->header.indexCount ||
+		pModel->submeshCount != pReflected->header.submeshCount)
+		return false;
+	for (uint32_t i = 0; i < pModel->submeshCount; i++)
+	{
+		if (strcmp(pModel->submeshes.ptr[i].name.ptr, pReflected->pSubmeshes[i].name) ||
+			pModel->submeshes.ptr[i].lods[0].indexCount != pReflected->pSubmeshes[i].lodIndexCount[0])
+			return false;
+	}
+	return !memcmp(pModel->vertices.ptr, pReflected->pVertices, sizeof(asVertexGeneric) * pModel->vertexCount) &&
+		!memcmp(pModel->indices.ptr, pReflected->pIndices, (size_t)pModel->indexCount * pModel->indexSize);
+}
+
+static int _runModel(const char* pName, const char* pPath)
+{
+	asModel_t* pSource = NULL;
+	asResults result = asModel_LoadFile(pPath, &pSource);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Could not load %s (%d)", pPath, result);
+		return 3;
+	}
+	char reflectedPath[BENCH_MAX_PATH];
+	snprintf(reflectedPath, BENCH_MAX_PATH, "%s.reflected", pPath);
+	result = _writeReflectedModel(reflectedPath, pSource);
+	asFree(pSource);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Could not write %s (%d)", reflectedPath, result);
+		return 3;
+	}
+
+	/*Files stay in the page cache so this is the cost of getting from bytes to a usable model*/
+	const char* paths[2] = { pPath, reflectedPath };
+	uint64_t readTicks[2] = { 0 };
+	uint64_t parseTicks[2] = { 0 };
+	size_t fileSize[2] = { 0 };
+	bool mismatch = false;
+	asTimer_t timer = asTimerStart();
+	for (int i = 0; i < BENCH_ITERATIONS && result == AS_SUCCESS; i++)
+	{
+		unsigned char* pData[2] = { NULL, NULL };
+		asModel_t* pModel = NULL;
+		benchReflectedModel reflected;
+		memset(&reflected, 0, sizeof(reflected));
+		for (int f = 0; f < 2 && result == AS_SUCCESS; f++)
+		{
+			timer = asTimerRestart(timer);
+			result = _readFile(paths[f], &pData[f], &fileSize[f]);
+			readTicks[f] += asTimerTicksElapsed(timer);
+			if (result != AS_SUCCESS)
+				break;
+			timer = asTimerRestart(timer);
+			if (f == 0)
+				result = asModel_Relocate(pData[f], fileSize[f], &pModel);
+			else
+				result = _parseReflectedModel(pData[f], fileSize[f], &reflected);
+			parseTicks[f] += asTimerTicksElapsed(timer);
+		}
+		if (result == AS_SUCCESS && i == 0)
+			mismatch = !_isSameModel(pModel, &reflected);
+		_freeReflectedModel(&reflected);
+		asFree(pData[0]);
+		asFree(pData[1]);
+	}
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> %s: load failed (%d)", pName, result);
+		return 4;
+	}
+
+	const char* labels[2] = { "in place", "reflected" };
+	double loadMs[2];
+	for (int f = 0; f < 2; f++)
+	{
+		const double readMs = asTimerSeconds(timer, readTicks[f]) * 1000.0 / BENCH_ITERATIONS;
+		const double parseMs = asTimerSeconds(timer, parseTicks[f]) * 1000.0 / BENCH_ITERATIONS;
+		loadMs[f] = readMs + parseMs;
+		asDebugLog("%-32s %-10s %8.2f MB  read %8.3f ms  parse %8.3f ms  load %8.3f ms %8.2f MB/s",
+			f ? "" : pName, labels[f], (double)fileSize[f] / (1024.0 * 1024.0),
+			readMs, parseMs, loadMs[f], (double)fileSize[f] / (1024.0 * 1024.0) / (loadMs[f] / 1000.0));
+	}
+	asDebugLog("%-32s %.2fx faster%s", "", loadMs[1] / loadMs[0], mismatch ? " [DATA MISMATCH]" : "");
+	return mismatch ? 5 : 0;
+}
+
+/*Depth passes read the position stream instead of whole vertices,
+quantized positions have to stay within a step of the float ones and match the snapped vertices exactly*/
+static int _runPositionStream(const char* pName, const char* pFloatPath, const char* pQuantizedPath)
+{
+	const char* paths[2] = { pFloatPath, pQuantizedPath };
+	asModel_t* pModels[2] = { NULL, NULL };
+	asResults result = AS_SUCCESS;
+	for (int i = 0; i < 2 && result == AS_SUCCESS; i++)
+		result = asModel_LoadFile(paths[i], &pModels[i]);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> %s: position stream load failed (%d)", pName, result);
+		asFree(pModels[0]);
+		return 3;
+	}
+
+	bool mismatch = pModels[0]->vertexCount != pModels[1]->vertexCount;
+	float maxError = 0.0f;
+	float maxStep = 0.0f;
+	for (int i = 0; i < 3; i++)
+		maxStep = glm_max(maxStep, pModels[1]->positionScale[i] / 65535.0f);
+	for (uint32_t v = 0; v < pModels[0]->vertexCount && !mismatch; v++)
+	{
+		vec3 position;
+		vec3 quantized;
+		asModel_DecodePosition(pModels[0], v, position);
+		asModel_DecodePosition(pModels[1], v, quantized);
+		for (int i = 0; i < 3; i++)
+			maxError = glm_max(maxError, fabsf(quantized[i] - position[i]));
+		mismatch |= memcmp(quantized, pModels[1]->vertices.ptr[v].position, sizeof(vec3)) != 0;
+	}
+	const char* labels[2] = { "float", "unorm16" };
+	const double vertexMB = (double)sizeof(asVertexGeneric) * pModels[0]->vertexCount / (1024.0 * 1024.0);
+	for (int i = 0; i < 2; i++)
+	{
+		const double streamMB = (double)pModels[i]->positionSize * pModels[i]->vertexCount / (1024.0 * 1024.0);
+		asDebugLog("%-32s %-10s %8.2f MB  depth stream %8.2f MB  %5.1f%% of the vertices",
+			i ? "" : pName, labels[i], vertexMB, streamMB, vertexMB > 0.0 ? streamMB / vertexMB * 100.0 : 0.0);
+	}
+	mismatch |= maxError > maxStep;
+	asDebugLog("%-32s max error %g (step %g)%s", "", maxError, maxStep, mismatch ? " [DATA MISMATCH]" : "");
+	asFree(pModels[0]);
+	asFree(pModels[1]);
+	return mismatch ? 5 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Model Load Benchmark...");
+	int result = 0;
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+			result |= _runModel(argv[i], argv[i]);
+		return result;
+	}
+
+	asDebugLog("%s", "No asMdl files given, using generated spheres (usage: asModelBenchmark [model.asmdl]...)");
+	const uint32_t sizes[3][3] = { { 32, 64, 2 }, { 128, 256, 4 }, { 512, 1024, 8 } };
+	for (int i = 0; i < 3; i++)
+	{
+		char name[64];
+		char path[64];
+		snprintf(name, 64, "sphere %ux%u", sizes[i][0], sizes[i][1]);
+		snprintf(path, 64, "asModelBenchmark%d.asmdl", i);
+		char quantizedPath[64];
+		snprintf(quantizedPath, 64, "asModelBenchmark%dq.asmdl", i);
+		asResults writeResult = _writeSphereModel(path, sizes[i][0], sizes[i][1], sizes[i][2], 0);
+		if (writeResult == AS_SUCCESS)
+			writeResult = _writeSphereModel(quantizedPath, sizes[i][0], sizes[i][1], sizes[i][2], AS_MODEL_FLAG_QUANTIZED_POSITIONS);
+		if (writeResult != AS_SUCCESS)
+		{
+			asDebugLog("[ERROR]> Could not write %s (%d)", path, writeResult);
+			result |= 3;
+			continue;
+		}
+		result |= _runModel(name, path);
+		result |= _runPositionStream(name, path, quantizedPath);
+	}
+	return result;
+}
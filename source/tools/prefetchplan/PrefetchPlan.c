@@ -0,0 +1,78 @@
+#include "engine/common/asCommon.h"
+#include "engine/resource/asResourceTrace.h"
+#include "engine/resource/asResourceManifest.h"
+
+/*Turns recorded access traces into a preload plan: run after MANIFEST, before PACK*/
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Resource Prefetch Plan Generator...");
+	if (argc < 3)
+	{
+		asDebugLog("Usage: %s [resource directory] [trace] [more traces...]", argv[0]);
+		return 1;
+	}
+
+	/*Gather every trace (several runs give a more stable order)*/
+	asResourceTraceEvent_t* pEvents = NULL;
+	size_t eventCount = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		asResourceTraceEvent_t* pTrace;
+		size_t traceCount;
+		asResults result = asResourceTrace_Load(argv[i], &pTrace, &traceCount);
+		if (result != AS_SUCCESS)
+		{
+			asDebugLog("[ERROR]> Could not load trace: %s (%d)", argv[i], (int)result);
+			asFree(pEvents);
+			return (int)result;
+		}
+		asDebugLog("%s: %zu reads", argv[i], traceCount);
+		pEvents = asRealloc(pEvents, sizeof(asResourceTraceEvent_t) * (eventCount + traceCount));
+		if (traceCount)
+			memcpy(pEvents + eventCount, pTrace, sizeof(asResourceTraceEvent_t) * traceCount);
+		eventCount += traceCount;
+		asFree(pTrace);
+	}
+
+	asResourceTraceEvent_t* pPlan;
+	size_t planCount;
+	asResourcePlan_Build(pEvents, eventCount, &pPlan, &planCount);
+	asFree(pEvents);
+
+	/*Drop entries the current manifest doesn't know about (renamed or removed since the trace)*/
+	char path[1024];
+	snprintf(path, 1024, "%s%s", argv[1], AS_RESOURCE_MANIFEST_NAME);
+	asResourceManifest manifest;
+	if (asResourceManifest_Open(&manifest, path) == AS_SUCCESS)
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < planCount; i++)
+		{
+			if (asResourceManifest_Find(manifest, pPlan[i].id))
+				pPlan[kept++] = pPlan[i];
+		}
+		if (kept != planCount)
+			asDebugLog("Dropped %zu entries missing from the manifest", planCount - kept);
+		planCount = kept;
+		asResourceManifest_Close(manifest);
+	}
+	else
+	{
+		asDebugLog("No binary manifest in %s, keeping every entry", argv[1]);
+	}
+
+	uint64_t totalBytes = 0;
+	for (size_t i = 0; i < planCount; i++)
+		totalBytes += pPlan[i].size;
+
+	snprintf(path, 1024, "%s%s", argv[1], AS_RESOURCE_PLAN_NAME);
+	asResults result = asResourcePlan_Write(path, pPlan, planCount);
+	asFree(pPlan);
+	if (result != AS_SUCCESS)
+	{
+		asDebugLog("[ERROR]> Could not write plan: %s", path);
+		return (int)result;
+	}
+	asDebugLog("%s: %zu entries, %.1f MB", path, planCount, (double)totalBytes / (1024.0 * 1024.0));
+	return 0;
+}
@@ -79,17 +79,22 @@ shaderc_shader_kind getShaderKind(asShaderStage stage)
 		case AS_SHADERSTAGE_TESS_EVALUATION: return shaderc_tess_evaluation_shader;
 		case AS_SHADERSTAGE_GEOMETRY: return shaderc_geometry_shader;
 		case AS_SHADERSTAGE_COMPUTE: return shaderc_compute_shader;
+		case AS_SHADERSTAGE_TASK: return shaderc_task_shader;
+		case AS_SHADERSTAGE_MESH: return shaderc_mesh_shader;
 		default: return shaderc_glsl_infer_from_source;
 	}
 }
 
-asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t contentsSize, const char* fileName, const char* permName, const asShaderTypeCodePath* codePath)
+asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t contentsSize, const char* fileName, const char* permName, const asShaderTypeCodePath* codePath, bool optional)
 {
 	/*Setup Compiler*/
 	struct shaderc_compiler* glslCompiler = shaderc_compiler_initialize();
 	struct shaderc_compile_options* compileOptions = shaderc_compile_options_initialize();
 	
 	shaderc_compile_options_set_target_env(compileOptions, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+	/*VK_EXT_mesh_shader needs SPIR-V 1.4*/
+	if (codePath->stage == AS_SHADERSTAGE_TASK || codePath->stage == AS_SHADERSTAGE_MESH)
+		shaderc_compile_options_set_target_spirv(compileOptions, shaderc_spirv_version_1_4);
 	shaderc_compile_options_set_source_language(compileOptions, shaderc_source_language_glsl);
 	shaderc_compile_options_set_optimization_level(compileOptions, shaderc_optimization_level_performance);
 	shaderc_compile_options_set_warnings_as_errors(compileOptions);
@@ -106,7 +111,9 @@ asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t conten
 	case AS_SHADERSTAGE_TESS_CONTROL: stageName = "AS_STAGE_TESS_CONTROL"; break;
 	case AS_SHADERSTAGE_TESS_EVALUATION: stageName = "AS_STAGE_TESS_EVALUATION"; break;
 	case AS_SHADERSTAGE_GEOMETRY: stageName = "AS_STAGE_GEOMETRY"; break;
-	case AS_SHADERSTAGE_COMPUTE: stageName = "AS_STAGE_COMPUTE"; break;}
+	case AS_SHADERSTAGE_COMPUTE: stageName = "AS_STAGE_COMPUTE"; break;
+	case AS_SHADERSTAGE_TASK: stageName = "AS_STAGE_TASK"; break;
+	case AS_SHADERSTAGE_MESH: stageName = "AS_STAGE_MESH"; break;}
 	shaderc_compile_options_add_macro_definition(compileOptions, stageName, strlen(stageName), "", 0);
 
 	/*Add Quality Macro*/
@@ -137,6 +144,15 @@ asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t conten
 	if (status != shaderc_compilation_status_success)
 	{
 		const char* error = shaderc_result_get_error_message(result);
+		/*Optional pipelines are left out of the FX when their code does not compile*/
+		if (optional)
+		{
+			asDebugLog("[WARNING]> Optional Pipeline: \"%s\" left out: \"%s\"", permName, error);
+			shaderc_result_release(result);
+			shaderc_compile_options_release(compileOptions);
+			shaderc_compiler_release(glslCompiler);
+			return AS_FAILURE_PARSE_ERROR;
+		}
 		asDebugLog("[ERROR]> Pipeline: \"%s\" Error: \"%s\"", permName, error);
 		_fcloseall();
 		exit(status);
@@ -3,4 +3,4 @@
 #include "engine/renderer/asShaderVariants.h"
 #include "FxCreator.h"
 
-asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t contentsSize, const char* fileName, const char* pipelineName, const asShaderTypeCodePath* codePath);
\ No newline at end of file
+asResults glslToSpirv(FxCreator* pFxCreator, const char* contents, size_t contentsSize, const char* fileName, const char* pipelineName, const asShaderTypeCodePath* codePath, bool optional);
\ No newline at end of file
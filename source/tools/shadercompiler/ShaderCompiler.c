@@ -112,7 +112,8 @@ int main(int argc, char* argv[])
 			glslContents, fileSize,
 			assetPath,
 			shaderTypeInfo->codePaths[j].pipelineName,
-			&shaderTypeInfo->codePaths[j]);
+			&shaderTypeInfo->codePaths[j],
+			asShaderCodePathIsOptional(shaderTypeInfo, j));
 	}
 
 	FxCreator_Finish(&fxCreator);
@@ -0,0 +1,395 @@
+#include "engine/common/asCommon.h"
+#include "engine/model/runtime/asModelRuntime.h"
+
+/*Every SIMD level is checked bit for bit against the scalar path on random vectors (with NaNs, infinities,
+subnormals and out of range values mixed in), the round trip error is checked on unit vectors
+and then every level is timed on large batches*/
+#define BENCH_SEED 0x6173566572746578ull
+#define BENCH_TEST_COUNT 100003 /*Odd so the scalar tail of every kernel is hit*/
+#define BENCH_TEST_OFFSETS 3 /*Unaligned starts*/
+#define BENCH_VERTEX_COUNT 10000000
+#define BENCH_ITERATIONS 4
+
+static const char* gLevelNames[AS_VERTEX_SIMD_COUNT] = { "scalar", "SSE2", "AVX2" };
+
+static uint64_t _xorshift64(uint64_t* pState)
+{
+	uint64_t x = *pState;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *pState = x;
+}
+
+static float _bitsFloat(uint32_t bits)
+{
+	float v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+static float _randomUnit(uint64_t* pState)
+{
+	return (float)(_xorshift64(pState) >> 40) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+/*Mostly values in range with the odd special case or random bit pattern*/
+static float _randomValue(uint64_t* pState, float range)
+{
+	static const uint32_t specials[] = {
+		0x00000000, 0x80000000, 0x7F800000, 0xFF800000, 0x7FC00000, 0xFFC00000, 0x7F800001, 0x7FA00000, 0xFFFFFFFF,
+		0x00000001, 0x807FFFFF, 0x33000000, 0x33000001, 0x387FFFFF, 0x38800000, 0x477FE000, 0x477FEFFF, 0x477FF000,
+		0x47800000, 0x3F800000, 0xBF800000, 0x3F800001, 0xBF800001, 0x40000000, 0xC0000000, 0x4F000000, 0xCF000000
+	};
+	const uint64_t r = _xorshift64(pState);
+	switch (r % 16)
+	{
+	case 0: return _bitsFloat(specials[(r >> 8) % (sizeof(specials) / sizeof(specials[0]))]);
+	case 1: return _bitsFloat((uint32_t)(r >> 32));
+	default: return _randomUnit(pState) * range;
+	}
+}
+
+/*Unit vectors with a random sign in W when there is room for one*/
+static void _randomUnitVectors(uint64_t* pState, float* pDst, size_t count, size_t stride)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		vec3 v = { _randomUnit(pState), _randomUnit(pState), _randomUnit(pState) };
+		glm_vec3_normalize(v);
+		memcpy(&pDst[i * stride], v, sizeof(float) * 3);
+		if (stride == 4)
+			pDst[i * stride + 3] = _xorshift64(pState) & 1 ? 1.0f : -1.0f;
+	}
+}
+
+/*------------------------------------KERNELS------------------------------------*/
+
+typedef enum {
+	BENCH_HALF_ENCODE,
+	BENCH_HALF_DECODE,
+	BENCH_SNORM_ENCODE,
+	BENCH_SNORM_DECODE,
+	BENCH_OCTAHEDRAL_ENCODE,
+	BENCH_OCTAHEDRAL_DECODE,
+	BENCH_TANGENT_ENCODE,
+	BENCH_TANGENT_DECODE,
+	BENCH_WEIGHT_ENCODE,
+	BENCH_WEIGHT_DECODE,
+	BENCH_KERNEL_COUNT
+} benchKernel;
+
+static const char* gKernelNames[BENCH_KERNEL_COUNT] = {
+	"float to half", "half to float", "snorm10 encode", "snorm10 decode", "octahedral encode",
+	"octahedral decode", "tangent encode", "tangent decode", "weight encode", "weight decode"
+};
+
+/*Floats per element on the unpacked side and bytes per element on the packed side*/
+static const size_t gKernelFloats[BENCH_KERNEL_COUNT] = { 1, 1, 3, 3, 3, 3, 4, 4, 4, 4 };
+static const size_t gKernelPackedBytes[BENCH_KERNEL_COUNT] = { 2, 2, 4, 4, 4, 4, 4, 4, 4, 4 };
+
+static bool _isDecoder(benchKernel kernel)
+{
+	return kernel % 2 == 1;
+}
+
+static void _runKernel(benchKernel kernel, float* pFloats, void* pPacked, size_t count)
+{
+	switch (kernel)
+	{
+	case BENCH_HALF_ENCODE: asVertexEncode_FloatToHalf(pPacked, pFloats, count); break;
+	case BENCH_HALF_DECODE: asVertexDecode_HalfToFloat(pFloats, pPacked, count); break;
+	case BENCH_SNORM_ENCODE: asVertexEncode_Normals(pPacked, pFloats, count, AS_VERTEX_NORMAL_SNORM10); break;
+	case BENCH_SNORM_DECODE: asVertexDecode_Normals(pFloats, pPacked, count, AS_VERTEX_NORMAL_SNORM10); break;
+	case BENCH_OCTAHEDRAL_ENCODE: asVertexEncode_Normals(pPacked, pFloats, count, AS_VERTEX_NORMAL_OCTAHEDRAL); break;
+	case BENCH_OCTAHEDRAL_DECODE: asVertexDecode_Normals(pFloats, pPacked, count, AS_VERTEX_NORMAL_OCTAHEDRAL); break;
+	case BENCH_TANGENT_ENCODE: asVertexEncode_Tangents(pPacked, pFloats, count); break;
+	case BENCH_TANGENT_DECODE: asVertexDecode_Tangents(pFloats, pPacked, count); break;
+	case BENCH_WEIGHT_ENCODE: asVertexEncode_BoneWeights(pPacked, pFloats, count); break;
+	case BENCH_WEIGHT_DECODE: asVertexDecode_BoneWeights(pFloats, pPacked, count); break;
+	default: break;
+	}
+}
+
+static void _fillInputs(benchKernel kernel, uint64_t seed, float* pFloats, void* pPacked, size_t count)
+{
+	uint64_t state = seed;
+	if (kernel == BENCH_HALF_DECODE)
+	{
+		/*Every half, then random ones*/
+		uint16_t* pHalves = pPacked;
+		for (size_t i = 0; i < count; i++)
+			pHalves[i] = i < 0x10000 ? (uint16_t)i : (uint16_t)_xorshift64(&state);
+	}
+	else if (_isDecoder(kernel))
+	{
+		uint32_t* pWords = pPacked;
+		for (size_t i = 0; i < count; i++)
+			pWords[i] = (uint32_t)_xorshift64(&state);
+	}
+	else
+	{
+		const float range = kernel == BENCH_HALF_ENCODE ? 70000.0f : 1.25f;
+		for (size_t i = 0; i < count * gKernelFloats[kernel]; i++)
+			pFloats[i] = _randomValue(&state, range);
+	}
+}
+
+/*------------------------------------TESTS------------------------------------*/
+
+static int _testBitExact(benchKernel kernel, uint64_t seed)
+{
+	const size_t floatBytes = sizeof(float) * gKernelFloats[kernel] * BENCH_TEST_COUNT;
+	const size_t packedBytes = gKernelPackedBytes[kernel] * BENCH_TEST_COUNT;
+	float* pFloats = asMalloc(floatBytes);
+	unsigned char* pPacked = asMalloc(packedBytes);
+	unsigned char* pReference = asMalloc(floatBytes > packedBytes ? floatBytes : packedBytes);
+	if (!pFloats || !pPacked || !pReference)
+	{
+		asFree(pFloats);
+		asFree(pPacked);
+		asFree(pReference);
+		asDebugLog("[ERROR]> %s: out of memory", gKernelNames[kernel]);
+		return 2;
+	}
+	int result = 0;
+	uint32_t levelsTested = 0;
+	for (size_t offset = 0; offset < BENCH_TEST_OFFSETS && !result; offset++)
+	{
+		const size_t count = BENCH_TEST_COUNT - offset * 5;
+		float* pTestFloats = pFloats + offset * gKernelFloats[kernel];
+		unsigned char* pTestPacked = pPacked + offset * gKernelPackedBytes[kernel];
+		const unsigned char* pOutput = _isDecoder(kernel) ? (const unsigned char*)pTestFloats : pTestPacked;
+		const size_t outputBytes = _isDecoder(kernel) ? sizeof(float) * gKernelFloats[kernel] * count : gKernelPackedBytes[kernel] * count;
+		for (int level = AS_VERTEX_SIMD_SCALAR; level < AS_VERTEX_SIMD_COUNT && !result; level++)
+		{
+			if (asVertexEncode_SetSimdLevel((asVertexSimdLevel)level) != (asVertexSimdLevel)level)
+				continue;
+			levelsTested |= 1u << level;
+			_fillInputs(kernel, seed + offset, pFloats, pPacked, BENCH_TEST_COUNT);
+			_runKernel(kernel, pTestFloats, pTestPacked, count);
+			if (level == AS_VERTEX_SIMD_SCALAR)
+			{
+				memcpy(pReference, pOutput, outputBytes);
+				continue;
+			}
+			for (size_t i = 0; i < outputBytes; i += gKernelPackedBytes[kernel])
+			{
+				if (!memcmp(pReference + i, pOutput + i, gKernelPackedBytes[kernel]))
+					continue;
+				uint32_t got = 0, expected = 0;
+				memcpy(&got, pOutput + i, gKernelPackedBytes[kernel]);
+				memcpy(&expected, pReference + i, gKernelPackedBytes[kernel]);
+				asDebugLog("[ERROR]> %s %s: %08x at byte %zu (offset %zu), scalar gives %08x",
+					gKernelNames[kernel], gLevelNames[level], got, i, offset, expected);
+				result = 1;
+				break;
+			}
+		}
+	}
+	asVertexEncode_SetSimdLevel(AS_VERTEX_SIMD_COUNT);
+	asFree(pFloats);
+	asFree(pPacked);
+	asFree(pReference);
+	if (!result)
+	{
+		asDebugLog("%-20s bit exact (%s%s%s)", gKernelNames[kernel], gLevelNames[0],
+			levelsTested & 2 ? ", SSE2" : "", levelsTested & 4 ? ", AVX2" : "");
+	}
+	return result;
+}
+
+/*Quantization error of a round trip through each packing*/
+static int _testRoundTrip(uint64_t seed)
+{
+	const size_t count = BENCH_TEST_COUNT;
+	float* pSource = asMalloc(sizeof(float) * 4 * count);
+	float* pDecoded = asMalloc(sizeof(float) * 4 * count);
+	uint32_t* pPacked = asMalloc(sizeof(uint32_t) * count);
+	if (!pSource || !pDecoded || !pPacked)
+	{
+		asFree(pSource);
+		asFree(pDecoded);
+		asFree(pPacked);
+		asDebugLog("%s", "[ERROR]> round trip: out of memory");
+		return 2;
+	}
+	int result = 0;
+	uint64_t state = seed;
+
+	const asVertexNormalEncoding encodings[2] = { AS_VERTEX_NORMAL_SNORM10, AS_VERTEX_NORMAL_OCTAHEDRAL };
+	const char* encodingNames[2] = { "snorm10", "octahedral" };
+	const float maxAngles[2] = { 0.2f, 0.01f }; /*Degrees*/
+	_randomUnitVectors(&state, pSource, count, 3);
+	for (int e = 0; e < 2; e++)
+	{
+		asVertexEncode_Normals(pPacked, pSource, count, encodings[e]);
+		asVertexDecode_Normals(pDecoded, pPacked, count, encodings[e]);
+		float worst = 0.0f;
+		for (size_t i = 0; i < count; i++)
+		{
+			/*atan2 keeps the precision acos loses for tiny angles*/
+			vec3 cross;
+			glm_vec3_cross(&pSource[i * 3], &pDecoded[i * 3], cross);
+			const float angle = glm_deg(atan2f(glm_vec3_norm(cross), glm_vec3_dot(&pSource[i * 3], &pDecoded[i * 3])));
+			worst = angle > worst ? angle : worst;
+		}
+		asDebugLog("%-20s worst error %.4f degrees", encodingNames[e], worst);
+		if (worst > maxAngles[e])
+		{
+			asDebugLog("[ERROR]> %s normals are off by up to %f degrees", encodingNames[e], worst);
+			result = 1;
+		}
+	}
+
+	_randomUnitVectors(&state, pSource, count, 4);
+	asVertexEncode_Tangents(pPacked, pSource, count);
+	asVertexDecode_Tangents(pDecoded, pPacked, count);
+	for (size_t i = 0; i < count && !result; i++)
+	{
+		if (pDecoded[i * 4 + 3] != pSource[i * 4 + 3])
+		{
+			asDebugLog("[ERROR]> tangent %zu lost its sign", i);
+			result = 1;
+		}
+	}
+
+	for (size_t i = 0; i < count * 4; i++)
+		pSource[i] = _xorshift64(&state) % 4 ? (_randomUnit(&state) + 1.0f) * 0.5f : 0.0f;
+	asVertexEncode_BoneWeights(pPacked, pSource, count);
+	for (size_t i = 0; i < count && !result; i++)
+	{
+		const float sum = pSource[i * 4] + pSource[i * 4 + 1] + pSource[i * 4 + 2] + pSource[i * 4 + 3];
+		uint32_t total = 0;
+		for (int j = 0; j < 4; j++)
+			total += (pPacked[i] >> (j * 8)) & 0xFF;
+		if (total != (sum > 0.0f ? 255u : 0u))
+		{
+			asDebugLog("[ERROR]> bone weights of vertex %zu add up to %u", i, total);
+			result = 1;
+		}
+	}
+	if (!result)
+		asDebugLog("%-20s bone weights add up to 255, tangent signs kept", "");
+
+	asFree(pSource);
+	asFree(pDecoded);
+	asFree(pPacked);
+	return result;
+}
+
+/*------------------------------------BENCHMARK------------------------------------*/
+
+static int _benchmark(size_t vertexCount, uint64_t seed)
+{
+	float* pFloats = asMalloc(sizeof(float) * 4 * vertexCount);
+	uint32_t* pPacked = asMalloc(sizeof(uint32_t) * vertexCount);
+	if (!pFloats || !pPacked)
+	{
+		asFree(pFloats);
+		asFree(pPacked);
+		asDebugLog("%s", "[ERROR]> benchmark: out of memory");
+		return 2;
+	}
+	asDebugLog("Kernels on %zu element batches (MB/s of unpacked floats)", vertexCount);
+	asDebugLog("%-20s %12s %12s %12s", "", gLevelNames[0], gLevelNames[1], gLevelNames[2]);
+	asTimer_t timer = asTimerStart();
+	for (int kernel = 0; kernel < BENCH_KERNEL_COUNT; kernel++)
+	{
+		/*Decoders are timed on what the encoders made so the data is realistic*/
+		if (!_isDecoder((benchKernel)kernel))
+		{
+			if (kernel == BENCH_HALF_ENCODE || kernel == BENCH_WEIGHT_ENCODE)
+				_fillInputs((benchKernel)kernel, seed, pFloats, pPacked, vertexCount);
+			else
+				_randomUnitVectors(&(uint64_t){ seed }, pFloats, vertexCount, gKernelFloats[kernel]);
+		}
+		const double megabytes = (double)(sizeof(float) * gKernelFloats[kernel] * vertexCount) / (1024.0 * 1024.0);
+		char columns[AS_VERTEX_SIMD_COUNT][16];
+		for (int level = AS_VERTEX_SIMD_SCALAR; level < AS_VERTEX_SIMD_COUNT; level++)
+		{
+			snprintf(columns[level], 16, "%s", "-");
+			if (asVertexEncode_SetSimdLevel((asVertexSimdLevel)level) != (asVertexSimdLevel)level)
+				continue;
+			_runKernel((benchKernel)kernel, pFloats, pPacked, vertexCount);
+			timer = asTimerRestart(timer);
+			for (int i = 0; i < BENCH_ITERATIONS; i++)
+				_runKernel((benchKernel)kernel, pFloats, pPacked, vertexCount);
+			const double seconds = asTimerSeconds(timer, asTimerTicksElapsed(timer)) / BENCH_ITERATIONS;
+			snprintf(columns[level], 16, "%.0f", megabytes / seconds);
+		}
+		asDebugLog("%-20s %12s %12s %12s", gKernelNames[kernel], columns[0], columns[1], columns[2]);
+	}
+	asFree(pFloats);
+	asFree(pPacked);
+
+	/*Whole vertices the way the cook builds them*/
+	float* pPositions = asMalloc(sizeof(float) * 3 * vertexCount);
+	float* pNormals = asMalloc(sizeof(float) * 3 * vertexCount);
+	float* pTangents = asMalloc(sizeof(float) * 4 * vertexCount);
+	float* pUVs = asMalloc(sizeof(float) * 2 * vertexCount);
+	float* pWeights = asMalloc(sizeof(float) * 4 * vertexCount);
+	asVertexGeneric* pVertices = asMalloc(sizeof(asVertexGeneric) * vertexCount);
+	int result = 0;
+	if (pPositions && pNormals && pTangents && pUVs && pWeights && pVertices)
+	{
+		uint64_t state = seed;
+		for (size_t i = 0; i < vertexCount * 3; i++)
+			pPositions[i] = _randomUnit(&state) * 100.0f;
+		_randomUnitVectors(&state, pNormals, vertexCount, 3);
+		_randomUnitVectors(&state, pTangents, vertexCount, 4);
+		for (size_t i = 0; i < vertexCount * 2; i++)
+			pUVs[i] = _randomUnit(&state) + 1.0f;
+		for (size_t i = 0; i < vertexCount * 4; i++)
+			pWeights[i] = (_randomUnit(&state) + 1.0f) * 0.5f;
+		asVertexGenericStreams_t streams;
+		memset(&streams, 0, sizeof(streams));
+		streams.pPositions = pPositions;
+		streams.pNormals = pNormals;
+		streams.pTangents = pTangents;
+		streams.pUVs[0] = pUVs;
+		streams.pBoneWeights = pWeights;
+		streams.normalEncoding = AS_VERTEX_NORMAL_OCTAHEDRAL;
+		const double inputMegabytes = (double)(sizeof(float) * 16 * vertexCount) / (1024.0 * 1024.0);
+		asDebugLog("asVertexGeneric batches of %zu vertices (position, octahedral normal, tangent, UV and weights)", vertexCount);
+		for (int level = AS_VERTEX_SIMD_SCALAR; level < AS_VERTEX_SIMD_COUNT; level++)
+		{
+			if (asVertexEncode_SetSimdLevel((asVertexSimdLevel)level) != (asVertexSimdLevel)level)
+				continue;
+			asVertexGeneric_encodeBatch(pVertices, vertexCount, &streams);
+			timer = asTimerRestart(timer);
+			for (int i = 0; i < BENCH_ITERATIONS; i++)
+				asVertexGeneric_encodeBatch(pVertices, vertexCount, &streams);
+			const double seconds = asTimerSeconds(timer, asTimerTicksElapsed(timer)) / BENCH_ITERATIONS;
+			asDebugLog("%-20s %8.2f ms %8.0f MB/s %8.1f Mverts/s", gLevelNames[level],
+				seconds * 1000.0, inputMegabytes / seconds, (double)vertexCount / seconds / 1000000.0);
+		}
+	}
+	else
+	{
+		asDebugLog("%s", "[ERROR]> benchmark: out of memory");
+		result = 2;
+	}
+	asVertexEncode_SetSimdLevel(AS_VERTEX_SIMD_COUNT);
+	asFree(pPositions);
+	asFree(pNormals);
+	asFree(pTangents);
+	asFree(pUVs);
+	asFree(pWeights);
+	asFree(pVertices);
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	asDebugLog("%s", "Running Vertex Encoding Benchmark...");
+	const size_t vertexCount = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : BENCH_VERTEX_COUNT;
+	asDebugLog("Best SIMD level: %s", gLevelNames[asVertexEncode_GetSimdLevel()]);
+	int result = 0;
+	for (int kernel = 0; kernel < BENCH_KERNEL_COUNT; kernel++)
+		result |= _testBitExact((benchKernel)kernel, BENCH_SEED + (uint64_t)kernel * 977);
+	result |= _testRoundTrip(BENCH_SEED);
+	if (result)
+		return result;
+	return _benchmark(vertexCount ? vertexCount : BENCH_VERTEX_COUNT, BENCH_SEED);
+}